@@ -0,0 +1,155 @@
+// TradeFlow Pro encoded bar cache
+// Closed bars almost never change, yet every export re-formats them from
+// sc.BaseDataIn field by field. This keeps the encoded JSON body of closed bars
+// keyed by bar time, with a fingerprint of every value that goes into the
+// body; a later export of the same bar appends the cached bytes and only a bar
+// whose fingerprint no longer matches (bar revised by a reload, calculations
+// reconfigured) is formatted again. Bounded to the most recently inserted bars;
+// a batch being assembled may exceed the bound until the caller trims.
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include "TradeFlow_Pro_StreamingCalcs.h"
+#include "TradeFlow_Pro_TimeAndSales.h"
+
+struct s_EncodedBar
+{
+    uint64_t Fingerprint = 0;
+    std::string Body;   // Bar object up to and including chart_info, no collected_at
+};
+
+struct s_EncodedBarCache
+{
+    int MaxBars = 0;    // 0 = disabled
+    int Hits = 0;       // Bars appended from the cache since the last Reset
+    int Encoded = 0;    // Bars formatted (missing or changed) since the last Reset
+
+    void Configure(int NewMaxBars)
+    {
+        if (NewMaxBars == MaxBars)
+            return;
+        MaxBars = NewMaxBars > 0 ? NewMaxBars : 0;
+        Evict();
+    }
+
+    void Reset()
+    {
+        Bars.clear();
+        Order.clear();
+        Symbol.clear();
+        ChartNumber = 0;
+        SecondsPerBar = 0;
+        Hits = 0;
+        Encoded = 0;
+    }
+
+    bool Enabled() const { return MaxBars > 0; }
+
+    // Drops every entry when the chart's identity (carried in chart_info)
+    // changed; call once before a batch is encoded
+    void Begin(SCStudyInterfaceRef sc)
+    {
+        if (Symbol == sc.Symbol.GetChars() && ChartNumber == sc.ChartNumber && SecondsPerBar == sc.SecondsPerBar)
+            return;
+        Reset();
+        Symbol = sc.Symbol.GetChars();
+        ChartNumber = sc.ChartNumber;
+        SecondsPerBar = sc.SecondsPerBar;
+    }
+
+    // FNV-1a over the raw values CreateTradeFlowBarBody reads for Index
+    static uint64_t Fingerprint(SCStudyInterfaceRef sc, int Index, const s_StreamingCalcs* Calcs)
+    {
+        uint64_t Hash = 14695981039346656037ULL;
+        const int Fields[] = { SC_OPEN, SC_HIGH, SC_LOW, SC_LAST, SC_VOLUME, SC_BIDVOL, SC_ASKVOL, SC_OPEN_INTEREST };
+        for (int Field : Fields)
+        {
+            float Value = sc.BaseDataIn[Field].GetArraySize() > 0 ? sc.BaseDataIn[Field][Index] : 0.0f;
+            Mix(Hash, &Value, sizeof(Value));
+        }
+        int Trades = sc.NumberOfTrades.GetArraySize() > 0 ? sc.NumberOfTrades[Index] : 0;
+        Mix(Hash, &Trades, sizeof(Trades));
+
+        if (Calcs == nullptr || !Calcs->HasValues(Index))
+            return Hash;
+
+        const s_StreamingCalcConfig& Config = Calcs->Config;
+        int Flags = (Config.Delta ? 1 : 0) | (Config.CVD ? 2 : 0) | (Config.VWAP ? 4 : 0);
+        Mix(Hash, &Flags, sizeof(Flags));
+        if (Config.Delta)
+            Mix(Hash, &Calcs->Delta[Index], sizeof(double));
+        if (Config.CVD)
+            Mix(Hash, &Calcs->CVD[Index], sizeof(double));
+        if (Config.VWAP)
+        {
+            Mix(Hash, &Config.VWAPBandMultiplier, sizeof(double));
+            Mix(Hash, &Calcs->SumPriceVolume[Index], sizeof(double));
+            Mix(Hash, &Calcs->SumVolume[Index], sizeof(double));
+            Mix(Hash, &Calcs->SumPrice2Volume[Index], sizeof(double));
+        }
+        for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+        {
+            if (Config.EMAPeriods[e] <= 0)
+                continue;
+            Mix(Hash, &Config.EMAPeriods[e], sizeof(int));
+            Mix(Hash, &Calcs->EMA[e][Index], sizeof(double));
+        }
+        return Hash;
+    }
+
+    // Cached body of the bar at TimeMs, or nullptr when missing or stale
+    const std::string* Find(long long TimeMs, uint64_t Fingerprint)
+    {
+        auto Found = Bars.find(TimeMs);
+        if (Found == Bars.end() || Found->second.Fingerprint != Fingerprint)
+            return nullptr;
+        Hits++;
+        return &Found->second.Body;
+    }
+
+    const std::string& Store(long long TimeMs, uint64_t Fingerprint, const SCString& Body)
+    {
+        Encoded++;
+        auto Inserted = Bars.emplace(TimeMs, s_EncodedBar());
+        s_EncodedBar& Bar = Inserted.first->second;
+        Bar.Fingerprint = Fingerprint;
+        Bar.Body.assign(Body.GetChars(), (size_t)Body.GetLength());
+        if (Inserted.second)
+            Order.push_back(TimeMs);
+        return Bar.Body;
+    }
+
+    // Evicts down to MaxBars. Separate from Store so bodies referenced by a
+    // request being assembled stay valid until it has been sent.
+    void Trim() { Evict(); }
+
+private:
+    std::unordered_map<long long, s_EncodedBar> Bars;
+    std::deque<long long> Order;    // Insertion order, oldest first
+    std::string Symbol;
+    int ChartNumber = 0;
+    int SecondsPerBar = 0;
+
+    static void Mix(uint64_t& Hash, const void* Data, size_t Size)
+    {
+        const unsigned char* Bytes = (const unsigned char*)Data;
+        for (size_t i = 0; i < Size; i++)
+        {
+            Hash ^= Bytes[i];
+            Hash *= 1099511628211ULL;
+        }
+    }
+
+    // Oldest entries go first
+    void Evict()
+    {
+        while ((int)Order.size() > MaxBars)
+        {
+            Bars.erase(Order.front());
+            Order.pop_front();
+        }
+    }
+};
@@ -0,0 +1,346 @@
+// TradeFlow Pro tick-built custom bars
+// Range, volume, tick-count, delta and Renko bars built side by side from the
+// chart's Time & Sales, each trade feeding every enabled type. Each enabled type
+// is its own stream (chart_info.bar_type, stored as the bar's timeframe), so
+// adding a bar type costs one builder rather than another chart. Finished bars
+// queue here until the collector posts them through the batch endpoint.
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "TradeFlow_Pro_TimeAndSales.h"
+
+enum e_CustomBarType
+{
+    CUSTOM_BAR_RANGE = 0,   // Size = range in ticks
+    CUSTOM_BAR_VOLUME,      // Size = contracts per bar
+    CUSTOM_BAR_TICK,        // Size = trades per bar
+    CUSTOM_BAR_DELTA,       // Size = |ask volume - bid volume| that closes the bar
+    CUSTOM_BAR_RENKO,       // Size = brick height in ticks
+    CUSTOM_BAR_TYPE_COUNT
+};
+
+const int CUSTOM_BAR_MAX_PENDING = 10000;   // Oldest finished bars are dropped beyond this
+
+// Backend timeframe labels (market_data.timeframe is VARCHAR(10), which the
+// input limits keep every label within)
+inline SCString CustomBarStreamId(int Type, int Size)
+{
+    switch (Type)
+    {
+    case CUSTOM_BAR_RANGE:  return SCString().Format("range%dt", Size);
+    case CUSTOM_BAR_VOLUME: return SCString().Format("vol%d", Size);
+    case CUSTOM_BAR_TICK:   return SCString().Format("tick%d", Size);
+    case CUSTOM_BAR_DELTA:  return SCString().Format("delta%d", Size);
+    default:                return SCString().Format("renko%dt", Size);
+    }
+}
+
+struct s_CustomBarConfig
+{
+    int Size[CUSTOM_BAR_TYPE_COUNT] = {};  // 0 = type disabled
+
+    bool AnyEnabled() const
+    {
+        for (int t = 0; t < CUSTOM_BAR_TYPE_COUNT; t++)
+            if (Size[t] > 0)
+                return true;
+        return false;
+    }
+
+    bool operator==(const s_CustomBarConfig& Other) const
+    {
+        for (int t = 0; t < CUSTOM_BAR_TYPE_COUNT; t++)
+            if (Size[t] != Other.Size[t])
+                return false;
+        return true;
+    }
+};
+
+struct s_CustomBar
+{
+    int Type = 0;
+    long long StartMs = 0;
+    int OpenTicks = 0;
+    int HighTicks = 0;
+    int LowTicks = 0;
+    int CloseTicks = 0;
+    double Volume = 0;
+    double BidVolume = 0;
+    double AskVolume = 0;
+    int NumberOfTrades = 0;
+    long long Sequence = 0;   // Position in the queue's stream, from 1
+};
+
+// One bar type. Trades are in tick units so range and brick tests are exact.
+struct s_CustomBarBuilder
+{
+    int Type = 0;
+    int Size = 0;
+    bool Active = false;
+    s_CustomBar Bar;
+    long long LastStartMs = -1;
+    int RenkoAnchor = 0;      // Close level of the last brick
+    int RenkoDirection = 0;   // 1 up, -1 down, 0 before the first brick
+    bool RenkoAnchored = false;
+
+    void Add(const s_Trade& Trade, std::deque<s_CustomBar>& Finished)
+    {
+        switch (Type)
+        {
+        case CUSTOM_BAR_RANGE:
+            if (Active && max(Bar.HighTicks, Trade.PriceTicks) - min(Bar.LowTicks, Trade.PriceTicks) > Size)
+                Finish(Finished);
+            if (!Active)
+                Start(Trade);
+            Accumulate(Trade, Trade.Volume, 1);
+            break;
+
+        case CUSTOM_BAR_VOLUME:
+        {
+            // A trade larger than what is left in the bar is split across bars
+            double Remaining = Trade.Volume;
+            int Trades = 1;
+            while (Remaining > 0)
+            {
+                if (!Active)
+                    Start(Trade);
+                double Take = min(Remaining, (double)Size - Bar.Volume);
+                Accumulate(Trade, Take, Trades);
+                Trades = 0;
+                Remaining -= Take;
+                if (Bar.Volume >= Size)
+                    Finish(Finished);
+            }
+            break;
+        }
+
+        case CUSTOM_BAR_TICK:
+            if (!Active)
+                Start(Trade);
+            Accumulate(Trade, Trade.Volume, 1);
+            if (Bar.NumberOfTrades >= Size)
+                Finish(Finished);
+            break;
+
+        case CUSTOM_BAR_DELTA:
+            if (!Active)
+                Start(Trade);
+            Accumulate(Trade, Trade.Volume, 1);
+            if (Bar.AskVolume - Bar.BidVolume >= Size || Bar.BidVolume - Bar.AskVolume >= Size)
+                Finish(Finished);
+            break;
+
+        case CUSTOM_BAR_RENKO:
+            AddRenko(Trade, Finished);
+            break;
+        }
+    }
+
+    void Reset()
+    {
+        Active = false;
+        Bar = s_CustomBar();
+        LastStartMs = -1;
+        RenkoAnchor = 0;
+        RenkoDirection = 0;
+        RenkoAnchored = false;
+    }
+
+private:
+    void Start(const s_Trade& Trade)
+    {
+        Bar = s_CustomBar();
+        Bar.Type = Type;
+        // Bars are keyed by start time, so several bars inside one millisecond
+        // are spread one millisecond apart to keep every key distinct
+        Bar.StartMs = Trade.TimeMs > LastStartMs ? Trade.TimeMs : LastStartMs + 1;
+        Bar.OpenTicks = Bar.HighTicks = Bar.LowTicks = Bar.CloseTicks = Trade.PriceTicks;
+        LastStartMs = Bar.StartMs;
+        Active = true;
+    }
+
+    void Accumulate(const s_Trade& Trade, double Volume, int Trades)
+    {
+        Bar.HighTicks = max(Bar.HighTicks, Trade.PriceTicks);
+        Bar.LowTicks = min(Bar.LowTicks, Trade.PriceTicks);
+        Bar.CloseTicks = Trade.PriceTicks;
+        Bar.Volume += Volume;
+        if (Trade.AtAsk)
+            Bar.AskVolume += Volume;
+        else
+            Bar.BidVolume += Volume;
+        Bar.NumberOfTrades += Trades;
+    }
+
+    void Finish(std::deque<s_CustomBar>& Finished)
+    {
+        Finished.push_back(Bar);
+        Active = false;
+    }
+
+    // Classic bricks: a continuation needs one brick of travel from the last
+    // close, a reversal two. Each brick ships with its level bounds as OHLC and
+    // the volume traded while it formed; extra bricks completed by the same
+    // trade carry no volume.
+    void AddRenko(const s_Trade& Trade, std::deque<s_CustomBar>& Finished)
+    {
+        if (!RenkoAnchored)
+        {
+            RenkoAnchor = Trade.PriceTicks;
+            RenkoAnchored = true;
+        }
+        if (!Active)
+            Start(Trade);
+        Accumulate(Trade, Trade.Volume, 1);
+
+        while (true)
+        {
+            int UpTarget = RenkoAnchor + (RenkoDirection < 0 ? 2 : 1) * Size;
+            int DownTarget = RenkoAnchor - (RenkoDirection > 0 ? 2 : 1) * Size;
+            int Close;
+            if (Trade.PriceTicks >= UpTarget)
+            {
+                Close = UpTarget;
+                RenkoDirection = 1;
+            }
+            else if (Trade.PriceTicks <= DownTarget)
+            {
+                Close = DownTarget;
+                RenkoDirection = -1;
+            }
+            else
+                break;
+
+            if (!Active)
+                Start(Trade);
+            Bar.OpenTicks = Close - RenkoDirection * Size;
+            Bar.CloseTicks = Close;
+            Bar.HighTicks = max(Bar.OpenTicks, Bar.CloseTicks);
+            Bar.LowTicks = min(Bar.OpenTicks, Bar.CloseTicks);
+            Finish(Finished);
+            RenkoAnchor = Close;
+        }
+    }
+};
+
+struct s_CustomBars
+{
+    s_CustomBarConfig Config;
+    s_CustomBarBuilder Builders[CUSTOM_BAR_TYPE_COUNT];
+    std::deque<s_CustomBar> Finished;   // Oldest first, waiting to be sent
+    int InFlight = 0;                   // Leading Finished bars in the pending request
+    int DroppedBars = 0;
+    // Batches carry a stream id made from StreamEpochMs (first trade after a
+    // reset) and the contiguous sequence range of their bars, so the backend
+    // can drop resends
+    long long StreamEpochMs = 0;
+    long long LastSequence = 0;
+
+    void Configure(const s_CustomBarConfig& NewConfig)
+    {
+        if (NewConfig == Config)
+            return;
+        Config = NewConfig;
+        Reset();
+    }
+
+    void Reset()
+    {
+        for (int t = 0; t < CUSTOM_BAR_TYPE_COUNT; t++)
+        {
+            Builders[t].Reset();
+            Builders[t].Type = t;
+            Builders[t].Size = Config.Size[t];
+        }
+        Finished.clear();
+        InFlight = 0;
+        StreamEpochMs = 0;
+        LastSequence = 0;
+    }
+
+    // Feeds one trade to every enabled builder
+    void Add(const s_Trade& Trade)
+    {
+        if (StreamEpochMs == 0)
+            StreamEpochMs = Trade.TimeMs;
+        size_t Queued = Finished.size();
+        for (int t = 0; t < CUSTOM_BAR_TYPE_COUNT; t++)
+        {
+            if (Builders[t].Size > 0)
+                Builders[t].Add(Trade, Finished);
+        }
+        for (size_t i = Queued; i < Finished.size(); i++)
+            Finished[i].Sequence = ++LastSequence;
+    }
+
+    // "SYMBOL:chart:custom:epoch", the stream the queued bars' sequences belong to
+    SCString StreamId(SCStudyInterfaceRef sc) const
+    {
+        return SCString().Format("%s:%d:custom:%lld", sc.Symbol.GetChars(), sc.ChartNumber, StreamEpochMs);
+    }
+
+    // Over the cap, drops the oldest bars that are not part of a pending request
+    void Trim()
+    {
+        while ((int)Finished.size() > CUSTOM_BAR_MAX_PENDING && (int)Finished.size() > InFlight)
+        {
+            Finished.erase(Finished.begin() + InFlight);
+            DroppedBars++;
+        }
+    }
+
+    // Bars stay queued until the backend answers the request carrying them
+    int Acknowledge()
+    {
+        int Sent = min(InFlight, (int)Finished.size());
+        Finished.erase(Finished.begin(), Finished.begin() + Sent);
+        InFlight = 0;
+        return Sent;
+    }
+
+    // Leading bars, at most Max, whose sequences are contiguous (Trim can
+    // leave a gap), so one batch always covers a single sequence range
+    int ContiguousCount(int Max) const
+    {
+        int Count = min(Max, (int)Finished.size());
+        for (int i = 1; i < Count; i++)
+        {
+            if (Finished[i].Sequence != Finished[i - 1].Sequence + 1)
+                return i;
+        }
+        return Count;
+    }
+
+    // Batch payload for the first Count finished bars, in the /batch format
+    SCString CreateBatchJSON(SCStudyInterfaceRef sc, int Count) const
+    {
+        float TickSize = sc.TickSize > 0 ? sc.TickSize : 1.0f;
+        SCString json;
+        json += "{\"data\":[";
+
+        for (int i = 0; i < Count; i++)
+        {
+            const s_CustomBar& Bar = Finished[i];
+            if (i > 0)
+                json += ",";
+            json += "{\"timestamp\":\"";
+            json += FormatTradeFlowTime(Bar.StartMs);
+            json += SCString().Format("\",\"open\":%f,\"high\":%f,\"low\":%f,\"close\":%f",
+                Bar.OpenTicks * TickSize, Bar.HighTicks * TickSize, Bar.LowTicks * TickSize, Bar.CloseTicks * TickSize);
+            json += SCString().Format(",\"volume\":%.0f,\"bid_volume\":%.0f,\"ask_volume\":%.0f,\"number_of_trades\":%d,\"delta\":%.0f",
+                Bar.Volume, Bar.BidVolume, Bar.AskVolume, Bar.NumberOfTrades, Bar.AskVolume - Bar.BidVolume);
+            json += ",\"open_interest\":null,\"chart_info\":{\"symbol\":\"";
+            json += sc.Symbol.GetChars();
+            json += SCString().Format("\",\"chart_number\":%d,\"seconds_per_bar\":0,\"bar_type\":\"", sc.ChartNumber);
+            json += CustomBarStreamId(Bar.Type, Builders[Bar.Type].Size);
+            json += "\"},\"source\":\"sierra_chart_custom_bars\"}";
+        }
+
+        json += "],\"metadata\":{\"source\":\"sierra_chart_custom_bars\",\"collected_at\":\"";
+        json += sc.FormatDateTime(sc.CurrentSystemDateTime).GetChars();
+        json += SCString().Format("\",\"total_bars\":%d}}", Count);
+        return json;
+    }
+};
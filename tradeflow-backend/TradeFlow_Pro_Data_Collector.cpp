@@ -1,6 +1,17 @@
 // The top of every source code file must include this line
 #include "sierrachart.h"
 
+#include "TradeFlow_Pro_BarCache.h"
+#include "TradeFlow_Pro_CustomBars.h"
+#include "TradeFlow_Pro_EncoderPool.h"
+#include "TradeFlow_Pro_Heatmap.h"
+#include "TradeFlow_Pro_LargeTrades.h"
+#include "TradeFlow_Pro_OrderFlow.h"
+#include "TradeFlow_Pro_RawBars.h"
+#include "TradeFlow_Pro_SessionTimes.h"
+#include "TradeFlow_Pro_Slices.h"
+#include "TradeFlow_Pro_StreamingCalcs.h"
+
 // TradeFlow Pro Data Collector for Sierra Chart
 // Sends real-time and historical market data to TradeFlow Pro backend
 SCDLLName("TradeFlow Pro Data Collector")
@@ -18,6 +29,42 @@ struct s_DataCollectionState
     bool HistoricalExportTriggered = false;
     SCDateTime LastExportTime;     // Track time for periodic exports
     bool ManualExportTriggered = false;  // Manual trigger flag
+    s_StreamingCalcs Calcs;        // Per-bar delta/CVD/VWAP/EMA shipped with each bar
+    s_CustomBars CustomBars;       // Range/volume/tick/delta/Renko bars built from Time & Sales
+    s_OrderFlowDetector OrderFlow; // Stacked imbalance/absorption/unfinished auction events
+    s_TimeAndSalesReader Trades;   // Feeds custom bars and large trade detection
+    s_LargeTradeDetector LargeTrades;  // Block trades and icebergs, queued as order flow events
+    s_HeatmapAggregator Heatmap;   // Market depth folded into finished heatmap tiles
+    s_SessionTimes SessionTimes;   // Chart session times for the backend's session calendar
+    s_EncodedBarCache BarCache;    // Encoded closed bars reused by batch mode and exports
+
+    // Batch mode cursor: closed bars up to BatchAckedIndex (bar time
+    // BatchAckedTime) are acknowledged by the backend; BatchInFlightEnd is the
+    // last bar of the pending batch request, -1 when none
+    int BatchAckedIndex = -1;
+    SCDateTime BatchAckedTime;
+    int BatchInFlightEnd = -1;
+    SCDateTime BatchInFlightTime;
+    // Dedupe stream of the cursor: bars acked since it started are numbered
+    // from 1 under a stream id that includes the start bar's time
+    long long BatchEpochMs = 0;
+    long long BatchAckedCount = 0;
+    int BatchInFlightCount = 0;
+
+    // Export dedupe stream: bars numbered from the export's first bar under a
+    // stream id that includes the time it was triggered
+    int HistoricalExportStart = 0;
+    long long HistoricalExportEpochMs = 0;
+
+    // Batch bodies formatted on the shared encoder pool (Encoder Threads > 0):
+    // the pending job's ticket (0 = none) and the range it was captured from
+    bool UsesEncoderPool = false;
+    c_EncoderStream Encoder;
+    uint64_t EncodeTicket = 0;
+    int EncodeStart = -1;
+    int EncodeEnd = -1;
+    SCDateTime EncodeEndTime;
+    std::string EncodeSource;
 
     void Reset()
     {
@@ -31,11 +78,138 @@ struct s_DataCollectionState
         HistoricalExportTriggered = false;
         LastExportTime.Clear();
         ManualExportTriggered = false;
+        CustomBars.Reset();
+        OrderFlow.Reset();
+        Trades.Reset();
+        LargeTrades.Reset();
+        Heatmap.Reset();
+        SessionTimes.Reset();
+        BarCache.Reset();
+        ClearBatchCursor();
+        EncodeTicket = 0;   // A result still in flight is discarded when it arrives
+    }
+
+    void ClearBatchCursor()
+    {
+        BatchAckedIndex = -1;
+        BatchAckedTime.Clear();
+        BatchInFlightEnd = -1;
+        BatchInFlightTime.Clear();
+        BatchEpochMs = 0;
+        BatchAckedCount = 0;
+        BatchInFlightCount = 0;
+    }
+
+    // Queued custom bars, order flow events, heatmap tiles and session times
+    // leave their queues only once the backend answers the request that carried them
+    bool QueuedInFlight() const
+    {
+        return CustomBars.InFlight > 0 || OrderFlow.InFlight > 0 || Heatmap.InFlight > 0 || SessionTimes.InFlight;
+    }
+
+    int AcknowledgeQueued()
+    {
+        return CustomBars.Acknowledge() + OrderFlow.Acknowledge() + Heatmap.Acknowledge() + SessionTimes.Acknowledge();
+    }
+
+    void RetryQueued()
+    {
+        CustomBars.InFlight = 0;
+        OrderFlow.InFlight = 0;
+        Heatmap.InFlight = 0;
+        SessionTimes.Retry();
+        BatchInFlightEnd = -1;  // The batch is resent from the same cursor
     }
 };
 
-// Function to create JSON string for single bar data (TradeFlow format)
-SCString CreateTradeFlowBarJSON(SCStudyInterfaceRef sc, int Index)
+// Index of the bar at Time, or of the newest bar before it when that bar is
+// gone (chart reloaded with different history); -1 when every bar is later
+int FindBarAtOrBefore(SCStudyInterfaceRef sc, const SCDateTime& Time)
+{
+    int Low = 0;
+    int High = sc.ArraySize;
+    while (Low < High)
+    {
+        int Mid = (Low + High) / 2;
+        if (sc.BaseDateTimeIn[Mid] <= Time)
+            Low = Mid + 1;
+        else
+            High = Mid;
+    }
+    return Low - 1;
+}
+
+// Identifies a batch for server-side dedupe: the stream it belongs to and the
+// contiguous sequence range of its bars within that stream
+struct s_BatchSequence
+{
+    SCString Stream;
+    long long First = 0;
+    long long Last = 0;
+};
+
+// POSTs a JSON body to the API endpoint joined with Path ("" for the endpoint
+// itself). Batches with a Sequence carry it in the X-TradeFlow-Stream and
+// X-TradeFlow-Seq headers so a resend is dropped before its body is parsed.
+int PostTradeFlowJSON(SCStudyInterfaceRef sc, const SCString& Endpoint, const SCString& APIKey, const char* Path, const SCString& JSON,
+    const s_BatchSequence* Sequence = nullptr)
+{
+    // Remove trailing slash to avoid double slash
+    SCString baseURL = Endpoint;
+    if (*Path != 0 && baseURL.GetLength() > 0 && baseURL[baseURL.GetLength() - 1] == '/') {
+        baseURL = baseURL.Left(baseURL.GetLength() - 1);
+    }
+    SCString apiURL = baseURL + Path;
+
+    // Prepare headers
+    n_ACSIL::s_HTTPHeader headers[4];
+    int numHeaders = 0;
+
+    if (APIKey.GetLength() > 0)
+    {
+        headers[0].Name = "X-API-Key";
+        headers[0].Value = APIKey;
+        numHeaders++;
+    }
+
+    headers[numHeaders].Name = "Content-Type";
+    headers[numHeaders].Value = "application/json";
+    numHeaders++;
+
+    if (Sequence != nullptr)
+    {
+        headers[numHeaders].Name = "X-TradeFlow-Stream";
+        headers[numHeaders].Value = Sequence->Stream;
+        numHeaders++;
+        headers[numHeaders].Name = "X-TradeFlow-Seq";
+        headers[numHeaders].Value = SCString().Format("%lld-%lld", Sequence->First, Sequence->Last);
+        numHeaders++;
+    }
+
+    return sc.MakeHTTPPOSTRequest(apiURL, JSON, headers, numHeaders);
+}
+
+// True when the backend stored what the request carried: its "status" is
+// "success", "duplicate" (already stored by an earlier send) or "empty".
+// Error bodies (401, 422, 500 ...) carry "detail" instead and are resent.
+bool IsTradeFlowDelivered(const SCString& Response)
+{
+    const char* Status = strstr(Response.GetChars(), "\"status\"");
+    if (Status == nullptr)
+        return false;
+
+    Status += 8;
+    while (*Status == ' ' || *Status == ':')
+        Status++;
+
+    return strncmp(Status, "\"success\"", 9) == 0
+        || strncmp(Status, "\"duplicate\"", 11) == 0
+        || strncmp(Status, "\"empty\"", 7) == 0;
+}
+
+// Bar object up to and including chart_info (TradeFlow format); the caller
+// closes it with CreateTradeFlowBarTail
+SCString CreateTradeFlowBarBody(SCStudyInterfaceRef sc, int Index, const s_StreamingCalcs* Calcs = nullptr)
 {
     SCString json;
     json += "{";
@@ -96,7 +270,7 @@ SCString CreateTradeFlowBarJSON(SCStudyInterfaceRef sc, int Index)
     if (sc.NumberOfTrades.GetArraySize() > 0 && sc.NumberOfTrades[Index] != 0)
     {
         json += "\"number_of_trades\":";
-        json += SCString().Format("%d", sc.NumberOfTrades[Index]);
+        json += SCString().Format("%d", (int)sc.NumberOfTrades[Index]);
         json += ",";
     }
     else
@@ -116,6 +290,10 @@ SCString CreateTradeFlowBarJSON(SCStudyInterfaceRef sc, int Index)
         json += "\"open_interest\":null,";
     }
 
+    // Collector-side calculations (only the enabled ones are emitted)
+    if (Calcs != nullptr)
+        Calcs->AppendJSON(json, Index);
+
     // Chart info (Nested object to match Pydantic model)
     json += "\"chart_info\":{";
     
@@ -132,7 +310,14 @@ SCString CreateTradeFlowBarJSON(SCStudyInterfaceRef sc, int Index)
     
     json += "}"; // End chart_info
 
-    // Data source metadata (Root level)
+    return json;
+}
+
+// Data source metadata (root level) and the end of the bar object; the same
+// for every bar of a request
+SCString CreateTradeFlowBarTail(SCStudyInterfaceRef sc)
+{
+    SCString json;
     json += ",\"source\":\"sierra_chart\"";
     json += ",\"collected_at\":\"";
     json += sc.FormatDateTime(sc.CurrentSystemDateTime).GetChars();
@@ -142,34 +327,262 @@ SCString CreateTradeFlowBarJSON(SCStudyInterfaceRef sc, int Index)
     return json;
 }
 
-// Function to create JSON array for multiple bars (TradeFlow batch format)
-SCString CreateTradeFlowBatchJSON(SCStudyInterfaceRef sc, int StartIndex, int EndIndex, const char* DataSource = "sierra_chart_historical")
+// Function to create JSON string for single bar data (TradeFlow format)
+SCString CreateTradeFlowBarJSON(SCStudyInterfaceRef sc, int Index, const s_StreamingCalcs* Calcs = nullptr)
 {
-    SCString json;
-    json += "{\"data\":[";
+    SCString json = CreateTradeFlowBarBody(sc, Index, Calcs);
+    json += CreateTradeFlowBarTail(sc);
+    return json;
+}
+
+// Describes a batch (TradeFlow batch format) as slices into Out: the envelope,
+// each bar's body and the shared per-request tail. With a Cache, closed bars
+// whose values are unchanged since they were last encoded are referenced in the
+// cache instead of being formatted again; the caller trims the cache once the
+// slices have been sent or flattened.
+void CreateTradeFlowBatchSlices(SCStudyInterfaceRef sc, int StartIndex, int EndIndex, const char* DataSource,
+    const s_StreamingCalcs* Calcs, s_EncodedBarCache* Cache, s_TradeFlowSlices& Out)
+{
+    if (Cache != nullptr && Cache->Enabled())
+        Cache->Begin(sc);
+    else
+        Cache = nullptr;
+
+    Out.Clear();
+    Out.Add("{\"data\":[", 9);
+
+    SCString Tail = CreateTradeFlowBarTail(sc);
+    Out.Owned.push_back(std::string(Tail.GetChars(), (size_t)Tail.GetLength()) + ",");
+    const std::string& TailComma = Out.Owned.back();
+    Out.Owned.push_back(TailComma.substr(0, TailComma.size() - 1));
+    const std::string& LastTail = Out.Owned.back();
 
     for (int i = StartIndex; i <= EndIndex; i++)
     {
-        if (i > StartIndex)
-            json += ",";
-        json += CreateTradeFlowBarJSON(sc, i);
+        // The forming bar changes on every trade and is never cached
+        if (Cache != nullptr && i < sc.ArraySize - 1)
+        {
+            long long TimeMs = DateTimeToMs(sc.BaseDateTimeIn[i]);
+            uint64_t Fingerprint = s_EncodedBarCache::Fingerprint(sc, i, Calcs);
+            const std::string* Body = Cache->Find(TimeMs, Fingerprint);
+            if (Body == nullptr)
+                Body = &Cache->Store(TimeMs, Fingerprint, CreateTradeFlowBarBody(sc, i, Calcs));
+            Out.Add(*Body);
+        }
+        else
+        {
+            SCString Body = CreateTradeFlowBarBody(sc, i, Calcs);
+            Out.Own(std::string(Body.GetChars(), (size_t)Body.GetLength()));
+        }
+        Out.Add(i < EndIndex ? TailComma : LastTail);
     }
 
-    json += "],";
-    json += "\"metadata\":{";
-    json += "\"source\":\"";
-    json += DataSource;
-    json += "\",";
-    json += "\"collected_at\":\"";
-    json += sc.FormatDateTime(sc.CurrentSystemDateTime).GetChars();
-    json += "\",";
-    json += "\"total_bars\":";
-    json += SCString().Format("%d", (EndIndex - StartIndex + 1));
-    json += "\"}}";
+    SCString Metadata;
+    Metadata += "],";
+    Metadata += "\"metadata\":{";
+    Metadata += "\"source\":\"";
+    Metadata += DataSource;
+    Metadata += "\",";
+    Metadata += "\"collected_at\":\"";
+    Metadata += sc.FormatDateTime(sc.CurrentSystemDateTime).GetChars();
+    Metadata += "\",";
+    Metadata += "\"total_bars\":";
+    Metadata += SCString().Format("%d", (EndIndex - StartIndex + 1));
+    Metadata += "}}";
+    Out.Own(std::string(Metadata.GetChars(), (size_t)Metadata.GetLength()));
+}
 
+// Function to create JSON array for multiple bars (TradeFlow batch format),
+// flattened once from its slices for sc.MakeHTTPPOSTRequest
+SCString CreateTradeFlowBatchJSON(SCStudyInterfaceRef sc, int StartIndex, int EndIndex, const char* DataSource = "sierra_chart_historical",
+    const s_StreamingCalcs* Calcs = nullptr, s_EncodedBarCache* Cache = nullptr)
+{
+    s_TradeFlowSlices Slices;
+    CreateTradeFlowBatchSlices(sc, StartIndex, EndIndex, DataSource, Calcs, Cache, Slices);
+    SCString json = Slices.Flatten();
+    if (Cache != nullptr)
+        Cache->Trim();
     return json;
 }
 
+static_assert(RAW_BAR_MAX_EMAS == TRADEFLOW_MAX_EMAS, "s_RawBar carries every EMA slot");
+
+// Shared by every collector instance in the DLL; started by the first
+// instance that turns Encoder Threads on and stopped with the last one
+c_EncoderPool& TradeFlowEncoderPool()
+{
+    static c_EncoderPool Pool;
+    return Pool;
+}
+
+// Copies what CreateTradeFlowBatchJSON reads for bars StartIndex..EndIndex,
+// so EncodeTradeFlowBatch can format it on another thread
+void CaptureTradeFlowBatch(SCStudyInterfaceRef sc, int StartIndex, int EndIndex, const char* DataSource,
+    const s_StreamingCalcs* Calcs, s_RawBarBatch& Out)
+{
+    Out.Symbol = sc.Symbol.GetChars();
+    Out.ChartNumber = sc.ChartNumber;
+    Out.SecondsPerBar = sc.SecondsPerBar;
+    Out.DataSource = DataSource;
+    Out.CollectedAt = sc.FormatDateTime(sc.CurrentSystemDateTime).GetChars();
+    if (Calcs != nullptr)
+    {
+        Out.Delta = Calcs->Config.Delta;
+        Out.CVD = Calcs->Config.CVD;
+        Out.VWAP = Calcs->Config.VWAP;
+        for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+            Out.EMAPeriods[e] = Calcs->Config.EMAPeriods[e];
+    }
+
+    bool HasBidVolume = sc.BaseDataIn[SC_BIDVOL].GetArraySize() > 0;
+    bool HasAskVolume = sc.BaseDataIn[SC_ASKVOL].GetArraySize() > 0;
+    bool HasOpenInterest = sc.BaseDataIn[SC_OPEN_INTEREST].GetArraySize() > 0;
+    bool HasTrades = sc.NumberOfTrades.GetArraySize() > 0;
+
+    Out.Bars.resize((size_t)(EndIndex - StartIndex + 1));
+    for (int i = StartIndex; i <= EndIndex; i++)
+    {
+        s_RawBar& Bar = Out.Bars[(size_t)(i - StartIndex)];
+        Bar.TimeMs = DateTimeToMs(sc.BaseDateTimeIn[i]);
+        Bar.Open = sc.BaseDataIn[SC_OPEN][i];
+        Bar.High = sc.BaseDataIn[SC_HIGH][i];
+        Bar.Low = sc.BaseDataIn[SC_LOW][i];
+        Bar.Close = sc.BaseDataIn[SC_LAST][i];
+        Bar.Volume = sc.BaseDataIn[SC_VOLUME][i];
+        Bar.BidVolume = HasBidVolume ? sc.BaseDataIn[SC_BIDVOL][i] : 0.0f;
+        Bar.AskVolume = HasAskVolume ? sc.BaseDataIn[SC_ASKVOL][i] : 0.0f;
+        Bar.OpenInterest = HasOpenInterest ? sc.BaseDataIn[SC_OPEN_INTEREST][i] : 0.0f;
+        Bar.Trades = HasTrades ? (int)sc.NumberOfTrades[i] : 0;
+
+        Bar.HasCalcs = Calcs != nullptr && Calcs->HasValues(i);
+        if (!Bar.HasCalcs)
+            continue;
+        if (Out.Delta)
+            Bar.Delta = Calcs->Delta[i];
+        if (Out.CVD)
+            Bar.CVD = Calcs->CVD[i];
+        if (Out.VWAP)
+        {
+            double Band = Calcs->VWAPStdDev(i) * Calcs->Config.VWAPBandMultiplier;
+            Bar.VWAP = Calcs->VWAP(i);
+            Bar.VWAPUpper = Bar.VWAP + Band;
+            Bar.VWAPLower = Bar.VWAP - Band;
+        }
+        for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+        {
+            if (Out.EMAPeriods[e] > 0)
+                Bar.EMA[e] = Calcs->EMA[e][i];
+        }
+    }
+}
+
+// Batch body for StartIndex..EndIndex. Without the encoder pool it is
+// formatted here (through the bar cache) and always ready. With the pool, the
+// first call for a range captures the bars and submits them, and a later call
+// returns true once the body is back; a result for a range that has since
+// been replaced (cursor moved, chart reloaded) is discarded.
+bool TradeFlowBatchBody(SCStudyInterfaceRef sc, s_DataCollectionState* p_State, int StartIndex, int EndIndex,
+    const char* DataSource, SCString& json)
+{
+    if (!p_State->UsesEncoderPool)
+    {
+        json = CreateTradeFlowBatchJSON(sc, StartIndex, EndIndex, DataSource, &p_State->Calcs, &p_State->BarCache);
+        return true;
+    }
+
+    if (p_State->EncodeTicket == 0 || p_State->EncodeStart != StartIndex || p_State->EncodeEnd != EndIndex
+        || p_State->EncodeEndTime != sc.BaseDateTimeIn[EndIndex] || p_State->EncodeSource != DataSource)
+    {
+        std::shared_ptr<s_RawBarBatch> Batch = std::make_shared<s_RawBarBatch>();
+        CaptureTradeFlowBatch(sc, StartIndex, EndIndex, DataSource, &p_State->Calcs, *Batch);
+        p_State->EncodeTicket = p_State->Encoder.Submit(TradeFlowEncoderPool(),
+            [Batch](std::string& Buffer) { EncodeTradeFlowBatch(*Batch, Buffer); });
+        p_State->EncodeStart = StartIndex;
+        p_State->EncodeEnd = EndIndex;
+        p_State->EncodeEndTime = sc.BaseDateTimeIn[EndIndex];
+        p_State->EncodeSource = DataSource;
+    }
+
+    std::string Body;
+    uint64_t Ticket = 0;
+    while (p_State->Encoder.Poll(Body, Ticket))
+    {
+        if (Ticket != p_State->EncodeTicket)
+            continue;
+        p_State->EncodeTicket = 0;
+        json = Body.c_str();
+        return true;
+    }
+    return false;
+}
+
+// Indexes move when the chart reloads or trims: finds the acked bar by time
+void LocateTradeFlowBatchCursor(SCStudyInterfaceRef sc, s_DataCollectionState* p_State)
+{
+    if (p_State->BatchAckedIndex < 0 || p_State->BatchAckedIndex >= sc.ArraySize
+        || sc.BaseDateTimeIn[p_State->BatchAckedIndex] != p_State->BatchAckedTime)
+        p_State->BatchAckedIndex = FindBarAtOrBefore(sc, p_State->BatchAckedTime);
+}
+
+// Posts the closed bars after the acked cursor through EndIndex as the next
+// batch of the cursor's dedupe stream. False while the body is still on the
+// encoder pool or when the request could not be made.
+bool PostTradeFlowBatch(SCStudyInterfaceRef sc, s_DataCollectionState* p_State, int EndIndex,
+    const SCString& Endpoint, const SCString& APIKey)
+{
+    int StartIndex = p_State->BatchAckedIndex + 1;
+    int Count = EndIndex - StartIndex + 1;
+    SCString jsonData;
+    if (Count <= 0 || !TradeFlowBatchBody(sc, p_State, StartIndex, EndIndex, "sierra_chart_batch", jsonData))
+        return false;
+
+    s_BatchSequence Sequence;
+    Sequence.Stream = SCString().Format("%s:%d:%d:batch:%lld", sc.Symbol.GetChars(), sc.ChartNumber, sc.SecondsPerBar, p_State->BatchEpochMs);
+    Sequence.First = p_State->BatchAckedCount + 1;
+    Sequence.Last = p_State->BatchAckedCount + Count;
+    int result = PostTradeFlowJSON(sc, Endpoint, APIKey, "/batch", jsonData, &Sequence);
+
+    if (result <= 0)
+    {
+        p_State->FailedRequests++;
+        sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Failed to send batch data. Error code: %d", result), 1);
+        return false;
+    }
+
+    p_State->RequestState = 1;  // Request made
+    p_State->BatchInFlightCount = Count;
+    p_State->BatchInFlightEnd = EndIndex;
+    p_State->BatchInFlightTime = sc.BaseDateTimeIn[EndIndex];
+    sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Sent batch of bars %d to %d (%d closed bars behind)",
+        StartIndex, EndIndex, sc.ArraySize - 2 - EndIndex), 0);
+    return true;
+}
+
+// Leaving batch mode: the closed bars past the acked cursor still go out, in
+// batches of at most BatchSize with the last one partial, and only then is the
+// cursor cleared. Sending then continues after the last batched bar.
+void FlushTradeFlowBatch(SCStudyInterfaceRef sc, s_DataCollectionState* p_State, int BatchSize,
+    const SCString& Endpoint, const SCString& APIKey)
+{
+    if (p_State->RequestState != 0 || p_State->BatchInFlightEnd >= 0)
+        return;  // The pending request's response moves the cursor first
+
+    LocateTradeFlowBatchCursor(sc, p_State);
+    int LastClosedIndex = sc.ArraySize - 2;
+    if (p_State->BatchAckedIndex >= 0 && p_State->BatchAckedIndex < LastClosedIndex)
+    {
+        PostTradeFlowBatch(sc, p_State, min(p_State->BatchAckedIndex + BatchSize, LastClosedIndex), Endpoint, APIKey);
+        return;
+    }
+
+    if (p_State->BatchAckedIndex >= 0)
+    {
+        p_State->LastSentIndex = p_State->BatchAckedIndex;
+        p_State->LastBarDateTime = p_State->BatchAckedTime;
+    }
+    p_State->ClearBatchCursor();
+}
+
 /*============================================================================
     Main TradeFlow Pro Data Collector Study Function
 ----------------------------------------------------------------------------*/
@@ -188,6 +601,35 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
     SCInputRef Input_SendImmediately = sc.Input[8];
     SCInputRef Input_HistoricalBarsCount = sc.Input[9];
     SCInputRef Input_ManualExportTrigger = sc.Input[10];
+    SCInputRef Input_CalcDelta = sc.Input[11];
+    SCInputRef Input_CalcCVD = sc.Input[12];
+    SCInputRef Input_CalcVWAP = sc.Input[13];
+    SCInputRef Input_VWAPBandMultiplier = sc.Input[14];
+    SCInputRef Input_EMA1Period = sc.Input[15];
+    SCInputRef Input_EMA2Period = sc.Input[16];
+    SCInputRef Input_EMA3Period = sc.Input[17];
+    SCInputRef Input_RangeBarTicks = sc.Input[18];
+    SCInputRef Input_VolumeBarSize = sc.Input[19];
+    SCInputRef Input_TickBarTrades = sc.Input[20];
+    SCInputRef Input_DeltaBarSize = sc.Input[21];
+    SCInputRef Input_RenkoBrickTicks = sc.Input[22];
+    SCInputRef Input_DetectOrderFlow = sc.Input[23];
+    SCInputRef Input_ImbalanceRatio = sc.Input[24];
+    SCInputRef Input_MinImbalanceVolume = sc.Input[25];
+    SCInputRef Input_StackedLevels = sc.Input[26];
+    SCInputRef Input_AbsorptionMultiple = sc.Input[27];
+    SCInputRef Input_DetectLargeTrades = sc.Input[28];
+    SCInputRef Input_LargeTradePercentile = sc.Input[29];
+    SCInputRef Input_MinBlockSize = sc.Input[30];
+    SCInputRef Input_ClusterWindowMs = sc.Input[31];
+    SCInputRef Input_IcebergRefills = sc.Input[32];
+    SCInputRef Input_MinIcebergPrints = sc.Input[33];
+    SCInputRef Input_SendHeatmap = sc.Input[34];
+    SCInputRef Input_HeatmapDepthLevels = sc.Input[35];
+    SCInputRef Input_HeatmapColumnSeconds = sc.Input[36];
+    SCInputRef Input_BarCacheSize = sc.Input[37];
+    SCInputRef Input_EncoderThreads = sc.Input[38];
+    SCInputRef Input_SendSessionTimes = sc.Input[39];
 
     // Subgraph references
     SCSubgraphRef Subgraph_Status = sc.Subgraph[0];
@@ -246,6 +688,124 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
         Input_ManualExportTrigger.Name = "Manual Export Trigger";
         Input_ManualExportTrigger.SetYesNo(0);  // Disabled by default
 
+        Input_CalcDelta.Name = "Send Bar Delta";
+        Input_CalcDelta.SetYesNo(0);
+
+        Input_CalcCVD.Name = "Send Session CVD";
+        Input_CalcCVD.SetYesNo(0);
+
+        Input_CalcVWAP.Name = "Send Session VWAP with Bands";
+        Input_CalcVWAP.SetYesNo(0);
+
+        Input_VWAPBandMultiplier.Name = "VWAP Band Std Dev Multiplier";
+        Input_VWAPBandMultiplier.SetFloat(2.0f);
+        Input_VWAPBandMultiplier.SetFloatLimits(0.1f, 10.0f);
+
+        Input_EMA1Period.Name = "Send EMA 1 Period (0 = off)";
+        Input_EMA1Period.SetInt(0);
+        Input_EMA1Period.SetIntLimits(0, 1000);
+
+        Input_EMA2Period.Name = "Send EMA 2 Period (0 = off)";
+        Input_EMA2Period.SetInt(0);
+        Input_EMA2Period.SetIntLimits(0, 1000);
+
+        Input_EMA3Period.Name = "Send EMA 3 Period (0 = off)";
+        Input_EMA3Period.SetInt(0);
+        Input_EMA3Period.SetIntLimits(0, 1000);
+
+        // Custom bars are built from Time & Sales and sent as their own streams
+        Input_RangeBarTicks.Name = "Send Range Bars, Ticks (0 = off)";
+        Input_RangeBarTicks.SetInt(0);
+        Input_RangeBarTicks.SetIntLimits(0, 1000);
+
+        Input_VolumeBarSize.Name = "Send Volume Bars, Contracts (0 = off)";
+        Input_VolumeBarSize.SetInt(0);
+        Input_VolumeBarSize.SetIntLimits(0, 9999999);
+
+        Input_TickBarTrades.Name = "Send Tick Bars, Trades (0 = off)";
+        Input_TickBarTrades.SetInt(0);
+        Input_TickBarTrades.SetIntLimits(0, 999999);
+
+        Input_DeltaBarSize.Name = "Send Delta Bars, Contracts (0 = off)";
+        Input_DeltaBarSize.SetInt(0);
+        Input_DeltaBarSize.SetIntLimits(0, 99999);
+
+        Input_RenkoBrickTicks.Name = "Send Renko Bars, Brick Ticks (0 = off)";
+        Input_RenkoBrickTicks.SetInt(0);
+        Input_RenkoBrickTicks.SetIntLimits(0, 1000);
+
+        // Order flow events are detected from the volume-at-price ladder, which
+        // is only maintained while they are enabled (set below)
+        Input_DetectOrderFlow.Name = "Send Order Flow Events";
+        Input_DetectOrderFlow.SetYesNo(0);
+
+        Input_ImbalanceRatio.Name = "Diagonal Imbalance Ratio";
+        Input_ImbalanceRatio.SetFloat(3.0f);
+        Input_ImbalanceRatio.SetFloatLimits(1.0f, 100.0f);
+
+        Input_MinImbalanceVolume.Name = "Min Imbalance Volume";
+        Input_MinImbalanceVolume.SetInt(10);
+        Input_MinImbalanceVolume.SetIntLimits(1, 1000000);
+
+        Input_StackedLevels.Name = "Stacked Imbalance Levels";
+        Input_StackedLevels.SetInt(3);
+        Input_StackedLevels.SetIntLimits(2, 20);
+
+        Input_AbsorptionMultiple.Name = "Absorption Volume Multiple";
+        Input_AbsorptionMultiple.SetFloat(3.0f);
+        Input_AbsorptionMultiple.SetFloatLimits(1.0f, 50.0f);
+
+        // Large trades and icebergs are detected on individual Time & Sales prints
+        Input_DetectLargeTrades.Name = "Send Large Trade and Iceberg Events";
+        Input_DetectLargeTrades.SetYesNo(0);
+
+        Input_LargeTradePercentile.Name = "Large Trade Size Percentile";
+        Input_LargeTradePercentile.SetFloat(99.5f);
+        Input_LargeTradePercentile.SetFloatLimits(90.0f, 99.99f);
+
+        Input_MinBlockSize.Name = "Min Large Trade Size";
+        Input_MinBlockSize.SetInt(10);
+        Input_MinBlockSize.SetIntLimits(1, 1000000);
+
+        Input_ClusterWindowMs.Name = "Iceberg Cluster Window (ms)";
+        Input_ClusterWindowMs.SetInt(1000);
+        Input_ClusterWindowMs.SetIntLimits(10, 60000);
+
+        Input_IcebergRefills.Name = "Iceberg Volume vs Displayed Size";
+        Input_IcebergRefills.SetFloat(3.0f);
+        Input_IcebergRefills.SetFloatLimits(1.0f, 100.0f);
+
+        Input_MinIcebergPrints.Name = "Iceberg Min Prints";
+        Input_MinIcebergPrints.SetInt(3);
+        Input_MinIcebergPrints.SetIntLimits(2, 1000);
+
+        // Heatmap tiles are aggregated from market depth; only finished tiles are sent
+        Input_SendHeatmap.Name = "Send Liquidity Heatmap Tiles";
+        Input_SendHeatmap.SetYesNo(0);
+
+        Input_HeatmapDepthLevels.Name = "Heatmap Depth Levels per Side";
+        Input_HeatmapDepthLevels.SetInt(20);
+        Input_HeatmapDepthLevels.SetIntLimits(1, 1000);
+
+        Input_HeatmapColumnSeconds.Name = "Heatmap Column Seconds";
+        Input_HeatmapColumnSeconds.SetInt(1);
+        Input_HeatmapColumnSeconds.SetIntLimits(1, 60);
+
+        Input_BarCacheSize.Name = "Encoded Bar Cache Size (0 = Off)";
+        Input_BarCacheSize.SetInt(10000);  // Covers the largest historical export
+        Input_BarCacheSize.SetIntLimits(0, 1000000);
+
+        // Batch and export bodies are formatted on a pool shared by every
+        // chart; the first chart to turn it on sets the thread count
+        Input_EncoderThreads.Name = "Encoder Threads (0 = Encode on Chart Thread)";
+        Input_EncoderThreads.SetInt(0);
+        Input_EncoderThreads.SetIntLimits(0, ENCODER_MAX_THREADS);
+
+        // The backend builds the symbol's volume profile and TPO sessions
+        // from these unless a session calendar is configured for it
+        Input_SendSessionTimes.Name = "Send Chart Session Times";
+        Input_SendSessionTimes.SetYesNo(1);
+
         // Subgraph configuration
         Subgraph_Status.Name = "Status";
         Subgraph_Status.DrawStyle = DRAWSTYLE_HIDDEN;
@@ -259,6 +819,19 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
         return;
     }
 
+    // Release state when the study is removed or the chart is closed
+    if (sc.LastCallToFunction)
+    {
+        if (p_State != nullptr)
+        {
+            if (p_State->UsesEncoderPool)
+                TradeFlowEncoderPool().Release();
+            delete p_State;
+            sc.SetPersistentPointer(0, nullptr);
+        }
+        return;
+    }
+
     // Initialize state on first run
     if (p_State == nullptr)
     {
@@ -275,9 +848,71 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
         }
     }
 
+    // Keep collector-side calculations current. This runs even while collection
+    // is disabled so values are ready for every bar once sending starts.
+    s_StreamingCalcConfig CalcConfig;
+    CalcConfig.Delta = Input_CalcDelta.GetYesNo() != 0;
+    CalcConfig.CVD = Input_CalcCVD.GetYesNo() != 0;
+    CalcConfig.VWAP = Input_CalcVWAP.GetYesNo() != 0;
+    CalcConfig.VWAPBandMultiplier = Input_VWAPBandMultiplier.GetFloat();
+    CalcConfig.EMAPeriods[0] = Input_EMA1Period.GetInt();
+    CalcConfig.EMAPeriods[1] = Input_EMA2Period.GetInt();
+    CalcConfig.EMAPeriods[2] = Input_EMA3Period.GetInt();
+    p_State->Calcs.Configure(CalcConfig);
+    p_State->Calcs.Update(sc, sc.Index);
+
+    s_CustomBarConfig CustomBarConfig;
+    CustomBarConfig.Size[CUSTOM_BAR_RANGE] = Input_RangeBarTicks.GetInt();
+    CustomBarConfig.Size[CUSTOM_BAR_VOLUME] = Input_VolumeBarSize.GetInt();
+    CustomBarConfig.Size[CUSTOM_BAR_TICK] = Input_TickBarTrades.GetInt();
+    CustomBarConfig.Size[CUSTOM_BAR_DELTA] = Input_DeltaBarSize.GetInt();
+    CustomBarConfig.Size[CUSTOM_BAR_RENKO] = Input_RenkoBrickTicks.GetInt();
+    p_State->CustomBars.Configure(CustomBarConfig);
+
+    s_OrderFlowConfig OrderFlowConfig;
+    OrderFlowConfig.Enabled = Input_DetectOrderFlow.GetYesNo() != 0;
+    OrderFlowConfig.ImbalanceRatio = Input_ImbalanceRatio.GetFloat();
+    OrderFlowConfig.MinImbalanceVolume = (float)Input_MinImbalanceVolume.GetInt();
+    OrderFlowConfig.StackedLevels = Input_StackedLevels.GetInt();
+    OrderFlowConfig.AbsorptionMultiple = Input_AbsorptionMultiple.GetFloat();
+    p_State->OrderFlow.Configure(OrderFlowConfig);
+    sc.MaintainVolumeAtPriceData = OrderFlowConfig.Enabled ? 1 : 0;
+
+    s_LargeTradeConfig LargeTradeConfig;
+    LargeTradeConfig.Enabled = Input_DetectLargeTrades.GetYesNo() != 0;
+    LargeTradeConfig.Percentile = Input_LargeTradePercentile.GetFloat();
+    LargeTradeConfig.MinBlockSize = Input_MinBlockSize.GetInt();
+    LargeTradeConfig.ClusterWindowMs = Input_ClusterWindowMs.GetInt();
+    LargeTradeConfig.IcebergRefills = Input_IcebergRefills.GetFloat();
+    LargeTradeConfig.MinIcebergPrints = Input_MinIcebergPrints.GetInt();
+    p_State->LargeTrades.Configure(LargeTradeConfig);
+
+    s_HeatmapConfig HeatmapConfig;
+    HeatmapConfig.Enabled = Input_SendHeatmap.GetYesNo() != 0;
+    HeatmapConfig.DepthLevels = Input_HeatmapDepthLevels.GetInt();
+    HeatmapConfig.ColumnSeconds = Input_HeatmapColumnSeconds.GetInt();
+    p_State->Heatmap.Configure(HeatmapConfig);
+    sc.UsesMarketDepthData = HeatmapConfig.Enabled ? 1 : 0;
+
+    p_State->BarCache.Configure(Input_BarCacheSize.GetInt());
+
+    bool UseEncoderPool = Input_EncoderThreads.GetInt() > 0;
+    if (UseEncoderPool != p_State->UsesEncoderPool)
+    {
+        if (UseEncoderPool)
+            TradeFlowEncoderPool().Acquire(Input_EncoderThreads.GetInt());
+        else
+            TradeFlowEncoderPool().Release();
+        p_State->UsesEncoderPool = UseEncoderPool;
+        p_State->EncodeTicket = 0;
+    }
+
     // Handle mode switching - reset conflicting state variables
     int CurrentSendMode = Input_SendMode.GetIndex();
 
+    // The batch cursor outlives a switch away from batch mode until its
+    // remaining closed bars are flushed (below, once any response is handled)
+
     if (CurrentSendMode == 0)  // Real-time mode
     {
         // Force cleanup of ALL historical mode state when switching to real-time
@@ -316,6 +951,7 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
         {
             sc.HTTPRequestID = 0;
             p_State->RequestState = 0;
+            p_State->RetryQueued();
             sc.AddMessageToLog("TradeFlow Pro: Disabled - cleared HTTP request state", 0);
         }
 
@@ -325,6 +961,12 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
             p_State->Reset();
         }
 
+        p_State->CustomBars.Reset();
+        p_State->OrderFlow.Reset();
+        p_State->Trades.Reset();
+        p_State->LargeTrades.Reset();
+        p_State->Heatmap.Reset();
+        p_State->SessionTimes.Reset();
         Subgraph_Status[sc.Index] = 0;  // Status = disabled
         return;
     }
@@ -338,13 +980,28 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
             p_State->LastAPIResponse = sc.HTTPResponse;
 
             // Log response
-            if (sc.HTTPResponse.GetLength() > 0)
+            if (sc.HTTPResponse.GetLength() > 0 && IsTradeFlowDelivered(sc.HTTPResponse))
             {
                 sc.AddMessageToLog(SCString().Format("TradeFlow Pro: API Response: %s", sc.HTTPResponse.GetChars()), 0);
                 p_State->FailedRequests = 0;
 
                 // Move historical export index FORWARD if in historical mode
-                if (Input_SendMode.GetIndex() == 2 && (p_State->HistoricalExportTriggered || p_State->ManualExportTriggered))
+                if (p_State->QueuedInFlight())
+                {
+                    // The response was for custom bars or events, not an export batch
+                    p_State->TotalBarsSent += p_State->CustomBars.InFlight;
+                    p_State->AcknowledgeQueued();
+                }
+                else if (p_State->BatchInFlightEnd >= 0)
+                {
+                    // Batch mode: the cursor only moves once the backend has the bars
+                    p_State->TotalBarsSent += p_State->BatchInFlightCount;
+                    p_State->BatchAckedCount += p_State->BatchInFlightCount;
+                    p_State->BatchAckedIndex = p_State->BatchInFlightEnd;
+                    p_State->BatchAckedTime = p_State->BatchInFlightTime;
+                    p_State->BatchInFlightEnd = -1;
+                }
+                else if (Input_SendMode.GetIndex() == 2 && (p_State->HistoricalExportTriggered || p_State->ManualExportTriggered))
                 {
                     int BatchSize = 100;  // TradeFlow optimized batch size
                     int NextIndex = p_State->HistoricalExportIndex + BatchSize;
@@ -367,9 +1024,18 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
                     }
                 }
             }
+            else if (sc.HTTPResponse.GetLength() > 0)
+            {
+                // Rejected or failed on the server: nothing moves forward
+                p_State->FailedRequests++;
+                p_State->RetryQueued();
+                sc.AddMessageToLog(SCString().Format("TradeFlow Pro: API error response: %s. Failed attempts: %d",
+                    sc.HTTPResponse.GetChars(), p_State->FailedRequests), 1);
+            }
             else
             {
                 p_State->FailedRequests++;
+                p_State->RetryQueued();
                 sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Empty API response. Failed attempts: %d", p_State->FailedRequests), 1);
             }
 
@@ -380,6 +1046,7 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
             // Request timed out or failed
             p_State->RequestState = 0;
             p_State->FailedRequests++;
+            p_State->RetryQueued();
             sc.AddMessageToLog(SCString().Format("TradeFlow Pro: HTTP request timed out. Failed attempts: %d", p_State->FailedRequests), 1);
         }
     }
@@ -388,16 +1055,59 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
         // Reset state if we've been stuck in response state
         sc.AddMessageToLog("TradeFlow Pro: Resetting stuck request state", 1);
         p_State->RequestState = 0;
+        p_State->RetryQueued();
         sc.HTTPRequestID = 0;
     }
 
     // Data collection logic
     Subgraph_Status[sc.Index] = 1;  // Status = active
 
+    // Feed the trades since the last call to custom bars and large trade
+    // detection. Time & Sales is chart-wide, so one pass on the newest bar
+    // covers every consumer.
+    if (sc.Index == sc.ArraySize - 1 &&
+        (p_State->CustomBars.Config.AnyEnabled() || p_State->LargeTrades.Config.Enabled))
+    {
+        int Dropped = p_State->CustomBars.DroppedBars;
+        p_State->Trades.Read(sc, [p_State](const s_Trade& Trade)
+        {
+            p_State->CustomBars.Add(Trade);
+            p_State->LargeTrades.Add(Trade, p_State->OrderFlow);
+        });
+        p_State->CustomBars.Trim();
+        if (p_State->CustomBars.DroppedBars != Dropped)
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Custom bar queue full - dropped %d oldest bars",
+                p_State->CustomBars.DroppedBars - Dropped), 1);
+    }
+
+    // Fold the current book into the forming heatmap columns
+    if (sc.Index == sc.ArraySize - 1 && p_State->Heatmap.Config.Enabled)
+    {
+        int DroppedTiles = p_State->Heatmap.DroppedTiles;
+        p_State->Heatmap.Sample(sc);
+        p_State->Heatmap.Trim();
+        if (p_State->Heatmap.DroppedTiles != DroppedTiles)
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Heatmap tile queue full - dropped %d oldest tiles",
+                p_State->Heatmap.DroppedTiles - DroppedTiles), 1);
+    }
+
+    // Scan the updated bar's ladder for order flow events
+    int DroppedEvents = p_State->OrderFlow.DroppedEvents;
+    p_State->OrderFlow.Update(sc, sc.Index);
+    p_State->OrderFlow.Trim();
+    if (p_State->OrderFlow.DroppedEvents != DroppedEvents)
+        sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Order flow event queue full - dropped %d oldest events",
+            p_State->OrderFlow.DroppedEvents - DroppedEvents), 1);
+
     // Determine send mode and logic
     int SendMode = Input_SendMode.GetIndex();
 
-    if (SendMode == 0)  // Real-time mode - send new bars only
+    if (SendMode != 1 && !p_State->BatchAckedTime.IsUnset())
+    {
+        // Leaving batch mode: the new mode starts once the batch is flushed
+        FlushTradeFlowBatch(sc, p_State, Input_BatchSize.GetInt(), Input_APIEndpoint.GetString(), Input_APIKey.GetString());
+    }
+    else if (SendMode == 0)  // Real-time mode - send new bars only
     {
         bool NewBar = false;
         bool ForceSend = Input_SendImmediately.GetYesNo();
@@ -456,7 +1166,7 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
         // Send data if we have a new bar and no pending request
         if (NewBar && p_State->RequestState == 0)
         {
-            SCString jsonData = CreateTradeFlowBarJSON(sc, sc.Index);
+            SCString jsonData = CreateTradeFlowBarJSON(sc, sc.Index, &p_State->Calcs);
             SCString apiURL = Input_APIEndpoint.GetString();
             SCString apiKey = Input_APIKey.GetString();
 
@@ -501,61 +1211,42 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
             }
         }
     }
-    else if (SendMode == 1)  // Batch mode - send multiple bars at once
+    else if (SendMode == 1)  // Batch mode - closed bars in full batches from the acked cursor
     {
-        if (p_State->RequestState == 0)  // No pending request
-        {
-            int BatchSize = Input_BatchSize.GetInt();
-            int StartIndex = max(0, sc.Index - BatchSize + 1);
+        int LastClosedIndex = sc.ArraySize - 2;  // The newest bar is still forming
 
-            // Send batch if we have enough new bars
-            if (sc.Index - p_State->LastSentIndex >= BatchSize)
+        if (p_State->BatchAckedTime.IsUnset())
+        {
+            // First call in batch mode: continue after the last bar sent in
+            // real-time mode, so bars that closed since then are not skipped;
+            // with none sent yet, start after the newest closed bar
+            int SeedIndex = LastClosedIndex;
+            if (!p_State->LastBarDateTime.IsUnset())
             {
-                SCString jsonData = CreateTradeFlowBatchJSON(sc, StartIndex, sc.Index, "sierra_chart_batch");
-                SCString apiURL = Input_APIEndpoint.GetString();
-                SCString apiKey = Input_APIKey.GetString();
-
-                // Add batch to the URL for TradeFlow batch endpoint
-                // Remove trailing slash to avoid double slash
-                SCString baseURL = Input_APIEndpoint.GetString();
-                if (baseURL.GetLength() > 0 && baseURL[baseURL.GetLength() - 1] == '/') {
-                    baseURL = baseURL.Left(baseURL.GetLength() - 1);
-                }
-                apiURL = baseURL + "/batch";
-
-                // Prepare headers
-                n_ACSIL::s_HTTPHeader headers[2];
-                int numHeaders = 0;
-
-                if (apiKey.GetLength() > 0)
-                {
-                    headers[0].Name = "X-API-Key";
-                    headers[0].Value = apiKey;
-                    numHeaders++;
-                }
-
-                headers[numHeaders].Name = "Content-Type";
-                headers[numHeaders].Value = "application/json";
-                numHeaders++;
-
-                // Make HTTP POST request
-                int result = sc.MakeHTTPPOSTRequest(apiURL, jsonData, headers, numHeaders);
-
-                if (result > 0)
-                {
-                    p_State->RequestState = 1;  // Request made
-                    p_State->LastSentIndex = sc.Index;
-                    p_State->TotalBarsSent += (sc.Index - StartIndex + 1);
-                    sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Sent batch of %d bars. Total bars sent: %d",
-                        (sc.Index - StartIndex + 1), p_State->TotalBarsSent), 0);
-                }
-                else
-                {
-                    p_State->FailedRequests++;
-                    sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Failed to send batch data. Error code: %d", result), 1);
-                }
+                int LastSent = FindBarAtOrBefore(sc, p_State->LastBarDateTime);
+                if (LastSent >= 0)
+                    SeedIndex = min(LastSent, LastClosedIndex);
+            }
+            if (SeedIndex >= 0)
+            {
+                p_State->BatchAckedIndex = SeedIndex;
+                p_State->BatchAckedTime = sc.BaseDateTimeIn[SeedIndex];
+                p_State->BatchEpochMs = DateTimeToMs(p_State->BatchAckedTime);
+                p_State->BatchAckedCount = 0;
             }
         }
+        else
+            LocateTradeFlowBatchCursor(sc, p_State);
+
+        // A backlog goes out as back-to-back full batches, one per response;
+        // a partial batch waits for more bars to close (or for a switch to
+        // another mode, which flushes it), and a batch on the encoder pool
+        // until its body is ready
+        int BatchSize = Input_BatchSize.GetInt();
+        if (p_State->RequestState == 0 && !p_State->BatchAckedTime.IsUnset()
+            && LastClosedIndex - p_State->BatchAckedIndex >= BatchSize)
+            PostTradeFlowBatch(sc, p_State, p_State->BatchAckedIndex + BatchSize,
+                Input_APIEndpoint.GetString(), Input_APIKey.GetString());
     }
     else if (SendMode == 2)  // Historical mode - export historical data
     {
@@ -607,6 +1298,10 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
             // Calculate starting index (Oldest data first)
             int StartIndex = max(0, TotalBarsAvailable - HistoricalBarsCount);
             p_State->HistoricalExportIndex = StartIndex;
+            p_State->HistoricalExportStart = StartIndex;
+            p_State->HistoricalExportEpochMs = DateTimeToMs(sc.CurrentSystemDateTime);
+            p_State->BarCache.Hits = 0;
+            p_State->BarCache.Encoded = 0;
             p_State->LastExportTime = sc.CurrentSystemDateTime;
             p_State->TotalBarsSent = 0;
 
@@ -627,61 +1322,45 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
                 int BatchSize = 100;  // TradeFlow optimized
                 int EndIndex = min(p_State->HistoricalExportIndex + BatchSize - 1, TotalBarsAvailable - 1);
 
-                // Create batch JSON for historical data
+                // Create batch JSON for historical data; with the encoder pool
+                // the batch goes out on the call that finds its body ready
                 SCString sourceType = p_State->ManualExportTriggered ?
                     "sierra_chart_manual_historical_export" : "sierra_chart_historical_export";
-                SCString historicalData = CreateTradeFlowBatchJSON(sc, p_State->HistoricalExportIndex, EndIndex, sourceType.GetChars());
-
-                sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Exporting batch bars %d to %d",
-                    p_State->HistoricalExportIndex, EndIndex), 0);
-
-                SCString apiURL = Input_APIEndpoint.GetString();
-                SCString apiKey = Input_APIKey.GetString();
-
-                // Add batch to the URL
-                // Remove trailing slash to avoid double slash
-                SCString baseURL = Input_APIEndpoint.GetString();
-                if (baseURL.GetLength() > 0 && baseURL[baseURL.GetLength() - 1] == '/') {
-                    baseURL = baseURL.Left(baseURL.GetLength() - 1);
-                }
-                apiURL = baseURL + "/batch";
-
-                // Prepare headers
-                n_ACSIL::s_HTTPHeader headers[2];
-                int numHeaders = 0;
-
-                if (apiKey.GetLength() > 0)
+                SCString historicalData;
+                if (TradeFlowBatchBody(sc, p_State, p_State->HistoricalExportIndex, EndIndex, sourceType.GetChars(), historicalData))
                 {
-                    headers[0].Name = "X-API-Key";
-                    headers[0].Value = apiKey;
-                    numHeaders++;
-                }
-
-                headers[numHeaders].Name = "Content-Type";
-                headers[numHeaders].Value = "application/json";
-                numHeaders++;
-
-                // Make HTTP POST request
-                int result = sc.MakeHTTPPOSTRequest(apiURL, historicalData, headers, numHeaders);
-
-                if (result > 0)
-                {
-                    p_State->RequestState = 1;  // Request made
-                    p_State->TotalBarsSent += (EndIndex - p_State->HistoricalExportIndex + 1);
-                    p_State->LastExportTime = sc.CurrentSystemDateTime;
-                    sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Sent historical batch of %d bars. Total sent: %d",
-                        (EndIndex - p_State->HistoricalExportIndex + 1), p_State->TotalBarsSent), 0);
-                }
-                else
-                {
-                    p_State->FailedRequests++;
-                    sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Failed to send historical batch. Error: %d (Total failures: %d)", result, p_State->FailedRequests), 1);
+                    sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Exporting batch bars %d to %d",
+                        p_State->HistoricalExportIndex, EndIndex), 0);
+
+                    // Bars are numbered from the export's first bar, so a retried
+                    // batch repeats its range
+                    s_BatchSequence Sequence;
+                    Sequence.Stream = SCString().Format("%s:%d:%d:export:%lld", sc.Symbol.GetChars(), sc.ChartNumber, sc.SecondsPerBar,
+                        p_State->HistoricalExportEpochMs);
+                    Sequence.First = p_State->HistoricalExportIndex - p_State->HistoricalExportStart + 1;
+                    Sequence.Last = EndIndex - p_State->HistoricalExportStart + 1;
+                    int result = PostTradeFlowJSON(sc, Input_APIEndpoint.GetString(), Input_APIKey.GetString(), "/batch", historicalData, &Sequence);
+
+                    if (result > 0)
+                    {
+                        p_State->RequestState = 1;  // Request made
+                        p_State->TotalBarsSent += (EndIndex - p_State->HistoricalExportIndex + 1);
+                        p_State->LastExportTime = sc.CurrentSystemDateTime;
+                        sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Sent historical batch of %d bars. Total sent: %d",
+                            (EndIndex - p_State->HistoricalExportIndex + 1), p_State->TotalBarsSent), 0);
+                    }
+                    else
+                    {
+                        p_State->FailedRequests++;
+                        sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Failed to send historical batch. Error: %d (Total failures: %d)", result, p_State->FailedRequests), 1);
+                    }
                 }
             }
             else
             {
                 // Historical export complete
-                sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Historical export complete. Total bars exported: %d", p_State->TotalBarsSent), 0);
+                sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Historical export complete. Total bars exported: %d (encoded bar cache: %d reused, %d encoded)",
+                    p_State->TotalBarsSent, p_State->BarCache.Hits, p_State->BarCache.Encoded), 0);
 
                 // Reset states for next export
                 p_State->HistoricalExportTriggered = false;
@@ -691,6 +1370,91 @@ SCSFExport scsf_TradeFlowProDataCollector(SCStudyInterfaceRef sc)
         }
     }
 
+    // Send the chart's session times when due, then finished custom bars,
+    // order flow events and heatmap tiles, whenever the line is free.
+    // Historical exports go first: their response advances the export.
+    bool QueueTurn = p_State->RequestState == 0 &&
+        !p_State->HistoricalExportTriggered && !p_State->ManualExportTriggered;
+    bool SendSessionTimes = Input_SendSessionTimes.GetYesNo() != 0;
+    if (SendSessionTimes)
+        p_State->SessionTimes.Update(sc);
+
+    if (QueueTurn && SendSessionTimes && p_State->SessionTimes.Due(sc))
+    {
+        SCString jsonData = p_State->SessionTimes.CreateJSON(sc);
+        int result = PostTradeFlowJSON(sc, Input_APIEndpoint.GetString(), Input_APIKey.GetString(), "/session-times", jsonData);
+
+        if (result > 0)
+        {
+            p_State->RequestState = 1;  // Request made
+            p_State->SessionTimes.Sending(sc);
+        }
+        else
+        {
+            p_State->FailedRequests++;
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Failed to send session times. Error code: %d", result), 1);
+        }
+    }
+    else if (QueueTurn && !p_State->CustomBars.Finished.empty())
+    {
+        int Count = p_State->CustomBars.ContiguousCount(Input_BatchSize.GetInt());
+        SCString jsonData = p_State->CustomBars.CreateBatchJSON(sc, Count);
+        s_BatchSequence Sequence;
+        Sequence.Stream = p_State->CustomBars.StreamId(sc);
+        Sequence.First = p_State->CustomBars.Finished[0].Sequence;
+        Sequence.Last = p_State->CustomBars.Finished[Count - 1].Sequence;
+        int result = PostTradeFlowJSON(sc, Input_APIEndpoint.GetString(), Input_APIKey.GetString(), "/batch", jsonData, &Sequence);
+
+        if (result > 0)
+        {
+            p_State->RequestState = 1;  // Request made
+            p_State->CustomBars.InFlight = Count;
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Sent %d custom bars (%d queued)",
+                Count, (int)p_State->CustomBars.Finished.size()), 0);
+        }
+        else
+        {
+            p_State->FailedRequests++;
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Failed to send custom bars. Error code: %d", result), 1);
+        }
+    }
+    else if (QueueTurn && !p_State->OrderFlow.Events.empty())
+    {
+        int Count = min((int)p_State->OrderFlow.Events.size(), Input_BatchSize.GetInt());
+        SCString jsonData = p_State->OrderFlow.CreateEventsJSON(sc, Count);
+        int result = PostTradeFlowJSON(sc, Input_APIEndpoint.GetString(), Input_APIKey.GetString(), "/orderflow-events", jsonData);
+
+        if (result > 0)
+        {
+            p_State->RequestState = 1;  // Request made
+            p_State->OrderFlow.InFlight = Count;
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Sent %d order flow events", Count), 0);
+        }
+        else
+        {
+            p_State->FailedRequests++;
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Failed to send order flow events. Error code: %d", result), 1);
+        }
+    }
+    else if (QueueTurn && !p_State->Heatmap.Finished.empty())
+    {
+        int Count = min((int)p_State->Heatmap.Finished.size(), Input_BatchSize.GetInt());
+        SCString jsonData = p_State->Heatmap.CreateTilesJSON(sc, Count);
+        int result = PostTradeFlowJSON(sc, Input_APIEndpoint.GetString(), Input_APIKey.GetString(), "/heatmap-tiles", jsonData);
+
+        if (result > 0)
+        {
+            p_State->RequestState = 1;  // Request made
+            p_State->Heatmap.InFlight = Count;
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Sent %d heatmap tiles", Count), 0);
+        }
+        else
+        {
+            p_State->FailedRequests++;
+            sc.AddMessageToLog(SCString().Format("TradeFlow Pro: Failed to send heatmap tiles. Error code: %d", result), 1);
+        }
+    }
+
     // Update sent count subgraph
     Subgraph_SentCount[sc.Index] = (float)p_State->TotalBarsSent;
 
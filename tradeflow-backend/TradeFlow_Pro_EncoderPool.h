@@ -0,0 +1,249 @@
+// TradeFlow Pro encoder pool
+// Formatting a batch is CPU work that otherwise runs on the chart thread, once
+// per chart and one chart at a time. The pool is a small set of worker
+// threads shared by every collector instance in the DLL: a chart thread
+// submits an encode job (a copy of the raw records and what to do with them)
+// and picks the finished body up on a later call. Each worker owns a job
+// deque and a reusable output buffer; jobs go to the deque picked by their
+// stream, and an idle worker steals from the back of another worker's deque,
+// so one busy chart does not leave the other threads idle. A stream's jobs
+// may finish out of order on different workers; c_EncoderStream hands the
+// bodies back in submission order.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const int ENCODER_MAX_THREADS = 64;
+
+struct s_EncoderPoolStats
+{
+    size_t Executed = 0;
+    size_t Stolen = 0;      // Executed by a worker other than the one submitted to
+};
+
+class c_EncoderPool
+{
+public:
+    // Writes the encoded output into Buffer, the worker's own (cleared,
+    // capacity kept between jobs)
+    typedef std::function<void(std::string& Buffer)> t_Job;
+
+    c_EncoderPool() {}
+    c_EncoderPool(const c_EncoderPool&) = delete;
+    c_EncoderPool& operator=(const c_EncoderPool&) = delete;
+    ~c_EncoderPool() { Stop(); }
+
+    // Reference-counted start and stop for instances sharing the pool. The
+    // first Acquire sets the thread count; the last Release joins the
+    // workers, so threads never outlive the instances (a DLL must not join
+    // threads from its unload path).
+    void Acquire(int Threads)
+    {
+        std::lock_guard<std::mutex> Lock(UsersMutex);
+        if (Users++ == 0)
+            Start(Threads);
+    }
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> Lock(UsersMutex);
+        if (Users > 0 && --Users == 0)
+            Stop();
+    }
+
+    void Start(int Threads)
+    {
+        Stop();
+        Threads = Threads < 1 ? 1 : (Threads > ENCODER_MAX_THREADS ? ENCODER_MAX_THREADS : Threads);
+        Stopping = false;
+        for (int t = 0; t < Threads; t++)
+            Workers.emplace_back(new s_Worker());
+        for (size_t t = 0; t < Workers.size(); t++)
+            Workers[t]->Thread = std::thread(&c_EncoderPool::Run, this, t);
+    }
+
+    // Joins the workers; jobs not yet started are dropped
+    void Stop()
+    {
+        if (Workers.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> Lock(SleepMutex);
+            Stopping = true;
+        }
+        Wake.notify_all();
+        for (std::unique_ptr<s_Worker>& Worker : Workers)
+            Worker->Thread.join();
+        Workers.clear();
+        Queued = 0;
+    }
+
+    int GetThreads() const { return (int)Workers.size(); }
+
+    // Queues Job on the worker picked by Hint (a stream id keeps a stream on
+    // one worker unless another steals). Runs it on the caller without workers.
+    void Submit(size_t Hint, t_Job Job)
+    {
+        if (Workers.empty())
+        {
+            std::string Buffer;
+            Job(Buffer);
+            return;
+        }
+        s_Worker& Worker = *Workers[Hint % Workers.size()];
+        {
+            std::lock_guard<std::mutex> Lock(SleepMutex);
+            {
+                std::lock_guard<std::mutex> Jobs(Worker.Mutex);
+                Worker.Jobs.push_back(std::move(Job));
+            }
+            Queued++;
+        }
+        Wake.notify_one();
+    }
+
+    s_EncoderPoolStats GetStats() const
+    {
+        s_EncoderPoolStats Stats;
+        for (const std::unique_ptr<s_Worker>& Worker : Workers)
+        {
+            Stats.Executed += Worker->Executed.load();
+            Stats.Stolen += Worker->Stolen.load();
+        }
+        return Stats;
+    }
+
+private:
+    struct s_Worker
+    {
+        std::mutex Mutex;
+        std::deque<t_Job> Jobs;
+        std::string Buffer;
+        std::thread Thread;
+        std::atomic<size_t> Executed{ 0 };
+        std::atomic<size_t> Stolen{ 0 };
+    };
+
+    std::vector<std::unique_ptr<s_Worker>> Workers;
+    std::mutex SleepMutex;              // Taken before any worker's Mutex
+    std::condition_variable Wake;
+    size_t Queued = 0;                  // Jobs in all deques; guarded by SleepMutex
+    bool Stopping = false;
+    std::mutex UsersMutex;
+    int Users = 0;
+
+    // Own deque from the front (submission order), others' from the back
+    bool Take(size_t Self, t_Job& Job)
+    {
+        size_t Count = Workers.size();
+        for (size_t k = 0; k < Count; k++)
+        {
+            s_Worker& Victim = *Workers[(Self + k) % Count];
+            std::lock_guard<std::mutex> Lock(Victim.Mutex);
+            if (Victim.Jobs.empty())
+                continue;
+            if (k == 0)
+            {
+                Job = std::move(Victim.Jobs.front());
+                Victim.Jobs.pop_front();
+            }
+            else
+            {
+                Job = std::move(Victim.Jobs.back());
+                Victim.Jobs.pop_back();
+                Workers[Self]->Stolen++;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void Run(size_t Self)
+    {
+        s_Worker& Worker = *Workers[Self];
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> Lock(SleepMutex);
+                Wake.wait(Lock, [this]() { return Stopping || Queued > 0; });
+                if (Stopping)
+                    return;
+                Queued--;   // Claims one job; it is in some deque until taken
+            }
+
+            t_Job Job;
+            while (!Take(Self, Job))
+                std::this_thread::yield();  // Claimed but not yet visible to this scan
+            Worker.Buffer.clear();
+            Job(Worker.Buffer);
+            Worker.Executed++;
+        }
+    }
+};
+
+// Per-stream ordering on top of the pool: bodies come back in the order
+// their jobs were submitted, whichever worker finished them first. Results
+// are shared with the jobs, so a stream may be destroyed with jobs in flight.
+class c_EncoderStream
+{
+public:
+    c_EncoderStream()
+        : Shared(std::make_shared<s_Shared>())
+    {
+        static std::atomic<size_t> NextId(0);
+        Id = NextId++;
+    }
+
+    // Queues Encode (which appends to the worker's buffer) and returns its
+    // ticket, counting from 1
+    uint64_t Submit(c_EncoderPool& Pool, std::function<void(std::string&)> Encode)
+    {
+        uint64_t Ticket = ++LastTicket;
+        std::shared_ptr<s_Shared> Results = Shared;
+        Pool.Submit(Id, [Results, Ticket, Encode](std::string& Buffer)
+        {
+            Encode(Buffer);
+            std::lock_guard<std::mutex> Lock(Results->Mutex);
+            Results->Done.emplace(Ticket, Buffer);
+        });
+        return Ticket;
+    }
+
+    // The next body in submission order, once it is finished
+    bool Poll(std::string& Body, uint64_t& Ticket)
+    {
+        std::lock_guard<std::mutex> Lock(Shared->Mutex);
+        auto Found = Shared->Done.find(Delivered + 1);
+        if (Found == Shared->Done.end())
+            return false;
+        Body.swap(Found->second);
+        Ticket = Found->first;
+        Shared->Done.erase(Found);
+        Delivered++;
+        return true;
+    }
+
+    size_t Pending() const { return (size_t)(LastTicket - Delivered); }
+
+private:
+    struct s_Shared
+    {
+        std::mutex Mutex;
+        std::map<uint64_t, std::string> Done;
+    };
+
+    std::shared_ptr<s_Shared> Shared;
+    size_t Id = 0;
+    uint64_t LastTicket = 0;
+    uint64_t Delivered = 0;
+};
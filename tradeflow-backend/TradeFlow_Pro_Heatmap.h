@@ -0,0 +1,340 @@
+// TradeFlow Pro liquidity heatmap tiles
+// Samples the top of the market depth book on every study call and folds it
+// straight into time x price cells at a few fixed resolutions: each sample's
+// book is held until the next one, so a cell accumulates resting size x time
+// (its time-weighted average) and the largest size seen. A column finishes
+// when its time span ends and is queued as one tile: the cell range in rows of
+// the resolution's tick size, quantized to two 6-bit characters per cell.
+// Raw book updates never leave the collector.
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "TradeFlow_Pro_TimeAndSales.h"
+
+const int HEATMAP_RESOLUTIONS = 3;
+const int HEATMAP_COLUMN_FACTOR[HEATMAP_RESOLUTIONS] = { 1, 10, 60 };   // x "Heatmap Column Seconds"
+const int HEATMAP_ROW_TICKS[HEATMAP_RESOLUTIONS] = { 1, 2, 8 };         // Price rows merge ticks as columns widen
+const int HEATMAP_MAX_ROWS = 4096;          // Rows per column; depth beyond this span (bad prices) is skipped
+const int HEATMAP_MAX_GAP_MS = 5000;        // A book is held at most this long when study calls stall
+const int HEATMAP_MAX_PENDING = 5000;       // Oldest finished tiles are dropped beyond this
+const int HEATMAP_QUANT_LEVELS = 63;
+
+// Cell values are q = round(63 * sqrt(size / scale)), one base64url character
+// each; the backend decodes size = scale * (q / 63)^2. The square root keeps
+// thin liquidity visible next to the largest resting orders.
+const char HEATMAP_QUANT_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+struct s_HeatmapConfig
+{
+    bool Enabled = false;
+    int DepthLevels = 20;       // Book levels sampled per side
+    int ColumnSeconds = 1;      // Finest column width
+
+    bool operator==(const s_HeatmapConfig& Other) const
+    {
+        return Enabled == Other.Enabled && DepthLevels == Other.DepthLevels && ColumnSeconds == Other.ColumnSeconds;
+    }
+};
+
+struct s_HeatmapTile
+{
+    long long TimeMs = 0;       // Column start, chart time zone
+    int ColumnSeconds = 0;
+    int RowTicks = 0;
+    int LowTick = 0;            // Price of the first row, in ticks
+    float Scale = 0;            // Largest size in the tile; quantization reference
+    std::string Cells;          // Per row, lowest first: average then max character
+};
+
+struct s_HeatmapAggregator
+{
+    s_HeatmapConfig Config;
+    std::deque<s_HeatmapTile> Finished;   // Oldest first, waiting to be sent
+    int InFlight = 0;                     // Leading tiles in the pending request
+    int DroppedTiles = 0;
+
+    void Configure(const s_HeatmapConfig& NewConfig)
+    {
+        if (NewConfig == Config)
+            return;
+        Config = NewConfig;
+        Reset();
+    }
+
+    void Reset()
+    {
+        Finished.clear();
+        InFlight = 0;
+        Book.clear();
+        LastSampleMs = -1;
+        for (int r = 0; r < HEATMAP_RESOLUTIONS; r++)
+            Columns[r] = s_Column();
+    }
+
+    // Reads the current book and credits the previous one for the time since
+    // the last sample. Sampling starts with the first call; no history exists.
+    void Sample(SCStudyInterfaceRef sc)
+    {
+        if (!Config.Enabled)
+            return;
+
+        long long NowMs = DateTimeToMs(sc.CurrentSystemDateTimeMS);
+        if (LastSampleMs >= 0 && NowMs < LastSampleMs)
+        {
+            // Clock stepped back: drop the forming columns rather than overlap them
+            LastSampleMs = -1;
+            for (int r = 0; r < HEATMAP_RESOLUTIONS; r++)
+                Columns[r] = s_Column();
+        }
+
+        for (int r = 0; r < HEATMAP_RESOLUTIONS; r++)
+        {
+            if (LastSampleMs >= 0)
+                Credit(r, LastSampleMs, min(NowMs, LastSampleMs + HEATMAP_MAX_GAP_MS));
+        }
+
+        ReadBook(sc);
+
+        for (int r = 0; r < HEATMAP_RESOLUTIONS; r++)
+        {
+            s_Column& Column = Columns[r];
+            if (Column.StartMs >= 0 && NowMs >= Column.StartMs + Width(r))
+                Finish(r);
+            if (Column.StartMs < 0)
+                Open(r, NowMs);
+            MarkMax(r);
+        }
+        LastSampleMs = NowMs;
+    }
+
+    // Over the cap, drops the oldest tiles that are not part of a pending request
+    void Trim()
+    {
+        while ((int)Finished.size() > HEATMAP_MAX_PENDING && (int)Finished.size() > InFlight)
+        {
+            Finished.erase(Finished.begin() + InFlight);
+            DroppedTiles++;
+        }
+    }
+
+    int Acknowledge()
+    {
+        int Sent = min(InFlight, (int)Finished.size());
+        Finished.erase(Finished.begin(), Finished.begin() + Sent);
+        InFlight = 0;
+        return Sent;
+    }
+
+    // {"symbol":..., "tiles":[[time, column seconds, row size, low price, scale, cells], ...]}
+    SCString CreateTilesJSON(SCStudyInterfaceRef sc, int Count) const
+    {
+        SCString json;
+        json += "{\"symbol\":\"";
+        json += sc.Symbol.GetChars();
+        json += "\",\"tiles\":[";
+        for (int i = 0; i < Count; i++)
+        {
+            const s_HeatmapTile& Tile = Finished[i];
+            if (i > 0)
+                json += ",";
+            json += "[\"";
+            json += FormatTradeFlowTime(Tile.TimeMs);
+            json += SCString().Format("\",%d,%f,%f,%.0f,\"", Tile.ColumnSeconds,
+                Tile.RowTicks * sc.TickSize, Tile.LowTick * sc.TickSize, Tile.Scale);
+            json += Tile.Cells.c_str();
+            json += "\"]";
+        }
+        json += "]}";
+        return json;
+    }
+
+private:
+    struct s_Level
+    {
+        int PriceTicks;
+        float Size;
+    };
+
+    struct s_Cell
+    {
+        double SizeMs = 0;      // Resting size x milliseconds
+        float Max = 0;
+        float Current = 0;      // Scratch row total while marking a sample
+    };
+
+    struct s_Column
+    {
+        long long StartMs = -1; // -1 while no column is forming
+        long long CoveredMs = 0;
+        int LowRow = 0;
+        std::vector<s_Cell> Cells;
+    };
+
+    std::vector<s_Level> Book;  // Bid then ask levels of the last sample
+    long long LastSampleMs = -1;
+    s_Column Columns[HEATMAP_RESOLUTIONS];
+
+    long long Width(int r) const
+    {
+        return (long long)Config.ColumnSeconds * HEATMAP_COLUMN_FACTOR[r] * 1000;
+    }
+
+    static int RowOf(int PriceTicks, int RowTicks)
+    {
+        return PriceTicks >= 0 ? PriceTicks / RowTicks : -((-PriceTicks + RowTicks - 1) / RowTicks);
+    }
+
+    void ReadBook(SCStudyInterfaceRef sc)
+    {
+        Book.clear();
+        float TickSize = sc.TickSize > 0 ? sc.TickSize : 1.0f;
+        int BidLevels = min(sc.GetBidMarketDepthNumberOfLevels(), Config.DepthLevels);
+        int AskLevels = min(sc.GetAskMarketDepthNumberOfLevels(), Config.DepthLevels);
+        s_MarketDepthEntry Entry;
+        for (int Level = 0; Level < BidLevels + AskLevels; Level++)
+        {
+            bool Bid = Level < BidLevels;
+            if (!(Bid ? sc.GetBidMarketDepthEntryAtLevel(Entry, Level) : sc.GetAskMarketDepthEntryAtLevel(Entry, Level - BidLevels)))
+                continue;
+            if (Entry.Quantity == 0 || Entry.Price <= 0)
+                continue;
+            s_Level Resting;
+            Resting.PriceTicks = (int)floor(Entry.Price * sc.RealTimePriceMultiplier / TickSize + 0.5);
+            Resting.Size = (float)Entry.Quantity;
+            Book.push_back(Resting);
+        }
+    }
+
+    void Open(int r, long long TimeMs)
+    {
+        s_Column& Column = Columns[r];
+        Column.StartMs = TimeMs - TimeMs % Width(r);
+        Column.CoveredMs = 0;
+        Column.Cells.clear();
+    }
+
+    // Cell of Row in the forming column, growing the column's row range; null
+    // when the range would exceed HEATMAP_MAX_ROWS
+    s_Cell* CellAt(s_Column& Column, int Row)
+    {
+        if (Column.Cells.empty())
+        {
+            Column.LowRow = Row;
+            Column.Cells.resize(1);
+            return &Column.Cells[0];
+        }
+        int Count = (int)Column.Cells.size();
+        if (Row < Column.LowRow)
+        {
+            if (Column.LowRow + Count - Row > HEATMAP_MAX_ROWS)
+                return nullptr;
+            Column.Cells.insert(Column.Cells.begin(), (size_t)(Column.LowRow - Row), s_Cell());
+            Column.LowRow = Row;
+        }
+        else if (Row >= Column.LowRow + Count)
+        {
+            if (Row - Column.LowRow + 1 > HEATMAP_MAX_ROWS)
+                return nullptr;
+            Column.Cells.resize((size_t)(Row - Column.LowRow + 1));
+        }
+        return &Column.Cells[Row - Column.LowRow];
+    }
+
+    // Holds the current book over [FromMs, ToMs), finishing columns it crosses
+    void Credit(int r, long long FromMs, long long ToMs)
+    {
+        s_Column& Column = Columns[r];
+        while (FromMs < ToMs)
+        {
+            if (Column.StartMs >= 0 && FromMs >= Column.StartMs + Width(r))
+                Finish(r);
+            if (Column.StartMs < 0)
+            {
+                Open(r, FromMs);
+                MarkMax(r);   // The held book is resting in the new column too
+            }
+
+            long long UntilMs = min(ToMs, Column.StartMs + Width(r));
+            double Elapsed = (double)(UntilMs - FromMs);
+            for (const s_Level& Resting : Book)
+            {
+                s_Cell* Cell = CellAt(Column, RowOf(Resting.PriceTicks, HEATMAP_ROW_TICKS[r]));
+                if (Cell != nullptr)
+                    Cell->SizeMs += Resting.Size * Elapsed;
+            }
+            Column.CoveredMs += UntilMs - FromMs;
+            FromMs = UntilMs;
+        }
+    }
+
+    // Max is per row: merged ticks are summed first
+    void MarkMax(int r)
+    {
+        s_Column& Column = Columns[r];
+        int RowTicks = HEATMAP_ROW_TICKS[r];
+        for (const s_Level& Resting : Book)
+        {
+            s_Cell* Cell = CellAt(Column, RowOf(Resting.PriceTicks, RowTicks));
+            if (Cell != nullptr)
+                Cell->Current += Resting.Size;
+        }
+        for (const s_Level& Resting : Book)
+        {
+            s_Cell* Cell = CellAt(Column, RowOf(Resting.PriceTicks, RowTicks));
+            if (Cell != nullptr && Cell->Current > 0)
+            {
+                if (Cell->Current > Cell->Max)
+                    Cell->Max = Cell->Current;
+                Cell->Current = 0;
+            }
+        }
+    }
+
+    static char Quantize(double Value, double Scale)
+    {
+        if (Value <= 0)
+            return HEATMAP_QUANT_CHARS[0];
+        int Level = (int)floor(HEATMAP_QUANT_LEVELS * sqrt(min(Value / Scale, 1.0)) + 0.5);
+        return HEATMAP_QUANT_CHARS[Level];
+    }
+
+    // Queues the forming column as a tile (rows with no resting size trimmed
+    // from both ends) and leaves no column open
+    void Finish(int r)
+    {
+        s_Column& Column = Columns[r];
+        int First = 0;
+        int Last = (int)Column.Cells.size() - 1;
+        while (First <= Last && Column.Cells[First].Max <= 0)
+            First++;
+        while (Last >= First && Column.Cells[Last].Max <= 0)
+            Last--;
+
+        if (First <= Last && Column.CoveredMs > 0)
+        {
+            float Scale = 0;
+            for (int c = First; c <= Last; c++)
+                Scale = max(Scale, Column.Cells[c].Max);
+
+            s_HeatmapTile Tile;
+            Tile.TimeMs = Column.StartMs;
+            Tile.ColumnSeconds = Config.ColumnSeconds * HEATMAP_COLUMN_FACTOR[r];
+            Tile.RowTicks = HEATMAP_ROW_TICKS[r];
+            Tile.LowTick = (Column.LowRow + First) * Tile.RowTicks;
+            Tile.Scale = Scale;
+
+            Tile.Cells.reserve((size_t)(Last - First + 1) * 2);
+            for (int c = First; c <= Last; c++)
+            {
+                const s_Cell& Cell = Column.Cells[c];
+                Tile.Cells += Quantize(Cell.SizeMs / (double)Column.CoveredMs, Scale);
+                Tile.Cells += Quantize(Cell.Max, Scale);
+            }
+            Finished.push_back(Tile);
+        }
+        Column = s_Column();
+    }
+};
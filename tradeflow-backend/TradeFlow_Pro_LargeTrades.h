@@ -0,0 +1,191 @@
+// TradeFlow Pro large trade and iceberg detection
+// Watches individual Time & Sales prints. A rolling trade-size percentile,
+// kept in a fixed-size log-bucket sketch, sets the block trade threshold;
+// same-price, same-side prints inside a time window are clustered, and a
+// cluster that keeps executing well beyond the size displayed at its price is
+// reported as a refilling iceberg. Per-trade cost is O(1): one bucket
+// increment, a scan of a few cluster slots, and a percentile walk amortised
+// over LARGETRADE_REFRESH_TRADES trades.
+#pragma once
+
+#include "TradeFlow_Pro_OrderFlow.h"
+#include "TradeFlow_Pro_TimeAndSales.h"
+
+const int SIZE_SKETCH_BUCKETS = 192;          // Up to ~2.4M contracts at 8% relative error
+const double SIZE_SKETCH_GAMMA = 1.08;
+const int SIZE_SKETCH_HALF_LIFE = 20000;      // Trades between halvings (rolling window)
+const int LARGETRADE_WARMUP_TRADES = 500;     // No block events until the sketch has this many
+const int LARGETRADE_REFRESH_TRADES = 64;     // Threshold recomputed every this many trades
+const int LARGETRADE_CLUSTER_SLOTS = 8;       // Concurrent price/side clusters tracked
+
+// Relative-error quantile sketch: bucket b counts sizes in (gamma^(b-1), gamma^b].
+// Counts are halved every SIZE_SKETCH_HALF_LIFE trades so percentiles follow
+// the recent tape in constant memory.
+struct s_SizeSketch
+{
+    float Counts[SIZE_SKETCH_BUCKETS] = {};
+    double Total = 0;
+    int SinceDecay = 0;
+
+    void Add(double Size)
+    {
+        int Bucket = Size <= 1.0 ? 0 : (int)ceil(log(Size) / log(SIZE_SKETCH_GAMMA));
+        if (Bucket >= SIZE_SKETCH_BUCKETS)
+            Bucket = SIZE_SKETCH_BUCKETS - 1;
+        Counts[Bucket] += 1.0f;
+        Total += 1.0;
+
+        if (++SinceDecay >= SIZE_SKETCH_HALF_LIFE)
+        {
+            for (int b = 0; b < SIZE_SKETCH_BUCKETS; b++)
+                Counts[b] *= 0.5f;
+            Total *= 0.5;
+            SinceDecay = 0;
+        }
+    }
+
+    // Upper bound of the bucket holding quantile Q (0..1)
+    double Quantile(double Q) const
+    {
+        double Target = Q * Total;
+        double Seen = 0;
+        for (int b = 0; b < SIZE_SKETCH_BUCKETS; b++)
+        {
+            Seen += Counts[b];
+            if (Seen >= Target)
+                return pow(SIZE_SKETCH_GAMMA, b);
+        }
+        return pow(SIZE_SKETCH_GAMMA, SIZE_SKETCH_BUCKETS - 1);
+    }
+};
+
+struct s_LargeTradeConfig
+{
+    bool Enabled = false;
+    float Percentile = 99.5f;        // Trade size percentile that marks a block trade
+    int MinBlockSize = 10;           // Absolute floor for thin markets
+    int ClusterWindowMs = 1000;      // Span from a cluster's first print to its last
+    float IcebergRefills = 3.0f;     // Executed volume vs the largest displayed size
+    int MinIcebergPrints = 3;
+
+    bool operator==(const s_LargeTradeConfig& Other) const
+    {
+        return Enabled == Other.Enabled && Percentile == Other.Percentile && MinBlockSize == Other.MinBlockSize
+            && ClusterWindowMs == Other.ClusterWindowMs && IcebergRefills == Other.IcebergRefills
+            && MinIcebergPrints == Other.MinIcebergPrints;
+    }
+};
+
+struct s_LargeTradeDetector
+{
+    s_LargeTradeConfig Config;
+    s_SizeSketch Sketch;
+    double Threshold = 0;
+    int SinceRefresh = 0;
+
+    void Configure(const s_LargeTradeConfig& NewConfig)
+    {
+        if (NewConfig == Config)
+            return;
+        Config = NewConfig;
+        Reset();
+    }
+
+    void Reset()
+    {
+        Sketch = s_SizeSketch();
+        Threshold = 0;
+        SinceRefresh = 0;
+        for (int c = 0; c < LARGETRADE_CLUSTER_SLOTS; c++)
+            Clusters[c] = s_Cluster();
+    }
+
+    void Add(const s_Trade& Trade, s_OrderFlowDetector& Out)
+    {
+        if (!Config.Enabled)
+            return;
+
+        Sketch.Add(Trade.Volume);
+        if (++SinceRefresh >= LARGETRADE_REFRESH_TRADES || Threshold == 0)
+        {
+            Threshold = Sketch.Quantile(Config.Percentile / 100.0);
+            SinceRefresh = 0;
+        }
+
+        double BlockSize = Threshold > Config.MinBlockSize ? Threshold : (double)Config.MinBlockSize;
+        if (Sketch.Total >= LARGETRADE_WARMUP_TRADES && Trade.Volume >= BlockSize)
+            Push(Out, Trade.TimeMs, Trade.AtAsk ? "LB" : "LS", Trade.PriceTicks, Trade.Volume);
+
+        Cluster(Trade, BlockSize, Out);
+    }
+
+private:
+    struct s_Cluster
+    {
+        bool Active = false;
+        bool Reported = false;
+        int PriceTicks = 0;
+        bool AtAsk = false;
+        long long FirstMs = 0;
+        long long LastMs = 0;
+        double Volume = 0;
+        double MaxResting = 0;
+        int Prints = 0;
+    };
+
+    s_Cluster Clusters[LARGETRADE_CLUSTER_SLOTS];
+
+    void Cluster(const s_Trade& Trade, double BlockSize, s_OrderFlowDetector& Out)
+    {
+        // Find this price/side's cluster, or reuse an expired or the stalest slot
+        s_Cluster* Slot = nullptr;
+        s_Cluster* Stalest = &Clusters[0];
+        for (int c = 0; c < LARGETRADE_CLUSTER_SLOTS; c++)
+        {
+            s_Cluster& Candidate = Clusters[c];
+            if (Candidate.Active && Trade.TimeMs - Candidate.FirstMs > Config.ClusterWindowMs)
+                Candidate.Active = false;
+            if (Candidate.Active && Candidate.PriceTicks == Trade.PriceTicks && Candidate.AtAsk == Trade.AtAsk)
+                Slot = &Candidate;
+            if (!Candidate.Active || (Stalest->Active && Candidate.LastMs < Stalest->LastMs))
+                Stalest = &Candidate;
+        }
+
+        if (Slot == nullptr)
+        {
+            Slot = Stalest;
+            *Slot = s_Cluster();
+            Slot->Active = true;
+            Slot->PriceTicks = Trade.PriceTicks;
+            Slot->AtAsk = Trade.AtAsk;
+            Slot->FirstMs = Trade.TimeMs;
+        }
+
+        Slot->LastMs = Trade.TimeMs;
+        Slot->Volume += Trade.Volume;
+        Slot->Prints++;
+        if (Trade.RestingSize > Slot->MaxResting)
+            Slot->MaxResting = Trade.RestingSize;
+
+        // Executed far more than was ever shown at the price: hidden size refilled.
+        // Without displayed sizes in the feed only the block threshold applies.
+        if (!Slot->Reported && Slot->Prints >= Config.MinIcebergPrints && Slot->Volume >= BlockSize
+            && Slot->Volume >= Config.IcebergRefills * Slot->MaxResting)
+        {
+            Slot->Reported = true;
+            // A buyer lifting the ask hits an iceberg resting on the ask, and vice versa
+            Push(Out, Slot->FirstMs, Slot->AtAsk ? "IA" : "IB", Slot->PriceTicks, Slot->Volume);
+        }
+    }
+
+    static void Push(s_OrderFlowDetector& Out, long long TimeMs, const char* Code, int PriceTicks, double Volume)
+    {
+        s_OrderFlowEvent Event;
+        Event.TimeMs = TimeMs;
+        Event.Code = Code;
+        Event.LowTick = PriceTicks;
+        Event.HighTick = PriceTicks;
+        Event.Volume = (float)Volume;
+        Out.Events.push_back(Event);
+    }
+};
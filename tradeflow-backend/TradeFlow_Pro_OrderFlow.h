@@ -0,0 +1,321 @@
+// TradeFlow Pro order flow event detector
+// Reads each bar's volume-at-price ladder from sc.VolumeAtPriceForBars at tick
+// resolution and compares diagonal bid/ask volumes on every update of the
+// forming bar. Stacked imbalances are emitted as soon as they form; unfinished
+// auctions and absorption depend on the bar's final extremes and are emitted
+// when it closes. Events are compact ("SB" + price range + volume) and queue
+// here, with the large trade detector's, until the collector posts them.
+#pragma once
+
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "TradeFlow_Pro_TimeAndSales.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TRADEFLOW_ORDERFLOW_SSE2 1
+#endif
+
+const int ORDERFLOW_MAX_LEVELS = 4096;      // Ladders wider than this (bad ticks) are skipped
+const int ORDERFLOW_MAX_PENDING = 10000;    // Oldest events are dropped beyond this
+
+enum e_OrderFlowFlag
+{
+    ORDERFLOW_BUY_IMBALANCE = 1,    // Ask at P vs bid at P - 1 tick
+    ORDERFLOW_SELL_IMBALANCE = 2    // Bid at P vs ask at P + 1 tick
+};
+
+struct s_OrderFlowConfig
+{
+    bool Enabled = false;
+    float ImbalanceRatio = 3.0f;
+    float MinImbalanceVolume = 10.0f;   // Aggressive volume a level needs to count
+    int StackedLevels = 3;              // Consecutive imbalanced levels for a stacked event
+    float AbsorptionMultiple = 3.0f;    // Extreme-level volume vs the bar's mean level volume
+
+    bool operator==(const s_OrderFlowConfig& Other) const
+    {
+        return Enabled == Other.Enabled && ImbalanceRatio == Other.ImbalanceRatio
+            && MinImbalanceVolume == Other.MinImbalanceVolume && StackedLevels == Other.StackedLevels
+            && AbsorptionMultiple == Other.AbsorptionMultiple;
+    }
+};
+
+struct s_OrderFlowEvent
+{
+    long long TimeMs = 0;    // Bar start, or the trade time for large trade events
+    // SB/SS stacked buy/sell, UH/UL unfinished high/low, AH/AL absorption at high/low,
+    // LB/LS large buy/sell trade, IB/IA iceberg resting on the bid/ask
+    const char* Code = "";
+    int LowTick = 0;
+    int HighTick = 0;
+    float Volume = 0;        // Aggressive volume across the event's levels
+};
+
+// Marks diagonal imbalances for every level of a padded ladder. Bid and Ask
+// hold level k (k = 1..Levels) at index k, with zeros at 0 and beyond Levels
+// (at least 4 entries) so the diagonal neighbours never need a bounds check.
+inline void MarkDiagonalImbalances(const float* Bid, const float* Ask, int Levels,
+    float Ratio, float MinVolume, unsigned char* Flags)
+{
+    int k = 1;
+#ifdef TRADEFLOW_ORDERFLOW_SSE2
+    const __m128 VRatio = _mm_set1_ps(Ratio);
+    const __m128 VMin = _mm_set1_ps(MinVolume);
+    for (; k + 3 <= Levels; k += 4)
+    {
+        __m128 AskHere = _mm_loadu_ps(Ask + k);
+        __m128 BidHere = _mm_loadu_ps(Bid + k);
+        __m128 BidBelow = _mm_loadu_ps(Bid + k - 1);
+        __m128 AskAbove = _mm_loadu_ps(Ask + k + 1);
+
+        __m128 Buy = _mm_and_ps(_mm_cmpge_ps(AskHere, _mm_mul_ps(VRatio, BidBelow)), _mm_cmpge_ps(AskHere, VMin));
+        __m128 Sell = _mm_and_ps(_mm_cmpge_ps(BidHere, _mm_mul_ps(VRatio, AskAbove)), _mm_cmpge_ps(BidHere, VMin));
+
+        // Spread each 4-bit lane mask to one byte per level (x86 is little-endian)
+        unsigned BuyBytes = ((unsigned)_mm_movemask_ps(Buy) * 0x00204081u) & 0x01010101u;
+        unsigned SellBytes = ((unsigned)_mm_movemask_ps(Sell) * 0x00204081u) & 0x01010101u;
+        unsigned Packed = BuyBytes * ORDERFLOW_BUY_IMBALANCE | SellBytes * ORDERFLOW_SELL_IMBALANCE;
+        memcpy(Flags + k, &Packed, 4);
+    }
+#endif
+    for (; k <= Levels; k++)
+    {
+        unsigned char Flag = 0;
+        if (Ask[k] >= Ratio * Bid[k - 1] && Ask[k] >= MinVolume)
+            Flag |= ORDERFLOW_BUY_IMBALANCE;
+        if (Bid[k] >= Ratio * Ask[k + 1] && Bid[k] >= MinVolume)
+            Flag |= ORDERFLOW_SELL_IMBALANCE;
+        Flags[k] = Flag;
+    }
+}
+
+struct s_OrderFlowDetector
+{
+    s_OrderFlowConfig Config;
+    std::deque<s_OrderFlowEvent> Events;   // Oldest first, waiting to be sent
+    int InFlight = 0;                      // Leading events in the pending request
+    int DroppedEvents = 0;
+    int FirstIndex = -1;                   // Bars before this are never scanned
+    int CurrentIndex = -1;                 // Forming bar being scanned
+
+    // New settings restart the scan from the newest bar but keep the queue:
+    // events already detected, including the large trade detector's, are
+    // still sent, and a pending request still acknowledges its own events
+    void Configure(const s_OrderFlowConfig& NewConfig)
+    {
+        if (NewConfig == Config)
+            return;
+        Config = NewConfig;
+        ResetScan();
+    }
+
+    void Reset()
+    {
+        Events.clear();
+        InFlight = 0;
+        ResetScan();
+    }
+
+    void ResetScan()
+    {
+        FirstIndex = -1;
+        CurrentIndex = -1;
+        Emitted.clear();
+    }
+
+    // Called for each updated bar. The first call starts at the newest bar so
+    // enabling detection never replays the chart's history.
+    void Update(SCStudyInterfaceRef sc, int Index)
+    {
+        if (!Config.Enabled || sc.VolumeAtPriceForBars == nullptr)
+            return;
+
+        if (FirstIndex < 0)
+            FirstIndex = CurrentIndex = sc.ArraySize - 1;
+        if (Index < FirstIndex)
+            return;
+
+        if (Index > CurrentIndex)
+        {
+            // The previous bar is final: scan it once more and emit its close-time events
+            if (LoadLadder(sc, CurrentIndex))
+            {
+                DetectStacked(sc, CurrentIndex);
+                DetectAtClose(sc, CurrentIndex);
+            }
+            CurrentIndex = Index;
+            Emitted.clear();
+        }
+
+        if (Index == CurrentIndex && LoadLadder(sc, Index))
+            DetectStacked(sc, Index);
+    }
+
+    // Over the cap, drops the oldest events that are not part of a pending request
+    void Trim()
+    {
+        while ((int)Events.size() > ORDERFLOW_MAX_PENDING && (int)Events.size() > InFlight)
+        {
+            Events.erase(Events.begin() + InFlight);
+            DroppedEvents++;
+        }
+    }
+
+    int Acknowledge()
+    {
+        int Sent = min(InFlight, (int)Events.size());
+        Events.erase(Events.begin(), Events.begin() + Sent);
+        InFlight = 0;
+        return Sent;
+    }
+
+    // {"symbol":..., "seconds_per_bar":..., "events":[[time, code, low, high, volume], ...]}
+    SCString CreateEventsJSON(SCStudyInterfaceRef sc, int Count) const
+    {
+        SCString json;
+        json += "{\"symbol\":\"";
+        json += sc.Symbol.GetChars();
+        json += SCString().Format("\",\"seconds_per_bar\":%d,\"events\":[", sc.SecondsPerBar);
+        for (int i = 0; i < Count; i++)
+        {
+            const s_OrderFlowEvent& Event = Events[i];
+            if (i > 0)
+                json += ",";
+            json += "[\"";
+            json += FormatTradeFlowTime(Event.TimeMs);
+            json += SCString().Format("\",\"%s\",%f,%f,%.0f]", Event.Code,
+                Event.LowTick * sc.TickSize, Event.HighTick * sc.TickSize, Event.Volume);
+        }
+        json += "]}";
+        return json;
+    }
+
+private:
+    struct s_Run
+    {
+        unsigned char Side;
+        int LowTick;
+        int HighTick;
+    };
+
+    // Ladder of the bar being scanned, padded as MarkDiagonalImbalances expects
+    int LowTick = 0;
+    int Levels = 0;
+    std::vector<float> Bid;
+    std::vector<float> Ask;
+    std::vector<unsigned char> Flags;
+    std::vector<s_Run> Emitted;   // Stacked runs already sent for the current bar
+
+    bool LoadLadder(SCStudyInterfaceRef sc, int Index)
+    {
+        Levels = 0;
+        int Count = sc.VolumeAtPriceForBars->GetSizeAtBarIndex(Index);
+        if (Count <= 0)
+            return false;
+
+        // Elements are sorted by price, so the first and last give the range
+        s_VolumeAtPriceV2* First = nullptr;
+        s_VolumeAtPriceV2* Last = nullptr;
+        if (!sc.VolumeAtPriceForBars->GetVAPElementAtIndex(Index, 0, &First)
+            || !sc.VolumeAtPriceForBars->GetVAPElementAtIndex(Index, Count - 1, &Last))
+            return false;
+
+        int Range = Last->PriceInTicks - First->PriceInTicks + 1;
+        if (Range <= 0 || Range > ORDERFLOW_MAX_LEVELS)
+            return false;
+
+        LowTick = First->PriceInTicks;
+        Levels = Range;
+        Bid.assign(Levels + 6, 0.0f);
+        Ask.assign(Levels + 6, 0.0f);
+        Flags.assign(Levels + 2, 0);
+
+        for (int e = 0; e < Count; e++)
+        {
+            s_VolumeAtPriceV2* Element = nullptr;
+            if (!sc.VolumeAtPriceForBars->GetVAPElementAtIndex(Index, e, &Element))
+                continue;
+            int k = Element->PriceInTicks - LowTick + 1;
+            Bid[k] = (float)Element->BidVolume;
+            Ask[k] = (float)Element->AskVolume;
+        }
+
+        MarkDiagonalImbalances(Bid.data(), Ask.data(), Levels, Config.ImbalanceRatio, Config.MinImbalanceVolume, Flags.data());
+        return true;
+    }
+
+    void DetectStacked(SCStudyInterfaceRef sc, int Index)
+    {
+        const unsigned char Sides[2] = { ORDERFLOW_BUY_IMBALANCE, ORDERFLOW_SELL_IMBALANCE };
+        for (unsigned char Side : Sides)
+        {
+            int k = 1;
+            while (k <= Levels)
+            {
+                if (!(Flags[k] & Side))
+                {
+                    k++;
+                    continue;
+                }
+                int Start = k;
+                float Volume = 0;
+                while (k <= Levels && (Flags[k] & Side))
+                {
+                    Volume += Side == ORDERFLOW_BUY_IMBALANCE ? Ask[k] : Bid[k];
+                    k++;
+                }
+                if (k - Start >= Config.StackedLevels)
+                    EmitStacked(sc, Index, Side, LowTick + Start - 1, LowTick + k - 2, Volume);
+            }
+        }
+    }
+
+    // A run that overlaps one already sent for this bar is the same zone growing
+    void EmitStacked(SCStudyInterfaceRef sc, int Index, unsigned char Side, int Low, int High, float Volume)
+    {
+        for (const s_Run& Run : Emitted)
+        {
+            if (Run.Side == Side && Run.LowTick <= High && Low <= Run.HighTick)
+                return;
+        }
+        Emitted.push_back({ Side, Low, High });
+        Push(sc, Index, Side == ORDERFLOW_BUY_IMBALANCE ? "SB" : "SS", Low, High, Volume);
+    }
+
+    void DetectAtClose(SCStudyInterfaceRef sc, int Index)
+    {
+        int HighTick = LowTick + Levels - 1;
+
+        // Both sides traded at an extreme: the auction did not finish there
+        if (Bid[Levels] > 0 && Ask[Levels] > 0)
+            Push(sc, Index, "UH", HighTick, HighTick, Bid[Levels] + Ask[Levels]);
+        if (Bid[1] > 0 && Ask[1] > 0)
+            Push(sc, Index, "UL", LowTick, LowTick, Bid[1] + Ask[1]);
+
+        // Heavy aggression into an extreme that the bar then closed away from
+        float Total = 0;
+        for (int k = 1; k <= Levels; k++)
+            Total += Bid[k] + Ask[k];
+        float Threshold = Config.AbsorptionMultiple * Total / Levels;
+        int CloseTick = sc.PriceValueToTicks(sc.BaseDataIn[SC_LAST][Index]);
+
+        if (Levels > 1 && Ask[Levels] >= Threshold && Ask[Levels] >= Config.MinImbalanceVolume && CloseTick < HighTick)
+            Push(sc, Index, "AH", HighTick, HighTick, Ask[Levels]);
+        if (Levels > 1 && Bid[1] >= Threshold && Bid[1] >= Config.MinImbalanceVolume && CloseTick > LowTick)
+            Push(sc, Index, "AL", LowTick, LowTick, Bid[1]);
+    }
+
+    void Push(SCStudyInterfaceRef sc, int Index, const char* Code, int Low, int High, float Volume)
+    {
+        s_OrderFlowEvent Event;
+        Event.TimeMs = DateTimeToMs(sc.BaseDateTimeIn[Index]);
+        Event.Code = Code;
+        Event.LowTick = Low;
+        Event.HighTick = High;
+        Event.Volume = Volume;
+        Events.push_back(Event);
+    }
+};
@@ -0,0 +1,153 @@
+// TradeFlow Pro raw bar batches
+// Closed bars copied out of sc.BaseDataIn and the streaming calculations as
+// plain values, so a batch can be encoded away from the chart thread (see
+// TradeFlow_Pro_EncoderPool.h). EncodeTradeFlowBatch writes the same JSON as
+// CreateTradeFlowBatchJSON; bar times are printed to the second, as
+// sc.FormatDateTime prints them. Uses only the standard library.
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+const int RAW_BAR_MAX_EMAS = 3;     // TRADEFLOW_MAX_EMAS
+
+struct s_RawBar
+{
+    long long TimeMs = 0;           // Milliseconds since the SCDateTime epoch
+    float Open = 0, High = 0, Low = 0, Close = 0;
+    float Volume = 0;
+    float BidVolume = 0;            // 0 when the array is missing or empty at the bar
+    float AskVolume = 0;
+    float OpenInterest = 0;
+    int Trades = 0;
+    bool HasCalcs = false;
+    double Delta = 0, CVD = 0;
+    double VWAP = 0, VWAPUpper = 0, VWAPLower = 0;
+    double EMA[RAW_BAR_MAX_EMAS] = { 0, 0, 0 };
+};
+
+struct s_RawBarBatch
+{
+    std::string Symbol;
+    int ChartNumber = 0;
+    int SecondsPerBar = 0;
+    bool Delta = false;             // Enabled calculations, as s_StreamingCalcConfig
+    bool CVD = false;
+    bool VWAP = false;
+    int EMAPeriods[RAW_BAR_MAX_EMAS] = { 0, 0, 0 };
+    std::string DataSource;
+    std::string CollectedAt;        // sc.FormatDateTime(sc.CurrentSystemDateTime) at capture
+    std::vector<s_RawBar> Bars;
+};
+
+// "YYYY-MM-DD HH:MM:SS" from milliseconds since 1899-12-30
+inline void AppendRawBarTime(std::string& Out, long long Ms)
+{
+    long long Days = Ms / 86400000;
+    long long MsOfDay = Ms % 86400000;
+    long long z = Days - 25569 + 719468;
+    long long Era = (z >= 0 ? z : z - 146096) / 146097;
+    long long DayOfEra = z - Era * 146097;
+    long long YearOfEra = (DayOfEra - DayOfEra / 1460 + DayOfEra / 36524 - DayOfEra / 146096) / 365;
+    long long DayOfYear = DayOfEra - (365 * YearOfEra + YearOfEra / 4 - YearOfEra / 100);
+    long long MonthPart = (5 * DayOfYear + 2) / 153;
+    int Day = (int)(DayOfYear - (153 * MonthPart + 2) / 5 + 1);
+    int Month = (int)(MonthPart < 10 ? MonthPart + 3 : MonthPart - 9);
+    int Year = (int)(YearOfEra + Era * 400 + (Month <= 2 ? 1 : 0));
+
+    char Text[32];
+    int Length = snprintf(Text, sizeof(Text), "%04d-%02d-%02d %02d:%02d:%02d", Year, Month, Day,
+        (int)(MsOfDay / 3600000), (int)(MsOfDay / 60000 % 60), (int)(MsOfDay / 1000 % 60));
+    Out.append(Text, (size_t)Length);
+}
+
+inline void AppendRawBarFormat(std::string& Out, const char* Format, double Value)
+{
+    char Text[64];
+    int Length = snprintf(Text, sizeof(Text), Format, Value);
+    Out.append(Text, (size_t)Length);
+}
+
+// CreateTradeFlowBarBody followed by CreateTradeFlowBarTail
+inline void EncodeTradeFlowBar(const s_RawBarBatch& Batch, const s_RawBar& Bar, std::string& Out)
+{
+    Out += "{\"timestamp\":\"";
+    AppendRawBarTime(Out, Bar.TimeMs);
+    AppendRawBarFormat(Out, "\",\"open\":%f,", Bar.Open);
+    AppendRawBarFormat(Out, "\"high\":%f,", Bar.High);
+    AppendRawBarFormat(Out, "\"low\":%f,", Bar.Low);
+    AppendRawBarFormat(Out, "\"close\":%f,", Bar.Close);
+    AppendRawBarFormat(Out, "\"volume\":%.0f,", Bar.Volume);
+    if (Bar.BidVolume != 0)
+        AppendRawBarFormat(Out, "\"bid_volume\":%.0f,", Bar.BidVolume);
+    else
+        Out += "\"bid_volume\":0.0,";
+    if (Bar.AskVolume != 0)
+        AppendRawBarFormat(Out, "\"ask_volume\":%.0f,", Bar.AskVolume);
+    else
+        Out += "\"ask_volume\":0.0,";
+    Out += "\"number_of_trades\":";
+    Out += std::to_string(Bar.Trades);
+    Out += ",";
+    if (Bar.OpenInterest != 0)
+        AppendRawBarFormat(Out, "\"open_interest\":%.0f,", Bar.OpenInterest);
+    else
+        Out += "\"open_interest\":null,";
+
+    // s_StreamingCalcs::AppendJSON
+    if (Bar.HasCalcs)
+    {
+        if (Batch.Delta)
+            AppendRawBarFormat(Out, "\"delta\":%.0f,", Bar.Delta);
+        if (Batch.CVD)
+            AppendRawBarFormat(Out, "\"cvd\":%.0f,", Bar.CVD);
+        if (Batch.VWAP)
+        {
+            AppendRawBarFormat(Out, "\"vwap\":%f,", Bar.VWAP);
+            AppendRawBarFormat(Out, "\"vwap_upper\":%f,", Bar.VWAPUpper);
+            AppendRawBarFormat(Out, "\"vwap_lower\":%f,", Bar.VWAPLower);
+        }
+        bool First = true;
+        for (int e = 0; e < RAW_BAR_MAX_EMAS; e++)
+        {
+            if (Batch.EMAPeriods[e] <= 0)
+                continue;
+            Out += First ? "\"ema\":{\"" : ",\"";
+            Out += std::to_string(Batch.EMAPeriods[e]);
+            AppendRawBarFormat(Out, "\":%f", Bar.EMA[e]);
+            First = false;
+        }
+        if (!First)
+            Out += "},";
+    }
+
+    Out += "\"chart_info\":{\"symbol\":\"";
+    Out += Batch.Symbol;
+    Out += "\",\"chart_number\":";
+    Out += std::to_string(Batch.ChartNumber);
+    Out += ",\"seconds_per_bar\":";
+    Out += std::to_string(Batch.SecondsPerBar);
+    Out += "},\"source\":\"sierra_chart\",\"collected_at\":\"";
+    Out += Batch.CollectedAt;
+    Out += "\"}";
+}
+
+// CreateTradeFlowBatchJSON for the captured bars
+inline void EncodeTradeFlowBatch(const s_RawBarBatch& Batch, std::string& Out)
+{
+    Out += "{\"data\":[";
+    for (size_t i = 0; i < Batch.Bars.size(); i++)
+    {
+        if (i > 0)
+            Out += ",";
+        EncodeTradeFlowBar(Batch, Batch.Bars[i], Out);
+    }
+    Out += "],\"metadata\":{\"source\":\"";
+    Out += Batch.DataSource;
+    Out += "\",\"collected_at\":\"";
+    Out += Batch.CollectedAt;
+    Out += "\",\"total_bars\":";
+    Out += std::to_string(Batch.Bars.size());
+    Out += "}}";
+}
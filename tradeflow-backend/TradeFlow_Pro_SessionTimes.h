@@ -0,0 +1,87 @@
+// TradeFlow Pro chart session times
+// The chart's session times (Chart Settings > Session Times) posted to the
+// backend, which compiles them into the symbol's session calendar for the
+// volume profile and TPO sessions unless one is configured for the symbol
+// there. Times are seconds after midnight in the chart's time zone, the zone
+// bar timestamps are sent in. Sent whenever they change and again every
+// SESSION_TIMES_RESEND_SECONDS, so a restarted backend learns them back.
+#pragma once
+
+const int SESSION_TIMES_RESEND_SECONDS = 900;
+
+struct s_SessionTimes
+{
+    int StartTime = 0;
+    int EndTime = 0;            // Inclusive, as Sierra Chart keeps it
+    bool UseEvening = false;
+    int EveningStartTime = 0;
+    int EveningEndTime = 0;
+    bool Changed = true;        // Not yet sent since the last change
+    bool InFlight = false;      // Carried by the pending request
+    SCDateTime LastSent;
+
+    void Reset()
+    {
+        Changed = true;
+        InFlight = false;
+        LastSent.Clear();
+    }
+
+    void Update(SCStudyInterfaceRef sc)
+    {
+        int Start = (int)sc.StartTime1;
+        int End = (int)sc.EndTime1;
+        bool Evening = sc.UseSecondStartEndTimes != 0;
+        int EveningStart = Evening ? (int)sc.StartTime2 : 0;
+        int EveningEnd = Evening ? (int)sc.EndTime2 : 0;
+        if (Start == StartTime && End == EndTime && Evening == UseEvening &&
+            EveningStart == EveningStartTime && EveningEnd == EveningEndTime)
+            return;
+        StartTime = Start;
+        EndTime = End;
+        UseEvening = Evening;
+        EveningStartTime = EveningStart;
+        EveningEndTime = EveningEnd;
+        Changed = true;
+    }
+
+    bool Due(SCStudyInterfaceRef sc) const
+    {
+        return Changed || LastSent.IsUnset() ||
+            sc.CurrentSystemDateTime - LastSent >= SCDateTime::SECONDS(SESSION_TIMES_RESEND_SECONDS);
+    }
+
+    // Marks the times sent when the request is made; a failed request makes
+    // them due again through Retry
+    void Sending(SCStudyInterfaceRef sc)
+    {
+        InFlight = true;
+        Changed = false;
+        LastSent = sc.CurrentSystemDateTime;
+    }
+
+    int Acknowledge()
+    {
+        InFlight = false;
+        return 0;
+    }
+
+    void Retry()
+    {
+        if (InFlight)
+            Changed = true;
+        InFlight = false;
+    }
+
+    // {"symbol":..., "start_time":..., "end_time":..., "use_evening_session":..., ...}
+    SCString CreateJSON(SCStudyInterfaceRef sc) const
+    {
+        SCString json;
+        json += "{\"symbol\":\"";
+        json += sc.Symbol.GetChars();
+        json += SCString().Format("\",\"start_time\":%d,\"end_time\":%d,\"use_evening_session\":%s,"
+            "\"evening_start_time\":%d,\"evening_end_time\":%d}",
+            StartTime, EndTime, UseEvening ? "true" : "false", EveningStartTime, EveningEndTime);
+        return json;
+    }
+};
@@ -0,0 +1,59 @@
+// TradeFlow Pro request slices
+// A request body described as a list of slices instead of one concatenated
+// string: literal envelope pieces, the per-request metadata, and encoded bars
+// referenced in place (cached bodies are not copied to build the request). The
+// list has iovec layout, so a native Linux sender (native/uring.h,
+// s_UringSlice) can write it with vectored writes and never build a body;
+// sc.MakeHTTPPOSTRequest needs one string, and Flatten copies every byte once.
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+
+struct s_TradeFlowSlice
+{
+    const char* Data;
+    size_t Length;
+};
+
+struct s_TradeFlowSlices
+{
+    std::vector<s_TradeFlowSlice> Slices;
+    std::deque<std::string> Owned;      // Pieces made for this request only; stable addresses
+    size_t Length = 0;
+
+    void Clear()
+    {
+        Slices.clear();
+        Owned.clear();
+        Length = 0;
+    }
+
+    // References Data in place until the request is sent. Data must be a
+    // complete NUL-terminated string (a literal or a whole std::string).
+    void Add(const char* Data, size_t Size)
+    {
+        if (Size == 0)
+            return;
+        Slices.push_back({ Data, Size });
+        Length += Size;
+    }
+
+    void Add(const std::string& Piece) { Add(Piece.c_str(), Piece.size()); }
+
+    // Keeps Piece with the request and references it
+    void Own(std::string&& Piece)
+    {
+        Owned.push_back(std::move(Piece));
+        Add(Owned.back());
+    }
+
+    SCString Flatten() const
+    {
+        SCString json;
+        for (const s_TradeFlowSlice& Slice : Slices)
+            json += Slice.Data;
+        return json;
+    }
+};
@@ -0,0 +1,211 @@
+// TradeFlow Pro streaming bar calculations
+// Per-bar delta, session CVD, session VWAP with standard deviation bands and a
+// small EMA set, maintained incrementally from sc.BaseDataIn and shipped as
+// extra fields on each bar. Disabled calculations allocate and compute nothing.
+#pragma once
+
+#include <vector>
+
+const int TRADEFLOW_MAX_EMAS = 3;
+
+struct s_StreamingCalcConfig
+{
+    bool Delta = false;
+    bool CVD = false;
+    bool VWAP = false;
+    double VWAPBandMultiplier = 2.0;
+    int EMAPeriods[TRADEFLOW_MAX_EMAS] = { 0, 0, 0 };  // 0 = slot disabled
+
+    bool AnyEMA() const
+    {
+        for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+            if (EMAPeriods[e] > 0)
+                return true;
+        return false;
+    }
+
+    bool AnyEnabled() const { return Delta || CVD || VWAP || AnyEMA(); }
+
+    bool operator==(const s_StreamingCalcConfig& Other) const
+    {
+        for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+            if (EMAPeriods[e] != Other.EMAPeriods[e])
+                return false;
+        return Delta == Other.Delta && CVD == Other.CVD && VWAP == Other.VWAP
+            && VWAPBandMultiplier == Other.VWAPBandMultiplier;
+    }
+};
+
+struct s_StreamingCalcs
+{
+    s_StreamingCalcConfig Config;
+    int ComputedThrough = -1;  // Highest bar index with computed values
+
+    // Per-bar results, indexed like sc.BaseDataIn. Each bar depends only on the
+    // previous bar, so recomputing the forming bar on every update is O(1);
+    // recomputing an older bar carries forward through the newest computed bar.
+    std::vector<double> Delta;
+    std::vector<double> CVD;
+    std::vector<double> SumPriceVolume;   // Session accumulators for VWAP
+    std::vector<double> SumVolume;
+    std::vector<double> SumPrice2Volume;
+    std::vector<double> EMA[TRADEFLOW_MAX_EMAS];
+
+    void Configure(const s_StreamingCalcConfig& NewConfig)
+    {
+        if (NewConfig == Config)
+            return;
+        Config = NewConfig;
+        Reset();
+    }
+
+    void Reset()
+    {
+        ComputedThrough = -1;
+        Delta.clear();
+        CVD.clear();
+        SumPriceVolume.clear();
+        SumVolume.clear();
+        SumPrice2Volume.clear();
+        for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+            EMA[e].clear();
+    }
+
+    bool HasValues(int Index) const
+    {
+        return Config.AnyEnabled() && Index >= 0 && Index <= ComputedThrough;
+    }
+
+    // Brings values up to date through Index; called once per study call
+    void Update(SCStudyInterfaceRef sc, int Index)
+    {
+        if (!Config.AnyEnabled() || Index < 0 || Index >= sc.ArraySize)
+            return;
+
+        if (sc.IsFullRecalculation && Index == 0)
+            Reset();
+
+        Grow(sc.ArraySize);
+
+        // Fill any bars skipped since the last call (e.g. calcs enabled mid-chart)
+        for (int i = ComputedThrough + 1; i < Index; i++)
+            ComputeBar(sc, i);
+
+        // Later bars accumulate from this one, so a recomputed older bar is
+        // carried through everything computed after it
+        int Through = min(max(Index, ComputedThrough), sc.ArraySize - 1);
+        for (int i = Index; i <= Through; i++)
+            ComputeBar(sc, i);
+        ComputedThrough = Through;
+    }
+
+    double VWAP(int Index) const
+    {
+        return SumVolume[Index] > 0 ? SumPriceVolume[Index] / SumVolume[Index] : 0.0;
+    }
+
+    double VWAPStdDev(int Index) const
+    {
+        if (SumVolume[Index] <= 0)
+            return 0.0;
+        double Mean = VWAP(Index);
+        double Variance = SumPrice2Volume[Index] / SumVolume[Index] - Mean * Mean;
+        return Variance > 0 ? sqrt(Variance) : 0.0;
+    }
+
+    // Appends the enabled fields as "name":value, pairs (each with a trailing comma)
+    void AppendJSON(SCString& json, int Index) const
+    {
+        if (!HasValues(Index))
+            return;
+
+        if (Config.Delta)
+            json += SCString().Format("\"delta\":%.0f,", Delta[Index]);
+
+        if (Config.CVD)
+            json += SCString().Format("\"cvd\":%.0f,", CVD[Index]);
+
+        if (Config.VWAP)
+        {
+            double Mean = VWAP(Index);
+            double Band = VWAPStdDev(Index) * Config.VWAPBandMultiplier;
+            json += SCString().Format("\"vwap\":%f,\"vwap_upper\":%f,\"vwap_lower\":%f,",
+                Mean, Mean + Band, Mean - Band);
+        }
+
+        if (Config.AnyEMA())
+        {
+            json += "\"ema\":{";
+            bool First = true;
+            for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+            {
+                if (Config.EMAPeriods[e] <= 0)
+                    continue;
+                if (!First)
+                    json += ",";
+                json += SCString().Format("\"%d\":%f", Config.EMAPeriods[e], EMA[e][Index]);
+                First = false;
+            }
+            json += "},";
+        }
+    }
+
+private:
+    void Grow(int Size)
+    {
+        size_t Target = (size_t)Size;
+        if (Config.Delta || Config.CVD)
+        {
+            if (Delta.size() < Target) Delta.resize(Target, 0.0);
+        }
+        if (Config.CVD)
+        {
+            if (CVD.size() < Target) CVD.resize(Target, 0.0);
+        }
+        if (Config.VWAP)
+        {
+            if (SumPriceVolume.size() < Target) SumPriceVolume.resize(Target, 0.0);
+            if (SumVolume.size() < Target) SumVolume.resize(Target, 0.0);
+            if (SumPrice2Volume.size() < Target) SumPrice2Volume.resize(Target, 0.0);
+        }
+        for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+        {
+            if (Config.EMAPeriods[e] > 0 && EMA[e].size() < Target)
+                EMA[e].resize(Target, 0.0);
+        }
+    }
+
+    void ComputeBar(SCStudyInterfaceRef sc, int i)
+    {
+        bool NewSession = i == 0
+            || sc.GetTradingDayDate(sc.BaseDateTimeIn[i]) != sc.GetTradingDayDate(sc.BaseDateTimeIn[i - 1]);
+
+        if (Config.Delta || Config.CVD)
+        {
+            double AskVolume = sc.BaseDataIn[SC_ASKVOL].GetArraySize() > 0 ? sc.BaseDataIn[SC_ASKVOL][i] : 0.0;
+            double BidVolume = sc.BaseDataIn[SC_BIDVOL].GetArraySize() > 0 ? sc.BaseDataIn[SC_BIDVOL][i] : 0.0;
+            Delta[i] = AskVolume - BidVolume;  // Buyers - Sellers, same as the backend
+        }
+
+        if (Config.CVD)
+            CVD[i] = (NewSession ? 0.0 : CVD[i - 1]) + Delta[i];
+
+        if (Config.VWAP)
+        {
+            double TypicalPrice = (sc.BaseDataIn[SC_HIGH][i] + sc.BaseDataIn[SC_LOW][i] + sc.BaseDataIn[SC_LAST][i]) / 3.0;
+            double Volume = sc.BaseDataIn[SC_VOLUME][i];
+            SumPriceVolume[i] = (NewSession ? 0.0 : SumPriceVolume[i - 1]) + TypicalPrice * Volume;
+            SumVolume[i] = (NewSession ? 0.0 : SumVolume[i - 1]) + Volume;
+            SumPrice2Volume[i] = (NewSession ? 0.0 : SumPrice2Volume[i - 1]) + TypicalPrice * TypicalPrice * Volume;
+        }
+
+        double Close = sc.BaseDataIn[SC_LAST][i];
+        for (int e = 0; e < TRADEFLOW_MAX_EMAS; e++)
+        {
+            if (Config.EMAPeriods[e] <= 0)
+                continue;
+            double Alpha = 2.0 / (Config.EMAPeriods[e] + 1.0);
+            EMA[e][i] = i == 0 ? Close : EMA[e][i - 1] + Alpha * (Close - EMA[e][i - 1]);
+        }
+    }
+};
@@ -0,0 +1,97 @@
+// TradeFlow Pro Time & Sales reader
+// One pass per study call over the Time & Sales records added since the last
+// call, handing each trade (in ticks, chart time zone milliseconds) to every
+// tick-level consumer: custom bars, large trade detection.
+#pragma once
+
+struct s_Trade
+{
+    long long TimeMs = 0;   // Chart time zone, milliseconds since the SCDateTime epoch
+    int PriceTicks = 0;
+    double Volume = 0;
+    bool AtAsk = false;     // Buyer initiated
+    double RestingSize = 0; // Displayed size on the side that was hit (bid size for sells, ask size for buys)
+};
+
+inline long long DateTimeToMs(const SCDateTime& DateTime)
+{
+    return (long long)floor(DateTime.GetAsDouble() * 86400000.0 + 0.5);
+}
+
+// "YYYY-MM-DD HH:MM:SS.mmm" from milliseconds since 1899-12-30
+inline SCString FormatTradeFlowTime(long long Ms)
+{
+    long long Days = Ms / 86400000;
+    long long MsOfDay = Ms % 86400000;
+
+    // Civil date from days since 1970-01-01 (proleptic Gregorian)
+    long long z = Days - 25569 + 719468;
+    long long Era = (z >= 0 ? z : z - 146096) / 146097;
+    long long DayOfEra = z - Era * 146097;
+    long long YearOfEra = (DayOfEra - DayOfEra / 1460 + DayOfEra / 36524 - DayOfEra / 146096) / 365;
+    long long DayOfYear = DayOfEra - (365 * YearOfEra + YearOfEra / 4 - YearOfEra / 100);
+    long long MonthPart = (5 * DayOfYear + 2) / 153;
+    int Day = (int)(DayOfYear - (153 * MonthPart + 2) / 5 + 1);
+    int Month = (int)(MonthPart < 10 ? MonthPart + 3 : MonthPart - 9);
+    int Year = (int)(YearOfEra + Era * 400 + (Month <= 2 ? 1 : 0));
+
+    return SCString().Format("%04d-%02d-%02d %02d:%02d:%02d.%03d", Year, Month, Day,
+        (int)(MsOfDay / 3600000), (int)(MsOfDay / 60000 % 60), (int)(MsOfDay / 1000 % 60), (int)(MsOfDay % 1000));
+}
+
+struct s_TimeAndSalesReader
+{
+    unsigned LastSequence = 0;   // Newest record consumed
+    bool Primed = false;         // False until the first pass sets LastSequence
+
+    void Reset()
+    {
+        LastSequence = 0;
+        Primed = false;
+    }
+
+    // Calls Sink(const s_Trade&) for each trade newer than the last pass. The
+    // first pass only records the newest sequence so enabling the collector
+    // never replays the buffered session.
+    template <typename t_Sink>
+    void Read(SCStudyInterfaceRef sc, t_Sink&& Sink)
+    {
+        c_SCTimeAndSalesArray TimeSales;
+        sc.GetTimeAndSales(TimeSales);
+        int Count = TimeSales.Size();
+        if (Count == 0)
+            return;
+
+        unsigned Newest = TimeSales[Count - 1].Sequence;
+        if (!Primed || Newest < LastSequence)
+        {
+            // First pass, or the feed reconnected and restarted its sequence
+            LastSequence = Newest;
+            Primed = true;
+            return;
+        }
+
+        // Records are oldest first; walk back to the first unseen one
+        int First = Count;
+        while (First > 0 && TimeSales[First - 1].Sequence > LastSequence)
+            First--;
+
+        float TickSize = sc.TickSize > 0 ? sc.TickSize : 1.0f;
+        for (int r = First; r < Count; r++)
+        {
+            const s_TimeAndSales& Record = TimeSales[r];
+            if ((Record.Type != SC_TS_BID && Record.Type != SC_TS_ASK) || Record.Volume == 0)
+                continue;
+
+            s_Trade Trade;
+            // Time & Sales times are UTC; everything is sent in the chart time zone
+            Trade.TimeMs = DateTimeToMs(Record.DateTime + sc.TimeScaleAdjustment);
+            Trade.PriceTicks = (int)floor(Record.Price * sc.RealTimePriceMultiplier / TickSize + 0.5);
+            Trade.Volume = (double)Record.Volume;
+            Trade.AtAsk = Record.Type == SC_TS_ASK;
+            Trade.RestingSize = (double)(Trade.AtAsk ? Record.AskSize : Record.BidSize);
+            Sink(Trade);
+        }
+        LastSequence = Newest;
+    }
+};
@@ -30,6 +30,33 @@ class BollingerRequest(IndicatorRequest):
     period: int = 20
     std_dev: float = 2.0
 
+async def _indicator_series(
+    kind: str,
+    params: tuple,
+    symbol: str,
+    timeframe: str,
+    limit: int,
+    market_data_service: MarketDataService,
+    indicator_service: IndicatorService
+):
+    """
+    Serve from the warm per-(symbol, timeframe, params) stream when possible,
+    otherwise cold-start from get_bars. Returns [{time, value}] oldest -> newest.
+    """
+    warm = indicator_service.get_warm_series(kind, params, symbol, timeframe, limit)
+    if warm is not None:
+        return warm
+
+    bars = await market_data_service.get_bars(symbol, timeframe, limit)
+    if not bars:
+        raise HTTPException(status_code=404, detail="No data found for symbol")
+
+    # Only raw timeframes are fed by ingest, aggregated ones would go stale
+    return indicator_service.compute_series(
+        kind, params, symbol, timeframe, bars, limit,
+        keep_warm=market_data_service.is_raw_timeframe(timeframe)
+    )
+
 @router.get("/sma")
 async def get_sma(
     symbol: str = Query(...),
@@ -39,47 +66,9 @@ async def get_sma(
     market_data_service: MarketDataService = Depends(),
     indicator_service: IndicatorService = Depends(lambda: indicator_service)
 ):
-    bars = await market_data_service.get_bars(symbol, timeframe, limit)
-    if not bars:
-        raise HTTPException(status_code=404, detail="No data found for symbol")
-    
-    closes = [bar['close'] for bar in bars]
-    closes.reverse()
-    
-    values = indicator_service.calculate_sma(closes, period)
-    
-    # Map values back to timestamps
-    # bars is newest first, closes was reversed to oldest first
-    # values corresponds to closes (oldest first)
-    # We want to return [{time: ..., value: ...}]
-    
-    result = []
-    # Pad with None for initial period where indicator is not calculated
-    # But calculate_sma usually returns list of same length with NaNs or shorter list?
-    # Let's assume it returns list of same length with None/NaN for first (period-1) elements
-    
-    # Actually, let's check indicator_service implementation. 
-    # Assuming it returns a list aligned with input closes.
-    
-    for i, val in enumerate(values):
-        # closes[i] corresponds to bars[len(bars)-1-i]
-        # bars is DESC (newest at 0)
-        # closes is ASC (oldest at 0)
-        
-        # So values[i] corresponds to closes[i] which is bars[len(bars)-1-i]
-        bar_idx = len(bars) - 1 - i
-        if bar_idx >= 0:
-            result.append({
-                "time": bars[bar_idx]['time'],
-                "value": val
-            })
-            
-    # Result is now Oldest -> Newest
-    # Frontend might expect Newest -> Oldest or just time-value pairs
-    # Let's return as is (Oldest -> Newest) or reverse?
-    # The frontend client.ts seems to expect just .json() and then map it.
-    
-    return result
+    return await _indicator_series(
+        "sma", (period,), symbol, timeframe, limit, market_data_service, indicator_service
+    )
 
 @router.get("/ema")
 async def get_ema(
@@ -90,24 +79,9 @@ async def get_ema(
     market_data_service: MarketDataService = Depends(),
     indicator_service: IndicatorService = Depends(lambda: indicator_service)
 ):
-    bars = await market_data_service.get_bars(symbol, timeframe, limit)
-    if not bars:
-        raise HTTPException(status_code=404, detail="No data found for symbol")
-    
-    closes = [bar['close'] for bar in bars]
-    closes.reverse()
-    
-    values = indicator_service.calculate_ema(closes, period)
-    
-    result = []
-    for i, val in enumerate(values):
-        bar_idx = len(bars) - 1 - i
-        if bar_idx >= 0:
-            result.append({
-                "time": bars[bar_idx]['time'],
-                "value": val
-            })
-    return result
+    return await _indicator_series(
+        "ema", (period,), symbol, timeframe, limit, market_data_service, indicator_service
+    )
 
 @router.get("/rsi")
 async def get_rsi(
@@ -118,24 +92,9 @@ async def get_rsi(
     market_data_service: MarketDataService = Depends(),
     indicator_service: IndicatorService = Depends(lambda: indicator_service)
 ):
-    bars = await market_data_service.get_bars(symbol, timeframe, limit)
-    if not bars:
-        raise HTTPException(status_code=404, detail="No data found for symbol")
-    
-    closes = [bar['close'] for bar in bars]
-    closes.reverse()
-    
-    values = indicator_service.calculate_rsi(closes, period)
-    
-    result = []
-    for i, val in enumerate(values):
-        bar_idx = len(bars) - 1 - i
-        if bar_idx >= 0:
-            result.append({
-                "time": bars[bar_idx]['time'],
-                "value": val
-            })
-    return result
+    return await _indicator_series(
+        "rsi", (period,), symbol, timeframe, limit, market_data_service, indicator_service
+    )
 
 @router.get("/macd")
 async def get_macd(
@@ -148,29 +107,10 @@ async def get_macd(
     market_data_service: MarketDataService = Depends(),
     indicator_service: IndicatorService = Depends(lambda: indicator_service)
 ):
-    bars = await market_data_service.get_bars(symbol, timeframe, limit)
-    if not bars:
-        raise HTTPException(status_code=404, detail="No data found for symbol")
-    
-    closes = [bar['close'] for bar in bars]
-    closes.reverse()
-    
-    calc_res = indicator_service.calculate_macd(closes, fast_period, slow_period, signal_period)
-    
-    result = []
-    # Assuming all lists in calc_res are same length and aligned with closes
-    for i in range(len(closes)):
-        bar_idx = len(bars) - 1 - i
-        if bar_idx >= 0:
-            result.append({
-                "time": bars[bar_idx]['time'],
-                "value": {
-                    "macd": calc_res["macd"][i],
-                    "signal": calc_res["signal"][i],
-                    "histogram": calc_res["histogram"][i]
-                }
-            })
-    return result
+    return await _indicator_series(
+        "macd", (fast_period, slow_period, signal_period), symbol, timeframe, limit,
+        market_data_service, indicator_service
+    )
 
 @router.get("/bollinger")
 async def get_bollinger(
@@ -182,25 +122,7 @@ async def get_bollinger(
     market_data_service: MarketDataService = Depends(),
     indicator_service: IndicatorService = Depends(lambda: indicator_service)
 ):
-    bars = await market_data_service.get_bars(symbol, timeframe, limit)
-    if not bars:
-        raise HTTPException(status_code=404, detail="No data found for symbol")
-    
-    closes = [bar['close'] for bar in bars]
-    closes.reverse()
-    
-    calc_res = indicator_service.calculate_bollinger_bands(closes, period, std_dev)
-    
-    result = []
-    for i in range(len(closes)):
-        bar_idx = len(bars) - 1 - i
-        if bar_idx >= 0:
-            result.append({
-                "time": bars[bar_idx]['time'],
-                "value": {
-                    "upper": calc_res["upper"][i],
-                    "middle": calc_res["middle"][i],
-                    "lower": calc_res["lower"][i]
-                }
-            })
-    return result
+    return await _indicator_series(
+        "bollinger", (period, std_dev), symbol, timeframe, limit,
+        market_data_service, indicator_service
+    )
@@ -1,11 +1,17 @@
 from fastapi import APIRouter, Header, HTTPException, BackgroundTasks, Depends, Request, Body
-from pydantic import BaseModel, Field
-from typing import Optional, List
+from pydantic import BaseModel, Field, ValidationError
+from typing import Optional, List, Dict
 from datetime import datetime, timedelta
 import logging
 
+from app.core.dedupe import batch_deduper, parse_seq_range
+from app.core.downsample import LINE_METHODS
 from app.core.security import verify_api_key
 from app.services.market_data_service import MarketDataService
+from app.services.alert_service import alert_service
+from app.services.heatmap_service import heatmap_service
+from app.services.orderflow_service import orderflow_service
+from app.services.session_service import session_service
 
 router = APIRouter()
 logger = logging.getLogger(__name__)
@@ -14,6 +20,14 @@ class ChartInfo(BaseModel):
     symbol: Optional[str] = "UNKNOWN"
     chart_number: Optional[int] = 1
     seconds_per_bar: Optional[int] = 60
+    # Stream id of a collector-built custom bar (e.g. "range8t", "renko4t");
+    # stored as the timeframe instead of the chart's seconds per bar
+    bar_type: Optional[str] = None
+
+    def timeframe(self) -> str:
+        if self.bar_type:
+            return self.bar_type
+        return f"{self.seconds_per_bar}s" if self.seconds_per_bar else "1m"
 
 class SierraChartBar(BaseModel):
     timestamp: Optional[str] = None
@@ -26,6 +40,13 @@ class SierraChartBar(BaseModel):
     ask_volume: Optional[float] = None
     number_of_trades: Optional[int] = None
     open_interest: Optional[float] = None
+    # Collector-side calculations, present only when enabled in the study
+    delta: Optional[float] = None
+    cvd: Optional[float] = None
+    vwap: Optional[float] = None
+    vwap_upper: Optional[float] = None
+    vwap_lower: Optional[float] = None
+    ema: Optional[Dict[str, float]] = None
     chart_info: Optional[ChartInfo] = ChartInfo()
 
     @classmethod
@@ -40,6 +61,26 @@ class SierraChartBatch(BaseModel):
     data: List[SierraChartBar]
     metadata: dict
 
+class OrderFlowEventBatch(BaseModel):
+    symbol: str
+    seconds_per_bar: Optional[int] = 60
+    # [bar timestamp, code, low price, high price, volume]
+    events: List[list]
+
+class HeatmapTileBatch(BaseModel):
+    symbol: str
+    # [column start, column seconds, row size, low price, scale, cells]
+    tiles: List[list]
+
+class ChartSessionTimes(BaseModel):
+    symbol: str
+    # Seconds after midnight in the chart's time zone; end times are inclusive
+    start_time: int = Field(ge=0, lt=86400)
+    end_time: int = Field(ge=0, lt=86400)
+    use_evening_session: bool = False
+    evening_start_time: int = Field(0, ge=0, lt=86400)
+    evening_end_time: int = Field(0, ge=0, lt=86400)
+
 @router.post("")
 @router.post("/")
 async def receive_market_data(
@@ -65,7 +106,7 @@ async def receive_market_data(
 
     # Extract data with defaults
     symbol = request.chart_info.symbol if request.chart_info else "UNKNOWN"
-    timeframe = f"{request.chart_info.seconds_per_bar}s" if request.chart_info and request.chart_info.seconds_per_bar else "1m"
+    timeframe = request.chart_info.timeframe() if request.chart_info else "1m"
 
     # Parse timestamp
     if request.timestamp:
@@ -91,7 +132,13 @@ async def receive_market_data(
         bid_volume=request.bid_volume,
         ask_volume=request.ask_volume,
         number_of_trades=request.number_of_trades,
-        open_interest=request.open_interest
+        open_interest=request.open_interest,
+        delta=request.delta,
+        cvd=request.cvd,
+        vwap=request.vwap,
+        vwap_upper=request.vwap_upper,
+        vwap_lower=request.vwap_lower,
+        ema=request.ema
     )
 
     # Schedule background tasks
@@ -111,6 +158,11 @@ async def receive_market_data(
         symbol, request.dict()
     )
 
+    background_tasks.add_task(
+        alert_service.process_bar,
+        symbol, request.high, request.low
+    )
+
     return {
         "status": "success",
         "symbol": symbol,
@@ -147,7 +199,7 @@ async def receive_market_data_debug(
         try:
             chart_bar = SierraChartBar(**raw_data)
             symbol = chart_bar.chart_info.symbol
-            timeframe = f"{chart_bar.chart_info.seconds_per_bar}s"
+            timeframe = chart_bar.chart_info.timeframe()
             timestamp = chart_bar.parse_timestamp(chart_bar.timestamp)
 
             # Extract data from validated object
@@ -215,6 +267,11 @@ async def receive_market_data_debug(
             symbol, raw_data
         )
 
+        background_tasks.add_task(
+            alert_service.process_bar,
+            symbol, high_price, low_price
+        )
+
         return {
             "status": "success",
             "symbol": symbol,
@@ -229,50 +286,176 @@ async def receive_market_data_debug(
 @router.post("/batch")
 @router.post("/batch/")
 async def receive_batch(
-    request: SierraChartBatch,
+    request: Request,
     background_tasks: BackgroundTasks,
     x_api_key: Optional[str] = Header(None),
+    x_tradeflow_stream: Optional[str] = Header(None),
+    x_tradeflow_seq: Optional[str] = Header(None),
     service: MarketDataService = Depends()
 ):
     """
     Receive batch from Sierra Chart (Historical mode)
     
-    Sierra Chart sends 50-100 bars per batch
+    Sierra Chart sends 50-100 bars per batch. Batches carrying X-TradeFlow-Stream
+    and X-TradeFlow-Seq ("first-last" bar sequence numbers) are deduplicated:
+    resends of stored ranges are dropped unparsed, overlaps are trimmed.
     """
     if not verify_api_key(x_api_key):
         raise HTTPException(status_code=401, detail="Invalid API key")
-    
-    if not request.data:
+
+    seq_range = parse_seq_range(x_tradeflow_seq) if x_tradeflow_stream else None
+    skip = 0
+    if seq_range:
+        skip = batch_deduper.check(x_tradeflow_stream, *seq_range)
+        if skip is None:
+            return {"status": "duplicate", "bars_received": 0, "bars_stored": 0}
+
+    try:
+        batch = SierraChartBatch.model_validate_json(await request.body())
+    except ValidationError as e:
+        raise HTTPException(status_code=422, detail=e.errors())
+
+    if seq_range and len(batch.data) != seq_range[1] - seq_range[0] + 1:
+        # Range doesn't describe the body; store it whole rather than trim blindly
+        logger.warning(f"Batch {x_tradeflow_stream} {x_tradeflow_seq} holds {len(batch.data)} bars")
+        seq_range, skip = None, 0
+
+    bars = batch.data[skip:]
+    if not bars:
         return {"status": "empty"}
 
-    symbol = request.data[0].chart_info.symbol
-    logger.info(f"Received batch: {len(request.data)} bars for {symbol}")
+    symbol = bars[0].chart_info.symbol
+    logger.info(f"Received batch: {len(bars)} bars for {symbol}")
     
     # Bulk insert (fast!)
-    stored_count = await service.store_batch(request.data)
+    stored_count = await service.store_batch(bars)
+    if seq_range:
+        batch_deduper.commit(x_tradeflow_stream, seq_range[1])
+
+    # Price alerts see each symbol's batch as one bar spanning its range
+    ranges = {}
+    for bar in bars:
+        high, low = ranges.get(bar.chart_info.symbol, (bar.high, bar.low))
+        ranges[bar.chart_info.symbol] = (max(high, bar.high), min(low, bar.low))
+    for bar_symbol, (high, low) in ranges.items():
+        background_tasks.add_task(alert_service.process_bar, bar_symbol, high, low)
     
     return {
         "status": "success",
-        "bars_received": len(request.data),
+        "bars_received": len(batch.data),
         "bars_stored": stored_count,
         "symbol": symbol
     }
 
+@router.post("/orderflow-events")
+async def receive_orderflow_events(
+    request: OrderFlowEventBatch,
+    background_tasks: BackgroundTasks,
+    x_api_key: Optional[str] = Header(None),
+    service: MarketDataService = Depends()
+):
+    """
+    Receive order flow events detected by the Sierra Chart collector
+    (stacked imbalances, unfinished auctions, absorption, large trades, icebergs)
+    """
+    if not verify_api_key(x_api_key):
+        raise HTTPException(status_code=401, detail="Invalid API key")
+
+    stored_count, alerts = orderflow_service.on_events(request.symbol, request.seconds_per_bar or 60, request.events)
+
+    # Large trades and icebergs are pushed live, like ticks
+    if alerts:
+        background_tasks.add_task(service.broadcast_large_trades, request.symbol, alerts)
+
+    return {
+        "status": "success",
+        "events_received": len(request.events),
+        "events_stored": stored_count,
+        "symbol": request.symbol
+    }
+
+@router.post("/heatmap-tiles")
+async def receive_heatmap_tiles(
+    request: HeatmapTileBatch,
+    x_api_key: Optional[str] = Header(None)
+):
+    """
+    Receive finished liquidity heatmap tiles aggregated by the Sierra Chart
+    collector from market depth
+    """
+    if not verify_api_key(x_api_key):
+        raise HTTPException(status_code=401, detail="Invalid API key")
+
+    stored_count = await heatmap_service.on_tiles(request.symbol, request.tiles)
+    return {
+        "status": "success",
+        "tiles_received": len(request.tiles),
+        "tiles_stored": stored_count,
+        "symbol": request.symbol
+    }
+
+@router.post("/session-times")
+async def receive_session_times(
+    request: ChartSessionTimes,
+    x_api_key: Optional[str] = Header(None)
+):
+    """
+    Receive the session times of a Sierra Chart chart; they become the
+    symbol's session calendar unless SESSION_SYMBOLS names one for it
+    """
+    if not verify_api_key(x_api_key):
+        raise HTTPException(status_code=401, detail="Invalid API key")
+
+    changed = session_service.set_chart_sessions(
+        request.symbol, request.start_time, request.end_time,
+        request.use_evening_session, request.evening_start_time, request.evening_end_time
+    )
+    return {
+        "status": "success",
+        "changed": changed,
+        "symbol": request.symbol
+    }
+
 @router.get("/bars")
 async def get_market_data(
     symbol: str,
     timeframe: str = "1m",
     limit: int = 500,
+    max_points: Optional[int] = None,
     service: MarketDataService = Depends()
 ):
     """
     Get market data for charting
     
-    Supports all timeframes: 1s, 5s, 1m, 5m, 15m, 1h, 4h, 1d, 1w
+    Supports all timeframes: 1s, 5s, 1m, 5m, 15m, 1h, 4h, 1d, 1w, plus the
+    collector's custom bar streams (range8t, vol1000, tick500, delta300, renko4t).
+    With max_points below limit, consecutive bars are merged (OHLC preserved,
+    volumes summed) so at most max_points are returned.
     """
-    bars = await service.get_bars(symbol, timeframe, limit)
+    bars = await service.get_bars(symbol, timeframe, limit, max_points)
     return bars
 
+@router.get("/bars/range")
+async def get_bar_range(
+    symbol: str,
+    start_time: datetime,
+    end_time: Optional[datetime] = None,
+    max_points: int = 1000,
+    service: MarketDataService = Depends()
+):
+    """
+    Get bars for a visible time range at the finest power-of-two resolution
+    (1s, 2s, 4s ...) that returns at most max_points bars, for zooming.
+    """
+    if max_points <= 0:
+        raise HTTPException(status_code=400, detail="max_points must be positive")
+    if not end_time:
+        end_time = datetime.utcnow()
+    if end_time < start_time:
+        raise HTTPException(status_code=400, detail="end_time must not be before start_time")
+
+    return await service.get_bar_range(symbol, start_time, end_time, max_points)
+
 @router.get("/volume-profile")
 async def get_volume_profile(
     symbol: str,
@@ -311,23 +494,52 @@ async def get_footprint(
     footprint = await service.get_footprint_data(symbol, timeframe, start_time, end_time)
     return footprint
 
+@router.get("/heatmap")
+async def get_heatmap(
+    symbol: str,
+    column_seconds: int = 1,
+    start_time: Optional[datetime] = None,
+    end_time: Optional[datetime] = None,
+    decode: bool = False
+):
+    """
+    Get liquidity heatmap tiles (one per time column, oldest first).
+    column_seconds picks the resolution the collector aggregated (by default
+    1s, 10s and 60s columns). Cells are two characters per price row, lowest
+    first: time-weighted average then max resting size, each
+    scale * (q / 63)^2 for q its index in the base64url alphabet; decode=true
+    returns them as "average" and "max" lists instead.
+    """
+    if not end_time:
+        end_time = datetime.utcnow()
+    if not start_time:
+        start_time = end_time - timedelta(minutes=15)
+
+    return await heatmap_service.get_tiles(symbol, column_seconds, start_time, end_time, decode)
+
 @router.get("/cvd")
 async def get_cvd(
     symbol: str,
     timeframe: str = "1m",
     start_time: Optional[datetime] = None,
     end_time: Optional[datetime] = None,
+    max_points: Optional[int] = None,
+    method: str = "lttb",
     service: MarketDataService = Depends()
 ):
     """
     Get Cumulative Volume Delta (CVD) data.
+    max_points reduces the line with LTTB (method=lttb) or per-bucket
+    min/max points (method=minmax).
     """
+    if method not in LINE_METHODS:
+        raise HTTPException(status_code=400, detail=f"method must be one of {', '.join(LINE_METHODS)}")
     if not end_time:
         end_time = datetime.utcnow()
     if not start_time:
         start_time = end_time - timedelta(hours=1)
 
-    cvd = await service.get_cvd_data(symbol, timeframe, start_time, end_time)
+    cvd = await service.get_cvd_data(symbol, timeframe, start_time, end_time, max_points, method)
     return cvd
 
 @router.get("/symbols/{symbol}")
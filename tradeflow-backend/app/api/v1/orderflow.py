@@ -92,6 +92,15 @@ async def get_imbalances_get(
     """GET endpoint for Imbalance data - matches frontend expectations"""
     return await service.detect_imbalances(symbol, timeframe, limit, ratio)
 
+@router.get("/large-trades/{symbol}")
+async def get_large_trades_get(
+    symbol: str,
+    limit: int = Query(100, description="Number of events to fetch"),
+    service: OrderFlowService = Depends(lambda: orderflow_service)
+):
+    """GET endpoint for large trade and iceberg events detected by the collector"""
+    return service.get_large_trades(symbol, limit)
+
 def _calculate_start_time(end_time: datetime, timeframe: str, limit: int) -> datetime:
     """Calculate start time based on timeframe and limit"""
     # Convert timeframe to seconds
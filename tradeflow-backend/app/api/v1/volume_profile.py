@@ -4,6 +4,7 @@ from typing import List, Optional
 from datetime import datetime
 
 from app.services.volume_profile_service import volume_profile_service, VolumeProfileService
+from app.services.tpo_service import tpo_service
 
 router = APIRouter()
 
@@ -18,3 +19,15 @@ async def get_session_profile(
     service: VolumeProfileService = Depends(lambda: volume_profile_service)
 ):
     return await service.get_session_profile(request.symbol, request.start_time, request.end_time)
+
+@router.get("/tpo/{symbol}")
+async def get_tpo_profile(symbol: str, session_start: Optional[datetime] = None):
+    """Market profile of the live session, or of a stored session by its start"""
+    live = tpo_service.get_profile(symbol)
+    if live is not None and (session_start is None or tpo_service.same_session(live, session_start)):
+        return live
+    if session_start is not None:
+        stored = await tpo_service.get_session(symbol, session_start)
+        if stored is not None:
+            return stored
+    raise HTTPException(status_code=404, detail=f"No market profile for {symbol}")
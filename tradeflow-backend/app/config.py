@@ -1,5 +1,5 @@
 from pydantic_settings import BaseSettings
-from typing import List
+from typing import List, Dict, Any
 from functools import lru_cache
 
 class Settings(BaseSettings):
@@ -42,10 +42,50 @@ class Settings(BaseSettings):
     
     # WebSocket
     WS_MAX_CONNECTIONS_PER_USER: int = 5
+    WS_SEND_QUEUE_SIZE: int = 256  # Per-connection backlog before updates are conflated
+    
+    # Footprint store (in-memory volume at price per bar)
+    FOOTPRINT_TICK_SIZE: float = 0.01  # Matches the round(close, 2) of the SQL path
+    FOOTPRINT_TIMEFRAMES: List[str] = ["1m", "5m", "15m", "1h"]
+    FOOTPRINT_RING_BARS: int = 1000  # Recent bars per (symbol, timeframe) kept as dense ladders
+    FOOTPRINT_ARCHIVE_BARS: int = 20000  # Older bars kept as encoded columnar blocks
+    TPO_TICK_SIZE: float = 0.01
+    TPO_PERIOD_SECONDS: int = 1800  # One letter per 30 minutes
+    TPO_SESSION_OFFSET_SECONDS: int = 0  # Session start, seconds after midnight UTC, of symbols without a session calendar
+    TPO_SESSION_SECONDS: int = 86400  # Session length; bars after it are left out of the profile
+    TPO_IB_PERIODS: int = 2  # Initial balance = first two periods
+    TPO_VALUE_AREA: float = 0.70
+    TPO_FLUSH_SECONDS: int = 5  # Changed market_profile levels are written at most this often
+    ORDERFLOW_EVENTS_PER_STREAM: int = 5000  # Collector order flow events kept per (symbol, timeframe), and large trades per symbol
+    HEATMAP_TILES_PER_STREAM: int = 3600  # Collector heatmap tiles kept in memory per (symbol, column seconds)
+    INGEST_DEDUPE_STREAMS: int = 10000  # Collector batch streams whose sequence high-water mark is remembered
+    INGEST_REORDER_LATENESS_BARS: int = 3  # Bars a bar may trail its stream's newest and still reach the rollups in order; 0 disables reordering
+    INGEST_REORDER_MIN_LATENESS_MS: int = 2000  # Lateness floor, and the lateness of bar types without a fixed duration
+    INGEST_REORDER_HOLD_MS: int = 2000  # A stream with no new bars for this long has its buffered bars released
+    INGEST_REORDER_MAX_BARS: int = 4096  # Buffered bars per stream before the oldest are released early
+    INGEST_REORDER_STREAMS: int = 10000  # Streams tracked; the least recently active is released and forgotten
+    
+    # Session calendars (trading hours per symbol, shared by the volume profile and TPO sessions)
+    SESSION_CALENDARS: Dict[str, Dict[str, Any]] = {}  # Name -> {"timezone", "sessions": [{"open", "close", "days"}], "holidays", "early_closes"}
+    SESSION_SYMBOLS: Dict[str, str] = {}  # Symbol or symbol prefix -> calendar name; the longest prefix wins over the chart's session times
+    SESSION_CALENDAR_START: str = "2015-01-01"  # First trading date compiled into each calendar
+    SESSION_CALENDAR_YEARS_AHEAD: int = 3  # Trading dates compiled past today
+    
+    # Bar store (local columnar hot tier in front of TimescaleDB; empty path disables)
+    BARSTORE_PATH: str = "data/barstore"
+    BARSTORE_RETENTION_DAYS: int = 7
+    BARSTORE_TIMEFRAMES: List[str] = ["1m", "5m", "15m", "1h", "4h", "1d"]  # Rolled up from 1s bars
+    
+    # Bar pyramid (OHLCV at 1s, 2s, 4s ... buckets for zooming over a time range)
+    PYRAMID_LEVELS: int = 17  # Coarsest bucket is 2^16 s (~18h)
+    PYRAMID_LEVEL_BARS: int = 4096  # Buckets kept per level and symbol (~5.5 MB per symbol at 17 levels)
     
     # Caching
     CACHE_TTL_MARKET_DATA: int = 1  # seconds
     CACHE_TTL_INDICATORS: int = 5
+    INDICATOR_STREAMS: int = 1000  # Warm indicator streams kept (up to ~160 KB each); the least recently requested is dropped
+    READ_CACHE_MAX_ROWS: int = 500000  # In-process versioned read cache, bounded by cached rows
+    CATALOG_PERSIST_SECONDS: int = 30  # Changed stream_catalog rows are written at most this often
     
     @property
     def MARIADB_URL(self) -> str:
@@ -1,8 +1,10 @@
 from functools import wraps
+from datetime import datetime
 import json
-from typing import Callable, Any
+from typing import Callable, Any, Awaitable, Optional
 from app.db.redis import redis_manager
 from app.config import settings
+from app.core.native import native, to_micros
 
 def cache_key(*args, **kwargs) -> str:
     """Generate a cache key from arguments"""
@@ -32,3 +34,45 @@ def cached(ttl: int = 60, prefix: str = ""):
             return result
         return wrapper
     return decorator
+
+# In-process read cache for query results. Entries are tagged with the version
+# of their symbol's ingest stream; store_bar bumps the version, so stale entries
+# are detected on lookup without scanning or deleting keys.
+read_cache = native.ReadCache(settings.READ_CACHE_MAX_ROWS) if native else None
+
+def bump_stream(stream: str, timestamp: datetime):
+    """Mark everything cached from `stream` stale; call after the data is written"""
+    if read_cache:
+        read_cache.bump(stream, to_micros(timestamp))
+
+async def versioned(
+    key: str,
+    stream: str,
+    compute: Callable[[], Awaitable[Any]],
+    extend: Optional[Callable[[Any, int], Awaitable[Any]]] = None
+) -> Any:
+    """
+    Return compute() through the read cache. For a stale entry, `extend(result,
+    changed_from)` may rebuild it from only the changed tail (changed_from is the
+    earliest change time in epoch microseconds); returning None recomputes.
+    Cached results are shared, so callers must not mutate them.
+    """
+    if not read_cache:
+        return await compute()
+
+    # Read the version first: a change landing mid-query leaves the entry stale
+    version = read_cache.version(stream)
+    found = read_cache.lookup(key)
+    if found:
+        result, fresh, changed_from = found
+        if fresh:
+            return result
+        if extend and changed_from is not None:
+            extended = await extend(result, changed_from)
+            if extended is not None:
+                read_cache.put(key, stream, version, extended, max(len(extended), 1))
+                return extended
+
+    result = await compute()
+    read_cache.put(key, stream, version, result, max(len(result), 1) if isinstance(result, list) else 1)
+    return result
@@ -0,0 +1,53 @@
+from bisect import bisect_left, bisect_right
+from typing import Dict, Hashable, List, Optional
+
+class CorrectedRanges:
+    """
+    Times (epoch microseconds) that in-memory stores hold wrong or not at all.
+
+    The stores fed from ingest only take bars newer than the last one they
+    saw, so a late or backfilled bar written to market_data after them is
+    missing from ranges they still report as covered. The correction path
+    marks its times here and reads overlapping a mark fall back to
+    TimescaleDB. At most max_ranges merged [first, last] ranges are kept per
+    key; past that the two closest are joined, which only widens what is
+    treated as uncovered.
+    """
+
+    def __init__(self, max_ranges: int = 64):
+        self.max_ranges = max(1, max_ranges)
+        self._firsts: Dict[Hashable, List[int]] = {}
+        self._lasts: Dict[Hashable, List[int]] = {}
+
+    def add(self, key: Hashable, first: int, last: Optional[int] = None):
+        if last is None:
+            last = first
+        firsts = self._firsts.setdefault(key, [])
+        lasts = self._lasts.setdefault(key, [])
+
+        # Ranges overlapping or touching [first, last] are absorbed into it
+        lo = bisect_left(lasts, first - 1)
+        hi = bisect_right(firsts, last + 1)
+        if lo < hi:
+            first = min(first, firsts[lo])
+            last = max(last, lasts[hi - 1])
+        firsts[lo:hi] = [first]
+        lasts[lo:hi] = [last]
+
+        if len(firsts) > self.max_ranges:
+            gaps = [firsts[i + 1] - lasts[i] for i in range(len(firsts) - 1)]
+            i = gaps.index(min(gaps))
+            lasts[i] = lasts[i + 1]
+            del firsts[i + 1]
+            del lasts[i + 1]
+
+    def overlaps(self, key: Hashable, start: int, end: int) -> bool:
+        """True when any marked time of `key` lies in [start, end]"""
+        lasts = self._lasts.get(key)
+        if not lasts:
+            return False
+        i = bisect_left(lasts, start)
+        return i < len(lasts) and self._firsts[key][i] <= end
+
+    def __len__(self) -> int:
+        return sum(len(firsts) for firsts in self._firsts.values())
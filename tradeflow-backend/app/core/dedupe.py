@@ -0,0 +1,66 @@
+from collections import OrderedDict
+from typing import Optional, Tuple
+import re
+
+from app.config import settings
+
+_SEQ_RANGE = re.compile(r"^(\d+)-(\d+)$")
+
+def parse_seq_range(value: Optional[str]) -> Optional[Tuple[int, int]]:
+    """Parse an X-TradeFlow-Seq header ("first-last"); None when absent or malformed"""
+    if not value:
+        return None
+    match = _SEQ_RANGE.match(value.strip())
+    if not match:
+        return None
+    first, last = int(match.group(1)), int(match.group(2))
+    return (first, last) if 0 < first <= last else None
+
+class BatchDeduper:
+    """
+    Per-stream high-water marks for collector batches.
+
+    The collector retries a batch until it is acknowledged, so a lost response
+    means the same bars arrive again. Each batch names its stream and the
+    contiguous sequence range of its bars; a range at or below the stream's
+    high-water mark is a resend and is dropped before its body is parsed, and a
+    range straddling the mark has its leading bars trimmed. Marks are kept for
+    the most recently used INGEST_DEDUPE_STREAMS streams and only in memory: a
+    resend after a restart is absorbed by the ON CONFLICT upserts instead.
+    """
+
+    def __init__(self, max_streams: int):
+        self.max_streams = max(1, max_streams)
+        self._marks: "OrderedDict[str, int]" = OrderedDict()
+        self.duplicates = 0
+        self.trimmed_bars = 0
+
+    def check(self, stream: str, first: int, last: int) -> Optional[int]:
+        """Leading bars of [first, last] already stored, or None for a full duplicate"""
+        mark = self._marks.get(stream)
+        if mark is None:
+            return 0
+        self._marks.move_to_end(stream)
+        if last <= mark:
+            self.duplicates += 1
+            return None
+        skip = max(0, mark - first + 1)
+        self.trimmed_bars += skip
+        return skip
+
+    def commit(self, stream: str, last: int):
+        """Record [.., last] as stored; call only after the write succeeded"""
+        if last > self._marks.get(stream, 0):
+            self._marks[stream] = last
+        self._marks.move_to_end(stream)
+        while len(self._marks) > self.max_streams:
+            self._marks.popitem(last=False)
+
+    def get_stats(self) -> dict:
+        return {
+            "streams": len(self._marks),
+            "duplicates": self.duplicates,
+            "trimmed_bars": self.trimmed_bars
+        }
+
+batch_deduper = BatchDeduper(settings.INGEST_DEDUPE_STREAMS)
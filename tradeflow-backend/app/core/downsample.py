@@ -0,0 +1,99 @@
+from typing import List, Dict, Any
+import math
+
+import numpy as np
+
+from app.core.native import native, to_micros, from_micros
+
+# How each bar column is merged when consecutive bars share a bucket: the
+# OHLC shape and volume totals survive, running values keep the newest
+BAR_REDUCTIONS = {
+    'open': 'first',
+    'high': 'max',
+    'low': 'min',
+    'close': 'last',
+    'volume': 'sum',
+    'bid_volume': 'sum',
+    'ask_volume': 'sum',
+    'number_of_trades': 'sum',
+    'delta': 'sum',
+    'open_interest': 'last',
+    'cvd': 'last',
+    'vwap': 'last',
+    'vwap_upper': 'last',
+    'vwap_lower': 'last'
+}
+
+LINE_METHODS = ('lttb', 'minmax')
+
+def bars_to_columns(bars: List[Dict[str, Any]]) -> Dict[str, np.ndarray]:
+    """Newest-first bar rows to oldest-first columns ('time' in epoch microseconds, None as NaN)"""
+    ordered = bars[::-1]
+    columns = {'time': np.fromiter((to_micros(bar['time']) for bar in ordered), dtype=np.int64, count=len(ordered))}
+    if not ordered:
+        return columns
+    for field in BAR_REDUCTIONS:
+        if field in ordered[0]:
+            columns[field] = np.array(
+                [math.nan if bar[field] is None else bar[field] for bar in ordered], dtype=np.float64
+            )
+    return columns
+
+def _bucket_reduce(values: np.ndarray, bucket_size: int, kind: str) -> np.ndarray:
+    if native:
+        return native.bucket_reduce(values, bucket_size, kind)
+    starts = np.arange(0, len(values), bucket_size)
+    if kind == 'first':
+        return values[starts]
+    if kind == 'last':
+        return values[np.minimum(starts + bucket_size, len(values)) - 1]
+    if kind == 'sum':
+        sums = np.add.reduceat(np.nan_to_num(values), starts)
+        seen = np.logical_or.reduceat(~np.isnan(values), starts)
+        return np.where(seen, sums, math.nan)
+    return (np.fmax if kind == 'max' else np.fmin).reduceat(values, starts)
+
+def downsample_bar_columns(columns: Dict[str, np.ndarray], max_points: int) -> Dict[str, np.ndarray]:
+    """
+    Merge runs of consecutive bars so at most max_points remain. Each bucket
+    takes its first bar's time, like a higher timeframe bucket.
+    """
+    count = len(columns['time'])
+    if max_points <= 0 or count <= max_points:
+        return columns
+    bucket_size = -(-count // max_points)
+    result = {'time': columns['time'][::bucket_size]}
+    for field, values in columns.items():
+        if field in BAR_REDUCTIONS:
+            result[field] = _bucket_reduce(np.ascontiguousarray(values, dtype=np.float64), bucket_size, BAR_REDUCTIONS[field])
+    return result
+
+def columns_to_bars(symbol: str, timeframe: str, columns: Dict[str, np.ndarray]) -> List[Dict[str, Any]]:
+    """Oldest-first columns back to newest-first rows (NaN as None)"""
+    fields = [field for field in columns if field in BAR_REDUCTIONS]
+    times = columns['time'].tolist()
+    values = {field: columns[field].tolist() for field in fields}
+    result = []
+    for i in range(len(times) - 1, -1, -1):
+        row = {'time': from_micros(times[i]), 'symbol': symbol, 'timeframe': timeframe}
+        for field in fields:
+            value = values[field][i]
+            row[field] = None if math.isnan(value) else value
+        if row.get('number_of_trades') is not None:
+            row['number_of_trades'] = int(row['number_of_trades'])
+        result.append(row)
+    return result
+
+def downsample_line(x: np.ndarray, y: np.ndarray, max_points: int, method: str = 'lttb') -> np.ndarray:
+    """Indices (ascending) of the points to keep from an x-ordered line series"""
+    count = len(y)
+    if max_points <= 0 or count <= max_points:
+        return np.arange(count)
+    x = np.ascontiguousarray(x, dtype=np.float64)
+    y = np.ascontiguousarray(y, dtype=np.float64)
+    if native:
+        if method == 'minmax':
+            return native.minmax_points(y, max_points)
+        return native.lttb(x, y, max_points)
+    # Without the extension: evenly spaced points, ends included
+    return np.unique(np.linspace(0, count - 1, max_points).round().astype(np.int64))
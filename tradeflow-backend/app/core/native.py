@@ -0,0 +1,41 @@
+import logging
+from datetime import datetime, timedelta, timezone
+
+logger = logging.getLogger(__name__)
+
+# Optional C++ extension (see native/README.md). Services fall back to their
+# pure-Python paths when it has not been built for this interpreter.
+try:
+    import tradeflow_native as native
+except ImportError:
+    native = None
+    logger.info("tradeflow_native extension not available, using Python fallbacks")
+
+def native_available() -> bool:
+    return native is not None
+
+# Native engines keep time as int64 epoch microseconds
+EPOCH = datetime(1970, 1, 1, tzinfo=timezone.utc)
+
+def as_utc(timestamp: datetime) -> datetime:
+    """Aware UTC datetime; naive timestamps are treated as UTC like the ingest path"""
+    if timestamp.tzinfo is None:
+        return timestamp.replace(tzinfo=timezone.utc)
+    return timestamp.astimezone(timezone.utc)
+
+def to_micros(timestamp: datetime) -> int:
+    """Epoch microseconds; naive timestamps are treated as UTC like the ingest path"""
+    return (as_utc(timestamp) - EPOCH) // timedelta(microseconds=1)
+
+def from_micros(micros: int) -> datetime:
+    return EPOCH + timedelta(microseconds=int(micros))
+
+# Timeframe labels the native engines bucket by, in seconds
+TIMEFRAME_SECONDS = {
+    '1m': 60,
+    '5m': 300,
+    '15m': 900,
+    '1h': 3600,
+    '4h': 14400,
+    '1d': 86400
+}
@@ -2,6 +2,7 @@ from fastapi import FastAPI, Request, status
 from fastapi.middleware.cors import CORSMiddleware
 from fastapi.middleware.gzip import GZipMiddleware
 from contextlib import asynccontextmanager
+import asyncio
 import logging
 import time
 
@@ -18,10 +19,24 @@ from app.config import settings
 from app.db.mariadb import mariadb_manager
 from app.db.timescale import timescale_manager
 from app.db.redis import redis_manager
+from app.services.alert_service import alert_service
+from app.services.catalog_service import catalog_service
+from app.services.market_data_service import MarketDataService
+from app.services.reorder_service import reorder_service
 
 logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger(__name__)
 
+async def release_quiet_streams():
+    """Feed the rollups the bars held for streams that stopped sending"""
+    service = MarketDataService()
+    while True:
+        await asyncio.sleep(settings.INGEST_REORDER_HOLD_MS / 1000)
+        try:
+            await service.release_reordered()
+        except Exception as e:
+            logger.warning(f"Reordered bars not released, retrying: {e}")
+
 @asynccontextmanager
 async def lifespan(app: FastAPI):
     # Startup
@@ -29,6 +44,15 @@ async def lifespan(app: FastAPI):
     await mariadb_manager.connect()
     await timescale_manager.connect()
     await redis_manager.connect()
+    try:
+        await alert_service.sync_alerts()
+    except Exception as e:
+        logger.warning(f"Price alert index not loaded: {e}")
+    try:
+        await catalog_service.load()
+    except Exception as e:
+        logger.warning(f"Stream catalog not loaded, symbol info uses SQL: {e}")
+    reorder_task = asyncio.create_task(release_quiet_streams()) if reorder_service.buffer else None
     # setup_monitoring(app)
     logger.info("✓ All systems operational")
     
@@ -36,6 +60,13 @@ async def lifespan(app: FastAPI):
     
     # Shutdown
     logger.info("Shutting down...")
+    if reorder_task:
+        reorder_task.cancel()
+    try:
+        await MarketDataService().release_reordered(flush=True)
+    except Exception as e:
+        logger.error(f"Buffered bars not fed to the rollups at shutdown: {e}")
+    await catalog_service.persist()
     await mariadb_manager.disconnect()
     await timescale_manager.disconnect()
     await redis_manager.disconnect()
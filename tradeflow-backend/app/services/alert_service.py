@@ -1,16 +1,29 @@
-from typing import List, Dict, Any, Optional
+from typing import List, Dict, Any, Optional, Set
 from datetime import datetime
 import logging
 from sqlalchemy import select, update, delete
 from sqlalchemy.ext.asyncio import AsyncSession
 
+from app.core.native import native
 from app.db.mariadb import mariadb_manager
-from app.db.models import Alert, AlertType
+from app.db.models import Alert, AlertType, Symbol
 from app.services.market_data_service import market_data_service
 
 logger = logging.getLogger(__name__)
 
+PRICE_OPERATORS = (">", ">=", "<", "<=")
+
 class AlertService:
+    def __init__(self):
+        # Price alerts indexed for tick-time evaluation. Native: per-symbol
+        # sorted ladders; fallback: per-symbol lists checked one by one, with
+        # the same fire, remove and re-arm rules.
+        self.engine = native.AlertEngine() if native else None
+        # symbol -> {alert_id: [operator, price, one_shot, armed]}
+        self._fallback_alerts: Dict[str, Dict[int, list]] = {}
+        self._symbol_names: Dict[int, str] = {}
+        self._repeating: Set[int] = set()
+
     async def create_alert(
         self,
         user_id: int,
@@ -31,6 +44,11 @@ class AlertService:
             session.add(alert)
             await session.commit()
             await session.refresh(alert)
+
+            if alert_type == AlertType.PRICE:
+                symbol = await self._symbol_name(session, symbol_id)
+                if symbol:
+                    self._index_alert(alert.id, symbol, condition_config)
             return alert
 
     async def get_user_alerts(self, user_id: int) -> List[Alert]:
@@ -44,6 +62,8 @@ class AlertService:
                 delete(Alert).where(Alert.id == alert_id, Alert.user_id == user_id)
             )
             await session.commit()
+            if result.rowcount > 0:
+                self._unindex_alert(alert_id)
             return result.rowcount > 0
 
     async def check_price_alert(self, alert: Alert, current_price: float):
@@ -69,15 +89,142 @@ class AlertService:
             
         return False
 
-    async def process_tick(self, symbol: str, price: float):
+    async def sync_alerts(self) -> int:
+        """
+        Bulk-load all active price alerts (joined to their symbol names) into the
+        tick-time index, replacing whatever was loaded before.
+        """
+        async with mariadb_manager.get_session() as session:
+            result = await session.execute(
+                select(Alert.id, Alert.condition_config, Symbol.id, Symbol.symbol)
+                .join(Symbol, Alert.symbol_id == Symbol.id)
+                .where(Alert.is_active == True, Alert.alert_type == AlertType.PRICE)
+            )
+            rows = result.all()
+
+        ids, symbols, operators, prices, one_shots = [], [], [], [], []
+        self._fallback_alerts = {}
+        self._repeating = set()
+        for alert_id, config, symbol_id, symbol in rows:
+            self._symbol_names[symbol_id] = symbol
+            parsed = self._parse_price_condition(config)
+            if not parsed:
+                continue
+            operator, price, one_shot = parsed
+            ids.append(alert_id)
+            symbols.append(symbol)
+            operators.append(operator)
+            prices.append(price)
+            one_shots.append(one_shot)
+            if not one_shot:
+                self._repeating.add(alert_id)
+            if not self.engine:
+                self._fallback_alerts.setdefault(symbol, {})[alert_id] = [operator, price, one_shot, True]
+
+        if self.engine:
+            self.engine.load(ids, symbols, operators, prices, one_shots)
+
+        logger.info(f"Alert index synced: {len(ids)} active price alerts")
+        return len(ids)
+
+    async def process_tick(self, symbol: str, price: float) -> List[int]:
+        """
+        Process incoming tick and fire every crossed price alert for the symbol.
+        Called by the market data ingestion pipeline.
+        """
+        return await self.process_bar(symbol, price, price)
+
+    async def process_bar(self, symbol: str, high: float, low: float) -> List[int]:
+        """
+        Fire every price alert whose level lies inside the bar's range.
+        One-shot alerts are deactivated in bulk; returns the fired alert ids.
+        """
+        if self.engine:
+            fired = self.engine.process_bar(symbol, high, low)
+        else:
+            fired = self._fallback_process_bar(symbol, high, low)
+
+        if not fired:
+            return []
+
+        logger.info(f"Price alerts fired for {symbol} (H:{high} L:{low}): {fired}")
+
+        # Repeating alerts stay active; everything else is one-shot
+        one_shot_ids = [alert_id for alert_id in fired if alert_id not in self._repeating]
+        if one_shot_ids:
+            async with mariadb_manager.get_session() as session:
+                await session.execute(
+                    update(Alert).where(Alert.id.in_(one_shot_ids)).values(is_active=False)
+                )
+                await session.commit()
+
+        return fired
+
+    def _fallback_process_bar(self, symbol: str, high: float, low: float) -> List[int]:
         """
-        Process incoming tick and check active alerts for the symbol.
-        This would typically be called by the market data ingestion pipeline or a worker.
+        AlertEngine.process_bar without the ladders. An armed alert fires when
+        the bar reaches its level; a one-shot alert is then removed and a
+        repeating one disarmed until price moves back through the level (its
+        condition stops holding). Each alert changes state at most once per bar.
         """
-        # 1. Get symbol ID (cache this mapping ideally)
-        # For now, we'll skip symbol_id lookup and assume we can query by symbol name if we joined tables,
-        # but our Alert model uses symbol_id.
-        # Let's assume we have a way to map symbol string to ID.
-        pass 
+        alerts = self._fallback_alerts.get(symbol, {})
+        fired = []
+        for alert_id, alert in list(alerts.items()):
+            operator, price, one_shot, armed = alert
+            rising = operator in (">", ">=")
+            if armed:
+                reached = (high > price or (operator == ">=" and high == price)) if rising \
+                    else (low < price or (operator == "<=" and low == price))
+                if reached:
+                    fired.append(alert_id)
+                    if one_shot:
+                        del alerts[alert_id]
+                    else:
+                        alert[3] = False
+            else:
+                # Re-arms where its own condition no longer holds
+                released = (low < price or (operator == ">" and low == price)) if rising \
+                    else (high > price or (operator == "<" and high == price))
+                if released:
+                    alert[3] = True
+        return fired
+
+    def _parse_price_condition(self, config: Dict[str, Any]):
+        """Returns (operator, price, one_shot) or None for non-price conditions"""
+        if not config:
+            return None
+        operator = config.get("operator")
+        target_price = config.get("price")
+        if operator not in PRICE_OPERATORS or target_price is None:
+            return None
+        return operator, float(target_price), not config.get("repeat", False)
+
+    def _index_alert(self, alert_id: int, symbol: str, config: Dict[str, Any]):
+        parsed = self._parse_price_condition(config)
+        if not parsed:
+            return
+        operator, price, one_shot = parsed
+        if not one_shot:
+            self._repeating.add(alert_id)
+        if self.engine:
+            self.engine.upsert(alert_id, symbol, operator, price, one_shot)
+        else:
+            self._fallback_alerts.setdefault(symbol, {})[alert_id] = [operator, price, one_shot, True]
+
+    def _unindex_alert(self, alert_id: int):
+        self._repeating.discard(alert_id)
+        if self.engine:
+            self.engine.remove(alert_id)
+        else:
+            for alerts in self._fallback_alerts.values():
+                alerts.pop(alert_id, None)
+
+    async def _symbol_name(self, session: AsyncSession, symbol_id: int) -> Optional[str]:
+        if symbol_id not in self._symbol_names:
+            symbol = await session.get(Symbol, symbol_id)
+            if not symbol:
+                return None
+            self._symbol_names[symbol_id] = symbol.symbol
+        return self._symbol_names[symbol_id]
 
 alert_service = AlertService()
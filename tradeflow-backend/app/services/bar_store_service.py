@@ -0,0 +1,141 @@
+from typing import List, Dict, Any, Optional
+from datetime import datetime
+import logging
+import math
+
+from app.config import settings
+from app.core.coverage import CorrectedRanges
+from app.core.native import native, to_micros, from_micros, TIMEFRAME_SECONDS
+
+logger = logging.getLogger(__name__)
+
+# Fields returned per timeframe, matching the two get_bars SQL paths
+RAW_FIELDS = (
+    'open', 'high', 'low', 'close', 'volume', 'bid_volume', 'ask_volume',
+    'number_of_trades', 'open_interest', 'delta', 'cvd', 'vwap', 'vwap_upper', 'vwap_lower'
+)
+AGGREGATED_FIELDS = (
+    'open', 'high', 'low', 'close', 'volume', 'bid_volume', 'ask_volume',
+    'number_of_trades', 'open_interest'
+)
+
+MAX_MICROS = 2**63 - 1
+
+class BarStoreService:
+    """
+    Local append-only columnar copy of recent bars (hot tier).
+    Ingest appends every stored bar; 1s bars are also rolled up into
+    BARSTORE_TIMEFRAMES. Reads are served from here when the stream holds
+    enough history and no late bar was written inside the rows they return,
+    otherwise callers fall back to TimescaleDB.
+    """
+
+    def __init__(self):
+        self.store = None
+        self.rollups = set()
+        if native and settings.BARSTORE_PATH:
+            rollups = [(tf, TIMEFRAME_SECONDS[tf]) for tf in settings.BARSTORE_TIMEFRAMES if tf in TIMEFRAME_SECONDS]
+            self.store = native.BarStore(settings.BARSTORE_PATH, settings.BARSTORE_RETENTION_DAYS, '1s', rollups)
+            self.rollups = {tf for tf, _ in rollups}
+        # Buckets with late bars the store could not take, per (symbol, timeframe)
+        self.corrected = CorrectedRanges()
+
+    def on_bar(
+        self,
+        symbol: str,
+        timeframe: str,
+        timestamp: datetime,
+        open: float,
+        high: float,
+        low: float,
+        close: float,
+        volume: float,
+        bid_volume: Optional[float] = None,
+        ask_volume: Optional[float] = None,
+        number_of_trades: Optional[int] = None,
+        open_interest: Optional[float] = None,
+        delta: Optional[float] = None,
+        cvd: Optional[float] = None,
+        vwap: Optional[float] = None,
+        vwap_upper: Optional[float] = None,
+        vwap_lower: Optional[float] = None
+    ):
+        """Append a stored bar; bars older than the stream's newest are left to TimescaleDB and marked"""
+        if not self.store:
+            return
+        try:
+            if not self.store.append(
+                symbol, timeframe, to_micros(timestamp), open, high, low, close, volume,
+                bid_volume, ask_volume, number_of_trades, open_interest,
+                delta, cvd, vwap, vwap_upper, vwap_lower
+            ):
+                self.on_correction(symbol, timeframe, timestamp)
+        except Exception as e:
+            logger.warning(f"Bar store append failed for {symbol} {timeframe}: {e}")
+
+    def on_correction(self, symbol: str, timeframe: str, timestamp: datetime):
+        """A late bar was written to TimescaleDB only: stop serving its bucket in each timeframe"""
+        if not self.store:
+            return
+        micros = to_micros(timestamp)
+        self.corrected.add((symbol, timeframe), micros)
+        if timeframe == '1s':
+            for rollup in self.rollups:
+                width = TIMEFRAME_SECONDS[rollup] * 1_000_000
+                self.corrected.add((symbol, rollup), micros - micros % width)
+
+    def get_bars(self, symbol: str, timeframe: str, limit: int, since: Optional[datetime] = None) -> Optional[List[Dict[str, Any]]]:
+        """
+        Newest `limit` bars (newest first, like the SQL path), optionally only those
+        at or after `since`; None if the stream is not held locally
+        """
+        if not self.store or self.store.count(symbol, timeframe) < limit:
+            return None
+        if since is None:
+            columns = self.store.tail(symbol, timeframe, limit)
+        else:
+            columns = self.store.range(symbol, timeframe, to_micros(since), MAX_MICROS)
+        if self._corrected(symbol, timeframe, columns):
+            return None
+        return self._rows(symbol, timeframe, columns, reverse=True)[:limit]
+
+    def get_columns(self, symbol: str, timeframe: str, limit: int) -> Optional[Dict[str, Any]]:
+        """Newest `limit` bars as oldest-first column arrays, or None if not held locally"""
+        if not self.store or self.store.count(symbol, timeframe) < limit:
+            return None
+        columns = self.store.tail(symbol, timeframe, limit)
+        if self._corrected(symbol, timeframe, columns):
+            return None
+        fields = AGGREGATED_FIELDS if timeframe in self.rollups else RAW_FIELDS
+        return {'time': columns['time'], **{field: columns[field] for field in fields}}
+
+    def get_range(self, symbol: str, timeframe: str, start_time: datetime, end_time: datetime) -> List[Dict[str, Any]]:
+        """Bars with start_time <= time <= end_time, oldest first"""
+        if not self.store:
+            return []
+        columns = self.store.range(symbol, timeframe, to_micros(start_time), to_micros(end_time))
+        return self._rows(symbol, timeframe, columns, reverse=False)
+
+    def _corrected(self, symbol: str, timeframe: str, columns: Dict[str, Any]) -> bool:
+        """True when a late bar landed at or after the oldest returned row"""
+        times = columns['time']
+        return len(times) > 0 and self.corrected.overlaps((symbol, timeframe), int(times[0]), MAX_MICROS)
+
+    def _rows(self, symbol: str, timeframe: str, columns: Dict[str, Any], reverse: bool) -> List[Dict[str, Any]]:
+        fields = AGGREGATED_FIELDS if timeframe in self.rollups else RAW_FIELDS
+        times = columns['time'].tolist()
+        values = {field: columns[field].tolist() for field in fields}
+
+        order = range(len(times) - 1, -1, -1) if reverse else range(len(times))
+        result = []
+        for i in order:
+            row = {'time': from_micros(times[i]), 'symbol': symbol, 'timeframe': timeframe}
+            for field in fields:
+                value = values[field][i]
+                row[field] = None if math.isnan(value) else value
+            if row['number_of_trades'] is not None:
+                row['number_of_trades'] = int(row['number_of_trades'])
+            result.append(row)
+        return result
+
+bar_store_service = BarStoreService()
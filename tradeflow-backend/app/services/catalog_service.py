@@ -0,0 +1,158 @@
+from typing import List, Dict, Any, Optional
+import logging
+import time
+
+from app.config import settings
+from app.core.native import native, to_micros, from_micros
+from app.db.timescale import timescale_manager
+
+logger = logging.getLogger(__name__)
+
+CATALOG_COLUMNS = """
+    symbol, timeframe, bar_count, first_time, last_time,
+    volume_sum, max_volume, min_low, max_high, last_volume
+"""
+
+class CatalogService:
+    """
+    Per-(symbol, timeframe) statistics maintained on ingest.
+    Loaded from stream_catalog at startup (seeded from market_data once if
+    empty) and caught up with bars stored after the last persist; changed
+    streams are written back at most every CATALOG_PERSIST_SECONDS. Bars
+    before a stream's newest are counted only when their write inserted a
+    row. Until it is loaded, or without the native extension, callers use
+    the SQL path.
+    """
+
+    def __init__(self):
+        self.catalog = native.StreamCatalog() if native else None
+        self.loaded = False
+        self._last_persist = time.monotonic()
+        # Exported streams not yet written, keyed by (symbol, timeframe); a
+        # newer export of the same stream replaces the older values
+        self._pending: Dict[tuple, tuple] = {}
+
+    async def load(self):
+        if not self.catalog:
+            return
+        rows = await timescale_manager.fetch(f"SELECT {CATALOG_COLUMNS} FROM stream_catalog")
+        if rows:
+            # Bars stored after the last persist: an index range per stream
+            rows += await timescale_manager.fetch("""
+                SELECT m.symbol, m.timeframe, COUNT(*) AS bar_count,
+                       MIN(m.time) AS first_time, MAX(m.time) AS last_time,
+                       SUM(m.volume) AS volume_sum, MAX(m.volume) AS max_volume,
+                       MIN(m.low) AS min_low, MAX(m.high) AS max_high,
+                       (ARRAY_AGG(m.volume ORDER BY m.time DESC))[1] AS last_volume
+                FROM stream_catalog c
+                JOIN market_data m ON m.symbol = c.symbol AND m.timeframe = c.timeframe AND m.time > c.last_time
+                GROUP BY m.symbol, m.timeframe
+            """)
+        else:
+            logger.info("stream_catalog is empty, seeding it from market_data")
+            rows = await timescale_manager.fetch("""
+                SELECT symbol, timeframe, COUNT(*) AS bar_count,
+                       MIN(time) AS first_time, MAX(time) AS last_time,
+                       SUM(volume) AS volume_sum, MAX(volume) AS max_volume,
+                       MIN(low) AS min_low, MAX(high) AS max_high,
+                       (ARRAY_AGG(volume ORDER BY time DESC))[1] AS last_volume
+                FROM market_data
+                GROUP BY symbol, timeframe
+            """)
+
+        for row in rows:
+            self.catalog.merge(
+                row['symbol'], row['timeframe'], row['bar_count'],
+                to_micros(row['first_time']), to_micros(row['last_time']),
+                float(row['volume_sum'] or 0), float(row['max_volume'] or 0),
+                float(row['min_low']) if row['min_low'] is not None else float('inf'),
+                float(row['max_high']) if row['max_high'] is not None else float('-inf'),
+                float(row['last_volume'] or 0)
+            )
+        self.loaded = True
+        await self.persist()
+
+    def is_backfill(self, symbol: str, timeframe: str, timestamp) -> bool:
+        """True for a bar before the stream's newest: the write must report whether it was new"""
+        return bool(self.catalog) and self.catalog.is_backfill(symbol, timeframe, to_micros(timestamp))
+
+    def on_bar(self, symbol: str, timeframe: str, timestamp, high: float, low: float, volume: float, inserted: bool = False):
+        if self.catalog:
+            self.catalog.add(symbol, timeframe, to_micros(timestamp), high, low, volume or 0, inserted)
+
+    async def maybe_persist(self):
+        if not self.loaded or time.monotonic() - self._last_persist < settings.CATALOG_PERSIST_SECONDS:
+            return
+        self._last_persist = time.monotonic()
+        await self.persist()
+
+    async def persist(self) -> int:
+        """Upsert streams changed since the last persist"""
+        if not self.loaded:
+            return 0
+        for stream in self.catalog.export(True):
+            self._pending[stream[:2]] = stream
+        if not self._pending:
+            return 0
+
+        rows = [
+            (symbol, timeframe, count, from_micros(first_time), from_micros(last_time),
+             volume_sum, max_volume, min_low, max_high, last_volume)
+            for symbol, timeframe, count, first_time, last_time, volume_sum, max_volume, min_low, max_high, last_volume
+            in self._pending.values()
+        ]
+        query = f"""
+            INSERT INTO stream_catalog ({CATALOG_COLUMNS})
+            VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10)
+            ON CONFLICT (symbol, timeframe) DO UPDATE SET
+                bar_count = EXCLUDED.bar_count,
+                first_time = EXCLUDED.first_time,
+                last_time = EXCLUDED.last_time,
+                volume_sum = EXCLUDED.volume_sum,
+                max_volume = EXCLUDED.max_volume,
+                min_low = EXCLUDED.min_low,
+                max_high = EXCLUDED.max_high,
+                last_volume = EXCLUDED.last_volume
+        """
+        try:
+            if not timescale_manager.pool:
+                await timescale_manager.connect()
+            async with timescale_manager.pool.acquire() as connection:
+                await connection.executemany(query, rows)
+        except Exception as e:
+            logger.error(f"Stream catalog persist failed, retrying next interval: {e}")
+            return 0
+
+        self._pending = {}
+        return len(rows)
+
+    def get_symbols(self) -> Optional[List[str]]:
+        if not self.loaded:
+            return None
+        return self.catalog.symbols()
+
+    def get_symbol_info(self, symbol: str) -> Optional[Dict[str, Any]]:
+        """Same shape as the SQL symbol info, or None when not loaded or unknown"""
+        if not self.loaded:
+            return None
+        summary = self.catalog.summary(symbol)
+        if summary is None:
+            return None
+        return {
+            "symbol": symbol,
+            "total_bars": summary['count'],
+            "first_data_time": from_micros(summary['first_time']).isoformat(),
+            "last_data_time": from_micros(summary['last_time']).isoformat(),
+            "available_timeframes": summary['timeframes'],
+            "avg_volume": summary['volume_sum'] / summary['count'],
+            "max_volume": summary['max_volume'],
+            "price_range": {
+                "min": summary['min_low'],
+                "max": summary['max_high']
+            }
+        }
+
+    def stats(self) -> Dict[str, Any]:
+        return self.catalog.stats() if self.catalog else {}
+
+catalog_service = CatalogService()
@@ -0,0 +1,84 @@
+from typing import List, Dict, Any, Optional
+from datetime import datetime
+import logging
+
+from app.config import settings
+from app.core.coverage import CorrectedRanges
+from app.core.native import native, to_micros, from_micros, TIMEFRAME_SECONDS
+
+logger = logging.getLogger(__name__)
+
+class FootprintService:
+    """
+    In-memory footprint (volume at price per bar) fed from ingest.
+    Every 1s bar adds its volume at the close price, in tick units, to each
+    configured timeframe; requests inside the covered window never touch SQL
+    unless a late bar was written into one of their buckets.
+    """
+
+    def __init__(self):
+        self.timeframes = [tf for tf in settings.FOOTPRINT_TIMEFRAMES if tf in TIMEFRAME_SECONDS]
+        self.store = native.FootprintStore(
+            settings.FOOTPRINT_TICK_SIZE,
+            [TIMEFRAME_SECONDS[tf] for tf in self.timeframes],
+            settings.FOOTPRINT_RING_BARS,
+            settings.FOOTPRINT_ARCHIVE_BARS
+        ) if native else None
+        # Newest 1s bar fed per symbol; resent bars are skipped and backfilled
+        # ones marked corrected, so volume is never counted twice (the
+        # collector only sends closed bars)
+        self._last_time: Dict[str, int] = {}
+        # Buckets with late bars the store could not take, per (symbol, seconds)
+        self.corrected = CorrectedRanges()
+
+    def on_bar(
+        self,
+        symbol: str,
+        timestamp: datetime,
+        close: float,
+        volume: float,
+        bid_volume: Optional[float],
+        ask_volume: Optional[float]
+    ):
+        """Feed a stored 1s bar (same close-price approximation as the SQL path)"""
+        if not self.store:
+            return
+        micros = to_micros(timestamp)
+        last_time = self._last_time.get(symbol, -1)
+        if micros <= last_time:
+            if micros < last_time:
+                self.on_correction(symbol, timestamp)
+            return
+        self._last_time[symbol] = micros
+        self.store.add(symbol, micros, close, volume, bid_volume or 0, ask_volume or 0)
+
+    def on_correction(self, symbol: str, timestamp: datetime):
+        """A late 1s bar was written to TimescaleDB only: its buckets are read from there"""
+        if not self.store:
+            return
+        micros = to_micros(timestamp)
+        for timeframe in self.timeframes:
+            width = TIMEFRAME_SECONDS[timeframe] * 1_000_000
+            self.corrected.add((symbol, TIMEFRAME_SECONDS[timeframe]), micros - micros % width)
+
+    def get_footprint(self, symbol: str, timeframe: str, start_time: datetime, end_time: datetime) -> Optional[List[Dict[str, Any]]]:
+        """Footprint bars from memory, or None when the range is not fully covered"""
+        if not self.store or timeframe not in self.timeframes:
+            return None
+
+        seconds = TIMEFRAME_SECONDS[timeframe]
+        covered_from = self.store.covered_from(symbol, seconds)
+        start = to_micros(start_time)
+        if covered_from is None or start < covered_from:
+            return None
+        first_bucket = start - start % (seconds * 1_000_000)
+        if self.corrected.overlaps((symbol, seconds), first_bucket, to_micros(end_time)):
+            return None
+
+        bars = self.store.query(symbol, seconds, start, to_micros(end_time))
+        return [{'time': from_micros(time).isoformat(), 'levels': levels} for time, levels in bars]
+
+    def stats(self) -> Dict[str, Any]:
+        return self.store.stats() if self.store else {}
+
+footprint_service = FootprintService()
@@ -0,0 +1,145 @@
+from typing import List, Dict, Any, Optional, Tuple
+from bisect import bisect_left
+from collections import deque
+from datetime import datetime
+import logging
+
+from app.config import settings
+from app.core.native import as_utc
+from app.db.timescale import timescale_manager
+
+logger = logging.getLogger(__name__)
+
+# Cell quantization of the collector's heatmap aggregator (TradeFlow_Pro_Heatmap.h):
+# one character per value, size = scale * (q / 63)^2
+HEATMAP_QUANT_CHARS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+HEATMAP_QUANT_LEVELS = 63
+_QUANT_INDEX = {char: q for q, char in enumerate(HEATMAP_QUANT_CHARS)}
+
+def decode_cells(cells: str, scale: float) -> Tuple[List[float], List[float]]:
+    """Per-row time-weighted average and max resting size, lowest price first"""
+    values = [scale * (_QUANT_INDEX.get(char, 0) / HEATMAP_QUANT_LEVELS) ** 2 for char in cells]
+    return values[0::2], values[1::2]
+
+class HeatmapService:
+    """
+    Liquidity heatmap tiles aggregated by the collector from market depth.
+    Each tile is one finished time column at one resolution: rows of
+    row_size from low_price up, with quantized average and max resting size
+    per row. Tiles are stored as received (heatmap_tiles) and the newest
+    HEATMAP_TILES_PER_STREAM per (symbol, column seconds) are kept in memory.
+    """
+
+    def __init__(self):
+        self._tiles: Dict[Tuple[str, int], deque] = {}
+
+    @staticmethod
+    def _parse(tile: list) -> Optional[Tuple[datetime, int, float, float, float, str]]:
+        if len(tile) != 6 or not isinstance(tile[5], str) or len(tile[5]) % 2:
+            return None
+        try:
+            tile_time = datetime.strptime(tile[0], "%Y-%m-%d %H:%M:%S.%f")
+        except ValueError:
+            tile_time = datetime.fromisoformat(tile[0].replace('Z', '+00:00'))
+        return as_utc(tile_time), int(tile[1]), float(tile[2]), float(tile[3]), float(tile[4]), tile[5]
+
+    async def on_tiles(self, symbol: str, tiles: List[list]) -> int:
+        """
+        Store tiles posted as [time, column seconds, row size, low price, scale,
+        cells]; malformed rows are skipped. A resent tile replaces the stored one.
+        """
+        rows = []
+        for tile in tiles:
+            try:
+                parsed = self._parse(tile)
+            except (TypeError, ValueError):
+                parsed = None
+            if parsed is not None:
+                rows.append(parsed)
+        if not rows:
+            return 0
+
+        query = """
+            INSERT INTO heatmap_tiles (time, symbol, column_seconds, row_size, low_price, scale, cells)
+            VALUES ($1, $2, $3, $4, $5, $6, $7)
+            ON CONFLICT (time, symbol, column_seconds) DO UPDATE SET
+                row_size = EXCLUDED.row_size,
+                low_price = EXCLUDED.low_price,
+                scale = EXCLUDED.scale,
+                cells = EXCLUDED.cells
+        """
+        if not timescale_manager.pool:
+            await timescale_manager.connect()
+        async with timescale_manager.pool.acquire() as connection:
+            await connection.executemany(query, [
+                (tile_time, symbol, seconds, row_size, low_price, scale, cells)
+                for tile_time, seconds, row_size, low_price, scale, cells in rows
+            ])
+
+        for row in rows:
+            stream = self._tiles.get((symbol, row[1]))
+            if stream is None:
+                stream = deque(maxlen=settings.HEATMAP_TILES_PER_STREAM)
+                self._tiles[(symbol, row[1])] = stream
+            self._insert(stream, row)
+        return len(rows)
+
+    @staticmethod
+    def _insert(stream: deque, row: tuple):
+        """
+        Keep the stream in time order. Tiles normally arrive in order; an older
+        one (resent after a reconnect) is placed where it belongs, so the held
+        window never has a hole that heatmap_tiles does not
+        """
+        if not stream or stream[-1][0] < row[0]:
+            stream.append(row)
+            return
+        i = bisect_left(stream, row[0], key=lambda tile: tile[0])
+        if i < len(stream) and stream[i][0] == row[0]:
+            stream[i] = row
+        elif i > 0 or len(stream) < stream.maxlen:
+            # Older than everything held: only kept while there is room
+            if len(stream) == stream.maxlen:
+                stream.popleft()
+                i -= 1
+            stream.insert(i, row)
+
+    async def get_tiles(
+        self,
+        symbol: str,
+        column_seconds: int,
+        start_time: datetime,
+        end_time: datetime,
+        decode: bool = False
+    ) -> List[Dict[str, Any]]:
+        """Tiles with start_time <= time <= end_time, oldest first"""
+        start_time, end_time = as_utc(start_time), as_utc(end_time)
+        stream = self._tiles.get((symbol, column_seconds))
+        if stream and stream[0][0] <= start_time:
+            rows = [row for row in stream if start_time <= row[0] <= end_time]
+        else:
+            records = await timescale_manager.fetch("""
+                SELECT time, column_seconds, row_size, low_price, scale, cells
+                FROM heatmap_tiles
+                WHERE symbol = $1 AND column_seconds = $2 AND time >= $3 AND time <= $4
+                ORDER BY time
+            """, symbol, column_seconds, start_time, end_time)
+            rows = [tuple(record) for record in records]
+
+        result = []
+        for tile_time, seconds, row_size, low_price, scale, cells in rows:
+            tile = {
+                "time": tile_time.isoformat(),
+                "column_seconds": seconds,
+                "row_size": row_size,
+                "low_price": low_price,
+                "scale": scale
+            }
+            if decode:
+                tile["average"], tile["max"] = decode_cells(cells, scale)
+            else:
+                tile["cells"] = cells
+            result.append(tile)
+        return result
+
+heatmap_service = HeatmapService()
@@ -1,24 +1,61 @@
 import numpy as np
 import pandas as pd
-from typing import List, Dict, Any
+from collections import OrderedDict
+from typing import List, Dict, Any, Optional, Tuple
+from datetime import datetime
+import logging
+
+from app.config import settings
+from app.core.native import native, to_micros, from_micros
+
+logger = logging.getLogger(__name__)
+
+# Output field names for multi-value indicators, in native column order
+INDICATOR_FIELDS = {
+    "macd": ("macd", "signal", "histogram"),
+    "bollinger": ("upper", "middle", "lower"),
+}
+
+def _min_bars(kind: str, params: Tuple) -> int:
+    """Bars the calculate_* methods need before returning anything (macd: the slow period)"""
+    return int(params[1] if kind == "macd" else params[0])
+
+def _clean(values) -> List[float]:
+    """Match the pandas fillna(0) contract of the calculate_* methods"""
+    return np.nan_to_num(np.asarray(values, dtype=np.float64), nan=0.0, posinf=0.0, neginf=0.0).tolist()
 
 class IndicatorService:
+    def __init__(self, history_capacity: int = 5000, max_streams: int = settings.INDICATOR_STREAMS):
+        self.history_capacity = history_capacity
+        self.max_streams = max(1, max_streams)
+        # (symbol, timeframe) -> {(kind, params): {"stream": IndicatorStream, "complete": bool, "capacity": int}}
+        self._streams: Dict[Tuple[str, str], Dict[Tuple[str, Tuple], Dict[str, Any]]] = {}
+        # (symbol, timeframe, kind, params) of every warm stream, least recently requested first
+        self._recent: "OrderedDict[Tuple[str, str, str, Tuple], None]" = OrderedDict()
+        self.evicted_streams = 0
+
     def calculate_sma(self, closes: List[float], period: int) -> List[float]:
         """Simple Moving Average"""
         if len(closes) < period:
             return []
+        if native:
+            return _clean(native.sma(closes, period))
         return pd.Series(closes).rolling(window=period).mean().fillna(0).tolist()
-    
+
     def calculate_ema(self, closes: List[float], period: int) -> List[float]:
         """Exponential Moving Average"""
         if len(closes) < period:
             return []
+        if native:
+            return _clean(native.ema(closes, period))
         return pd.Series(closes).ewm(span=period, adjust=False).mean().fillna(0).tolist()
-    
+
     def calculate_rsi(self, closes: List[float], period: int = 14) -> List[float]:
         """Relative Strength Index"""
         if len(closes) < period:
             return []
+        if native:
+            return _clean(native.rsi(closes, period))
         closes_series = pd.Series(closes)
         delta = closes_series.diff()
         gain = (delta.where(delta > 0, 0)).rolling(window=period).mean()
@@ -26,7 +63,7 @@ class IndicatorService:
         rs = gain / loss
         rsi = 100 - (100 / (1 + rs))
         return rsi.fillna(0).tolist()
-    
+
     def calculate_macd(
         self,
         closes: List[float],
@@ -37,20 +74,28 @@ class IndicatorService:
         """MACD"""
         if len(closes) < slow:
             return {"macd": [], "signal": [], "histogram": []}
-            
+
+        if native:
+            macd_line, signal_line, histogram = native.macd(closes, fast, slow, signal)
+            return {
+                "macd": _clean(macd_line),
+                "signal": _clean(signal_line),
+                "histogram": _clean(histogram)
+            }
+
         closes_series = pd.Series(closes)
         ema_fast = closes_series.ewm(span=fast, adjust=False).mean()
         ema_slow = closes_series.ewm(span=slow, adjust=False).mean()
         macd_line = ema_fast - ema_slow
         signal_line = macd_line.ewm(span=signal, adjust=False).mean()
         histogram = macd_line - signal_line
-        
+
         return {
             "macd": macd_line.fillna(0).tolist(),
             "signal": signal_line.fillna(0).tolist(),
             "histogram": histogram.fillna(0).tolist()
         }
-    
+
     def calculate_bollinger_bands(
         self,
         closes: List[float],
@@ -60,20 +105,28 @@ class IndicatorService:
         """Bollinger Bands"""
         if len(closes) < period:
             return {"upper": [], "middle": [], "lower": []}
-            
+
+        if native:
+            upper, middle, lower = native.bollinger(closes, period, std_dev)
+            return {
+                "upper": _clean(upper),
+                "middle": _clean(middle),
+                "lower": _clean(lower)
+            }
+
         closes_series = pd.Series(closes)
         sma = closes_series.rolling(window=period).mean()
         std = closes_series.rolling(window=period).std()
-        
+
         upper = sma + (std * std_dev)
         lower = sma - (std * std_dev)
-        
+
         return {
             "upper": upper.fillna(0).tolist(),
             "middle": sma.fillna(0).tolist(),
             "lower": lower.fillna(0).tolist()
         }
-    
+
     def calculate_atr(
         self,
         highs: List[float],
@@ -84,18 +137,156 @@ class IndicatorService:
         """Average True Range"""
         if len(closes) < period:
             return []
-            
+
+        if native:
+            return _clean(native.atr(highs, lows, closes, period))
+
         high = pd.Series(highs)
         low = pd.Series(lows)
         close = pd.Series(closes)
-        
+
         tr1 = high - low
         tr2 = (high - close.shift()).abs()
         tr3 = (low - close.shift()).abs()
-        
+
         tr = pd.concat([tr1, tr2, tr3], axis=1).max(axis=1)
         atr = tr.rolling(window=period).mean()
-        
+
         return atr.fillna(0).tolist()
 
+    # ------------------------------------------------------------------
+    # Warm streaming state
+    # ------------------------------------------------------------------
+
+    def get_warm_series(
+        self,
+        kind: str,
+        params: Tuple,
+        symbol: str,
+        timeframe: str,
+        limit: int
+    ) -> Optional[List[Dict[str, Any]]]:
+        """
+        Serve an indicator from its warm stream if it holds enough history.
+        Returns None when there is no usable stream (caller does a cold start).
+        """
+        entry = self._streams.get((symbol, timeframe), {}).get((kind, tuple(params)))
+        if not entry:
+            return None
+        self._recent.move_to_end((symbol, timeframe, kind, tuple(params)))
+
+        stream = entry["stream"]
+        # A complete stream holds all history until its ring starts evicting
+        holds_everything = entry["complete"] and stream.size < entry["capacity"]
+        if stream.size < limit and not holds_everything:
+            return None
+
+        return self._warm_tail(kind, params, stream, limit)
+
+    def compute_series(
+        self,
+        kind: str,
+        params: Tuple,
+        symbol: str,
+        timeframe: str,
+        bars: List[Dict[str, Any]],
+        limit: int,
+        keep_warm: bool = False
+    ) -> List[Dict[str, Any]]:
+        """
+        Cold start from get_bars output (newest first). With keep_warm the result
+        seeds a stream that ingest keeps current through on_bar().
+        """
+        ordered = list(reversed(bars))
+
+        if native and keep_warm:
+            capacity = max(self.history_capacity, limit)
+            stream = native.IndicatorStream(kind, [float(p) for p in params], capacity)
+            stream.update_many(
+                np.fromiter((to_micros(bar['time']) for bar in ordered), dtype=np.int64, count=len(ordered)),
+                np.fromiter((bar['high'] for bar in ordered), dtype=np.float64, count=len(ordered)),
+                np.fromiter((bar['low'] for bar in ordered), dtype=np.float64, count=len(ordered)),
+                np.fromiter((bar['close'] for bar in ordered), dtype=np.float64, count=len(ordered))
+            )
+            self._streams.setdefault((symbol, timeframe), {})[(kind, tuple(params))] = {
+                "stream": stream,
+                # Fewer bars than requested means the stream saw the full history
+                "complete": len(bars) < limit,
+                "capacity": capacity
+            }
+            self._touch(symbol, timeframe, kind, tuple(params))
+            return self._warm_tail(kind, params, stream, limit)
+
+        closes = [bar['close'] for bar in ordered]
+        if kind == "sma":
+            calc_res = {"value": self.calculate_sma(closes, *params)}
+        elif kind == "ema":
+            calc_res = {"value": self.calculate_ema(closes, *params)}
+        elif kind == "rsi":
+            calc_res = {"value": self.calculate_rsi(closes, *params)}
+        elif kind == "macd":
+            calc_res = self.calculate_macd(closes, *params)
+        elif kind == "bollinger":
+            calc_res = self.calculate_bollinger_bands(closes, *params)
+        elif kind == "atr":
+            calc_res = {"value": self.calculate_atr(
+                [bar['high'] for bar in ordered], [bar['low'] for bar in ordered], closes, *params)}
+        else:
+            raise ValueError(f"Unknown indicator: {kind}")
+
+        fields = INDICATOR_FIELDS.get(kind)
+        result = []
+        for i in range(len(next(iter(calc_res.values())))):
+            if fields:
+                value = {field: calc_res[field][i] for field in fields}
+            else:
+                value = calc_res["value"][i]
+            result.append({"time": ordered[i]['time'], "value": value})
+        return result
+
+    def on_bar(
+        self,
+        symbol: str,
+        timeframe: str,
+        timestamp: datetime,
+        high: float,
+        low: float,
+        close: float
+    ):
+        """Feed a stored bar to every warm stream of (symbol, timeframe)"""
+        streams = self._streams.get((symbol, timeframe))
+        if not streams:
+            return
+        micros = to_micros(timestamp)
+        for entry in streams.values():
+            entry["stream"].update(micros, high, low, close)
+
+    def _touch(self, symbol: str, timeframe: str, kind: str, params: Tuple):
+        """Mark a stream as just requested and drop the least recently requested past max_streams"""
+        self._recent[(symbol, timeframe, kind, params)] = None
+        self._recent.move_to_end((symbol, timeframe, kind, params))
+        while len(self._recent) > self.max_streams:
+            old_symbol, old_timeframe, old_kind, old_params = self._recent.popitem(last=False)[0]
+            streams = self._streams[(old_symbol, old_timeframe)]
+            del streams[(old_kind, old_params)]
+            if not streams:
+                del self._streams[(old_symbol, old_timeframe)]
+            self.evicted_streams += 1
+
+    def _warm_tail(self, kind: str, params: Tuple, stream, limit: int) -> List[Dict[str, Any]]:
+        """A stream's newest rows; empty until it has seen a full period, like calculate_*"""
+        if stream.size < _min_bars(kind, params):
+            return []
+        times, values = stream.tail(limit)
+        return self._format_series(kind, times, values)
+
+    def _format_series(self, kind: str, times, values) -> List[Dict[str, Any]]:
+        values = np.nan_to_num(values, nan=0.0, posinf=0.0, neginf=0.0)
+        fields = INDICATOR_FIELDS.get(kind)
+        result = []
+        for micros, row in zip(times.tolist(), values.tolist()):
+            value = dict(zip(fields, row)) if fields else row[0]
+            result.append({"time": from_micros(micros), "value": value})
+        return result
+
 indicator_service = IndicatorService()
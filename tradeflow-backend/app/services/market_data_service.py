@@ -1,13 +1,79 @@
 from typing import List, Optional, Dict, Any
 from datetime import datetime, timedelta
 import logging
+import json
+
+import numpy as np
 
 from app.db.timescale import timescale_manager
-from app.db.redis import redis_manager
-from app.core.caching import cache_key
+from app.core.caching import cache_key, versioned, bump_stream
+from app.core.downsample import bars_to_columns, columns_to_bars, downsample_bar_columns, downsample_line
+from app.core.native import to_micros
+from app.services.indicator_service import indicator_service
+from app.services.catalog_service import catalog_service
+from app.services.footprint_service import footprint_service
+from app.services.pyramid_service import pyramid_service
+from app.services.reorder_service import reorder_service
+from app.services.session_service import session_service
+from app.services.tpo_service import tpo_service
+from app.services.bar_store_service import bar_store_service
 
 logger = logging.getLogger(__name__)
 
+# Timeframe labels of the collector's tick-built bars (TradeFlow_Pro_CustomBars.h)
+CUSTOM_BAR_PREFIXES = ("range", "vol", "tick", "delta", "renko")
+
+# Every market_data write; live bars replace a stored row, batches
+# (historical backfill) leave it
+INSERT_MARKET_DATA = """
+    INSERT INTO market_data (
+        time, symbol, timeframe, open, high, low, close,
+        volume, bid_volume, ask_volume, number_of_trades, open_interest,
+        delta, cvd, vwap, vwap_upper, vwap_lower, ema
+    ) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12,
+              $13, $14, $15, $16, $17, $18::jsonb)
+"""
+# The same write for a whole set of rows in one statement, one array per
+# column, so a backfill learns which rows were new without a round trip each
+INSERT_MARKET_DATA_SET = """
+    INSERT INTO market_data (
+        time, symbol, timeframe, open, high, low, close,
+        volume, bid_volume, ask_volume, number_of_trades, open_interest,
+        delta, cvd, vwap, vwap_upper, vwap_lower, ema
+    )
+    SELECT time, symbol, timeframe, open, high, low, close,
+           volume, bid_volume, ask_volume, number_of_trades, open_interest,
+           delta, cvd, vwap, vwap_upper, vwap_lower, ema::jsonb
+    FROM unnest(
+        $1::timestamptz[], $2::text[], $3::text[], $4::float8[], $5::float8[], $6::float8[], $7::float8[],
+        $8::float8[], $9::float8[], $10::float8[], $11::int4[], $12::float8[],
+        $13::float8[], $14::float8[], $15::float8[], $16::float8[], $17::float8[], $18::text[]
+    ) AS r(time, symbol, timeframe, open, high, low, close,
+           volume, bid_volume, ask_volume, number_of_trades, open_interest,
+           delta, cvd, vwap, vwap_upper, vwap_lower, ema)
+"""
+ON_CONFLICT_REPLACE = """
+    ON CONFLICT (time, symbol, timeframe) DO UPDATE SET
+        open = EXCLUDED.open,
+        high = EXCLUDED.high,
+        low = EXCLUDED.low,
+        close = EXCLUDED.close,
+        volume = EXCLUDED.volume,
+        bid_volume = EXCLUDED.bid_volume,
+        ask_volume = EXCLUDED.ask_volume,
+        number_of_trades = EXCLUDED.number_of_trades,
+        open_interest = EXCLUDED.open_interest,
+        delta = EXCLUDED.delta,
+        cvd = EXCLUDED.cvd,
+        vwap = EXCLUDED.vwap,
+        vwap_upper = EXCLUDED.vwap_upper,
+        vwap_lower = EXCLUDED.vwap_lower,
+        ema = EXCLUDED.ema
+"""
+ON_CONFLICT_KEEP = """
+    ON CONFLICT (time, symbol, timeframe) DO NOTHING
+"""
+
 class MarketDataService:
     async def store_bar(
         self,
@@ -22,73 +88,159 @@ class MarketDataService:
         bid_volume: Optional[float] = None,
         ask_volume: Optional[float] = None,
         number_of_trades: Optional[int] = None,
-        open_interest: Optional[float] = None
+        open_interest: Optional[float] = None,
+        delta: Optional[float] = None,
+        cvd: Optional[float] = None,
+        vwap: Optional[float] = None,
+        vwap_upper: Optional[float] = None,
+        vwap_lower: Optional[float] = None,
+        ema: Optional[Dict[str, float]] = None
     ):
-        """Store single bar in TimescaleDB"""
-        query = """
-            INSERT INTO market_data (
-                time, symbol, timeframe, open, high, low, close,
-                volume, bid_volume, ask_volume, number_of_trades, open_interest
-            ) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12)
-            ON CONFLICT (time, symbol, timeframe) DO UPDATE SET
-                open = EXCLUDED.open,
-                high = EXCLUDED.high,
-                low = EXCLUDED.low,
-                close = EXCLUDED.close,
-                volume = EXCLUDED.volume,
-                bid_volume = EXCLUDED.bid_volume,
-                ask_volume = EXCLUDED.ask_volume,
-                number_of_trades = EXCLUDED.number_of_trades,
-                open_interest = EXCLUDED.open_interest
-        """
-        
-        await timescale_manager.execute(
-            query,
+        """Store single bar in TimescaleDB; the rollups take it through the reorder buffer"""
+        row = (
             timestamp, symbol, timeframe, open, high, low, close,
-            volume, bid_volume, ask_volume, number_of_trades, open_interest
+            volume, bid_volume, ask_volume, number_of_trades, open_interest,
+            delta, cvd, vwap, vwap_upper, vwap_lower,
+            json.dumps(ema) if ema is not None else None
         )
-        
-        # Invalidate cache
-        cache_key_pattern = f"market_data:{symbol}:*"
-        await redis_manager.delete_pattern(cache_key_pattern)
+        await self._ingest([row], replace=True)
     
     async def store_batch(self, bars: List) -> int:
         """Bulk insert for historical data"""
-        # Note: asyncpg doesn't support executemany with ON CONFLICT easily without a loop or unnest
-        # For simplicity and performance, we'll use a transaction and loop or COPY if possible.
-        # Here we will use a loop for now, but in production COPY is better.
-        # Actually, let's use executemany but we need to handle the object attributes.
-        
         data_tuples = []
         for bar in bars:
             timestamp = bar.parse_timestamp(bar.timestamp)
             symbol = bar.chart_info.symbol
-            timeframe = f"{bar.chart_info.seconds_per_bar}s"
+            timeframe = bar.chart_info.timeframe()
             
             data_tuples.append((
                 timestamp, symbol, timeframe,
                 bar.open, bar.high, bar.low, bar.close,
                 bar.volume, bar.bid_volume, bar.ask_volume,
-                bar.number_of_trades, bar.open_interest
+                bar.number_of_trades, bar.open_interest,
+                bar.delta, bar.cvd, bar.vwap, bar.vwap_upper, bar.vwap_lower,
+                json.dumps(bar.ema) if bar.ema is not None else None
             ))
-            
-        query = """
-            INSERT INTO market_data (
-                time, symbol, timeframe, open, high, low, close,
-                volume, bid_volume, ask_volume, number_of_trades, open_interest
-            ) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12)
-            ON CONFLICT (time, symbol, timeframe) DO NOTHING
+
+        # ON CONFLICT DO NOTHING: a backfill never overwrites stored bars
+        await self._ingest(data_tuples, replace=False)
+        return len(data_tuples)
+
+    async def _ingest(self, rows: List[tuple], replace: bool):
         """
-        
-        # We use executemany here. Note: ON CONFLICT DO NOTHING is used for batch to avoid errors,
-        # but it means updates won't happen. For historical backfill this is usually fine.
+        Write rows to market_data, then queue them for the in-memory rollups.
+        The upsert does not depend on order, so every row is stored before the
+        request is answered; only the rollups wait for the reorder buffer.
+        """
+        on_conflict = ON_CONFLICT_REPLACE if replace else ON_CONFLICT_KEEP
+
+        # Rows before their stream's newest bar may fill a gap or repeat a
+        # stored row; their write reports which were new
+        backfill = [i for i, row in enumerate(rows) if catalog_service.is_backfill(row[1], row[2], row[0])]
+        inserted = await self._write_rows_reporting([rows[i] for i in backfill], on_conflict) if backfill else []
+        if len(backfill) < len(rows):
+            skip = set(backfill)
+            await self._write_rows([row for i, row in enumerate(rows) if i not in skip], on_conflict)
+        self._bump_streams(rows)
+
+        # The catalog does not need the reorder buffer, only each request's
+        # rows in time order; rows that were already stored are left out
+        known = dict(zip(backfill, inserted))
+        for i in sorted(range(len(rows)), key=lambda i: rows[i][0]):
+            if known.get(i, True):
+                row = rows[i]
+                catalog_service.on_bar(row[1], row[2], row[0], row[4], row[5], row[7], inserted=i in known)
+
+        # A backfill row market_data already held (kept, not replaced) changed
+        # nothing, so it neither feeds the rollups nor marks a correction
+        changed = [row for i, row in enumerate(rows) if replace or known.get(i, True)]
+        late = [row for row in changed if not reorder_service.push(row[1], row[2], row[0], row)]
+        if late:
+            self._apply_corrections(late)
+        await self.release_reordered()
+
+    async def release_reordered(self, flush: bool = False) -> int:
+        """
+        Feed the bars the reorder buffer has released (flush: every buffered
+        bar) to the in-memory rollups, in time order per stream. The rows are
+        already in market_data; read caches are bumped again because the bar
+        store now holds them too.
+        """
+        released = reorder_service.drain(flush)
+
+        # Warm indicator streams ignore bars at or before their last time,
+        # so backfilled history never double-counts
+        for row in released:
+            bar_store_service.on_bar(row[1], row[2], row[0], *row[3:17])
+            indicator_service.on_bar(row[1], row[2], row[0], row[4], row[5], row[6])
+            if self.is_raw_timeframe(row[2]):
+                footprint_service.on_bar(row[1], row[0], row[6], row[7], row[8], row[9])
+                tpo_service.on_bar(row[1], row[0], row[4], row[5])
+                pyramid_service.on_bar(row[1], row[0], *row[3:12])
+
+        if released:
+            self._bump_streams(released)
+        await tpo_service.maybe_flush()
+        await catalog_service.maybe_persist()
+        return len(released)
+
+    def _apply_corrections(self, rows: List[tuple]):
+        """
+        Late bars (at or before bars of their stream the rollups have already
+        taken) are in market_data like every other row but skip the reorder
+        buffer. The TPO engine takes them; the bar store, footprint and pyramid
+        only append, so they stop serving the buckets these bars fall in and
+        reads of them go to TimescaleDB.
+        """
+        for row in rows:
+            bar_store_service.on_correction(row[1], row[2], row[0])
+            if self.is_raw_timeframe(row[2]):
+                footprint_service.on_correction(row[1], row[0])
+                pyramid_service.on_correction(row[1], row[0])
+                tpo_service.on_correction(row[1], row[0], row[4], row[5])
+        logger.info(f"Stored {len(rows)} late bars for {rows[0][1]} {rows[0][2]} from {min(row[0] for row in rows)}")
+
+    async def _write_rows(self, rows: List[tuple], on_conflict: str):
+        if not rows:
+            return
         if not timescale_manager.pool:
-             await timescale_manager.connect()
-             
+            await timescale_manager.connect()
         async with timescale_manager.pool.acquire() as connection:
-            await connection.executemany(query, data_tuples)
-            
-        return len(data_tuples)
+            await connection.executemany(INSERT_MARKET_DATA + on_conflict, rows)
+
+    async def _write_rows_reporting(self, rows: List[tuple], on_conflict: str) -> List[bool]:
+        """
+        Write rows in one set-based statement; True for every row market_data
+        did not hold before. A key repeated within rows is written once (the
+        first row kept, the last one replacing) and its other rows report False.
+        """
+        keep_last = on_conflict == ON_CONFLICT_REPLACE
+        chosen: Dict[tuple, int] = {}
+        for i, row in enumerate(rows):
+            key = (to_micros(row[0]), row[1], row[2])
+            if keep_last or key not in chosen:
+                chosen[key] = i
+        unique = [rows[i] for i in sorted(chosen.values())]
+
+        if not timescale_manager.pool:
+            await timescale_manager.connect()
+        query = INSERT_MARKET_DATA_SET + on_conflict + " RETURNING time, symbol, timeframe, (xmax = 0) AS inserted"
+        async with timescale_manager.pool.acquire() as connection:
+            # DO NOTHING returns no row for a conflict; DO UPDATE returns xmax = 0 only for an insert
+            returned = await connection.fetch(query, *(list(column) for column in zip(*unique)))
+
+        inserted = {(to_micros(r["time"]), r["symbol"], r["timeframe"]) for r in returned if r["inserted"]}
+        return [chosen[key] == i and key in inserted
+                for i, key in enumerate((to_micros(row[0]), row[1], row[2]) for row in rows)]
+
+    def _bump_streams(self, rows: List[tuple]):
+        # One bump per symbol, at its earliest bar, keeps append-only extension exact
+        earliest: Dict[str, datetime] = {}
+        for row in rows:
+            if row[1] not in earliest or row[0] < earliest[row[1]]:
+                earliest[row[1]] = row[0]
+        for symbol, timestamp in earliest.items():
+            bump_stream(symbol, timestamp)
 
     def _parse_timeframe(self, timeframe: str) -> timedelta:
         mapping = {
@@ -102,24 +254,85 @@ class MarketDataService:
         }
         return mapping.get(timeframe, timedelta(minutes=1))
 
-    async def get_bars(self, symbol: str, timeframe: str, limit: int = 500) -> List[Dict[str, Any]]:
+    def is_raw_timeframe(self, timeframe: str) -> bool:
+        """True for the base 1s stream every time-based timeframe aggregates from"""
+        return timeframe == '1s'
+
+    def is_custom_timeframe(self, timeframe: str) -> bool:
+        """True for collector-built range/volume/tick/delta/Renko streams"""
+        return timeframe.startswith(CUSTOM_BAR_PREFIXES)
+
+    async def get_bars(self, symbol: str, timeframe: str, limit: int = 500, max_points: Optional[int] = None) -> List[Dict[str, Any]]:
         logger.info(f"Fetching bars for {symbol} {timeframe} limit={limit}")
-        
-        if timeframe == '1s':
-            query = """
+
+        if max_points and 0 < max_points < limit:
+            return await self._get_bars_downsampled(symbol, timeframe, limit, max_points)
+
+        async def compute():
+            return await self._get_bars_uncached(symbol, timeframe, limit)
+
+        async def extend(cached, changed_from):
+            return await self._extend_bars(symbol, timeframe, limit, cached, changed_from)
+
+        return await versioned(f"bars:{symbol}:{timeframe}:{limit}", symbol, compute, extend)
+
+    async def _get_bars_downsampled(self, symbol: str, timeframe: str, limit: int, max_points: int) -> List[Dict[str, Any]]:
+        """
+        Newest `limit` bars merged into at most `max_points` OHLC buckets. Bar
+        store columns are reduced before any row is built; other sources go
+        through the (cached) full result.
+        """
+        async def compute():
+            columns = bar_store_service.get_columns(symbol, timeframe, limit)
+            if columns is None:
+                columns = bars_to_columns(await self.get_bars(symbol, timeframe, limit))
+            return columns_to_bars(symbol, timeframe, downsample_bar_columns(columns, max_points))
+
+        return await versioned(f"bars:{symbol}:{timeframe}:{limit}:{max_points}", symbol, compute)
+
+    async def _get_bars_uncached(self, symbol: str, timeframe: str, limit: int, since: Optional[datetime] = None) -> List[Dict[str, Any]]:
+        # Hot tier: local columnar bar store, when it holds enough history
+        bars = bar_store_service.get_bars(symbol, timeframe, limit, since)
+        if bars is not None:
+            logger.info(f"Found {len(bars)} rows (bar store)")
+            return bars
+
+        return await self._get_bars_sql(symbol, timeframe, limit, since)
+
+    async def _extend_bars(self, symbol: str, timeframe: str, limit: int, cached: List[Dict[str, Any]], changed_from: int) -> Optional[List[Dict[str, Any]]]:
+        """
+        Refresh a stale "newest N" result when every change since it was cached
+        is at or after its newest bar (appends, or updates to the forming bucket):
+        re-read only from that bar on and splice the older rows back in.
+        """
+        if not cached:
+            return None
+        newest = cached[0]['time']
+        if changed_from < to_micros(newest):
+            return None
+        fresh = await self._get_bars_uncached(symbol, timeframe, limit, since=newest)
+        return (fresh + [bar for bar in cached if bar['time'] < newest])[:limit]
+
+    async def _get_bars_sql(self, symbol: str, timeframe: str, limit: int, since: Optional[datetime] = None) -> List[Dict[str, Any]]:
+        # Stored rows are read directly; custom bars have no time buckets to aggregate into
+        if self.is_raw_timeframe(timeframe) or self.is_custom_timeframe(timeframe):
+            since_clause = "AND time >= $4" if since else ""
+            query = f"""
                 SELECT * FROM market_data 
-                WHERE symbol = $1 AND timeframe = $2
+                WHERE symbol = $1 AND timeframe = $2 {since_clause}
                 ORDER BY time DESC
                 LIMIT $3
             """
-            rows = await timescale_manager.fetch(query, symbol, timeframe, limit)
+            args = (symbol, timeframe, limit) + ((since,) if since else ())
+            rows = await timescale_manager.fetch(query, *args)
             logger.info(f"Found {len(rows)} rows (raw)")
             return [dict(row) for row in rows]
         else:
             # On-the-fly aggregation from 1s data
             interval = self._parse_timeframe(timeframe)
+            since_clause = "AND time >= $5" if since else ""
             
-            query = """
+            query = f"""
                 SELECT 
                     time_bucket($1, time) AS bucket,
                     $2 AS symbol,
@@ -134,12 +347,13 @@ class MarketDataService:
                     sum(number_of_trades) AS number_of_trades,
                     last(open_interest, time) AS open_interest
                 FROM market_data
-                WHERE symbol = $2 AND timeframe = '1s'
+                WHERE symbol = $2 AND timeframe = '1s' {since_clause}
                 GROUP BY bucket
                 ORDER BY bucket DESC
                 LIMIT $4
             """
-            rows = await timescale_manager.fetch(query, interval, symbol, timeframe, limit)
+            args = (interval, symbol, timeframe, limit) + ((since,) if since else ())
+            rows = await timescale_manager.fetch(query, *args)
             logger.info(f"Found {len(rows)} rows (aggregated)")
             
             # Map bucket to time
@@ -150,6 +364,56 @@ class MarketDataService:
                 result.append(d)
             return result
 
+    async def get_bar_range(self, symbol: str, start_time: datetime, end_time: datetime, max_points: int = 1000) -> Dict[str, Any]:
+        """
+        Bars covering [start_time, end_time] at the finest power-of-two
+        resolution (1s, 2s, 4s ...) that keeps them within max_points, newest
+        first, the buckets at both edges whole. Served from the bar pyramid when it covers the range, else
+        aggregated from 1s bars in SQL at the same resolution.
+        """
+        max_points = max(max_points, 1)
+        columns = pyramid_service.get_range(symbol, start_time, end_time, max_points)
+        if columns is not None:
+            seconds = columns['bucket_seconds']
+            bars = columns_to_bars(symbol, f"{seconds}s", columns)
+        else:
+            seconds = pyramid_service.bucket_seconds_for(start_time, end_time, max_points)
+            # Epoch-aligned whole buckets at both edges, as the pyramid levels return them
+            query = """
+                SELECT
+                    time_bucket($1, time) AS bucket,
+                    first(open, time) AS open,
+                    max(high) AS high,
+                    min(low) AS low,
+                    last(close, time) AS close,
+                    sum(volume) AS volume,
+                    sum(bid_volume) AS bid_volume,
+                    sum(ask_volume) AS ask_volume,
+                    sum(number_of_trades) AS number_of_trades,
+                    last(open_interest, time) AS open_interest
+                FROM market_data
+                WHERE symbol = $2 AND timeframe = '1s'
+                  AND time >= time_bucket($1, $3::timestamptz)
+                  AND time < time_bucket($1, $4::timestamptz) + $1
+                GROUP BY bucket
+                ORDER BY bucket DESC
+            """
+            rows = await timescale_manager.fetch(query, timedelta(seconds=seconds), symbol, start_time, end_time)
+            bars = []
+            for row in rows:
+                bar = dict(row)
+                bar['time'] = bar.pop('bucket')
+                bar['symbol'] = symbol
+                bar['timeframe'] = f"{seconds}s"
+                bars.append(bar)
+
+        return {
+            "symbol": symbol,
+            "resolution_seconds": seconds,
+            "source": "pyramid" if columns is not None else "sql",
+            "bars": bars
+        }
+
     async def aggregate_to_higher_timeframes(self, symbol: str, timeframe: str, timestamp: datetime):
         """
         Background task: Aggregate tick data to higher timeframes
@@ -172,8 +436,7 @@ class MarketDataService:
         ask_volume: Optional[float]
     ):
         """Update volume profile for current session"""
-        # Determine session start (e.g., 00:00 UTC for daily)
-        session_start = timestamp.replace(hour=0, minute=0, second=0, microsecond=0)
+        session_start = session_service.session_start(symbol, timestamp)
         
         # Round price to tick size (e.g., 0.01 for forex). 
         # Ideally fetch tick_size from symbols table, but for now hardcode or assume input is already rounded.
@@ -219,8 +482,13 @@ class MarketDataService:
     async def get_footprint_data(self, symbol: str, timeframe: str, start_time: datetime, end_time: datetime) -> List[Dict[str, Any]]:
         """
         Get footprint data (volume at price per bar).
-        Aggregates 1s data into the requested timeframe buckets, then groups by price level within each bucket.
+        Served from the in-memory footprint store when it covers the range;
+        otherwise aggregates 1s data into the requested timeframe buckets, then groups by price level within each bucket.
         """
+        footprint = footprint_service.get_footprint(symbol, timeframe, start_time, end_time)
+        if footprint is not None:
+            return footprint
+
         interval = self._parse_timeframe(timeframe)
         
         query = """
@@ -254,17 +522,29 @@ class MarketDataService:
             
         return [{'time': k, 'levels': v} for k, v in result.items()]
 
-    async def get_cvd_data(self, symbol: str, timeframe: str, start_time: datetime, end_time: datetime) -> List[Dict[str, Any]]:
+    async def get_cvd_data(
+        self,
+        symbol: str,
+        timeframe: str,
+        start_time: datetime,
+        end_time: datetime,
+        max_points: Optional[int] = None,
+        method: str = 'lttb'
+    ) -> List[Dict[str, Any]]:
         """
         Get Cumulative Volume Delta (CVD) data.
+        The line is one running sum of delta from start_time. Each bar's delta
+        is the collector-side value when it sent one, else ask - bid volume,
+        so buckets mixing both kinds of bars share the same baseline.
+        With max_points, the line is reduced (LTTB or min/max) and each kept
+        point's delta covers everything since the previous kept point.
         """
         interval = self._parse_timeframe(timeframe)
         
         query = """
             SELECT 
                 time_bucket($1, time) AS bucket,
-                sum(bid_volume) as bid_volume,
-                sum(ask_volume) as ask_volume
+                sum(coalesce(delta, coalesce(ask_volume, 0) - coalesce(bid_volume, 0))) as delta
             FROM market_data
             WHERE symbol = $2 AND timeframe = '1s' AND time >= $3 AND time <= $4
             GROUP BY bucket
@@ -276,9 +556,7 @@ class MarketDataService:
         result = []
         cumulative_delta = 0
         for row in rows:
-            bid_vol = row['bid_volume'] or 0
-            ask_vol = row['ask_volume'] or 0
-            delta = ask_vol - bid_vol # Buyers - Sellers
+            delta = row['delta'] or 0  # Buyers - Sellers
             cumulative_delta += delta
             
             result.append({
@@ -286,13 +564,33 @@ class MarketDataService:
                 'delta': delta,
                 'cumulative_delta': cumulative_delta
             })
-            
+
+        if max_points and len(result) > max_points:
+            result = self._downsample_cvd(result, max_points, method)
+        return result
+
+    def _downsample_cvd(self, points: List[Dict[str, Any]], max_points: int, method: str) -> List[Dict[str, Any]]:
+        times = np.fromiter((to_micros(point['time']) for point in points), dtype=np.int64, count=len(points))
+        values = np.fromiter((point['cumulative_delta'] for point in points), dtype=np.float64, count=len(points))
+        running = np.cumsum([point['delta'] for point in points], dtype=np.float64)
+
+        kept = downsample_line(times - times[0], values, max_points, method)
+        result = []
+        previous = None
+        for i in kept.tolist():
+            delta = running[i] - (running[previous] if previous is not None else 0.0)
+            result.append({'time': points[i]['time'], 'delta': float(delta), 'cumulative_delta': points[i]['cumulative_delta']})
+            previous = i
         return result
 
     async def get_available_symbols(self) -> List[str]:
         """
         Get list of all available symbols from the database
         """
+        symbols = catalog_service.get_symbols()
+        if symbols is not None:
+            return symbols
+
         query = """
             SELECT DISTINCT symbol
             FROM market_data
@@ -305,6 +603,10 @@ class MarketDataService:
         """
         Get detailed information about a specific symbol
         """
+        info = catalog_service.get_symbol_info(symbol)
+        if info is not None:
+            return info
+
         # Get basic symbol stats
         query = """
             SELECT
@@ -361,4 +663,13 @@ class MarketDataService:
             "data": data
         })
 
+    async def broadcast_large_trades(self, symbol: str, events: List[Dict[str, Any]]):
+        """Broadcast collector large trade / iceberg events to WebSocket clients"""
+        from app.services.websocket_service import ws_manager
+        await ws_manager.broadcast_to_symbol(symbol, {
+            "type": "large_trades",
+            "symbol": symbol,
+            "data": events
+        })
+
 market_data_service = MarketDataService()
@@ -1,14 +1,98 @@
-from typing import List, Dict, Any, Optional
+from typing import List, Dict, Any, Optional, Tuple
+from collections import deque
 from datetime import datetime
 import logging
 import random
 
+from app.config import settings
 from app.db.timescale import timescale_manager
 from app.core.caching import cache_key, cached
+from app.core.native import TIMEFRAME_SECONDS
 
 logger = logging.getLogger(__name__)
 
+# Event codes sent by the collector's order flow detector (TradeFlow_Pro_OrderFlow.h)
+ORDERFLOW_EVENT_TYPES = {
+    "SB": "stacked_buy",
+    "SS": "stacked_sell",
+    "UH": "unfinished_high",
+    "UL": "unfinished_low",
+    "AH": "absorption_high",
+    "AL": "absorption_low",
+}
+
+# Per-trade events from the collector's large trade detector (TradeFlow_Pro_LargeTrades.h),
+# kept per symbol rather than per bar and pushed to WebSocket clients as they arrive
+TRADE_EVENT_TYPES = {
+    "LB": "large_buy",
+    "LS": "large_sell",
+    "IB": "iceberg_bid",
+    "IA": "iceberg_ask",
+}
+
 class OrderFlowService:
+    def __init__(self):
+        # Recent collector events per (symbol, seconds per bar), oldest first
+        self._events: Dict[Tuple[str, int], deque] = {}
+        # Recent large trade and iceberg events per symbol, oldest first
+        self._trades: Dict[str, deque] = {}
+
+    @staticmethod
+    def _bar_seconds(timeframe: str) -> Optional[int]:
+        """'1m' style labels and the collector's '60s' style map to the same bar"""
+        if timeframe in TIMEFRAME_SECONDS:
+            return TIMEFRAME_SECONDS[timeframe]
+        if timeframe.endswith('s') and timeframe[:-1].isdigit():
+            return int(timeframe[:-1])
+        return None
+
+    def on_events(self, symbol: str, seconds_per_bar: int, events: List[list]) -> Tuple[int, List[Dict[str, Any]]]:
+        """
+        Store events posted by the collector as [time, code, low, high, volume].
+        Unknown codes and malformed rows are skipped. Returns the number stored
+        and the large trade / iceberg events, for the caller to broadcast.
+        """
+        stored = 0
+        alerts: List[Dict[str, Any]] = []
+        for event in events:
+            if len(event) != 5 or (event[1] not in ORDERFLOW_EVENT_TYPES and event[1] not in TRADE_EVENT_TYPES):
+                continue
+            try:
+                event_time = datetime.strptime(event[0], "%Y-%m-%d %H:%M:%S.%f")
+            except ValueError:
+                event_time = datetime.fromisoformat(event[0].replace('Z', '+00:00'))
+            low, high, volume = float(event[2]), float(event[3]), float(event[4])
+
+            if event[1] in TRADE_EVENT_TYPES:
+                alert = {
+                    "time": event_time.isoformat(),
+                    "type": TRADE_EVENT_TYPES[event[1]],
+                    "price": low,
+                    "volume": volume
+                }
+                self._stream(self._trades, symbol).append(alert)
+                alerts.append(alert)
+            else:
+                self._stream(self._events, (symbol, seconds_per_bar)).append(
+                    (event_time, ORDERFLOW_EVENT_TYPES[event[1]], low, high, volume))
+            stored += 1
+        return stored, alerts
+
+    @staticmethod
+    def _stream(streams: Dict, key) -> deque:
+        stream = streams.get(key)
+        if stream is None:
+            stream = deque(maxlen=settings.ORDERFLOW_EVENTS_PER_STREAM)
+            streams[key] = stream
+        return stream
+
+    def get_large_trades(self, symbol: str, limit: int = 100) -> List[Dict[str, Any]]:
+        """Large trade and iceberg events for a symbol, newest first"""
+        stream = self._trades.get(symbol)
+        if not stream:
+            return []
+        return list(reversed(stream))[:limit]
+
     async def get_cvd(
         self,
         symbol: str,
@@ -38,7 +122,7 @@ class OrderFlowService:
         try:
             logger.info(f"OrderFlowService.get_cvd: Fetching data for symbol={symbol}, timeframe={timeframe}, limit={limit}")
             query = """
-                SELECT time, close, bid_volume, ask_volume, volume
+                SELECT time, close, bid_volume, ask_volume, volume, delta
                 FROM market_data
                 WHERE symbol = $1 AND timeframe = $2
                 ORDER BY time DESC
@@ -74,7 +158,8 @@ class OrderFlowService:
                     bid_vol = total_vol * split_ratio
                     ask_vol = total_vol * (1 - split_ratio)
 
-                delta = ask_vol - bid_vol
+                # Collector-side delta when sent; one running sum either way
+                delta = float(row['delta']) if row['delta'] is not None else ask_vol - bid_vol
                 cumulative_delta += delta
 
                 cvd_data.append({
@@ -316,51 +401,32 @@ class OrderFlowService:
         ratio: float = 3.0
     ) -> List[Dict[str, Any]]:
         """
-        Detect Diagonal Imbalances
-        Ask at Price P > Bid at Price P-1 * ratio (Buying Imbalance)
-        Bid at Price P > Ask at Price P+1 * ratio (Selling Imbalance)
+        Order flow events detected by the collector from tick-resolution
+        volume at price, grouped by bar (newest first, at most `limit` bars):
+        stacked diagonal imbalances, unfinished auctions and absorption.
+
+        Diagonal imbalance: ask at P >= bid at P-1 * ratio (buying), bid at P
+        >= ask at P+1 * ratio (selling). The ratio is the study's "Diagonal
+        Imbalance Ratio" input; `ratio` is kept for API compatibility.
         """
-        footprints = await self.get_footprint(symbol, timeframe, limit)
-        imbalances = []
-        
-        for bar in footprints:
-            levels = bar['levels'] # Sorted by price DESC
-            bar_imbalances = []
-            
-            # We need to access by index
-            for i in range(len(levels) - 1):
-                # Current level (higher price)
-                curr = levels[i]
-                # Next level (lower price)
-                next_level = levels[i+1]
-                
-                # Diagonal calculation depends on tick size, but here we just compare adjacent levels in the array
-                # Assuming levels are contiguous tick-by-tick. If not, this logic needs adjustment.
-                
-                # Buying Imbalance: Ask at Current > Bid at Next * Ratio
-                if curr['ask'] > next_level['bid'] * ratio and curr['ask'] > 0 and next_level['bid'] > 0:
-                    bar_imbalances.append({
-                        "type": "buy",
-                        "price": curr['price'],
-                        "volume": curr['ask'],
-                        "compared_to": next_level['bid']
-                    })
-                
-                # Selling Imbalance: Bid at Next > Ask at Current * Ratio
-                if next_level['bid'] > curr['ask'] * ratio and next_level['bid'] > 0 and curr['ask'] > 0:
-                    bar_imbalances.append({
-                        "type": "sell",
-                        "price": next_level['price'],
-                        "volume": next_level['bid'],
-                        "compared_to": curr['ask']
-                    })
-            
-            if bar_imbalances:
-                imbalances.append({
-                    "timestamp": bar['timestamp'],
-                    "imbalances": bar_imbalances
-                })
-                
+        stream = self._events.get((symbol, self._bar_seconds(timeframe)))
+        if not stream:
+            return []
+
+        imbalances: List[Dict[str, Any]] = []
+        for bar_time, event_type, low, high, volume in reversed(stream):
+            timestamp = bar_time.isoformat()
+            if not imbalances or imbalances[-1]["timestamp"] != timestamp:
+                if len(imbalances) == limit:
+                    break
+                imbalances.append({"timestamp": timestamp, "imbalances": []})
+            imbalances[-1]["imbalances"].append({
+                "type": event_type,
+                "price_low": low,
+                "price_high": high,
+                "volume": volume
+            })
+
         return imbalances
 
 orderflow_service = OrderFlowService()
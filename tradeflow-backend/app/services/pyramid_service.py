@@ -0,0 +1,94 @@
+from typing import Dict, Any, Optional
+from datetime import datetime
+import logging
+
+from app.config import settings
+from app.core.coverage import CorrectedRanges
+from app.core.native import native, to_micros
+
+logger = logging.getLogger(__name__)
+
+class PyramidService:
+    """
+    Bars at power-of-two resolutions (1s, 2s, 4s ... 2^(levels-1) s) rolled
+    up from ingested 1s bars. A time range is answered from the finest level
+    that fits the point budget, so zooming in or out reads a few thousand
+    precomputed buckets at most. Only bars seen since startup are covered;
+    older ranges, and ranges holding late bars the pyramid could not take,
+    return None and callers aggregate them in SQL.
+    """
+
+    def __init__(self):
+        self.pyramid = native.BarPyramid(settings.PYRAMID_LEVELS, settings.PYRAMID_LEVEL_BARS) if native else None
+        # Newest 1s bar fed per symbol; resent bars are skipped and backfilled
+        # ones marked corrected (same guard as the footprint store)
+        self._last_time: Dict[str, int] = {}
+        # Times of late 1s bars written to TimescaleDB only, per symbol
+        self.corrected = CorrectedRanges()
+
+    def on_bar(
+        self,
+        symbol: str,
+        timestamp: datetime,
+        open: float,
+        high: float,
+        low: float,
+        close: float,
+        volume: float,
+        bid_volume: Optional[float],
+        ask_volume: Optional[float],
+        number_of_trades: Optional[int],
+        open_interest: Optional[float]
+    ):
+        if not self.pyramid:
+            return
+        micros = to_micros(timestamp)
+        last_time = self._last_time.get(symbol, -1)
+        if micros <= last_time:
+            if micros < last_time:
+                self.on_correction(symbol, timestamp)
+            return
+        self._last_time[symbol] = micros
+        self.pyramid.add(
+            symbol, micros, open, high, low, close, volume or 0,
+            bid_volume, ask_volume,
+            float(number_of_trades) if number_of_trades is not None else None,
+            open_interest
+        )
+
+    def on_correction(self, symbol: str, timestamp: datetime):
+        """A late 1s bar was written to TimescaleDB only: ranges holding it are read from there"""
+        if self.pyramid:
+            self.corrected.add(symbol, to_micros(timestamp))
+
+    def get_range(self, symbol: str, start_time: datetime, end_time: datetime, max_points: int) -> Optional[Dict[str, Any]]:
+        """
+        Oldest-first columns ('time' in epoch microseconds, NaN for missing)
+        plus 'bucket_seconds', or None when no level covers start_time
+        """
+        if not self.pyramid:
+            return None
+        start, end = to_micros(start_time), to_micros(end_time)
+        columns = self.pyramid.query(symbol, start, end, max_points)
+        if columns is not None:
+            # Any bucket of the chosen width holding a late bar
+            width = columns['bucket_seconds'] * 1_000_000
+            if self.corrected.overlaps(symbol, start - start % width, end - end % width + width - 1):
+                return None
+        return columns
+
+    @staticmethod
+    def bucket_seconds_for(start_time: datetime, end_time: datetime, max_points: int) -> int:
+        """The bucket width get_range would pick with every level covered"""
+        span = max(to_micros(end_time) - to_micros(start_time), 0) + 1
+        seconds = 1
+        for _ in range(settings.PYRAMID_LEVELS - 1):
+            if -(-span // (seconds * 1000000)) + 1 <= max_points:
+                break
+            seconds *= 2
+        return seconds
+
+    def stats(self) -> Dict[str, Any]:
+        return self.pyramid.stats() if self.pyramid else {}
+
+pyramid_service = PyramidService()
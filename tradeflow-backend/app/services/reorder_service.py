@@ -0,0 +1,76 @@
+from typing import List, Dict, Any
+import logging
+import re
+import time
+
+from app.config import settings
+from app.core.native import native, to_micros
+
+logger = logging.getLogger(__name__)
+
+_TIMEFRAME = re.compile(r"^(\d+)([smhd])$")
+_UNIT_SECONDS = {'s': 1, 'm': 60, 'h': 3600, 'd': 86400}
+
+class ReorderService:
+    """
+    Per-stream watermark reorder buffer in front of the in-memory rollups.
+
+    Bars are written to market_data before they are pushed here. They are
+    released to the rollups in time order per (symbol, timeframe) once the
+    stream's newest bar is INGEST_REORDER_LATENESS_BARS bars (at least
+    INGEST_REORDER_MIN_LATENESS_MS) past them, or once the stream has been
+    quiet for INGEST_REORDER_HOLD_MS, so the rollups see every bar of a burst
+    that arrived shuffled. A bar at or before the stream's last released time
+    is late and goes to the correction path; a resent bar still in the buffer
+    replaces the buffered one. A crash only loses what the rollups had not
+    yet taken, never a stored row.
+    Without the native extension, or with reordering disabled, every bar is
+    released as soon as it is pushed.
+    """
+
+    def __init__(self):
+        enabled = settings.INGEST_REORDER_LATENESS_BARS > 0
+        self.buffer = native.ReorderBuffer(
+            settings.INGEST_REORDER_HOLD_MS * 1000,
+            settings.INGEST_REORDER_MAX_BARS,
+            settings.INGEST_REORDER_STREAMS
+        ) if native and enabled else None
+        self._ready: List[Any] = []   # Pushed payloads when there is no buffer
+        self._lateness: Dict[str, int] = {}
+
+    def lateness_micros(self, timeframe: str) -> int:
+        lateness = self._lateness.get(timeframe)
+        if lateness is None:
+            match = _TIMEFRAME.match(timeframe)
+            seconds = int(match.group(1)) * _UNIT_SECONDS[match.group(2)] if match else 0
+            lateness = max(settings.INGEST_REORDER_MIN_LATENESS_MS * 1000,
+                           settings.INGEST_REORDER_LATENESS_BARS * seconds * 1_000_000)
+            self._lateness[timeframe] = lateness
+        return lateness
+
+    def push(self, symbol: str, timeframe: str, timestamp, payload: Any) -> bool:
+        """Queue a bar; False when it is late and must take the correction path"""
+        if not self.buffer:
+            self._ready.append(payload)
+            return True
+        result = self.buffer.push(
+            f"{symbol}\0{timeframe}", to_micros(timestamp), payload,
+            self.lateness_micros(timeframe), time.monotonic_ns() // 1000
+        )
+        return result != 2
+
+    def drain(self, flush: bool = False) -> List[Any]:
+        """Payloads released since the last call, in time order per stream"""
+        if not self.buffer:
+            ready, self._ready = self._ready, []
+            return ready
+        if flush:
+            self.buffer.flush()
+        else:
+            self.buffer.expire(time.monotonic_ns() // 1000)
+        return [payload for _, _, payload in self.buffer.drain()]
+
+    def stats(self) -> Dict[str, Any]:
+        return self.buffer.stats() if self.buffer else {}
+
+reorder_service = ReorderService()
@@ -0,0 +1,220 @@
+from typing import List, Dict, Any, Optional, Tuple, Union
+from bisect import bisect_right
+from datetime import date, datetime, timedelta
+from zoneinfo import ZoneInfo
+import logging
+
+from app.config import settings
+from app.core.native import native, to_micros, from_micros
+
+logger = logging.getLogger(__name__)
+
+DAY_SECONDS = 86400
+DAY_MICROS = DAY_SECONDS * 1_000_000
+WEEKDAYS = [0, 1, 2, 3, 4]
+
+# (session index, start, end, in session, bar index, bar start), times in epoch microseconds
+Position = Tuple[int, int, int, bool, int, int]
+
+def _seconds(value: Union[str, int]) -> int:
+    """'HH:MM', 'HH:MM:SS' or seconds after midnight; '24:00' is the end of the day"""
+    if isinstance(value, int):
+        return value
+    parts = [int(part) for part in value.split(':')]
+    return parts[0] * 3600 + parts[1] * 60 + (parts[2] if len(parts) > 2 else 0)
+
+def compile_sessions(spec: Dict[str, Any], first: date, last: date) -> Tuple[List[int], List[int]]:
+    """
+    Sorted, non-overlapping [start, end) sessions in epoch microseconds for
+    the trading dates first..last of a SESSION_CALENDARS entry:
+
+        {"timezone": "America/Chicago",
+         "sessions": [{"open": "17:00", "close": "16:00", "days": [0, 1, 2, 3, 4]}],
+         "holidays": ["2025-12-25"],
+         "early_closes": {"2025-11-28": "12:15"}}
+
+    A session's trading date is the date it closes on; one that closes at or
+    before its open time opens the evening before. "days" are the weekdays
+    (Monday = 0) of its trading dates. Hours are wall-clock times in the time
+    zone, so sessions follow its DST changes.
+    """
+    zone = ZoneInfo(spec.get('timezone', 'UTC'))
+    holidays = set(spec.get('holidays', []))
+    early_closes = {day: _seconds(close) for day, close in spec.get('early_closes', {}).items()}
+    hours = []
+    for session in spec.get('sessions', []):
+        open_seconds = _seconds(session['open'])
+        close_seconds = _seconds(session['close'])
+        if close_seconds <= open_seconds:
+            open_seconds -= DAY_SECONDS
+        hours.append((open_seconds, close_seconds, set(session.get('days', WEEKDAYS))))
+
+    sessions = []
+    day = first
+    while day <= last:
+        key = day.isoformat()
+        if key not in holidays:
+            midnight = datetime(day.year, day.month, day.day, tzinfo=zone)
+            for open_seconds, close_seconds, days in hours:
+                close_seconds = min(close_seconds, early_closes.get(key, close_seconds))
+                if day.weekday() not in days or close_seconds <= open_seconds:
+                    continue
+                # Aware datetime + timedelta is wall-clock arithmetic in the zone
+                sessions.append((
+                    to_micros(midnight + timedelta(seconds=open_seconds)),
+                    to_micros(midnight + timedelta(seconds=close_seconds))
+                ))
+        day += timedelta(days=1)
+
+    sessions.sort()
+    starts: List[int] = []
+    ends: List[int] = []
+    for start, end in sessions:
+        if ends and start < ends[-1]:
+            start = ends[-1]
+        if start < end:
+            starts.append(start)
+            ends.append(end)
+    return starts, ends
+
+class SessionService:
+    """
+    Trading sessions per symbol, shared by every engine that groups bars by
+    session (volume profile, TPO). Calendars come from SESSION_CALENDARS
+    (exchange hours, holidays and early closes) and from the session times a
+    Sierra Chart chart reports through the collector; each is compiled once
+    into sorted session boundaries held by a native SessionCalendar, which the
+    TPO engine reads directly. A symbol uses the calendar named by its longest
+    SESSION_SYMBOLS prefix, else its chart's session times, else daily
+    sessions at TPO_SESSION_OFFSET_SECONDS lasting TPO_SESSION_SECONDS.
+    Chart session times are in the chart's time zone, the frame the collector
+    stamps bars in. Without the native extension the same boundaries are
+    searched here with bisect.
+    """
+
+    def __init__(self):
+        self.calendar = native.SessionCalendar(
+            settings.TPO_SESSION_OFFSET_SECONDS,
+            settings.TPO_SESSION_SECONDS
+        ) if native else None
+        self._sessions: Dict[str, Tuple[List[int], List[int]]] = {}  # Boundaries when there is no native calendar
+        self._assigned: Dict[str, str] = {}     # Symbol -> calendar name, '' for the daily default
+        self._chart_times: Dict[str, Tuple] = {}
+        self._first = date.fromisoformat(settings.SESSION_CALENDAR_START)
+        self._last = date.today() + timedelta(days=366 * settings.SESSION_CALENDAR_YEARS_AHEAD)
+
+        for name, spec in settings.SESSION_CALENDARS.items():
+            try:
+                self._define(name, *compile_sessions(spec, self._first, self._last))
+            except Exception as e:
+                logger.error(f"Session calendar {name} not compiled: {e}")
+
+    def resolve(self, symbol: str):
+        """Assigns the symbol its calendar the first time it is seen"""
+        if symbol in self._assigned:
+            return
+        name = self._configured(symbol)
+        if not name and symbol in self._chart_times:
+            name = f"chart:{symbol}"
+        self._assign(symbol, name)
+
+    def locate(self, symbol: str, micros: int, bar_micros: int = 0) -> Optional[Position]:
+        """The symbol's session at micros (or the last one started before it) and the bar of bar_micros in it"""
+        self.resolve(symbol)
+        if self.calendar:
+            return self.calendar.locate(symbol, micros, bar_micros)
+        return self._locate_py(symbol, micros, bar_micros)
+
+    def session_start(self, symbol: str, timestamp: datetime) -> datetime:
+        """Start of the session timestamp belongs to; the daily default outside the compiled range"""
+        micros = to_micros(timestamp)
+        position = self.locate(symbol, micros)
+        start = position[1] if position else self._daily(micros)[1]
+        result = from_micros(start)
+        return result.replace(tzinfo=None) if timestamp.tzinfo is None else result
+
+    def bar_index(self, symbol: str, timestamp: datetime, seconds: int) -> Optional[int]:
+        """Bar of the given width since the session start, None outside session hours"""
+        position = self.locate(symbol, to_micros(timestamp), seconds * 1_000_000)
+        return position[4] if position and position[3] else None
+
+    def set_chart_sessions(
+        self,
+        symbol: str,
+        start_time: int,
+        end_time: int,
+        use_evening_session: bool = False,
+        evening_start_time: int = 0,
+        evening_end_time: int = 0
+    ) -> bool:
+        """
+        Session times of the symbol's Sierra Chart chart, in seconds after
+        midnight with inclusive end times as sc.StartTime1 / sc.EndTime1 (and
+        the evening session pair). Returns whether the calendar changed.
+        """
+        times = (start_time, end_time, use_evening_session, evening_start_time, evening_end_time)
+        if self._chart_times.get(symbol) == times:
+            return False
+        pairs = [(start_time, end_time)]
+        if use_evening_session:
+            pairs.append((evening_start_time, evening_end_time))
+        spec = {
+            'timezone': 'UTC',
+            'sessions': [{'open': start, 'close': end + 1, 'days': list(range(7))} for start, end in pairs]
+        }
+
+        name = f"chart:{symbol}"
+        if not self._define(name, *compile_sessions(spec, self._first, self._last)):
+            logger.error(f"Session times of {symbol} rejected: {times}")
+            return False
+        self._chart_times[symbol] = times
+        if not self._configured(symbol):
+            self._assign(symbol, name)
+        logger.info(f"Session calendar of {symbol} set from chart session times {times}")
+        return True
+
+    def stats(self) -> Dict[str, Any]:
+        return self.calendar.stats() if self.calendar else {}
+
+    def _define(self, name: str, starts: List[int], ends: List[int]) -> bool:
+        if self.calendar:
+            return self.calendar.define(name, starts, ends)
+        self._sessions[name] = (starts, ends)
+        return True
+
+    def _assign(self, symbol: str, name: str):
+        if self.calendar:
+            self.calendar.assign(symbol, name)
+        self._assigned[symbol] = name
+
+    def _configured(self, symbol: str) -> str:
+        """Calendar of the longest SESSION_SYMBOLS prefix of symbol that was compiled"""
+        best_prefix, best_name = None, ''
+        for prefix, name in settings.SESSION_SYMBOLS.items():
+            if symbol.startswith(prefix) and (best_prefix is None or len(prefix) > len(best_prefix)) and self._defined(name):
+                best_prefix, best_name = prefix, name
+        return best_name
+
+    def _defined(self, name: str) -> bool:
+        return self.calendar.has_calendar(name) if self.calendar else name in self._sessions
+
+    def _daily(self, micros: int) -> Tuple[int, int, int]:
+        offset = settings.TPO_SESSION_OFFSET_SECONDS * 1_000_000 % DAY_MICROS
+        index = (micros - offset) // DAY_MICROS
+        start = index * DAY_MICROS + offset
+        return index, start, start + min(max(settings.TPO_SESSION_SECONDS, 1), DAY_SECONDS) * 1_000_000
+
+    def _locate_py(self, symbol: str, micros: int, bar_micros: int) -> Optional[Position]:
+        name = self._assigned[symbol]
+        if name:
+            starts, ends = self._sessions[name]
+            index = bisect_right(starts, micros) - 1
+            if index < 0 or not ends or micros >= ends[-1]:
+                return None
+            start, end = starts[index], ends[index]
+        else:
+            index, start, end = self._daily(micros)
+        bar = (micros - start) // bar_micros if bar_micros > 0 else 0
+        return index, start, end, micros < end, bar, start + bar * bar_micros
+
+session_service = SessionService()
@@ -0,0 +1,191 @@
+from typing import List, Dict, Any, Optional
+from datetime import datetime
+import logging
+import time
+
+from app.config import settings
+from app.core.native import native, to_micros, from_micros
+from app.db.timescale import timescale_manager
+from app.services.session_service import session_service
+
+logger = logging.getLogger(__name__)
+
+class TPOService:
+    """
+    Market profile (TPO) sessions built in memory from ingest.
+    Every 1s bar marks its range with the letter of its period; the engine
+    keeps POC, initial balance and single prints current per bar. Sessions
+    come from the shared session calendar (see SessionService). Changed
+    levels are flushed to market_profile (and the session summary to
+    market_profile_sessions) at most every TPO_FLUSH_SECONDS.
+    """
+
+    def __init__(self):
+        self.engine = native.TPOEngine(
+            settings.TPO_TICK_SIZE,
+            settings.TPO_PERIOD_SECONDS,
+            settings.TPO_SESSION_OFFSET_SECONDS,
+            settings.TPO_SESSION_SECONDS,
+            settings.TPO_IB_PERIODS,
+            settings.TPO_VALUE_AREA
+        ) if native else None
+        if self.engine:
+            self.engine.set_calendar(session_service.calendar)
+        # Same in-order guard as the footprint store: resent bars are skipped
+        self._last_time: Dict[str, int] = {}
+        self._last_flush = time.monotonic()
+        # Snapshots from a failed flush, written before newer ones on the next try
+        self._pending: List[Dict[str, Any]] = []
+
+    def on_bar(self, symbol: str, timestamp: datetime, high: float, low: float):
+        """Feed a stored 1s bar"""
+        if not self.engine:
+            return
+        micros = to_micros(timestamp)
+        last_time = self._last_time.get(symbol, -1)
+        if micros <= last_time:
+            if micros < last_time:
+                self.on_correction(symbol, timestamp, high, low)
+            return
+        self._last_time[symbol] = micros
+        session_service.resolve(symbol)
+        self.engine.add(symbol, micros, high, low)
+
+    def on_correction(self, symbol: str, timestamp: datetime, high: float, low: float):
+        """
+        Feed a late 1s bar. Marking letters is idempotent, so a resend changes
+        nothing and a backfilled bar of the live session adds its range;
+        bars from sessions that already ended are rejected by the engine.
+        """
+        if not self.engine:
+            return
+        session_service.resolve(symbol)
+        self.engine.add(symbol, to_micros(timestamp), high, low)
+
+    async def maybe_flush(self):
+        if not self.engine or time.monotonic() - self._last_flush < settings.TPO_FLUSH_SECONDS:
+            return
+        self._last_flush = time.monotonic()
+        await self.flush()
+
+    async def flush(self) -> int:
+        """Upsert changed levels and session summaries; returns levels written"""
+        if not self.engine:
+            return 0
+        self._pending.extend(self.engine.flush())
+        if not self._pending:
+            return 0
+
+        level_rows = []
+        session_rows = []
+        for snapshot in self._pending:
+            session_start = from_micros(snapshot['session_start'])
+            symbol = snapshot['symbol']
+            for price, count, letters in snapshot['levels']:
+                level_rows.append((session_start, symbol, session_start, price, count, letters))
+            session_rows.append((
+                session_start, symbol, from_micros(snapshot['last_time']), snapshot['complete'],
+                snapshot['periods'], snapshot['tpo_count'], snapshot['single_prints'],
+                snapshot['high'], snapshot['low'], snapshot['poc'],
+                snapshot['value_area_high'], snapshot['value_area_low'],
+                snapshot['ib_high'], snapshot['ib_low'], snapshot['ib_complete']
+            ))
+
+        # Levels are keyed by session, so time = session_start and a level
+        # flushed again in a later period overwrites its earlier row
+        level_query = """
+            INSERT INTO market_profile (time, symbol, session_start, price_level, tpo_count, tpo_letters)
+            VALUES ($1, $2, $3, $4, $5, $6)
+            ON CONFLICT (time, symbol, session_start, price_level) DO UPDATE SET
+                tpo_count = EXCLUDED.tpo_count,
+                tpo_letters = EXCLUDED.tpo_letters
+        """
+        session_query = """
+            INSERT INTO market_profile_sessions (
+                session_start, symbol, last_update, complete, periods, tpo_count, single_prints,
+                high, low, poc, value_area_high, value_area_low, ib_high, ib_low, ib_complete
+            ) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15)
+            ON CONFLICT (session_start, symbol) DO UPDATE SET
+                last_update = EXCLUDED.last_update,
+                complete = EXCLUDED.complete,
+                periods = EXCLUDED.periods,
+                tpo_count = EXCLUDED.tpo_count,
+                single_prints = EXCLUDED.single_prints,
+                high = EXCLUDED.high,
+                low = EXCLUDED.low,
+                poc = EXCLUDED.poc,
+                value_area_high = EXCLUDED.value_area_high,
+                value_area_low = EXCLUDED.value_area_low,
+                ib_high = EXCLUDED.ib_high,
+                ib_low = EXCLUDED.ib_low,
+                ib_complete = EXCLUDED.ib_complete
+        """
+
+        try:
+            if not timescale_manager.pool:
+                await timescale_manager.connect()
+            async with timescale_manager.pool.acquire() as connection:
+                async with connection.transaction():
+                    if level_rows:
+                        await connection.executemany(level_query, level_rows)
+                    await connection.executemany(session_query, session_rows)
+        except Exception as e:
+            logger.error(f"TPO flush failed, retrying next interval: {e}")
+            return 0
+
+        self._pending = []
+        return len(level_rows)
+
+    def get_profile(self, symbol: str) -> Optional[Dict[str, Any]]:
+        """Full profile of the symbol's live session, or None"""
+        if not self.engine:
+            return None
+        profile = self.engine.profile(symbol)
+        if profile is None:
+            return None
+        return self._format(profile)
+
+    async def get_session(self, symbol: str, session_start: datetime) -> Optional[Dict[str, Any]]:
+        """A stored session (summary plus levels) from TimescaleDB"""
+        summary = await timescale_manager.fetchrow("""
+            SELECT * FROM market_profile_sessions
+            WHERE symbol = $1 AND session_start = $2
+        """, symbol, session_start)
+        if summary is None:
+            return None
+
+        levels = await timescale_manager.fetch("""
+            SELECT price_level, tpo_count, tpo_letters
+            FROM market_profile
+            WHERE symbol = $1 AND time = $2 AND session_start = $2
+            ORDER BY price_level DESC
+        """, symbol, session_start)
+
+        result = dict(summary)
+        result['session_start'] = summary['session_start'].isoformat()
+        result['last_update'] = summary['last_update'].isoformat()
+        result['levels'] = [
+            {'price': row['price_level'], 'tpo_count': row['tpo_count'], 'letters': row['tpo_letters']}
+            for row in levels
+        ]
+        return result
+
+    @staticmethod
+    def same_session(profile: Dict[str, Any], session_start: datetime) -> bool:
+        return profile['session_start'] == from_micros(to_micros(session_start)).isoformat()
+
+    def stats(self) -> Dict[str, Any]:
+        return self.engine.stats() if self.engine else {}
+
+    @staticmethod
+    def _format(profile: Dict[str, Any]) -> Dict[str, Any]:
+        result = dict(profile)
+        result['session_start'] = from_micros(profile['session_start']).isoformat()
+        result['last_update'] = from_micros(result.pop('last_time')).isoformat()
+        result['levels'] = [
+            {'price': price, 'tpo_count': count, 'letters': letters}
+            for price, count, letters in profile['levels']
+        ]
+        return result
+
+tpo_service = TPOService()
@@ -4,8 +4,15 @@ import logging
 import json
 import asyncio
 
+from app.config import settings
+from app.core.native import native
+
 logger = logging.getLogger(__name__)
 
+# Message types that carry events rather than the latest state; a slow
+# client gets every one of them instead of only the newest
+EVENT_MESSAGE_TYPES = {"large_trades"}
+
 class WebSocketService:
     def __init__(self):
         # Map symbol -> Set of WebSockets
@@ -13,9 +20,25 @@ class WebSocketService:
         # Map WebSocket -> Set of symbols (for cleanup)
         self.socket_subscriptions: Dict[WebSocket, Set[str]] = {}
 
+        # Native fan-out: bounded per-connection queues drained by one writer task
+        # per socket, so a slow client never holds up the others
+        self.broadcaster = native.Broadcaster(settings.WS_SEND_QUEUE_SIZE) if native else None
+        self.connection_ids: Dict[WebSocket, int] = {}
+        self.writer_events: Dict[int, asyncio.Event] = {}
+        self.writer_tasks: Dict[int, asyncio.Task] = {}
+
     async def connect(self, websocket: WebSocket):
         await websocket.accept()
         self.socket_subscriptions[websocket] = set()
+
+        if self.broadcaster:
+            connection_id = self.broadcaster.add_connection()
+            self.connection_ids[websocket] = connection_id
+            self.writer_events[connection_id] = asyncio.Event()
+            self.writer_tasks[connection_id] = asyncio.create_task(
+                self._writer(websocket, connection_id)
+            )
+
         logger.info(f"WebSocket connected: {websocket.client}")
 
     def disconnect(self, websocket: WebSocket):
@@ -27,28 +50,56 @@ class WebSocketService:
                     if not self.active_connections[symbol]:
                         del self.active_connections[symbol]
             del self.socket_subscriptions[websocket]
+
+        connection_id = self.connection_ids.pop(websocket, None)
+        if connection_id is not None:
+            self.broadcaster.remove_connection(connection_id)
+            self.writer_events.pop(connection_id, None)
+            task = self.writer_tasks.pop(connection_id, None)
+            if task and task is not asyncio.current_task():
+                task.cancel()
+
         logger.info(f"WebSocket disconnected: {websocket.client}")
 
     async def subscribe(self, websocket: WebSocket, symbols: List[str]):
+        connection_id = self.connection_ids.get(websocket)
         for symbol in symbols:
             if symbol not in self.active_connections:
                 self.active_connections[symbol] = set()
             self.active_connections[symbol].add(websocket)
             self.socket_subscriptions[websocket].add(symbol)
+            if connection_id is not None:
+                self.broadcaster.subscribe(connection_id, symbol)
         logger.info(f"WebSocket subscribed to: {symbols}")
 
     async def unsubscribe(self, websocket: WebSocket, symbols: List[str]):
+        connection_id = self.connection_ids.get(websocket)
         for symbol in symbols:
             if symbol in self.active_connections:
                 self.active_connections[symbol].discard(websocket)
             if websocket in self.socket_subscriptions:
                 self.socket_subscriptions[websocket].discard(symbol)
+            if connection_id is not None:
+                self.broadcaster.unsubscribe(connection_id, symbol)
         logger.info(f"WebSocket unsubscribed from: {symbols}")
 
     async def broadcast_to_symbol(self, symbol: str, message: Dict[str, Any]):
         if symbol in self.active_connections:
             # Convert to JSON string once
             json_message = json.dumps(message)
+
+            if self.broadcaster:
+                # Enqueue by reference; only wake writers that were idle
+                message_type = message.get("type", "")
+                woken = self.broadcaster.publish(
+                    symbol, json_message, message_type, message_type not in EVENT_MESSAGE_TYPES
+                )
+                for connection_id in woken:
+                    event = self.writer_events.get(connection_id)
+                    if event:
+                        event.set()
+                return
+
             # Create tasks for all sends
             tasks = [
                 connection.send_text(json_message)
@@ -57,4 +108,22 @@ class WebSocketService:
             if tasks:
                 await asyncio.gather(*tasks, return_exceptions=True)
 
+    async def _writer(self, websocket: WebSocket, connection_id: int):
+        """Drain one connection's queue; waits only on its own socket"""
+        event = self.writer_events[connection_id]
+        try:
+            while True:
+                messages = self.broadcaster.drain(connection_id, 64)
+                if not messages:
+                    event.clear()
+                    await event.wait()
+                    continue
+                for json_message in messages:
+                    await websocket.send_text(json_message)
+        except asyncio.CancelledError:
+            pass
+        except Exception as e:
+            logger.warning(f"WebSocket writer stopped for {websocket.client}: {e}")
+            self.disconnect(websocket)
+
 ws_manager = WebSocketService()
@@ -0,0 +1,111 @@
+import asyncio
+from contextlib import asynccontextmanager
+
+from app.services import alert_service as module
+from app.services.alert_service import AlertService
+
+class FakeSession:
+    def __init__(self, executed):
+        self.executed = executed
+
+    async def execute(self, statement):
+        self.executed.append(statement)
+
+    async def commit(self):
+        pass
+
+class FakeMariaDB:
+    """Records the deactivation statements fired one-shot alerts issue"""
+
+    def __init__(self):
+        self.executed = []
+
+    @asynccontextmanager
+    async def get_session(self):
+        yield FakeSession(self.executed)
+
+def service(monkeypatch):
+    monkeypatch.setattr(module, "native", None)
+    monkeypatch.setattr(module, "mariadb_manager", FakeMariaDB())
+    alerts = AlertService()
+    assert alerts.engine is None
+    return alerts
+
+def bar(alerts, high, low=None, symbol="ES"):
+    return sorted(asyncio.run(alerts.process_bar(symbol, high, low if low is not None else high)))
+
+def test_levels_fire_inclusively_or_strictly(monkeypatch):
+    alerts = service(monkeypatch)
+    alerts._index_alert(1, "ES", {"operator": ">", "price": 100.0})
+    alerts._index_alert(2, "ES", {"operator": ">=", "price": 100.0})
+    alerts._index_alert(3, "ES", {"operator": "<", "price": 90.0})
+    alerts._index_alert(4, "ES", {"operator": "<=", "price": 90.0})
+    alerts._index_alert(5, "NQ", {"operator": ">", "price": 1.0})
+
+    assert bar(alerts, 95.0) == []
+    assert bar(alerts, 100.0) == [2]
+    assert bar(alerts, 100.25, 90.0) == [1, 4]
+    assert bar(alerts, 89.75) == [3]
+    # One-shot alerts are gone, deactivated with one statement per firing bar
+    assert bar(alerts, 200.0, 0.0) == []
+    assert len(module.mariadb_manager.executed) == 3
+    assert list(alerts._fallback_alerts["ES"]) == []
+
+def test_repeating_alerts_re_arm_once_price_moves_back(monkeypatch):
+    alerts = service(monkeypatch)
+    alerts._index_alert(1, "ES", {"operator": ">", "price": 100.0, "repeat": True})
+    alerts._index_alert(2, "ES", {"operator": "<=", "price": 90.0, "repeat": True})
+
+    assert bar(alerts, 101.0) == [1]
+    # Still above the level: no refire on every bar
+    assert bar(alerts, 102.0) == []
+    assert bar(alerts, 101.0, 100.5) == []
+    # Back to the level re-arms a strict ">" (its condition no longer holds)
+    assert bar(alerts, 100.0) == []
+    assert bar(alerts, 100.25) == [1]
+
+    assert bar(alerts, 90.0) == [2]
+    assert bar(alerts, 90.0) == []
+    # "<=" re-arms only strictly above its level
+    assert bar(alerts, 90.25) == []
+    assert bar(alerts, 89.0) == [2]
+    assert module.mariadb_manager.executed == []
+
+def test_removed_alerts_do_not_fire(monkeypatch):
+    alerts = service(monkeypatch)
+    alerts._index_alert(1, "ES", {"operator": ">", "price": 100.0, "repeat": True})
+    alerts._index_alert(2, "ES", {"operator": "above", "price": 100.0})
+    alerts._unindex_alert(1)
+    assert bar(alerts, 101.0) == []
+    assert 1 not in alerts._repeating
+
+class FakeRequest:
+    def __init__(self, body):
+        self._body = body
+
+    async def body(self):
+        return self._body
+
+class FakeMarketData:
+    async def store_batch(self, bars):
+        return len(bars)
+
+def test_batches_schedule_alerts_over_each_symbols_range():
+    import json
+    from fastapi import BackgroundTasks
+    from app.api.v1 import market_data
+
+    def bar(symbol, high, low, bar_type=None):
+        return {"timestamp": "2025-03-14 13:30:00", "high": high, "low": low,
+                "chart_info": {"symbol": symbol, "bar_type": bar_type}}
+
+    body = json.dumps({"metadata": {}, "data": [
+        bar("ES", 101.0, 99.0), bar("ES", 103.5, 100.0), bar("NQ", 20.0, 19.0),
+        bar("ES", 100.5, 97.25, "range8t")
+    ]}).encode()
+    tasks = BackgroundTasks()
+    result = asyncio.run(market_data.receive_batch(FakeRequest(body), tasks, "key", None, None, FakeMarketData()))
+
+    assert result["bars_stored"] == 4
+    scheduled = sorted((task.func.__name__, task.args) for task in tasks.tasks)
+    assert scheduled == [("process_bar", ("ES", 103.5, 97.25)), ("process_bar", ("NQ", 20.0, 19.0))]
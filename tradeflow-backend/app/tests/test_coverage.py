@@ -0,0 +1,33 @@
+from app.core.coverage import CorrectedRanges
+
+def test_marks_merge_when_touching():
+    ranges = CorrectedRanges()
+    ranges.add("ES", 10)
+    ranges.add("ES", 12)
+    ranges.add("ES", 11)
+    assert len(ranges) == 1
+    assert ranges.overlaps("ES", 10, 10)
+    assert ranges.overlaps("ES", 0, 10)
+    assert ranges.overlaps("ES", 12, 100)
+    assert not ranges.overlaps("ES", 13, 100)
+    assert not ranges.overlaps("ES", 0, 9)
+    assert not ranges.overlaps("NQ", 0, 100)
+
+def test_overlap_between_ranges():
+    ranges = CorrectedRanges()
+    ranges.add("ES", 100, 200)
+    ranges.add("ES", 500)
+    assert not ranges.overlaps("ES", 201, 499)
+    assert ranges.overlaps("ES", 150, 160)
+    assert ranges.overlaps("ES", 0, 1000)
+    assert ranges.overlaps("ES", 499, 501)
+
+def test_cap_joins_closest_ranges():
+    ranges = CorrectedRanges(max_ranges=2)
+    ranges.add("ES", 0)
+    ranges.add("ES", 100)
+    ranges.add("ES", 110)
+    assert len(ranges) == 2
+    # 100 and 110 were closest, so the gap between them is now marked
+    assert ranges.overlaps("ES", 105, 105)
+    assert not ranges.overlaps("ES", 1, 99)
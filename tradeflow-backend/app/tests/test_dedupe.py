@@ -0,0 +1,45 @@
+from app.core.dedupe import BatchDeduper, parse_seq_range
+
+def test_parse_seq_range():
+    assert parse_seq_range("1-25") == (1, 25)
+    assert parse_seq_range(" 7-7 ") == (7, 7)
+    for value in (None, "", "25", "5-3", "0-4", "-1-4", "1-x", "1 - 4", "1-4-5"):
+        assert parse_seq_range(value) is None, value
+
+def test_new_stream_is_stored_whole():
+    deduper = BatchDeduper(10)
+    assert deduper.check("ES:1:1700000000000", 1, 50) == 0
+
+def test_resend_is_dropped_and_overlap_trimmed():
+    deduper = BatchDeduper(10)
+    deduper.commit("s", 50)
+    assert deduper.check("s", 1, 50) is None
+    assert deduper.check("s", 20, 40) is None
+    assert deduper.check("s", 41, 60) == 10
+    assert deduper.check("s", 51, 60) == 0
+    stats = deduper.get_stats()
+    assert stats["duplicates"] == 2
+    assert stats["trimmed_bars"] == 10
+
+def test_mark_only_moves_forward():
+    deduper = BatchDeduper(10)
+    deduper.commit("s", 50)
+    deduper.commit("s", 30)
+    assert deduper.check("s", 31, 50) is None
+
+def test_check_alone_does_not_mark():
+    # Only a successful write commits; a failed one is accepted again on retry
+    deduper = BatchDeduper(10)
+    assert deduper.check("s", 1, 10) == 0
+    assert deduper.check("s", 1, 10) == 0
+
+def test_least_recently_used_stream_is_forgotten():
+    deduper = BatchDeduper(2)
+    deduper.commit("a", 10)
+    deduper.commit("b", 10)
+    assert deduper.check("a", 1, 10) is None    # a is now the most recent
+    deduper.commit("c", 10)
+    assert deduper.get_stats()["streams"] == 2
+    assert deduper.check("b", 1, 10) == 0       # Forgotten: taken whole again
+    assert deduper.check("a", 1, 10) is None
+    assert deduper.check("c", 1, 10) is None
@@ -0,0 +1,81 @@
+import math
+from datetime import datetime, timedelta, timezone
+
+import numpy as np
+import pytest
+
+from app.core import downsample
+from app.core.downsample import bars_to_columns, columns_to_bars, downsample_bar_columns, downsample_line
+
+START = datetime(2024, 1, 2, 14, 30, tzinfo=timezone.utc)
+NAN = math.nan
+
+@pytest.fixture
+def python_path(monkeypatch):
+    """Run the numpy fallbacks even where the extension is built"""
+    monkeypatch.setattr(downsample, "native", None)
+
+def bars(count):
+    # get_bars order: newest first; bar i has open i, high i + 1, low i - 1, close i + 0.5
+    return [{
+        "time": START + timedelta(minutes=i), "open": float(i), "high": i + 1.0, "low": i - 1.0,
+        "close": i + 0.5, "volume": 10.0, "number_of_trades": 2, "delta": None if i % 2 else 1.0,
+        "cvd": float(i), "open_interest": None,
+    } for i in reversed(range(count))]
+
+@pytest.mark.parametrize("kind,expected", [
+    ("first", [1.0, NAN, 5.0]),
+    ("last", [2.0, 4.0, 5.0]),
+    ("max", [2.0, 4.0, 5.0]),
+    ("min", [1.0, 4.0, 5.0]),
+    ("sum", [3.0, 4.0, 5.0]),
+])
+def test_bucket_reduce_fallback(python_path, kind, expected):
+    values = np.array([1.0, 2.0, NAN, 4.0, 5.0])
+    np.testing.assert_array_equal(downsample._bucket_reduce(values, 2, kind), expected)
+
+def test_bucket_reduce_all_missing_bucket_stays_missing(python_path):
+    values = np.array([NAN, NAN, 1.0])
+    for kind in ("max", "min", "sum"):
+        assert math.isnan(downsample._bucket_reduce(values, 2, kind)[0]), kind
+
+def test_bar_columns_merge_like_a_higher_timeframe(python_path):
+    columns = downsample_bar_columns(bars_to_columns(bars(10)), 3)
+    # ceil(10 / 3) = 4 bars per bucket: [0-3], [4-7], [8-9]
+    rows = columns_to_bars("ES", "1m", columns)
+    assert [row["time"] for row in rows] == [START + timedelta(minutes=m) for m in (8, 4, 0)]
+    oldest = rows[-1]
+    assert (oldest["open"], oldest["high"], oldest["low"], oldest["close"]) == (0.0, 4.0, -1.0, 3.5)
+    assert oldest["volume"] == 40.0
+    assert oldest["number_of_trades"] == 8 and isinstance(oldest["number_of_trades"], int)
+    assert oldest["delta"] == 2.0       # Missing deltas do not count
+    assert oldest["cvd"] == 3.0         # Running values keep the newest
+    assert oldest["open_interest"] is None
+    assert rows[0]["close"] == 9.5
+
+def test_bar_columns_under_the_limit_are_untouched(python_path):
+    columns = bars_to_columns(bars(5))
+    assert downsample_bar_columns(columns, 5) is columns
+    assert downsample_bar_columns(columns, 0) is columns
+    assert columns_to_bars("ES", "1m", columns) == [
+        {**bar, "symbol": "ES", "timeframe": "1m"} for bar in bars(5)
+    ]
+
+def test_empty_bars():
+    assert columns_to_bars("ES", "1m", bars_to_columns([])) == []
+
+def test_line_fallback_keeps_evenly_spaced_points_and_the_ends(python_path):
+    x = np.arange(100, dtype=np.float64)
+    kept = downsample_line(x, np.sin(x), 10)
+    assert kept[0] == 0 and kept[-1] == 99
+    assert len(kept) == 10
+    assert np.all(np.diff(kept) > 0)
+    np.testing.assert_array_equal(downsample_line(x[:5], x[:5], 10), np.arange(5))
+
+@pytest.mark.skipif(downsample.native is None, reason="tradeflow_native not built")
+def test_native_bucket_reduce_matches_fallback(monkeypatch):
+    values = np.array([1.0, 2.0, NAN, 4.0, 5.0, NAN, NAN])
+    native_results = {kind: downsample._bucket_reduce(values, 2, kind) for kind in ("first", "last", "max", "min", "sum")}
+    monkeypatch.setattr(downsample, "native", None)
+    for kind, result in native_results.items():
+        np.testing.assert_array_equal(result, downsample._bucket_reduce(values, 2, kind), err_msg=kind)
@@ -0,0 +1,78 @@
+import asyncio
+from datetime import datetime, timedelta, timezone
+
+from app.core import caching
+from app.core.native import to_micros
+from app.services.market_data_service import market_data_service
+
+START = datetime(2024, 1, 2, 14, 30, tzinfo=timezone.utc)
+
+def bar(minute, close):
+    return {"time": START + timedelta(minutes=minute), "close": close}
+
+# A cached "newest 4" result, newest first
+CACHED = [bar(3, 3.0), bar(2, 2.0), bar(1, 1.0), bar(0, 0.0)]
+
+def fake_reads(monkeypatch, fresh):
+    calls = []
+
+    async def get_bars_uncached(symbol, timeframe, limit, since=None):
+        calls.append(since)
+        return [row for row in fresh if since is None or row["time"] >= since]
+
+    monkeypatch.setattr(market_data_service, "_get_bars_uncached", get_bars_uncached)
+    return calls
+
+def extend(cached, changed_from, limit=4):
+    return asyncio.run(market_data_service._extend_bars("ES", "1m", limit, cached, changed_from))
+
+def test_forming_bar_update_rereads_only_the_newest_bar(monkeypatch):
+    calls = fake_reads(monkeypatch, [bar(3, 3.5), bar(2, 99.0)])
+    result = extend(CACHED, to_micros(START + timedelta(minutes=3)))
+    assert calls == [START + timedelta(minutes=3)]
+    assert result == [bar(3, 3.5), bar(2, 2.0), bar(1, 1.0), bar(0, 0.0)]
+
+def test_appended_bars_push_the_oldest_out(monkeypatch):
+    fake_reads(monkeypatch, [bar(5, 5.0), bar(4, 4.0), bar(3, 3.0)])
+    result = extend(CACHED, to_micros(START + timedelta(minutes=4)))
+    assert result == [bar(5, 5.0), bar(4, 4.0), bar(3, 3.0), bar(2, 2.0)]
+
+def test_change_before_the_newest_bar_recomputes(monkeypatch):
+    calls = fake_reads(monkeypatch, [])
+    assert extend(CACHED, to_micros(START + timedelta(minutes=2))) is None
+    assert extend([], to_micros(START)) is None
+    assert calls == []
+
+def test_naive_cached_times(monkeypatch):
+    # SQL rows come back naive (UTC); the change time comparison still holds
+    naive = [{**row, "time": row["time"].replace(tzinfo=None)} for row in CACHED]
+    fake_reads(monkeypatch, [{"time": naive[0]["time"], "close": 3.5}])
+    result = extend(naive, to_micros(START + timedelta(minutes=3)))
+    assert [row["close"] for row in result] == [3.5, 2.0, 1.0, 0.0]
+
+class FakeReadCache:
+    """Stand-in for tradeflow_native.ReadCache holding one stale entry"""
+
+    def __init__(self, entry, changed_from):
+        self.entry = entry
+        self.changed_from = changed_from
+        self.stored = None
+
+    def version(self, stream):
+        return 7
+
+    def lookup(self, key):
+        return (self.entry, False, self.changed_from) if self.entry is not None else None
+
+    def put(self, key, stream, version, payload, cost):
+        self.stored = (key, version, payload, cost)
+
+def test_get_bars_extends_a_stale_cache_entry(monkeypatch):
+    cache = FakeReadCache(CACHED, to_micros(START + timedelta(minutes=4)))
+    monkeypatch.setattr(caching, "read_cache", cache)
+    calls = fake_reads(monkeypatch, [bar(4, 4.0), bar(3, 3.0)])
+
+    result = asyncio.run(market_data_service.get_bars("ES", "1m", 4))
+    assert calls == [START + timedelta(minutes=3)]
+    assert result == [bar(4, 4.0), bar(3, 3.0), bar(2, 2.0), bar(1, 1.0)]
+    assert cache.stored == ("bars:ES:1m:4", 7, result, 4)
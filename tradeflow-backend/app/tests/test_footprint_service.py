@@ -0,0 +1,122 @@
+import asyncio
+from datetime import datetime, timedelta, timezone
+
+from app.services import footprint_service as module
+from app.services import market_data_service as market_module
+from app.services.footprint_service import FootprintService
+
+class FakeFootprintStore:
+    """
+    Pure-Python stand-in for tradeflow_native.FootprintStore (native/footprint.h)
+    with the binding's results: query is newest bar first, highest price
+    first, like the SQL path. Eviction into the archive is left out; the
+    ring starts at ring_start to model it.
+    """
+
+    def __init__(self, tick_size, timeframes, ring_bars, archive_bars):
+        self.tick_size = tick_size
+        self.timeframes = timeframes
+        self.series = {}
+        self.ring_start = {}
+
+    def add(self, symbol, time, price, volume, bid_volume, ask_volume):
+        tick = round(price / self.tick_size)
+        for seconds in self.timeframes:
+            width = seconds * 1_000_000
+            bucket = time - time % width
+            bars = self.series.setdefault((symbol, seconds), {})
+            if not bars:
+                self.ring_start[(symbol, seconds)] = bucket if bucket == time else bucket + width
+            level = bars.setdefault(bucket, {}).setdefault(tick, [0.0, 0.0, 0.0])
+            level[0] += volume
+            level[1] += bid_volume
+            level[2] += ask_volume
+        return True
+
+    def covered_from(self, symbol, seconds):
+        return self.ring_start.get((symbol, seconds))
+
+    def query(self, symbol, seconds, start, end):
+        width = seconds * 1_000_000
+        first = start - start % width
+        bars = self.series.get((symbol, seconds), {})
+        return [
+            (bucket, [{"price": tick * self.tick_size, "volume": v, "bid_volume": b, "ask_volume": a}
+                      for tick, (v, b, a) in sorted(bars[bucket].items(), reverse=True)])
+            for bucket in sorted(bars, reverse=True) if first <= bucket <= end
+        ]
+
+class FakeNative:
+    FootprintStore = FakeFootprintStore
+
+START = datetime(2024, 1, 2, 14, 30, tzinfo=timezone.utc)
+
+# 1s bars: (second, close, volume, bid, ask)
+BARS = [(0, 100.25, 5, 2, 3), (10, 100.5, 4, 4, 0), (30, 100.25, 1, 0, 1), (59, 99.75, 2, 1, 1),
+        (60, 101.0, 7, 3, 4), (90, 100.75, 3, 1, 2), (150, 100.75, 1, 1, 0)]
+
+def service(monkeypatch):
+    monkeypatch.setattr(module, "native", FakeNative)
+    footprint = FootprintService()
+    for second, close, volume, bid, ask in BARS:
+        footprint.on_bar("ES", START + timedelta(seconds=second), close, volume, bid, ask)
+    return footprint
+
+def sql_rows(interval, start_time, end_time):
+    """What the SQL path's query returns for BARS: by bucket, then price, both descending"""
+    width = interval.total_seconds()
+    sums = {}
+    for second, close, volume, bid, ask in BARS:
+        time = START + timedelta(seconds=second)
+        if not start_time <= time <= end_time:
+            continue
+        bucket = START + timedelta(seconds=second - second % width)
+        level = sums.setdefault((bucket, round(close, 2)), [0.0, 0.0, 0.0])
+        for i, value in enumerate((volume, bid, ask)):
+            level[i] += value
+    return [{"bucket": bucket, "price": price, "volume": v, "bid_volume": b, "ask_volume": a}
+            for (bucket, price), (v, b, a) in sorted(sums.items(), reverse=True)]
+
+def test_memory_matches_the_sql_shape_and_order(monkeypatch):
+    footprint = service(monkeypatch)
+    end = START + timedelta(minutes=5)
+    memory = footprint.get_footprint("ES", "1m", START, end)
+    assert [bar["time"] for bar in memory] == [
+        (START + timedelta(minutes=2)).isoformat(), (START + timedelta(minutes=1)).isoformat(), START.isoformat()]
+    assert [level["price"] for level in memory[2]["levels"]] == [100.5, 100.25, 99.75]
+    assert memory[2]["levels"][1] == {"price": 100.25, "volume": 6.0, "bid_volume": 2.0, "ask_volume": 4.0}
+
+    async def fetch(query, interval, symbol, start_time, end_time):
+        return sql_rows(interval, start_time, end_time)
+
+    # The SQL path, forced by a timeframe the store does not keep
+    monkeypatch.setattr(market_module.timescale_manager, "fetch", fetch)
+    monkeypatch.setattr(footprint, "timeframes", [])
+    monkeypatch.setattr(market_module, "footprint_service", footprint)
+    sql = asyncio.run(market_module.market_data_service.get_footprint_data("ES", "1m", START, end))
+    assert sql == memory
+
+def test_ranges_before_coverage_go_to_sql(monkeypatch):
+    monkeypatch.setattr(module, "native", FakeNative)
+    footprint = FootprintService()
+    # Starts mid-bucket: that minute is incomplete in memory
+    footprint.on_bar("ES", START + timedelta(seconds=20), 100.0, 1, 0, 1)
+    footprint.on_bar("ES", START + timedelta(seconds=70), 100.0, 1, 0, 1)
+    assert footprint.get_footprint("ES", "1m", START, START + timedelta(minutes=2)) is None
+    assert footprint.get_footprint("ES", "1m", START + timedelta(minutes=1), START + timedelta(minutes=2)) is not None
+    assert footprint.get_footprint("NQ", "1m", START, START + timedelta(minutes=2)) is None
+    assert footprint.get_footprint("ES", "1d", START, START + timedelta(minutes=2)) is None
+
+def test_late_bars_send_their_buckets_to_sql(monkeypatch):
+    footprint = service(monkeypatch)
+    footprint.on_bar("ES", START + timedelta(seconds=150), 100.75, 1, 1, 0)   # Resend: ignored
+    assert footprint.get_footprint("ES", "1m", START, START + timedelta(minutes=5)) is not None
+
+    footprint.on_bar("ES", START + timedelta(seconds=75), 100.0, 9, 9, 0)     # Late: not added
+    assert footprint.get_footprint("ES", "1m", START, START + timedelta(minutes=5)) is None
+    assert footprint.get_footprint("ES", "5m", START, START + timedelta(minutes=5)) is None
+    # Other buckets are still served from memory, without the late volume
+    later = footprint.get_footprint("ES", "1m", START + timedelta(minutes=2), START + timedelta(minutes=5))
+    assert [level["volume"] for level in later[0]["levels"]] == [1.0]
+    early = footprint.get_footprint("ES", "1m", START, START + timedelta(seconds=59))
+    assert len(early) == 1 and early[0]["time"] == START.isoformat()
@@ -0,0 +1,46 @@
+import asyncio
+from collections import deque
+from datetime import datetime, timezone
+
+from app.services.heatmap_service import HeatmapService
+
+def tile(second: int, cells: str = "AB") -> list:
+    return [f"2024-03-01 14:30:{second:02d}.000", 1, 0.25, 5000.0, 10.0, cells]
+
+def load(service: HeatmapService, tiles: list):
+    rows = [service._parse(t) for t in tiles]
+    stream = service._tiles.setdefault(("ES", 1), deque(maxlen=4))
+    for row in rows:
+        service._insert(stream, row)
+    return stream
+
+def test_parsed_times_are_aware_utc():
+    parsed = HeatmapService._parse(tile(5))
+    assert parsed[0] == datetime(2024, 3, 1, 14, 30, 5, tzinfo=timezone.utc)
+    parsed = HeatmapService._parse(["2024-03-01T09:30:05-05:00", 1, 0.25, 5000.0, 10.0, "AB"])
+    assert parsed[0] == datetime(2024, 3, 1, 14, 30, 5, tzinfo=timezone.utc)
+
+def test_older_tiles_fill_the_window_in_order():
+    service = HeatmapService()
+    stream = load(service, [tile(1), tile(4), tile(2), tile(3), tile(3, "CD")])
+    assert [row[0].second for row in stream] == [1, 2, 3, 4]
+    assert stream[2][5] == "CD"
+
+    # Full window: a tile older than everything held is dropped, one inside
+    # it pushes the oldest out
+    load(service, [tile(0)])
+    assert [row[0].second for row in stream] == [1, 2, 3, 4]
+    load(service, [tile(6), tile(5)])
+    assert [row[0].second for row in stream] == [3, 4, 5, 6]
+
+def test_get_tiles_accepts_aware_and_naive_bounds():
+    service = HeatmapService()
+    load(service, [tile(1), tile(2), tile(3)])
+
+    aware = asyncio.run(service.get_tiles(
+        "ES", 1, datetime.fromisoformat("2024-03-01T14:30:02+00:00"),
+        datetime.fromisoformat("2024-03-01T09:30:03-05:00")))
+    naive = asyncio.run(service.get_tiles("ES", 1, datetime(2024, 3, 1, 14, 30, 2), datetime(2024, 3, 1, 14, 30, 3)))
+    assert [t["time"] for t in aware] == [t["time"] for t in naive] == [
+        "2024-03-01T14:30:02+00:00", "2024-03-01T14:30:03+00:00"
+    ]
@@ -0,0 +1,83 @@
+from datetime import datetime, timedelta, timezone
+
+import numpy as np
+
+from app.services import indicator_service as module
+from app.services.indicator_service import IndicatorService
+
+class FakeStream:
+    """Stands in for tradeflow_native.IndicatorStream: keeps the closes it was fed"""
+
+    def __init__(self, kind, params, capacity):
+        self.times, self.closes = [], []
+
+    def update_many(self, times, highs, lows, closes):
+        self.times += times.tolist()
+        self.closes += closes.tolist()
+
+    def update(self, time, high, low, close):
+        self.times.append(time)
+        self.closes.append(close)
+
+    @property
+    def size(self):
+        return len(self.closes)
+
+    def tail(self, n):
+        return np.array(self.times[-n:], dtype=np.int64), np.array(self.closes[-n:]).reshape(-1, 1)
+
+class FakeNative:
+    IndicatorStream = FakeStream
+
+def bars(count):
+    start = datetime(2024, 1, 2, tzinfo=timezone.utc)
+    # get_bars order: newest first
+    return [{"time": start + timedelta(minutes=i), "high": i + 1.0, "low": i - 1.0, "close": float(i)}
+            for i in reversed(range(count))]
+
+def test_warm_streams_are_capped_least_recently_requested_first(monkeypatch):
+    monkeypatch.setattr(module, "native", FakeNative)
+    service = IndicatorService(max_streams=2)
+
+    service.compute_series("sma", (3,), "ES", "1m", bars(5), 10, keep_warm=True)
+    service.compute_series("sma", (3,), "NQ", "1m", bars(5), 10, keep_warm=True)
+    # Requesting ES makes NQ the least recently requested
+    assert service.get_warm_series("sma", (3,), "ES", "1m", 5) is not None
+    service.compute_series("ema", (3,), "ES", "1m", bars(5), 10, keep_warm=True)
+
+    assert service.get_warm_series("sma", (3,), "NQ", "1m", 5) is None
+    assert service.get_warm_series("sma", (3,), "ES", "1m", 5) is not None
+    assert service.get_warm_series("ema", (3,), "ES", "1m", 5) is not None
+    assert ("NQ", "1m") not in service._streams
+    assert service.evicted_streams == 1
+
+    # Ingest still feeds the streams that were kept
+    service.on_bar("ES", "1m", datetime(2024, 1, 2, 0, 5, tzinfo=timezone.utc), 6.0, 4.0, 5.0)
+    assert service.get_warm_series("sma", (3,), "ES", "1m", 1)[0]["value"] == 5.0
+    service.on_bar("NQ", "1m", datetime(2024, 1, 2, 0, 5, tzinfo=timezone.utc), 6.0, 4.0, 5.0)
+
+def test_reseeding_a_stream_does_not_count_twice(monkeypatch):
+    monkeypatch.setattr(module, "native", FakeNative)
+    service = IndicatorService(max_streams=2)
+    for _ in range(3):
+        service.compute_series("sma", (3,), "ES", "1m", bars(5), 10, keep_warm=True)
+    service.compute_series("sma", (3,), "NQ", "1m", bars(5), 10, keep_warm=True)
+    assert service.evicted_streams == 0
+    assert len(service._recent) == 2
+
+def test_warm_streams_return_nothing_before_a_full_period(monkeypatch):
+    service = IndicatorService()
+    # The calculate_* contract: fewer bars than the period is no series at all
+    assert service.compute_series("sma", (10,), "ES", "1m", bars(5), 10) == []
+    assert service.compute_series("macd", (3, 8, 3), "ES", "1m", bars(5), 10) == []
+
+    monkeypatch.setattr(module, "native", FakeNative)
+    assert service.compute_series("sma", (10,), "ES", "1m", bars(5), 10, keep_warm=True) == []
+    assert service.get_warm_series("sma", (10,), "ES", "1m", 10) == []
+    assert service.compute_series("macd", (3, 8, 3), "ES", "1m", bars(5), 10, keep_warm=True) == []
+
+    # The stream stays warm and starts answering once ingest fills the period
+    for minute in range(5, 10):
+        service.on_bar("ES", "1m", datetime(2024, 1, 2, 0, minute, tzinfo=timezone.utc), 0.0, 0.0, float(minute))
+    series = service.get_warm_series("sma", (10,), "ES", "1m", 10)
+    assert [row["value"] for row in series] == [float(i) for i in range(10)]
@@ -0,0 +1,117 @@
+import asyncio
+from datetime import datetime, timedelta, timezone
+
+from app.services import market_data_service as module
+from app.services.market_data_service import MarketDataService
+
+START = datetime(2024, 1, 2, 14, 30, tzinfo=timezone.utc)
+
+class FakeConnection:
+    """
+    market_data as a dict keyed like its primary key. fetch applies the
+    set-based insert the way PostgreSQL does: one row per array position,
+    conflicts skipped or replaced, RETURNING for every row written.
+    """
+
+    def __init__(self, stored):
+        self.stored = stored
+        self.statements = []
+
+    async def fetch(self, query, *columns):
+        self.statements.append(query)
+        assert "unnest(" in query and "RETURNING time, symbol, timeframe, (xmax = 0)" in query
+        assert len(columns) == 18 and len({len(column) for column in columns}) == 1
+        returned = []
+        written = set()
+        for row in zip(*columns):
+            key = (row[0], row[1], row[2])
+            assert key not in written, "ON CONFLICT cannot affect a row twice in one statement"
+            written.add(key)
+            if key in self.stored and "DO NOTHING" in query:
+                continue
+            returned.append({"time": row[0], "symbol": row[1], "timeframe": row[2], "inserted": key not in self.stored})
+            self.stored[key] = row
+        return returned
+
+    async def executemany(self, query, rows):
+        self.statements.append(query)
+        for row in rows:
+            self.stored.setdefault((row[0], row[1], row[2]), row)
+
+class FakePool:
+    def __init__(self, connection):
+        self.connection = connection
+
+    def acquire(self):
+        pool = self
+
+        class Acquire:
+            async def __aenter__(self):
+                return pool.connection
+
+            async def __aexit__(self, *exc):
+                return False
+
+        return Acquire()
+
+def bar(second, close=100.0, timeframe="1s"):
+    return (START + timedelta(seconds=second), "ES", timeframe, close, close, close, close,
+            1.0, 0.0, 1.0, 1, None, 1.0, None, None, None, None, None)
+
+def service(monkeypatch, stored_seconds, newest_second):
+    stored = {(row[0], row[1], row[2]): row for row in map(bar, stored_seconds)}
+    connection = FakeConnection(stored)
+    monkeypatch.setattr(module.timescale_manager, "pool", FakePool(connection))
+
+    catalog = []
+    corrections = []
+    newest = START + timedelta(seconds=newest_second)
+    monkeypatch.setattr(module.catalog_service, "is_backfill", lambda symbol, timeframe, timestamp: timestamp < newest)
+    monkeypatch.setattr(module.catalog_service, "on_bar",
+                        lambda symbol, timeframe, timestamp, high, low, volume, inserted=False: catalog.append((timestamp, inserted)))
+    # Every backfilled bar is older than what the rollups have taken
+    monkeypatch.setattr(module.reorder_service, "push", lambda symbol, timeframe, timestamp, row: timestamp >= newest)
+    monkeypatch.setattr(module, "bump_stream", lambda symbol, timestamp: None)
+
+    market_data = MarketDataService()
+    monkeypatch.setattr(market_data, "_apply_corrections", lambda rows: corrections.extend(row[0] for row in rows))
+
+    async def release_reordered(flush=False):
+        return 0
+
+    monkeypatch.setattr(market_data, "release_reordered", release_reordered)
+    return market_data, connection, catalog, corrections
+
+def test_backfill_is_one_statement_and_reports_new_rows(monkeypatch):
+    market_data, connection, catalog, corrections = service(monkeypatch, stored_seconds=[1, 3], newest_second=10)
+    rows = [bar(0), bar(1, close=99.0), bar(2), bar(3), bar(2, close=98.0), bar(12)]
+
+    asyncio.run(market_data._ingest(rows, replace=False))
+
+    # One set-based write for the five backfill rows, one for the live bar
+    assert len(connection.statements) == 2
+    # The stored rows are kept; a key repeated in the request is written once
+    assert connection.stored[(START + timedelta(seconds=1), "ES", "1s")][3] == 100.0
+    assert connection.stored[(START + timedelta(seconds=2), "ES", "1s")][3] == 100.0
+    assert sorted(catalog) == [(START, True), (START + timedelta(seconds=2), True), (START + timedelta(seconds=12), False)]
+    # Only rows that changed market_data mark a correction
+    assert sorted(corrections) == [START, START + timedelta(seconds=2)]
+
+def test_reporting_matches_per_row_semantics(monkeypatch):
+    market_data, connection, catalog, corrections = service(monkeypatch, stored_seconds=[1], newest_second=10)
+    rows = [bar(1), bar(0), bar(0, close=101.0)]
+    keep = asyncio.run(market_data._write_rows_reporting(rows, module.ON_CONFLICT_KEEP))
+    assert keep == [False, True, False]
+
+    market_data, connection, catalog, corrections = service(monkeypatch, stored_seconds=[1], newest_second=10)
+    replace = asyncio.run(market_data._write_rows_reporting(rows, module.ON_CONFLICT_REPLACE))
+    # The last row of a repeated key is the one written
+    assert replace == [False, False, True]
+    assert connection.stored[(START, "ES", "1s")][3] == 101.0
+
+def test_a_replaced_late_bar_is_still_a_correction(monkeypatch):
+    market_data, connection, catalog, corrections = service(monkeypatch, stored_seconds=[4], newest_second=10)
+    asyncio.run(market_data._ingest([bar(4, close=97.0)], replace=True))
+    assert connection.stored[(START + timedelta(seconds=4), "ES", "1s")][3] == 97.0
+    assert corrections == [START + timedelta(seconds=4)]
+    assert catalog == []
@@ -0,0 +1,28 @@
+import pathlib
+import shutil
+import subprocess
+
+import pytest
+
+# Header-only engines under native/ are tested by standalone C++ programs in
+# native/tests/ (one per engine, exit status 0 on success); this builds and
+# runs each of them with sanitizers so `pytest` covers them without the
+# Python extension. native/tests is on the include path for the collector
+# tests, which build the collector source against its sierrachart.h stand-in.
+BACKEND = pathlib.Path(__file__).resolve().parents[2]
+NATIVE_TESTS = sorted((BACKEND / "native" / "tests").glob("*_test.cpp"))
+COMPILER = shutil.which("c++") or shutil.which("g++") or shutil.which("clang++")
+
+@pytest.mark.skipif(COMPILER is None, reason="no C++ compiler")
+@pytest.mark.parametrize("source", NATIVE_TESTS, ids=lambda path: path.stem)
+def test_native_engine(source, tmp_path):
+    binary = tmp_path / source.stem
+    command = [COMPILER, "-O1", "-g", "-std=c++17", f"-I{BACKEND / 'native' / 'tests'}", f"-I{BACKEND / 'native'}", f"-I{BACKEND}", str(source), "-o", str(binary), "-lpthread"]
+    build = subprocess.run(command[:1] + ["-fsanitize=address,undefined"] + command[1:], capture_output=True, text=True)
+    if build.returncode != 0:
+        # Toolchains without sanitizer runtimes still run the checks
+        build = subprocess.run(command, capture_output=True, text=True)
+    assert build.returncode == 0, build.stderr
+
+    run = subprocess.run([str(binary)], capture_output=True, text=True, timeout=300)
+    assert run.returncode == 0, run.stdout + run.stderr
@@ -0,0 +1,91 @@
+import pytest
+
+# Import smoke test for the built extension (native/README.md): every bound
+# class is constructed with the arguments its service passes, so a signature or
+# py::arg mismatch in bindings.cpp fails here rather than at service startup.
+native = pytest.importorskip("tradeflow_native")
+np = pytest.importorskip("numpy")
+
+def test_indicator_states():
+    for state in (native.SMA(3), native.EMA(3), native.RSI(3), native.Bollinger(3, 2.0)):
+        for close in (1.0, 2.0, 3.0, 4.0):
+            state.update(close)
+        assert state.ready
+    macd = native.MACD(3, 6, 2)
+    assert len(macd.update(1.0)) == 3
+    atr = native.ATR(3)
+    atr.update(2.0, 1.0, 1.5)
+    assert not atr.ready
+
+def test_batch_kernels():
+    closes = np.arange(1.0, 21.0)
+    assert len(native.sma(closes, 5)) == 20
+    assert len(native.ema(closes, 5)) == 20
+    assert len(native.rsi(closes, 5)) == 20
+    assert len(native.macd(closes, 3, 6, 2)) == 3
+    assert len(native.bollinger(closes, 5, 2.0)) == 3
+    assert len(native.atr(closes + 1, closes - 1, closes, 5)) == 20
+
+def test_indicator_stream():
+    stream = native.IndicatorStream("sma", [3.0], 10)
+    assert stream.update(1_000_000, 2.0, 1.0, 1.5)
+    times, values = stream.tail(5)
+    assert len(times) == 1 and values.shape == (1, stream.width)
+
+def test_engines_construct():
+    broadcaster = native.Broadcaster(8)
+    connection = broadcaster.add_connection()
+    broadcaster.subscribe(connection, "ES")
+    assert broadcaster.publish("ES", "tick", "tick", True) == [connection]
+    broadcaster.publish("ES", "event", "large_trades", False)
+    assert broadcaster.drain(connection) == ["tick", "event"]
+    assert broadcaster.stats()["dropped"] == 0
+
+    alerts = native.AlertEngine()
+    alerts.upsert(1, "ES", ">=", 100.0)
+    assert len(alerts) == 1
+
+    footprint = native.FootprintStore(0.25, [60, 300], 100, 1000)
+    footprint.add("ES", 0, 100.0, 5.0, 2.0, 3.0)
+    footprint.add("ES", 1_000_000, 100.5, 1.0, 1.0, 0.0)
+    footprint.add("ES", 60_000_000, 99.0, 2.0, 0.0, 2.0)
+    assert isinstance(footprint.stats(), dict)
+    assert footprint.covered_from("ES", 60) == 0
+    # Newest bar first, highest price first, like the SQL path
+    bars = footprint.query("ES", 60, 0, 120_000_000)
+    assert [time for time, _ in bars] == [60_000_000, 0]
+    assert [level["price"] for level in bars[1][1]] == [100.5, 100.0]
+    assert bars[1][1][1] == {"price": 100.0, "volume": 5.0, "bid_volume": 2.0, "ask_volume": 3.0}
+
+    cache = native.ReadCache(1024)
+    assert cache.lookup("missing") is None
+
+    reorder = native.ReorderBuffer(2_000_000, 100, 10)
+    assert reorder.push("ES|1s", 1_000_000, {"time": 1}, 0, 1_000_000) == 0
+    reorder.flush()
+    assert [bar[1] for bar in reorder.drain()] == [1_000_000]
+
+    calendar = native.SessionCalendar(0, 86400)
+    engine = native.TPOEngine(0.25, 1800, 0, 86400, 2, 0.70)
+    engine.set_calendar(calendar)
+    engine.add("ES", 1_000_000, 101.0, 100.0)
+    assert isinstance(calendar.stats(), dict) and isinstance(engine.stats(), dict)
+
+    catalog = native.StreamCatalog()
+    catalog.add("ES", "1s", 1_000_000, 101.0, 100.0, 5.0)
+    assert not catalog.is_backfill("ES", "1s", 2_000_000)
+
+    pyramid = native.BarPyramid(4, 64)
+    assert pyramid.levels == 4
+
+def test_bar_store(tmp_path):
+    store = native.BarStore(str(tmp_path), 0, "1s", [("1m", 60)])
+    store.append("ES", "1s", 1_000_000, 1.0, 2.0, 0.5, 1.5, 10.0)
+    assert store.count("ES", "1s") == 1
+
+def test_downsample():
+    values = np.arange(10.0)
+    assert native.bucket_size_for(10, 5) >= 2
+    assert len(native.bucket_reduce(values, 2, "max")) == 5
+    assert len(native.lttb(values, values, 4)) == 4
+    assert len(native.minmax_points(values, 4)) <= 4
@@ -0,0 +1,104 @@
+from datetime import datetime, timedelta, timezone
+
+from app.config import settings
+from app.services import reorder_service as module
+from app.services.reorder_service import ReorderService
+
+class FakeReorderBuffer:
+    """
+    Pure-Python stand-in for tradeflow_native.ReorderBuffer (native/reorder.h)
+    with the same call signatures and results, so the service runs without
+    the extension. The bounds are left out.
+    """
+
+    def __init__(self, max_hold, max_bars_per_stream, max_streams):
+        self.max_hold = max_hold
+        self.streams = {}
+        self.ready = []
+
+    def push(self, stream, time, payload, lateness, now):
+        state = self.streams.setdefault(stream, {"bars": {}, "newest": None, "released": None, "last_push": now})
+        state["last_push"] = now
+        if state["released"] is not None and time <= state["released"]:
+            return 2
+        replaced = time in state["bars"]
+        state["bars"][time] = payload
+        if state["newest"] is None or time > state["newest"]:
+            state["newest"] = time
+        self._release(stream, state, state["newest"] - lateness)
+        return 1 if replaced else 0
+
+    def expire(self, now):
+        for stream, state in self.streams.items():
+            if now - state["last_push"] >= self.max_hold:
+                self._release(stream, state, None)
+
+    def flush(self):
+        for stream, state in self.streams.items():
+            self._release(stream, state, None)
+
+    def drain(self):
+        ready, self.ready = self.ready, []
+        return ready
+
+    def stats(self):
+        return {"buffered": sum(len(state["bars"]) for state in self.streams.values())}
+
+    def _release(self, stream, state, watermark):
+        for time in sorted(state["bars"]):
+            if watermark is not None and time > watermark:
+                break
+            self.ready.append((stream, time, state["bars"].pop(time)))
+            state["released"] = time
+
+class FakeNative:
+    ReorderBuffer = FakeReorderBuffer
+
+START = datetime(2024, 1, 2, 14, 30, tzinfo=timezone.utc)
+
+def service(monkeypatch, lateness_bars=3):
+    monkeypatch.setattr(module, "native", FakeNative)
+    monkeypatch.setattr(settings, "INGEST_REORDER_LATENESS_BARS", lateness_bars)
+    monkeypatch.setattr(settings, "INGEST_REORDER_MIN_LATENESS_MS", 2000)
+    return ReorderService()
+
+def push(reorder, second, symbol="ES", timeframe="1s"):
+    return reorder.push(symbol, timeframe, START + timedelta(seconds=second), {"symbol": symbol, "second": second})
+
+def test_lateness_is_bars_of_the_timeframe_with_a_floor(monkeypatch):
+    reorder = service(monkeypatch)
+    assert reorder.lateness_micros("1s") == 3_000_000
+    assert reorder.lateness_micros("1m") == 180_000_000
+    assert reorder.lateness_micros("range_4") == 2_000_000
+
+def test_shuffled_bars_are_released_in_order(monkeypatch):
+    reorder = service(monkeypatch)
+    for second in (0, 2, 1, 5, 3, 4, 9):
+        assert push(reorder, second)
+    # Watermark 9 - 3: everything through 6 is released, sorted
+    assert [row["second"] for row in reorder.drain()] == [0, 1, 2, 3, 4, 5]
+    assert [row["second"] for row in reorder.drain(flush=True)] == [9]
+
+def test_late_bar_takes_the_correction_path(monkeypatch):
+    reorder = service(monkeypatch)
+    for second in (0, 1, 10):
+        push(reorder, second)
+    reorder.drain()
+    assert not push(reorder, 1)
+    assert push(reorder, 8)
+
+def test_streams_are_ordered_independently(monkeypatch):
+    reorder = service(monkeypatch)
+    push(reorder, 5, symbol="ES")
+    push(reorder, 1, symbol="NQ")
+    push(reorder, 0, symbol="NQ")
+    released = reorder.drain(flush=True)
+    assert [(row["symbol"], row["second"]) for row in released] == [("ES", 5), ("NQ", 0), ("NQ", 1)]
+
+def test_disabled_reordering_passes_bars_through(monkeypatch):
+    reorder = service(monkeypatch, lateness_bars=0)
+    assert reorder.buffer is None
+    for second in (2, 0, 1):
+        assert push(reorder, second)
+    assert [row["second"] for row in reorder.drain()] == [2, 0, 1]
+    assert reorder.stats() == {}
@@ -0,0 +1,56 @@
+from datetime import date, datetime, timezone
+
+from app.core.native import to_micros
+from app.services.session_service import compile_sessions
+
+CME = {
+    "timezone": "America/Chicago",
+    "sessions": [{"open": "17:00", "close": "16:00", "days": [0, 1, 2, 3, 4]}],
+    "holidays": ["2024-03-13"],
+    "early_closes": {"2024-03-14": "12:15"},
+}
+
+def utc(*args) -> int:
+    return to_micros(datetime(*args, tzinfo=timezone.utc))
+
+def test_sessions_follow_the_dst_change():
+    # US DST starts Sunday 2024-03-10: Chicago goes from UTC-6 to UTC-5
+    starts, ends = compile_sessions(CME, date(2024, 3, 7), date(2024, 3, 11))
+    assert list(zip(starts, ends)) == [
+        (utc(2024, 3, 6, 23), utc(2024, 3, 7, 22)),     # Thursday, CST
+        (utc(2024, 3, 7, 23), utc(2024, 3, 8, 22)),     # Friday, CST
+        (utc(2024, 3, 10, 22), utc(2024, 3, 11, 21)),   # Monday opens Sunday evening, CDT
+    ]
+
+def test_session_spanning_the_change_is_an_hour_short():
+    spec = {"timezone": "America/Chicago", "sessions": [{"open": "17:00", "close": "16:00", "days": [6]}]}
+    starts, ends = compile_sessions(spec, date(2024, 3, 10), date(2024, 3, 10))
+    assert starts == [utc(2024, 3, 9, 23)]
+    assert ends == [utc(2024, 3, 10, 21)]
+    assert ends[0] - starts[0] == 22 * 3600 * 1_000_000
+
+def test_fall_back_change():
+    # DST ends Sunday 2024-11-03: Monday's session opens an hour later in UTC
+    starts, ends = compile_sessions(CME, date(2024, 11, 1), date(2024, 11, 4))
+    assert list(zip(starts, ends)) == [
+        (utc(2024, 10, 31, 22), utc(2024, 11, 1, 21)),
+        (utc(2024, 11, 3, 23), utc(2024, 11, 4, 22)),
+    ]
+
+def test_holidays_and_early_closes():
+    starts, ends = compile_sessions(CME, date(2024, 3, 12), date(2024, 3, 14))
+    assert list(zip(starts, ends)) == [
+        (utc(2024, 3, 11, 22), utc(2024, 3, 12, 21)),
+        (utc(2024, 3, 13, 22), utc(2024, 3, 14, 17, 15)),
+    ]
+
+def test_overlapping_sessions_are_trimmed():
+    spec = {"timezone": "UTC", "sessions": [
+        {"open": "08:00", "close": "12:00", "days": [0]},
+        {"open": "11:00", "close": "15:00", "days": [0]},
+    ]}
+    starts, ends = compile_sessions(spec, date(2024, 1, 1), date(2024, 1, 1))
+    assert list(zip(starts, ends)) == [
+        (utc(2024, 1, 1, 8), utc(2024, 1, 1, 12)),
+        (utc(2024, 1, 1, 12), utc(2024, 1, 1, 15)),
+    ]
@@ -0,0 +1,43 @@
+import pathlib
+import re
+
+from app.services.market_data_service import INSERT_MARKET_DATA
+
+BACKEND = pathlib.Path(__file__).resolve().parents[2]
+SCHEMA = (BACKEND / "sql" / "timescale_schema.sql").read_text()
+# Statements outside DO blocks, comments dropped
+STATEMENTS = [
+    statement.strip()
+    for statement in re.sub(r"--[^\n]*", "", re.sub(r"DO \$\$.*?\$\$;", "", SCHEMA, flags=re.S)).split(";")
+    if statement.strip()
+]
+
+# market_data columns added after the first release of the schema
+COLLECTOR_CALC_COLUMNS = ("delta", "cvd", "vwap", "vwap_upper", "vwap_lower", "ema")
+
+def test_every_statement_can_run_again():
+    for statement in STATEMENTS:
+        head = " ".join(statement.split()[:6]).upper()
+        if head.startswith("CREATE"):
+            assert "IF NOT EXISTS" in head, statement
+        elif re.match(r"SELECT (create_hypertable|add_\w+_policy)\(", statement):
+            assert "if_not_exists => TRUE" in statement, statement
+        elif head.startswith("ALTER TABLE"):
+            assert "ADD COLUMN IF NOT EXISTS" in statement, statement
+
+    # Compression settings are applied once, inside a guarded block
+    assert "timescaledb.compress" not in " ".join(STATEMENTS)
+    assert re.search(r"IF NOT EXISTS \(SELECT 1 FROM timescaledb_information\.hypertables\s+WHERE hypertable_name = 'market_data' AND compression_enabled\)", SCHEMA)
+
+def test_ingest_columns_exist_on_older_databases():
+    columns = re.search(r"INSERT INTO market_data \((.*?)\)", INSERT_MARKET_DATA, flags=re.S).group(1)
+    table = re.search(r"CREATE TABLE IF NOT EXISTS market_data \((.*?)\n\);", SCHEMA, flags=re.S).group(1)
+    for column in (name.strip() for name in columns.split(",")):
+        assert re.search(rf"^\s+{column} ", table, flags=re.M), column
+    for column in COLLECTOR_CALC_COLUMNS:
+        assert f"ALTER TABLE market_data ADD COLUMN IF NOT EXISTS {column} " in SCHEMA, column
+
+def test_every_written_table_is_created():
+    services = "".join(path.read_text() for path in (BACKEND / "app" / "services").glob("*.py"))
+    for table in set(re.findall(r"INSERT INTO (\w+)", services)):
+        assert f"CREATE TABLE IF NOT EXISTS {table} (" in SCHEMA, table
@@ -0,0 +1,240 @@
+// TradeFlow Pro native price alert engine
+// Active price alerts live in per-symbol sorted ladders: one for conditions
+// that fire as price rises (">", ">=") and one for those that fire as it falls
+// ("<", "<="). A trade or bar fires every crossed alert by walking the ladder
+// from its near end, so a tick costs O(log n + fired). One-shot alerts are
+// removed when they fire; repeating alerts are parked on the opposite ladder
+// and re-armed once price moves back through their level.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    enum e_AlertOperator
+    {
+        ALERT_ABOVE = 0,           // price >  target
+        ALERT_ABOVE_OR_EQUAL,      // price >= target
+        ALERT_BELOW,               // price <  target
+        ALERT_BELOW_OR_EQUAL,      // price <= target
+    };
+
+    inline bool ParseAlertOperator(const std::string& Text, e_AlertOperator& Operator)
+    {
+        if (Text == ">") Operator = ALERT_ABOVE;
+        else if (Text == ">=") Operator = ALERT_ABOVE_OR_EQUAL;
+        else if (Text == "<") Operator = ALERT_BELOW;
+        else if (Text == "<=") Operator = ALERT_BELOW_OR_EQUAL;
+        else return false;
+        return true;
+    }
+
+    class c_AlertEngine
+    {
+    public:
+        // Adds or replaces an alert. Returns false for an unknown operator.
+        bool Upsert(int64_t AlertId, const std::string& Symbol, e_AlertOperator Operator, double Target, bool OneShot)
+        {
+            Remove(AlertId);
+
+            s_Alert Alert;
+            Alert.Id = AlertId;
+            Alert.SymbolId = InternSymbol(Symbol);
+            Alert.Operator = Operator;
+            Alert.Target = Target;
+            Alert.OneShot = OneShot;
+            Insert(Alert, IsRising(Operator) ? LADDER_RISING : LADDER_FALLING, false);
+            return true;
+        }
+
+        bool Remove(int64_t AlertId)
+        {
+            auto Found = Locations.find(AlertId);
+            if (Found == Locations.end())
+                return false;
+
+            const s_Location& Location = Found->second;
+            s_SymbolLadders& Ladders = Symbols[Location.SymbolId];
+            if (Location.Ladder == LADDER_RISING)
+                Ladders.Rising.erase(Location.Key);
+            else
+                Ladders.Falling.erase(Location.Key);
+            Locations.erase(Found);
+            return true;
+        }
+
+        void Clear()
+        {
+            Symbols.clear();
+            SymbolIds.clear();
+            Locations.clear();
+        }
+
+        size_t Size() const { return Locations.size(); }
+
+        // A trade at Price; appends the ids of fired alerts
+        size_t ProcessTrade(const std::string& Symbol, double Price, std::vector<int64_t>& Fired)
+        {
+            return ProcessRange(Symbol, Price, Price, Fired);
+        }
+
+        // A bar that traded between Low and High fires everything inside its range
+        size_t ProcessBar(const std::string& Symbol, double High, double Low, std::vector<int64_t>& Fired)
+        {
+            return ProcessRange(Symbol, High, Low, Fired);
+        }
+
+    private:
+        enum e_Ladder { LADDER_RISING = 0, LADDER_FALLING = 1 };
+
+        struct s_Alert
+        {
+            int64_t Id = 0;
+            uint32_t SymbolId = 0;
+            e_AlertOperator Operator = ALERT_ABOVE;
+            double Target = 0.0;
+            bool OneShot = true;
+            bool Parked = false;  // Repeating alert waiting to re-arm, never fires from here
+        };
+
+        // Ladder order puts the entries nearest to firing first: by target (ascending
+        // on the rising ladder, descending on the falling one), then inclusive before
+        // strict conditions at the same level, then id for uniqueness
+        struct s_Key
+        {
+            double Target;
+            int Strict;
+            int64_t Id;
+        };
+
+        struct s_RisingOrder
+        {
+            bool operator()(const s_Key& A, const s_Key& B) const
+            {
+                if (A.Target != B.Target) return A.Target < B.Target;
+                if (A.Strict != B.Strict) return A.Strict < B.Strict;
+                return A.Id < B.Id;
+            }
+        };
+
+        struct s_FallingOrder
+        {
+            bool operator()(const s_Key& A, const s_Key& B) const
+            {
+                if (A.Target != B.Target) return A.Target > B.Target;
+                if (A.Strict != B.Strict) return A.Strict < B.Strict;
+                return A.Id < B.Id;
+            }
+        };
+
+        struct s_SymbolLadders
+        {
+            std::map<s_Key, s_Alert, s_RisingOrder> Rising;
+            std::map<s_Key, s_Alert, s_FallingOrder> Falling;
+        };
+
+        struct s_Location
+        {
+            uint32_t SymbolId;
+            e_Ladder Ladder;
+            s_Key Key;
+        };
+
+        static bool IsRising(e_AlertOperator Operator)
+        {
+            return Operator == ALERT_ABOVE || Operator == ALERT_ABOVE_OR_EQUAL;
+        }
+
+        // Strictness of the condition that triggers this entry on its current ladder.
+        // A parked alert re-arms when its own condition stops holding: a parked ">"
+        // re-arms at price <= target, i.e. inclusively on the falling ladder.
+        static int EntryStrict(const s_Alert& Alert)
+        {
+            bool Inclusive = Alert.Operator == ALERT_ABOVE_OR_EQUAL || Alert.Operator == ALERT_BELOW_OR_EQUAL;
+            return (Inclusive != Alert.Parked) ? 0 : 1;
+        }
+
+        void Insert(s_Alert Alert, e_Ladder Ladder, bool Parked)
+        {
+            Alert.Parked = Parked;
+            s_Key Key = { Alert.Target, EntryStrict(Alert), Alert.Id };
+            s_SymbolLadders& Ladders = Symbols[Alert.SymbolId];
+            if (Ladder == LADDER_RISING)
+                Ladders.Rising.emplace(Key, Alert);
+            else
+                Ladders.Falling.emplace(Key, Alert);
+            Locations[Alert.Id] = { Alert.SymbolId, Ladder, Key };
+        }
+
+        uint32_t InternSymbol(const std::string& Symbol)
+        {
+            auto Found = SymbolIds.find(Symbol);
+            if (Found != SymbolIds.end())
+                return Found->second;
+            uint32_t SymbolId = (uint32_t)Symbols.size();
+            SymbolIds.emplace(Symbol, SymbolId);
+            Symbols.emplace_back();
+            return SymbolId;
+        }
+
+        static bool Crossed(const s_Key& Key, double Price, bool Rising)
+        {
+            if (Key.Target == Price)
+                return Key.Strict == 0;
+            return Rising ? Key.Target < Price : Key.Target > Price;
+        }
+
+        size_t ProcessRange(const std::string& Symbol, double High, double Low, std::vector<int64_t>& Fired)
+        {
+            auto Found = SymbolIds.find(Symbol);
+            if (Found == SymbolIds.end())
+                return 0;
+
+            s_SymbolLadders& Ladders = Symbols[Found->second];
+            size_t Before = Fired.size();
+            std::vector<s_Alert> Moved;
+
+            // Rising ladder: everything at or below the high has been reached
+            while (!Ladders.Rising.empty() && Crossed(Ladders.Rising.begin()->first, High, true))
+            {
+                Moved.push_back(Ladders.Rising.begin()->second);
+                Ladders.Rising.erase(Ladders.Rising.begin());
+            }
+
+            // Falling ladder: everything at or above the low has been reached
+            while (!Ladders.Falling.empty() && Crossed(Ladders.Falling.begin()->first, Low, false))
+            {
+                Moved.push_back(Ladders.Falling.begin()->second);
+                Ladders.Falling.erase(Ladders.Falling.begin());
+            }
+
+            for (const s_Alert& Alert : Moved)
+            {
+                Locations.erase(Alert.Id);
+                bool Rising = IsRising(Alert.Operator);
+
+                if (Alert.Parked)
+                {
+                    // Price came back through the level: arm it again
+                    Insert(Alert, Rising ? LADDER_RISING : LADDER_FALLING, false);
+                    continue;
+                }
+
+                Fired.push_back(Alert.Id);
+                if (!Alert.OneShot)
+                    Insert(Alert, Rising ? LADDER_FALLING : LADDER_RISING, true);
+            }
+
+            return Fired.size() - Before;
+        }
+
+        std::vector<s_SymbolLadders> Symbols;   // Indexed by symbol id
+        std::unordered_map<std::string, uint32_t> SymbolIds;
+        std::unordered_map<int64_t, s_Location> Locations;
+    };
+}
@@ -0,0 +1,716 @@
+// TradeFlow Pro native bar store
+// Embedded append-only columnar storage for bars, used as the hot tier in front
+// of TimescaleDB. Each (symbol, timeframe) stream is a directory of daily
+// segments; a segment holds one file per column (int64 times, double values)
+// that is appended with pwrite and read through mmap. A sparse in-memory index
+// (every BARSTORE_INDEX_STRIDE-th time) locates range boundaries, so "last N"
+// and time-range reads are a binary search plus one memcpy per column.
+//
+// Only the newest bar of a stream may be rewritten (same time); older times are
+// rejected and stay in TimescaleDB only. NULL values are stored as NaN.
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace n_TradeFlow
+{
+    enum e_BarColumn
+    {
+        BAR_OPEN = 0,
+        BAR_HIGH,
+        BAR_LOW,
+        BAR_CLOSE,
+        BAR_VOLUME,
+        BAR_BID_VOLUME,
+        BAR_ASK_VOLUME,
+        BAR_NUMBER_OF_TRADES,
+        BAR_OPEN_INTEREST,
+        BAR_DELTA,
+        BAR_CVD,
+        BAR_VWAP,
+        BAR_VWAP_UPPER,
+        BAR_VWAP_LOWER,
+        BAR_COLUMN_COUNT
+    };
+
+    // File names and market_data column names
+    const char* const BAR_COLUMN_NAMES[BAR_COLUMN_COUNT] =
+    {
+        "open", "high", "low", "close", "volume", "bid_volume", "ask_volume",
+        "number_of_trades", "open_interest", "delta", "cvd", "vwap", "vwap_upper", "vwap_lower"
+    };
+
+    const double BAR_NULL = std::numeric_limits<double>::quiet_NaN();
+    const size_t BARSTORE_INDEX_STRIDE = 64;
+    const int64_t BARSTORE_MICROS_PER_DAY = 86400LL * 1000000;
+
+    struct s_BarRow
+    {
+        int64_t Time = 0;   // Epoch microseconds
+        double Values[BAR_COLUMN_COUNT];
+
+        s_BarRow()
+        {
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+                Values[c] = BAR_NULL;
+        }
+    };
+
+    struct s_BarColumns
+    {
+        std::vector<int64_t> Time;
+        std::vector<double> Values[BAR_COLUMN_COUNT];
+
+        size_t Size() const { return Time.size(); }
+
+        void Clear()
+        {
+            Time.clear();
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+                Values[c].clear();
+        }
+    };
+
+    // One column file. Writable files keep their descriptor and remap on demand
+    // as they grow; sealed files are mapped once and the descriptor is closed.
+    class c_MappedColumn
+    {
+    public:
+        c_MappedColumn(const c_MappedColumn&) = delete;
+        c_MappedColumn& operator=(const c_MappedColumn&) = delete;
+
+        c_MappedColumn(size_t ElementSize) : ElementSize(ElementSize) {}
+
+        ~c_MappedColumn()
+        {
+            Unmap();
+            if (Fd >= 0)
+                close(Fd);
+        }
+
+        bool Open(const std::string& Path, bool Writable)
+        {
+            Fd = open(Path.c_str(), Writable ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+            if (Fd < 0)
+                return false;
+            struct stat Info;
+            if (fstat(Fd, &Info) != 0)
+                return false;
+            Rows = (size_t)Info.st_size / ElementSize;
+            return true;
+        }
+
+        size_t GetRows() const { return Rows; }
+
+        bool Write(size_t Row, const void* Value)
+        {
+            if (Fd < 0)
+                return false;
+            if (pwrite(Fd, Value, ElementSize, (off_t)(Row * ElementSize)) != (ssize_t)ElementSize)
+                return false;
+            if (Row >= Rows)
+                Rows = Row + 1;
+            return true;
+        }
+
+        // Drops rows past Count (recovery from a torn append)
+        void Truncate(size_t Count)
+        {
+            if (Fd >= 0 && Count < Rows && ftruncate(Fd, (off_t)(Count * ElementSize)) == 0)
+                Rows = Count;
+        }
+
+        // Pointer to the first Count rows; remaps when the file outgrew the mapping
+        const char* Data(size_t Count)
+        {
+            if (Count == 0)
+                return nullptr;
+            if (Count > MappedRows)
+            {
+                Unmap();
+                void* Address = mmap(nullptr, Rows * ElementSize, PROT_READ, MAP_SHARED, Fd, 0);
+                if (Address == MAP_FAILED)
+                    return nullptr;
+                Mapping = (char*)Address;
+                MappedRows = Rows;
+            }
+            return Mapping;
+        }
+
+        // Maps everything and releases the descriptor (segment no longer written)
+        void Seal()
+        {
+            if (Fd < 0)
+                return;
+            Data(Rows);
+            close(Fd);
+            Fd = -1;
+        }
+
+    private:
+        void Unmap()
+        {
+            if (Mapping != nullptr)
+                munmap(Mapping, MappedRows * ElementSize);
+            Mapping = nullptr;
+            MappedRows = 0;
+        }
+
+        size_t ElementSize;
+        int Fd = -1;
+        size_t Rows = 0;
+        char* Mapping = nullptr;
+        size_t MappedRows = 0;
+    };
+
+    // One UTC day of one stream
+    class c_BarSegment
+    {
+    public:
+        c_BarSegment(int64_t Day, const std::string& Directory)
+            : Day(Day), Directory(Directory), TimeColumn(sizeof(int64_t))
+        {
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+                Columns[c].reset(new c_MappedColumn(sizeof(double)));
+        }
+
+        bool Open(bool Writable)
+        {
+            if (Writable)
+            {
+                std::error_code Error;
+                std::filesystem::create_directories(Directory, Error);
+            }
+
+            if (!TimeColumn.Open(Directory + "/time.bin", Writable))
+                return false;
+            Rows = TimeColumn.GetRows();
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+            {
+                if (!Columns[c]->Open(Directory + "/" + BAR_COLUMN_NAMES[c] + ".bin", Writable))
+                    return false;
+                Rows = std::min(Rows, Columns[c]->GetRows());
+            }
+
+            // Values are written before the time, so a torn append leaves the
+            // time column shortest; cut every column back to the complete rows
+            TimeColumn.Truncate(Rows);
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+                Columns[c]->Truncate(Rows);
+
+            const int64_t* Times = GetTimes();
+            for (size_t r = 0; r < Rows; r += BARSTORE_INDEX_STRIDE)
+                Sparse.push_back(Times[r]);
+
+            if (!Writable)
+                Seal();
+            return true;
+        }
+
+        void Seal()
+        {
+            TimeColumn.Seal();
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+                Columns[c]->Seal();
+        }
+
+        bool Append(const s_BarRow& Row)
+        {
+            if (!WriteValues(Rows, Row) || !TimeColumn.Write(Rows, &Row.Time))
+                return false;
+            if (Rows % BARSTORE_INDEX_STRIDE == 0)
+                Sparse.push_back(Row.Time);
+            Rows++;
+            return true;
+        }
+
+        bool OverwriteLast(const s_BarRow& Row)
+        {
+            return Rows > 0 && WriteValues(Rows - 1, Row);
+        }
+
+        bool ReadRow(size_t r, s_BarRow& Row)
+        {
+            if (r >= Rows)
+                return false;
+            Row.Time = GetTimes()[r];
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+                Row.Values[c] = ((const double*)Columns[c]->Data(Rows))[r];
+            return true;
+        }
+
+        // First row with time >= Time: sparse index, then at most one stride
+        size_t LowerBound(int64_t Time)
+        {
+            size_t Block = std::upper_bound(Sparse.begin(), Sparse.end(), Time) - Sparse.begin();
+            size_t r = Block > 0 ? (Block - 1) * BARSTORE_INDEX_STRIDE : 0;
+            size_t End = std::min(Rows, Block * BARSTORE_INDEX_STRIDE);
+            const int64_t* Times = GetTimes();
+            while (r < End && Times[r] < Time)
+                r++;
+            return r;
+        }
+
+        // Appends rows [First, Last) to Out, one memcpy per column
+        void CopyRows(size_t First, size_t Last, s_BarColumns& Out)
+        {
+            if (First >= Last)
+                return;
+            size_t Count = Last - First;
+            size_t At = Out.Size();
+
+            Out.Time.resize(At + Count);
+            memcpy(Out.Time.data() + At, GetTimes() + First, Count * sizeof(int64_t));
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+            {
+                Out.Values[c].resize(At + Count);
+                memcpy(Out.Values[c].data() + At, (const double*)Columns[c]->Data(Rows) + First, Count * sizeof(double));
+            }
+        }
+
+        int64_t GetDay() const { return Day; }
+        size_t GetRows() const { return Rows; }
+
+    private:
+        const int64_t* GetTimes() { return (const int64_t*)TimeColumn.Data(Rows); }
+
+        bool WriteValues(size_t r, const s_BarRow& Row)
+        {
+            for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+                if (!Columns[c]->Write(r, &Row.Values[c]))
+                    return false;
+            return true;
+        }
+
+        int64_t Day;
+        std::string Directory;
+        c_MappedColumn TimeColumn;
+        std::unique_ptr<c_MappedColumn> Columns[BAR_COLUMN_COUNT];
+        size_t Rows = 0;
+        std::vector<int64_t> Sparse;
+    };
+
+    // Days since epoch <-> YYYYMMDD directory names (proleptic Gregorian, UTC)
+    inline std::string DayToName(int64_t Day)
+    {
+        int64_t z = Day + 719468;
+        int64_t Era = (z >= 0 ? z : z - 146096) / 146097;
+        int64_t DayOfEra = z - Era * 146097;
+        int64_t YearOfEra = (DayOfEra - DayOfEra / 1460 + DayOfEra / 36524 - DayOfEra / 146096) / 365;
+        int64_t DayOfYear = DayOfEra - (365 * YearOfEra + YearOfEra / 4 - YearOfEra / 100);
+        int64_t MonthIndex = (5 * DayOfYear + 2) / 153;
+        int64_t DayOfMonth = DayOfYear - (153 * MonthIndex + 2) / 5 + 1;
+        int64_t Month = MonthIndex < 10 ? MonthIndex + 3 : MonthIndex - 9;
+        int64_t Year = YearOfEra + Era * 400 + (Month <= 2 ? 1 : 0);
+
+        char Name[40];
+        snprintf(Name, sizeof(Name), "%04d%02d%02d", (int)Year, (int)Month, (int)DayOfMonth);
+        return Name;
+    }
+
+    inline bool NameToDay(const std::string& Name, int64_t& Day)
+    {
+        if (Name.size() != 8 || Name.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        int64_t Year = std::stoll(Name.substr(0, 4));
+        int64_t Month = std::stoll(Name.substr(4, 2));
+        int64_t DayOfMonth = std::stoll(Name.substr(6, 2));
+        Year -= Month <= 2 ? 1 : 0;
+        int64_t Era = (Year >= 0 ? Year : Year - 399) / 400;
+        int64_t YearOfEra = Year - Era * 400;
+        int64_t DayOfYear = (153 * (Month > 2 ? Month - 3 : Month + 9) + 2) / 5 + DayOfMonth - 1;
+        int64_t DayOfEra = YearOfEra * 365 + YearOfEra / 4 - YearOfEra / 100 + DayOfYear;
+        Day = Era * 146097 + DayOfEra - 719468;
+        return true;
+    }
+
+    inline int64_t FloorDiv(int64_t Value, int64_t Divisor)
+    {
+        int64_t Result = Value / Divisor;
+        return (Result * Divisor > Value) ? Result - 1 : Result;
+    }
+
+    class c_BarStream
+    {
+    public:
+        explicit c_BarStream(const std::string& Directory) : Directory(Directory)
+        {
+            std::error_code Error;
+            for (const auto& Entry : std::filesystem::directory_iterator(Directory, Error))
+            {
+                int64_t Day;
+                if (Entry.is_directory(Error) && NameToDay(Entry.path().filename().string(), Day))
+                    Segments.push_back({ Day, nullptr });
+            }
+            std::sort(Segments.begin(), Segments.end(),
+                [](const s_SegmentSlot& A, const s_SegmentSlot& B) { return A.Day < B.Day; });
+        }
+
+        // Appends Row, or rewrites the newest bar when Row.Time equals it.
+        // Returns false for rows older than the newest bar or on I/O errors.
+        bool Append(const s_BarRow& Row, int RetentionDays)
+        {
+            s_BarRow Previous;
+            if (LastRow(Previous))
+            {
+                if (Row.Time < Previous.Time)
+                    return false;
+                if (Row.Time == Previous.Time)
+                {
+                    if (!LastSegment()->OverwriteLast(Row))
+                        return false;
+                    Newest = Row;
+                    return true;
+                }
+            }
+
+            c_BarSegment* Last = LastSegment();
+
+            int64_t Day = FloorDiv(Row.Time, BARSTORE_MICROS_PER_DAY);
+            if (Last == nullptr || Day > Last->GetDay())
+            {
+                if (Last != nullptr)
+                    Last->Seal();
+                std::unique_ptr<c_BarSegment> Segment(new c_BarSegment(Day, Directory + "/" + DayToName(Day)));
+                if (!Segment->Open(true))
+                    return false;
+                Segments.push_back({ Day, std::move(Segment) });
+                Last = Segments.back().Segment.get();
+                if (RetentionDays > 0)
+                    DropBefore(Day - RetentionDays + 1);
+            }
+            else if (Day < Last->GetDay())
+            {
+                return false;
+            }
+
+            if (!Last->Append(Row))
+                return false;
+            Newest = Row;
+            HasNewest = true;
+            return true;
+        }
+
+        // Newest bar, cached so appends and rollups never touch the mapping
+        bool LastRow(s_BarRow& Row)
+        {
+            if (!NewestLoaded)
+            {
+                c_BarSegment* Last = LastSegment();
+                HasNewest = Last != nullptr && Last->GetRows() > 0 && Last->ReadRow(Last->GetRows() - 1, Newest);
+                NewestLoaded = true;
+            }
+            if (HasNewest)
+                Row = Newest;
+            return HasNewest;
+        }
+
+        size_t Count()
+        {
+            size_t Total = 0;
+            for (size_t s = 0; s < Segments.size(); s++)
+            {
+                c_BarSegment* Segment = Load(s);
+                Total += Segment != nullptr ? Segment->GetRows() : 0;
+            }
+            return Total;
+        }
+
+        // Newest N rows, oldest first
+        void Tail(size_t N, s_BarColumns& Out)
+        {
+            Out.Clear();
+            size_t First = Segments.size();
+            size_t Collected = 0;
+            while (First > 0 && Collected < N)
+            {
+                c_BarSegment* Segment = Load(First - 1);
+                Collected += Segment != nullptr ? Segment->GetRows() : 0;
+                First--;
+            }
+
+            size_t Skip = Collected > N ? Collected - N : 0;
+            for (size_t s = First; s < Segments.size(); s++)
+            {
+                c_BarSegment* Segment = Load(s);
+                if (Segment == nullptr)
+                    continue;
+                size_t Begin = std::min(Skip, Segment->GetRows());
+                Skip -= Begin;
+                Segment->CopyRows(Begin, Segment->GetRows(), Out);
+            }
+        }
+
+        // Rows with StartTime <= time <= EndTime, oldest first
+        void Range(int64_t StartTime, int64_t EndTime, s_BarColumns& Out)
+        {
+            Out.Clear();
+            if (EndTime < StartTime)
+                return;
+            int64_t FirstDay = FloorDiv(StartTime, BARSTORE_MICROS_PER_DAY);
+            int64_t LastDay = FloorDiv(EndTime, BARSTORE_MICROS_PER_DAY);
+            for (size_t s = 0; s < Segments.size(); s++)
+            {
+                if (Segments[s].Day < FirstDay || Segments[s].Day > LastDay)
+                    continue;
+                c_BarSegment* Segment = Load(s);
+                if (Segment == nullptr)
+                    continue;
+                size_t Begin = Segment->LowerBound(StartTime);
+                size_t End = EndTime < std::numeric_limits<int64_t>::max() ? Segment->LowerBound(EndTime + 1) : Segment->GetRows();
+                Segment->CopyRows(Begin, End, Out);
+            }
+        }
+
+        void DropBefore(int64_t Day)
+        {
+            size_t Keep = 0;
+            while (Keep < Segments.size() && Segments[Keep].Day < Day)
+            {
+                std::error_code Error;
+                std::filesystem::remove_all(Directory + "/" + DayToName(Segments[Keep].Day), Error);
+                Keep++;
+            }
+            Segments.erase(Segments.begin(), Segments.begin() + Keep);
+        }
+
+    private:
+        struct s_SegmentSlot
+        {
+            int64_t Day;
+            std::unique_ptr<c_BarSegment> Segment;   // Opened on first use
+        };
+
+        c_BarSegment* Load(size_t s)
+        {
+            s_SegmentSlot& Slot = Segments[s];
+            if (!Slot.Segment)
+            {
+                // Only the newest segment is ever appended to
+                bool Writable = s + 1 == Segments.size();
+                std::unique_ptr<c_BarSegment> Segment(new c_BarSegment(Slot.Day, Directory + "/" + DayToName(Slot.Day)));
+                if (!Segment->Open(Writable))
+                    return nullptr;
+                Slot.Segment = std::move(Segment);
+            }
+            return Slot.Segment.get();
+        }
+
+        c_BarSegment* LastSegment()
+        {
+            return Segments.empty() ? nullptr : Load(Segments.size() - 1);
+        }
+
+        std::string Directory;
+        std::vector<s_SegmentSlot> Segments;
+        s_BarRow Newest;
+        bool HasNewest = false;
+        bool NewestLoaded = false;
+    };
+
+    struct s_BarRollup
+    {
+        std::string Timeframe;
+        int64_t BarMicros;
+    };
+
+    // All streams under one root directory. Bars of the base timeframe are also
+    // rolled up into each configured higher timeframe, with the forming bucket
+    // rewritten in place. Single-threaded, like the other ingest-fed engines.
+    class c_BarStore
+    {
+    public:
+        c_BarStore(const std::string& Root, int RetentionDays, const std::string& BaseTimeframe, const std::vector<s_BarRollup>& Rollups)
+            : Root(Root), RetentionDays(RetentionDays), BaseTimeframe(BaseTimeframe), Rollups(Rollups)
+        {
+            std::error_code Error;
+            std::filesystem::create_directories(Root, Error);
+        }
+
+        bool Append(const std::string& Symbol, const std::string& Timeframe, const s_BarRow& Row)
+        {
+            c_BarStream& Stream = GetStream(Symbol, Timeframe);
+            s_BarRow Previous;
+            bool Rewrite = Stream.LastRow(Previous) && Previous.Time == Row.Time;
+            if (!Stream.Append(Row, RetentionDays))
+                return false;
+
+            if (Timeframe == BaseTimeframe)
+            {
+                for (const s_BarRollup& Rollup : Rollups)
+                {
+                    if (Rewrite)
+                        RebuildBucket(Symbol, Rollup, Stream, Row.Time);
+                    else
+                        RollUp(Symbol, Rollup, Row);
+                }
+            }
+            return true;
+        }
+
+        size_t Count(const std::string& Symbol, const std::string& Timeframe)
+        {
+            return GetStream(Symbol, Timeframe).Count();
+        }
+
+        void Tail(const std::string& Symbol, const std::string& Timeframe, size_t N, s_BarColumns& Out)
+        {
+            GetStream(Symbol, Timeframe).Tail(N, Out);
+        }
+
+        void Range(const std::string& Symbol, const std::string& Timeframe, int64_t StartTime, int64_t EndTime, s_BarColumns& Out)
+        {
+            GetStream(Symbol, Timeframe).Range(StartTime, EndTime, Out);
+        }
+
+    private:
+        static double SumNullable(double A, double B)
+        {
+            if (std::isnan(A)) return B;
+            if (std::isnan(B)) return A;
+            return A + B;
+        }
+
+        // Same aggregation as the time_bucket query in get_bars
+        static void Fold(s_BarRow& Row, const s_BarRow& Bar, bool First)
+        {
+            if (First)
+            {
+                int64_t Bucket = Row.Time;
+                Row = s_BarRow();
+                Row.Time = Bucket;
+                Row.Values[BAR_OPEN] = Bar.Values[BAR_OPEN];
+                Row.Values[BAR_HIGH] = Bar.Values[BAR_HIGH];
+                Row.Values[BAR_LOW] = Bar.Values[BAR_LOW];
+                Row.Values[BAR_VOLUME] = 0.0;
+            }
+            else
+            {
+                Row.Values[BAR_HIGH] = std::max(Row.Values[BAR_HIGH], Bar.Values[BAR_HIGH]);
+                Row.Values[BAR_LOW] = std::min(Row.Values[BAR_LOW], Bar.Values[BAR_LOW]);
+            }
+
+            Row.Values[BAR_CLOSE] = Bar.Values[BAR_CLOSE];
+            Row.Values[BAR_VOLUME] += Bar.Values[BAR_VOLUME];
+            Row.Values[BAR_BID_VOLUME] = SumNullable(Row.Values[BAR_BID_VOLUME], Bar.Values[BAR_BID_VOLUME]);
+            Row.Values[BAR_ASK_VOLUME] = SumNullable(Row.Values[BAR_ASK_VOLUME], Bar.Values[BAR_ASK_VOLUME]);
+            Row.Values[BAR_NUMBER_OF_TRADES] = SumNullable(Row.Values[BAR_NUMBER_OF_TRADES], Bar.Values[BAR_NUMBER_OF_TRADES]);
+            Row.Values[BAR_OPEN_INTEREST] = Bar.Values[BAR_OPEN_INTEREST];
+            Row.Values[BAR_DELTA] = SumNullable(Row.Values[BAR_DELTA], Bar.Values[BAR_DELTA]);
+            Row.Values[BAR_CVD] = Bar.Values[BAR_CVD];
+        }
+
+        void RollUp(const std::string& Symbol, const s_BarRollup& Rollup, const s_BarRow& Bar)
+        {
+            c_BarStream& Stream = GetStream(Symbol, Rollup.Timeframe);
+            int64_t Bucket = FloorDiv(Bar.Time, Rollup.BarMicros) * Rollup.BarMicros;
+
+            s_BarRow Row;
+            bool Forming = Stream.LastRow(Row) && Row.Time == Bucket;
+            if (!Forming)
+            {
+                // A stream's first bucket is usually partial; start at the next one
+                std::string Key = StreamKey(Symbol, Rollup.Timeframe);
+                if (Stream.Count() == 0 && !FirstBucket.count(Key))
+                    FirstBucket[Key] = Bucket;
+                if (FirstBucket.count(Key) && FirstBucket[Key] == Bucket)
+                    return;
+                Row.Time = Bucket;
+            }
+
+            Fold(Row, Bar, !Forming);
+            Stream.Append(Row, RetentionDays);
+        }
+
+        // The newest base bar was rewritten: fold its bucket again from the
+        // base rows, so the replaced values are not counted twice
+        void RebuildBucket(const std::string& Symbol, const s_BarRollup& Rollup, c_BarStream& Base, int64_t Time)
+        {
+            c_BarStream& Stream = GetStream(Symbol, Rollup.Timeframe);
+            int64_t Bucket = FloorDiv(Time, Rollup.BarMicros) * Rollup.BarMicros;
+
+            s_BarRow Row;
+            if (!Stream.LastRow(Row) || Row.Time != Bucket)
+                return;   // Skipped as the stream's partial first bucket
+
+            s_BarColumns Bars;
+            Base.Range(Bucket, Time, Bars);
+            for (size_t i = 0; i < Bars.Size(); i++)
+            {
+                s_BarRow Bar;
+                Bar.Time = Bars.Time[i];
+                for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+                    Bar.Values[c] = Bars.Values[c][i];
+                Fold(Row, Bar, i == 0);
+            }
+            if (Bars.Size() > 0)
+                Stream.Append(Row, RetentionDays);
+        }
+
+        static std::string StreamKey(const std::string& Symbol, const std::string& Timeframe)
+        {
+            return Symbol + '\n' + Timeframe;
+        }
+
+        // Symbols may contain '/', ':' etc.; keep [A-Za-z0-9._-] and hex-escape the rest
+        static std::string SafeName(const std::string& Name)
+        {
+            static const char Hex[] = "0123456789ABCDEF";
+            std::string Result;
+            for (unsigned char Char : Name)
+            {
+                if (isalnum(Char) || Char == '.' || Char == '_' || Char == '-')
+                {
+                    Result += (char)Char;
+                }
+                else
+                {
+                    Result += '%';
+                    Result += Hex[Char >> 4];
+                    Result += Hex[Char & 15];
+                }
+            }
+            if (Result.empty() || Result == "." || Result == "..")
+                Result = "%" + Result;
+            return Result;
+        }
+
+        c_BarStream& GetStream(const std::string& Symbol, const std::string& Timeframe)
+        {
+            std::string Key = StreamKey(Symbol, Timeframe);
+            auto Found = Streams.find(Key);
+            if (Found != Streams.end())
+                return *Found->second;
+
+            std::unique_ptr<c_BarStream> Stream(new c_BarStream(Root + "/" + SafeName(Symbol) + "/" + SafeName(Timeframe)));
+            c_BarStream& Result = *Stream;
+            Streams.emplace(Key, std::move(Stream));
+            return Result;
+        }
+
+        std::string Root;
+        int RetentionDays;
+        std::string BaseTimeframe;
+        std::vector<s_BarRollup> Rollups;
+        std::unordered_map<std::string, std::unique_ptr<c_BarStream>> Streams;
+        std::unordered_map<std::string, int64_t> FirstBucket;   // Skipped partial bucket per new rollup stream
+    };
+}
@@ -0,0 +1,176 @@
+// Alert engine benchmark: 100k price alerts across 50 symbols
+//
+// Feeds a random-walk trade stream through c_AlertEngine and through a linear
+// scan over every alert of the symbol with the same rules (one-shot alerts
+// deactivate, repeating alerts disarm until price moves back through their
+// level, as AlertService's fallback does), and reports per-trade latency for
+// both. The two must fire the same alerts; the run fails if they do not.
+//
+// Build (from tradeflow-backend/):
+//   c++ -O3 -std=c++17 -Inative native/bench/alert_bench.cpp -o alert_bench
+// Run:
+//   ./alert_bench [alerts=100000] [symbols=50] [trades=1000000] [repeat_percent=20]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "alerts.h"
+
+using namespace n_TradeFlow;
+typedef std::chrono::steady_clock Clock;
+
+struct s_LinearAlert
+{
+    int64_t Id;
+    e_AlertOperator Operator;
+    double Target;
+    bool OneShot;
+    bool Active;
+    bool Armed;
+};
+
+// A disarmed repeating alert re-arms where its own condition no longer holds
+static bool LinearRearm(const s_LinearAlert& Alert, double Price)
+{
+    switch (Alert.Operator)
+    {
+    case ALERT_ABOVE: return Price <= Alert.Target;
+    case ALERT_ABOVE_OR_EQUAL: return Price < Alert.Target;
+    case ALERT_BELOW: return Price >= Alert.Target;
+    case ALERT_BELOW_OR_EQUAL: return Price > Alert.Target;
+    }
+    return false;
+}
+
+static bool LinearCheck(const s_LinearAlert& Alert, double Price)
+{
+    switch (Alert.Operator)
+    {
+    case ALERT_ABOVE: return Price > Alert.Target;
+    case ALERT_ABOVE_OR_EQUAL: return Price >= Alert.Target;
+    case ALERT_BELOW: return Price < Alert.Target;
+    case ALERT_BELOW_OR_EQUAL: return Price <= Alert.Target;
+    }
+    return false;
+}
+
+static double Percentile(std::vector<double>& Samples, double P)
+{
+    if (Samples.empty())
+        return 0.0;
+    size_t Rank = (size_t)(P / 100.0 * (Samples.size() - 1));
+    std::nth_element(Samples.begin(), Samples.begin() + Rank, Samples.end());
+    return Samples[Rank];
+}
+
+int main(int argc, char** argv)
+{
+    int AlertCount = argc > 1 ? atoi(argv[1]) : 100000;
+    int SymbolCount = argc > 2 ? atoi(argv[2]) : 50;
+    int TradeCount = argc > 3 ? atoi(argv[3]) : 1000000;
+    int RepeatPercent = argc > 4 ? atoi(argv[4]) : 20;
+
+    std::mt19937_64 Random(7);
+    std::vector<std::string> Names(SymbolCount);
+    std::vector<double> Prices(SymbolCount);
+    for (int s = 0; s < SymbolCount; s++)
+    {
+        Names[s] = "SYM" + std::to_string(s);
+        Prices[s] = 1000.0 + s * 10.0;
+    }
+
+    c_AlertEngine Engine;
+    std::vector<std::vector<s_LinearAlert>> Linear(SymbolCount);
+    std::normal_distribution<double> Offset(0.0, 5.0);
+
+    for (int a = 0; a < AlertCount; a++)
+    {
+        int s = (int)(Random() % SymbolCount);
+        double Distance = Offset(Random);
+        // Alerts are placed on the far side of the current price, as users set them
+        e_AlertOperator Operator = Distance >= 0
+            ? (Random() % 2 ? ALERT_ABOVE : ALERT_ABOVE_OR_EQUAL)
+            : (Random() % 2 ? ALERT_BELOW : ALERT_BELOW_OR_EQUAL);
+        double Target = std::round((Prices[s] + Distance) * 4.0) / 4.0;
+        bool OneShot = (int)(Random() % 100) >= RepeatPercent;
+
+        Engine.Upsert(a, Names[s], Operator, Target, OneShot);
+        Linear[s].push_back({ a, Operator, Target, OneShot, true, true });
+    }
+
+    std::vector<int> TradeSymbols(TradeCount);
+    std::vector<double> TradePrices(TradeCount);
+    std::normal_distribution<double> Step(0.0, 0.25);
+    for (int t = 0; t < TradeCount; t++)
+    {
+        int s = (int)(Random() % SymbolCount);
+        Prices[s] = std::round((Prices[s] + Step(Random)) * 4.0) / 4.0;
+        TradeSymbols[t] = s;
+        TradePrices[t] = Prices[s];
+    }
+
+    // Ladder engine
+    std::vector<double> EngineLatency;
+    EngineLatency.reserve(TradeCount);
+    std::vector<int64_t> Fired;
+    size_t EngineFired = 0;
+    uint64_t EngineChecksum = 0;
+    Clock::time_point EngineStart = Clock::now();
+    for (int t = 0; t < TradeCount; t++)
+    {
+        Fired.clear();
+        Clock::time_point Before = Clock::now();
+        Engine.ProcessTrade(Names[TradeSymbols[t]], TradePrices[t], Fired);
+        EngineLatency.push_back(std::chrono::duration<double, std::nano>(Clock::now() - Before).count());
+        EngineFired += Fired.size();
+        for (int64_t Id : Fired)
+            EngineChecksum += (uint64_t)(Id + 1) * (uint64_t)(t + 1);
+    }
+    double EngineSeconds = std::chrono::duration<double>(Clock::now() - EngineStart).count();
+
+    // Linear scan baseline with the engine's rules
+    std::vector<double> LinearLatency;
+    LinearLatency.reserve(TradeCount);
+    size_t LinearFired = 0;
+    uint64_t LinearChecksum = 0;
+    Clock::time_point LinearStart = Clock::now();
+    for (int t = 0; t < TradeCount; t++)
+    {
+        Clock::time_point Before = Clock::now();
+        double Price = TradePrices[t];
+        for (s_LinearAlert& Alert : Linear[TradeSymbols[t]])
+        {
+            if (!Alert.Active)
+                continue;
+            if (!Alert.Armed)
+            {
+                Alert.Armed = LinearRearm(Alert, Price);
+                continue;
+            }
+            if (LinearCheck(Alert, Price))
+            {
+                LinearFired++;
+                LinearChecksum += (uint64_t)(Alert.Id + 1) * (uint64_t)(t + 1);
+                if (Alert.OneShot)
+                    Alert.Active = false;
+                else
+                    Alert.Armed = false;
+            }
+        }
+        LinearLatency.push_back(std::chrono::duration<double, std::nano>(Clock::now() - Before).count());
+    }
+    double LinearSeconds = std::chrono::duration<double>(Clock::now() - LinearStart).count();
+
+    printf("alerts=%d symbols=%d trades=%d repeating=%d%%\n", AlertCount, SymbolCount, TradeCount, RepeatPercent);
+    printf("ladder engine: %.0f trades/s  p50=%.0fns p99=%.0fns  fired=%zu  remaining=%zu\n",
+        TradeCount / EngineSeconds, Percentile(EngineLatency, 50), Percentile(EngineLatency, 99), EngineFired, Engine.Size());
+    printf("linear scan:   %.0f trades/s  p50=%.0fns p99=%.0fns  fired=%zu\n",
+        TradeCount / LinearSeconds, Percentile(LinearLatency, 50), Percentile(LinearLatency, 99), LinearFired);
+    printf("speedup: %.1fx  same alerts fired: %s\n", LinearSeconds / EngineSeconds,
+        EngineFired == LinearFired && EngineChecksum == LinearChecksum ? "yes" : "NO");
+    return EngineFired == LinearFired && EngineChecksum == LinearChecksum ? 0 : 1;
+}
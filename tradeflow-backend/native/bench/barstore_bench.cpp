@@ -0,0 +1,119 @@
+// Bar store benchmark: append throughput and hot-tier read latency
+//
+// Writes Days of 1s bars for one symbol (with the 1m/5m/15m/1h/4h/1d rollups
+// the backend configures), reopens the store cold, then times the two read
+// shapes the API issues: "last N bars" (get_bars) and a time range. Compare
+// with the SQL paths using bench/barstore_vs_sql.py against a live database.
+//
+// Build (from tradeflow-backend/):
+//   c++ -O3 -std=c++17 -Inative native/bench/barstore_bench.cpp -o barstore_bench
+// Run:
+//   ./barstore_bench [dir=/tmp/barstore_bench] [days=5] [reads=2000]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "barstore.h"
+
+using namespace n_TradeFlow;
+typedef std::chrono::steady_clock Clock;
+
+static double Percentile(std::vector<double>& Samples, double P)
+{
+    if (Samples.empty())
+        return 0.0;
+    size_t Rank = (size_t)(P / 100.0 * (Samples.size() - 1));
+    std::nth_element(Samples.begin(), Samples.begin() + Rank, Samples.end());
+    return Samples[Rank];
+}
+
+static std::vector<s_BarRollup> BackendRollups()
+{
+    return {
+        { "1m", 60LL * 1000000 }, { "5m", 300LL * 1000000 }, { "15m", 900LL * 1000000 },
+        { "1h", 3600LL * 1000000 }, { "4h", 14400LL * 1000000 }, { "1d", 86400LL * 1000000 }
+    };
+}
+
+template <typename t_Read>
+static void TimeReads(const char* Label, int Reads, t_Read Read)
+{
+    std::vector<double> Latency;
+    Latency.reserve(Reads);
+    size_t Rows = 0;
+    for (int r = 0; r < Reads; r++)
+    {
+        Clock::time_point Before = Clock::now();
+        Rows += Read(r);
+        Latency.push_back(std::chrono::duration<double, std::micro>(Clock::now() - Before).count());
+    }
+    printf("%-22s p50=%8.1fus p99=%8.1fus  avg rows=%zu\n",
+        Label, Percentile(Latency, 50), Percentile(Latency, 99), Rows / (Reads > 0 ? Reads : 1));
+}
+
+int main(int argc, char** argv)
+{
+    std::string Directory = argc > 1 ? argv[1] : "/tmp/barstore_bench";
+    int Days = argc > 2 ? atoi(argv[2]) : 5;
+    int Reads = argc > 3 ? atoi(argv[3]) : 2000;
+
+    std::filesystem::remove_all(Directory);
+    const std::string Symbol = "ESZ4";
+    const int64_t Start = 1700006400LL * 1000000;   // 2023-11-15 00:00 UTC
+    const int64_t Bars = (int64_t)Days * 86400;
+
+    // Append: one 1s bar per second, random walk
+    {
+        c_BarStore Store(Directory, 0, "1s", BackendRollups());
+        std::mt19937_64 Random(7);
+        std::normal_distribution<double> Step(0.0, 0.25);
+        double Price = 4500.0;
+
+        Clock::time_point Before = Clock::now();
+        for (int64_t b = 0; b < Bars; b++)
+        {
+            s_BarRow Row;
+            Row.Time = Start + b * 1000000;
+            double Open = Price;
+            Price = std::round((Price + Step(Random)) * 4.0) / 4.0;
+            Row.Values[BAR_OPEN] = Open;
+            Row.Values[BAR_HIGH] = std::max(Open, Price);
+            Row.Values[BAR_LOW] = std::min(Open, Price);
+            Row.Values[BAR_CLOSE] = Price;
+            Row.Values[BAR_VOLUME] = (double)(Random() % 50 + 1);
+            Row.Values[BAR_BID_VOLUME] = Row.Values[BAR_VOLUME] / 2;
+            Row.Values[BAR_ASK_VOLUME] = Row.Values[BAR_VOLUME] / 2;
+            Row.Values[BAR_NUMBER_OF_TRADES] = (double)(Random() % 20 + 1);
+            Store.Append(Symbol, "1s", Row);
+        }
+        double Seconds = std::chrono::duration<double>(Clock::now() - Before).count();
+        printf("append: %lld 1s bars (+6 rollups) in %.2fs = %.0f bars/s\n", (long long)Bars, Seconds, Bars / Seconds);
+    }
+
+    // Reads against a freshly opened store (segments mapped on first touch)
+    c_BarStore Store(Directory, 0, "1s", BackendRollups());
+    s_BarColumns Out;
+    std::mt19937_64 Random(11);
+
+    TimeReads("tail 1s  500", Reads, [&](int) { Store.Tail(Symbol, "1s", 500, Out); return Out.Size(); });
+    TimeReads("tail 1s  5000", Reads, [&](int) { Store.Tail(Symbol, "1s", 5000, Out); return Out.Size(); });
+    TimeReads("tail 1m  500", Reads, [&](int) { Store.Tail(Symbol, "1m", 500, Out); return Out.Size(); });
+    TimeReads("tail 1h  500", Reads, [&](int) { Store.Tail(Symbol, "1h", 500, Out); return Out.Size(); });
+    TimeReads("range 1s 1 hour", Reads, [&](int)
+    {
+        int64_t From = Start + (int64_t)(Random() % (uint64_t)(Bars - 3600)) * 1000000;
+        Store.Range(Symbol, "1s", From, From + 3600LL * 1000000, Out);
+        return Out.Size();
+    });
+    TimeReads("range 1s 1 day", Reads / 10, [&](int)
+    {
+        int64_t From = Start + (int64_t)(Random() % (uint64_t)(Bars > 86400 ? Bars - 86400 : 1)) * 1000000;
+        Store.Range(Symbol, "1s", From, From + 86400LL * 1000000, Out);
+        return Out.Size();
+    });
+    return 0;
+}
@@ -0,0 +1,58 @@
+"""
+Bar store vs TimescaleDB: times the get_bars read paths for one symbol.
+
+Compares MarketDataService._get_bars_sql (ORDER BY time DESC LIMIT for 1s,
+time_bucket aggregation otherwise) with the bar store hot tier for the same
+(symbol, timeframe, limit). Needs the database from .env and a built
+tradeflow_native module; the bar store must already hold the symbol.
+
+Run (from tradeflow-backend/):
+    python native/bench/barstore_vs_sql.py ESZ4 [limit=500] [runs=50]
+"""
+import asyncio
+import statistics
+import sys
+import time
+
+sys.path.insert(0, ".")
+
+from app.db.timescale import timescale_manager
+from app.services.bar_store_service import bar_store_service
+from app.services.market_data_service import MarketDataService
+
+TIMEFRAMES = ["1s", "1m", "5m", "15m", "1h", "4h", "1d"]
+
+async def time_call(runs, call):
+    samples = []
+    rows = 0
+    for _ in range(runs):
+        start = time.perf_counter()
+        result = await call()
+        samples.append((time.perf_counter() - start) * 1000)
+        rows = len(result) if result is not None else 0
+    samples.sort()
+    return statistics.median(samples), samples[int(0.99 * (len(samples) - 1))], rows
+
+async def main():
+    symbol = sys.argv[1] if len(sys.argv) > 1 else "ESZ4"
+    limit = int(sys.argv[2]) if len(sys.argv) > 2 else 500
+    runs = int(sys.argv[3]) if len(sys.argv) > 3 else 50
+
+    if not bar_store_service.store:
+        sys.exit("bar store disabled (tradeflow_native missing or BARSTORE_PATH empty)")
+
+    await timescale_manager.connect()
+    service = MarketDataService()
+    print(f"{symbol} limit={limit} runs={runs}  (p50 / p99 ms)")
+    for timeframe in TIMEFRAMES:
+        async def from_store():
+            return bar_store_service.get_bars(symbol, timeframe, limit)
+
+        sql = await time_call(runs, lambda: service._get_bars_sql(symbol, timeframe, limit))
+        store = await time_call(runs, from_store)
+        store_text = f"{store[0]:8.2f} / {store[1]:8.2f}  rows={store[2]}" if store[2] else "not held locally"
+        print(f"{timeframe:>4}  sql {sql[0]:8.2f} / {sql[1]:8.2f}  rows={sql[2]:<6}  store {store_text}")
+    await timescale_manager.disconnect()
+
+if __name__ == "__main__":
+    asyncio.run(main())
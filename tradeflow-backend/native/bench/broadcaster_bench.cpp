@@ -0,0 +1,174 @@
+// Fan-out load test for c_FanoutBroadcaster with a local client simulator
+//
+// Simulates N WebSocket subscribers spread over a symbol universe. Most clients
+// drain their queue continuously; a configurable fraction are slow and read
+// at most 8 messages every slow_drain_ms, less than they are sent, so their
+// queues fill and further ticks conflate. Every 20th message is a large trade
+// event, which is never conflated. Reports publish cost and delivery latency
+// percentiles for fast clients, and conflation and drop counts for slow ones.
+//
+// Build (from tradeflow-backend/):
+//   c++ -O3 -std=c++17 -pthread -Inative native/bench/broadcaster_bench.cpp -o broadcaster_bench
+// Run:
+//   ./broadcaster_bench [subscribers=10000] [symbols=50] [ticks_per_sec=2000] [seconds=10] [slow_percent=5] [slow_drain_ms=250]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "broadcaster.h"
+
+using namespace n_TradeFlow;
+typedef std::chrono::steady_clock Clock;
+
+struct s_BenchMessage
+{
+    Clock::time_point PublishedAt;
+    std::string Encoded;
+    bool Event = false;
+};
+
+typedef std::shared_ptr<const s_BenchMessage> BenchPayload;
+
+static double Percentile(std::vector<double>& Samples, double P)
+{
+    if (Samples.empty())
+        return 0.0;
+    size_t Rank = (size_t)(P / 100.0 * (Samples.size() - 1));
+    std::nth_element(Samples.begin(), Samples.begin() + Rank, Samples.end());
+    return Samples[Rank];
+}
+
+int main(int argc, char** argv)
+{
+    int Subscribers = argc > 1 ? atoi(argv[1]) : 10000;
+    int Symbols = argc > 2 ? atoi(argv[2]) : 50;
+    int TicksPerSecond = argc > 3 ? atoi(argv[3]) : 2000;
+    int Seconds = argc > 4 ? atoi(argv[4]) : 10;
+    int SlowPercent = argc > 5 ? atoi(argv[5]) : 5;
+    int SlowDrainMs = argc > 6 ? atoi(argv[6]) : 250;
+    int ConsumerThreads = (int)std::max(2u, std::thread::hardware_concurrency() - 1);
+
+    c_FanoutBroadcaster<BenchPayload> Broadcaster(256);
+    std::mt19937 Random(42);
+
+    std::vector<uint32_t> Ids(Subscribers);
+    std::vector<bool> Slow(Subscribers);
+    for (int c = 0; c < Subscribers; c++)
+    {
+        Ids[c] = Broadcaster.AddConnection();
+        Slow[c] = (int)(Random() % 100) < SlowPercent;
+        int Count = 1 + Random() % 3;
+        for (int s = 0; s < Count; s++)
+            Broadcaster.Subscribe(Ids[c], "SYM" + std::to_string(Random() % Symbols));
+    }
+
+    std::atomic<bool> Running(true);
+    std::vector<std::vector<double>> Latencies(ConsumerThreads);
+    std::atomic<uint64_t> SlowDelivered(0);
+    std::atomic<uint64_t> SlowEventsDelivered(0);
+
+    std::vector<std::thread> Consumers;
+    for (int t = 0; t < ConsumerThreads; t++)
+    {
+        Consumers.emplace_back([&, t]()
+        {
+            std::vector<BenchPayload> Batch;
+            Clock::time_point LastSlowDrain = Clock::now();
+            while (Running.load(std::memory_order_relaxed))
+            {
+                bool DrainSlow = Clock::now() - LastSlowDrain > std::chrono::milliseconds(SlowDrainMs);
+                for (int c = t; c < Subscribers; c += ConsumerThreads)
+                {
+                    if (Slow[c] && !DrainSlow)
+                        continue;
+
+                    Batch.clear();
+                    Broadcaster.Drain(Ids[c], Slow[c] ? 8 : 64, Batch);
+                    Clock::time_point Now = Clock::now();
+                    for (const BenchPayload& Message : Batch)
+                    {
+                        if (Slow[c])
+                        {
+                            SlowDelivered++;
+                            if (Message->Event)
+                                SlowEventsDelivered++;
+                        }
+                        else
+                            Latencies[t].push_back(std::chrono::duration<double, std::micro>(Now - Message->PublishedAt).count());
+                    }
+                }
+                if (DrainSlow)
+                    LastSlowDrain = Clock::now();
+            }
+        });
+    }
+
+    std::vector<double> PublishCosts;
+    std::vector<uint32_t> Woken;
+    Clock::time_point Start = Clock::now();
+    Clock::time_point NextTick = Start;
+    std::chrono::nanoseconds Interval(1000000000LL / std::max(1, TicksPerSecond));
+    uint64_t Sequence = 0;
+    uint64_t Events = 0;
+
+    while (Clock::now() - Start < std::chrono::seconds(Seconds))
+    {
+        std::this_thread::sleep_until(NextTick);
+        NextTick += Interval;
+
+        std::shared_ptr<s_BenchMessage> Message(new s_BenchMessage());
+        char Buffer[160];
+        int Symbol = (int)(Sequence++ % Symbols);
+        Message->Event = Sequence % 20 == 0;
+        const char* Type = Message->Event ? "large_trades" : "tick";
+        snprintf(Buffer, sizeof(Buffer), "{\"type\":\"%s\",\"symbol\":\"SYM%d\",\"data\":{\"close\":%.2f,\"seq\":%llu}}",
+            Type, Symbol, 4000.0 + (Sequence % 100) * 0.25, (unsigned long long)Sequence);
+        Message->Encoded = Buffer;  // Encoded once, shared by every subscriber
+        Message->PublishedAt = Clock::now();
+        if (Message->Event)
+            Events++;
+
+        Woken.clear();
+        Clock::time_point Before = Clock::now();
+        Broadcaster.Publish("SYM" + std::to_string(Symbol), Type, BenchPayload(Message), Woken, !Message->Event);
+        PublishCosts.push_back(std::chrono::duration<double, std::micro>(Clock::now() - Before).count());
+    }
+
+    Running = false;
+    for (std::thread& Consumer : Consumers)
+        Consumer.join();
+
+    std::vector<double> All;
+    for (std::vector<double>& Samples : Latencies)
+        All.insert(All.end(), Samples.begin(), Samples.end());
+
+    s_BroadcastStats Stats = Broadcaster.GetStats();
+    int SlowClients = 0;
+    size_t SlowPending = 0;
+    for (int c = 0; c < Subscribers; c++)
+    {
+        if (!Slow[c])
+            continue;
+        SlowClients++;
+        SlowPending += Broadcaster.Pending(Ids[c]);
+    }
+
+    printf("subscribers=%d symbols=%d ticks/s=%d seconds=%d slow=%d%% (%d clients, 8 msgs per %d ms) consumer_threads=%d\n",
+        Subscribers, Symbols, TicksPerSecond, Seconds, SlowPercent, SlowClients, SlowDrainMs, ConsumerThreads);
+    printf("published=%llu (events %llu) enqueued=%llu conflated=%llu dropped_events=%llu delivered=%llu\n",
+        (unsigned long long)Stats.Published, (unsigned long long)Events, (unsigned long long)Stats.Enqueued,
+        (unsigned long long)Stats.Conflated, (unsigned long long)Stats.Dropped, (unsigned long long)Stats.Delivered);
+    printf("slow clients: delivered=%llu (events %llu) still pending=%zu (%.1f per client)\n",
+        (unsigned long long)SlowDelivered.load(), (unsigned long long)SlowEventsDelivered.load(),
+        SlowPending, SlowClients > 0 ? (double)SlowPending / SlowClients : 0.0);
+    printf("publish cost us: p50=%.1f p99=%.1f max=%.1f\n",
+        Percentile(PublishCosts, 50), Percentile(PublishCosts, 99), Percentile(PublishCosts, 100));
+    printf("fast-client delivery latency us: p50=%.1f p99=%.1f p99.9=%.1f (samples=%zu)\n",
+        Percentile(All, 50), Percentile(All, 99), Percentile(All, 99.9), All.size());
+    return 0;
+}
@@ -0,0 +1,924 @@
+// Multi-collector load generator for ingest capacity planning
+//
+// Emulates Collectors Sierra Chart collectors with Symbols charts each against
+// /api/v1/market-data. Every chart is one study instance: one keep-alive
+// connection with at most one request in flight, posting the request shapes
+// TradeFlow_Pro_Data_Collector.cpp builds for its send mode:
+//   bar       real-time mode, one closed bar per request (CreateTradeFlowBarJSON)
+//             to the endpoint root
+//   batch     batch mode, batch_size closed bars per request from the
+//             acknowledged cursor (CreateTradeFlowBatchJSON, "sierra_chart_batch")
+//             to /batch with X-TradeFlow-Stream/Seq; a backlog goes out back to back
+//   export    historical mode, a backfill of backfill_bars bars in 100-bar
+//             requests to /batch ("sierra_chart_historical_export"), repeated
+//             every backfill_every_s when set
+// Time-based bars close on every chart at once, every bar_ms of wall time
+// (seconds_per_bar of chart time); inside a burst window (the last burst_s of
+// every burst_every_s) they close burst_factor times as often. A real-time bar
+// that closes while the chart's previous request is in flight is skipped, as
+// in the collector; batch charts build a backlog instead. Failed batch and
+// export requests are resent after retry_ms. Everything runs on one thread
+// through c_UringLoop and c_UringSender (native/uring.h).
+//
+// Reports, per endpoint: requests, throughput, error rate (an HTTP status
+// other than 200, or a transport failure) and latency percentiles, plus the
+// lag from a bar's close to the response that stored it. endpoint=local
+// starts a loopback stand-in that answers every POST with 200, to measure the
+// generator itself.
+//
+// Build (from tradeflow-backend/):
+//   c++ -O3 -std=c++17 -pthread -Inative native/bench/collector_loadgen.cpp -o collector_loadgen
+// Run (name=value arguments, defaults shown):
+//   ./collector_loadgen endpoint=local api_key= collectors=20 symbols=4 seconds=30 bar_ms=1000
+//       seconds_per_bar=60 batch_share=0.5 batch_size=10 backfill_share=0.1 backfill_bars=2000
+//       backfill_every_s=0 burst_every_s=0 burst_s=5 burst_factor=10 calcs=1 retry_ms=250 report_s=5
+// For staging use e.g. endpoint=http://staging-host:8000/api/v1/market-data api_key=...
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#include "uring.h"
+
+using namespace n_TradeFlow;
+typedef std::chrono::steady_clock Clock;
+
+static const long long SC_EPOCH_OFFSET_MS = 25569LL * 86400000;    // 1899-12-30 to 1970-01-01
+static const int EXPORT_BATCH_BARS = 100;       // The collector's historical batch size
+
+static const char RESPONSE[] =
+    "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 20\r\n\r\n{\"status\":\"success\"}";
+
+static double Percentile(std::vector<double>& Samples, double P)
+{
+    if (Samples.empty())
+        return 0.0;
+    size_t Rank = (size_t)(P / 100.0 * (Samples.size() - 1));
+    std::nth_element(Samples.begin(), Samples.begin() + Rank, Samples.end());
+    return Samples[Rank];
+}
+
+// Complete requests at the front of Buffer are answered and removed
+static bool ServeBuffered(int Fd, std::string& Buffer)
+{
+    for (;;)
+    {
+        size_t End = Buffer.find("\r\n\r\n");
+        if (End == std::string::npos)
+            return true;
+        size_t Length = 0;
+        size_t Header = Buffer.find("Content-Length: ");
+        if (Header != std::string::npos && Header < End)
+            Length = (size_t)strtoull(Buffer.c_str() + Header + 16, nullptr, 10);
+        if (Buffer.size() < End + 4 + Length)
+            return true;
+        Buffer.erase(0, End + 4 + Length);
+        if (send(Fd, RESPONSE, sizeof(RESPONSE) - 1, MSG_NOSIGNAL) != (ssize_t)(sizeof(RESPONSE) - 1))
+            return false;
+    }
+}
+
+static void ServerThread(int Listener, std::atomic<bool>* Stop)
+{
+    int Poll = epoll_create1(0);
+    epoll_event Event;
+    Event.events = EPOLLIN;
+    Event.data.fd = Listener;
+    epoll_ctl(Poll, EPOLL_CTL_ADD, Listener, &Event);
+
+    std::unordered_map<int, std::string> Buffers;
+    std::vector<epoll_event> Ready(256);
+    std::vector<char> Chunk(65536);
+    while (!Stop->load())
+    {
+        int Count = epoll_wait(Poll, Ready.data(), (int)Ready.size(), 50);
+        for (int e = 0; e < Count; e++)
+        {
+            int Fd = Ready[e].data.fd;
+            if (Fd == Listener)
+            {
+                int Client = accept4(Listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (Client < 0)
+                    continue;
+                int One = 1;
+                setsockopt(Client, IPPROTO_TCP, TCP_NODELAY, &One, sizeof(One));
+                Event.events = EPOLLIN;
+                Event.data.fd = Client;
+                epoll_ctl(Poll, EPOLL_CTL_ADD, Client, &Event);
+                Buffers[Client].clear();
+                continue;
+            }
+
+            std::string& Buffer = Buffers[Fd];
+            bool Open = true;
+            for (;;)
+            {
+                ssize_t Received = recv(Fd, Chunk.data(), Chunk.size(), 0);
+                if (Received > 0)
+                {
+                    Buffer.append(Chunk.data(), (size_t)Received);
+                    continue;
+                }
+                Open = Received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+                break;
+            }
+            if (!Open || !ServeBuffered(Fd, Buffer))
+            {
+                epoll_ctl(Poll, EPOLL_CTL_DEL, Fd, nullptr);
+                close(Fd);
+                Buffers.erase(Fd);
+            }
+        }
+    }
+    for (auto& Entry : Buffers)
+        close(Entry.first);
+    close(Poll);
+}
+
+// Listens on an ephemeral loopback port; returns the port, or 0
+static int StartStandIn(std::vector<std::thread>& Threads, std::atomic<bool>& Stop)
+{
+    int Listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int One = 1;
+    setsockopt(Listener, SOL_SOCKET, SO_REUSEADDR, &One, sizeof(One));
+    sockaddr_in Address;
+    memset(&Address, 0, sizeof(Address));
+    Address.sin_family = AF_INET;
+    Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t Length = sizeof(Address);
+    if (bind(Listener, (const sockaddr*)&Address, sizeof(Address)) != 0 || listen(Listener, 4096) != 0
+        || getsockname(Listener, (sockaddr*)&Address, &Length) != 0)
+        return 0;
+    Threads.emplace_back(ServerThread, Listener, &Stop);
+    return ntohs(Address.sin_port);
+}
+
+struct s_Options
+{
+    std::string Endpoint = "local";
+    std::string APIKey;
+    int Collectors = 20;
+    int Symbols = 4;                // Charts per collector
+    double Seconds = 30;
+    double BarMs = 1000;            // Wall time between bar closes outside bursts
+    int SecondsPerBar = 60;         // Chart time per bar (chart_info, timestamps)
+    double BatchShare = 0.5;        // Share of charts in batch mode
+    int BatchSize = 10;
+    double BackfillShare = 0.1;     // Share of charts in historical mode
+    int BackfillBars = 2000;
+    double BackfillEverySeconds = 0;    // 0 = one backfill at start
+    double BurstEverySeconds = 0;   // 0 = no bursts
+    double BurstSeconds = 5;
+    double BurstFactor = 10;
+    bool Calcs = true;              // Delta, CVD, VWAP bands and two EMAs per bar
+    double RetryMs = 250;
+    double ReportSeconds = 5;
+};
+
+static bool ParseOptions(int argc, char** argv, s_Options& Options)
+{
+    for (int a = 1; a < argc; a++)
+    {
+        std::string Arg = argv[a];
+        size_t Equals = Arg.find('=');
+        if (Equals == std::string::npos)
+            return false;
+        std::string Name = Arg.substr(0, Equals);
+        const char* Value = argv[a] + Equals + 1;
+
+        if (Name == "endpoint") Options.Endpoint = Value;
+        else if (Name == "api_key") Options.APIKey = Value;
+        else if (Name == "collectors") Options.Collectors = atoi(Value);
+        else if (Name == "symbols") Options.Symbols = atoi(Value);
+        else if (Name == "seconds") Options.Seconds = atof(Value);
+        else if (Name == "bar_ms") Options.BarMs = atof(Value);
+        else if (Name == "seconds_per_bar") Options.SecondsPerBar = atoi(Value);
+        else if (Name == "batch_share") Options.BatchShare = atof(Value);
+        else if (Name == "batch_size") Options.BatchSize = atoi(Value);
+        else if (Name == "backfill_share") Options.BackfillShare = atof(Value);
+        else if (Name == "backfill_bars") Options.BackfillBars = atoi(Value);
+        else if (Name == "backfill_every_s") Options.BackfillEverySeconds = atof(Value);
+        else if (Name == "burst_every_s") Options.BurstEverySeconds = atof(Value);
+        else if (Name == "burst_s") Options.BurstSeconds = atof(Value);
+        else if (Name == "burst_factor") Options.BurstFactor = atof(Value);
+        else if (Name == "calcs") Options.Calcs = atoi(Value) != 0;
+        else if (Name == "retry_ms") Options.RetryMs = atof(Value);
+        else if (Name == "report_s") Options.ReportSeconds = atof(Value);
+        else
+            return false;
+    }
+    return Options.Collectors > 0 && Options.Symbols > 0 && Options.Seconds > 0 && Options.BarMs > 0
+        && Options.SecondsPerBar > 0 && Options.BatchSize > 0 && Options.BackfillBars >= 0
+        && Options.BurstFactor > 0 && Options.ReportSeconds > 0;
+}
+
+// sc.FormatDateTime layout, "YYYY-MM-DD HH:MM:SS", from ms since 1899-12-30
+static void AppendTime(std::string& Out, long long Ms)
+{
+    long long Days = Ms / 86400000;
+    long long MsOfDay = Ms % 86400000;
+    long long z = Days - 25569 + 719468;
+    long long Era = (z >= 0 ? z : z - 146096) / 146097;
+    long long DayOfEra = z - Era * 146097;
+    long long YearOfEra = (DayOfEra - DayOfEra / 1460 + DayOfEra / 36524 - DayOfEra / 146096) / 365;
+    long long DayOfYear = DayOfEra - (365 * YearOfEra + YearOfEra / 4 - YearOfEra / 100);
+    long long MonthPart = (5 * DayOfYear + 2) / 153;
+    int Day = (int)(DayOfYear - (153 * MonthPart + 2) / 5 + 1);
+    int Month = (int)(MonthPart < 10 ? MonthPart + 3 : MonthPart - 9);
+    int Year = (int)(YearOfEra + Era * 400 + (Month <= 2 ? 1 : 0));
+
+    char Text[32];
+    snprintf(Text, sizeof(Text), "%04d-%02d-%02d %02d:%02d:%02d", Year, Month, Day,
+        (int)(MsOfDay / 3600000), (int)(MsOfDay / 60000 % 60), (int)(MsOfDay / 1000 % 60));
+    Out += Text;
+}
+
+static long long NowScMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+        + SC_EPOCH_OFFSET_MS;
+}
+
+static void AppendFormat(std::string& Out, const char* Format, double Value)
+{
+    char Text[64];
+    snprintf(Text, sizeof(Text), Format, Value);
+    Out += Text;
+}
+
+struct s_Bar
+{
+    long long TimeMs = 0;       // Bar start, ms since 1899-12-30
+    float Open = 0, High = 0, Low = 0, Close = 0;   // sc.BaseDataIn is float
+    float Volume = 0, BidVolume = 0, AskVolume = 0;
+    int Trades = 0;
+    double Delta = 0, CVD = 0, VWAP = 0, VWAPBand = 0, EMA9 = 0, EMA21 = 0;
+    Clock::time_point ClosedAt;
+};
+
+// Random walk in 0.25 ticks, with the collector's streaming calculations
+struct s_Walk
+{
+    uint64_t State = 0;
+    double Price = 0;
+    double CVD = 0, SumPV = 0, SumV = 0, SumP2V = 0, EMA9 = 0, EMA21 = 0;
+
+    void Seed(uint64_t Seed, double Start)
+    {
+        State = Seed * 0x9E3779B97F4A7C15ULL + 1;
+        Price = Start;
+        CVD = SumPV = SumV = SumP2V = 0;
+        EMA9 = EMA21 = Start;
+    }
+
+    uint64_t Next()
+    {
+        State ^= State << 13;
+        State ^= State >> 7;
+        State ^= State << 17;
+        return State;
+    }
+
+    s_Bar Make(long long TimeMs)
+    {
+        s_Bar Bar;
+        Bar.TimeMs = TimeMs;
+        Bar.Open = Bar.High = Bar.Low = (float)Price;
+        int Steps = 4 + (int)(Next() % 12);
+        for (int s = 0; s < Steps; s++)
+        {
+            Price += ((int)(Next() % 5) - 2) * 0.25;
+            Bar.High = std::max(Bar.High, (float)Price);
+            Bar.Low = std::min(Bar.Low, (float)Price);
+        }
+        Bar.Close = (float)Price;
+        Bar.Volume = (float)(50 + Next() % 2000);
+        Bar.BidVolume = std::floor(Bar.Volume * (0.3f + (Next() % 40) / 100.0f));
+        Bar.AskVolume = Bar.Volume - Bar.BidVolume;
+        Bar.Trades = 1 + (int)(Bar.Volume / 3);
+
+        double Typical = (Bar.High + Bar.Low + Bar.Close) / 3.0;
+        Bar.Delta = Bar.AskVolume - Bar.BidVolume;
+        CVD += Bar.Delta;
+        SumPV += Typical * Bar.Volume;
+        SumV += Bar.Volume;
+        SumP2V += Typical * Typical * Bar.Volume;
+        EMA9 += (Bar.Close - EMA9) * 2.0 / 10.0;
+        EMA21 += (Bar.Close - EMA21) * 2.0 / 22.0;
+        Bar.CVD = CVD;
+        Bar.VWAP = SumPV / SumV;
+        Bar.VWAPBand = std::sqrt(std::max(0.0, SumP2V / SumV - Bar.VWAP * Bar.VWAP)) * 2.0;
+        Bar.EMA9 = EMA9;
+        Bar.EMA21 = EMA21;
+        return Bar;
+    }
+};
+
+struct s_ChartInfo
+{
+    std::string Symbol;
+    int ChartNumber = 0;
+    int SecondsPerBar = 0;
+};
+
+// CreateTradeFlowBarBody followed by CreateTradeFlowBarTail, field for field
+static void AppendBar(std::string& Out, const s_ChartInfo& Info, const s_Bar& Bar, bool Calcs, const std::string& CollectedAt)
+{
+    Out += "{\"timestamp\":\"";
+    AppendTime(Out, Bar.TimeMs);
+    AppendFormat(Out, "\",\"open\":%f", Bar.Open);
+    AppendFormat(Out, ",\"high\":%f", Bar.High);
+    AppendFormat(Out, ",\"low\":%f", Bar.Low);
+    AppendFormat(Out, ",\"close\":%f", Bar.Close);
+    AppendFormat(Out, ",\"volume\":%.0f", Bar.Volume);
+    if (Bar.BidVolume != 0)
+        AppendFormat(Out, ",\"bid_volume\":%.0f", Bar.BidVolume);
+    else
+        Out += ",\"bid_volume\":0.0";
+    if (Bar.AskVolume != 0)
+        AppendFormat(Out, ",\"ask_volume\":%.0f", Bar.AskVolume);
+    else
+        Out += ",\"ask_volume\":0.0";
+    Out += ",\"number_of_trades\":";
+    Out += std::to_string(Bar.Trades);
+    Out += ",\"open_interest\":null,";
+    if (Calcs)
+    {
+        AppendFormat(Out, "\"delta\":%.0f,", Bar.Delta);
+        AppendFormat(Out, "\"cvd\":%.0f,", Bar.CVD);
+        AppendFormat(Out, "\"vwap\":%f,", Bar.VWAP);
+        AppendFormat(Out, "\"vwap_upper\":%f,", Bar.VWAP + Bar.VWAPBand);
+        AppendFormat(Out, "\"vwap_lower\":%f,", Bar.VWAP - Bar.VWAPBand);
+        AppendFormat(Out, "\"ema\":{\"9\":%f,", Bar.EMA9);
+        AppendFormat(Out, "\"21\":%f},", Bar.EMA21);
+    }
+    Out += "\"chart_info\":{\"symbol\":\"";
+    Out += Info.Symbol;
+    Out += "\",\"chart_number\":";
+    Out += std::to_string(Info.ChartNumber);
+    Out += ",\"seconds_per_bar\":";
+    Out += std::to_string(Info.SecondsPerBar);
+    Out += "},\"source\":\"sierra_chart\",\"collected_at\":\"";
+    Out += CollectedAt;
+    Out += "\"}";
+}
+
+// CreateTradeFlowBatchJSON
+static void AppendBatch(std::string& Out, const s_ChartInfo& Info, const std::vector<s_Bar>& Bars, const char* DataSource,
+    bool Calcs)
+{
+    std::string CollectedAt;
+    AppendTime(CollectedAt, NowScMs());
+    Out += "{\"data\":[";
+    for (size_t i = 0; i < Bars.size(); i++)
+    {
+        if (i > 0)
+            Out += ",";
+        AppendBar(Out, Info, Bars[i], Calcs, CollectedAt);
+    }
+    Out += "],\"metadata\":{\"source\":\"";
+    Out += DataSource;
+    Out += "\",\"collected_at\":\"";
+    Out += CollectedAt;
+    Out += "\",\"total_bars\":";
+    Out += std::to_string(Bars.size());
+    Out += "}}";
+}
+
+enum e_Mode
+{
+    MODE_REALTIME,
+    MODE_BATCH,
+    MODE_BACKFILL
+};
+
+enum e_Kind
+{
+    KIND_BAR,
+    KIND_BATCH,
+    KIND_EXPORT,
+    KIND_COUNT
+};
+
+static const char* KIND_NAMES[KIND_COUNT] = { "bar", "batch", "export" };
+static const char* KIND_PATHS[KIND_COUNT] = { "", "/batch", "/batch" };
+
+struct s_Chart
+{
+    s_ChartInfo Info;
+    e_Mode Mode = MODE_REALTIME;
+    int Connection = -1;
+    s_Walk Walk;
+
+    // Batch mode: closed bars after the acknowledged cursor
+    std::deque<s_Bar> Pending;
+    long long EpochMs = 0;
+    long long AckedCount = 0;
+
+    // Historical mode
+    bool Exporting = false;
+    int ExportAcked = 0;
+    long long ExportEpochMs = 0;
+    long long ExportFirstMs = 0;
+    s_Walk ExportWalk;
+
+    // The request in flight or awaiting a resend; Body is sent in place
+    bool InFlight = false;
+    bool RetryPending = false;
+    e_Kind Kind = KIND_BAR;
+    int Bars = 0;
+    std::string Body;
+    std::string Headers;
+    Clock::time_point SentAt;
+    Clock::time_point NewestClose;  // Close of the newest live bar in Body
+    bool TimerArmed = false;        // Resend, or the next backfill when idle
+    Clock::time_point TimerAt;
+};
+
+struct s_EndpointStats
+{
+    size_t Requests = 0;
+    size_t Bars = 0;
+    size_t Bytes = 0;
+    size_t HTTPErrors = 0;
+    size_t TransportErrors = 0;
+    std::vector<double> Latency;    // ms, post to response
+    std::vector<double> Lag;        // ms, newest bar's close to the response that stored it
+};
+
+class c_LoadGenerator
+{
+public:
+    c_LoadGenerator(const s_Options& Options, c_UringLoop& Loop, const std::string& Endpoint)
+        : Options(Options)
+        , Loop(Loop)
+        , Sender(Loop, Endpoint, Options.APIKey)
+    {
+    }
+
+    bool IsValid() const { return Sender.IsValid(); }
+
+    void Setup()
+    {
+        int Count = Options.Collectors * Options.Symbols;
+        int Backfill = std::min(Count, (int)std::lround(Count * Options.BackfillShare));
+        int Batch = std::min(Count - Backfill, (int)std::lround(Count * Options.BatchShare));
+        std::vector<e_Mode> Modes((size_t)Count, MODE_REALTIME);
+        std::fill(Modes.begin(), Modes.begin() + Backfill, MODE_BACKFILL);
+        std::fill(Modes.begin() + Backfill, Modes.begin() + Backfill + Batch, MODE_BATCH);
+        s_Walk Shuffle;
+        Shuffle.Seed(42, 0);
+        for (int i = Count - 1; i > 0; i--)
+            std::swap(Modes[(size_t)i], Modes[(size_t)(Shuffle.Next() % (uint64_t)(i + 1))]);
+
+        // Whole seconds keep the batch stream epochs distinct between runs
+        BaseMs = NowScMs() / 1000 * 1000;
+        NextBarMs = BaseMs;
+        Charts.resize((size_t)Count);
+        for (int c = 0; c < Options.Collectors; c++)
+        {
+            for (int s = 0; s < Options.Symbols; s++)
+            {
+                int Index = c * Options.Symbols + s;
+                s_Chart& Chart = Charts[(size_t)Index];
+                char Symbol[32];
+                snprintf(Symbol, sizeof(Symbol), "LG%03d_%02d", c, s);
+                Chart.Info.Symbol = Symbol;
+                Chart.Info.ChartNumber = s + 1;
+                Chart.Info.SecondsPerBar = Options.SecondsPerBar;
+                Chart.Mode = Modes[(size_t)Index];
+                Chart.Connection = Sender.AddConnection();
+                Chart.Walk.Seed((uint64_t)Index + 1, 4000.0 + Index % 500);
+                Chart.EpochMs = BaseMs - Options.SecondsPerBar * 1000LL;
+                ModeCounts[Chart.Mode]++;
+            }
+        }
+    }
+
+    void Run()
+    {
+        Start = Clock::now();
+        Clock::time_point End = Start + ToDuration(Options.Seconds * 1000);
+        Clock::time_point NextClose = Start + Interval(Start);
+        Clock::time_point NextReport = Start + ToDuration(Options.ReportSeconds * 1000);
+        Clock::time_point DrainUntil;
+        bool Stopping = false;
+
+        printf("%8s %9s %9s %8s %9s %9s %9s %8s %8s\n",
+            "time", "req/s", "bars/s", "errors", "p50 ms", "p99 ms", "in flight", "unacked", "skipped");
+        for (size_t i = 0; i < Charts.size(); i++)
+            if (Charts[i].Mode == MODE_BACKFILL && Options.BackfillBars > 0)
+                StartExport((int)i);
+
+        for (;;)
+        {
+            Clock::time_point Now = Clock::now();
+            if (!Stopping && Now >= End)
+            {
+                // No new bars, resends or backfills; wait for what is in flight
+                Stopping = true;
+                DrainUntil = Now + std::chrono::seconds(10);
+            }
+            if (Stopping)
+            {
+                if (InFlight == 0 || Now >= DrainUntil)
+                    break;
+            }
+            else
+            {
+                while (Now >= NextClose)
+                {
+                    CloseBars(Now);
+                    NextClose += Interval(NextClose);
+                }
+                while (!Timers.empty() && Timers.top().first <= Now)
+                {
+                    int Index = Timers.top().second;
+                    Clock::time_point At = Timers.top().first;
+                    Timers.pop();
+                    OnTimer(Index, At);
+                }
+            }
+            if (Now >= NextReport)
+            {
+                ReportInterval(Now);
+                NextReport += ToDuration(Options.ReportSeconds * 1000);
+            }
+
+            Clock::time_point Deadline = std::min(NextReport, Stopping ? DrainUntil : std::min(NextClose, End));
+            if (!Stopping && !Timers.empty())
+                Deadline = std::min(Deadline, Timers.top().first);
+            long long WaitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Deadline - Clock::now()).count();
+            if (Loop.Run(1, std::max(0LL, WaitNs)) < 0)
+                break;
+        }
+        Elapsed = std::chrono::duration<double>(Clock::now() - Start).count();
+    }
+
+    void Report()
+    {
+        std::string Base = Sender.GetBasePath();
+        printf("\n%-40s %8s %9s %9s %7s %7s %6s %6s %8s %8s %8s %8s %8s %9s %9s\n",
+            "endpoint", "requests", "req/s", "bars/s", "MB/s", "err %", "http", "net",
+            "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms", "lag p50", "lag p99");
+        s_EndpointStats All;
+        for (int k = 0; k < KIND_COUNT; k++)
+        {
+            s_EndpointStats& Stats = Endpoints[k];
+            All.Requests += Stats.Requests;
+            All.Bars += Stats.Bars;
+            All.Bytes += Stats.Bytes;
+            All.HTTPErrors += Stats.HTTPErrors;
+            All.TransportErrors += Stats.TransportErrors;
+            All.Latency.insert(All.Latency.end(), Stats.Latency.begin(), Stats.Latency.end());
+            All.Lag.insert(All.Lag.end(), Stats.Lag.begin(), Stats.Lag.end());
+            if (Stats.Requests > 0)
+                PrintRow(("POST " + Base + KIND_PATHS[k] + " (" + KIND_NAMES[k] + ")").c_str(), Stats);
+        }
+        PrintRow("all", All);
+
+        size_t Backlog = 0;
+        size_t MaxBacklog = 0;
+        for (const s_Chart& Chart : Charts)
+        {
+            Backlog += Chart.Pending.size();
+            MaxBacklog = std::max(MaxBacklog, Chart.Pending.size());
+        }
+        printf("\ncharts: %d real-time, %d batch (%d bars per request), %d backfill (%d bars)\n",
+            ModeCounts[MODE_REALTIME], ModeCounts[MODE_BATCH], Options.BatchSize, ModeCounts[MODE_BACKFILL], Options.BackfillBars);
+        printf("bars closed: %zu per chart; real-time bars skipped (request still in flight): %zu\n", BarsClosed, Skipped);
+        printf("batch bars unacknowledged at the end: %zu (largest on one chart: %zu); backfills completed: %zu; resends: %zu\n",
+            Backlog, MaxBacklog, ExportsDone, Resends);
+
+        printf("responses:");
+        for (auto& Entry : Statuses)
+        {
+            if (Entry.first < 0)
+                printf(" %s=%zu", strerror(-Entry.first), Entry.second);
+            else
+                printf(" %d=%zu", Entry.first, Entry.second);
+        }
+        printf("\nuring: %zu SQEs in %zu submits, %zu connects\n",
+            Loop.GetStats().Submitted, Loop.GetStats().Submits, Sender.GetStats().Connects);
+    }
+
+private:
+    const s_Options& Options;
+    c_UringLoop& Loop;
+    c_UringSender Sender;
+    std::vector<s_Chart> Charts;
+    int ModeCounts[3] = { 0, 0, 0 };
+    long long BaseMs = 0;
+    long long NextBarMs = 0;        // Start of the next bar to close, the same on every live chart
+    Clock::time_point Start;
+    double Elapsed = 0;
+    int InFlight = 0;
+
+    typedef std::pair<Clock::time_point, int> t_Timer;
+    std::priority_queue<t_Timer, std::vector<t_Timer>, std::greater<t_Timer>> Timers;
+
+    s_EndpointStats Endpoints[KIND_COUNT];
+    std::map<int, size_t> Statuses;     // HTTP status, or -errno
+    size_t BarsClosed = 0;
+    size_t Skipped = 0;
+    size_t ExportsDone = 0;
+    size_t Resends = 0;
+    std::vector<s_Bar> Scratch;
+
+    // Interval counters, reset by ReportInterval
+    size_t IntervalRequests = 0;
+    size_t IntervalBars = 0;
+    size_t IntervalErrors = 0;
+    std::vector<double> IntervalLatency;
+    Clock::time_point LastReport;
+
+    static Clock::duration ToDuration(double Ms)
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(Ms));
+    }
+
+    // Wall time until the bar after At closes; shorter inside a burst window
+    Clock::duration Interval(Clock::time_point At) const
+    {
+        double Seconds = std::chrono::duration<double>(At - Start).count();
+        double Every = Options.BurstEverySeconds;
+        bool Burst = Every > 0 && std::fmod(Seconds, Every) >= Every - Options.BurstSeconds;
+        return ToDuration(Burst ? Options.BarMs / Options.BurstFactor : Options.BarMs);
+    }
+
+    void CloseBars(Clock::time_point Now)
+    {
+        BarsClosed++;
+        for (size_t i = 0; i < Charts.size(); i++)
+        {
+            s_Chart& Chart = Charts[i];
+            if (Chart.Mode == MODE_BACKFILL)
+                continue;
+            s_Bar Bar = Chart.Walk.Make(NextBarMs);
+            Bar.ClosedAt = Now;
+
+            if (Chart.Mode == MODE_BATCH)
+            {
+                Chart.Pending.push_back(Bar);
+                SendBatch((int)i);
+                continue;
+            }
+
+            // Real time: the collector moves past a bar it could not send
+            if (Chart.InFlight)
+            {
+                Skipped++;
+                continue;
+            }
+            std::string CollectedAt;
+            AppendTime(CollectedAt, NowScMs());
+            Chart.Body.clear();
+            AppendBar(Chart.Body, Chart.Info, Bar, Options.Calcs, CollectedAt);
+            Chart.Headers.clear();
+            Chart.NewestClose = Now;
+            Send((int)i, KIND_BAR, 1);
+        }
+        NextBarMs += Options.SecondsPerBar * 1000LL;
+    }
+
+    // One full batch from the acknowledged cursor, when the line is free
+    void SendBatch(int Index)
+    {
+        s_Chart& Chart = Charts[(size_t)Index];
+        size_t Size = (size_t)Options.BatchSize;
+        if (Chart.InFlight || Chart.RetryPending || Chart.Pending.size() < Size)
+            return;
+
+        Scratch.assign(Chart.Pending.begin(), Chart.Pending.begin() + (long)Size);
+        Chart.Body.clear();
+        AppendBatch(Chart.Body, Chart.Info, Scratch, "sierra_chart_batch", Options.Calcs);
+        char Headers[256];
+        snprintf(Headers, sizeof(Headers), "X-TradeFlow-Stream: %s:%d:%d:batch:%lld\r\nX-TradeFlow-Seq: %lld-%lld\r\n",
+            Chart.Info.Symbol.c_str(), Chart.Info.ChartNumber, Chart.Info.SecondsPerBar, Chart.EpochMs,
+            Chart.AckedCount + 1, Chart.AckedCount + (long long)Size);
+        Chart.Headers = Headers;
+        Chart.NewestClose = Scratch.back().ClosedAt;
+        Send(Index, KIND_BATCH, (int)Size);
+    }
+
+    // Historical export of the BackfillBars bars before the live session,
+    // numbered from the export's first bar
+    void StartExport(int Index)
+    {
+        s_Chart& Chart = Charts[(size_t)Index];
+        Chart.Exporting = true;
+        Chart.ExportAcked = 0;
+        Chart.ExportEpochMs = NowScMs();
+        Chart.ExportFirstMs = BaseMs - Options.BackfillBars * Options.SecondsPerBar * 1000LL;
+        Chart.ExportWalk.Seed((uint64_t)Index + 7919, 4000.0 + Index % 500);
+        SendExport(Index);
+    }
+
+    void SendExport(int Index)
+    {
+        s_Chart& Chart = Charts[(size_t)Index];
+        int Count = std::min(EXPORT_BATCH_BARS, Options.BackfillBars - Chart.ExportAcked);
+        Scratch.clear();
+        for (int b = 0; b < Count; b++)
+            Scratch.push_back(Chart.ExportWalk.Make(Chart.ExportFirstMs + (Chart.ExportAcked + b) * Options.SecondsPerBar * 1000LL));
+        Chart.Body.clear();
+        AppendBatch(Chart.Body, Chart.Info, Scratch, "sierra_chart_historical_export", Options.Calcs);
+        char Headers[256];
+        snprintf(Headers, sizeof(Headers), "X-TradeFlow-Stream: %s:%d:%d:export:%lld\r\nX-TradeFlow-Seq: %d-%d\r\n",
+            Chart.Info.Symbol.c_str(), Chart.Info.ChartNumber, Chart.Info.SecondsPerBar, Chart.ExportEpochMs,
+            Chart.ExportAcked + 1, Chart.ExportAcked + Count);
+        Chart.Headers = Headers;
+        Send(Index, KIND_EXPORT, Count);
+    }
+
+    // Posts Chart.Body as it stands (a resend posts the same bytes again)
+    void Send(int Index, e_Kind Kind, int Bars)
+    {
+        s_Chart& Chart = Charts[(size_t)Index];
+        Chart.InFlight = true;
+        Chart.Kind = Kind;
+        Chart.Bars = Bars;
+        Chart.SentAt = Clock::now();
+        InFlight++;
+        s_UringSlice Slice = { Chart.Body.data(), Chart.Body.size() };
+        Sender.Post(Chart.Connection, KIND_PATHS[Kind], &Slice, 1,
+            [this, Index](const s_UringResponse& Response) { OnResponse(Index, Response); }, Chart.Headers);
+    }
+
+    void OnResponse(int Index, const s_UringResponse& Response)
+    {
+        Clock::time_point Now = Clock::now();
+        s_Chart& Chart = Charts[(size_t)Index];
+        s_EndpointStats& Stats = Endpoints[Chart.Kind];
+        double Latency = std::chrono::duration<double, std::milli>(Now - Chart.SentAt).count();
+        bool OK = Response.Status == 200;
+        Chart.InFlight = false;
+        InFlight--;
+
+        Stats.Requests++;
+        Stats.Bars += (size_t)Chart.Bars;
+        Stats.Bytes += Chart.Body.size();
+        Stats.Latency.push_back(Latency);
+        if (Response.Status < 0)
+            Stats.TransportErrors++;
+        else if (!OK)
+            Stats.HTTPErrors++;
+        Statuses[Response.Status]++;
+        IntervalRequests++;
+        IntervalBars += OK ? (size_t)Chart.Bars : 0;
+        IntervalErrors += OK ? 0 : 1;
+        IntervalLatency.push_back(Latency);
+
+        if (OK && Chart.Kind != KIND_EXPORT)
+            Stats.Lag.push_back(std::chrono::duration<double, std::milli>(Now - Chart.NewestClose).count());
+
+        bool Stopping = Now >= Start + ToDuration(Options.Seconds * 1000);
+        if (Chart.Kind == KIND_BAR || Stopping)
+            return;
+        if (!OK)
+        {
+            Chart.RetryPending = true;
+            Arm(Index, Now + ToDuration(Options.RetryMs));
+            return;
+        }
+
+        if (Chart.Kind == KIND_BATCH)
+        {
+            Chart.Pending.erase(Chart.Pending.begin(), Chart.Pending.begin() + Chart.Bars);
+            Chart.AckedCount += Chart.Bars;
+            SendBatch(Index);
+            return;
+        }
+
+        Chart.ExportAcked += Chart.Bars;
+        if (Chart.ExportAcked < Options.BackfillBars)
+        {
+            SendExport(Index);
+            return;
+        }
+        Chart.Exporting = false;
+        ExportsDone++;
+        if (Options.BackfillEverySeconds > 0)
+            Arm(Index, Now + ToDuration(Options.BackfillEverySeconds * 1000));
+    }
+
+    void Arm(int Index, Clock::time_point At)
+    {
+        s_Chart& Chart = Charts[(size_t)Index];
+        Chart.TimerArmed = true;
+        Chart.TimerAt = At;
+        Timers.push(t_Timer(At, Index));
+    }
+
+    void OnTimer(int Index, Clock::time_point At)
+    {
+        s_Chart& Chart = Charts[(size_t)Index];
+        if (!Chart.TimerArmed || Chart.TimerAt != At)
+            return;
+        Chart.TimerArmed = false;
+        if (Chart.RetryPending)
+        {
+            Chart.RetryPending = false;
+            Resends++;
+            Send(Index, Chart.Kind, Chart.Bars);
+        }
+        else if (!Chart.Exporting)
+            StartExport(Index);
+    }
+
+    void ReportInterval(Clock::time_point Now)
+    {
+        Clock::time_point From = LastReport == Clock::time_point() ? Start : LastReport;
+        double Seconds = std::max(1e-9, std::chrono::duration<double>(Now - From).count());
+        size_t Backlog = 0;
+        for (const s_Chart& Chart : Charts)
+            Backlog += Chart.Pending.size();
+        printf("%7.0fs %9.0f %9.0f %8zu %9.2f %9.2f %9d %8zu %8zu\n",
+            std::chrono::duration<double>(Now - Start).count(), IntervalRequests / Seconds, IntervalBars / Seconds,
+            IntervalErrors, Percentile(IntervalLatency, 50), Percentile(IntervalLatency, 99), InFlight, Backlog, Skipped);
+        fflush(stdout);
+        IntervalRequests = 0;
+        IntervalBars = 0;
+        IntervalErrors = 0;
+        IntervalLatency.clear();
+        LastReport = Now;
+    }
+
+    void PrintRow(const char* Label, s_EndpointStats& Stats)
+    {
+        double Seconds = std::max(1e-9, Elapsed);
+        size_t Errors = Stats.HTTPErrors + Stats.TransportErrors;
+        bool HasLag = !Stats.Lag.empty();
+        printf("%-40s %8zu %9.0f %9.0f %7.2f %7.2f %6zu %6zu %8.2f %8.2f %8.2f %8.2f %8.2f ",
+            Label, Stats.Requests, Stats.Requests / Seconds, Stats.Bars / Seconds, Stats.Bytes / Seconds / 1e6,
+            Stats.Requests > 0 ? 100.0 * Errors / Stats.Requests : 0.0, Stats.HTTPErrors, Stats.TransportErrors,
+            Percentile(Stats.Latency, 50), Percentile(Stats.Latency, 90), Percentile(Stats.Latency, 99),
+            Percentile(Stats.Latency, 99.9), Percentile(Stats.Latency, 100));
+        if (HasLag)
+            printf("%9.2f %9.2f\n", Percentile(Stats.Lag, 50), Percentile(Stats.Lag, 99));
+        else
+            printf("%9s %9s\n", "-", "-");
+    }
+};
+
+int main(int argc, char** argv)
+{
+    s_Options Options;
+    if (!ParseOptions(argc, argv, Options))
+    {
+        fprintf(stderr, "usage: %s [name=value ...] (see the top of collector_loadgen.cpp)\n", argv[0]);
+        return 1;
+    }
+
+    std::atomic<bool> Stop(false);
+    std::vector<std::thread> Server;
+    std::string Endpoint = Options.Endpoint;
+    if (Endpoint == "local")
+    {
+        int Port = StartStandIn(Server, Stop);
+        if (Port == 0)
+        {
+            fprintf(stderr, "cannot listen on loopback: %s\n", strerror(errno));
+            return 1;
+        }
+        Endpoint = "http://127.0.0.1:" + std::to_string(Port) + "/api/v1/market-data";
+    }
+
+    // Bodies are sent in place, so no staging slots are needed
+    c_UringLoop Loop;
+    if (!Loop.Open(1024, 0, 0))
+    {
+        fprintf(stderr, "io_uring unavailable: %s\n", strerror(errno));
+        return 1;
+    }
+    c_LoadGenerator Generator(Options, Loop, Endpoint);
+    if (!Generator.IsValid())
+    {
+        fprintf(stderr, "cannot resolve endpoint %s\n", Endpoint.c_str());
+        return 1;
+    }
+
+    printf("endpoint=%s collectors=%d symbols=%d seconds=%.0f bar_ms=%.0f burst_every_s=%.0f calcs=%d\n",
+        Endpoint.c_str(), Options.Collectors, Options.Symbols, Options.Seconds, Options.BarMs,
+        Options.BurstEverySeconds, Options.Calcs ? 1 : 0);
+    Generator.Setup();
+    Generator.Run();
+    Generator.Report();
+
+    Stop = true;
+    for (std::thread& Thread : Server)
+        Thread.join();
+    return 0;
+}
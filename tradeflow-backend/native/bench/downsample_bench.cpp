@@ -0,0 +1,133 @@
+// Downsampling benchmark: 10M-row bar and line series
+//
+// Times the OHLC bucket reductions (max/min/sum per column), LTTB and min/max
+// line selection on a random-walk series, SSE2 kernels against their scalar
+// versions, and checks both pick the same points.
+//
+// Build (from tradeflow-backend/):
+//   c++ -O3 -std=c++17 -Inative native/bench/downsample_bench.cpp -o downsample_bench
+// Run:
+//   ./downsample_bench [rows=10000000] [points=2000] [repeat=5]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "downsample.h"
+
+using namespace n_TradeFlow;
+typedef std::chrono::steady_clock Clock;
+
+static double Percentile(std::vector<double>& Samples, double P)
+{
+    if (Samples.empty())
+        return 0.0;
+    size_t Rank = (size_t)(P / 100.0 * (Samples.size() - 1));
+    std::nth_element(Samples.begin(), Samples.begin() + Rank, Samples.end());
+    return Samples[Rank];
+}
+
+template <typename t_Body>
+static double TimeMs(int Repeat, t_Body&& Body)
+{
+    std::vector<double> Samples;
+    for (int r = 0; r < Repeat; r++)
+    {
+        Clock::time_point Start = Clock::now();
+        Body();
+        Samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - Start).count());
+    }
+    return Percentile(Samples, 50);
+}
+
+// Scalar baselines with the same bucket layout as the library versions
+static void BucketReduceScalar(const double* In, size_t Count, size_t BucketSize, e_BucketReduce Kind, double* Out)
+{
+    for (size_t b = 0, Start = 0; Start < Count; b++, Start += BucketSize)
+        Out[b] = n_Downsample::ReduceScalar(In + Start, std::min(BucketSize, Count - Start), Kind);
+}
+
+static size_t LTTBScalar(const double* X, const double* Y, size_t Count, size_t Threshold, int64_t* OutIndex)
+{
+    double Every = (double)(Count - 2) / (double)(Threshold - 2);
+    size_t Kept = 0, A = 0;
+    OutIndex[Kept++] = 0;
+    for (size_t b = 0; b < Threshold - 2; b++)
+    {
+        size_t Start = (size_t)(b * Every) + 1;
+        size_t End = std::min((size_t)((b + 1) * Every) + 1, Count - 1);
+        size_t NextEnd = b + 2 < Threshold - 1 ? std::min((size_t)((b + 2) * Every) + 1, Count) : Count;
+        size_t NextCount = NextEnd - End;
+        // Same centroid as the library so only the triangle kernel differs
+        double Cx = n_Downsample::Reduce(X + End, NextCount, BUCKET_SUM) / (double)NextCount;
+        double Cy = n_Downsample::Reduce(Y + End, NextCount, BUCKET_SUM) / (double)NextCount;
+        A = n_Downsample::LargestTriangleScalar(X, Y, Start, End, X[A], Y[A], Cx, Cy);
+        OutIndex[Kept++] = (int64_t)A;
+    }
+    OutIndex[Kept++] = (int64_t)(Count - 1);
+    return Kept;
+}
+
+int main(int argc, char** argv)
+{
+    size_t Rows = argc > 1 ? (size_t)atoll(argv[1]) : 10000000;
+    size_t Points = argc > 2 ? (size_t)atoll(argv[2]) : 2000;
+    int Repeat = argc > 3 ? atoi(argv[3]) : 5;
+
+    std::mt19937_64 Random(42);
+    std::normal_distribution<double> Step(0.0, 0.25);
+    std::vector<double> X(Rows), Close(Rows), High(Rows), Low(Rows), Volume(Rows);
+    double Price = 5000.0;
+    for (size_t i = 0; i < Rows; i++)
+    {
+        Price += Step(Random);
+        X[i] = (double)i;
+        Close[i] = Price;
+        High[i] = Price + std::fabs(Step(Random));
+        Low[i] = Price - std::fabs(Step(Random));
+        Volume[i] = (double)(Random() % 50);
+    }
+
+    size_t BucketSize = BucketSizeFor(Rows, Points);
+    size_t Buckets = BucketCount(Rows, BucketSize);
+    std::vector<double> Out(Buckets), Reference(Buckets);
+    printf("%zu rows -> %zu buckets of %zu (p50 of %d runs)\n\n", Rows, Buckets, BucketSize, Repeat);
+    printf("%-22s %10s %10s\n", "kernel", "sse2 ms", "scalar ms");
+
+    const char* Names[] = { "", "", "bucket max (high)", "bucket min (low)", "bucket sum (volume)" };
+    const std::vector<double>* Inputs[] = { nullptr, nullptr, &High, &Low, &Volume };
+    for (int k = BUCKET_MAX; k <= BUCKET_SUM; k++)
+    {
+        e_BucketReduce Kind = (e_BucketReduce)k;
+        const double* In = Inputs[k]->data();
+        double Fast = TimeMs(Repeat, [&] { BucketReduce(In, Rows, BucketSize, Kind, Out.data()); });
+        double Slow = TimeMs(Repeat, [&] { BucketReduceScalar(In, Rows, BucketSize, Kind, Reference.data()); });
+        for (size_t b = 0; b < Buckets; b++)
+        {
+            if (std::fabs(Out[b] - Reference[b]) > 1e-6 * std::max(1.0, std::fabs(Reference[b])))
+            {
+                printf("mismatch in %s bucket %zu: %f vs %f\n", Names[k], b, Out[b], Reference[b]);
+                return 1;
+            }
+        }
+        printf("%-22s %10.2f %10.2f\n", Names[k], Fast, Slow);
+    }
+
+    std::vector<int64_t> Picked(Points), ReferencePicked(Points);
+    size_t Kept = 0, ReferenceKept = 0;
+    double Fast = TimeMs(Repeat, [&] { Kept = DownsampleLTTB(X.data(), Close.data(), Rows, Points, Picked.data()); });
+    double Slow = TimeMs(Repeat, [&] { ReferenceKept = LTTBScalar(X.data(), Close.data(), Rows, Points, ReferencePicked.data()); });
+    if (Kept != ReferenceKept || !std::equal(Picked.begin(), Picked.begin() + Kept, ReferencePicked.begin()))
+    {
+        printf("LTTB selections differ\n");
+        return 1;
+    }
+    printf("%-22s %10.2f %10.2f\n", "lttb", Fast, Slow);
+
+    Fast = TimeMs(Repeat, [&] { Kept = DownsampleMinMax(Close.data(), Rows, Points, Picked.data()); });
+    printf("%-22s %10.2f %10s\n", "min/max points", Fast, "-");
+    printf("\nkept %zu points\n", Kept);
+    return 0;
+}
@@ -0,0 +1,235 @@
+// Encoder pool benchmark: batch encoding throughput from 1 to N worker threads
+//
+// One producer thread plays the chart threads of many collector instances: for
+// every stream (chart) it copies a batch of raw bars (what
+// CaptureTradeFlowBatch copies out of sc.BaseDataIn), submits it to the
+// encoder pool with at most `window` batches outstanding per stream, and polls
+// the finished bodies, checking each stream gets them back in submission
+// order. The bodies are the collector's batch JSON (EncodeTradeFlowBatch, the
+// same bytes as CreateTradeFlowBatchJSON). The first row encodes on the
+// producer thread, as the collector does with Encoder Threads at 0.
+//
+// Build (from tradeflow-backend/):
+//   c++ -O3 -std=c++17 -pthread -I. native/bench/encoder_pool_bench.cpp -o encoder_pool_bench
+// Run:
+//   ./encoder_pool_bench [streams=64] [batches=200] [bars=100] [max_threads=cores] [window=4]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TradeFlow_Pro_EncoderPool.h"
+#include "TradeFlow_Pro_RawBars.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double Percentile(std::vector<double>& Samples, double P)
+{
+    if (Samples.empty())
+        return 0.0;
+    size_t Rank = (size_t)(P / 100.0 * (Samples.size() - 1));
+    std::nth_element(Samples.begin(), Samples.begin() + Rank, Samples.end());
+    return Samples[Rank];
+}
+
+struct s_Stream
+{
+    s_RawBarBatch Template;         // Chart identity and calculation flags
+    std::vector<s_RawBar> History;  // The chart's bars, batches copied in turn
+    c_EncoderStream Encoder;
+    int Submitted = 0;
+    int Received = 0;
+    std::vector<Clock::time_point> SubmitTimes;
+};
+
+struct s_Result
+{
+    double Seconds = 0;
+    size_t Bytes = 0;
+    bool Ordered = true;
+    size_t Stolen = 0;              // Jobs run by a worker other than the stream's own
+    std::vector<double> LatencyUs;  // Submit to poll, per batch
+};
+
+static void MakeStreams(std::vector<std::unique_ptr<s_Stream>>& Streams, int Count, int Batches, int Bars)
+{
+    std::mt19937_64 Random(42);
+    std::normal_distribution<double> Step(0.0, 0.25);
+    const char* Symbols[] = { "ES", "NQ", "YM", "RTY", "CL", "GC", "ZN", "6E" };
+    for (int s = 0; s < Count; s++)
+    {
+        std::unique_ptr<s_Stream> Stream(new s_Stream());
+        s_RawBarBatch& Template = Stream->Template;
+        Template.Symbol = std::string(Symbols[s % 8]) + std::to_string(s / 8);
+        Template.ChartNumber = s + 1;
+        Template.SecondsPerBar = 60;
+        Template.Delta = true;
+        Template.CVD = true;
+        Template.VWAP = s % 2 == 0;
+        Template.EMAPeriods[0] = 9;
+        Template.EMAPeriods[1] = s % 2 == 0 ? 21 : 0;
+        Template.CollectedAt = "2026-10-17 14:30:00";
+
+        double Price = 4000.0 + s;
+        long long TimeMs = 45000LL * 86400000;
+        Stream->History.resize((size_t)Batches * Bars);
+        for (s_RawBar& Bar : Stream->History)
+        {
+            double Open = Price;
+            Price += Step(Random);
+            Bar.TimeMs = TimeMs;
+            Bar.Open = (float)Open;
+            Bar.Close = (float)Price;
+            Bar.High = (float)std::max(Open, Price) + 0.25f;
+            Bar.Low = (float)std::min(Open, Price) - 0.25f;
+            Bar.Volume = (float)(Random() % 5000);
+            Bar.BidVolume = (float)(Random() % 2500);
+            Bar.AskVolume = Bar.Volume - Bar.BidVolume;
+            Bar.Trades = (int)(Random() % 900);
+            Bar.HasCalcs = true;
+            Bar.Delta = Bar.AskVolume - Bar.BidVolume;
+            Bar.CVD = Bar.Delta * 3;
+            Bar.VWAP = Price - 0.5;
+            Bar.VWAPUpper = Price + 2.0;
+            Bar.VWAPLower = Price - 3.0;
+            Bar.EMA[0] = Price - 0.1;
+            Bar.EMA[1] = Price - 0.3;
+            TimeMs += 60000;
+        }
+        Streams.push_back(std::move(Stream));
+    }
+}
+
+// The chart thread's part: copy one batch of raw bars
+static std::shared_ptr<s_RawBarBatch> Capture(const s_Stream& Stream, int Batch, int Bars)
+{
+    std::shared_ptr<s_RawBarBatch> Out = std::make_shared<s_RawBarBatch>(Stream.Template);
+    Out->DataSource = "bench:" + std::to_string(Batch);
+    Out->Bars.assign(Stream.History.begin() + (size_t)Batch * Bars, Stream.History.begin() + (size_t)(Batch + 1) * Bars);
+    return Out;
+}
+
+// The body of a stream's next batch must carry its batch number
+static bool InOrder(const std::string& Body, int Batch)
+{
+    std::string Tag = "\"source\":\"bench:" + std::to_string(Batch) + "\"";
+    size_t From = Body.size() > 200 ? Body.size() - 200 : 0;
+    return Body.find(Tag, From) != std::string::npos;
+}
+
+static s_Result RunInline(std::vector<std::unique_ptr<s_Stream>>& Streams, int Batches, int Bars)
+{
+    s_Result Result;
+    std::string Body;
+    Clock::time_point Start = Clock::now();
+    for (int b = 0; b < Batches; b++)
+    {
+        for (std::unique_ptr<s_Stream>& Stream : Streams)
+        {
+            Clock::time_point Submitted = Clock::now();
+            std::shared_ptr<s_RawBarBatch> Batch = Capture(*Stream, b, Bars);
+            Body.clear();
+            EncodeTradeFlowBatch(*Batch, Body);
+            Result.Bytes += Body.size();
+            Result.LatencyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - Submitted).count());
+        }
+    }
+    Result.Seconds = std::chrono::duration<double>(Clock::now() - Start).count();
+    return Result;
+}
+
+static s_Result RunPool(std::vector<std::unique_ptr<s_Stream>>& Streams, int Batches, int Bars, int Threads, int Window)
+{
+    s_Result Result;
+    c_EncoderPool Pool;
+    Pool.Start(Threads);
+    for (std::unique_ptr<s_Stream>& Stream : Streams)
+    {
+        Stream->Encoder = c_EncoderStream();
+        Stream->Submitted = 0;
+        Stream->Received = 0;
+        Stream->SubmitTimes.assign((size_t)Batches, Clock::time_point());
+    }
+
+    size_t Total = Streams.size() * (size_t)Batches;
+    size_t Done = 0;
+    std::string Body;
+    uint64_t Ticket = 0;
+    Clock::time_point Start = Clock::now();
+    while (Done < Total)
+    {
+        bool Idle = true;
+        for (std::unique_ptr<s_Stream>& Stream : Streams)
+        {
+            while (Stream->Encoder.Poll(Body, Ticket))
+            {
+                Result.LatencyUs.push_back(std::chrono::duration<double, std::micro>(
+                    Clock::now() - Stream->SubmitTimes[(size_t)Stream->Received]).count());
+                Result.Ordered = Result.Ordered && InOrder(Body, Stream->Received);
+                Result.Bytes += Body.size();
+                Stream->Received++;
+                Done++;
+                Idle = false;
+            }
+            if (Stream->Submitted < Batches && Stream->Submitted - Stream->Received < Window)
+            {
+                int Batch = Stream->Submitted++;
+                Stream->SubmitTimes[(size_t)Batch] = Clock::now();
+                std::shared_ptr<s_RawBarBatch> Raw = Capture(*Stream, Batch, Bars);
+                Stream->Encoder.Submit(Pool, [Raw](std::string& Buffer) { EncodeTradeFlowBatch(*Raw, Buffer); });
+                Idle = false;
+            }
+        }
+        if (Idle)
+            std::this_thread::yield();
+    }
+    Result.Seconds = std::chrono::duration<double>(Clock::now() - Start).count();
+
+    Result.Stolen = Pool.GetStats().Stolen;
+    Pool.Stop();
+    return Result;
+}
+
+static void Print(const char* Label, s_Result& Result, size_t Bars, double Baseline)
+{
+    double BarsPerSec = Bars / Result.Seconds;
+    printf("%-10s %12.0f %9.1f %8.2fx %10.0f %10.0f %8zu %s\n", Label, BarsPerSec, Result.Bytes / Result.Seconds / 1e6,
+        Baseline > 0 ? BarsPerSec / Baseline : 1.0, Percentile(Result.LatencyUs, 50), Percentile(Result.LatencyUs, 99),
+        Result.Stolen, Result.Ordered ? "" : "OUT OF ORDER");
+}
+
+int main(int argc, char** argv)
+{
+    int StreamCount = argc > 1 ? atoi(argv[1]) : 64;
+    int Batches = argc > 2 ? atoi(argv[2]) : 200;
+    int Bars = argc > 3 ? atoi(argv[3]) : 100;
+    int MaxThreads = argc > 4 ? atoi(argv[4]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    int Window = argc > 5 ? atoi(argv[5]) : 4;
+
+    std::vector<std::unique_ptr<s_Stream>> Streams;
+    MakeStreams(Streams, StreamCount, Batches, Bars);
+    size_t TotalBars = (size_t)StreamCount * Batches * Bars;
+    printf("%d streams x %d batches x %d bars, window %d, %u hardware threads\n\n", StreamCount, Batches, Bars, Window,
+        std::thread::hardware_concurrency());
+    printf("%-10s %12s %9s %9s %10s %10s %8s\n", "threads", "bars/s", "MB/s", "speedup", "p50 us", "p99 us", "stolen");
+
+    s_Result Inline = RunInline(Streams, Batches, Bars);
+    double Baseline = TotalBars / Inline.Seconds;
+    Print("inline", Inline, TotalBars, 0);
+
+    std::vector<int> Counts;
+    for (int t = 1; t < MaxThreads; t *= 2)
+        Counts.push_back(t);
+    Counts.push_back(MaxThreads);
+    for (int Threads : Counts)
+    {
+        s_Result Result = RunPool(Streams, Batches, Bars, Threads, Window);
+        Print(std::to_string(Threads).c_str(), Result, TotalBars, Baseline);
+    }
+    return 0;
+}
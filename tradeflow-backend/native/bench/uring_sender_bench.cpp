@@ -0,0 +1,347 @@
+// io_uring sender and spool vs. thread-per-connection on loopback
+//
+// Starts a minimal keep-alive HTTP responder on 127.0.0.1, then sends the same
+// workload twice: Streams collector streams, each posting Requests batches of
+// BodyBytes one at a time (waiting for every response, like the collector) and
+// appending each batch to a spool file first. The uring run drives every
+// stream from one thread through c_UringLoop; the baseline gives every stream
+// its own thread with blocking send/recv and pwrite. A third run sends the
+// body as ~320-byte slices (one encoded bar each) referenced in place with
+// vectored writes instead of copying it into a staging buffer. Reports
+// throughput, per-request latency and the number of submission syscalls.
+//
+// Build (from tradeflow-backend/):
+//   c++ -O3 -std=c++17 -pthread -Inative native/bench/uring_sender_bench.cpp -o uring_sender_bench
+// Run:
+//   ./uring_sender_bench [streams=256] [requests=200] [body_bytes=32768] [server_threads=2] [spool=/tmp/uring_bench.spool]
+// A spool path of "-" leaves the spool out of both runs.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#include "uring.h"
+
+using namespace n_TradeFlow;
+typedef std::chrono::steady_clock Clock;
+
+static const char RESPONSE[] =
+    "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 20\r\n\r\n{\"status\":\"success\"}";
+
+static double Percentile(std::vector<double>& Samples, double P)
+{
+    if (Samples.empty())
+        return 0.0;
+    size_t Rank = (size_t)(P / 100.0 * (Samples.size() - 1));
+    std::nth_element(Samples.begin(), Samples.begin() + Rank, Samples.end());
+    return Samples[Rank];
+}
+
+// Complete requests at the front of Buffer are answered and removed
+static bool ServeBuffered(int Fd, std::string& Buffer)
+{
+    for (;;)
+    {
+        size_t End = Buffer.find("\r\n\r\n");
+        if (End == std::string::npos)
+            return true;
+        size_t Length = 0;
+        size_t Header = Buffer.find("Content-Length: ");
+        if (Header != std::string::npos && Header < End)
+            Length = (size_t)strtoull(Buffer.c_str() + Header + 16, nullptr, 10);
+        if (Buffer.size() < End + 4 + Length)
+            return true;
+        Buffer.erase(0, End + 4 + Length);
+        if (send(Fd, RESPONSE, sizeof(RESPONSE) - 1, MSG_NOSIGNAL) != (ssize_t)(sizeof(RESPONSE) - 1))
+            return false;
+    }
+}
+
+static void ServerThread(int Listener, std::atomic<bool>* Stop)
+{
+    int Poll = epoll_create1(0);
+    epoll_event Event;
+    Event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    Event.data.fd = Listener;
+    epoll_ctl(Poll, EPOLL_CTL_ADD, Listener, &Event);
+
+    std::unordered_map<int, std::string> Buffers;
+    std::vector<epoll_event> Ready(256);
+    std::vector<char> Chunk(65536);
+    while (!Stop->load())
+    {
+        int Count = epoll_wait(Poll, Ready.data(), (int)Ready.size(), 50);
+        for (int e = 0; e < Count; e++)
+        {
+            int Fd = Ready[e].data.fd;
+            if (Fd == Listener)
+            {
+                int Client = accept4(Listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (Client < 0)
+                    continue;
+                int One = 1;
+                setsockopt(Client, IPPROTO_TCP, TCP_NODELAY, &One, sizeof(One));
+                Event.events = EPOLLIN;
+                Event.data.fd = Client;
+                epoll_ctl(Poll, EPOLL_CTL_ADD, Client, &Event);
+                Buffers[Client].clear();
+                continue;
+            }
+
+            std::string& Buffer = Buffers[Fd];
+            bool Open = true;
+            for (;;)
+            {
+                ssize_t Received = recv(Fd, Chunk.data(), Chunk.size(), 0);
+                if (Received > 0)
+                {
+                    Buffer.append(Chunk.data(), (size_t)Received);
+                    continue;
+                }
+                Open = Received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+                break;
+            }
+            if (!Open || !ServeBuffered(Fd, Buffer))
+            {
+                epoll_ctl(Poll, EPOLL_CTL_DEL, Fd, nullptr);
+                close(Fd);
+                Buffers.erase(Fd);
+            }
+        }
+    }
+    for (auto& Entry : Buffers)
+        close(Entry.first);
+    close(Poll);
+}
+
+static std::string MakeBody(size_t Bytes)
+{
+    std::string Body = "{\"data\":[";
+    while (Body.size() + 2 < Bytes)
+        Body += "{\"open\":4064.25,\"high\":4065.00,\"low\":4063.75,\"close\":4064.50,\"volume\":454},";
+    Body.resize(Bytes - 2);
+    Body += "]}";
+    return Body;
+}
+
+struct s_Result
+{
+    double Seconds = 0;
+    std::vector<double> Latency;
+    size_t Failed = 0;
+    size_t Syscalls = 0;
+};
+
+static void Report(const char* Label, s_Result& Result, int Streams, int Requests, size_t BodyBytes)
+{
+    double Total = (double)Streams * Requests;
+    printf("%-10s %8.0f req/s %7.1f MB/s  p50=%7.1fus p99=%8.1fus  failed=%zu  submit syscalls=%zu\n",
+        Label, Total / Result.Seconds, Total * BodyBytes / Result.Seconds / 1e6,
+        Percentile(Result.Latency, 50), Percentile(Result.Latency, 99), Result.Failed, Result.Syscalls);
+}
+
+static const size_t BAR_BYTES = 320;
+
+static s_Result RunUring(int Port, int Streams, int Requests, const std::string& Body, const std::string& SpoolPath, bool Gather)
+{
+    s_Result Result;
+    c_UringLoop Loop;
+    if (!Loop.Open(1024, (size_t)Streams * 4, Body.size() + 512))
+    {
+        fprintf(stderr, "io_uring unavailable: %s\n", strerror(errno));
+        exit(1);
+    }
+    c_UringSender Sender(Loop, "http://127.0.0.1:" + std::to_string(Port) + "/api/v1/market-data");
+    c_UringSpool Spool(Loop);
+    bool UseSpool = SpoolPath != "-";
+    unlink(SpoolPath.c_str());
+    if (UseSpool && !Spool.Open(SpoolPath))
+    {
+        fprintf(stderr, "cannot open spool %s\n", SpoolPath.c_str());
+        exit(1);
+    }
+
+    std::vector<s_UringSlice> Slices;
+    for (size_t Offset = 0; Offset < Body.size(); Offset += BAR_BYTES)
+        Slices.push_back({ Body.data() + Offset, std::min(BAR_BYTES, Body.size() - Offset) });
+
+    std::vector<int> Sent((size_t)Streams, 0);
+    std::vector<Clock::time_point> StartedAt((size_t)Streams);
+    size_t Done = 0;
+    Result.Latency.reserve((size_t)Streams * Requests);
+
+    std::function<void(int)> SendNext = [&](int Stream)
+    {
+        Sent[(size_t)Stream]++;
+        StartedAt[(size_t)Stream] = Clock::now();
+        if (UseSpool)
+            Spool.Append(Body.data(), Body.size());
+        auto OnResponse = [&, Stream](const s_UringResponse& Response)
+        {
+            Result.Latency.push_back(std::chrono::duration<double, std::micro>(Clock::now() - StartedAt[(size_t)Stream]).count());
+            if (Response.Status != 200)
+                Result.Failed++;
+            Done++;
+            if (Sent[(size_t)Stream] < Requests)
+                SendNext(Stream);
+        };
+        if (Gather)
+            Sender.Post(Stream, "/batch", Slices.data(), Slices.size(), OnResponse);
+        else
+            Sender.Post(Stream, "/batch", Body.data(), Body.size(), OnResponse);
+    };
+
+    Clock::time_point Before = Clock::now();
+    for (int s = 0; s < Streams; s++)
+    {
+        Sender.AddConnection();
+        SendNext(s);
+    }
+    while (Done < (size_t)Streams * Requests)
+    {
+        if (Loop.Run(1) < 0)
+            break;
+    }
+    Result.Seconds = std::chrono::duration<double>(Clock::now() - Before).count();
+    Result.Syscalls = Loop.GetStats().Submits;
+
+    printf("uring%s: %zu SQEs in %zu submits (%.1f per call), %zu fixed / %zu plain / %zu gather writes, registered buffers: %s, spool %.1f MB\n",
+        Gather ? " gather" : "", Loop.GetStats().Submitted, Loop.GetStats().Submits,
+        (double)Loop.GetStats().Submitted / std::max<size_t>(1, Loop.GetStats().Submits), Loop.GetStats().FixedWrites,
+        Loop.GetStats().PlainWrites, Loop.GetStats().GatherWrites, Loop.HasRegisteredBuffers() ? "yes" : "no", Spool.Size() / 1e6);
+    return Result;
+}
+
+static s_Result RunThreads(int Port, int Streams, int Requests, const std::string& Body, const std::string& SpoolPath)
+{
+    s_Result Result;
+    unlink(SpoolPath.c_str());
+    int Spool = SpoolPath != "-" ? open(SpoolPath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644) : -1;
+    std::atomic<uint64_t> SpoolTail(0);
+    std::atomic<size_t> Failed(0);
+    std::vector<std::vector<double>> Latency((size_t)Streams);
+
+    std::string Wire = "POST /api/v1/market-data/batch HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Type: application/json\r\nContent-Length: "
+        + std::to_string(Body.size()) + "\r\n\r\n" + Body;
+
+    Clock::time_point Before = Clock::now();
+    std::vector<std::thread> Threads;
+    for (int s = 0; s < Streams; s++)
+    {
+        Threads.emplace_back([&, s]()
+        {
+            sockaddr_in Address;
+            memset(&Address, 0, sizeof(Address));
+            Address.sin_family = AF_INET;
+            Address.sin_port = htons((uint16_t)Port);
+            Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            int Fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int One = 1;
+            setsockopt(Fd, IPPROTO_TCP, TCP_NODELAY, &One, sizeof(One));
+            if (connect(Fd, (const sockaddr*)&Address, sizeof(Address)) != 0)
+            {
+                Failed += (size_t)Requests;
+                close(Fd);
+                return;
+            }
+
+            std::vector<char> Chunk(URING_RECV_BYTES);
+            std::string Response;
+            Latency[(size_t)s].reserve((size_t)Requests);
+            for (int r = 0; r < Requests; r++)
+            {
+                Clock::time_point Start = Clock::now();
+                if (Spool >= 0)
+                    pwrite(Spool, Body.data(), Body.size(), (off_t)SpoolTail.fetch_add(Body.size()));
+                size_t Sent = 0;
+                while (Sent < Wire.size())
+                {
+                    ssize_t n = send(Fd, Wire.data() + Sent, Wire.size() - Sent, MSG_NOSIGNAL);
+                    if (n <= 0)
+                        break;
+                    Sent += (size_t)n;
+                }
+                Response.clear();
+                size_t End = std::string::npos;
+                while (End == std::string::npos || Response.size() < End + 4 + 20)
+                {
+                    ssize_t n = recv(Fd, Chunk.data(), Chunk.size(), 0);
+                    if (n <= 0)
+                        break;
+                    Response.append(Chunk.data(), (size_t)n);
+                    End = Response.find("\r\n\r\n");
+                }
+                if (Sent < Wire.size() || Response.compare(0, 12, "HTTP/1.1 200") != 0)
+                    Failed++;
+                Latency[(size_t)s].push_back(std::chrono::duration<double, std::micro>(Clock::now() - Start).count());
+            }
+            close(Fd);
+        });
+    }
+    for (std::thread& Thread : Threads)
+        Thread.join();
+    Result.Seconds = std::chrono::duration<double>(Clock::now() - Before).count();
+    if (Spool >= 0)
+        close(Spool);
+
+    for (std::vector<double>& Samples : Latency)
+        Result.Latency.insert(Result.Latency.end(), Samples.begin(), Samples.end());
+    Result.Failed = Failed.load();
+    Result.Syscalls = (size_t)Streams * Requests * 3;   // pwrite + send + recv, at least
+    return Result;
+}
+
+int main(int argc, char** argv)
+{
+    int Streams = argc > 1 ? atoi(argv[1]) : 256;
+    int Requests = argc > 2 ? atoi(argv[2]) : 200;
+    size_t BodyBytes = argc > 3 ? (size_t)atoll(argv[3]) : 32768;
+    int ServerThreads = argc > 4 ? atoi(argv[4]) : 2;
+    std::string SpoolPath = argc > 5 ? argv[5] : "/tmp/uring_bench.spool";
+
+    int Listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int One = 1;
+    setsockopt(Listener, SOL_SOCKET, SO_REUSEADDR, &One, sizeof(One));
+    sockaddr_in Address;
+    memset(&Address, 0, sizeof(Address));
+    Address.sin_family = AF_INET;
+    Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t Length = sizeof(Address);
+    if (bind(Listener, (const sockaddr*)&Address, sizeof(Address)) != 0 || listen(Listener, 4096) != 0
+        || getsockname(Listener, (sockaddr*)&Address, &Length) != 0)
+    {
+        fprintf(stderr, "cannot listen on loopback: %s\n", strerror(errno));
+        return 1;
+    }
+    int Port = ntohs(Address.sin_port);
+
+    std::atomic<bool> Stop(false);
+    std::vector<std::thread> Server;
+    for (int t = 0; t < ServerThreads; t++)
+        Server.emplace_back(ServerThread, Listener, &Stop);
+
+    std::string Body = MakeBody(BodyBytes);
+    printf("streams=%d requests/stream=%d body=%zu bytes server_threads=%d cpus=%u\n",
+        Streams, Requests, BodyBytes, ServerThreads, std::thread::hardware_concurrency());
+
+    s_Result Uring = RunUring(Port, Streams, Requests, Body, SpoolPath, false);
+    s_Result Gather = RunUring(Port, Streams, Requests, Body, SpoolPath, true);
+    s_Result Threads = RunThreads(Port, Streams, Requests, Body, SpoolPath);
+    Report("io_uring", Uring, Streams, Requests, BodyBytes);
+    Report("gather", Gather, Streams, Requests, BodyBytes);
+    Report("threads", Threads, Streams, Requests, BodyBytes);
+
+    Stop = true;
+    for (std::thread& Thread : Server)
+        Thread.join();
+    close(Listener);
+    unlink(SpoolPath.c_str());
+    return 0;
+}
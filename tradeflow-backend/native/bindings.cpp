@@ -0,0 +1,781 @@
+// TradeFlow Pro native extension module (tradeflow_native)
+// Python bindings for the native engines, loaded through app.core.native
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+
+#include "alerts.h"
+#include "barstore.h"
+#include "broadcaster.h"
+#include "calendar.h"
+#include "catalog.h"
+#include "downsample.h"
+#include "footprint.h"
+#include "indicators.h"
+#include "pyramid.h"
+#include "readcache.h"
+#include "reorder.h"
+#include "tpo.h"
+
+namespace py = pybind11;
+using namespace n_TradeFlow;
+
+typedef py::array_t<double, py::array::c_style | py::array::forcecast> DoubleArray;
+
+static DoubleArray NewArray(size_t Count)
+{
+    return DoubleArray((py::ssize_t)Count);
+}
+
+static void BindIndicators(py::module_& m)
+{
+    // Streaming states
+    py::class_<s_SMAState>(m, "SMA")
+        .def(py::init<int>(), py::arg("period") = 14)
+        .def("update", &s_SMAState::Update)
+        .def("reset", &s_SMAState::Reset)
+        .def_property_readonly("ready", &s_SMAState::IsReady);
+
+    py::class_<s_EMAState>(m, "EMA")
+        .def(py::init<int>(), py::arg("period") = 14)
+        .def("update", &s_EMAState::Update)
+        .def("reset", &s_EMAState::Reset)
+        .def_property_readonly("ready", &s_EMAState::IsReady);
+
+    py::class_<s_RSIState>(m, "RSI")
+        .def(py::init<int>(), py::arg("period") = 14)
+        .def("update", &s_RSIState::Update)
+        .def("reset", &s_RSIState::Reset)
+        .def_property_readonly("ready", &s_RSIState::IsReady);
+
+    py::class_<s_MACDState>(m, "MACD")
+        .def(py::init<int, int, int>(), py::arg("fast") = 12, py::arg("slow") = 26, py::arg("signal") = 9)
+        .def("update", [](s_MACDState& State, double Close)
+        {
+            s_MACDValue Value = State.Update(Close);
+            return py::make_tuple(Value.MACD, Value.Signal, Value.Histogram);
+        })
+        .def("reset", &s_MACDState::Reset)
+        .def_property_readonly("ready", &s_MACDState::IsReady);
+
+    py::class_<s_BollingerState>(m, "Bollinger")
+        .def(py::init<int, double>(), py::arg("period") = 20, py::arg("std_dev") = 2.0)
+        .def("update", [](s_BollingerState& State, double Close)
+        {
+            s_BollingerValue Value = State.Update(Close);
+            return py::make_tuple(Value.Upper, Value.Middle, Value.Lower);
+        })
+        .def("reset", &s_BollingerState::Reset)
+        .def_property_readonly("ready", &s_BollingerState::IsReady);
+
+    py::class_<s_ATRState>(m, "ATR")
+        .def(py::init<int>(), py::arg("period") = 14)
+        .def("update", &s_ATRState::Update, py::arg("high"), py::arg("low"), py::arg("close"))
+        .def("reset", &s_ATRState::Reset)
+        .def_property_readonly("ready", &s_ATRState::IsReady);
+
+    // Batch kernels (oldest-first float64 arrays in, same-length arrays out, NaN during warm-up)
+    m.def("sma", [](DoubleArray Closes, int Period)
+    {
+        DoubleArray Out = NewArray(Closes.size());
+        BatchSMA(Closes.data(), Closes.size(), Period, Out.mutable_data());
+        return Out;
+    }, py::arg("closes"), py::arg("period"));
+
+    m.def("ema", [](DoubleArray Closes, int Period)
+    {
+        DoubleArray Out = NewArray(Closes.size());
+        BatchEMA(Closes.data(), Closes.size(), Period, Out.mutable_data());
+        return Out;
+    }, py::arg("closes"), py::arg("period"));
+
+    m.def("rsi", [](DoubleArray Closes, int Period)
+    {
+        DoubleArray Out = NewArray(Closes.size());
+        BatchRSI(Closes.data(), Closes.size(), Period, Out.mutable_data());
+        return Out;
+    }, py::arg("closes"), py::arg("period") = 14);
+
+    m.def("macd", [](DoubleArray Closes, int Fast, int Slow, int Signal)
+    {
+        size_t Count = Closes.size();
+        DoubleArray Line = NewArray(Count), SignalLine = NewArray(Count), Histogram = NewArray(Count);
+        BatchMACD(Closes.data(), Count, Fast, Slow, Signal,
+            Line.mutable_data(), SignalLine.mutable_data(), Histogram.mutable_data());
+        return py::make_tuple(Line, SignalLine, Histogram);
+    }, py::arg("closes"), py::arg("fast") = 12, py::arg("slow") = 26, py::arg("signal") = 9);
+
+    m.def("bollinger", [](DoubleArray Closes, int Period, double StdDev)
+    {
+        size_t Count = Closes.size();
+        DoubleArray Upper = NewArray(Count), Middle = NewArray(Count), Lower = NewArray(Count);
+        BatchBollinger(Closes.data(), Count, Period, StdDev,
+            Upper.mutable_data(), Middle.mutable_data(), Lower.mutable_data());
+        return py::make_tuple(Upper, Middle, Lower);
+    }, py::arg("closes"), py::arg("period") = 20, py::arg("std_dev") = 2.0);
+
+    m.def("atr", [](DoubleArray Highs, DoubleArray Lows, DoubleArray Closes, int Period)
+    {
+        size_t Count = Closes.size();
+        if ((size_t)Highs.size() != Count || (size_t)Lows.size() != Count)
+            throw std::invalid_argument("highs, lows and closes must have the same length");
+        DoubleArray Out = NewArray(Count);
+        BatchATR(Highs.data(), Lows.data(), Closes.data(), Count, Period, Out.mutable_data());
+        return Out;
+    }, py::arg("highs"), py::arg("lows"), py::arg("closes"), py::arg("period") = 14);
+
+    // Warm indicator streams: one state plus a ring of its recent outputs
+    py::class_<c_IndicatorStream>(m, "IndicatorStream")
+        .def(py::init([](const std::string& Name, const std::vector<double>& Params, size_t Capacity)
+        {
+            e_IndicatorKind Kind;
+            if (!ParseIndicatorKind(Name, Kind))
+                throw std::invalid_argument("unknown indicator: " + Name);
+            return new c_IndicatorStream(Kind, Params, Capacity);
+        }), py::arg("kind"), py::arg("params"), py::arg("capacity") = 5000)
+        .def("update", &c_IndicatorStream::Update,
+            py::arg("time"), py::arg("high"), py::arg("low"), py::arg("close"))
+        .def("update_many", [](c_IndicatorStream& Stream, py::array_t<int64_t, py::array::c_style | py::array::forcecast> Times,
+            DoubleArray Highs, DoubleArray Lows, DoubleArray Closes)
+        {
+            size_t Count = Times.size();
+            if ((size_t)Highs.size() != Count || (size_t)Lows.size() != Count || (size_t)Closes.size() != Count)
+                throw std::invalid_argument("times, highs, lows and closes must have the same length");
+            size_t Accepted = 0;
+            for (size_t i = 0; i < Count; i++)
+                Accepted += Stream.Update(Times.data()[i], Highs.data()[i], Lows.data()[i], Closes.data()[i]);
+            return Accepted;
+        }, py::arg("times"), py::arg("highs"), py::arg("lows"), py::arg("closes"))
+        .def("tail", [](const c_IndicatorStream& Stream, size_t N)
+        {
+            const s_SeriesBuffer& History = Stream.GetHistory();
+            if (N > History.Count)
+                N = History.Count;
+            py::array_t<int64_t> Times((py::ssize_t)N);
+            DoubleArray Values({ (py::ssize_t)N, (py::ssize_t)History.Width });
+            History.CopyTail(N, Times.mutable_data(), Values.mutable_data());
+            return py::make_tuple(Times, Values);
+        }, py::arg("n"))
+        .def_property_readonly("size", [](const c_IndicatorStream& Stream) { return Stream.GetHistory().Count; })
+        .def_property_readonly("width", [](const c_IndicatorStream& Stream) { return Stream.GetHistory().Width; })
+        .def_property_readonly("last_time", [](const c_IndicatorStream& Stream) { return Stream.GetHistory().LastTime(); });
+}
+
+typedef c_FanoutBroadcaster<py::object> PyBroadcaster;
+
+static void BindBroadcaster(py::module_& m)
+{
+    // Payloads are the already-encoded Python str objects, so each message is
+    // serialized once and shared by reference across all subscriber queues
+    py::class_<PyBroadcaster>(m, "Broadcaster")
+        .def(py::init<size_t>(), py::arg("queue_capacity") = 256)
+        .def("add_connection", &PyBroadcaster::AddConnection, py::arg("queue_capacity") = 0)
+        .def("remove_connection", &PyBroadcaster::RemoveConnection, py::arg("connection_id"))
+        .def("subscribe", &PyBroadcaster::Subscribe, py::arg("connection_id"), py::arg("symbol"))
+        .def("unsubscribe", &PyBroadcaster::Unsubscribe, py::arg("connection_id"), py::arg("symbol"))
+        .def("publish", [](PyBroadcaster& Broadcaster, const std::string& Symbol, py::object Payload,
+            const std::string& MessageType, bool Conflate)
+        {
+            std::vector<uint32_t> Woken;
+            Broadcaster.Publish(Symbol, MessageType, Payload, Woken, Conflate);
+            return Woken;
+        }, py::arg("symbol"), py::arg("payload"), py::arg("message_type") = "", py::arg("conflate") = true)
+        .def("drain", [](PyBroadcaster& Broadcaster, uint32_t Id, size_t Max)
+        {
+            std::vector<py::object> Out;
+            Broadcaster.Drain(Id, Max, Out);
+            py::list Result(Out.size());
+            for (size_t i = 0; i < Out.size(); i++)
+                Result[i] = std::move(Out[i]);
+            return Result;
+        }, py::arg("connection_id"), py::arg("max_messages") = 64)
+        .def("pending", &PyBroadcaster::Pending, py::arg("connection_id"))
+        .def("stats", [](PyBroadcaster& Broadcaster)
+        {
+            s_BroadcastStats Stats = Broadcaster.GetStats();
+            py::dict Result;
+            Result["published"] = Stats.Published;
+            Result["enqueued"] = Stats.Enqueued;
+            Result["conflated"] = Stats.Conflated;
+            Result["dropped"] = Stats.Dropped;
+            Result["delivered"] = Stats.Delivered;
+            Result["connections"] = Stats.Connections;
+            return Result;
+        });
+}
+
+static e_AlertOperator AlertOperatorFromString(const std::string& Text)
+{
+    e_AlertOperator Operator;
+    if (!ParseAlertOperator(Text, Operator))
+        throw std::invalid_argument("unknown alert operator: " + Text);
+    return Operator;
+}
+
+static void BindAlerts(py::module_& m)
+{
+    py::class_<c_AlertEngine>(m, "AlertEngine")
+        .def(py::init<>())
+        .def("upsert", [](c_AlertEngine& Engine, int64_t Id, const std::string& Symbol,
+            const std::string& Operator, double Target, bool OneShot)
+        {
+            Engine.Upsert(Id, Symbol, AlertOperatorFromString(Operator), Target, OneShot);
+        }, py::arg("alert_id"), py::arg("symbol"), py::arg("operator"), py::arg("price"), py::arg("one_shot") = true)
+        .def("load", [](c_AlertEngine& Engine, const std::vector<int64_t>& Ids, const std::vector<std::string>& Symbols,
+            const std::vector<std::string>& Operators, const std::vector<double>& Targets, const std::vector<bool>& OneShots)
+        {
+            // Bulk sync from the alerts table: replaces everything currently loaded
+            size_t Count = Ids.size();
+            if (Symbols.size() != Count || Operators.size() != Count || Targets.size() != Count || OneShots.size() != Count)
+                throw std::invalid_argument("alert columns must have the same length");
+            Engine.Clear();
+            for (size_t i = 0; i < Count; i++)
+                Engine.Upsert(Ids[i], Symbols[i], AlertOperatorFromString(Operators[i]), Targets[i], OneShots[i]);
+            return Engine.Size();
+        }, py::arg("ids"), py::arg("symbols"), py::arg("operators"), py::arg("prices"), py::arg("one_shots"))
+        .def("remove", &c_AlertEngine::Remove, py::arg("alert_id"))
+        .def("clear", &c_AlertEngine::Clear)
+        .def("process_trade", [](c_AlertEngine& Engine, const std::string& Symbol, double Price)
+        {
+            std::vector<int64_t> Fired;
+            Engine.ProcessTrade(Symbol, Price, Fired);
+            return Fired;
+        }, py::arg("symbol"), py::arg("price"))
+        .def("process_bar", [](c_AlertEngine& Engine, const std::string& Symbol, double High, double Low)
+        {
+            std::vector<int64_t> Fired;
+            Engine.ProcessBar(Symbol, High, Low, Fired);
+            return Fired;
+        }, py::arg("symbol"), py::arg("high"), py::arg("low"))
+        .def("__len__", &c_AlertEngine::Size);
+}
+
+static void BindFootprint(py::module_& m)
+{
+    py::class_<c_FootprintStore>(m, "FootprintStore")
+        .def(py::init<double, const std::vector<int>&, size_t, size_t>(),
+            py::arg("tick_size"), py::arg("timeframes"), py::arg("ring_bars") = 1000, py::arg("archive_bars") = 20000)
+        .def("add", &c_FootprintStore::Add,
+            py::arg("symbol"), py::arg("time"), py::arg("price"), py::arg("volume"),
+            py::arg("bid_volume"), py::arg("ask_volume"))
+        .def("covered_from", [](const c_FootprintStore& Store, const std::string& Symbol, int Seconds) -> py::object
+        {
+            int64_t Time = Store.CoveredFrom(Symbol, Seconds);
+            if (Time == FOOTPRINT_NOT_COVERED)
+                return py::none();
+            return py::int_(Time);
+        }, py::arg("symbol"), py::arg("timeframe_seconds"))
+        .def("query", [](const c_FootprintStore& Store, const std::string& Symbol, int Seconds, int64_t StartTime, int64_t EndTime)
+        {
+            // Newest bar first and highest price first, like the SQL path
+            s_FootprintColumns Columns;
+            Store.Query(Symbol, Seconds, StartTime, EndTime, Columns);
+
+            size_t Bars = Columns.BarCount();
+            py::list Result(Bars);
+            for (size_t b = 0; b < Bars; b++)
+            {
+                size_t Begin = Columns.LevelStart[b], End = Columns.LevelStart[b + 1];
+                py::list Levels(End - Begin);
+                for (size_t l = End; l > Begin; l--)
+                {
+                    py::dict Level;
+                    Level["price"] = Store.ToPrice(Columns.LowTicks[b] + Columns.TickOffsets[l - 1]);
+                    Level["volume"] = Columns.Volume[l - 1];
+                    Level["bid_volume"] = Columns.BidVolume[l - 1];
+                    Level["ask_volume"] = Columns.AskVolume[l - 1];
+                    Levels[End - l] = Level;
+                }
+                Result[Bars - 1 - b] = py::make_tuple(Columns.Times[b], Levels);
+            }
+            return Result;
+        }, py::arg("symbol"), py::arg("timeframe_seconds"), py::arg("start_time"), py::arg("end_time"))
+        .def("stats", [](const c_FootprintStore& Store)
+        {
+            s_FootprintStats Stats = Store.GetStats();
+            py::dict Result;
+            Result["series"] = Stats.Series;
+            Result["ring_bars"] = Stats.RingBars;
+            Result["archived_bars"] = Stats.ArchivedBars;
+            Result["archived_bytes"] = Stats.ArchivedBytes;
+            return Result;
+        });
+}
+
+static py::dict BarColumnsToDict(const s_BarColumns& Columns)
+{
+    // One memcpy per column out of the mapped segments, oldest row first
+    size_t Count = Columns.Size();
+    py::dict Result;
+    py::array_t<int64_t> Times((py::ssize_t)Count);
+    if (Count > 0)
+        memcpy(Times.mutable_data(), Columns.Time.data(), Count * sizeof(int64_t));
+    Result["time"] = Times;
+    for (int c = 0; c < BAR_COLUMN_COUNT; c++)
+    {
+        DoubleArray Values = NewArray(Count);
+        if (Count > 0)
+            memcpy(Values.mutable_data(), Columns.Values[c].data(), Count * sizeof(double));
+        Result[BAR_COLUMN_NAMES[c]] = Values;
+    }
+    return Result;
+}
+
+static void BindBarStore(py::module_& m)
+{
+    py::class_<c_BarStore>(m, "BarStore")
+        .def(py::init([](const std::string& Root, int RetentionDays, const std::string& BaseTimeframe,
+            const std::vector<std::pair<std::string, int>>& Rollups)
+        {
+            std::vector<s_BarRollup> Configured;
+            for (const auto& Rollup : Rollups)
+                Configured.push_back({ Rollup.first, (int64_t)Rollup.second * 1000000 });
+            return new c_BarStore(Root, RetentionDays, BaseTimeframe, Configured);
+        }), py::arg("root"), py::arg("retention_days") = 0, py::arg("base_timeframe") = "1s",
+            py::arg("rollups") = std::vector<std::pair<std::string, int>>())
+        .def("append", [](c_BarStore& Store, const std::string& Symbol, const std::string& Timeframe, int64_t Time,
+            double Open, double High, double Low, double Close, double Volume,
+            std::optional<double> BidVolume, std::optional<double> AskVolume, std::optional<double> NumberOfTrades,
+            std::optional<double> OpenInterest, std::optional<double> Delta, std::optional<double> CVD,
+            std::optional<double> VWAP, std::optional<double> VWAPUpper, std::optional<double> VWAPLower)
+        {
+            s_BarRow Row;
+            Row.Time = Time;
+            Row.Values[BAR_OPEN] = Open;
+            Row.Values[BAR_HIGH] = High;
+            Row.Values[BAR_LOW] = Low;
+            Row.Values[BAR_CLOSE] = Close;
+            Row.Values[BAR_VOLUME] = Volume;
+            Row.Values[BAR_BID_VOLUME] = BidVolume.value_or(BAR_NULL);
+            Row.Values[BAR_ASK_VOLUME] = AskVolume.value_or(BAR_NULL);
+            Row.Values[BAR_NUMBER_OF_TRADES] = NumberOfTrades.value_or(BAR_NULL);
+            Row.Values[BAR_OPEN_INTEREST] = OpenInterest.value_or(BAR_NULL);
+            Row.Values[BAR_DELTA] = Delta.value_or(BAR_NULL);
+            Row.Values[BAR_CVD] = CVD.value_or(BAR_NULL);
+            Row.Values[BAR_VWAP] = VWAP.value_or(BAR_NULL);
+            Row.Values[BAR_VWAP_UPPER] = VWAPUpper.value_or(BAR_NULL);
+            Row.Values[BAR_VWAP_LOWER] = VWAPLower.value_or(BAR_NULL);
+            return Store.Append(Symbol, Timeframe, Row);
+        }, py::arg("symbol"), py::arg("timeframe"), py::arg("time"),
+            py::arg("open"), py::arg("high"), py::arg("low"), py::arg("close"), py::arg("volume"),
+            py::arg("bid_volume") = py::none(), py::arg("ask_volume") = py::none(),
+            py::arg("number_of_trades") = py::none(), py::arg("open_interest") = py::none(),
+            py::arg("delta") = py::none(), py::arg("cvd") = py::none(), py::arg("vwap") = py::none(),
+            py::arg("vwap_upper") = py::none(), py::arg("vwap_lower") = py::none())
+        .def("count", &c_BarStore::Count, py::arg("symbol"), py::arg("timeframe"))
+        .def("tail", [](c_BarStore& Store, const std::string& Symbol, const std::string& Timeframe, size_t N)
+        {
+            s_BarColumns Columns;
+            Store.Tail(Symbol, Timeframe, N, Columns);
+            return BarColumnsToDict(Columns);
+        }, py::arg("symbol"), py::arg("timeframe"), py::arg("n"))
+        .def("range", [](c_BarStore& Store, const std::string& Symbol, const std::string& Timeframe, int64_t StartTime, int64_t EndTime)
+        {
+            s_BarColumns Columns;
+            Store.Range(Symbol, Timeframe, StartTime, EndTime, Columns);
+            return BarColumnsToDict(Columns);
+        }, py::arg("symbol"), py::arg("timeframe"), py::arg("start_time"), py::arg("end_time"));
+}
+
+typedef c_VersionedCache<py::object> PyReadCache;
+
+static void BindReadCache(py::module_& m)
+{
+    // Payloads are the result objects themselves: a hit returns them by reference
+    // with no re-serialization
+    py::class_<PyReadCache>(m, "ReadCache")
+        .def(py::init<size_t>(), py::arg("max_cost"))
+        .def("version", &PyReadCache::Version, py::arg("stream"))
+        .def("bump", &PyReadCache::Bump, py::arg("stream"), py::arg("time"))
+        .def("lookup", [](PyReadCache& Cache, const std::string& Key) -> py::object
+        {
+            // None on a miss, else (payload, fresh, changed_from) where changed_from
+            // is the earliest change time since the entry, or None if unknown
+            s_ReadCacheLookup<py::object> Result;
+            if (!Cache.Lookup(Key, Result))
+                return py::none();
+            py::object ChangedFrom = Result.Extendable ? py::object(py::int_(Result.ChangedFrom)) : py::object(py::none());
+            return py::make_tuple(Result.Payload, Result.Fresh, ChangedFrom);
+        }, py::arg("key"))
+        .def("put", &PyReadCache::Put,
+            py::arg("key"), py::arg("stream"), py::arg("version"), py::arg("payload"), py::arg("cost") = 1)
+        .def("erase", &PyReadCache::Erase, py::arg("key"))
+        .def("clear", &PyReadCache::Clear)
+        .def("stats", [](const PyReadCache& Cache)
+        {
+            s_ReadCacheStats Stats = Cache.GetStats();
+            py::dict Result;
+            Result["hits"] = Stats.Hits;
+            Result["misses"] = Stats.Misses;
+            Result["stale"] = Stats.Stale;
+            Result["evictions"] = Stats.Evictions;
+            Result["entries"] = Stats.Entries;
+            Result["cost"] = Stats.Cost;
+            return Result;
+        });
+}
+
+typedef c_ReorderBuffer<py::object> PyReorderBuffer;
+
+static void BindReorder(py::module_& m)
+{
+    // Payloads are the caller's row objects, handed back unchanged on release
+    py::class_<PyReorderBuffer>(m, "ReorderBuffer")
+        .def(py::init([](int64_t MaxHold, size_t MaxBarsPerStream, size_t MaxStreams)
+        {
+            s_ReorderConfig Config;
+            Config.MaxHoldMicros = MaxHold;
+            Config.MaxBarsPerStream = std::max<size_t>(MaxBarsPerStream, 1);
+            Config.MaxStreams = std::max<size_t>(MaxStreams, 1);
+            return new PyReorderBuffer(Config);
+        }), py::arg("max_hold"), py::arg("max_bars_per_stream"), py::arg("max_streams"))
+        .def("push", [](PyReorderBuffer& Buffer, const std::string& Stream, int64_t Time, py::object Payload, int64_t Lateness, int64_t Now)
+        {
+            // 0 = buffered, 1 = replaced a buffered bar, 2 = late
+            return (int)Buffer.Push(Stream, Time, Payload, Lateness, Now);
+        }, py::arg("stream"), py::arg("time"), py::arg("payload"), py::arg("lateness"), py::arg("now"))
+        .def("expire", &PyReorderBuffer::Expire, py::arg("now"))
+        .def("flush", &PyReorderBuffer::Flush)
+        .def("drain", [](PyReorderBuffer& Buffer)
+        {
+            // (stream, time, payload) per released bar
+            std::vector<s_ReleasedBar<py::object>> Released;
+            Buffer.Drain(Released);
+            py::list Result(Released.size());
+            for (size_t i = 0; i < Released.size(); i++)
+                Result[i] = py::make_tuple(Released[i].Stream, Released[i].Time, Released[i].Payload);
+            return Result;
+        })
+        .def("stats", [](const PyReorderBuffer& Buffer)
+        {
+            s_ReorderStats Stats = Buffer.GetStats();
+            py::dict Result;
+            Result["streams"] = Stats.Streams;
+            Result["buffered"] = Stats.Buffered;
+            Result["pushed"] = Stats.Pushed;
+            Result["released"] = Stats.Released;
+            Result["reordered"] = Stats.Reordered;
+            Result["replaced"] = Stats.Replaced;
+            Result["late"] = Stats.Late;
+            Result["forced"] = Stats.Forced;
+            Result["expired"] = Stats.Expired;
+            return Result;
+        });
+}
+
+static void BindCalendar(py::module_& m)
+{
+    py::class_<c_SessionCalendar>(m, "SessionCalendar")
+        .def(py::init<int, int>(), py::arg("default_offset_seconds") = 0, py::arg("default_session_seconds") = 86400)
+        .def("set_default", &c_SessionCalendar::SetDefault, py::arg("offset_seconds"), py::arg("session_seconds"))
+        .def("define", &c_SessionCalendar::Define, py::arg("name"), py::arg("starts"), py::arg("ends"))
+        .def("has_calendar", &c_SessionCalendar::HasCalendar, py::arg("name"))
+        .def("assign", &c_SessionCalendar::Assign, py::arg("symbol"), py::arg("name"))
+        .def("locate", [](c_SessionCalendar& Calendar, const std::string& Symbol, int64_t Time, int64_t BarMicros) -> py::object
+        {
+            // (session index, start, end, in session, bar index, bar start), or None
+            s_SessionPosition Position;
+            if (!Calendar.Locate(Symbol, Time, BarMicros, Position))
+                return py::none();
+            return py::make_tuple(Position.Index, Position.Start, Position.End, Position.InSession, Position.Bar, Position.BarStart);
+        }, py::arg("symbol"), py::arg("time"), py::arg("bar_micros") = 0)
+        .def("stats", [](const c_SessionCalendar& Calendar)
+        {
+            s_CalendarStats Stats = Calendar.GetStats();
+            py::dict Result;
+            Result["calendars"] = Stats.Calendars;
+            Result["symbols"] = Stats.Symbols;
+            Result["sessions"] = Stats.Sessions;
+            Result["lookups"] = Stats.Lookups;
+            Result["hint_hits"] = Stats.HintHits;
+            Result["searches"] = Stats.Searches;
+            Result["misses"] = Stats.Misses;
+            return Result;
+        });
+}
+
+static py::dict TPOSnapshotToDict(const c_TPOEngine& Engine, const s_TPOSnapshot& Snapshot)
+{
+    py::dict Result;
+    Result["symbol"] = Snapshot.Symbol;
+    Result["session_start"] = Snapshot.SessionStart;
+    Result["last_time"] = Snapshot.LastTime;
+    Result["complete"] = Snapshot.Complete;
+    Result["periods"] = Snapshot.Periods;
+    Result["tpo_count"] = Snapshot.TotalTPOs;
+    Result["single_prints"] = Snapshot.SinglePrints;
+    Result["high"] = Engine.ToPrice(Snapshot.HighTick);
+    Result["low"] = Engine.ToPrice(Snapshot.LowTick);
+    Result["poc"] = Engine.ToPrice(Snapshot.POCTick);
+    Result["value_area_high"] = Engine.ToPrice(Snapshot.ValueAreaHighTick);
+    Result["value_area_low"] = Engine.ToPrice(Snapshot.ValueAreaLowTick);
+    Result["ib_complete"] = Snapshot.IBComplete;
+    Result["ib_high"] = Engine.ToPrice(Snapshot.IBHighTick);
+    Result["ib_low"] = Engine.ToPrice(Snapshot.IBLowTick);
+
+    py::list Levels(Snapshot.Levels.size());
+    for (size_t l = 0; l < Snapshot.Levels.size(); l++)
+    {
+        const s_TPOLevel& Level = Snapshot.Levels[l];
+        Levels[l] = py::make_tuple(Engine.ToPrice(Level.Tick), Level.Count, Level.Letters);
+    }
+    Result["levels"] = Levels;
+    return Result;
+}
+
+static void BindTPO(py::module_& m)
+{
+    py::class_<c_TPOEngine>(m, "TPOEngine")
+        .def(py::init<double, int, int, int, int, double>(),
+            py::arg("tick_size"), py::arg("period_seconds") = 1800, py::arg("session_offset_seconds") = 0,
+            py::arg("session_seconds") = 86400, py::arg("ib_periods") = 2, py::arg("value_area") = 0.70)
+        // The engine keeps a pointer to the calendar, so the calendar lives as long as the engine
+        .def("set_calendar", [](c_TPOEngine& Engine, c_SessionCalendar* Calendar) { Engine.SetCalendar(Calendar); },
+            py::arg("calendar"), py::keep_alive<1, 2>())
+        .def("add", &c_TPOEngine::Add, py::arg("symbol"), py::arg("time"), py::arg("high"), py::arg("low"))
+        .def("flush", [](c_TPOEngine& Engine)
+        {
+            // Changed levels only, as (price, tpo_count, letters) highest first
+            std::vector<s_TPOSnapshot> Snapshots;
+            Engine.Flush(Snapshots);
+            py::list Result(Snapshots.size());
+            for (size_t s = 0; s < Snapshots.size(); s++)
+                Result[s] = TPOSnapshotToDict(Engine, Snapshots[s]);
+            return Result;
+        })
+        .def("profile", [](const c_TPOEngine& Engine, const std::string& Symbol) -> py::object
+        {
+            s_TPOSnapshot Snapshot;
+            if (!Engine.Profile(Symbol, Snapshot))
+                return py::none();
+            return TPOSnapshotToDict(Engine, Snapshot);
+        }, py::arg("symbol"))
+        .def("stats", [](const c_TPOEngine& Engine)
+        {
+            s_TPOStats Stats = Engine.GetStats();
+            py::dict Result;
+            Result["symbols"] = Stats.Symbols;
+            Result["levels"] = Stats.Levels;
+            Result["sessions"] = Stats.Sessions;
+            Result["rejected_bars"] = Stats.RejectedBars;
+            return Result;
+        });
+}
+
+static void BindCatalog(py::module_& m)
+{
+    py::class_<c_StreamCatalog>(m, "StreamCatalog")
+        .def(py::init<>())
+        .def("add", &c_StreamCatalog::Add,
+            py::arg("symbol"), py::arg("timeframe"), py::arg("time"), py::arg("high"), py::arg("low"), py::arg("volume"),
+            py::arg("inserted") = false)
+        .def("is_backfill", &c_StreamCatalog::IsBackfill, py::arg("symbol"), py::arg("timeframe"), py::arg("time"))
+        .def("merge", [](c_StreamCatalog& Catalog, const std::string& Symbol, const std::string& Timeframe, int64_t Count,
+            int64_t FirstTime, int64_t LastTime, double VolumeSum, double MaxVolume, double MinLow, double MaxHigh, double LastVolume)
+        {
+            s_StreamStats Stream;
+            Stream.Symbol = Symbol;
+            Stream.Timeframe = Timeframe;
+            Stream.Count = Count;
+            Stream.FirstTime = FirstTime;
+            Stream.LastTime = LastTime;
+            Stream.VolumeSum = VolumeSum;
+            Stream.MaxVolume = MaxVolume;
+            Stream.MinLow = MinLow;
+            Stream.MaxHigh = MaxHigh;
+            Stream.LastVolume = LastVolume;
+            Catalog.Merge(Stream);
+        }, py::arg("symbol"), py::arg("timeframe"), py::arg("count"), py::arg("first_time"), py::arg("last_time"),
+            py::arg("volume_sum"), py::arg("max_volume"), py::arg("min_low"), py::arg("max_high"), py::arg("last_volume"))
+        .def("symbols", &c_StreamCatalog::Symbols)
+        .def("summary", [](const c_StreamCatalog& Catalog, const std::string& Symbol) -> py::object
+        {
+            s_SymbolSummary Summary;
+            if (!Catalog.Summary(Symbol, Summary))
+                return py::none();
+            py::dict Result;
+            Result["count"] = Summary.Count;
+            Result["first_time"] = Summary.FirstTime;
+            Result["last_time"] = Summary.LastTime;
+            Result["volume_sum"] = Summary.VolumeSum;
+            Result["max_volume"] = Summary.MaxVolume;
+            Result["min_low"] = Summary.MinLow;
+            Result["max_high"] = Summary.MaxHigh;
+            Result["timeframes"] = Summary.Timeframes;
+            return Result;
+        }, py::arg("symbol"))
+        .def("export", [](c_StreamCatalog& Catalog, bool ChangedOnly)
+        {
+            // (symbol, timeframe, count, first_time, last_time, volume_sum,
+            //  max_volume, min_low, max_high, last_volume) per stream
+            std::vector<s_StreamStats> Streams;
+            Catalog.Export(ChangedOnly, Streams);
+            py::list Result(Streams.size());
+            for (size_t s = 0; s < Streams.size(); s++)
+            {
+                const s_StreamStats& Stream = Streams[s];
+                Result[s] = py::make_tuple(Stream.Symbol, Stream.Timeframe, Stream.Count, Stream.FirstTime, Stream.LastTime,
+                    Stream.VolumeSum, Stream.MaxVolume, Stream.MinLow, Stream.MaxHigh, Stream.LastVolume);
+            }
+            return Result;
+        }, py::arg("changed_only") = true)
+        .def("stats", [](const c_StreamCatalog& Catalog)
+        {
+            s_CatalogStats Stats = Catalog.GetStats();
+            py::dict Result;
+            Result["symbols"] = Stats.Symbols;
+            Result["streams"] = Stats.Streams;
+            Result["changed"] = Stats.Changed;
+            Result["bars"] = Stats.Bars;
+            return Result;
+        });
+}
+
+typedef py::array_t<int64_t> IndexArray;
+
+static void BindDownsample(py::module_& m)
+{
+    m.def("bucket_size_for", &BucketSizeFor, py::arg("count"), py::arg("max_points"));
+
+    m.def("bucket_reduce", [](DoubleArray Values, size_t BucketSize, const std::string& Kind)
+    {
+        e_BucketReduce Reduce;
+        if (Kind == "first")
+            Reduce = BUCKET_FIRST;
+        else if (Kind == "last")
+            Reduce = BUCKET_LAST;
+        else if (Kind == "max")
+            Reduce = BUCKET_MAX;
+        else if (Kind == "min")
+            Reduce = BUCKET_MIN;
+        else if (Kind == "sum")
+            Reduce = BUCKET_SUM;
+        else
+            throw std::invalid_argument("unknown bucket reduction: " + Kind);
+        if (BucketSize == 0)
+            throw std::invalid_argument("bucket_size must be positive");
+
+        size_t Count = Values.size();
+        DoubleArray Out = NewArray(BucketCount(Count, BucketSize));
+        BucketReduce(Values.data(), Count, BucketSize, Reduce, Out.mutable_data());
+        return Out;
+    }, py::arg("values"), py::arg("bucket_size"), py::arg("kind"));
+
+    // Both return the indices of the kept points, ascending
+    m.def("lttb", [](DoubleArray X, DoubleArray Y, size_t MaxPoints)
+    {
+        size_t Count = Y.size();
+        if ((size_t)X.size() != Count)
+            throw std::invalid_argument("x and y must have the same length");
+        std::vector<int64_t> Indexes(std::min(Count, MaxPoints));
+        size_t Kept = DownsampleLTTB(X.data(), Y.data(), Count, MaxPoints, Indexes.data());
+        IndexArray Out((py::ssize_t)Kept);
+        if (Kept > 0)
+            memcpy(Out.mutable_data(), Indexes.data(), Kept * sizeof(int64_t));
+        return Out;
+    }, py::arg("x"), py::arg("y"), py::arg("max_points"));
+
+    m.def("minmax_points", [](DoubleArray Y, size_t MaxPoints)
+    {
+        size_t Count = Y.size();
+        std::vector<int64_t> Indexes(std::min(Count, MaxPoints));
+        size_t Kept = DownsampleMinMax(Y.data(), Count, MaxPoints, Indexes.data());
+        IndexArray Out((py::ssize_t)Kept);
+        if (Kept > 0)
+            memcpy(Out.mutable_data(), Indexes.data(), Kept * sizeof(int64_t));
+        return Out;
+    }, py::arg("y"), py::arg("max_points"));
+}
+
+static void BindPyramid(py::module_& m)
+{
+    py::class_<c_BarPyramid>(m, "BarPyramid")
+        .def(py::init<int, size_t>(), py::arg("levels") = 17, py::arg("level_bars") = 4096)
+        .def("add", [](c_BarPyramid& Pyramid, const std::string& Symbol, int64_t Time,
+            double Open, double High, double Low, double Close, double Volume,
+            std::optional<double> BidVolume, std::optional<double> AskVolume,
+            std::optional<double> NumberOfTrades, std::optional<double> OpenInterest)
+        {
+            const double NaN = std::numeric_limits<double>::quiet_NaN();
+            double Bar[PYRAMID_COLUMN_COUNT];
+            Bar[PYRAMID_OPEN] = Open;
+            Bar[PYRAMID_HIGH] = High;
+            Bar[PYRAMID_LOW] = Low;
+            Bar[PYRAMID_CLOSE] = Close;
+            Bar[PYRAMID_VOLUME] = Volume;
+            Bar[PYRAMID_BID_VOLUME] = BidVolume.value_or(NaN);
+            Bar[PYRAMID_ASK_VOLUME] = AskVolume.value_or(NaN);
+            Bar[PYRAMID_NUMBER_OF_TRADES] = NumberOfTrades.value_or(NaN);
+            Bar[PYRAMID_OPEN_INTEREST] = OpenInterest.value_or(NaN);
+            Pyramid.Add(Symbol, Time, Bar);
+        }, py::arg("symbol"), py::arg("time"),
+            py::arg("open"), py::arg("high"), py::arg("low"), py::arg("close"), py::arg("volume"),
+            py::arg("bid_volume") = py::none(), py::arg("ask_volume") = py::none(),
+            py::arg("number_of_trades") = py::none(), py::arg("open_interest") = py::none())
+        .def("query", [](c_BarPyramid& Pyramid, const std::string& Symbol, int64_t StartTime, int64_t EndTime,
+            size_t MaxPoints) -> py::object
+        {
+            // None when no level covers the range, else oldest-first columns
+            // plus the level and bucket width they came from
+            s_PyramidColumns Columns;
+            if (!Pyramid.Query(Symbol, StartTime, EndTime, MaxPoints, Columns))
+                return py::none();
+            size_t Count = Columns.Size();
+            py::dict Result;
+            IndexArray Times((py::ssize_t)Count);
+            if (Count > 0)
+                memcpy(Times.mutable_data(), Columns.Time.data(), Count * sizeof(int64_t));
+            Result["time"] = Times;
+            for (int c = 0; c < PYRAMID_COLUMN_COUNT; c++)
+            {
+                DoubleArray Values = NewArray(Count);
+                if (Count > 0)
+                    memcpy(Values.mutable_data(), Columns.Values[c].data(), Count * sizeof(double));
+                Result[PYRAMID_COLUMN_NAMES[c]] = Values;
+            }
+            Result["level"] = Columns.Level;
+            Result["bucket_seconds"] = Columns.BucketSeconds;
+            return Result;
+        }, py::arg("symbol"), py::arg("start_time"), py::arg("end_time"), py::arg("max_points"))
+        .def("covered_from", [](const c_BarPyramid& Pyramid, const std::string& Symbol, int Level) -> py::object
+        {
+            int64_t From = Pyramid.CoveredFrom(Symbol, Level);
+            if (From == PYRAMID_NOT_COVERED)
+                return py::none();
+            return py::int_(From);
+        }, py::arg("symbol"), py::arg("level"))
+        .def_property_readonly("levels", &c_BarPyramid::LevelCount)
+        .def("stats", [](const c_BarPyramid& Pyramid)
+        {
+            s_PyramidStats Stats = Pyramid.GetStats();
+            py::dict Result;
+            Result["symbols"] = Stats.Symbols;
+            Result["levels"] = Stats.Levels;
+            Result["buckets"] = Stats.Buckets;
+            Result["queries"] = Stats.Queries;
+            Result["misses"] = Stats.Misses;
+            return Result;
+        });
+}
+
+PYBIND11_MODULE(tradeflow_native, m)
+{
+    m.doc() = "TradeFlow Pro native engines";
+    BindIndicators(m);
+    BindBroadcaster(m);
+    BindAlerts(m);
+    BindFootprint(m);
+    BindBarStore(m);
+    BindReadCache(m);
+    BindReorder(m);
+    BindCalendar(m);
+    BindTPO(m);
+    BindCatalog(m);
+    BindDownsample(m);
+    BindPyramid(m);
+}
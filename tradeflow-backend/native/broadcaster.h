@@ -0,0 +1,284 @@
+// TradeFlow Pro native WebSocket fan-out
+// Each published message is encoded once by the caller and shared by reference
+// across every subscriber queue. Queues are bounded per connection: once a
+// consumer falls behind, further updates are conflated to the latest one per
+// symbol and message type instead of growing an unbounded backlog. Event
+// messages are never conflated: they wait in a second bounded list and are
+// dropped (and counted) only once that is full too.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    struct s_BroadcastStats
+    {
+        uint64_t Published = 0;     // Messages handed to Publish
+        uint64_t Enqueued = 0;      // Per-connection queue insertions
+        uint64_t Conflated = 0;     // Updates that replaced or skipped the queue
+        uint64_t Dropped = 0;       // Events refused by a connection with both lists full
+        uint64_t Delivered = 0;     // Messages returned by Drain
+        size_t Connections = 0;
+    };
+
+    // t_Payload is any cheaply copyable handle to an immutable encoded message:
+    // std::shared_ptr<const std::string> natively, a Python str in the bindings.
+    template <typename t_Payload>
+    class c_FanoutBroadcaster
+    {
+    public:
+        explicit c_FanoutBroadcaster(size_t DefaultQueueCapacity = 256)
+            : DefaultCapacity(DefaultQueueCapacity > 0 ? DefaultQueueCapacity : 1)
+        {
+        }
+
+        uint32_t AddConnection(size_t QueueCapacity = 0)
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            uint32_t Id = NextConnectionId++;
+            std::unique_ptr<s_Connection> Connection(new s_Connection());
+            Connection->Id = Id;
+            Connection->Capacity = QueueCapacity > 0 ? QueueCapacity : DefaultCapacity;
+            Connections[Id] = std::move(Connection);
+            return Id;
+        }
+
+        void RemoveConnection(uint32_t Id)
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            auto Found = Connections.find(Id);
+            if (Found == Connections.end())
+                return;
+
+            s_Connection* Connection = Found->second.get();
+            for (uint32_t SymbolId : Connection->Symbols)
+                RemoveSubscriber(SymbolId, Connection);
+            Connections.erase(Found);
+        }
+
+        bool Subscribe(uint32_t Id, const std::string& Symbol)
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            s_Connection* Connection = FindConnection(Id);
+            if (Connection == nullptr)
+                return false;
+
+            uint32_t SymbolId = InternSymbol(Symbol);
+            for (uint32_t Existing : Connection->Symbols)
+                if (Existing == SymbolId)
+                    return true;
+
+            Connection->Symbols.push_back(SymbolId);
+            Subscribers[SymbolId].push_back(Connection);
+            return true;
+        }
+
+        bool Unsubscribe(uint32_t Id, const std::string& Symbol)
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            s_Connection* Connection = FindConnection(Id);
+            auto SymbolEntry = SymbolIds.find(Symbol);
+            if (Connection == nullptr || SymbolEntry == SymbolIds.end())
+                return false;
+
+            uint32_t SymbolId = SymbolEntry->second;
+            std::vector<uint32_t>& Symbols = Connection->Symbols;
+            for (size_t i = 0; i < Symbols.size(); i++)
+            {
+                if (Symbols[i] != SymbolId)
+                    continue;
+                Symbols[i] = Symbols.back();
+                Symbols.pop_back();
+                RemoveSubscriber(SymbolId, Connection);
+                return true;
+            }
+            return false;
+        }
+
+        // Shares Payload with every subscriber of Symbol. Behind a full queue, a
+        // message replaces the pending one with the same Symbol and Type, or with
+        // Conflate false (events) is kept in order behind the conflated updates.
+        // Ids of connections that had nothing pending (and therefore need a
+        // wake-up) are appended to Woken. Returns the number of subscribers reached.
+        size_t Publish(const std::string& Symbol, const std::string& Type, const t_Payload& Payload,
+            std::vector<uint32_t>& Woken, bool Conflate = true)
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            Stats.Published++;
+
+            auto SymbolEntry = SymbolIds.find(Symbol);
+            if (SymbolEntry == SymbolIds.end())
+                return 0;
+
+            uint32_t SymbolId = SymbolEntry->second;
+            uint64_t Key = Conflate ? (uint64_t)InternType(Type) << 32 | SymbolId : EVENT_KEY;
+            const std::vector<s_Connection*>& Targets = Subscribers[SymbolId];
+            for (s_Connection* Connection : Targets)
+            {
+                if (Connection->PendingCount() == 0)
+                    Woken.push_back(Connection->Id);
+
+                if (Connection->Queue.size() < Connection->Capacity && Connection->Latest.empty())
+                {
+                    Connection->Queue.push_back(Payload);
+                    Stats.Enqueued++;
+                }
+                else if (Conflate)
+                {
+                    // Slow consumer: keep only the newest update per symbol and type
+                    Connection->Conflate(Key, Payload);
+                    Stats.Conflated++;
+                }
+                else if (Connection->Events < Connection->Capacity)
+                {
+                    Connection->Latest.emplace_back(Key, Payload);
+                    Connection->Events++;
+                    Stats.Enqueued++;
+                }
+                else
+                {
+                    Stats.Dropped++;
+                }
+            }
+            return Targets.size();
+        }
+
+        // Moves up to Max pending messages into Out, oldest first. Conflated updates
+        // and overflowed events are delivered after the queued backlog, in the order
+        // they first overflowed. Returns the number moved.
+        size_t Drain(uint32_t Id, size_t Max, std::vector<t_Payload>& Out)
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            s_Connection* Connection = FindConnection(Id);
+            if (Connection == nullptr)
+                return 0;
+
+            size_t Moved = 0;
+            while (Moved < Max && !Connection->Queue.empty())
+            {
+                Out.push_back(std::move(Connection->Queue.front()));
+                Connection->Queue.pop_front();
+                Moved++;
+            }
+
+            while (Moved < Max && !Connection->Latest.empty())
+            {
+                if (Connection->Latest.front().first == EVENT_KEY)
+                    Connection->Events--;
+                Out.push_back(std::move(Connection->Latest.front().second));
+                Connection->Latest.pop_front();
+                Moved++;
+            }
+
+            Stats.Delivered += Moved;
+            return Moved;
+        }
+
+        size_t Pending(uint32_t Id)
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            s_Connection* Connection = FindConnection(Id);
+            return Connection != nullptr ? Connection->PendingCount() : 0;
+        }
+
+        s_BroadcastStats GetStats()
+        {
+            std::lock_guard<std::mutex> Guard(Lock);
+            s_BroadcastStats Result = Stats;
+            Result.Connections = Connections.size();
+            return Result;
+        }
+
+    private:
+        // Latest key of event messages, which never match each other
+        static constexpr uint64_t EVENT_KEY = ~0ULL;
+
+        struct s_Connection
+        {
+            uint32_t Id = 0;
+            size_t Capacity = 0;
+            std::vector<uint32_t> Symbols;
+            std::deque<t_Payload> Queue;
+            // Once the queue is full: the latest update per (type << 32 | symbol),
+            // bounded by Symbols.size() times the message types, plus up to
+            // Capacity events under EVENT_KEY
+            std::deque<std::pair<uint64_t, t_Payload>> Latest;
+            size_t Events = 0;
+
+            size_t PendingCount() const { return Queue.size() + Latest.size(); }
+
+            void Conflate(uint64_t Key, const t_Payload& Payload)
+            {
+                for (auto& Entry : Latest)
+                {
+                    if (Entry.first == Key)
+                    {
+                        Entry.second = Payload;
+                        return;
+                    }
+                }
+                Latest.emplace_back(Key, Payload);
+            }
+        };
+
+        s_Connection* FindConnection(uint32_t Id)
+        {
+            auto Found = Connections.find(Id);
+            return Found != Connections.end() ? Found->second.get() : nullptr;
+        }
+
+        uint32_t InternSymbol(const std::string& Symbol)
+        {
+            auto Found = SymbolIds.find(Symbol);
+            if (Found != SymbolIds.end())
+                return Found->second;
+
+            uint32_t SymbolId = (uint32_t)Subscribers.size();
+            SymbolIds.emplace(Symbol, SymbolId);
+            Subscribers.emplace_back();
+            return SymbolId;
+        }
+
+        uint32_t InternType(const std::string& Type)
+        {
+            auto Found = TypeIds.find(Type);
+            if (Found != TypeIds.end())
+                return Found->second;
+
+            uint32_t TypeId = (uint32_t)TypeIds.size();
+            TypeIds.emplace(Type, TypeId);
+            return TypeId;
+        }
+
+        void RemoveSubscriber(uint32_t SymbolId, s_Connection* Connection)
+        {
+            std::vector<s_Connection*>& List = Subscribers[SymbolId];
+            for (size_t i = 0; i < List.size(); i++)
+            {
+                if (List[i] == Connection)
+                {
+                    List[i] = List.back();
+                    List.pop_back();
+                    return;
+                }
+            }
+        }
+
+        std::mutex Lock;
+        size_t DefaultCapacity;
+        uint32_t NextConnectionId = 1;
+        std::unordered_map<uint32_t, std::unique_ptr<s_Connection>> Connections;
+        std::unordered_map<std::string, uint32_t> SymbolIds;
+        std::unordered_map<std::string, uint32_t> TypeIds;
+        std::vector<std::vector<s_Connection*>> Subscribers;  // Indexed by symbol id
+        s_BroadcastStats Stats;
+    };
+}
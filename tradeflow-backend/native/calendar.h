@@ -0,0 +1,207 @@
+// TradeFlow Pro native session calendar
+// Trading sessions per symbol, precompiled into sorted boundary arrays so that
+// mapping a bar time to its session, its bar index within the session and a
+// session-anchored bucket is a lookup rather than date arithmetic in every
+// engine. A calendar is a named list of [start, end) sessions (trading hours
+// with holidays and early closes already applied by the caller); symbols are
+// assigned to a calendar, and symbols without one get daily sessions at a
+// fixed offset from midnight, computed directly. Each symbol remembers the
+// session its last lookup landed in, so in-order ingest resolves in O(1)
+// (same or next session) and only jumps fall back to a binary search.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    const int64_t CALENDAR_DAY_MICROS = 86400LL * 1000000;
+
+    struct s_SessionPosition
+    {
+        int64_t Index = 0;          // Session number in the calendar; days since the epoch for daily sessions
+        int64_t Start = 0;          // Epoch microseconds
+        int64_t End = 0;            // Exclusive
+        bool InSession = false;     // False between sessions: the position is the last session started
+        int64_t Bar = 0;            // Bar of the requested width since the session start
+        int64_t BarStart = 0;       // Its start; the last bar of a session may be cut short by End
+    };
+
+    struct s_CalendarStats
+    {
+        size_t Calendars = 0;
+        size_t Symbols = 0;         // Symbols assigned to a calendar
+        size_t Sessions = 0;        // Across all calendars
+        uint64_t Lookups = 0;
+        uint64_t HintHits = 0;      // Resolved from the symbol's previous session
+        uint64_t Searches = 0;      // Binary searches
+        uint64_t Misses = 0;        // Before the first session or after the last one
+    };
+
+    class c_SessionCalendar
+    {
+    public:
+        c_SessionCalendar(int DefaultOffsetSeconds = 0, int DefaultSessionSeconds = 86400)
+        {
+            SetDefault(DefaultOffsetSeconds, DefaultSessionSeconds);
+        }
+
+        // Daily sessions of symbols without a calendar: every 24 hours from
+        // OffsetSeconds past midnight, lasting SessionSeconds
+        void SetDefault(int OffsetSeconds, int SessionSeconds)
+        {
+            int64_t Offset = (int64_t)OffsetSeconds * 1000000 % CALENDAR_DAY_MICROS;
+            DefaultOffset = Offset < 0 ? Offset + CALENDAR_DAY_MICROS : Offset;
+            DefaultLength = (int64_t)std::min(std::max(SessionSeconds, 1), 86400) * 1000000;
+        }
+
+        // Replaces calendar Name with sessions [Starts[i], Ends[i]). Sessions
+        // must be sorted, non-empty and non-overlapping; false leaves the
+        // calendar unchanged.
+        bool Define(const std::string& Name, const std::vector<int64_t>& Starts, const std::vector<int64_t>& Ends)
+        {
+            if (Name.empty() || Starts.size() != Ends.size())
+                return false;
+            for (size_t i = 0; i < Starts.size(); i++)
+            {
+                if (Ends[i] <= Starts[i] || (i > 0 && Starts[i] < Ends[i - 1]))
+                    return false;
+            }
+
+            auto Found = Names.find(Name);
+            if (Found == Names.end())
+            {
+                Found = Names.emplace(Name, Calendars.size()).first;
+                Calendars.emplace_back();
+            }
+            s_Calendar& Calendar = Calendars[Found->second];
+            Calendar.Starts = Starts;
+            Calendar.Ends = Ends;
+            return true;
+        }
+
+        bool HasCalendar(const std::string& Name) const { return Names.count(Name) > 0; }
+
+        // Symbol takes its sessions from calendar Name; an empty Name returns
+        // it to the daily default. False when Name is not defined.
+        bool Assign(const std::string& Symbol, const std::string& Name)
+        {
+            if (Name.empty())
+            {
+                Symbols.erase(Symbol);
+                return true;
+            }
+            auto Found = Names.find(Name);
+            if (Found == Names.end())
+                return false;
+            s_Symbol& State = Symbols[Symbol];
+            State.Calendar = Found->second;
+            State.Hint = 0;
+            return true;
+        }
+
+        // The session holding Time, or the last one started before it. With
+        // BarMicros > 0 also the bar of that width, counted from the session
+        // start, that Time falls in. False before a calendar's first session
+        // or after its last one (outside the compiled range).
+        bool Locate(const std::string& Symbol, int64_t Time, int64_t BarMicros, s_SessionPosition& Out)
+        {
+            Stats.Lookups++;
+            auto Found = Symbols.find(Symbol);
+            if (Found == Symbols.end())
+                LocateDaily(Time, Out);
+            else if (!LocateIn(Found->second, Time, Out))
+            {
+                Stats.Misses++;
+                return false;
+            }
+
+            if (BarMicros > 0)
+            {
+                Out.Bar = (Time - Out.Start) / BarMicros;
+                Out.BarStart = Out.Start + Out.Bar * BarMicros;
+            }
+            else
+            {
+                Out.Bar = 0;
+                Out.BarStart = Out.Start;
+            }
+            return true;
+        }
+
+        s_CalendarStats GetStats() const
+        {
+            s_CalendarStats Result = Stats;
+            Result.Calendars = Calendars.size();
+            Result.Symbols = Symbols.size();
+            for (const s_Calendar& Calendar : Calendars)
+                Result.Sessions += Calendar.Starts.size();
+            return Result;
+        }
+
+    private:
+        struct s_Calendar
+        {
+            std::vector<int64_t> Starts;
+            std::vector<int64_t> Ends;
+        };
+
+        struct s_Symbol
+        {
+            size_t Calendar = 0;
+            size_t Hint = 0;        // Session of the previous lookup
+        };
+
+        std::vector<s_Calendar> Calendars;
+        std::unordered_map<std::string, size_t> Names;
+        std::unordered_map<std::string, s_Symbol> Symbols;
+        int64_t DefaultOffset = 0;
+        int64_t DefaultLength = CALENDAR_DAY_MICROS;
+        s_CalendarStats Stats;
+
+        void LocateDaily(int64_t Time, s_SessionPosition& Out) const
+        {
+            int64_t Shifted = Time - DefaultOffset;
+            int64_t Days = Shifted / CALENDAR_DAY_MICROS - (Shifted % CALENDAR_DAY_MICROS < 0 ? 1 : 0);
+            Out.Index = Days;
+            Out.Start = Days * CALENDAR_DAY_MICROS + DefaultOffset;
+            Out.End = Out.Start + DefaultLength;
+            Out.InSession = Time < Out.End;
+        }
+
+        bool LocateIn(s_Symbol& State, int64_t Time, s_SessionPosition& Out)
+        {
+            const s_Calendar& Calendar = Calendars[State.Calendar];
+            const std::vector<int64_t>& Starts = Calendar.Starts;
+            size_t Count = Starts.size();
+            if (Count == 0 || Time < Starts[0] || Time >= Calendar.Ends[Count - 1])
+                return false;
+
+            // Session i holds Time when Starts[i] <= Time < Starts[i + 1]
+            size_t Index = State.Hint;
+            if (Index < Count && Starts[Index] <= Time && (Index + 1 == Count || Time < Starts[Index + 1]))
+                Stats.HintHits++;
+            else if (Index + 1 < Count && Starts[Index + 1] <= Time && (Index + 2 == Count || Time < Starts[Index + 2]))
+            {
+                Index++;
+                Stats.HintHits++;
+            }
+            else
+            {
+                Index = (size_t)(std::upper_bound(Starts.begin(), Starts.end(), Time) - Starts.begin()) - 1;
+                Stats.Searches++;
+            }
+            State.Hint = Index;
+
+            Out.Index = (int64_t)Index;
+            Out.Start = Starts[Index];
+            Out.End = Calendar.Ends[Index];
+            Out.InSession = Time < Out.End;
+            return true;
+        }
+    };
+}
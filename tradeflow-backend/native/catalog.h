@@ -0,0 +1,239 @@
+// TradeFlow Pro native stream catalog
+// Per-(symbol, timeframe) statistics kept current from ingest: bar count,
+// first/last time, volume sum and maximum, price extrema. Each bar is one hash
+// lookup and a handful of compares, so symbol listings and symbol info never
+// scan market_data. Streams changed since the last export are flagged so the
+// catalog can be persisted incrementally and reloaded at startup.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    struct s_StreamStats
+    {
+        std::string Symbol;
+        std::string Timeframe;
+        int64_t Count = 0;
+        int64_t FirstTime = 0;      // Epoch microseconds
+        int64_t LastTime = 0;
+        double VolumeSum = 0.0;
+        double MaxVolume = 0.0;
+        double MinLow = std::numeric_limits<double>::infinity();
+        double MaxHigh = -std::numeric_limits<double>::infinity();
+        double LastVolume = 0.0;    // Volume of the bar at LastTime, replaced when it is rewritten
+    };
+
+    struct s_SymbolSummary
+    {
+        int64_t Count = 0;
+        int64_t FirstTime = 0;
+        int64_t LastTime = 0;
+        double VolumeSum = 0.0;
+        double MaxVolume = 0.0;
+        double MinLow = std::numeric_limits<double>::infinity();
+        double MaxHigh = -std::numeric_limits<double>::infinity();
+        std::vector<std::string> Timeframes;   // Sorted
+    };
+
+    struct s_CatalogStats
+    {
+        size_t Symbols = 0;
+        size_t Streams = 0;
+        size_t Changed = 0;     // Streams not yet exported
+        size_t Bars = 0;        // Bars seen since startup
+    };
+
+    class c_StreamCatalog
+    {
+    public:
+        // Counts a stored bar. Bars after the stream's last time or before its
+        // first are new; a bar at the last time rewrites it (its volume replaces
+        // the previous one). A bar strictly inside the covered range is counted
+        // only when Inserted says market_data did not hold it before (a
+        // backfilled gap); otherwise it is a resend and only widens the
+        // extrema. Returns true if counted.
+        bool Add(const std::string& Symbol, const std::string& Timeframe, int64_t Time, double High, double Low, double Volume,
+            bool Inserted = false)
+        {
+            s_Entry& Entry = GetStream(Symbol, Timeframe);
+            s_StreamStats& Stream = Entry.Stats;
+            Entry.Changed = true;
+            Bars++;
+
+            if (std::isfinite(High))
+                Stream.MaxHigh = std::max(Stream.MaxHigh, High);
+            if (std::isfinite(Low))
+                Stream.MinLow = std::min(Stream.MinLow, Low);
+            if (!std::isfinite(Volume))
+                Volume = 0.0;
+            Stream.MaxVolume = std::max(Stream.MaxVolume, Volume);
+
+            if (Stream.Count > 0 && Time == Stream.LastTime)
+            {
+                Stream.VolumeSum += Volume - Stream.LastVolume;
+                Stream.LastVolume = Volume;
+                return false;
+            }
+            if (Stream.Count > 0 && Time > Stream.FirstTime && Time < Stream.LastTime)
+            {
+                if (!Inserted)
+                    return false;
+                Stream.Count++;
+                Stream.VolumeSum += Volume;
+                return true;
+            }
+
+            if (Stream.Count == 0 || Time > Stream.LastTime)
+            {
+                if (Stream.Count == 0)
+                    Stream.FirstTime = Time;
+                Stream.LastTime = Time;
+                Stream.LastVolume = Volume;
+            }
+            else
+                Stream.FirstTime = Time;
+            Stream.Count++;
+            Stream.VolumeSum += Volume;
+            return true;
+        }
+
+        // True when Time is before the stream's last bar: whether such a bar
+        // is new cannot be told from the catalog, so the caller finds out
+        // from the write and passes Inserted to Add
+        bool IsBackfill(const std::string& Symbol, const std::string& Timeframe, int64_t Time) const
+        {
+            auto Found = Streams.find(StreamKey(Symbol, Timeframe));
+            return Found != Streams.end() && Found->second.Stats.Count > 0 && Time < Found->second.Stats.LastTime;
+        }
+
+        // Folds in statistics for bars not yet seen (a reload, or a catch-up
+        // over bars stored after the last export)
+        void Merge(const s_StreamStats& Other)
+        {
+            if (Other.Count <= 0)
+                return;
+            s_Entry& Entry = GetStream(Other.Symbol, Other.Timeframe);
+            s_StreamStats& Stream = Entry.Stats;
+            Entry.Changed = true;
+
+            if (Stream.Count == 0 || Other.FirstTime < Stream.FirstTime)
+                Stream.FirstTime = Other.FirstTime;
+            if (Stream.Count == 0 || Other.LastTime >= Stream.LastTime)
+            {
+                Stream.LastTime = Other.LastTime;
+                Stream.LastVolume = Other.LastVolume;
+            }
+            Stream.Count += Other.Count;
+            Stream.VolumeSum += Other.VolumeSum;
+            Stream.MaxVolume = std::max(Stream.MaxVolume, Other.MaxVolume);
+            Stream.MinLow = std::min(Stream.MinLow, Other.MinLow);
+            Stream.MaxHigh = std::max(Stream.MaxHigh, Other.MaxHigh);
+        }
+
+        std::vector<std::string> Symbols() const
+        {
+            std::vector<std::string> Result;
+            Result.reserve(SymbolStreams.size());
+            for (const auto& Entry : SymbolStreams)
+                Result.push_back(Entry.first);
+            std::sort(Result.begin(), Result.end());
+            return Result;
+        }
+
+        // Same aggregates as a GROUP BY symbol over every timeframe
+        bool Summary(const std::string& Symbol, s_SymbolSummary& Out) const
+        {
+            auto Found = SymbolStreams.find(Symbol);
+            if (Found == SymbolStreams.end())
+                return false;
+
+            Out = s_SymbolSummary();
+            for (const s_Entry* Entry : Found->second)
+            {
+                const s_StreamStats& Stream = Entry->Stats;
+                if (Stream.Count == 0)
+                    continue;
+                Out.FirstTime = Out.Count == 0 ? Stream.FirstTime : std::min(Out.FirstTime, Stream.FirstTime);
+                Out.LastTime = Out.Count == 0 ? Stream.LastTime : std::max(Out.LastTime, Stream.LastTime);
+                Out.Count += Stream.Count;
+                Out.VolumeSum += Stream.VolumeSum;
+                Out.MaxVolume = std::max(Out.MaxVolume, Stream.MaxVolume);
+                Out.MinLow = std::min(Out.MinLow, Stream.MinLow);
+                Out.MaxHigh = std::max(Out.MaxHigh, Stream.MaxHigh);
+                Out.Timeframes.push_back(Stream.Timeframe);
+            }
+            std::sort(Out.Timeframes.begin(), Out.Timeframes.end());
+            return Out.Count > 0;
+        }
+
+        // Streams changed since the last call (all streams if ChangedOnly is false)
+        void Export(bool ChangedOnly, std::vector<s_StreamStats>& Out)
+        {
+            for (auto& Item : Streams)
+            {
+                if (ChangedOnly && !Item.second.Changed)
+                    continue;
+                Out.push_back(Item.second.Stats);
+                Item.second.Changed = false;
+            }
+        }
+
+        s_CatalogStats GetStats() const
+        {
+            s_CatalogStats Stats;
+            Stats.Symbols = SymbolStreams.size();
+            Stats.Streams = Streams.size();
+            Stats.Bars = Bars;
+            for (const auto& Item : Streams)
+            {
+                if (Item.second.Changed)
+                    Stats.Changed++;
+            }
+            return Stats;
+        }
+
+    private:
+        struct s_Entry
+        {
+            s_StreamStats Stats;
+            bool Changed = false;
+        };
+
+        // Keyed by symbol + '\0' + timeframe. Node-based, so the per-symbol
+        // pointers stay valid as streams are added.
+        std::unordered_map<std::string, s_Entry> Streams;
+        std::unordered_map<std::string, std::vector<const s_Entry*>> SymbolStreams;
+        size_t Bars = 0;
+
+        static std::string StreamKey(const std::string& Symbol, const std::string& Timeframe)
+        {
+            std::string Key;
+            Key.reserve(Symbol.size() + Timeframe.size() + 1);
+            Key.append(Symbol).push_back('\0');
+            Key.append(Timeframe);
+            return Key;
+        }
+
+        s_Entry& GetStream(const std::string& Symbol, const std::string& Timeframe)
+        {
+            std::string Key = StreamKey(Symbol, Timeframe);
+            auto Found = Streams.find(Key);
+            if (Found != Streams.end())
+                return Found->second;
+
+            s_Entry& Entry = Streams[Key];
+            Entry.Stats.Symbol = Symbol;
+            Entry.Stats.Timeframe = Timeframe;
+            SymbolStreams[Symbol].push_back(&Entry);
+            return Entry;
+        }
+    };
+}
@@ -0,0 +1,408 @@
+// TradeFlow Pro native downsampling kernels
+// Reduce wide column ranges to roughly the number of points a chart can draw
+// before they are turned into rows. Bars are merged into fixed-size buckets per
+// column (first/last/max/min/sum, so OHLC shape and volume totals survive);
+// line series keep either the Largest-Triangle-Three-Buckets selection or each
+// bucket's min and max point. The inner loops run two doubles per SSE2 lane
+// pair, with scalar versions kept as the fallback and the benchmark baseline.
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TRADEFLOW_DOWNSAMPLE_SSE2 1
+#endif
+
+namespace n_TradeFlow
+{
+    enum e_BucketReduce
+    {
+        BUCKET_FIRST = 0,
+        BUCKET_LAST,
+        BUCKET_MAX,     // NaN (missing) values are skipped; an all-missing bucket is NaN
+        BUCKET_MIN,
+        BUCKET_SUM
+    };
+
+    inline size_t BucketCount(size_t Count, size_t BucketSize)
+    {
+        return BucketSize > 0 ? (Count + BucketSize - 1) / BucketSize : 0;
+    }
+
+    // Smallest bucket size that brings Count values down to at most MaxPoints
+    inline size_t BucketSizeFor(size_t Count, size_t MaxPoints)
+    {
+        if (MaxPoints == 0 || Count <= MaxPoints)
+            return 1;
+        return (Count + MaxPoints - 1) / MaxPoints;
+    }
+
+    namespace n_Downsample
+    {
+        const double Infinity = std::numeric_limits<double>::infinity();
+        const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+        inline double ReduceScalar(const double* In, size_t Count, e_BucketReduce Kind)
+        {
+            double Result = Kind == BUCKET_MAX ? -Infinity : Kind == BUCKET_MIN ? Infinity : 0.0;
+            bool Any = false;
+            for (size_t i = 0; i < Count; i++)
+            {
+                double Value = In[i];
+                if (Value != Value)
+                    continue;
+                Any = true;
+                if (Kind == BUCKET_MAX)
+                    Result = Value > Result ? Value : Result;
+                else if (Kind == BUCKET_MIN)
+                    Result = Value < Result ? Value : Result;
+                else
+                    Result += Value;
+            }
+            return Any ? Result : NaN;
+        }
+
+#if TRADEFLOW_DOWNSAMPLE_SSE2
+        // maxpd/minpd return the second operand when either is NaN, so passing
+        // the accumulator second skips missing values. Sums zero them through an
+        // ordered-compare mask; the same mask records whether any value was seen.
+        inline double ReduceSSE2(const double* In, size_t Count, e_BucketReduce Kind)
+        {
+            __m128d Acc0, Acc1;
+            if (Kind == BUCKET_MAX)
+                Acc0 = Acc1 = _mm_set1_pd(-Infinity);
+            else if (Kind == BUCKET_MIN)
+                Acc0 = Acc1 = _mm_set1_pd(Infinity);
+            else
+                Acc0 = Acc1 = _mm_setzero_pd();
+            __m128d Seen = _mm_setzero_pd();
+
+            size_t i = 0;
+            for (; i + 4 <= Count; i += 4)
+            {
+                __m128d A = _mm_loadu_pd(In + i);
+                __m128d B = _mm_loadu_pd(In + i + 2);
+                __m128d OrderedA = _mm_cmpord_pd(A, A);
+                __m128d OrderedB = _mm_cmpord_pd(B, B);
+                Seen = _mm_or_pd(Seen, _mm_or_pd(OrderedA, OrderedB));
+                if (Kind == BUCKET_MAX)
+                {
+                    Acc0 = _mm_max_pd(A, Acc0);
+                    Acc1 = _mm_max_pd(B, Acc1);
+                }
+                else if (Kind == BUCKET_MIN)
+                {
+                    Acc0 = _mm_min_pd(A, Acc0);
+                    Acc1 = _mm_min_pd(B, Acc1);
+                }
+                else
+                {
+                    Acc0 = _mm_add_pd(Acc0, _mm_and_pd(A, OrderedA));
+                    Acc1 = _mm_add_pd(Acc1, _mm_and_pd(B, OrderedB));
+                }
+            }
+
+            double Lanes[4];
+            _mm_storeu_pd(Lanes, Acc0);
+            _mm_storeu_pd(Lanes + 2, Acc1);
+            bool Any = _mm_movemask_pd(Seen) != 0;
+            double Result;
+            if (Kind == BUCKET_MAX)
+                Result = std::fmax(std::fmax(Lanes[0], Lanes[1]), std::fmax(Lanes[2], Lanes[3]));
+            else if (Kind == BUCKET_MIN)
+                Result = std::fmin(std::fmin(Lanes[0], Lanes[1]), std::fmin(Lanes[2], Lanes[3]));
+            else
+                Result = (Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3]);
+
+            if (i < Count)
+            {
+                double Tail = ReduceScalar(In + i, Count - i, Kind);
+                if (Tail == Tail)
+                {
+                    Any = true;
+                    if (Kind == BUCKET_MAX)
+                        Result = std::fmax(Result, Tail);
+                    else if (Kind == BUCKET_MIN)
+                        Result = std::fmin(Result, Tail);
+                    else
+                        Result += Tail;
+                }
+            }
+            return Any ? Result : NaN;
+        }
+#endif
+
+        inline double Reduce(const double* In, size_t Count, e_BucketReduce Kind)
+        {
+#if TRADEFLOW_DOWNSAMPLE_SSE2
+            return ReduceSSE2(In, Count, Kind);
+#else
+            return ReduceScalar(In, Count, Kind);
+#endif
+        }
+
+        // Index of the point in [Start, End) forming the largest triangle with
+        // A and C. The doubled area |(Ax - Cx)(y - Ay) - (Ax - x)(Cy - Ay)| is
+        // linear in (x, y), so it is K0 + Kx * x + Ky * y under the abs.
+        inline size_t LargestTriangleScalar(const double* X, const double* Y, size_t Start, size_t End,
+            double Ax, double Ay, double Cx, double Cy)
+        {
+            double Kx = Cy - Ay, Ky = Ax - Cx, K0 = -Ky * Ay - Kx * Ax;
+            size_t Best = Start;
+            double BestArea = -1.0;
+            for (size_t j = Start; j < End; j++)
+            {
+                double Area = std::fabs(K0 + Kx * X[j] + Ky * Y[j]);
+                if (Area > BestArea)
+                {
+                    BestArea = Area;
+                    Best = j;
+                }
+            }
+            return Best;
+        }
+
+#if TRADEFLOW_DOWNSAMPLE_SSE2
+        inline size_t LargestTriangleSSE2(const double* X, const double* Y, size_t Start, size_t End,
+            double Ax, double Ay, double Cx, double Cy)
+        {
+            double Kx = Cy - Ay, Ky = Ax - Cx, K0 = -Ky * Ay - Kx * Ax;
+            const __m128d VK0 = _mm_set1_pd(K0), VKx = _mm_set1_pd(Kx), VKy = _mm_set1_pd(Ky);
+            const __m128d AbsMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+            const __m128d Two = _mm_set1_pd(2.0);
+
+            // Per lane: best area and its index (held as a double, exact below 2^53).
+            // Strict > keeps the first index within a lane, like the scalar loop.
+            __m128d BestArea = _mm_set1_pd(-1.0);
+            __m128d BestIndex = _mm_setzero_pd();
+            __m128d Index = _mm_set_pd((double)Start + 1, (double)Start);
+            size_t j = Start;
+            for (; j + 2 <= End; j += 2)
+            {
+                __m128d Area = _mm_add_pd(_mm_add_pd(VK0, _mm_mul_pd(VKx, _mm_loadu_pd(X + j))), _mm_mul_pd(VKy, _mm_loadu_pd(Y + j)));
+                Area = _mm_and_pd(Area, AbsMask);
+                __m128d Better = _mm_cmpgt_pd(Area, BestArea);
+                BestArea = _mm_or_pd(_mm_and_pd(Better, Area), _mm_andnot_pd(Better, BestArea));
+                BestIndex = _mm_or_pd(_mm_and_pd(Better, Index), _mm_andnot_pd(Better, BestIndex));
+                Index = _mm_add_pd(Index, Two);
+            }
+
+            double Areas[2], Indexes[2];
+            _mm_storeu_pd(Areas, BestArea);
+            _mm_storeu_pd(Indexes, BestIndex);
+            double Area = Areas[0];
+            size_t Best = (size_t)Indexes[0];
+            if (Areas[1] > Area || (Areas[1] == Area && (size_t)Indexes[1] < Best))
+            {
+                Area = Areas[1];
+                Best = (size_t)Indexes[1];
+            }
+            if (Area < 0.0)
+                Best = Start;
+            if (j < End)
+            {
+                double Tail = std::fabs(K0 + Kx * X[j] + Ky * Y[j]);
+                if (Tail > Area)
+                    Best = j;
+            }
+            return Best;
+        }
+#endif
+
+        inline size_t LargestTriangle(const double* X, const double* Y, size_t Start, size_t End,
+            double Ax, double Ay, double Cx, double Cy)
+        {
+#if TRADEFLOW_DOWNSAMPLE_SSE2
+            return LargestTriangleSSE2(X, Y, Start, End, Ax, Ay, Cx, Cy);
+#else
+            return LargestTriangleScalar(X, Y, Start, End, Ax, Ay, Cx, Cy);
+#endif
+        }
+
+        // Index of the smallest and largest value in [Start, End), first occurrence
+        inline void MinMaxIndexScalar(const double* Y, size_t Start, size_t End, size_t& MinIndex, size_t& MaxIndex)
+        {
+            MinIndex = MaxIndex = Start;
+            for (size_t j = Start + 1; j < End; j++)
+            {
+                if (Y[j] < Y[MinIndex])
+                    MinIndex = j;
+                if (Y[j] > Y[MaxIndex])
+                    MaxIndex = j;
+            }
+        }
+
+#if TRADEFLOW_DOWNSAMPLE_SSE2
+        // Lane-wise running min/max with their indices, as in LargestTriangleSSE2
+        inline void MinMaxIndexSSE2(const double* Y, size_t Start, size_t End, size_t& MinIndex, size_t& MaxIndex)
+        {
+            if (End - Start < 4)
+            {
+                MinMaxIndexScalar(Y, Start, End, MinIndex, MaxIndex);
+                return;
+            }
+
+            __m128d Index = _mm_set_pd((double)Start + 1, (double)Start);
+            __m128d Low = _mm_loadu_pd(Y + Start), High = Low;
+            __m128d LowIndex = Index, HighIndex = Index;
+            const __m128d Two = _mm_set1_pd(2.0);
+            size_t j = Start + 2;
+            Index = _mm_add_pd(Index, Two);
+            for (; j + 2 <= End; j += 2)
+            {
+                __m128d Value = _mm_loadu_pd(Y + j);
+                __m128d Lower = _mm_cmplt_pd(Value, Low);
+                __m128d Higher = _mm_cmpgt_pd(Value, High);
+                Low = _mm_or_pd(_mm_and_pd(Lower, Value), _mm_andnot_pd(Lower, Low));
+                LowIndex = _mm_or_pd(_mm_and_pd(Lower, Index), _mm_andnot_pd(Lower, LowIndex));
+                High = _mm_or_pd(_mm_and_pd(Higher, Value), _mm_andnot_pd(Higher, High));
+                HighIndex = _mm_or_pd(_mm_and_pd(Higher, Index), _mm_andnot_pd(Higher, HighIndex));
+                Index = _mm_add_pd(Index, Two);
+            }
+
+            double Lows[2], LowIndexes[2], Highs[2], HighIndexes[2];
+            _mm_storeu_pd(Lows, Low);
+            _mm_storeu_pd(LowIndexes, LowIndex);
+            _mm_storeu_pd(Highs, High);
+            _mm_storeu_pd(HighIndexes, HighIndex);
+            MinIndex = (size_t)LowIndexes[0];
+            MaxIndex = (size_t)HighIndexes[0];
+            if (Lows[1] < Lows[0] || (Lows[1] == Lows[0] && (size_t)LowIndexes[1] < MinIndex))
+                MinIndex = (size_t)LowIndexes[1];
+            if (Highs[1] > Highs[0] || (Highs[1] == Highs[0] && (size_t)HighIndexes[1] < MaxIndex))
+                MaxIndex = (size_t)HighIndexes[1];
+            if (j < End)
+            {
+                if (Y[j] < Y[MinIndex])
+                    MinIndex = j;
+                if (Y[j] > Y[MaxIndex])
+                    MaxIndex = j;
+            }
+        }
+#endif
+
+        inline void MinMaxIndex(const double* Y, size_t Start, size_t End, size_t& MinIndex, size_t& MaxIndex)
+        {
+#if TRADEFLOW_DOWNSAMPLE_SSE2
+            MinMaxIndexSSE2(Y, Start, End, MinIndex, MaxIndex);
+#else
+            MinMaxIndexScalar(Y, Start, End, MinIndex, MaxIndex);
+#endif
+        }
+    }
+
+    // Out[b] = Kind applied to In[b * BucketSize, (b + 1) * BucketSize); the last
+    // bucket may be short. Out holds BucketCount(Count, BucketSize) values.
+    inline void BucketReduce(const double* In, size_t Count, size_t BucketSize, e_BucketReduce Kind, double* Out)
+    {
+        if (BucketSize == 0)
+            return;
+        size_t Buckets = BucketCount(Count, BucketSize);
+        for (size_t b = 0; b < Buckets; b++)
+        {
+            size_t Start = b * BucketSize;
+            size_t Size = Start + BucketSize <= Count ? BucketSize : Count - Start;
+            switch (Kind)
+            {
+            case BUCKET_FIRST:
+                Out[b] = In[Start];
+                break;
+            case BUCKET_LAST:
+                Out[b] = In[Start + Size - 1];
+                break;
+            default:
+                Out[b] = n_Downsample::Reduce(In + Start, Size, Kind);
+                break;
+            }
+        }
+    }
+
+    // Every index when nothing needs dropping, else just the end points
+    inline size_t KeepEnds(size_t Count, size_t MaxPoints, int64_t* OutIndex)
+    {
+        size_t Kept = 0;
+        if (MaxPoints >= Count)
+        {
+            for (; Kept < Count; Kept++)
+                OutIndex[Kept] = (int64_t)Kept;
+            return Kept;
+        }
+        if (MaxPoints > 0)
+            OutIndex[Kept++] = 0;
+        if (MaxPoints > 1)
+            OutIndex[Kept++] = (int64_t)(Count - 1);
+        return Kept;
+    }
+
+    // Largest-Triangle-Three-Buckets (Steinarsson): keeps the first and last
+    // points and, from each of Threshold - 2 equal buckets in between, the
+    // point with the largest triangle against the previous pick and the next
+    // bucket's centroid. X must be increasing; X and Y finite. Writes the kept
+    // indices to OutIndex (at most Threshold) and returns how many.
+    inline size_t DownsampleLTTB(const double* X, const double* Y, size_t Count, size_t Threshold, int64_t* OutIndex)
+    {
+        if (Threshold >= Count || Threshold < 3)
+            return KeepEnds(Count, Threshold, OutIndex);
+
+        double Every = (double)(Count - 2) / (double)(Threshold - 2);
+        size_t Kept = 0;
+        size_t A = 0;
+        OutIndex[Kept++] = 0;
+
+        for (size_t b = 0; b < Threshold - 2; b++)
+        {
+            size_t Start = (size_t)(b * Every) + 1;
+            size_t End = (size_t)((b + 1) * Every) + 1;
+            size_t NextEnd = b + 2 < Threshold - 1 ? (size_t)((b + 2) * Every) + 1 : Count;
+            if (End > Count - 1)
+                End = Count - 1;
+            if (NextEnd > Count)
+                NextEnd = Count;
+
+            // Next bucket's centroid (the last point for the final bucket)
+            size_t NextCount = NextEnd - End;
+            double Cx = n_Downsample::Reduce(X + End, NextCount, BUCKET_SUM) / (double)NextCount;
+            double Cy = n_Downsample::Reduce(Y + End, NextCount, BUCKET_SUM) / (double)NextCount;
+
+            A = n_Downsample::LargestTriangle(X, Y, Start, End, X[A], Y[A], Cx, Cy);
+            OutIndex[Kept++] = (int64_t)A;
+        }
+
+        OutIndex[Kept++] = (int64_t)(Count - 1);
+        return Kept;
+    }
+
+    // Min/max bucketing for line series: the first and last points plus, from
+    // each of (MaxPoints - 2) / 2 equal buckets in between, its lowest and
+    // highest point in index order. Keeps every spike LTTB might smooth over.
+    inline size_t DownsampleMinMax(const double* Y, size_t Count, size_t MaxPoints, int64_t* OutIndex)
+    {
+        if (MaxPoints >= Count || MaxPoints < 4)
+            return KeepEnds(Count, MaxPoints, OutIndex);
+
+        size_t Buckets = (MaxPoints - 2) / 2;
+        double Every = (double)(Count - 2) / (double)Buckets;
+        size_t Kept = 0;
+        OutIndex[Kept++] = 0;
+        for (size_t b = 0; b < Buckets; b++)
+        {
+            size_t Start = (size_t)(b * Every) + 1;
+            size_t End = b + 1 < Buckets ? (size_t)((b + 1) * Every) + 1 : Count - 1;
+            if (Start >= End)
+                continue;
+            size_t MinIndex, MaxIndex;
+            n_Downsample::MinMaxIndex(Y, Start, End, MinIndex, MaxIndex);
+            size_t First = MinIndex < MaxIndex ? MinIndex : MaxIndex;
+            size_t Second = MinIndex < MaxIndex ? MaxIndex : MinIndex;
+            OutIndex[Kept++] = (int64_t)First;
+            if (Second != First)
+                OutIndex[Kept++] = (int64_t)Second;
+        }
+        OutIndex[Kept++] = (int64_t)(Count - 1);
+        return Kept;
+    }
+}
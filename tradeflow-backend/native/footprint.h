@@ -0,0 +1,561 @@
+// TradeFlow Pro native footprint store
+// Volume at price per bar, pre-bucketed at ingest. Each (symbol, timeframe)
+// series keeps its recent bars in a ring; every bar owns a dense price ladder
+// indexed in tick units from its low, so a footprint query is a contiguous scan
+// over the ladders in range. Bars evicted from the ring are packed into sealed
+// columnar blocks (varint times/ticks, sparse levels, raw volumes) and only
+// decoded when a query reaches back that far.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    const int64_t FOOTPRINT_NOT_COVERED = std::numeric_limits<int64_t>::max();
+    const size_t FOOTPRINT_BLOCK_BARS = 256;      // Bars per sealed archive block
+    const size_t FOOTPRINT_MAX_LEVELS = 1 << 16;  // Ladder span guard against bad prints
+
+    struct s_FootprintLevel
+    {
+        double Volume = 0.0;
+        double BidVolume = 0.0;
+        double AskVolume = 0.0;
+    };
+
+    struct s_FootprintBar
+    {
+        int64_t StartTime = 0;   // Bucket start, epoch microseconds
+        int64_t LowTick = 0;     // Price of Levels[0] in tick units
+        std::vector<s_FootprintLevel> Levels;
+
+        bool Add(int64_t Tick, double Volume, double BidVolume, double AskVolume)
+        {
+            if (Levels.empty())
+            {
+                LowTick = Tick;
+                Levels.resize(1);
+            }
+            else if (Tick < LowTick)
+            {
+                size_t Grow = (size_t)(LowTick - Tick);
+                if (Levels.size() + Grow > FOOTPRINT_MAX_LEVELS)
+                    return false;
+                Levels.insert(Levels.begin(), Grow, s_FootprintLevel());
+                LowTick = Tick;
+            }
+            else if (Tick - LowTick >= (int64_t)Levels.size())
+            {
+                size_t Size = (size_t)(Tick - LowTick) + 1;
+                if (Size > FOOTPRINT_MAX_LEVELS)
+                    return false;
+                Levels.resize(Size);
+            }
+
+            s_FootprintLevel& Level = Levels[(size_t)(Tick - LowTick)];
+            Level.Volume += Volume;
+            Level.BidVolume += BidVolume;
+            Level.AskVolume += AskVolume;
+            return true;
+        }
+    };
+
+    // Columnar footprint bars with only non-empty levels kept. Used both as the
+    // query result and as the unsealed tail of the archive.
+    struct s_FootprintColumns
+    {
+        std::vector<int64_t> Times;
+        std::vector<int64_t> LowTicks;
+        std::vector<uint32_t> LevelStart;   // Bar b owns levels [LevelStart[b], LevelStart[b + 1])
+        std::vector<uint32_t> TickOffsets;  // Tick - LowTick of each level
+        std::vector<double> Volume;
+        std::vector<double> BidVolume;
+        std::vector<double> AskVolume;
+
+        size_t BarCount() const { return Times.size(); }
+
+        void Clear()
+        {
+            Times.clear();
+            LowTicks.clear();
+            LevelStart.clear();
+            TickOffsets.clear();
+            Volume.clear();
+            BidVolume.clear();
+            AskVolume.clear();
+        }
+
+        void Append(const s_FootprintBar& Bar)
+        {
+            if (LevelStart.empty())
+                LevelStart.push_back(0);
+            Times.push_back(Bar.StartTime);
+            LowTicks.push_back(Bar.LowTick);
+            for (size_t l = 0; l < Bar.Levels.size(); l++)
+            {
+                const s_FootprintLevel& Level = Bar.Levels[l];
+                if (Level.Volume == 0.0 && Level.BidVolume == 0.0 && Level.AskVolume == 0.0)
+                    continue;
+                TickOffsets.push_back((uint32_t)l);
+                Volume.push_back(Level.Volume);
+                BidVolume.push_back(Level.BidVolume);
+                AskVolume.push_back(Level.AskVolume);
+            }
+            LevelStart.push_back((uint32_t)TickOffsets.size());
+        }
+
+        // Appends bar b of Source (already sparse)
+        void AppendFrom(const s_FootprintColumns& Source, size_t b)
+        {
+            if (LevelStart.empty())
+                LevelStart.push_back(0);
+            Times.push_back(Source.Times[b]);
+            LowTicks.push_back(Source.LowTicks[b]);
+            for (uint32_t l = Source.LevelStart[b]; l < Source.LevelStart[b + 1]; l++)
+            {
+                TickOffsets.push_back(Source.TickOffsets[l]);
+                Volume.push_back(Source.Volume[l]);
+                BidVolume.push_back(Source.BidVolume[l]);
+                AskVolume.push_back(Source.AskVolume[l]);
+            }
+            LevelStart.push_back((uint32_t)TickOffsets.size());
+        }
+    };
+
+    // Byte encoding of s_FootprintColumns: bar count, then delta-varint times,
+    // zigzag-delta low ticks, varint level counts and tick offsets, raw doubles
+    namespace n_FootprintCodec
+    {
+        inline void PutVarint(std::string& Out, uint64_t Value)
+        {
+            while (Value >= 0x80)
+            {
+                Out.push_back((char)(Value | 0x80));
+                Value >>= 7;
+            }
+            Out.push_back((char)Value);
+        }
+
+        inline void PutZigZag(std::string& Out, int64_t Value)
+        {
+            PutVarint(Out, ((uint64_t)Value << 1) ^ (uint64_t)(Value >> 63));
+        }
+
+        inline void PutDoubles(std::string& Out, const std::vector<double>& Values)
+        {
+            if (!Values.empty())
+                Out.append((const char*)Values.data(), Values.size() * sizeof(double));
+        }
+
+        inline bool GetVarint(const std::string& In, size_t& Pos, uint64_t& Value)
+        {
+            Value = 0;
+            for (int Shift = 0; Shift < 64 && Pos < In.size(); Shift += 7)
+            {
+                uint8_t Byte = (uint8_t)In[Pos++];
+                Value |= (uint64_t)(Byte & 0x7F) << Shift;
+                if ((Byte & 0x80) == 0)
+                    return true;
+            }
+            return false;
+        }
+
+        inline bool GetZigZag(const std::string& In, size_t& Pos, int64_t& Value)
+        {
+            uint64_t Raw;
+            if (!GetVarint(In, Pos, Raw))
+                return false;
+            Value = (int64_t)(Raw >> 1) ^ -(int64_t)(Raw & 1);
+            return true;
+        }
+
+        inline bool GetDoubles(const std::string& In, size_t& Pos, size_t Count, std::vector<double>& Values)
+        {
+            size_t Bytes = Count * sizeof(double);
+            if (In.size() - Pos < Bytes)
+                return false;
+            Values.resize(Count);
+            if (Count > 0)
+                memcpy(Values.data(), In.data() + Pos, Bytes);
+            Pos += Bytes;
+            return true;
+        }
+
+        inline std::string Encode(const s_FootprintColumns& Columns)
+        {
+            std::string Out;
+            size_t Bars = Columns.BarCount();
+            PutVarint(Out, Bars);
+
+            int64_t PreviousTime = 0;
+            int64_t PreviousTick = 0;
+            for (size_t b = 0; b < Bars; b++)
+            {
+                PutZigZag(Out, Columns.Times[b] - PreviousTime);
+                PutZigZag(Out, Columns.LowTicks[b] - PreviousTick);
+                PutVarint(Out, Columns.LevelStart[b + 1] - Columns.LevelStart[b]);
+                PreviousTime = Columns.Times[b];
+                PreviousTick = Columns.LowTicks[b];
+            }
+
+            // Offsets restart at each bar and ascend, so store the gaps
+            for (size_t b = 0; b < Bars; b++)
+            {
+                uint32_t Previous = 0;
+                for (uint32_t l = Columns.LevelStart[b]; l < Columns.LevelStart[b + 1]; l++)
+                {
+                    PutVarint(Out, Columns.TickOffsets[l] - Previous);
+                    Previous = Columns.TickOffsets[l];
+                }
+            }
+
+            PutDoubles(Out, Columns.Volume);
+            PutDoubles(Out, Columns.BidVolume);
+            PutDoubles(Out, Columns.AskVolume);
+            return Out;
+        }
+
+        inline bool Decode(const std::string& In, s_FootprintColumns& Columns)
+        {
+            Columns.Clear();
+            size_t Pos = 0;
+            uint64_t Bars;
+            if (!GetVarint(In, Pos, Bars))
+                return false;
+
+            Columns.LevelStart.push_back(0);
+            int64_t Time = 0;
+            int64_t Tick = 0;
+            for (uint64_t b = 0; b < Bars; b++)
+            {
+                int64_t TimeDelta, TickDelta;
+                uint64_t Count;
+                if (!GetZigZag(In, Pos, TimeDelta) || !GetZigZag(In, Pos, TickDelta) || !GetVarint(In, Pos, Count))
+                    return false;
+                Time += TimeDelta;
+                Tick += TickDelta;
+                Columns.Times.push_back(Time);
+                Columns.LowTicks.push_back(Tick);
+                Columns.LevelStart.push_back(Columns.LevelStart.back() + (uint32_t)Count);
+            }
+
+            size_t Levels = Columns.LevelStart.back();
+            Columns.TickOffsets.resize(Levels);
+            for (uint64_t b = 0; b < Bars; b++)
+            {
+                uint32_t Offset = 0;
+                for (uint32_t l = Columns.LevelStart[b]; l < Columns.LevelStart[b + 1]; l++)
+                {
+                    uint64_t Gap;
+                    if (!GetVarint(In, Pos, Gap))
+                        return false;
+                    Offset += (uint32_t)Gap;
+                    Columns.TickOffsets[l] = Offset;
+                }
+            }
+
+            return GetDoubles(In, Pos, Levels, Columns.Volume)
+                && GetDoubles(In, Pos, Levels, Columns.BidVolume)
+                && GetDoubles(In, Pos, Levels, Columns.AskVolume);
+        }
+    }
+
+    class c_FootprintSeries
+    {
+    public:
+        c_FootprintSeries(int64_t BarMicros, size_t RingBars, size_t MaxArchivedBars)
+            : BarMicros(BarMicros > 0 ? BarMicros : 1)
+            , Capacity(RingBars > 0 ? RingBars : 1)
+            , MaxArchivedBars(MaxArchivedBars)
+        {
+        }
+
+        // Adds volume at Tick to the bar containing Time. Bars already archived
+        // are immutable, so prints older than the ring are rejected.
+        bool Add(int64_t Time, int64_t Tick, double Volume, double BidVolume, double AskVolume)
+        {
+            int64_t BarStart = FloorToBar(Time);
+
+            if (Ring.empty())
+            {
+                // Partial first bucket: coverage starts at the next complete one
+                CoveredFrom = Time == BarStart ? BarStart : BarStart + BarMicros;
+                return PushBar(BarStart).Add(Tick, Volume, BidVolume, AskVolume);
+            }
+
+            s_FootprintBar& Newest = At(Count() - 1);
+            if (BarStart == Newest.StartTime)
+                return Newest.Add(Tick, Volume, BidVolume, AskVolume);
+            if (BarStart > Newest.StartTime)
+                return PushBar(BarStart).Add(Tick, Volume, BidVolume, AskVolume);
+
+            // Late print: only bars still in the ring can take it. A bucket that was
+            // skipped entirely (no bar in the ring) is dropped to keep the ring sorted.
+            size_t Index = LowerBound(BarStart);
+            if (Index >= Count() || At(Index).StartTime != BarStart)
+                return false;
+            return At(Index).Add(Tick, Volume, BidVolume, AskVolume);
+        }
+
+        // Bars with StartTime in [StartTime, EndTime], oldest first
+        void Query(int64_t StartTime, int64_t EndTime, s_FootprintColumns& Out) const
+        {
+            Out.Clear();
+            int64_t First = FloorToBar(StartTime);
+            if (EndTime < First)
+                return;
+
+            if (!Archive.empty() || Open.BarCount() > 0)
+            {
+                s_FootprintColumns Decoded;
+                for (const s_SealedBlock& Block : Archive)
+                {
+                    if (Block.LastTime < First || Block.FirstTime > EndTime)
+                        continue;
+                    if (!n_FootprintCodec::Decode(Block.Bytes, Decoded))
+                        continue;
+                    AppendRange(Decoded, First, EndTime, Out);
+                }
+                AppendRange(Open, First, EndTime, Out);
+            }
+
+            for (size_t i = LowerBound(First); i < Count(); i++)
+            {
+                const s_FootprintBar& Bar = At(i);
+                if (Bar.StartTime > EndTime)
+                    break;
+                Out.Append(Bar);
+            }
+        }
+
+        // First bucket whose footprint is complete in this series
+        int64_t GetCoveredFrom() const
+        {
+            if (Ring.empty())
+                return FOOTPRINT_NOT_COVERED;
+            int64_t Oldest = Archive.empty()
+                ? (Open.BarCount() > 0 ? Open.Times.front() : At(0).StartTime)
+                : Archive.front().FirstTime;
+            return std::max(CoveredFrom, Oldest);
+        }
+
+        size_t Count() const { return Ring.size() < Capacity ? Ring.size() : Capacity; }
+        size_t ArchivedBars() const { return SealedBars + Open.BarCount(); }
+
+        size_t ArchivedBytes() const
+        {
+            size_t Bytes = 0;
+            for (const s_SealedBlock& Block : Archive)
+                Bytes += Block.Bytes.size();
+            return Bytes;
+        }
+
+    private:
+        struct s_SealedBlock
+        {
+            int64_t FirstTime;
+            int64_t LastTime;
+            size_t Bars;
+            std::string Bytes;
+        };
+
+        int64_t FloorToBar(int64_t Time) const
+        {
+            int64_t Bar = Time / BarMicros * BarMicros;
+            return Bar > Time ? Bar - BarMicros : Bar;  // Floor for pre-epoch times
+        }
+
+        // Logical index 0 is the oldest bar in the ring
+        s_FootprintBar& At(size_t i) { return Ring[(Head + i) % Ring.size()]; }
+        const s_FootprintBar& At(size_t i) const { return Ring[(Head + i) % Ring.size()]; }
+
+        size_t LowerBound(int64_t Time) const
+        {
+            size_t Low = 0, High = Count();
+            while (Low < High)
+            {
+                size_t Mid = (Low + High) / 2;
+                if (At(Mid).StartTime < Time)
+                    Low = Mid + 1;
+                else
+                    High = Mid;
+            }
+            return Low;
+        }
+
+        s_FootprintBar& PushBar(int64_t BarStart)
+        {
+            if (Ring.size() < Capacity)
+            {
+                Ring.emplace_back();
+                Ring.back().StartTime = BarStart;
+                return Ring.back();
+            }
+
+            // Full: archive the oldest bar and reuse its slot (keeps the allocation)
+            s_FootprintBar& Slot = Ring[Head];
+            ArchiveBar(Slot);
+            Head = (Head + 1) % Capacity;
+            Slot.StartTime = BarStart;
+            Slot.LowTick = 0;
+            Slot.Levels.clear();
+            return Slot;
+        }
+
+        void ArchiveBar(const s_FootprintBar& Bar)
+        {
+            if (MaxArchivedBars == 0)
+                return;
+
+            Open.Append(Bar);
+            if (Open.BarCount() >= FOOTPRINT_BLOCK_BARS)
+            {
+                s_SealedBlock Block;
+                Block.FirstTime = Open.Times.front();
+                Block.LastTime = Open.Times.back();
+                Block.Bars = Open.BarCount();
+                Block.Bytes = n_FootprintCodec::Encode(Open);
+                SealedBars += Block.Bars;
+                Archive.push_back(std::move(Block));
+                Open.Clear();
+            }
+
+            while (!Archive.empty() && SealedBars + Open.BarCount() > MaxArchivedBars)
+            {
+                SealedBars -= Archive.front().Bars;
+                Archive.pop_front();
+            }
+        }
+
+        static void AppendRange(const s_FootprintColumns& Source, int64_t StartTime, int64_t EndTime, s_FootprintColumns& Out)
+        {
+            size_t b = std::lower_bound(Source.Times.begin(), Source.Times.end(), StartTime) - Source.Times.begin();
+            for (; b < Source.BarCount() && Source.Times[b] <= EndTime; b++)
+                Out.AppendFrom(Source, b);
+        }
+
+        int64_t BarMicros;
+        size_t Capacity;
+        size_t MaxArchivedBars;
+        int64_t CoveredFrom = FOOTPRINT_NOT_COVERED;
+
+        std::vector<s_FootprintBar> Ring;
+        size_t Head = 0;
+
+        std::deque<s_SealedBlock> Archive;
+        size_t SealedBars = 0;
+        s_FootprintColumns Open;   // Archived bars not yet sealed into a block
+    };
+
+    struct s_FootprintStats
+    {
+        size_t Series = 0;
+        size_t RingBars = 0;
+        size_t ArchivedBars = 0;
+        size_t ArchivedBytes = 0;
+    };
+
+    // All footprint series: every trade/bar fed for a symbol updates each
+    // configured timeframe. Single-threaded, like the other ingest-fed engines.
+    class c_FootprintStore
+    {
+    public:
+        c_FootprintStore(double TickSize, const std::vector<int>& TimeframeSeconds, size_t RingBars, size_t ArchivedBars)
+            : TickSize(TickSize > 0 ? TickSize : 0.01)
+            , TicksPerUnit(1.0 / this->TickSize)
+            , Timeframes(TimeframeSeconds)
+            , RingBars(RingBars)
+            , ArchivedBarsPerSeries(ArchivedBars)
+        {
+        }
+
+        int64_t ToTick(double Price) const { return (int64_t)llround(Price * TicksPerUnit); }
+
+        // Dividing by the (usually integral) ticks-per-unit keeps prices like
+        // 100.07 exact instead of 10007 * 0.01
+        double ToPrice(int64_t Tick) const { return (double)Tick / TicksPerUnit; }
+
+        bool Add(const std::string& Symbol, int64_t Time, double Price, double Volume, double BidVolume, double AskVolume)
+        {
+            if (!std::isfinite(Price))
+                return false;
+
+            std::vector<c_FootprintSeries>& SymbolSeries = GetSymbol(Symbol);
+            int64_t Tick = ToTick(Price);
+            bool Added = true;
+            for (c_FootprintSeries& Series : SymbolSeries)
+                Added &= Series.Add(Time, Tick, Volume, BidVolume, AskVolume);
+            return Added;
+        }
+
+        const c_FootprintSeries* Find(const std::string& Symbol, int TimeframeSeconds) const
+        {
+            auto Found = Symbols.find(Symbol);
+            if (Found == Symbols.end())
+                return nullptr;
+            for (size_t t = 0; t < Timeframes.size(); t++)
+                if (Timeframes[t] == TimeframeSeconds)
+                    return &Found->second[t];
+            return nullptr;
+        }
+
+        int64_t CoveredFrom(const std::string& Symbol, int TimeframeSeconds) const
+        {
+            const c_FootprintSeries* Series = Find(Symbol, TimeframeSeconds);
+            return Series != nullptr ? Series->GetCoveredFrom() : FOOTPRINT_NOT_COVERED;
+        }
+
+        bool Query(const std::string& Symbol, int TimeframeSeconds, int64_t StartTime, int64_t EndTime, s_FootprintColumns& Out) const
+        {
+            const c_FootprintSeries* Series = Find(Symbol, TimeframeSeconds);
+            if (Series == nullptr)
+                return false;
+            Series->Query(StartTime, EndTime, Out);
+            return true;
+        }
+
+        s_FootprintStats GetStats() const
+        {
+            s_FootprintStats Stats;
+            for (const auto& Entry : Symbols)
+            {
+                for (const c_FootprintSeries& Series : Entry.second)
+                {
+                    Stats.Series++;
+                    Stats.RingBars += Series.Count();
+                    Stats.ArchivedBars += Series.ArchivedBars();
+                    Stats.ArchivedBytes += Series.ArchivedBytes();
+                }
+            }
+            return Stats;
+        }
+
+    private:
+        std::vector<c_FootprintSeries>& GetSymbol(const std::string& Symbol)
+        {
+            auto Found = Symbols.find(Symbol);
+            if (Found != Symbols.end())
+                return Found->second;
+
+            std::vector<c_FootprintSeries>& SymbolSeries = Symbols[Symbol];
+            for (int Seconds : Timeframes)
+                SymbolSeries.emplace_back((int64_t)Seconds * 1000000, RingBars, ArchivedBarsPerSeries);
+            return SymbolSeries;
+        }
+
+        double TickSize;
+        double TicksPerUnit;
+        std::vector<int> Timeframes;
+        size_t RingBars;
+        size_t ArchivedBarsPerSeries;
+        std::unordered_map<std::string, std::vector<c_FootprintSeries>> Symbols;
+    };
+}
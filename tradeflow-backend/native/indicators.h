@@ -0,0 +1,561 @@
+// TradeFlow Pro native indicator library
+// Streaming indicator states (O(1) per bar) and batch kernels for cold starts
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    // Fixed-capacity ring of doubles backing every rolling window
+    struct s_RollingWindow
+    {
+        std::vector<double> Values;
+        size_t Head = 0;
+        size_t Count = 0;
+
+        explicit s_RollingWindow(size_t Capacity = 1)
+            : Values(Capacity > 0 ? Capacity : 1, 0.0)
+        {
+        }
+
+        size_t Capacity() const { return Values.size(); }
+        bool IsFull() const { return Count == Values.size(); }
+
+        // Stores Value and returns the value that fell out of the window (0 until full)
+        double Push(double Value)
+        {
+            double Evicted = 0.0;
+            if (IsFull())
+                Evicted = Values[Head];
+            else
+                Count++;
+
+            Values[Head] = Value;
+            Head = (Head + 1) % Values.size();
+            return Evicted;
+        }
+
+        // Exact sum of the window, used to cancel running-sum drift once per revolution
+        double Sum() const
+        {
+            double Total = 0.0;
+            for (size_t i = 0; i < Count; i++)
+                Total += Values[i];
+            return Total;
+        }
+
+        double SumSquares() const
+        {
+            double Total = 0.0;
+            for (size_t i = 0; i < Count; i++)
+                Total += Values[i] * Values[i];
+            return Total;
+        }
+
+        void Reset()
+        {
+            Head = 0;
+            Count = 0;
+        }
+    };
+
+    /*========================================================================
+        Streaming states
+        Each Update() is O(1) (amortized: running sums are re-synced from the
+        window once every Period updates). Values that pandas would report as
+        NaN during warm-up are returned as NaN here as well.
+    ------------------------------------------------------------------------*/
+
+    struct s_SMAState
+    {
+        s_RollingWindow Window;
+        double RunningSum = 0.0;
+
+        explicit s_SMAState(int Period = 14) : Window(Period > 0 ? Period : 1) {}
+
+        bool IsReady() const { return Window.IsFull(); }
+
+        double Update(double Value)
+        {
+            RunningSum += Value - Window.Push(Value);
+            if (Window.Head == 0)
+                RunningSum = Window.Sum();
+
+            if (!Window.IsFull())
+                return NaN;
+            return RunningSum / Window.Capacity();
+        }
+
+        void Reset()
+        {
+            Window.Reset();
+            RunningSum = 0.0;
+        }
+    };
+
+    // Matches pandas ewm(span=Period, adjust=False): seeded with the first value
+    struct s_EMAState
+    {
+        double Alpha = 0.0;
+        double Value = 0.0;
+        bool Seeded = false;
+
+        explicit s_EMAState(int Period = 14) : Alpha(2.0 / ((Period > 0 ? Period : 1) + 1.0)) {}
+
+        bool IsReady() const { return Seeded; }
+
+        double Update(double Input)
+        {
+            if (!Seeded)
+            {
+                Value = Input;
+                Seeded = true;
+            }
+            else
+            {
+                Value += Alpha * (Input - Value);
+            }
+            return Value;
+        }
+
+        void Reset()
+        {
+            Value = 0.0;
+            Seeded = false;
+        }
+    };
+
+    // Simple-average RSI, identical to IndicatorService.calculate_rsi
+    struct s_RSIState
+    {
+        s_SMAState Gains;
+        s_SMAState Losses;
+        double PreviousClose = 0.0;
+        bool HasPrevious = false;
+
+        explicit s_RSIState(int Period = 14) : Gains(Period), Losses(Period) {}
+
+        bool IsReady() const { return Gains.IsReady(); }
+
+        double Update(double Close)
+        {
+            double Delta = HasPrevious ? Close - PreviousClose : 0.0;
+            PreviousClose = Close;
+            HasPrevious = true;
+
+            double AverageGain = Gains.Update(Delta > 0 ? Delta : 0.0);
+            double AverageLoss = Losses.Update(Delta < 0 ? -Delta : 0.0);
+
+            if (std::isnan(AverageGain))
+                return NaN;
+            if (AverageLoss == 0.0)
+                return AverageGain == 0.0 ? NaN : 100.0;
+            return 100.0 - 100.0 / (1.0 + AverageGain / AverageLoss);
+        }
+
+        void Reset()
+        {
+            Gains.Reset();
+            Losses.Reset();
+            HasPrevious = false;
+        }
+    };
+
+    struct s_MACDValue
+    {
+        double MACD;
+        double Signal;
+        double Histogram;
+    };
+
+    struct s_MACDState
+    {
+        s_EMAState Fast;
+        s_EMAState Slow;
+        s_EMAState SignalLine;
+
+        s_MACDState(int FastPeriod = 12, int SlowPeriod = 26, int SignalPeriod = 9)
+            : Fast(FastPeriod), Slow(SlowPeriod), SignalLine(SignalPeriod)
+        {
+        }
+
+        bool IsReady() const { return SignalLine.IsReady(); }
+
+        s_MACDValue Update(double Close)
+        {
+            double Line = Fast.Update(Close) - Slow.Update(Close);
+            double Signal = SignalLine.Update(Line);
+            return { Line, Signal, Line - Signal };
+        }
+
+        void Reset()
+        {
+            Fast.Reset();
+            Slow.Reset();
+            SignalLine.Reset();
+        }
+    };
+
+    struct s_BollingerValue
+    {
+        double Upper;
+        double Middle;
+        double Lower;
+    };
+
+    // Uses the sample standard deviation (ddof = 1) like pandas rolling().std()
+    struct s_BollingerState
+    {
+        s_RollingWindow Window;
+        double StdDevMultiplier = 2.0;
+        double RunningSum = 0.0;
+        double RunningSumSquares = 0.0;
+
+        s_BollingerState(int Period = 20, double StdDev = 2.0)
+            : Window(Period > 0 ? Period : 1), StdDevMultiplier(StdDev)
+        {
+        }
+
+        bool IsReady() const { return Window.IsFull(); }
+
+        s_BollingerValue Update(double Close)
+        {
+            double Evicted = Window.Push(Close);
+            RunningSum += Close - Evicted;
+            RunningSumSquares += Close * Close - Evicted * Evicted;
+            if (Window.Head == 0)
+            {
+                RunningSum = Window.Sum();
+                RunningSumSquares = Window.SumSquares();
+            }
+
+            if (!Window.IsFull())
+                return { NaN, NaN, NaN };
+
+            double N = (double)Window.Capacity();
+            double Mean = RunningSum / N;
+            double StdDev = NaN;
+            if (N > 1)
+            {
+                double Variance = (RunningSumSquares - RunningSum * Mean) / (N - 1);
+                StdDev = Variance > 0 ? std::sqrt(Variance) : 0.0;
+            }
+
+            return { Mean + StdDev * StdDevMultiplier, Mean, Mean - StdDev * StdDevMultiplier };
+        }
+
+        void Reset()
+        {
+            Window.Reset();
+            RunningSum = 0.0;
+            RunningSumSquares = 0.0;
+        }
+    };
+
+    // Simple-average ATR, identical to IndicatorService.calculate_atr
+    struct s_ATRState
+    {
+        s_SMAState TrueRanges;
+        double PreviousClose = 0.0;
+        bool HasPrevious = false;
+
+        explicit s_ATRState(int Period = 14) : TrueRanges(Period) {}
+
+        bool IsReady() const { return TrueRanges.IsReady(); }
+
+        double Update(double High, double Low, double Close)
+        {
+            double TrueRange = High - Low;
+            if (HasPrevious)
+            {
+                TrueRange = std::fmax(TrueRange, std::fabs(High - PreviousClose));
+                TrueRange = std::fmax(TrueRange, std::fabs(Low - PreviousClose));
+            }
+            PreviousClose = Close;
+            HasPrevious = true;
+            return TrueRanges.Update(TrueRange);
+        }
+
+        void Reset()
+        {
+            TrueRanges.Reset();
+            HasPrevious = false;
+        }
+    };
+
+    /*========================================================================
+        Batch kernels
+        Cold-start paths over contiguous arrays. SMA and Bollinger use a
+        prefix-sum pass followed by a branch-free window difference that the
+        compiler vectorizes; recursive indicators run the streaming state.
+        Inputs are shifted by the first value before summing to keep the
+        prefix sums small and the variance free of cancellation error.
+    ------------------------------------------------------------------------*/
+
+    inline void BatchSMA(const double* In, size_t Count, int Period, double* Out)
+    {
+        if (Count == 0)
+            return;
+        size_t P = Period > 0 ? (size_t)Period : 1;
+
+        std::vector<double> Prefix(Count + 1);
+        double Origin = In[0];
+        Prefix[0] = 0.0;
+        for (size_t i = 0; i < Count; i++)
+            Prefix[i + 1] = Prefix[i] + (In[i] - Origin);
+
+        size_t Warmup = P - 1 < Count ? P - 1 : Count;
+        for (size_t i = 0; i < Warmup; i++)
+            Out[i] = NaN;
+
+        double InvPeriod = 1.0 / P;
+        for (size_t i = Warmup; i < Count; i++)
+            Out[i] = Origin + (Prefix[i + 1] - Prefix[i + 1 - P]) * InvPeriod;
+    }
+
+    inline void BatchEMA(const double* In, size_t Count, int Period, double* Out)
+    {
+        s_EMAState State(Period);
+        for (size_t i = 0; i < Count; i++)
+            Out[i] = State.Update(In[i]);
+    }
+
+    inline void BatchRSI(const double* In, size_t Count, int Period, double* Out)
+    {
+        s_RSIState State(Period);
+        for (size_t i = 0; i < Count; i++)
+            Out[i] = State.Update(In[i]);
+    }
+
+    inline void BatchMACD(const double* In, size_t Count, int FastPeriod, int SlowPeriod, int SignalPeriod,
+        double* OutMACD, double* OutSignal, double* OutHistogram)
+    {
+        s_MACDState State(FastPeriod, SlowPeriod, SignalPeriod);
+        for (size_t i = 0; i < Count; i++)
+        {
+            s_MACDValue Value = State.Update(In[i]);
+            OutMACD[i] = Value.MACD;
+            OutSignal[i] = Value.Signal;
+            OutHistogram[i] = Value.Histogram;
+        }
+    }
+
+    inline void BatchBollinger(const double* In, size_t Count, int Period, double StdDev,
+        double* OutUpper, double* OutMiddle, double* OutLower)
+    {
+        if (Count == 0)
+            return;
+        size_t P = Period > 0 ? (size_t)Period : 1;
+
+        std::vector<double> Prefix(Count + 1);
+        std::vector<double> PrefixSquares(Count + 1);
+        double Origin = In[0];
+        Prefix[0] = 0.0;
+        PrefixSquares[0] = 0.0;
+        for (size_t i = 0; i < Count; i++)
+        {
+            double Shifted = In[i] - Origin;
+            Prefix[i + 1] = Prefix[i] + Shifted;
+            PrefixSquares[i + 1] = PrefixSquares[i] + Shifted * Shifted;
+        }
+
+        size_t Warmup = P - 1 < Count ? P - 1 : Count;
+        for (size_t i = 0; i < Warmup; i++)
+        {
+            OutUpper[i] = NaN;
+            OutMiddle[i] = NaN;
+            OutLower[i] = NaN;
+        }
+
+        double N = (double)P;
+        for (size_t i = Warmup; i < Count; i++)
+        {
+            double Sum = Prefix[i + 1] - Prefix[i + 1 - P];
+            double SumSquares = PrefixSquares[i + 1] - PrefixSquares[i + 1 - P];
+            double Mean = Sum / N;
+            double Variance = P > 1 ? (SumSquares - Sum * Mean) / (N - 1) : NaN;
+            double Deviation = (Variance > 0 ? std::sqrt(Variance) : (P > 1 ? 0.0 : NaN)) * StdDev;
+
+            OutMiddle[i] = Origin + Mean;
+            OutUpper[i] = Origin + Mean + Deviation;
+            OutLower[i] = Origin + Mean - Deviation;
+        }
+    }
+
+    inline void BatchATR(const double* High, const double* Low, const double* Close, size_t Count, int Period, double* Out)
+    {
+        s_ATRState State(Period);
+        for (size_t i = 0; i < Count; i++)
+            Out[i] = State.Update(High[i], Low[i], Close[i]);
+    }
+
+    /*========================================================================
+        Series buffer and indicator streams
+        An indicator stream owns one streaming state plus a ring of its recent
+        outputs, so serving the last N values is an O(N) copy.
+    ------------------------------------------------------------------------*/
+
+    struct s_SeriesBuffer
+    {
+        size_t Capacity = 0;
+        size_t Width = 1;
+        size_t Head = 0;
+        size_t Count = 0;
+        std::vector<int64_t> Times;
+        std::vector<double> Values;  // Capacity x Width, row-major
+
+        s_SeriesBuffer(size_t InCapacity = 1, size_t InWidth = 1)
+            : Capacity(InCapacity > 0 ? InCapacity : 1), Width(InWidth > 0 ? InWidth : 1),
+              Times(Capacity, 0), Values(Capacity * Width, 0.0)
+        {
+        }
+
+        double* Append(int64_t Time)
+        {
+            size_t Slot = Head;
+            Times[Slot] = Time;
+            Head = (Head + 1) % Capacity;
+            if (Count < Capacity)
+                Count++;
+            return &Values[Slot * Width];
+        }
+
+        int64_t LastTime() const
+        {
+            return Count > 0 ? Times[(Head + Capacity - 1) % Capacity] : std::numeric_limits<int64_t>::min();
+        }
+
+        // Copies the newest min(N, Count) rows oldest-first; returns the row count
+        size_t CopyTail(size_t N, int64_t* OutTimes, double* OutValues) const
+        {
+            if (N > Count)
+                N = Count;
+            size_t Start = (Head + Capacity - N) % Capacity;
+            for (size_t i = 0; i < N; i++)
+            {
+                size_t Slot = (Start + i) % Capacity;
+                OutTimes[i] = Times[Slot];
+                for (size_t w = 0; w < Width; w++)
+                    OutValues[i * Width + w] = Values[Slot * Width + w];
+            }
+            return N;
+        }
+
+        void Reset()
+        {
+            Head = 0;
+            Count = 0;
+        }
+    };
+
+    enum e_IndicatorKind
+    {
+        INDICATOR_SMA = 0,
+        INDICATOR_EMA,
+        INDICATOR_RSI,
+        INDICATOR_MACD,
+        INDICATOR_BOLLINGER,
+        INDICATOR_ATR,
+    };
+
+    inline bool ParseIndicatorKind(const std::string& Name, e_IndicatorKind& Kind)
+    {
+        if (Name == "sma") Kind = INDICATOR_SMA;
+        else if (Name == "ema") Kind = INDICATOR_EMA;
+        else if (Name == "rsi") Kind = INDICATOR_RSI;
+        else if (Name == "macd") Kind = INDICATOR_MACD;
+        else if (Name == "bollinger") Kind = INDICATOR_BOLLINGER;
+        else if (Name == "atr") Kind = INDICATOR_ATR;
+        else return false;
+        return true;
+    }
+
+    class c_IndicatorStream
+    {
+    public:
+        // Params: sma/ema/rsi/atr = {period}, macd = {fast, slow, signal}, bollinger = {period, std_dev}
+        c_IndicatorStream(e_IndicatorKind InKind, const std::vector<double>& Params, size_t HistoryCapacity)
+            : Kind(InKind),
+              SMA(ParamInt(Params, 0, 14)),
+              EMA(ParamInt(Params, 0, 14)),
+              RSI(ParamInt(Params, 0, 14)),
+              MACD(ParamInt(Params, 0, 12), ParamInt(Params, 1, 26), ParamInt(Params, 2, 9)),
+              Bollinger(ParamInt(Params, 0, 20), Params.size() > 1 ? Params[1] : 2.0),
+              ATR(ParamInt(Params, 0, 14)),
+              History(HistoryCapacity, Width(InKind))
+        {
+        }
+
+        static size_t Width(e_IndicatorKind Kind)
+        {
+            return (Kind == INDICATOR_MACD || Kind == INDICATOR_BOLLINGER) ? 3 : 1;
+        }
+
+        // Feeds one closed bar. Bars at or before the last seen time are ignored so
+        // re-sent bars cannot double-count. Returns false when the bar was ignored.
+        bool Update(int64_t Time, double High, double Low, double Close)
+        {
+            if (History.Count > 0 && Time <= History.LastTime())
+                return false;
+
+            double* Row = History.Append(Time);
+            switch (Kind)
+            {
+            case INDICATOR_SMA:
+                Row[0] = SMA.Update(Close);
+                break;
+            case INDICATOR_EMA:
+                Row[0] = EMA.Update(Close);
+                break;
+            case INDICATOR_RSI:
+                Row[0] = RSI.Update(Close);
+                break;
+            case INDICATOR_MACD:
+            {
+                s_MACDValue Value = MACD.Update(Close);
+                Row[0] = Value.MACD;
+                Row[1] = Value.Signal;
+                Row[2] = Value.Histogram;
+                break;
+            }
+            case INDICATOR_BOLLINGER:
+            {
+                s_BollingerValue Value = Bollinger.Update(Close);
+                Row[0] = Value.Upper;
+                Row[1] = Value.Middle;
+                Row[2] = Value.Lower;
+                break;
+            }
+            case INDICATOR_ATR:
+                Row[0] = ATR.Update(High, Low, Close);
+                break;
+            }
+            return true;
+        }
+
+        const s_SeriesBuffer& GetHistory() const { return History; }
+        e_IndicatorKind GetKind() const { return Kind; }
+
+    private:
+        static int ParamInt(const std::vector<double>& Params, size_t Index, int Default)
+        {
+            return Params.size() > Index ? (int)Params[Index] : Default;
+        }
+
+        e_IndicatorKind Kind;
+        s_SMAState SMA;
+        s_EMAState EMA;
+        s_RSIState RSI;
+        s_MACDState MACD;
+        s_BollingerState Bollinger;
+        s_ATRState ATR;
+        s_SeriesBuffer History;
+    };
+}
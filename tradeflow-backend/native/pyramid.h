@@ -0,0 +1,306 @@
+// TradeFlow Pro native bar pyramid
+// OHLCV at power-of-two resolutions (1s, 2s, 4s ... 2^N s) per symbol, all
+// rolled up from the same 1s bars as they arrive: each bar updates the forming
+// bucket of every level, O(levels) per bar. Every level is a fixed-capacity
+// columnar ring aligned to epoch multiples of its bucket, so a visible range at
+// any zoom is served from the finest level that fits the point budget by one
+// binary search and at most two contiguous copies per column, independent of
+// how much history exists.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    enum e_PyramidColumn
+    {
+        PYRAMID_OPEN = 0,
+        PYRAMID_HIGH,
+        PYRAMID_LOW,
+        PYRAMID_CLOSE,
+        PYRAMID_VOLUME,
+        PYRAMID_BID_VOLUME,
+        PYRAMID_ASK_VOLUME,
+        PYRAMID_NUMBER_OF_TRADES,
+        PYRAMID_OPEN_INTEREST,
+        PYRAMID_COLUMN_COUNT
+    };
+
+    // Same names and aggregation as the time_bucket path of get_bars
+    const char* const PYRAMID_COLUMN_NAMES[PYRAMID_COLUMN_COUNT] =
+    {
+        "open", "high", "low", "close", "volume", "bid_volume", "ask_volume", "number_of_trades", "open_interest"
+    };
+
+    const int PYRAMID_MAX_LEVELS = 24;   // 2^23 s is ~97 days per bucket
+    const int64_t PYRAMID_NOT_COVERED = std::numeric_limits<int64_t>::max();
+
+    // Start of the bucket holding Time (floor, also for times before 1970)
+    inline int64_t PyramidBucket(int64_t Time, int64_t BucketMicros)
+    {
+        int64_t Remainder = Time % BucketMicros;
+        return Time - (Remainder < 0 ? Remainder + BucketMicros : Remainder);
+    }
+
+    struct s_PyramidColumns
+    {
+        int Level = -1;
+        int64_t BucketSeconds = 0;
+        std::vector<int64_t> Time;
+        std::vector<double> Values[PYRAMID_COLUMN_COUNT];
+
+        size_t Size() const { return Time.size(); }
+    };
+
+    struct s_PyramidStats
+    {
+        size_t Symbols = 0;
+        size_t Levels = 0;
+        size_t Buckets = 0;     // Filled across all symbols and levels
+        size_t Queries = 0;
+        size_t Misses = 0;      // Ranges no level covered
+    };
+
+    // One resolution of one symbol: a ring of buckets, oldest at Head
+    class c_PyramidLevel
+    {
+    public:
+        c_PyramidLevel(int64_t BucketMicros, size_t Capacity)
+            : BucketMicros(BucketMicros)
+            , Capacity(Capacity > 0 ? Capacity : 1)
+            , Times(this->Capacity)
+        {
+            for (int c = 0; c < PYRAMID_COLUMN_COUNT; c++)
+                Values[c].resize(this->Capacity);
+        }
+
+        size_t Size() const { return Count; }
+
+        void Add(int64_t Time, const double* Bar)
+        {
+            int64_t Bucket = PyramidBucket(Time, BucketMicros);
+            if (Count > 0 && Bucket < Times[Slot(Count - 1)])
+                return;
+
+            if (Count == 0 || Bucket > Times[Slot(Count - 1)])
+            {
+                // The first bucket seen since startup is usually partial
+                if (FirstBucket == PYRAMID_NOT_COVERED)
+                    FirstBucket = Bucket;
+                if (Bucket == FirstBucket)
+                    return;
+                Open(Bucket, Bar);
+                return;
+            }
+
+            size_t s = Slot(Count - 1);
+            Values[PYRAMID_HIGH][s] = std::max(Values[PYRAMID_HIGH][s], Bar[PYRAMID_HIGH]);
+            Values[PYRAMID_LOW][s] = std::min(Values[PYRAMID_LOW][s], Bar[PYRAMID_LOW]);
+            Values[PYRAMID_CLOSE][s] = Bar[PYRAMID_CLOSE];
+            Values[PYRAMID_VOLUME][s] += Bar[PYRAMID_VOLUME];
+            for (int c : { PYRAMID_BID_VOLUME, PYRAMID_ASK_VOLUME, PYRAMID_NUMBER_OF_TRADES })
+                Values[c][s] = SumNullable(Values[c][s], Bar[c]);
+            Values[PYRAMID_OPEN_INTEREST][s] = Bar[PYRAMID_OPEN_INTEREST];
+        }
+
+        // Start of the oldest complete bucket held
+        int64_t CoveredFrom() const
+        {
+            return Count > 0 ? Times[Head] : PYRAMID_NOT_COVERED;
+        }
+
+        // Appends buckets with StartTime <= time <= EndTime, oldest first
+        void Range(int64_t StartTime, int64_t EndTime, s_PyramidColumns& Out) const
+        {
+            size_t First = LowerBound(StartTime);
+            size_t Last = LowerBound(EndTime == std::numeric_limits<int64_t>::max() ? EndTime : EndTime + 1);
+            if (Last <= First)
+                return;
+
+            // Logical [First, Last) is at most two physical runs of the ring
+            size_t Total = Last - First;
+            size_t Offset = Out.Size();
+            Out.Time.resize(Offset + Total);
+            for (int c = 0; c < PYRAMID_COLUMN_COUNT; c++)
+                Out.Values[c].resize(Offset + Total);
+
+            size_t Start = Slot(First);
+            size_t FirstRun = std::min(Total, Capacity - Start);
+            CopyRun(Start, FirstRun, Offset, Out);
+            if (FirstRun < Total)
+                CopyRun(0, Total - FirstRun, Offset + FirstRun, Out);
+        }
+
+    private:
+        int64_t BucketMicros;
+        size_t Capacity;
+        size_t Head = 0;
+        size_t Count = 0;
+        int64_t FirstBucket = PYRAMID_NOT_COVERED;
+        std::vector<int64_t> Times;
+        std::vector<double> Values[PYRAMID_COLUMN_COUNT];
+
+        static double SumNullable(double Total, double Value)
+        {
+            if (std::isnan(Value))
+                return Total;
+            return std::isnan(Total) ? Value : Total + Value;
+        }
+
+        size_t Slot(size_t Logical) const
+        {
+            size_t s = Head + Logical;
+            return s >= Capacity ? s - Capacity : s;
+        }
+
+        void Open(int64_t Bucket, const double* Bar)
+        {
+            size_t s;
+            if (Count < Capacity)
+                s = Slot(Count++);
+            else
+            {
+                s = Head;
+                Head = Slot(1);
+            }
+            Times[s] = Bucket;
+            for (int c = 0; c < PYRAMID_COLUMN_COUNT; c++)
+                Values[c][s] = Bar[c];
+        }
+
+        // First logical index whose time is >= Time
+        size_t LowerBound(int64_t Time) const
+        {
+            size_t Low = 0, High = Count;
+            while (Low < High)
+            {
+                size_t Mid = (Low + High) / 2;
+                if (Times[Slot(Mid)] < Time)
+                    Low = Mid + 1;
+                else
+                    High = Mid;
+            }
+            return Low;
+        }
+
+        void CopyRun(size_t Start, size_t Length, size_t Offset, s_PyramidColumns& Out) const
+        {
+            memcpy(Out.Time.data() + Offset, Times.data() + Start, Length * sizeof(int64_t));
+            for (int c = 0; c < PYRAMID_COLUMN_COUNT; c++)
+                memcpy(Out.Values[c].data() + Offset, Values[c].data() + Start, Length * sizeof(double));
+        }
+    };
+
+    class c_BarPyramid
+    {
+    public:
+        // Levels 0..Levels-1 hold buckets of 2^level seconds, LevelBars each
+        c_BarPyramid(int Levels, size_t LevelBars)
+            : Levels(std::min(std::max(Levels, 1), PYRAMID_MAX_LEVELS))
+            , LevelBars(LevelBars > 0 ? LevelBars : 1)
+        {
+        }
+
+        int LevelCount() const { return Levels; }
+
+        // Feeds one 1s bar (values in PYRAMID_COLUMN order, NaN for missing)
+        // into every level. Bars are expected in time order per symbol.
+        void Add(const std::string& Symbol, int64_t Time, const double* Bar)
+        {
+            std::vector<c_PyramidLevel>& Pyramid = GetSymbol(Symbol);
+            for (c_PyramidLevel& Level : Pyramid)
+                Level.Add(Time, Bar);
+        }
+
+        // The finest level whose buckets bring [StartTime, EndTime] to at most
+        // MaxPoints and that still holds StartTime's bucket; coarser levels
+        // keep more history, so a level too fine to cover the range is skipped.
+        // Returns false when no level covers the range.
+        bool Query(const std::string& Symbol, int64_t StartTime, int64_t EndTime, size_t MaxPoints, s_PyramidColumns& Out)
+        {
+            Queries++;
+            auto Found = Symbols.find(Symbol);
+            if (Found == Symbols.end() || EndTime < StartTime)
+                return Miss();
+
+            uint64_t Span = (uint64_t)(EndTime - StartTime) + 1;
+            uint64_t Budget = MaxPoints > 0 ? (uint64_t)MaxPoints : 1;
+            for (int l = 0; l < Levels; l++)
+            {
+                int64_t BucketMicros = (int64_t)1000000 << l;
+                // A range can straddle one more bucket than Span / BucketMicros
+                uint64_t Width = (uint64_t)BucketMicros;
+                if ((Span + Width - 1) / Width + 1 > Budget && l + 1 < Levels)
+                    continue;
+
+                const c_PyramidLevel& Level = Found->second[(size_t)l];
+                int64_t StartBucket = PyramidBucket(StartTime, BucketMicros);
+                if (Level.CoveredFrom() > StartBucket)
+                    continue;
+
+                Out.Level = l;
+                Out.BucketSeconds = (int64_t)1 << l;
+                Level.Range(StartBucket, EndTime, Out);
+                return true;
+            }
+            return Miss();
+        }
+
+        int64_t CoveredFrom(const std::string& Symbol, int Level) const
+        {
+            auto Found = Symbols.find(Symbol);
+            if (Found == Symbols.end() || Level < 0 || Level >= Levels)
+                return PYRAMID_NOT_COVERED;
+            return Found->second[(size_t)Level].CoveredFrom();
+        }
+
+        s_PyramidStats GetStats() const
+        {
+            s_PyramidStats Stats;
+            Stats.Symbols = Symbols.size();
+            Stats.Levels = (size_t)Levels;
+            Stats.Queries = Queries;
+            Stats.Misses = Misses;
+            for (const auto& Entry : Symbols)
+            {
+                for (const c_PyramidLevel& Level : Entry.second)
+                    Stats.Buckets += Level.Size();
+            }
+            return Stats;
+        }
+
+    private:
+        int Levels;
+        size_t LevelBars;
+        std::unordered_map<std::string, std::vector<c_PyramidLevel>> Symbols;
+        size_t Queries = 0;
+        size_t Misses = 0;
+
+        bool Miss()
+        {
+            Misses++;
+            return false;
+        }
+
+        std::vector<c_PyramidLevel>& GetSymbol(const std::string& Symbol)
+        {
+            auto Found = Symbols.find(Symbol);
+            if (Found != Symbols.end())
+                return Found->second;
+
+            std::vector<c_PyramidLevel>& Pyramid = Symbols[Symbol];
+            Pyramid.reserve((size_t)Levels);
+            for (int l = 0; l < Levels; l++)
+                Pyramid.emplace_back((int64_t)1000000 << l, LevelBars);
+            return Pyramid;
+        }
+    };
+}
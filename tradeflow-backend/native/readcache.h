@@ -0,0 +1,179 @@
+// TradeFlow Pro native read cache
+// In-process cache of query results tagged with the version of the stream they
+// were computed from. Ingest bumps a stream's version, which makes every entry
+// computed from an older version stale in O(1): no key scans, no deletes.
+// Each stream also remembers the times of its most recent changes, so a caller
+// holding a stale "newest N" result can tell whether the changes were all at or
+// after its newest row (pure appends) and extend it instead of recomputing.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    const size_t READCACHE_CHANGE_HISTORY = 64;   // Changes remembered per stream
+
+    struct s_ReadCacheStats
+    {
+        uint64_t Hits = 0;
+        uint64_t Misses = 0;
+        uint64_t Stale = 0;        // Found but computed from an older version
+        uint64_t Evictions = 0;
+        size_t Entries = 0;
+        size_t Cost = 0;
+    };
+
+    template <typename t_Payload>
+    struct s_ReadCacheLookup
+    {
+        t_Payload Payload;
+        bool Fresh = false;
+        bool Extendable = false;   // All changes since the entry are known
+        int64_t ChangedFrom = 0;   // Earliest change time since the entry (if Extendable)
+    };
+
+    // t_Payload is any cheaply copyable handle to an immutable result (a Python
+    // object in the bindings). Cost is caller-defined (e.g. rows) and bounds the
+    // cache; least recently used entries are evicted first.
+    template <typename t_Payload>
+    class c_VersionedCache
+    {
+    public:
+        explicit c_VersionedCache(size_t MaxCost) : MaxCost(MaxCost) {}
+
+        uint64_t Version(const std::string& Stream)
+        {
+            return Streams[InternStream(Stream)].Version;
+        }
+
+        // Records a change to Stream at Time (epoch microseconds) and returns the new version
+        uint64_t Bump(const std::string& Stream, int64_t Time)
+        {
+            s_Stream& State = Streams[InternStream(Stream)];
+            State.Version++;
+            State.Changes[State.Version % READCACHE_CHANGE_HISTORY] = Time;
+            return State.Version;
+        }
+
+        bool Lookup(const std::string& Key, s_ReadCacheLookup<t_Payload>& Result)
+        {
+            auto Found = Index.find(Key);
+            if (Found == Index.end())
+            {
+                Stats.Misses++;
+                return false;
+            }
+
+            s_Entry& Entry = *Found->second;
+            Entries.splice(Entries.begin(), Entries, Found->second);
+
+            const s_Stream& State = Streams[Entry.StreamId];
+            Result.Payload = Entry.Payload;
+            Result.Fresh = Entry.Version == State.Version;
+            Result.Extendable = false;
+            if (Result.Fresh)
+            {
+                Stats.Hits++;
+                return true;
+            }
+
+            Stats.Stale++;
+            if (State.Version - Entry.Version <= READCACHE_CHANGE_HISTORY)
+            {
+                int64_t Earliest = std::numeric_limits<int64_t>::max();
+                for (uint64_t v = Entry.Version + 1; v <= State.Version; v++)
+                    Earliest = std::min(Earliest, State.Changes[v % READCACHE_CHANGE_HISTORY]);
+                Result.Extendable = true;
+                Result.ChangedFrom = Earliest;
+            }
+            return true;
+        }
+
+        // Stores Payload as computed from Version (read before the query ran, so a
+        // change that lands mid-query leaves the entry stale rather than wrong)
+        void Put(const std::string& Key, const std::string& Stream, uint64_t Version, const t_Payload& Payload, size_t Cost)
+        {
+            Erase(Key);
+            if (Cost > MaxCost)
+                return;
+
+            Entries.push_front({ Key, InternStream(Stream), Version, Payload, Cost });
+            Index[Key] = Entries.begin();
+            TotalCost += Cost;
+
+            while (TotalCost > MaxCost && !Entries.empty())
+            {
+                Erase(Entries.back().Key);
+                Stats.Evictions++;
+            }
+        }
+
+        void Erase(const std::string& Key)
+        {
+            auto Found = Index.find(Key);
+            if (Found == Index.end())
+                return;
+            TotalCost -= Found->second->Cost;
+            Entries.erase(Found->second);
+            Index.erase(Found);
+        }
+
+        void Clear()
+        {
+            Entries.clear();
+            Index.clear();
+            TotalCost = 0;
+        }
+
+        s_ReadCacheStats GetStats() const
+        {
+            s_ReadCacheStats Result = Stats;
+            Result.Entries = Index.size();
+            Result.Cost = TotalCost;
+            return Result;
+        }
+
+    private:
+        struct s_Stream
+        {
+            uint64_t Version = 0;
+            int64_t Changes[READCACHE_CHANGE_HISTORY] = {};   // Change time by version % history
+        };
+
+        struct s_Entry
+        {
+            std::string Key;
+            uint32_t StreamId;
+            uint64_t Version;
+            t_Payload Payload;
+            size_t Cost;
+        };
+
+        uint32_t InternStream(const std::string& Stream)
+        {
+            auto Found = StreamIds.find(Stream);
+            if (Found != StreamIds.end())
+                return Found->second;
+            uint32_t Id = (uint32_t)Streams.size();
+            StreamIds.emplace(Stream, Id);
+            Streams.emplace_back();
+            return Id;
+        }
+
+        size_t MaxCost;
+        size_t TotalCost = 0;
+        std::list<s_Entry> Entries;   // Most recently used first
+        std::unordered_map<std::string, typename std::list<s_Entry>::iterator> Index;
+        std::unordered_map<std::string, uint32_t> StreamIds;
+        std::vector<s_Stream> Streams;   // Indexed by stream id
+        s_ReadCacheStats Stats;
+    };
+}
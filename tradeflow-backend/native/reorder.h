@@ -0,0 +1,222 @@
+// TradeFlow Pro native reorder buffer
+// Bars of one stream (symbol, timeframe) can reach ingest out of time order:
+// pipelined and retried batches, several collectors sending the same chart.
+// The rollups fed from ingest (bar store, pyramid, footprint, TPO, warm
+// indicators) only take bars newer than the last one they saw, so one early
+// newer bar hides every older bar behind it from them. This holds each
+// stream's bars sorted by time and releases them in order once the stream's
+// watermark (newest time pushed minus its lateness) passes them, or once the
+// stream has had no push for the hold time. A bar at or before the stream's
+// last released time is late and is handed back for the correction path; a
+// bar at a time already buffered replaces it (the newest version wins, as in
+// the upsert). Memory is bounded per stream (the oldest bars are released
+// early past MaxBarsPerStream) and in streams (the least recently pushed
+// stream is released and forgotten past MaxStreams).
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace n_TradeFlow
+{
+    enum e_ReorderResult
+    {
+        REORDER_BUFFERED = 0,
+        REORDER_REPLACED,       // Replaced the buffered bar at the same time
+        REORDER_LATE            // At or before the released time: not buffered
+    };
+
+    struct s_ReorderConfig
+    {
+        int64_t MaxHoldMicros = 5000000;    // Idle time after which a stream is released whole
+        size_t MaxBarsPerStream = 4096;
+        size_t MaxStreams = 10000;
+    };
+
+    struct s_ReorderStats
+    {
+        size_t Streams = 0;
+        size_t Buffered = 0;        // Bars held now
+        uint64_t Pushed = 0;
+        uint64_t Released = 0;
+        uint64_t Reordered = 0;     // Buffered behind a newer bar pushed before them
+        uint64_t Replaced = 0;
+        uint64_t Late = 0;
+        uint64_t Forced = 0;        // Released ahead of the watermark by a bound
+        uint64_t Expired = 0;       // Released by the hold time
+    };
+
+    template <typename t_Payload>
+    struct s_ReleasedBar
+    {
+        std::string Stream;
+        int64_t Time;
+        t_Payload Payload;
+    };
+
+    // t_Payload is any copyable handle to the bar (a Python object in the
+    // bindings). Times are epoch microseconds; Now is any monotonic clock in
+    // microseconds.
+    template <typename t_Payload>
+    class c_ReorderBuffer
+    {
+    public:
+        explicit c_ReorderBuffer(const s_ReorderConfig& Config) : Config(Config) {}
+
+        // LatenessMicros is how far behind the stream's newest bar a bar may
+        // arrive and still be released in order
+        e_ReorderResult Push(const std::string& Stream, int64_t Time, const t_Payload& Payload, int64_t LatenessMicros, int64_t Now)
+        {
+            Stats.Pushed++;
+            s_Stream& State = Touch(Stream);
+            State.LastPush = Now;
+            State.Lateness = LatenessMicros > 0 ? LatenessMicros : 0;
+
+            if (State.HasReleased && Time <= State.ReleasedTime)
+            {
+                Stats.Late++;
+                return REORDER_LATE;
+            }
+
+            e_ReorderResult Result = REORDER_BUFFERED;
+            auto Inserted = State.Bars.emplace(Time, Payload);
+            if (!Inserted.second)
+            {
+                Inserted.first->second = Payload;
+                Stats.Replaced++;
+                Result = REORDER_REPLACED;
+            }
+            else
+            {
+                Buffered++;
+                if (State.HasNewest && Time < State.Newest)
+                    Stats.Reordered++;
+            }
+            if (!State.HasNewest || Time > State.Newest)
+            {
+                State.Newest = Time;
+                State.HasNewest = true;
+            }
+
+            ReleaseThrough(Stream, State, State.Newest - State.Lateness);
+            while (State.Bars.size() > Config.MaxBarsPerStream)
+            {
+                ReleaseFront(Stream, State);
+                Stats.Forced++;
+            }
+            return Result;
+        }
+
+        // Releases the bars of every stream without a push for MaxHoldMicros
+        void Expire(int64_t Now)
+        {
+            for (auto& Item : Streams)
+            {
+                s_Stream& State = Item.second;
+                if (State.Bars.empty() || Now - State.LastPush < Config.MaxHoldMicros)
+                    continue;
+                Stats.Expired += State.Bars.size();
+                while (!State.Bars.empty())
+                    ReleaseFront(Item.first, State);
+            }
+        }
+
+        // Releases everything (shutdown)
+        void Flush()
+        {
+            for (auto& Item : Streams)
+            {
+                while (!Item.second.Bars.empty())
+                    ReleaseFront(Item.first, Item.second);
+            }
+        }
+
+        // Moves out the bars released since the last call: each stream's in
+        // time order, streams in the order they were released
+        void Drain(std::vector<s_ReleasedBar<t_Payload>>& Out)
+        {
+            Out.insert(Out.end(), std::make_move_iterator(Ready.begin()), std::make_move_iterator(Ready.end()));
+            Ready.clear();
+        }
+
+        s_ReorderStats GetStats() const
+        {
+            s_ReorderStats Result = Stats;
+            Result.Streams = Streams.size();
+            Result.Buffered = Buffered;
+            return Result;
+        }
+
+    private:
+        struct s_Stream
+        {
+            std::map<int64_t, t_Payload> Bars;
+            int64_t Newest = 0;
+            bool HasNewest = false;
+            int64_t ReleasedTime = 0;
+            bool HasReleased = false;
+            int64_t Lateness = 0;
+            int64_t LastPush = 0;
+            std::list<std::string>::iterator Recent;
+        };
+
+        s_ReorderConfig Config;
+        std::unordered_map<std::string, s_Stream> Streams;
+        std::list<std::string> Recent;     // Most recently pushed stream first
+        std::vector<s_ReleasedBar<t_Payload>> Ready;
+        size_t Buffered = 0;
+        s_ReorderStats Stats;
+
+        // Finds or creates Stream and marks it most recently pushed; past
+        // MaxStreams the least recent one is released and forgotten, so a late
+        // bar for it later counts as new
+        s_Stream& Touch(const std::string& Stream)
+        {
+            auto Found = Streams.find(Stream);
+            if (Found != Streams.end())
+            {
+                Recent.splice(Recent.begin(), Recent, Found->second.Recent);
+                return Found->second;
+            }
+
+            while (Streams.size() >= Config.MaxStreams && !Recent.empty())
+            {
+                auto Oldest = Streams.find(Recent.back());
+                Stats.Forced += Oldest->second.Bars.size();
+                while (!Oldest->second.Bars.empty())
+                    ReleaseFront(Oldest->first, Oldest->second);
+                Streams.erase(Oldest);
+                Recent.pop_back();
+            }
+
+            Recent.push_front(Stream);
+            s_Stream& State = Streams[Stream];
+            State.Recent = Recent.begin();
+            return State;
+        }
+
+        void ReleaseThrough(const std::string& Stream, s_Stream& State, int64_t Watermark)
+        {
+            while (!State.Bars.empty() && State.Bars.begin()->first <= Watermark)
+                ReleaseFront(Stream, State);
+        }
+
+        void ReleaseFront(const std::string& Stream, s_Stream& State)
+        {
+            auto Front = State.Bars.begin();
+            Ready.push_back({ Stream, Front->first, std::move(Front->second) });
+            State.ReleasedTime = Front->first;
+            State.HasReleased = true;
+            State.Bars.erase(Front);
+            Buffered--;
+            Stats.Released++;
+        }
+    };
+}
@@ -0,0 +1,133 @@
+// Price alert engine: strict and inclusive crossings, bar ranges, one-shot
+// removal, repeating alerts re-arming, upserts and removal
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/alerts_test.cpp -o alerts_test && ./alerts_test
+#include "alerts.h"
+#include "check.h"
+
+#include <algorithm>
+
+using namespace n_TradeFlow;
+
+static std::vector<int64_t> Trade(c_AlertEngine& Engine, double Price, const char* Symbol = "ES")
+{
+    std::vector<int64_t> Fired;
+    Engine.ProcessTrade(Symbol, Price, Fired);
+    std::sort(Fired.begin(), Fired.end());
+    return Fired;
+}
+
+static std::vector<int64_t> Bar(c_AlertEngine& Engine, double High, double Low)
+{
+    std::vector<int64_t> Fired;
+    Engine.ProcessBar("ES", High, Low, Fired);
+    std::sort(Fired.begin(), Fired.end());
+    return Fired;
+}
+
+typedef std::vector<int64_t> Ids;
+
+static void TestCrossing()
+{
+    c_AlertEngine Engine;
+    Engine.Upsert(1, "ES", ALERT_ABOVE, 100.0, true);
+    Engine.Upsert(2, "ES", ALERT_ABOVE_OR_EQUAL, 100.0, true);
+    Engine.Upsert(3, "ES", ALERT_BELOW, 90.0, true);
+    Engine.Upsert(4, "ES", ALERT_BELOW_OR_EQUAL, 90.0, true);
+    Engine.Upsert(5, "ES", ALERT_ABOVE, 105.0, true);
+    Engine.Upsert(6, "NQ", ALERT_ABOVE, 1.0, true);
+    CHECK(Engine.Size() == 6);
+
+    CHECK(Trade(Engine, 95.0).empty());
+    CHECK(Trade(Engine, 100.0) == Ids({ 2 }));      // Only the inclusive one at the level
+    CHECK(Trade(Engine, 100.25) == Ids({ 1 }));
+    CHECK(Trade(Engine, 90.0) == Ids({ 4 }));
+    CHECK(Trade(Engine, 89.75) == Ids({ 3 }));
+    CHECK(Trade(Engine, 95.0, "CL").empty());       // Unknown symbol
+
+    // One-shot alerts are gone once fired
+    CHECK(Trade(Engine, 100.25).empty());
+    CHECK(Engine.Size() == 2);
+
+    // A jump past several levels fires them all
+    Engine.Upsert(7, "ES", ALERT_ABOVE, 101.0, true);
+    Engine.Upsert(8, "ES", ALERT_ABOVE_OR_EQUAL, 103.0, true);
+    CHECK(Trade(Engine, 110.0) == Ids({ 5, 7, 8 }));
+}
+
+// A bar fires everything between its low and high on both ladders
+static void TestBarRange()
+{
+    c_AlertEngine Engine;
+    Engine.Upsert(1, "ES", ALERT_ABOVE, 102.0, true);
+    Engine.Upsert(2, "ES", ALERT_BELOW, 98.0, true);
+    Engine.Upsert(3, "ES", ALERT_ABOVE, 110.0, true);
+    Engine.Upsert(4, "ES", ALERT_BELOW_OR_EQUAL, 90.0, true);
+    CHECK(Bar(Engine, 103.0, 97.0) == Ids({ 1, 2 }));
+    CHECK(Bar(Engine, 109.0, 90.0) == Ids({ 4 }));
+    CHECK(Engine.Size() == 1);
+}
+
+// Repeating alerts fire once, then wait for price to move back through their level
+static void TestRearm()
+{
+    c_AlertEngine Engine;
+    Engine.Upsert(1, "ES", ALERT_ABOVE, 100.0, false);
+    Engine.Upsert(2, "ES", ALERT_BELOW_OR_EQUAL, 90.0, false);
+
+    CHECK(Trade(Engine, 101.0) == Ids({ 1 }));
+    CHECK(Trade(Engine, 102.0).empty());
+    CHECK(Trade(Engine, 100.5).empty());
+    CHECK(Trade(Engine, 100.0).empty());            // ">" no longer holds: re-armed
+    CHECK(Trade(Engine, 100.25) == Ids({ 1 }));
+
+    CHECK(Trade(Engine, 90.0) == Ids({ 2 }));
+    CHECK(Trade(Engine, 90.0).empty());
+    CHECK(Trade(Engine, 90.25).empty());            // "<=" no longer holds: re-armed
+    CHECK(Trade(Engine, 89.0) == Ids({ 2 }));
+    CHECK(Engine.Size() == 2);
+
+    // A bar that fires an alert does not re-arm it in the same call
+    CHECK(Trade(Engine, 95.0).empty());
+    CHECK(Bar(Engine, 101.0, 99.0) == Ids({ 1 }));
+    CHECK(Trade(Engine, 101.0).empty());
+}
+
+static void TestUpsertAndRemove()
+{
+    c_AlertEngine Engine;
+    Engine.Upsert(1, "ES", ALERT_ABOVE, 100.0, false);
+    CHECK(Trade(Engine, 101.0) == Ids({ 1 }));
+
+    // Replacing an alert (here a parked one) re-arms it at its new level
+    Engine.Upsert(1, "ES", ALERT_BELOW, 95.0, true);
+    CHECK(Engine.Size() == 1);
+    CHECK(Trade(Engine, 99.0).empty());
+    CHECK(Trade(Engine, 94.0) == Ids({ 1 }));
+
+    Engine.Upsert(2, "ES", ALERT_ABOVE, 100.0, false);
+    Engine.Upsert(3, "NQ", ALERT_ABOVE, 100.0, true);
+    CHECK(Trade(Engine, 101.0) == Ids({ 2 }));
+    CHECK(Engine.Remove(2));                        // Removed while parked
+    CHECK(!Engine.Remove(2));
+    CHECK(Engine.Remove(3));
+    CHECK(Trade(Engine, 99.0).empty());
+    CHECK(Trade(Engine, 101.0).empty());
+    CHECK(Trade(Engine, 101.0, "NQ").empty());
+    CHECK(Engine.Size() == 0);
+
+    Engine.Upsert(4, "ES", ALERT_ABOVE, 100.0, true);
+    Engine.Clear();
+    CHECK(Engine.Size() == 0);
+    CHECK(Trade(Engine, 101.0).empty());
+}
+
+int main()
+{
+    TestCrossing();
+    TestBarRange();
+    TestRearm();
+    TestUpsertAndRemove();
+    return TestResult("alerts_test");
+}
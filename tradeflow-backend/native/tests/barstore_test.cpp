@@ -0,0 +1,124 @@
+// Bar store: appends, rewrites of the newest bar and the rollups they feed
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/barstore_test.cpp -o barstore_test && ./barstore_test
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "barstore.h"
+#include "check.h"
+
+using namespace n_TradeFlow;
+
+static const int64_t Second = 1000000;
+static const int64_t Start = 1700006400LL * Second;   // 2023-11-15 00:00 UTC, a 1m boundary
+
+static s_BarRow Bar(int64_t Time, double Price, double Volume)
+{
+    s_BarRow Row;
+    Row.Time = Time;
+    Row.Values[BAR_OPEN] = Price;
+    Row.Values[BAR_HIGH] = Price + 1;
+    Row.Values[BAR_LOW] = Price - 1;
+    Row.Values[BAR_CLOSE] = Price;
+    Row.Values[BAR_VOLUME] = Volume;
+    Row.Values[BAR_BID_VOLUME] = Volume / 2;
+    Row.Values[BAR_ASK_VOLUME] = Volume / 2;
+    Row.Values[BAR_NUMBER_OF_TRADES] = 1;
+    Row.Values[BAR_DELTA] = Volume / 10;
+    return Row;
+}
+
+static s_BarColumns Read(c_BarStore& Store, const char* Timeframe)
+{
+    s_BarColumns Columns;
+    Store.Tail("ES", Timeframe, 1000, Columns);
+    return Columns;
+}
+
+// The partial first minute is skipped, so every check uses the second one
+static void TestRewriteDoesNotDoubleCount(const std::string& Directory)
+{
+    c_BarStore Store(Directory, 0, "1s", { { "1m", 60 * Second } });
+    Store.Append("ES", "1s", Bar(Start - Second, 99, 1));
+    CHECK(Store.Append("ES", "1s", Bar(Start, 100, 5)));
+    CHECK(Store.Append("ES", "1s", Bar(Start + Second, 101, 10)));
+
+    // Resend of the newest bar: same values, then a corrected volume and price
+    CHECK(Store.Append("ES", "1s", Bar(Start + Second, 101, 10)));
+    s_BarColumns Minute = Read(Store, "1m");
+    CHECK(Minute.Size() == 1);
+    CHECK_NEAR(Minute.Values[BAR_VOLUME][0], 15);
+    CHECK_NEAR(Minute.Values[BAR_NUMBER_OF_TRADES][0], 2);
+    CHECK_NEAR(Minute.Values[BAR_DELTA][0], 1.5);
+
+    CHECK(Store.Append("ES", "1s", Bar(Start + Second, 103, 12)));
+    Minute = Read(Store, "1m");
+    CHECK(Minute.Size() == 1);
+    CHECK_NEAR(Minute.Values[BAR_OPEN][0], 100);
+    CHECK_NEAR(Minute.Values[BAR_HIGH][0], 104);
+    CHECK_NEAR(Minute.Values[BAR_LOW][0], 99);
+    CHECK_NEAR(Minute.Values[BAR_CLOSE][0], 103);
+    CHECK_NEAR(Minute.Values[BAR_VOLUME][0], 17);
+    CHECK_NEAR(Minute.Values[BAR_BID_VOLUME][0], 8.5);
+    CHECK_NEAR(Minute.Values[BAR_NUMBER_OF_TRADES][0], 2);
+
+    // A lower high on rewrite must lower the bucket's high too
+    CHECK(Store.Append("ES", "1s", Bar(Start + Second, 100, 12)));
+    Minute = Read(Store, "1m");
+    CHECK_NEAR(Minute.Values[BAR_HIGH][0], 101);
+
+    s_BarColumns Seconds = Read(Store, "1s");
+    CHECK(Seconds.Size() == 3);
+    CHECK_NEAR(Seconds.Values[BAR_VOLUME][2], 12);
+}
+
+// Rewriting the first bar of a new bucket rebuilds just that bucket
+static void TestRewriteOpensBucket(const std::string& Directory)
+{
+    c_BarStore Store(Directory, 0, "1s", { { "1m", 60 * Second } });
+    Store.Append("ES", "1s", Bar(Start - Second, 99, 1));
+    for (int s = 0; s < 60; s++)
+        Store.Append("ES", "1s", Bar(Start + s * Second, 100, 1));
+    CHECK(Store.Append("ES", "1s", Bar(Start + 60 * Second, 110, 3)));
+    CHECK(Store.Append("ES", "1s", Bar(Start + 60 * Second, 112, 4)));
+
+    s_BarColumns Minute = Read(Store, "1m");
+    CHECK(Minute.Size() == 2);
+    CHECK_NEAR(Minute.Values[BAR_VOLUME][0], 60);
+    CHECK_NEAR(Minute.Values[BAR_OPEN][1], 112);
+    CHECK_NEAR(Minute.Values[BAR_VOLUME][1], 4);
+}
+
+// Rewriting a bar of the skipped partial bucket leaves the rollup empty
+static void TestRewriteInSkippedBucket(const std::string& Directory)
+{
+    c_BarStore Store(Directory, 0, "1s", { { "1m", 60 * Second } });
+    Store.Append("ES", "1s", Bar(Start - 2 * Second, 99, 1));
+    CHECK(Store.Append("ES", "1s", Bar(Start - 2 * Second, 98, 2)));
+    CHECK(Read(Store, "1m").Size() == 0);
+}
+
+static void TestOlderBarsRejected(const std::string& Directory)
+{
+    c_BarStore Store(Directory, 0, "1s", { { "1m", 60 * Second } });
+    Store.Append("ES", "1s", Bar(Start, 100, 1));
+    Store.Append("ES", "1s", Bar(Start + 2 * Second, 100, 1));
+    CHECK(!Store.Append("ES", "1s", Bar(Start + Second, 100, 1)));
+    CHECK(Store.Count("ES", "1s") == 2);
+}
+
+int main()
+{
+    std::string Root = (std::filesystem::temp_directory_path() / "tradeflow_barstore_test").string();
+    int Case = 0;
+    for (auto Test : { TestRewriteDoesNotDoubleCount, TestRewriteOpensBucket, TestRewriteInSkippedBucket, TestOlderBarsRejected })
+    {
+        std::string Directory = Root + "/" + std::to_string(Case++);
+        std::filesystem::remove_all(Directory);
+        Test(Directory);
+    }
+    std::filesystem::remove_all(Root);
+    return TestResult("barstore_test");
+}
@@ -0,0 +1,114 @@
+// WebSocket fan-out: shared payloads, wake-ups, conflation per symbol and
+// message type behind a full queue, events kept in order and bounded
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/broadcaster_test.cpp -o broadcaster_test && ./broadcaster_test
+#include "broadcaster.h"
+#include "check.h"
+
+using namespace n_TradeFlow;
+
+typedef c_FanoutBroadcaster<std::string> Broadcaster;
+
+static std::vector<std::string> Drain(Broadcaster& Fanout, uint32_t Id)
+{
+    std::vector<std::string> Out;
+    Fanout.Drain(Id, 100, Out);
+    return Out;
+}
+
+static void TestFanout()
+{
+    Broadcaster Fanout(4);
+    uint32_t A = Fanout.AddConnection();
+    uint32_t B = Fanout.AddConnection();
+    CHECK(Fanout.Subscribe(A, "ES"));
+    CHECK(Fanout.Subscribe(A, "ES"));     // Once only
+    CHECK(Fanout.Subscribe(B, "NQ"));
+
+    std::vector<uint32_t> Woken;
+    CHECK(Fanout.Publish("ES", "tick", "es1", Woken) == 1);
+    CHECK(Fanout.Publish("ES", "tick", "es2", Woken) == 1);
+    CHECK(Fanout.Publish("CL", "tick", "cl1", Woken) == 0);
+    // Only the first message wakes an idle connection
+    CHECK(Woken.size() == 1 && Woken[0] == A);
+
+    CHECK((Drain(Fanout, A) == std::vector<std::string>{ "es1", "es2" }));
+    CHECK(Drain(Fanout, B).empty());
+
+    CHECK(Fanout.Unsubscribe(A, "ES"));
+    CHECK(Fanout.Publish("ES", "tick", "es3", Woken) == 0);
+    Fanout.RemoveConnection(B);
+    CHECK(Fanout.Publish("NQ", "tick", "nq1", Woken) == 0);
+    CHECK(Fanout.GetStats().Connections == 1);
+}
+
+// A full queue keeps the newest message per symbol and type, so a bar update
+// never replaces a different message type for the same symbol
+static void TestConflationByType()
+{
+    Broadcaster Fanout(2);
+    uint32_t Id = Fanout.AddConnection();
+    Fanout.Subscribe(Id, "ES");
+    Fanout.Subscribe(Id, "NQ");
+
+    std::vector<uint32_t> Woken;
+    Fanout.Publish("ES", "tick", "t1", Woken);
+    Fanout.Publish("ES", "tick", "t2", Woken);
+    Fanout.Publish("ES", "tick", "t3", Woken);
+    Fanout.Publish("ES", "profile", "p1", Woken);
+    Fanout.Publish("NQ", "tick", "n1", Woken);
+    Fanout.Publish("ES", "tick", "t4", Woken);
+    Fanout.Publish("ES", "profile", "p2", Woken);
+
+    CHECK(Fanout.Pending(Id) == 5);
+    CHECK((Drain(Fanout, Id) == std::vector<std::string>{ "t1", "t2", "t4", "p2", "n1" }));
+    CHECK(Fanout.GetStats().Conflated == 5);
+
+    // Drained, the queue takes messages in order again
+    Fanout.Publish("ES", "tick", "t5", Woken);
+    CHECK((Drain(Fanout, Id) == std::vector<std::string>{ "t5" }));
+}
+
+// Events behind a full queue are all delivered in order, up to the queue capacity
+static void TestEventsAreNotConflated()
+{
+    Broadcaster Fanout(2);
+    uint32_t Id = Fanout.AddConnection();
+    Fanout.Subscribe(Id, "ES");
+
+    std::vector<uint32_t> Woken;
+    Fanout.Publish("ES", "tick", "t1", Woken);
+    Fanout.Publish("ES", "tick", "t2", Woken);
+    Fanout.Publish("ES", "large_trades", "e1", Woken, false);
+    Fanout.Publish("ES", "tick", "t3", Woken);
+    Fanout.Publish("ES", "large_trades", "e2", Woken, false);
+    Fanout.Publish("ES", "large_trades", "e3", Woken, false);
+    Fanout.Publish("ES", "tick", "t4", Woken);
+
+    s_BroadcastStats Stats = Fanout.GetStats();
+    CHECK(Stats.Dropped == 1);
+    CHECK(Stats.Conflated == 2);
+
+    std::vector<std::string> Out;
+    CHECK(Fanout.Drain(Id, 3, Out) == 3);
+    CHECK((Out == std::vector<std::string>{ "t1", "t2", "e1" }));
+    CHECK((Drain(Fanout, Id) == std::vector<std::string>{ "t4", "e2" }));
+    CHECK(Fanout.Pending(Id) == 0);
+
+    // The event list is free again once drained
+    Fanout.Publish("ES", "tick", "t5", Woken);
+    Fanout.Publish("ES", "tick", "t6", Woken);
+    Fanout.Publish("ES", "large_trades", "e4", Woken, false);
+    Fanout.Publish("ES", "large_trades", "e5", Woken, false);
+    CHECK((Drain(Fanout, Id) == std::vector<std::string>{ "t5", "t6", "e4", "e5" }));
+    CHECK(Fanout.GetStats().Dropped == 1);
+}
+
+int main()
+{
+    TestFanout();
+    TestConflationByType();
+    TestEventsAreNotConflated();
+    return TestResult("broadcaster_test");
+}
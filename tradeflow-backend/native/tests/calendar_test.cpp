@@ -0,0 +1,126 @@
+// Session calendar: daily defaults, compiled calendars, gaps and the lookup hint
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/calendar_test.cpp -o calendar_test && ./calendar_test
+#include "calendar.h"
+#include "check.h"
+
+using namespace n_TradeFlow;
+
+static const int64_t HOUR = 3600LL * 1000000;
+static const int64_t DAY = CALENDAR_DAY_MICROS;
+
+// Symbols without a calendar: daily sessions at the default offset
+static void TestDailyDefault()
+{
+    c_SessionCalendar Calendar(-2 * 3600, 22 * 3600);   // 22:00 to 20:00 UTC
+    s_SessionPosition Position;
+
+    CHECK(Calendar.Locate("ES", 10 * DAY + 23 * HOUR, HOUR, Position));
+    CHECK(Position.Index == 10);
+    CHECK(Position.Start == 10 * DAY + 22 * HOUR);
+    CHECK(Position.End == 11 * DAY + 20 * HOUR);
+    CHECK(Position.InSession);
+    CHECK(Position.Bar == 1 && Position.BarStart == 10 * DAY + 23 * HOUR);
+
+    // The break between 20:00 and 22:00 belongs to the session that ended
+    CHECK(Calendar.Locate("ES", 11 * DAY + 21 * HOUR, 0, Position));
+    CHECK(Position.Index == 10);
+    CHECK(!Position.InSession);
+    CHECK(Position.Bar == 0 && Position.BarStart == Position.Start);
+
+    // Before the epoch the day still rounds down
+    CHECK(Calendar.Locate("ES", -HOUR, 0, Position));
+    CHECK(Position.Index == -1);
+    CHECK(Position.Start == -2 * HOUR);
+}
+
+// Two sessions with a holiday between them and an early close on the second
+static void TestCompiledCalendar()
+{
+    c_SessionCalendar Calendar;
+    std::vector<int64_t> Starts = { 0, 2 * DAY, 3 * DAY };
+    std::vector<int64_t> Ends = { 7 * HOUR, 2 * DAY + 4 * HOUR, 3 * DAY + 7 * HOUR };
+    CHECK(Calendar.Define("cme", Starts, Ends));
+    CHECK(Calendar.HasCalendar("cme"));
+    CHECK(!Calendar.Assign("ES", "missing"));
+    CHECK(Calendar.Assign("ES", "cme"));
+
+    s_SessionPosition Position;
+    CHECK(Calendar.Locate("ES", 2 * DAY + 90 * 60 * 1000000LL, HOUR, Position));
+    CHECK(Position.Index == 1);
+    CHECK(Position.End == 2 * DAY + 4 * HOUR);
+    CHECK(Position.InSession && Position.Bar == 1);
+
+    // The holiday falls to the session before it, out of session
+    CHECK(Calendar.Locate("ES", DAY + 12 * HOUR, 0, Position));
+    CHECK(Position.Index == 0 && !Position.InSession);
+
+    // Outside the compiled range
+    CHECK(!Calendar.Locate("ES", -1, 0, Position));
+    CHECK(!Calendar.Locate("ES", 3 * DAY + 7 * HOUR, 0, Position));
+    CHECK(Calendar.GetStats().Misses == 2);
+
+    // Unassigning returns the symbol to the daily default
+    CHECK(Calendar.Assign("ES", ""));
+    CHECK(Calendar.Locate("ES", DAY + 12 * HOUR, 0, Position));
+    CHECK(Position.Index == 1 && Position.InSession);
+}
+
+static void TestDefineRejectsBadSessions()
+{
+    c_SessionCalendar Calendar;
+    CHECK(!Calendar.Define("", { 0 }, { 1 }));
+    CHECK(!Calendar.Define("x", { 0, 1 }, { 1 }));
+    CHECK(!Calendar.Define("x", { 5 }, { 5 }));                 // Empty session
+    CHECK(!Calendar.Define("x", { 0, 5 }, { 10, 20 }));         // Overlap
+    CHECK(!Calendar.HasCalendar("x"));
+
+    CHECK(Calendar.Define("x", { 0 }, { 10 }));
+    CHECK(!Calendar.Define("x", { 10, 0 }, { 20, 5 }));         // Unsorted: left unchanged
+    CHECK(Calendar.Assign("S", "x"));
+    s_SessionPosition Position;
+    CHECK(Calendar.Locate("S", 5, 0, Position) && Position.End == 10);
+    CHECK(Calendar.GetStats().Sessions == 1);
+}
+
+// In-order lookups resolve from the previous session; jumps binary search
+static void TestHint()
+{
+    c_SessionCalendar Calendar;
+    std::vector<int64_t> Starts, Ends;
+    for (int64_t Day = 0; Day < 100; Day++)
+    {
+        Starts.push_back(Day * DAY);
+        Ends.push_back(Day * DAY + 8 * HOUR);
+    }
+    CHECK(Calendar.Define("c", Starts, Ends));
+    CHECK(Calendar.Assign("ES", "c"));
+
+    s_SessionPosition Position;
+    for (int64_t Day = 0; Day < 10; Day++)
+    {
+        for (int64_t Hour = 0; Hour < 8; Hour++)
+        {
+            CHECK(Calendar.Locate("ES", Day * DAY + Hour * HOUR, 0, Position));
+            CHECK(Position.Index == Day);
+        }
+    }
+    CHECK(Calendar.GetStats().Searches == 0);
+    CHECK(Calendar.GetStats().HintHits == 80);
+
+    CHECK(Calendar.Locate("ES", 70 * DAY + HOUR, 0, Position));
+    CHECK(Position.Index == 70);
+    CHECK(Calendar.Locate("ES", 20 * DAY, 0, Position));
+    CHECK(Position.Index == 20);
+    CHECK(Calendar.GetStats().Searches == 2);
+}
+
+int main()
+{
+    TestDailyDefault();
+    TestCompiledCalendar();
+    TestDefineRejectsBadSessions();
+    TestHint();
+    return TestResult("calendar_test");
+}
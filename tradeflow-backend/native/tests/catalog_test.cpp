@@ -0,0 +1,75 @@
+// Stream catalog: new, rewritten, resent and backfilled bars
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/catalog_test.cpp -o catalog_test && ./catalog_test
+#include "catalog.h"
+#include "check.h"
+
+using namespace n_TradeFlow;
+
+static s_StreamStats Stream(c_StreamCatalog& Catalog)
+{
+    std::vector<s_StreamStats> Streams;
+    Catalog.Export(false, Streams);
+    return Streams.empty() ? s_StreamStats() : Streams[0];
+}
+
+static void TestInOrderAndRewrite()
+{
+    c_StreamCatalog Catalog;
+    CHECK(Catalog.Add("ES", "1s", 10, 101, 99, 5));
+    CHECK(Catalog.Add("ES", "1s", 20, 102, 98, 7));
+    CHECK(!Catalog.Add("ES", "1s", 20, 102, 98, 9));   // Rewrite of the last bar
+    s_StreamStats Stats = Stream(Catalog);
+    CHECK(Stats.Count == 2);
+    CHECK_NEAR(Stats.VolumeSum, 14);
+    CHECK(Stats.FirstTime == 10 && Stats.LastTime == 20);
+    CHECK_NEAR(Stats.MaxHigh, 102);
+    CHECK_NEAR(Stats.MinLow, 98);
+}
+
+// Gap after an outage: bars 2..4 arrive after 1 and 5
+static void TestBackfilledGap()
+{
+    c_StreamCatalog Catalog;
+    Catalog.Add("ES", "1s", 1, 100, 100, 1);
+    Catalog.Add("ES", "1s", 5, 100, 100, 1);
+    for (int64_t t = 2; t <= 4; t++)
+    {
+        CHECK(Catalog.IsBackfill("ES", "1s", t));
+        CHECK(Catalog.Add("ES", "1s", t, 100, 100, 1, true));
+    }
+    s_StreamStats Stats = Stream(Catalog);
+    CHECK(Stats.Count == 5);
+    CHECK_NEAR(Stats.VolumeSum, 5);
+
+    // A resend of a stored bar inside the range is not counted
+    CHECK(!Catalog.Add("ES", "1s", 3, 100, 100, 1, false));
+    CHECK(Stream(Catalog).Count == 5);
+
+    // Before the first bar counts either way
+    CHECK(Catalog.IsBackfill("ES", "1s", 0));
+    CHECK(Catalog.Add("ES", "1s", 0, 100, 100, 1, true));
+    CHECK(Stream(Catalog).FirstTime == 0);
+    CHECK(Stream(Catalog).Count == 6);
+}
+
+static void TestIsBackfill()
+{
+    c_StreamCatalog Catalog;
+    CHECK(!Catalog.IsBackfill("ES", "1s", 5));
+    Catalog.Add("ES", "1s", 5, 100, 100, 1);
+    CHECK(!Catalog.IsBackfill("ES", "1s", 5));
+    CHECK(!Catalog.IsBackfill("ES", "1s", 6));
+    CHECK(Catalog.IsBackfill("ES", "1s", 4));
+    CHECK(!Catalog.IsBackfill("ES", "1m", 4));
+    CHECK(!Catalog.IsBackfill("NQ", "1s", 4));
+}
+
+int main()
+{
+    TestInOrderAndRewrite();
+    TestBackfilledGap();
+    TestIsBackfill();
+    return TestResult("catalog_test");
+}
@@ -0,0 +1,24 @@
+// Minimal checks for the native engine tests: each test file is one
+// executable that prints every failed check and exits non-zero if any failed.
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+static int g_Failures = 0;
+
+#define CHECK(Condition) \
+    do { if (!(Condition)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Condition); g_Failures++; } } while (0)
+
+#define CHECK_NEAR(A, B) \
+    do { double a_ = (A), b_ = (B); if (!(std::fabs(a_ - b_) <= 1e-9 * (1.0 + std::fabs(b_)))) \
+        { printf("%s:%d: CHECK_NEAR(%s, %s) failed: %.10g vs %.10g\n", __FILE__, __LINE__, #A, #B, a_, b_); g_Failures++; } } while (0)
+
+static int TestResult(const char* Name)
+{
+    if (g_Failures == 0)
+        printf("%s: ok\n", Name);
+    else
+        printf("%s: %d failed checks\n", Name, g_Failures);
+    return g_Failures == 0 ? 0 : 1;
+}
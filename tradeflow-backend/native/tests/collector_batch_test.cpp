@@ -0,0 +1,169 @@
+// Collector batch mode driven through the study function: the cursor starts
+// after the last bar real-time mode sent, only full batches go out while
+// batch mode is selected, a batch in flight during a mode switch is still
+// acknowledged, and the closed bars left behind the cursor are flushed as a
+// partial batch before the new mode takes over. The collector source is
+// compiled against sierrachart.h from this directory.
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative/tests -Inative -I. native/tests/collector_batch_test.cpp -o collector_batch_test -lpthread && ./collector_batch_test
+#include "TradeFlow_Pro_Data_Collector.cpp"
+#include "check.h"
+
+// 1 minute bars from 2025-03-14 13:30
+static void AddBar(s_sc& sc)
+{
+    int i = sc.ArraySize;
+    sc.BaseDateTimeIn.Values.push_back(SCDateTime(45730.0 + (13 * 3600 + 30 * 60 + i * 60) / 86400.0));
+    for (int Array : { SC_OPEN, SC_HIGH, SC_LOW, SC_LAST })
+        sc.BaseDataIn[Array].Values.push_back(5000.0f + (float)(i % 9) * 0.25f);
+    sc.BaseDataIn[SC_VOLUME].Values.push_back((float)(100 + i));
+    sc.ArraySize++;
+}
+
+// One update on the newest bar, as Sierra Chart calls the study in real time
+static void Update(s_sc& sc)
+{
+    sc.Index = sc.ArraySize - 1;
+    scsf_TradeFlowProDataCollector(sc);
+}
+
+// The backend's answer to the pending request, then the next update that
+// clears the answered request and may send again
+static void Respond(s_sc& sc)
+{
+    sc.HTTPRequestID = 1;
+    sc.HTTPResponse = "{\"status\":\"success\"}";
+    Update(sc);
+    Update(sc);
+}
+
+static SCString Header(const s_sc& sc, size_t Post, const char* Name)
+{
+    for (const n_ACSIL::s_HTTPHeader& Header : sc.PostedHeaders[Post])
+    {
+        if (Header.Name == Name)
+            return Header.Value;
+    }
+    return SCString();
+}
+
+static int BarCount(const SCString& Body)
+{
+    int Count = 0;
+    for (const char* At = strstr(Body.GetChars(), "\"timestamp\""); At != nullptr; At = strstr(At + 1, "\"timestamp\""))
+        Count++;
+    return Count;
+}
+
+// The batch covers First..Last by bar index and sequence number
+static bool IsBatch(const s_sc& sc, size_t Post, int First, int Last, long long FirstSeq)
+{
+    const SCString& Body = sc.Posted[Post];
+    return BarCount(Body) == Last - First + 1
+        && strstr(Body.GetChars(), sc.FormatDateTime(sc.BaseDateTimeIn[First]).GetChars()) != nullptr
+        && strstr(Body.GetChars(), sc.FormatDateTime(sc.BaseDateTimeIn[Last]).GetChars()) != nullptr
+        && Header(sc, Post, "X-TradeFlow-Seq") == SCString().Format("%lld-%lld", FirstSeq, FirstSeq + Last - First);
+}
+
+static void Setup(s_sc& sc, int Bars)
+{
+    sc.Symbol = "ESM5";
+    sc.SetDefaults = 1;
+    scsf_TradeFlowProDataCollector(sc);
+    sc.SetDefaults = 0;
+    sc.Input[1].SetYesNo(1);
+    sc.Input[3].SetInt(10);
+    sc.Input[39].SetYesNo(0);   // Session times would take turns with the bars
+    for (int i = 0; i < Bars; i++)
+        AddBar(sc);
+}
+
+static void TestSeedAndFlush()
+{
+    s_sc sc;
+    Setup(sc, 20);
+
+    // Real time: the bar forming at load counts as sent, so bar 19 is not;
+    // bar 20 is sent when it closes
+    Update(sc);
+    AddBar(sc);
+    AddBar(sc);
+    Update(sc);
+    CHECK(sc.Posted.size() == 1 && BarCount(sc.Posted[0]) == 1);
+    CHECK(strstr(sc.Posted[0].GetChars(), sc.FormatDateTime(sc.BaseDateTimeIn[20]).GetChars()) != nullptr);
+    Respond(sc);
+
+    // Bars 21..29 close before batch mode is selected: the cursor starts
+    // after bar 20, and nine bars are not yet a batch
+    for (int i = 0; i < 9; i++)
+        AddBar(sc);
+    sc.Input[2].SetCustomInputIndex(1);
+    Update(sc);
+    CHECK(sc.Posted.size() == 1);
+    AddBar(sc);
+    Update(sc);
+    CHECK(sc.Posted.size() == 2);
+    CHECK(IsBatch(sc, 1, 21, 30, 1));
+
+    // Back to real time with the batch still in flight and three more bars
+    // closed: its answer still moves the cursor, then 31..33 go out partial
+    AddBar(sc);
+    AddBar(sc);
+    AddBar(sc);
+    sc.Input[2].SetCustomInputIndex(0);
+    Respond(sc);
+    CHECK(sc.Posted.size() == 3);
+    CHECK(IsBatch(sc, 2, 31, 33, 11));
+    CHECK(Header(sc, 2, "X-TradeFlow-Stream") == Header(sc, 1, "X-TradeFlow-Stream"));
+
+    // Once that is answered, real time carries on after bar 33
+    Respond(sc);
+    CHECK(sc.Posted.size() == 3);
+    AddBar(sc);
+    Update(sc);
+    CHECK(sc.Posted.size() == 4 && BarCount(sc.Posted[3]) == 1);
+    CHECK(strstr(sc.Posted[3].GetChars(), sc.FormatDateTime(sc.BaseDateTimeIn[34]).GetChars()) != nullptr);
+
+    sc.LastCallToFunction = 1;
+    Update(sc);
+}
+
+// A backlog longer than one batch is flushed as full batches, the last partial
+static void TestFlushBacklog()
+{
+    s_sc sc;
+    Setup(sc, 5);
+    sc.Input[2].SetCustomInputIndex(1);
+    Update(sc);
+    for (int i = 0; i < 24; i++)
+        AddBar(sc);
+    Update(sc);
+    CHECK(sc.Posted.size() == 1 && IsBatch(sc, 0, 4, 13, 1));
+
+    sc.Input[2].SetCustomInputIndex(0);
+    Respond(sc);
+    CHECK(sc.Posted.size() == 2 && IsBatch(sc, 1, 14, 23, 11));
+    Respond(sc);
+    CHECK(sc.Posted.size() == 3 && IsBatch(sc, 2, 24, 27, 21));
+    Respond(sc);
+    CHECK(sc.Posted.size() == 3);
+
+    // Batch mode selected again starts a new stream after bar 27
+    sc.Input[2].SetCustomInputIndex(1);
+    for (int i = 0; i < 10; i++)
+        AddBar(sc);
+    Update(sc);
+    CHECK(sc.Posted.size() == 4 && IsBatch(sc, 3, 28, 37, 1));
+    CHECK(!(Header(sc, 3, "X-TradeFlow-Stream") == Header(sc, 0, "X-TradeFlow-Stream")));
+
+    sc.LastCallToFunction = 1;
+    Update(sc);
+}
+
+int main()
+{
+    TestSeedAndFlush();
+    TestFlushBacklog();
+    return TestResult("collector_batch_test");
+}
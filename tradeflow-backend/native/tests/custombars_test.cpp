@@ -0,0 +1,253 @@
+// Collector custom bars: range, volume, tick, delta and Renko boundaries,
+// price gaps, split volume, reversal bricks, distinct start keys, sequences,
+// stream labels within VARCHAR(10), and the Time & Sales reader feeding them.
+// Built against the sierrachart.h stand-in.
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative/tests -I. native/tests/custombars_test.cpp -o custombars_test && ./custombars_test
+#include "sierrachart.h"
+#include "TradeFlow_Pro_CustomBars.h"
+#include "check.h"
+
+static s_Trade Trade(long long TimeMs, int PriceTicks, double Volume, bool AtAsk)
+{
+    s_Trade Result;
+    Result.TimeMs = TimeMs;
+    Result.PriceTicks = PriceTicks;
+    Result.Volume = Volume;
+    Result.AtAsk = AtAsk;
+    return Result;
+}
+
+static s_CustomBars Bars(int Type, int Size)
+{
+    s_CustomBarConfig Config;
+    Config.Size[Type] = Size;
+    s_CustomBars Result;
+    Result.Configure(Config);
+    return Result;
+}
+
+static void CheckOHLC(const s_CustomBar& Bar, int Open, int High, int Low, int Close)
+{
+    CHECK(Bar.OpenTicks == Open);
+    CHECK(Bar.HighTicks == High);
+    CHECK(Bar.LowTicks == Low);
+    CHECK(Bar.CloseTicks == Close);
+}
+
+// A bar closes on the trade that would stretch it past the range; a gap
+// closes it without filling the levels in between
+static void TestRange()
+{
+    s_CustomBars Custom = Bars(CUSTOM_BAR_RANGE, 4);
+    Custom.Add(Trade(1000, 100, 1, true));
+    Custom.Add(Trade(1001, 102, 2, true));
+    Custom.Add(Trade(1002, 98, 3, false));
+    Custom.Add(Trade(1003, 101, 1, true));
+    Custom.Add(Trade(1004, 97, 1, false));   // 102 - 97 = 5 ticks
+    CHECK(Custom.Finished.size() == 1);
+    CheckOHLC(Custom.Finished[0], 100, 102, 98, 101);
+    CHECK_NEAR(Custom.Finished[0].Volume, 7);
+    CHECK_NEAR(Custom.Finished[0].AskVolume, 4);
+    CHECK_NEAR(Custom.Finished[0].BidVolume, 3);
+    CHECK(Custom.Finished[0].NumberOfTrades == 4);
+
+    Custom.Add(Trade(1005, 120, 2, true));
+    CHECK(Custom.Finished.size() == 2);
+    CheckOHLC(Custom.Finished[1], 97, 97, 97, 97);
+    CHECK(Custom.Builders[CUSTOM_BAR_RANGE].Active);
+    CHECK(Custom.Builders[CUSTOM_BAR_RANGE].Bar.OpenTicks == 120);
+    CHECK(Custom.Finished[0].Sequence == 1 && Custom.Finished[1].Sequence == 2);
+}
+
+// A trade larger than the room left is split; only its first bar counts it
+// as a trade, and bars started in the same millisecond get distinct keys
+static void TestVolume()
+{
+    s_CustomBars Custom = Bars(CUSTOM_BAR_VOLUME, 10);
+    Custom.Add(Trade(2000, 100, 4, true));
+    Custom.Add(Trade(2001, 101, 4, false));
+    Custom.Add(Trade(2002, 102, 5, true));
+    CHECK(Custom.Finished.size() == 1);
+    CHECK_NEAR(Custom.Finished[0].Volume, 10);
+    CHECK_NEAR(Custom.Finished[0].AskVolume, 6);
+    CHECK(Custom.Finished[0].NumberOfTrades == 3);
+
+    Custom.Add(Trade(2003, 103, 25, false));
+    CHECK(Custom.Finished.size() == 3);
+    CHECK_NEAR(Custom.Finished[1].Volume, 10);
+    CHECK_NEAR(Custom.Finished[1].AskVolume, 3);
+    CHECK(Custom.Finished[1].NumberOfTrades == 1);
+    CHECK_NEAR(Custom.Finished[2].Volume, 10);
+    CHECK(Custom.Finished[2].NumberOfTrades == 0);
+    CHECK(Custom.Finished[1].StartMs == 2002 && Custom.Finished[2].StartMs == 2003);
+
+    const s_CustomBarBuilder& Builder = Custom.Builders[CUSTOM_BAR_VOLUME];
+    CHECK(Builder.Active);
+    CHECK_NEAR(Builder.Bar.Volume, 8);
+    CHECK(Builder.Bar.StartMs == 2004);
+}
+
+static void TestTickAndDelta()
+{
+    s_CustomBars Ticks = Bars(CUSTOM_BAR_TICK, 3);
+    for (int i = 0; i < 7; i++)
+        Ticks.Add(Trade(3000 + i, 100 + i, 1, true));
+    CHECK(Ticks.Finished.size() == 2);
+    CheckOHLC(Ticks.Finished[1], 103, 105, 103, 105);
+    CHECK(Ticks.Builders[CUSTOM_BAR_TICK].Bar.NumberOfTrades == 1);
+
+    // Either side reaching the size closes the bar
+    s_CustomBars Delta = Bars(CUSTOM_BAR_DELTA, 5);
+    Delta.Add(Trade(4000, 100, 3, true));
+    Delta.Add(Trade(4001, 100, 1, false));
+    Delta.Add(Trade(4002, 101, 3, true));
+    CHECK(Delta.Finished.size() == 1);
+    CHECK_NEAR(Delta.Finished[0].AskVolume - Delta.Finished[0].BidVolume, 5);
+    Delta.Add(Trade(4003, 99, 6, false));
+    CHECK(Delta.Finished.size() == 2);
+    CHECK_NEAR(Delta.Finished[1].BidVolume, 6);
+}
+
+// One brick continues, a reversal needs two; a jump emits several bricks
+// and only the first carries the volume
+static void TestRenko()
+{
+    s_CustomBars Custom = Bars(CUSTOM_BAR_RENKO, 2);
+    Custom.Add(Trade(5000, 100, 1, true));
+    Custom.Add(Trade(5001, 101, 1, true));
+    CHECK(Custom.Finished.empty());
+    Custom.Add(Trade(5002, 102, 1, true));
+    CHECK(Custom.Finished.size() == 1);
+    CheckOHLC(Custom.Finished[0], 100, 102, 100, 102);
+    CHECK_NEAR(Custom.Finished[0].Volume, 3);
+
+    Custom.Add(Trade(5003, 103, 2, true));
+    Custom.Add(Trade(5004, 107, 4, true));
+    CHECK(Custom.Finished.size() == 3);
+    CheckOHLC(Custom.Finished[1], 102, 104, 102, 104);
+    CHECK_NEAR(Custom.Finished[1].Volume, 6);
+    CheckOHLC(Custom.Finished[2], 104, 106, 104, 106);
+    CHECK_NEAR(Custom.Finished[2].Volume, 0);
+    CHECK(Custom.Finished[2].NumberOfTrades == 0);
+    CHECK(Custom.Finished[1].StartMs == 5003 && Custom.Finished[2].StartMs == 5004);
+
+    // Down from 106: one brick (104) is not enough, two (102) reverse
+    Custom.Add(Trade(5006, 103, 1, false));
+    CHECK(Custom.Finished.size() == 3);
+    Custom.Add(Trade(5007, 102, 1, false));
+    CHECK(Custom.Finished.size() == 4);
+    CheckOHLC(Custom.Finished[3], 104, 104, 102, 102);
+    CHECK_NEAR(Custom.Finished[3].BidVolume, 2);
+
+    // Continuing down needs one brick
+    Custom.Add(Trade(5008, 100, 1, false));
+    CHECK(Custom.Finished.size() == 5);
+    CheckOHLC(Custom.Finished[4], 102, 102, 100, 100);
+}
+
+// Every type at its input limit still fits market_data.timeframe
+static void TestLabels()
+{
+    const int Limits[CUSTOM_BAR_TYPE_COUNT] = { 1000, 9999999, 999999, 99999, 1000 };
+    for (int t = 0; t < CUSTOM_BAR_TYPE_COUNT; t++)
+    {
+        CHECK(CustomBarStreamId(t, Limits[t]).GetLength() <= 10);
+        CHECK(CustomBarStreamId(t, 1).GetLength() <= 10);
+    }
+    CHECK(CustomBarStreamId(CUSTOM_BAR_RANGE, 4) == "range4t");
+    CHECK(CustomBarStreamId(CUSTOM_BAR_RENKO, 8) == "renko8t");
+}
+
+// Types share one sequence; the batch labels each bar with its own type and
+// stops at a gap left by trimming
+static void TestBatch()
+{
+    s_CustomBarConfig Config;
+    Config.Size[CUSTOM_BAR_TICK] = 1;
+    Config.Size[CUSTOM_BAR_RANGE] = 1;
+    s_CustomBars Custom;
+    Custom.Configure(Config);
+    Custom.Add(Trade(6000, 100, 1, true));
+    Custom.Add(Trade(6001, 105, 2, false));
+    CHECK(Custom.Finished.size() == 3);
+    CHECK(Custom.Finished[0].Type == CUSTOM_BAR_TICK);
+    CHECK(Custom.Finished[1].Type == CUSTOM_BAR_RANGE);
+    CHECK(Custom.Finished[2].Sequence == 3);
+    CHECK(Custom.StreamEpochMs == 6000);
+
+    s_sc sc;
+    sc.Symbol = "ES";
+    SCString Json = Custom.CreateBatchJSON(sc, Custom.ContiguousCount(10));
+    CHECK(strstr(Json.GetChars(), "\"bar_type\":\"tick1\"") != nullptr);
+    CHECK(strstr(Json.GetChars(), "\"bar_type\":\"range1t\"") != nullptr);
+    CHECK(strstr(Json.GetChars(), "\"high\":25.000000") != nullptr);
+    CHECK(strstr(Json.GetChars(), "\"total_bars\":3") != nullptr);
+    CHECK(Custom.StreamId(sc) == "ES:1:custom:6000");
+
+    Custom.Finished.erase(Custom.Finished.begin() + 1);
+    CHECK(Custom.ContiguousCount(10) == 1);
+
+    Custom.InFlight = 1;
+    CHECK(Custom.Acknowledge() == 1);
+    CHECK(Custom.Finished.size() == 1 && Custom.Finished[0].Sequence == 3);
+}
+
+static void AddRecord(s_sc& sc, unsigned Sequence, double Seconds, float Price, unsigned Volume, int Type)
+{
+    s_TimeAndSales Record;
+    Record.Sequence = Sequence;
+    Record.DateTime = SCDateTime(45730.0 + Seconds / 86400.0);
+    Record.Price = Price;
+    Record.Volume = Volume;
+    Record.Type = Type;
+    Record.AskSize = 7;
+    Record.BidSize = 9;
+    sc.TimeAndSales.Records.push_back(Record);
+}
+
+// The first pass only primes; later passes hand over new trades in ticks
+static void TestTimeAndSalesReader()
+{
+    s_sc sc;
+    AddRecord(sc, 1, 0, 5000.00f, 3, SC_TS_ASK);
+    s_TimeAndSalesReader Reader;
+    std::vector<s_Trade> Trades;
+    auto Sink = [&](const s_Trade& Trade) { Trades.push_back(Trade); };
+    Reader.Read(sc, Sink);
+    CHECK(Trades.empty());
+
+    AddRecord(sc, 2, 1.5, 5000.25f, 4, SC_TS_BID);
+    AddRecord(sc, 3, 1.5, 5000.25f, 0, SC_TS_ASK);
+    AddRecord(sc, 4, 2, 5000.50f, 1, SC_TS_BIDASKVALUES);
+    AddRecord(sc, 5, 2.25, 5001.00f, 2, SC_TS_ASK);
+    Reader.Read(sc, Sink);
+    CHECK(Trades.size() == 2);
+    CHECK(Trades[0].PriceTicks == 20001 && !Trades[0].AtAsk);
+    CHECK_NEAR(Trades[0].RestingSize, 9);
+    CHECK(Trades[1].PriceTicks == 20004 && Trades[1].AtAsk);
+    CHECK(Trades[1].TimeMs - Trades[0].TimeMs == 750);
+    CHECK(FormatTradeFlowTime(Trades[1].TimeMs) == "2025-03-14 00:00:02.250");
+
+    Reader.Read(sc, Sink);
+    CHECK(Trades.size() == 2);
+
+    // A restarted feed sequence primes again instead of replaying
+    sc.TimeAndSales.Records.clear();
+    AddRecord(sc, 1, 3, 5002.00f, 1, SC_TS_ASK);
+    Reader.Read(sc, Sink);
+    CHECK(Trades.size() == 2);
+}
+
+int main()
+{
+    TestRange();
+    TestVolume();
+    TestTickAndDelta();
+    TestRenko();
+    TestLabels();
+    TestBatch();
+    TestTimeAndSalesReader();
+    return TestResult("custombars_test");
+}
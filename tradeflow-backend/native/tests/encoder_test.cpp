@@ -0,0 +1,188 @@
+// Collector batch encoding: EncodeTradeFlowBatch on captured bars must write
+// the same bytes as CreateTradeFlowBatchJSON on the chart, with and without
+// the bar cache, the streaming calculations and the optional arrays, and on
+// the encoder pool. The collector source is compiled against sierrachart.h
+// from this directory, a stand-in for the ACSIL header.
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative/tests -Inative -I. native/tests/encoder_test.cpp -o encoder_test -lpthread && ./encoder_test
+#include "TradeFlow_Pro_Data_Collector.cpp"
+#include "check.h"
+
+#include <chrono>
+#include <thread>
+
+static const int BAR_COUNT = 40;
+
+// A 1 minute chart from 2025-03-14 13:30 with prices on a 0.25 tick
+static void FillChart(s_sc& sc, bool OptionalArrays)
+{
+    sc.Symbol = "ESM5";
+    sc.ChartNumber = 3;
+    sc.SecondsPerBar = 60;
+    sc.ArraySize = BAR_COUNT;
+    sc.CurrentSystemDateTime = SCDateTime(45730.0 + (13 * 3600 + 30 * 60 + 40 * 60 + 7) / 86400.0);
+    sc.BaseDateTimeIn.Values.clear();
+    for (SCFloatArray& Array : sc.BaseDataIn)
+        Array.Values.clear();
+    sc.NumberOfTrades.Values.clear();
+
+    for (int i = 0; i < BAR_COUNT; i++)
+    {
+        sc.BaseDateTimeIn.Values.push_back(SCDateTime(45730.0 + (13 * 3600 + 30 * 60 + i * 60) / 86400.0));
+        float Open = 5012.25f + (float)(i % 7) * 0.25f - (float)(i % 3) * 0.5f;
+        sc.BaseDataIn[SC_OPEN].Values.push_back(Open);
+        sc.BaseDataIn[SC_HIGH].Values.push_back(Open + 1.75f);
+        sc.BaseDataIn[SC_LOW].Values.push_back(Open - 1.25f);
+        sc.BaseDataIn[SC_LAST].Values.push_back(Open + (i % 2 ? 0.5f : -0.25f));
+        sc.BaseDataIn[SC_VOLUME].Values.push_back((float)(1200 + i * 37));
+        if (OptionalArrays)
+        {
+            // Every fifth bar has no bid volume and no open interest: the
+            // zero branches of both encoders
+            sc.BaseDataIn[SC_BIDVOL].Values.push_back(i % 5 == 0 ? 0.0f : (float)(500 + i * 11));
+            sc.BaseDataIn[SC_ASKVOL].Values.push_back((float)(700 + i * 26));
+            sc.BaseDataIn[SC_OPEN_INTEREST].Values.push_back(i % 5 == 0 ? 0.0f : (float)(2100000 + i));
+            sc.NumberOfTrades.Values.push_back((float)(i % 4 == 0 ? 0 : 300 + i));
+        }
+    }
+}
+
+static s_StreamingCalcConfig AllCalcs()
+{
+    s_StreamingCalcConfig Config;
+    Config.Delta = true;
+    Config.CVD = true;
+    Config.VWAP = true;
+    Config.EMAPeriods[0] = 9;
+    Config.EMAPeriods[2] = 21;    // A gap between enabled slots
+    return Config;
+}
+
+static std::string Chart(s_sc& sc, int Start, int End, const char* Source, const s_StreamingCalcs* Calcs, s_EncodedBarCache* Cache)
+{
+    SCString Json = CreateTradeFlowBatchJSON(sc, Start, End, Source, Calcs, Cache);
+    return std::string(Json.GetChars(), (size_t)Json.GetLength());
+}
+
+static std::string Encoded(s_sc& sc, int Start, int End, const char* Source, const s_StreamingCalcs* Calcs)
+{
+    s_RawBarBatch Batch;
+    CaptureTradeFlowBatch(sc, Start, End, Source, Calcs, Batch);
+    std::string Out;
+    EncodeTradeFlowBatch(Batch, Out);
+    return Out;
+}
+
+static void CheckSame(const std::string& Expected, const std::string& Actual)
+{
+    CHECK(Expected == Actual);
+    if (Expected != Actual)
+    {
+        size_t At = 0;
+        while (At < Expected.size() && At < Actual.size() && Expected[At] == Actual[At])
+            At++;
+        printf("  first difference at byte %zu:\n  chart:   %.80s\n  encoded: %.80s\n", At,
+            Expected.c_str() + std::min(At, Expected.size()), Actual.c_str() + std::min(At, Actual.size()));
+    }
+}
+
+static void TestWithCalcs()
+{
+    s_sc sc;
+    FillChart(sc, true);
+    s_StreamingCalcs Calcs;
+    Calcs.Configure(AllCalcs());
+    // The last two bars have no values yet, so they carry no calculated fields
+    Calcs.Update(sc, BAR_COUNT - 3);
+
+    std::string Expected = Chart(sc, 0, BAR_COUNT - 1, "sierra_chart_batch", &Calcs, nullptr);
+    CHECK(Expected.find("\"ema\":{\"9\":") != std::string::npos);
+    CHECK(Expected.find("\"bid_volume\":0.0,") != std::string::npos);
+    CHECK(Expected.find("\"open_interest\":null,") != std::string::npos);
+    CheckSame(Expected, Encoded(sc, 0, BAR_COUNT - 1, "sierra_chart_batch", &Calcs));
+
+    CheckSame(Chart(sc, 7, 7, "sierra_chart_historical", &Calcs, nullptr),
+        Encoded(sc, 7, 7, "sierra_chart_historical", &Calcs));
+}
+
+static void TestWithoutCalcsOrOptionalArrays()
+{
+    s_sc sc;
+    FillChart(sc, false);
+    std::string Expected = Chart(sc, 3, 20, "sierra_chart_batch", nullptr, nullptr);
+    CHECK(Expected.find("\"number_of_trades\":0,") != std::string::npos);
+    CheckSame(Expected, Encoded(sc, 3, 20, "sierra_chart_batch", nullptr));
+
+    // Calculations configured but all disabled emit nothing either
+    s_StreamingCalcs Calcs;
+    Calcs.Update(sc, BAR_COUNT - 1);
+    CheckSame(Chart(sc, 3, 20, "sierra_chart_batch", &Calcs, nullptr), Encoded(sc, 3, 20, "sierra_chart_batch", &Calcs));
+}
+
+// Bodies served from the bar cache are the bytes the encoder writes too
+static void TestBarCache()
+{
+    s_sc sc;
+    FillChart(sc, true);
+    s_StreamingCalcs Calcs;
+    Calcs.Configure(AllCalcs());
+    Calcs.Update(sc, BAR_COUNT - 1);
+
+    s_EncodedBarCache Cache;
+    Cache.Configure(1000);
+    std::string First = Chart(sc, 0, BAR_COUNT - 1, "sierra_chart_batch", &Calcs, &Cache);
+    std::string Cached = Chart(sc, 0, BAR_COUNT - 1, "sierra_chart_batch", &Calcs, &Cache);
+    CHECK(Cache.Hits > 0);
+    CheckSame(First, Cached);
+    CheckSame(Cached, Encoded(sc, 0, BAR_COUNT - 1, "sierra_chart_batch", &Calcs));
+}
+
+static void TestEncoderPool()
+{
+    s_sc sc;
+    FillChart(sc, true);
+    s_StreamingCalcs Calcs;
+    Calcs.Configure(AllCalcs());
+    Calcs.Update(sc, BAR_COUNT - 1);
+
+    c_EncoderPool Pool;
+    Pool.Acquire(3);
+    c_EncoderStream Stream;
+    std::vector<std::string> Expected;
+    for (int Start = 0; Start + 10 <= BAR_COUNT; Start += 5)
+    {
+        Expected.push_back(Chart(sc, Start, Start + 9, "sierra_chart_batch", &Calcs, nullptr));
+        std::shared_ptr<s_RawBarBatch> Batch = std::make_shared<s_RawBarBatch>();
+        CaptureTradeFlowBatch(sc, Start, Start + 9, "sierra_chart_batch", &Calcs, *Batch);
+        Stream.Submit(Pool, [Batch](std::string& Buffer) { EncodeTradeFlowBatch(*Batch, Buffer); });
+    }
+
+    // Bodies come back in submission order
+    size_t Received = 0;
+    auto Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (Received < Expected.size() && std::chrono::steady_clock::now() < Deadline)
+    {
+        std::string Body;
+        uint64_t Ticket = 0;
+        if (!Stream.Poll(Body, Ticket))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        CHECK(Ticket == Received + 1);
+        CheckSame(Expected[Received], Body);
+        Received++;
+    }
+    CHECK(Received == Expected.size());
+    Pool.Release();
+}
+
+int main()
+{
+    TestWithCalcs();
+    TestWithoutCalcsOrOptionalArrays();
+    TestBarCache();
+    TestEncoderPool();
+    return TestResult("encoder_test");
+}
@@ -0,0 +1,138 @@
+// Footprint store: bucketing and ladders, query order, coverage of a partial
+// first bucket, ring eviction into the archive (open and sealed blocks),
+// the archive cap, and late prints
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/footprint_test.cpp -o footprint_test && ./footprint_test
+#include "footprint.h"
+#include "check.h"
+
+using namespace n_TradeFlow;
+
+static const int64_t SECOND = 1000000;
+static const int64_t MINUTE = 60 * SECOND;
+
+// Volume of the level at Price in bar b of a query result, or -1 if absent
+static double LevelVolume(const c_FootprintStore& Store, const s_FootprintColumns& Columns, size_t b, double Price)
+{
+    for (uint32_t l = Columns.LevelStart[b]; l < Columns.LevelStart[b + 1]; l++)
+    {
+        if (Columns.LowTicks[b] + Columns.TickOffsets[l] == Store.ToTick(Price))
+            return Columns.Volume[l];
+    }
+    return -1;
+}
+
+static void TestBucketsAndLevels()
+{
+    c_FootprintStore Store(0.25, { 60, 300 }, 100, 1000);
+    CHECK(Store.Add("ES", 0, 100.0, 5, 2, 3));
+    CHECK(Store.Add("ES", 10 * SECOND, 100.5, 4, 4, 0));
+    CHECK(Store.Add("ES", 20 * SECOND, 100.0, 1, 0, 1));
+    CHECK(Store.Add("ES", 30 * SECOND, 99.25, 2, 1, 1));    // Ladder grows downwards
+    CHECK(Store.Add("ES", MINUTE + SECOND, 101.0, 7, 3, 4));
+    CHECK(!Store.Add("ES", 2 * MINUTE, NAN, 1, 1, 0));
+
+    s_FootprintColumns Columns;
+    CHECK(Store.Query("ES", 60, 0, 10 * MINUTE, Columns));
+    CHECK(Columns.BarCount() == 2);
+    CHECK(Columns.Times[0] == 0 && Columns.Times[1] == MINUTE);
+
+    // Oldest bar first, levels ascending from the bar's low, empty levels left out
+    CHECK(Columns.LevelStart[1] - Columns.LevelStart[0] == 3);
+    CHECK(Columns.LowTicks[0] == Store.ToTick(99.25));
+    CHECK(Columns.TickOffsets[0] == 0 && Columns.TickOffsets[1] == 3 && Columns.TickOffsets[2] == 5);
+    CHECK_NEAR(LevelVolume(Store, Columns, 0, 100.0), 6);
+    CHECK_NEAR(Columns.BidVolume[1], 2);
+    CHECK_NEAR(Columns.AskVolume[1], 4);
+    CHECK(LevelVolume(Store, Columns, 0, 99.5) == -1);
+    CHECK_NEAR(LevelVolume(Store, Columns, 1, 101.0), 7);
+    CHECK_NEAR(Store.ToPrice(Columns.LowTicks[1]), 101.0);
+
+    // The 5 minute series holds both minutes in one bar
+    CHECK(Store.Query("ES", 300, 0, 10 * MINUTE, Columns));
+    CHECK(Columns.BarCount() == 1 && Columns.LevelStart[1] == 4);
+
+    // A start inside a bucket includes the whole bucket
+    CHECK(Store.Query("ES", 60, MINUTE + 30 * SECOND, MINUTE + 40 * SECOND, Columns));
+    CHECK(Columns.BarCount() == 1 && Columns.Times[0] == MINUTE);
+    CHECK(!Store.Query("ES", 900, 0, MINUTE, Columns));
+    CHECK(!Store.Query("NQ", 60, 0, MINUTE, Columns));
+    CHECK(Store.CoveredFrom("NQ", 60) == FOOTPRINT_NOT_COVERED);
+}
+
+// Coverage starts at the first complete bucket and moves with the archive
+static void TestCoverageAndEviction()
+{
+    c_FootprintStore Store(1.0, { 60 }, 4, 600);
+    CHECK(Store.Add("ES", 10 * SECOND, 100.0, 1, 0, 1));
+    CHECK(Store.CoveredFrom("ES", 60) == MINUTE);
+
+    // 700 more one-minute bars: the ring keeps 4, the archive seals 256-bar
+    // blocks and drops the oldest block past 600 archived bars
+    for (int64_t m = 1; m <= 700; m++)
+    {
+        CHECK(Store.Add("ES", m * MINUTE, (double)(100 + m % 7), (double)m, 0, (double)m));
+        if (m == 500)
+            CHECK(Store.CoveredFrom("ES", 60) == MINUTE);
+    }
+
+    s_FootprintStats Stats = Store.GetStats();
+    CHECK(Stats.RingBars == 4);
+    CHECK(Stats.ArchivedBars == 441);
+    CHECK(Stats.ArchivedBytes > 0);
+
+    // Minutes 0..696 left the ring: 0..255 sealed and dropped, 256..511
+    // sealed, 512..696 still open
+    int64_t CoveredFrom = Store.CoveredFrom("ES", 60);
+    CHECK(CoveredFrom == 256 * MINUTE);
+
+    // Bars come back the same from a sealed block, the open block and the ring
+    s_FootprintColumns Columns;
+    CHECK(Store.Query("ES", 60, CoveredFrom, 700 * MINUTE, Columns));
+    CHECK(Columns.BarCount() == 445);
+    bool AllMatch = true;
+    for (size_t b = 0; b < Columns.BarCount(); b++)
+    {
+        int64_t Minute = Columns.Times[b] / MINUTE;
+        AllMatch &= Columns.Times[b] == (256 + (int64_t)b) * MINUTE;
+        AllMatch &= Columns.LevelStart[b + 1] - Columns.LevelStart[b] == 1;
+        AllMatch &= LevelVolume(Store, Columns, b, (double)(100 + Minute % 7)) == (double)Minute;
+        AllMatch &= Columns.AskVolume[Columns.LevelStart[b]] == (double)Minute;
+    }
+    CHECK(AllMatch);
+
+    // Archived bars are immutable; the ring still takes late prints
+    CHECK(!Store.Add("ES", 300 * MINUTE, 100.0, 1, 1, 0));
+    CHECK(Store.Add("ES", 698 * MINUTE + SECOND, 100.0, 1, 1, 0));
+    CHECK(Store.Query("ES", 60, 698 * MINUTE, 698 * MINUTE, Columns));
+    CHECK(Columns.BarCount() == 1 && Columns.LevelStart[1] == 2);
+}
+
+// A late print for a bucket the ring skipped cannot be placed
+static void TestSkippedBucket()
+{
+    c_FootprintStore Store(1.0, { 60 }, 10, 0);
+    CHECK(Store.Add("ES", 0, 100.0, 1, 0, 1));
+    CHECK(Store.Add("ES", 2 * MINUTE, 100.0, 1, 0, 1));
+    CHECK(!Store.Add("ES", MINUTE, 100.0, 1, 0, 1));
+    CHECK(Store.Add("ES", 30 * SECOND, 101.0, 1, 0, 1));
+
+    s_FootprintColumns Columns;
+    CHECK(Store.Query("ES", 60, 0, 5 * MINUTE, Columns));
+    CHECK(Columns.BarCount() == 2 && Columns.Times[1] == 2 * MINUTE);
+
+    // Without an archive, coverage is the ring
+    for (int64_t m = 3; m < 20; m++)
+        Store.Add("ES", m * MINUTE, 100.0, 1, 0, 1);
+    CHECK(Store.CoveredFrom("ES", 60) == 10 * MINUTE);
+    CHECK(Store.GetStats().ArchivedBars == 0);
+}
+
+int main()
+{
+    TestBucketsAndLevels();
+    TestCoverageAndEviction();
+    TestSkippedBucket();
+    return TestResult("footprint_test");
+}
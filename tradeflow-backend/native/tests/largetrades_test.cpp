@@ -0,0 +1,218 @@
+// Collector large trade detector: the log-bucket size sketch's relative
+// error and halving decay, the block threshold (warm-up, percentile, floor,
+// periodic refresh), and iceberg clusters across the 8 slots (reported once,
+// window expiry, displayed size, stalest slot reused). Built against the
+// sierrachart.h stand-in.
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative/tests -I. native/tests/largetrades_test.cpp -o largetrades_test && ./largetrades_test
+#include "sierrachart.h"
+#include "TradeFlow_Pro_LargeTrades.h"
+#include "check.h"
+
+static s_Trade Trade(long long TimeMs, int PriceTicks, double Volume, bool AtAsk, double RestingSize = 0)
+{
+    s_Trade Result;
+    Result.TimeMs = TimeMs;
+    Result.PriceTicks = PriceTicks;
+    Result.Volume = Volume;
+    Result.AtAsk = AtAsk;
+    Result.RestingSize = RestingSize;
+    return Result;
+}
+
+static s_LargeTradeConfig Enabled()
+{
+    s_LargeTradeConfig Config;
+    Config.Enabled = true;
+    return Config;
+}
+
+static int CountCode(const s_OrderFlowDetector& Out, const char* Code)
+{
+    int Count = 0;
+    for (const s_OrderFlowEvent& Event : Out.Events)
+        Count += strcmp(Event.Code, Code) == 0;
+    return Count;
+}
+
+// Every quantile is the upper bound of its bucket: never below the size and
+// less than one bucket (8%) above it
+static void TestSketchError()
+{
+    bool WithinBound = true;
+    for (double Size = 1; Size < 2000000; Size = Size * 1.37 + 1)
+    {
+        s_SizeSketch Sketch;
+        Sketch.Add(Size);
+        double Bound = Sketch.Quantile(0.5);
+        WithinBound &= Bound >= Size * (1 - 1e-9) && Bound < Size * SIZE_SKETCH_GAMMA * (1 + 1e-9);
+    }
+    CHECK(WithinBound);
+
+    s_SizeSketch Sketch;
+    for (int Size = 1; Size <= 100; Size++)
+        Sketch.Add(Size);
+    CHECK(Sketch.Quantile(0.5) >= 50 && Sketch.Quantile(0.5) < 50 * SIZE_SKETCH_GAMMA);
+    CHECK(Sketch.Quantile(1.0) >= 100 && Sketch.Quantile(1.0) < 100 * SIZE_SKETCH_GAMMA);
+    CHECK_NEAR(Sketch.Quantile(0.0), 1.0);
+
+    // Sizes past the last bucket are held there
+    Sketch.Add(1e12);
+    CHECK_NEAR(Sketch.Quantile(1.0), pow(SIZE_SKETCH_GAMMA, SIZE_SKETCH_BUCKETS - 1));
+}
+
+// Counts halve every half-life, so a newer tape outweighs an older one of the
+// same length
+static void TestSketchDecay()
+{
+    s_SizeSketch Sketch;
+    for (int i = 0; i < SIZE_SKETCH_HALF_LIFE; i++)
+        Sketch.Add(1);
+    CHECK_NEAR(Sketch.Total, SIZE_SKETCH_HALF_LIFE / 2);
+    CHECK(Sketch.SinceDecay == 0);
+
+    for (int i = 0; i < SIZE_SKETCH_HALF_LIFE; i++)
+        Sketch.Add(50);
+    CHECK_NEAR(Sketch.Total, SIZE_SKETCH_HALF_LIFE * 3 / 4);
+    // Without the decay the median would sit on the older 1-lots
+    CHECK(Sketch.Quantile(0.5) >= 50 && Sketch.Quantile(0.5) < 50 * SIZE_SKETCH_GAMMA);
+    CHECK_NEAR(Sketch.Quantile(0.3), 1.0);
+}
+
+// Trades two seconds apart at changing prices so no cluster forms
+static void Feed(s_LargeTradeDetector& Detector, s_OrderFlowDetector& Out, long long& TimeMs, int Count, double Size)
+{
+    for (int i = 0; i < Count; i++)
+    {
+        TimeMs += 2000;
+        Detector.Add(Trade(TimeMs, 1000 + i % 50, Size, i % 2 == 0), Out);
+    }
+}
+
+static void TestBlockThreshold()
+{
+    s_LargeTradeDetector Detector;
+    Detector.Configure(Enabled());
+    s_OrderFlowDetector Out;
+    long long TimeMs = 0;
+
+    // Nothing before the warm-up, however large
+    Feed(Detector, Out, TimeMs, 300, 1);
+    Feed(Detector, Out, TimeMs, 1, 500);
+    CHECK(Out.Events.empty());
+
+    // A thin tape of 1-lots: the floor sets the block size
+    Feed(Detector, Out, TimeMs, 198, 1);
+    CHECK(Detector.Sketch.Total == LARGETRADE_WARMUP_TRADES - 1);
+    Detector.Add(Trade(TimeMs + 2000, 900, 10, true), Out);
+    CHECK(Out.Events.size() == 1);
+    CHECK(strcmp(Out.Events[0].Code, "LB") == 0 && Out.Events[0].LowTick == 900 && Out.Events[0].Volume == 10);
+    CHECK(Out.Events[0].TimeMs == TimeMs + 2000);
+    TimeMs += 2000;
+    Detector.Add(Trade(TimeMs + 2000, 900, 9, false), Out);
+    CHECK(Out.Events.size() == 1);
+    TimeMs += 2000;
+
+    // One print in a hundred at 300 lots moves the 99.5th percentile there:
+    // the first few are blocks against the floor, later ones fall under the
+    // refreshed threshold (the upper bound of their own bucket)
+    Out.Events.clear();
+    for (int i = 0; i < 2000; i++)
+        Feed(Detector, Out, TimeMs, 1, i % 100 == 0 ? 300 : 2);
+    CHECK(Detector.Threshold >= 300 && Detector.Threshold < 300 * SIZE_SKETCH_GAMMA);
+    int Blocks = CountCode(Out, "LB") + CountCode(Out, "LS");
+    CHECK(Blocks > 0 && Blocks < 20);
+    Out.Events.clear();
+    Feed(Detector, Out, TimeMs, 1, 200);
+    CHECK(Out.Events.empty());
+    Feed(Detector, Out, TimeMs, 1, 330);
+    CHECK(Out.Events.size() == 1);
+
+    // New settings start a fresh sketch
+    s_LargeTradeConfig Changed = Enabled();
+    Changed.Percentile = 99.0f;
+    Detector.Configure(Changed);
+    CHECK(Detector.Sketch.Total == 0 && Detector.Threshold == 0);
+
+    s_LargeTradeDetector Disabled;
+    Disabled.Add(Trade(0, 1, 1000, true), Out);
+    CHECK(Disabled.Sketch.Total == 0);
+}
+
+// Prints at one price and side inside the window add up; once they reach
+// the block size and three times the largest displayed size, one iceberg is
+// reported with the cluster's first print time
+static void TestIceberg()
+{
+    s_LargeTradeDetector Detector;
+    Detector.Configure(Enabled());
+    s_OrderFlowDetector Out;
+
+    Detector.Add(Trade(1000, 500, 10, true, 5), Out);
+    Detector.Add(Trade(1100, 500, 10, false, 5), Out);   // Other side, its own cluster
+    Detector.Add(Trade(1200, 500, 10, true, 5), Out);
+    CHECK(Out.Events.empty());
+    Detector.Add(Trade(1300, 500, 10, true, 5), Out);
+    CHECK(Out.Events.size() == 1);
+    CHECK(strcmp(Out.Events[0].Code, "IA") == 0);
+    CHECK(Out.Events[0].TimeMs == 1000 && Out.Events[0].LowTick == 500 && Out.Events[0].Volume == 30);
+
+    Detector.Add(Trade(1400, 500, 10, true, 5), Out);
+    CHECK(Out.Events.size() == 1);
+
+    // The window runs from the first print: a later print starts over
+    Detector.Add(Trade(2001, 500, 10, true, 5), Out);
+    Detector.Add(Trade(2100, 500, 10, true, 5), Out);
+    CHECK(Out.Events.size() == 1);
+    Detector.Add(Trade(2200, 500, 10, true, 5), Out);
+    CHECK(Out.Events.size() == 2 && Out.Events[1].TimeMs == 2001);
+
+    // Large displayed size: executed volume is not hidden size
+    Detector.Add(Trade(5000, 600, 10, false, 20), Out);
+    Detector.Add(Trade(5010, 600, 10, false, 20), Out);
+    Detector.Add(Trade(5020, 600, 10, false, 20), Out);
+    CHECK(Out.Events.size() == 2);
+    Detector.Add(Trade(5030, 600, 40, false, 20), Out);
+    CHECK(Out.Events.size() == 3 && strcmp(Out.Events[2].Code, "IB") == 0);
+}
+
+// A ninth concurrent cluster takes the slot of the one printed least recently
+static void TestClusterSlots()
+{
+    s_LargeTradeDetector Detector;
+    Detector.Configure(Enabled());
+    s_OrderFlowDetector Out;
+
+    for (int c = 0; c < LARGETRADE_CLUSTER_SLOTS; c++)
+    {
+        Detector.Add(Trade(2 * c, 700 + c, 10, true, 1), Out);
+        Detector.Add(Trade(2 * c + 1, 700 + c, 10, true, 1), Out);
+    }
+    Detector.Add(Trade(16, 800, 10, true, 1), Out);
+    CHECK(Out.Events.empty());
+
+    // Price 701 kept its two prints; 700 lost them to 800
+    Detector.Add(Trade(17, 701, 10, true, 1), Out);
+    CHECK(Out.Events.size() == 1 && Out.Events[0].LowTick == 701 && Out.Events[0].TimeMs == 2);
+    Detector.Add(Trade(18, 700, 10, true, 1), Out);
+    CHECK(Out.Events.size() == 1);
+    Detector.Add(Trade(19, 700, 10, true, 1), Out);
+    Detector.Add(Trade(20, 700, 10, true, 1), Out);
+    CHECK(Out.Events.size() == 2 && Out.Events[1].LowTick == 700 && Out.Events[1].TimeMs == 18);
+
+    // Reset forgets every cluster
+    Detector.Reset();
+    Detector.Add(Trade(21, 703, 10, true, 1), Out);
+    CHECK(Out.Events.size() == 2);
+}
+
+int main()
+{
+    TestSketchError();
+    TestSketchDecay();
+    TestBlockThreshold();
+    TestIceberg();
+    TestClusterSlots();
+    return TestResult("largetrades_test");
+}
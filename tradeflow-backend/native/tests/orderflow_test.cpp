@@ -0,0 +1,230 @@
+// Collector order flow detector: the vectorised diagonal imbalance marking
+// against the scalar rule at every ladder length (whole blocks, tails, short
+// ladders, padding left untouched), stacked runs emitted once as they grow,
+// unfinished auctions and absorption at close, history never replayed, and
+// the event queue surviving a settings change. Built against the
+// sierrachart.h stand-in.
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative/tests -I. native/tests/orderflow_test.cpp -o orderflow_test && ./orderflow_test
+#include "sierrachart.h"
+#include "TradeFlow_Pro_OrderFlow.h"
+#include "check.h"
+
+static unsigned char ScalarFlag(const float* Bid, const float* Ask, int k, float Ratio, float MinVolume)
+{
+    unsigned char Flag = 0;
+    if (Ask[k] >= Ratio * Bid[k - 1] && Ask[k] >= MinVolume)
+        Flag |= ORDERFLOW_BUY_IMBALANCE;
+    if (Bid[k] >= Ratio * Ask[k + 1] && Bid[k] >= MinVolume)
+        Flag |= ORDERFLOW_SELL_IMBALANCE;
+    return Flag;
+}
+
+// Small integer volumes so ratio and minimum ties are exact and common
+static void TestMarkMatchesScalar()
+{
+    const unsigned char Sentinel = 0xEE;
+    unsigned Seed = 12345;
+    bool AllMatch = true;
+    bool PaddingKept = true;
+    int Marked = 0;
+
+    for (int Levels = 1; Levels <= 67; Levels++)
+    {
+        for (int Round = 0; Round < 20; Round++)
+        {
+            std::vector<float> Bid(Levels + 6, 0.0f), Ask(Levels + 6, 0.0f);
+            for (int k = 1; k <= Levels; k++)
+            {
+                Seed = Seed * 1103515245u + 12345u;
+                Bid[k] = (float)((Seed >> 16) % 13);
+                Seed = Seed * 1103515245u + 12345u;
+                Ask[k] = (float)((Seed >> 16) % 40);
+            }
+            std::vector<unsigned char> Flags(Levels + 2, Sentinel);
+            MarkDiagonalImbalances(Bid.data(), Ask.data(), Levels, 3.0f, 10.0f, Flags.data());
+
+            for (int k = 1; k <= Levels; k++)
+            {
+                AllMatch &= Flags[k] == ScalarFlag(Bid.data(), Ask.data(), k, 3.0f, 10.0f);
+                Marked += Flags[k] != 0;
+            }
+            PaddingKept &= Flags[0] == Sentinel && Flags[Levels + 1] == Sentinel;
+        }
+    }
+    CHECK(AllMatch);
+    CHECK(PaddingKept);
+    CHECK(Marked > 0);
+
+    // Exact ties count; a zero neighbour below the minimum does not
+    float Bid[10] = { 0, 4, 0, 10, 0, 0, 0, 0, 0, 0 };
+    float Ask[10] = { 0, 0, 12, 0, 9, 0, 0, 0, 0, 0 };
+    unsigned char Flags[6] = {};
+    MarkDiagonalImbalances(Bid, Ask, 4, 3.0f, 10.0f, Flags);
+    CHECK(Flags[1] == 0);
+    CHECK(Flags[2] == ORDERFLOW_BUY_IMBALANCE);
+    CHECK(Flags[3] == 0);   // 10 < 3 * 9
+    CHECK(Flags[4] == 0);   // 9 below the minimum
+}
+
+static void SetLadder(s_sc& sc, c_VAPContainer& VAP, int Index, int LowTick, std::vector<std::pair<unsigned, unsigned>> BidAsk, float Close)
+{
+    if ((int)VAP.Bars.size() <= Index)
+        VAP.Bars.resize((size_t)Index + 1);
+    VAP.Bars[(size_t)Index].clear();
+    for (size_t l = 0; l < BidAsk.size(); l++)
+    {
+        s_VolumeAtPriceV2 Level;
+        Level.PriceInTicks = LowTick + (int)l;
+        Level.BidVolume = BidAsk[l].first;
+        Level.AskVolume = BidAsk[l].second;
+        Level.Volume = Level.BidVolume + Level.AskVolume;
+        if (Level.Volume > 0)
+            VAP.Bars[(size_t)Index].push_back(Level);
+    }
+    while (sc.ArraySize <= Index)
+    {
+        sc.BaseDateTimeIn.Values.push_back(SCDateTime(45730.0 + sc.ArraySize * 60 / 86400.0));
+        sc.BaseDataIn[SC_LAST].Values.push_back(0);
+        sc.ArraySize++;
+    }
+    sc.BaseDataIn[SC_LAST][Index] = Close;
+}
+
+static s_OrderFlowConfig Enabled()
+{
+    s_OrderFlowConfig Config;
+    Config.Enabled = true;
+    Config.AbsorptionMultiple = 2.0f;
+    return Config;
+}
+
+static bool IsEvent(const s_OrderFlowEvent& Event, const char* Code, int Low, int High, float Volume)
+{
+    return strcmp(Event.Code, Code) == 0 && Event.LowTick == Low && Event.HighTick == High && Event.Volume == Volume;
+}
+
+static void TestDetector()
+{
+    s_sc sc;
+    c_VAPContainer VAP;
+    sc.VolumeAtPriceForBars = &VAP;
+    s_OrderFlowDetector Detector;
+    Detector.Configure(Enabled());
+
+    // Asks at 401..403 lift three times the bid below: a stacked buy run,
+    // sent while the bar is still forming
+    SetLadder(sc, VAP, 0, 400, { { 5, 2 }, { 4, 20 }, { 3, 15 }, { 2, 12 }, { 1, 1 } }, 101.0f);
+    Detector.Update(sc, 0);
+    CHECK(Detector.Events.size() == 1);
+    CHECK(IsEvent(Detector.Events[0], "SB", 401, 403, 47));
+    CHECK(Detector.Events[0].TimeMs == DateTimeToMs(sc.BaseDateTimeIn[0]));
+
+    // The run growing to 404 is the same zone
+    SetLadder(sc, VAP, 0, 400, { { 5, 2 }, { 4, 20 }, { 3, 15 }, { 2, 12 }, { 1, 10 } }, 100.75f);
+    Detector.Update(sc, 0);
+    CHECK(Detector.Events.size() == 1);
+
+    // The next bar finalises bar 0: both sides traded at both extremes
+    SetLadder(sc, VAP, 1, 500, { { 100, 0 }, { 2, 2 }, { 2, 2 } }, 125.5f);
+    Detector.Update(sc, 1);
+    CHECK(Detector.Events.size() == 3);
+    CHECK(IsEvent(Detector.Events[1], "UH", 404, 404, 11));
+    CHECK(IsEvent(Detector.Events[2], "UL", 400, 400, 7));
+
+    // Heavy selling into bar 1's low, closed away from it: absorption
+    SetLadder(sc, VAP, 2, 500, { { 1, 1 } }, 125.0f);
+    Detector.Update(sc, 2);
+    CHECK(Detector.Events.size() == 5);
+    CHECK(IsEvent(Detector.Events[3], "UH", 502, 502, 4));
+    CHECK(IsEvent(Detector.Events[4], "AL", 500, 500, 100));
+    CHECK(Detector.Events[4].TimeMs == DateTimeToMs(sc.BaseDateTimeIn[1]));
+
+    sc.Symbol = "ES";
+    SCString Json = Detector.CreateEventsJSON(sc, 1);
+    CHECK(Json == "{\"symbol\":\"ES\",\"seconds_per_bar\":60,\"events\":[[\"2025-03-14 00:00:00.000\",\"SB\",100.250000,100.750000,47]]}");
+}
+
+// The first update starts at the newest bar; older bars are never scanned
+static void TestNoReplay()
+{
+    s_sc sc;
+    c_VAPContainer VAP;
+    sc.VolumeAtPriceForBars = &VAP;
+    SetLadder(sc, VAP, 0, 400, { { 5, 2 }, { 4, 20 }, { 3, 15 }, { 2, 12 } }, 100.0f);
+    SetLadder(sc, VAP, 1, 400, { { 1, 1 } }, 100.0f);
+
+    s_OrderFlowDetector Detector;
+    Detector.Configure(Enabled());
+    Detector.Update(sc, 0);
+    Detector.Update(sc, 1);
+    CHECK(Detector.Events.empty());
+    CHECK(Detector.FirstIndex == 1);
+
+    s_OrderFlowDetector Disabled;
+    SetLadder(sc, VAP, 2, 400, { { 5, 2 }, { 4, 20 }, { 3, 15 }, { 2, 12 } }, 100.0f);
+    Disabled.Update(sc, 2);
+    CHECK(Disabled.Events.empty() && Disabled.FirstIndex == -1);
+}
+
+// Queued events, including large trade events sharing the queue, outlive a
+// settings change; only a full reset drops them
+static void TestConfigureKeepsQueue()
+{
+    s_sc sc;
+    c_VAPContainer VAP;
+    sc.VolumeAtPriceForBars = &VAP;
+    SetLadder(sc, VAP, 0, 400, { { 5, 2 }, { 4, 20 }, { 3, 15 }, { 2, 12 } }, 100.0f);
+
+    s_OrderFlowDetector Detector;
+    Detector.Configure(Enabled());
+    Detector.Update(sc, 0);
+    s_OrderFlowEvent Block;
+    Block.Code = "LB";
+    Detector.Events.push_back(Block);
+    Detector.InFlight = 1;
+
+    s_OrderFlowConfig Changed = Enabled();
+    Changed.StackedLevels = 2;
+    Detector.Configure(Changed);
+    CHECK(Detector.Events.size() == 2);
+    CHECK(Detector.InFlight == 1);
+    CHECK(Detector.FirstIndex == -1);
+    CHECK(Detector.Acknowledge() == 1);
+    CHECK(Detector.Events.size() == 1 && strcmp(Detector.Events[0].Code, "LB") == 0);
+
+    s_OrderFlowConfig Off;
+    Detector.Configure(Off);
+    CHECK(Detector.Events.size() == 1);
+
+    Detector.Reset();
+    CHECK(Detector.Events.empty() && Detector.InFlight == 0);
+}
+
+// Trim keeps the events of a pending request
+static void TestTrim()
+{
+    s_OrderFlowDetector Detector;
+    for (int i = 0; i < ORDERFLOW_MAX_PENDING + 5; i++)
+    {
+        s_OrderFlowEvent Event;
+        Event.TimeMs = i;
+        Detector.Events.push_back(Event);
+    }
+    Detector.InFlight = 3;
+    Detector.Trim();
+    CHECK((int)Detector.Events.size() == ORDERFLOW_MAX_PENDING);
+    CHECK(Detector.DroppedEvents == 5);
+    CHECK(Detector.Events[2].TimeMs == 2 && Detector.Events[3].TimeMs == 8);
+}
+
+int main()
+{
+    TestMarkMatchesScalar();
+    TestDetector();
+    TestNoReplay();
+    TestConfigureKeepsQueue();
+    TestTrim();
+    return TestResult("orderflow_test");
+}
@@ -0,0 +1,252 @@
+// Bar pyramid: every range read equals the time_bucket aggregation of the 1s
+// bars at the chosen level (first/max/min/last, sums skipping NULLs), level
+// selection by point budget and coverage, whole edge buckets, the forming
+// bucket updated in place, rings read across their wrap point, and the
+// partial first bucket left out
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/pyramid_test.cpp -o pyramid_test && ./pyramid_test
+#include "pyramid.h"
+#include "check.h"
+
+using namespace n_TradeFlow;
+
+static const int64_t SECOND = 1000000;
+static const int64_t T0 = 1700000000 * SECOND;   // A multiple of 2^7 seconds
+static const int LEVELS = 8;
+static const size_t LEVEL_BARS = 64;
+
+struct s_Bar
+{
+    int64_t Time;
+    double Values[PYRAMID_COLUMN_COUNT];
+};
+
+// 1s bars from T0 + 5 s with a few missing seconds and NULL columns
+static std::vector<s_Bar> MakeBars(int FirstSecond, int LastSecond)
+{
+    std::vector<s_Bar> Bars;
+    for (int s = FirstSecond; s <= LastSecond; s++)
+    {
+        if (s % 37 == 0)
+            continue;
+        s_Bar Bar;
+        Bar.Time = T0 + s * SECOND;
+        double Close = 4000 + (s % 17) - (s % 5) * 0.25;
+        Bar.Values[PYRAMID_OPEN] = Close - 0.5;
+        Bar.Values[PYRAMID_HIGH] = Close + (s % 3);
+        Bar.Values[PYRAMID_LOW] = Close - 1 - (s % 4);
+        Bar.Values[PYRAMID_CLOSE] = Close;
+        Bar.Values[PYRAMID_VOLUME] = 10 + s % 23;
+        Bar.Values[PYRAMID_BID_VOLUME] = s % 11 == 0 ? NAN : 4 + s % 7;
+        Bar.Values[PYRAMID_ASK_VOLUME] = s % 60 < 20 ? NAN : 6 + s % 5;
+        Bar.Values[PYRAMID_NUMBER_OF_TRADES] = 1 + s % 9;
+        Bar.Values[PYRAMID_OPEN_INTEREST] = s % 13 == 0 ? NAN : 20000 + s;
+        Bars.push_back(Bar);
+    }
+    return Bars;
+}
+
+// What get_bar_range's SQL returns at a level: time_bucket with first(open),
+// max, min, last(close), sum (NULL when every value is NULL) and
+// last(open_interest), for the buckets from StartTime's through EndTime's
+static s_PyramidColumns Aggregate(const std::vector<s_Bar>& Bars, int Level, int64_t StartTime, int64_t EndTime)
+{
+    int64_t Width = SECOND << Level;
+    int64_t First = PyramidBucket(StartTime, Width);
+    int64_t Last = PyramidBucket(EndTime, Width);
+    s_PyramidColumns Out;
+    for (const s_Bar& Bar : Bars)
+    {
+        int64_t Bucket = PyramidBucket(Bar.Time, Width);
+        if (Bucket < First || Bucket > Last)
+            continue;
+        if (Out.Time.empty() || Out.Time.back() != Bucket)
+        {
+            Out.Time.push_back(Bucket);
+            for (int c = 0; c < PYRAMID_COLUMN_COUNT; c++)
+                Out.Values[c].push_back(Bar.Values[c]);
+            continue;
+        }
+        double* Row[PYRAMID_COLUMN_COUNT];
+        for (int c = 0; c < PYRAMID_COLUMN_COUNT; c++)
+            Row[c] = &Out.Values[c].back();
+        *Row[PYRAMID_HIGH] = std::max(*Row[PYRAMID_HIGH], Bar.Values[PYRAMID_HIGH]);
+        *Row[PYRAMID_LOW] = std::min(*Row[PYRAMID_LOW], Bar.Values[PYRAMID_LOW]);
+        *Row[PYRAMID_CLOSE] = Bar.Values[PYRAMID_CLOSE];
+        *Row[PYRAMID_OPEN_INTEREST] = Bar.Values[PYRAMID_OPEN_INTEREST];
+        for (int c : { PYRAMID_VOLUME, PYRAMID_BID_VOLUME, PYRAMID_ASK_VOLUME, PYRAMID_NUMBER_OF_TRADES })
+        {
+            if (!std::isnan(Bar.Values[c]))
+                *Row[c] = std::isnan(*Row[c]) ? Bar.Values[c] : *Row[c] + Bar.Values[c];
+        }
+    }
+    return Out;
+}
+
+static bool SameValue(double A, double B)
+{
+    return (std::isnan(A) && std::isnan(B)) || A == B;
+}
+
+static bool Same(const s_PyramidColumns& Actual, const s_PyramidColumns& Expected)
+{
+    if (Actual.Time != Expected.Time)
+        return false;
+    for (int c = 0; c < PYRAMID_COLUMN_COUNT; c++)
+    {
+        for (size_t i = 0; i < Expected.Size(); i++)
+        {
+            if (!SameValue(Actual.Values[c][i], Expected.Values[c][i]))
+                return false;
+        }
+    }
+    return true;
+}
+
+static c_BarPyramid Build(const std::vector<s_Bar>& Bars)
+{
+    c_BarPyramid Pyramid(LEVELS, LEVEL_BARS);
+    for (const s_Bar& Bar : Bars)
+        Pyramid.Add("ES", Bar.Time, Bar.Values);
+    return Pyramid;
+}
+
+// The finest level within budget that covers StartTime, as Query documents it
+static int ExpectedLevel(const c_BarPyramid& Pyramid, int64_t StartTime, int64_t EndTime, size_t MaxPoints)
+{
+    uint64_t Span = (uint64_t)(EndTime - StartTime) + 1;
+    for (int l = 0; l < LEVELS; l++)
+    {
+        uint64_t Width = (uint64_t)(SECOND << l);
+        if ((Span + Width - 1) / Width + 1 > MaxPoints && l + 1 < LEVELS)
+            continue;
+        if (Pyramid.CoveredFrom("ES", l) <= PyramidBucket(StartTime, SECOND << l))
+            return l;
+    }
+    return -1;
+}
+
+static void TestRangesMatchAggregation()
+{
+    std::vector<s_Bar> Bars = MakeBars(5, 1000);
+    c_BarPyramid Pyramid = Build(Bars);
+
+    // The recent minute fits the 1s ring; a smaller budget moves up to 4s
+    s_PyramidColumns Out;
+    CHECK(Pyramid.Query("ES", T0 + 940 * SECOND, T0 + 999 * SECOND, 100, Out));
+    CHECK(Out.Level == 0 && Out.BucketSeconds == 1);
+    CHECK(Same(Out, Aggregate(Bars, 0, T0 + 940 * SECOND, T0 + 999 * SECOND)));
+    s_PyramidColumns Coarser;
+    CHECK(Pyramid.Query("ES", T0 + 940 * SECOND, T0 + 999 * SECOND, 20, Coarser));
+    CHECK(Coarser.Level == 2 && Coarser.Size() == 15);
+    CHECK(Same(Coarser, Aggregate(Bars, 2, T0 + 940 * SECOND, T0 + 999 * SECOND)));
+
+    // Older history is only in coarser rings: the finest covering one answers
+    s_PyramidColumns Older;
+    CHECK(Pyramid.Query("ES", T0 + 100 * SECOND, T0 + 400 * SECOND, 1000, Older));
+    CHECK(Older.Level == 4);
+    CHECK(Same(Older, Aggregate(Bars, 4, T0 + 100 * SECOND, T0 + 400 * SECOND)));
+
+    // Every level the rule picks agrees with SQL, across budgets and ranges
+    // (rings wrapped many times, so reads straddle the physical end)
+    bool AllMatch = true;
+    int Checked = 0;
+    for (int Start = 0; Start < 1000; Start += 53)
+    {
+        for (int Length : { 1, 7, 60, 333, 900 })
+        {
+            for (size_t Budget : { (size_t)2, (size_t)10, (size_t)70, (size_t)5000 })
+            {
+                int64_t StartTime = T0 + Start * SECOND + 250000;
+                int64_t EndTime = StartTime + Length * SECOND;
+                int Expected = ExpectedLevel(Pyramid, StartTime, EndTime, Budget);
+                s_PyramidColumns Columns;
+                bool Found = Pyramid.Query("ES", StartTime, EndTime, Budget, Columns);
+                AllMatch &= Found == (Expected >= 0);
+                if (!Found || Expected < 0)
+                    continue;
+                AllMatch &= Columns.Level == Expected;
+                AllMatch &= Same(Columns, Aggregate(Bars, Expected, StartTime, EndTime));
+                Checked++;
+            }
+        }
+    }
+    CHECK(AllMatch);
+    CHECK(Checked > 100);
+}
+
+// Buckets are whole at both edges: a range starting and ending inside a
+// bucket returns those buckets complete, bars after EndTime included
+static void TestPartialEdges()
+{
+    std::vector<s_Bar> Bars = MakeBars(5, 1000);
+    c_BarPyramid Pyramid = Build(Bars);
+
+    s_PyramidColumns Out;
+    int64_t StartTime = T0 + 517 * SECOND + 400000;
+    int64_t EndTime = T0 + 581 * SECOND;
+    CHECK(Pyramid.Query("ES", StartTime, EndTime, 6, Out));
+    CHECK(Out.Level == 4);
+    CHECK(Out.Time.front() == T0 + 512 * SECOND && Out.Time.back() == T0 + 576 * SECOND);
+    CHECK(Same(Out, Aggregate(Bars, 4, StartTime, EndTime)));
+    // The last bucket holds 577..591 too
+    CHECK_NEAR(Out.Values[PYRAMID_VOLUME].back(), Aggregate(Bars, 4, T0 + 576 * SECOND, T0 + 591 * SECOND).Values[PYRAMID_VOLUME][0]);
+
+    // The partial first bucket since startup is never served
+    CHECK(Pyramid.CoveredFrom("ES", 7) == T0 + 128 * SECOND);
+    CHECK(Pyramid.CoveredFrom("ES", 0) == Bars[Bars.size() - LEVEL_BARS].Time);
+    CHECK(!Pyramid.Query("ES", T0, T0 + 1000 * SECOND, 5000, Out));
+    CHECK(!Pyramid.Query("NQ", T0 + 900 * SECOND, T0 + 1000 * SECOND, 5000, Out));
+    CHECK(Pyramid.GetStats().Misses == 2);
+}
+
+// The newest bucket of each level takes every bar until the next bucket starts
+static void TestFormingBucket()
+{
+    std::vector<s_Bar> All = MakeBars(5, 300);
+    std::vector<s_Bar> Bars(All.begin(), All.begin() + 270);
+    c_BarPyramid Pyramid = Build(Bars);
+    int64_t StartTime = T0 + 200 * SECOND;
+
+    bool AllMatch = true;
+    for (size_t b = 270; b < All.size(); b++)
+    {
+        Pyramid.Add("ES", All[b].Time, All[b].Values);
+        Bars.push_back(All[b]);
+        for (int Level = 3; Level < 6; Level++)
+        {
+            s_PyramidColumns Out;
+            int64_t EndTime = All[b].Time;
+            AllMatch &= Pyramid.Query("ES", StartTime, EndTime, (size_t)(100 >> (Level - 3)) / 2 + 2, Out);
+            AllMatch &= Same(Out, Aggregate(Bars, Out.Level, StartTime, EndTime));
+            AllMatch &= Out.Time.back() == PyramidBucket(EndTime, SECOND << Out.Level);
+        }
+    }
+    CHECK(AllMatch);
+
+    // A bar older than a level's newest bucket changes nothing there
+    s_PyramidColumns Before, After;
+    Pyramid.Query("ES", T0 + 256 * SECOND, T0 + 300 * SECOND, 3, Before);
+    s_Bar Late = All[100];
+    Late.Values[PYRAMID_VOLUME] = 1e6;
+    Pyramid.Add("ES", Late.Time, Late.Values);
+    Pyramid.Query("ES", T0 + 256 * SECOND, T0 + 300 * SECOND, 3, After);
+    CHECK(Same(After, Before));
+}
+
+static void TestBucketBeforeEpoch()
+{
+    CHECK(PyramidBucket(-1, SECOND) == -SECOND);
+    CHECK(PyramidBucket(-SECOND, 2 * SECOND) == -2 * SECOND);
+    CHECK(PyramidBucket(3 * SECOND, 2 * SECOND) == 2 * SECOND);
+}
+
+int main()
+{
+    TestRangesMatchAggregation();
+    TestPartialEdges();
+    TestFormingBucket();
+    TestBucketBeforeEpoch();
+    return TestResult("pyramid_test");
+}
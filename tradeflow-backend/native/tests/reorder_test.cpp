@@ -0,0 +1,146 @@
+// Reorder buffer: watermark release, replacement, late bars and the bounds
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/reorder_test.cpp -o reorder_test && ./reorder_test
+#include "reorder.h"
+#include "check.h"
+
+using namespace n_TradeFlow;
+
+typedef c_ReorderBuffer<std::string> c_Buffer;
+
+static s_ReorderConfig Config(int64_t Hold, size_t MaxBars, size_t MaxStreams)
+{
+    s_ReorderConfig Result;
+    Result.MaxHoldMicros = Hold;
+    Result.MaxBarsPerStream = MaxBars;
+    Result.MaxStreams = MaxStreams;
+    return Result;
+}
+
+static std::vector<s_ReleasedBar<std::string>> Drain(c_Buffer& Buffer)
+{
+    std::vector<s_ReleasedBar<std::string>> Released;
+    Buffer.Drain(Released);
+    return Released;
+}
+
+static std::vector<int64_t> Times(const std::vector<s_ReleasedBar<std::string>>& Released)
+{
+    std::vector<int64_t> Result;
+    for (const auto& Bar : Released)
+        Result.push_back(Bar.Time);
+    return Result;
+}
+
+// A bar within the lateness is released in order behind the newer bar
+static void TestOutOfOrderWithinLateness()
+{
+    c_Buffer Buffer(Config(1000, 100, 10));
+    CHECK(Buffer.Push("ES|1s", 10, "a", 2, 0) == REORDER_BUFFERED);
+    CHECK(Buffer.Push("ES|1s", 12, "c", 2, 0) == REORDER_BUFFERED);
+    CHECK(Times(Drain(Buffer)) == std::vector<int64_t>({ 10 }));    // Watermark 10
+    CHECK(Buffer.Push("ES|1s", 11, "b", 2, 0) == REORDER_BUFFERED);
+    CHECK(Buffer.Push("ES|1s", 14, "d", 2, 0) == REORDER_BUFFERED);
+
+    auto Released = Drain(Buffer);
+    CHECK(Times(Released) == std::vector<int64_t>({ 11, 12 }));
+    CHECK(Released.size() == 2 && Released[0].Payload == "b" && Released[0].Stream == "ES|1s");
+
+    s_ReorderStats Stats = Buffer.GetStats();
+    CHECK(Stats.Pushed == 4);
+    CHECK(Stats.Released == 3);
+    CHECK(Stats.Reordered == 1);
+    CHECK(Stats.Buffered == 1);
+}
+
+static void TestReplaceAndLate()
+{
+    c_Buffer Buffer(Config(1000, 100, 10));
+    Buffer.Push("ES|1s", 10, "old", 5, 0);
+    CHECK(Buffer.Push("ES|1s", 10, "new", 5, 0) == REORDER_REPLACED);
+    Buffer.Push("ES|1s", 20, "x", 5, 0);
+    auto Released = Drain(Buffer);
+    CHECK(Released.size() == 1 && Released[0].Payload == "new");
+
+    // At or before the released time the bar is handed back as late
+    CHECK(Buffer.Push("ES|1s", 10, "again", 5, 0) == REORDER_LATE);
+    CHECK(Buffer.Push("ES|1s", 3, "older", 5, 0) == REORDER_LATE);
+    CHECK(Drain(Buffer).empty());
+
+    s_ReorderStats Stats = Buffer.GetStats();
+    CHECK(Stats.Replaced == 1);
+    CHECK(Stats.Late == 2);
+    CHECK(Stats.Buffered == 1);
+}
+
+// Zero lateness releases every bar as soon as it is pushed
+static void TestZeroLateness()
+{
+    c_Buffer Buffer(Config(1000, 100, 10));
+    Buffer.Push("ES|1s", 1, "a", 0, 0);
+    Buffer.Push("ES|1s", 2, "b", 0, 0);
+    CHECK(Times(Drain(Buffer)) == std::vector<int64_t>({ 1, 2 }));
+    CHECK(Buffer.GetStats().Buffered == 0);
+}
+
+static void TestMaxBarsPerStream()
+{
+    c_Buffer Buffer(Config(1000, 3, 10));
+    for (int64_t t = 1; t <= 5; t++)
+        Buffer.Push("ES|1s", t, "", 100, 0);
+    CHECK(Times(Drain(Buffer)) == std::vector<int64_t>({ 1, 2 }));
+    CHECK(Buffer.GetStats().Forced == 2);
+    CHECK(Buffer.GetStats().Buffered == 3);
+}
+
+static void TestExpireAndFlush()
+{
+    c_Buffer Buffer(Config(1000, 100, 10));
+    Buffer.Push("ES|1s", 1, "", 100, 0);
+    Buffer.Push("ES|1s", 2, "", 100, 0);
+    Buffer.Push("NQ|1s", 1, "", 100, 600);
+
+    Buffer.Expire(999);
+    CHECK(Drain(Buffer).empty());
+    Buffer.Expire(1000);     // ES idle for the hold time, NQ not yet
+    auto Released = Drain(Buffer);
+    CHECK(Times(Released) == std::vector<int64_t>({ 1, 2 }));
+    CHECK(Released.size() == 2 && Released[1].Stream == "ES|1s");
+    CHECK(Buffer.GetStats().Expired == 2);
+
+    Buffer.Flush();
+    Released = Drain(Buffer);
+    CHECK(Released.size() == 1 && Released[0].Stream == "NQ|1s");
+    CHECK(Buffer.GetStats().Buffered == 0);
+}
+
+// Past MaxStreams the least recently pushed stream is released and forgotten
+static void TestMaxStreams()
+{
+    c_Buffer Buffer(Config(1000, 100, 2));
+    Buffer.Push("A", 5, "", 100, 0);
+    Buffer.Push("B", 5, "", 100, 0);
+    Buffer.Push("A", 6, "", 100, 0);
+    Buffer.Push("C", 5, "", 100, 0);   // Evicts B
+
+    auto Released = Drain(Buffer);
+    CHECK(Released.size() == 1 && Released[0].Stream == "B" && Released[0].Time == 5);
+    CHECK(Buffer.GetStats().Streams == 2);
+    CHECK(Buffer.GetStats().Forced == 1);
+
+    // B starts over, so its released time no longer makes this late
+    CHECK(Buffer.Push("B", 4, "", 100, 0) == REORDER_BUFFERED);
+    CHECK(Buffer.GetStats().Streams == 2);
+}
+
+int main()
+{
+    TestOutOfOrderWithinLateness();
+    TestReplaceAndLate();
+    TestZeroLateness();
+    TestMaxBarsPerStream();
+    TestExpireAndFlush();
+    TestMaxStreams();
+    return TestResult("reorder_test");
+}
@@ -0,0 +1,314 @@
+// Test stand-in for Sierra Chart's ACSIL header: the subset of types and
+// sc members the collector uses, with plain in-memory data, so the collector
+// source compiles on Linux and its JSON builders can be called from tests.
+// Nothing here talks to a chart; HTTP calls and log messages are recorded.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using std::max;
+using std::min;
+
+#define SCDLLName(Name)
+#define SCSFExport extern "C" void
+
+class SCString
+{
+public:
+    SCString() {}
+    SCString(const char* Text) : Text(Text ? Text : "") {}
+    SCString(const std::string& Text) : Text(Text) {}
+
+    SCString& Format(const char* Pattern, ...)
+    {
+        va_list Args;
+        va_start(Args, Pattern);
+        va_list Copy;
+        va_copy(Copy, Args);
+        int Length = vsnprintf(nullptr, 0, Pattern, Copy);
+        va_end(Copy);
+        Text.assign((size_t)std::max(Length, 0) + 1, '\0');
+        vsnprintf(&Text[0], Text.size(), Pattern, Args);
+        Text.resize((size_t)std::max(Length, 0));
+        va_end(Args);
+        return *this;
+    }
+
+    const char* GetChars() const { return Text.c_str(); }
+    int GetLength() const { return (int)Text.size(); }
+    void Clear() { Text.clear(); }
+    SCString Left(int Count) const { return Text.substr(0, (size_t)Count); }
+    char operator[](int Index) const { return Text[(size_t)Index]; }
+
+    SCString& operator+=(const SCString& Other) { Text += Other.Text; return *this; }
+    SCString& operator+=(const char* Other) { Text += Other; return *this; }
+    SCString operator+(const SCString& Other) const { return Text + Other.Text; }
+    SCString operator+(const char* Other) const { return Text + Other; }
+    bool operator==(const SCString& Other) const { return Text == Other.Text; }
+    bool operator!=(const SCString& Other) const { return Text != Other.Text; }
+    bool operator==(const char* Other) const { return Text == Other; }
+    bool operator!=(const char* Other) const { return Text != Other; }
+
+private:
+    std::string Text;
+};
+
+// Days since 1899-12-30, as a double
+class SCDateTime
+{
+public:
+    SCDateTime() {}
+    SCDateTime(double Days) : Days(Days) {}
+
+    static SCDateTime SECONDS(int Seconds) { return SCDateTime(Seconds / 86400.0); }
+    static SCDateTime MILLISECONDS(int Ms) { return SCDateTime(Ms / 86400000.0); }
+
+    double GetAsDouble() const { return Days; }
+    int GetDate() const { return (int)std::floor(Days); }
+    bool IsUnset() const { return Days == 0; }
+    void Clear() { Days = 0; }
+
+    SCDateTime operator+(const SCDateTime& Other) const { return SCDateTime(Days + Other.Days); }
+    SCDateTime operator-(const SCDateTime& Other) const { return SCDateTime(Days - Other.Days); }
+    SCDateTime& operator+=(const SCDateTime& Other) { Days += Other.Days; return *this; }
+    bool operator<(const SCDateTime& Other) const { return Days < Other.Days; }
+    bool operator<=(const SCDateTime& Other) const { return Days <= Other.Days; }
+    bool operator>(const SCDateTime& Other) const { return Days > Other.Days; }
+    bool operator>=(const SCDateTime& Other) const { return Days >= Other.Days; }
+    bool operator==(const SCDateTime& Other) const { return Days == Other.Days; }
+    bool operator!=(const SCDateTime& Other) const { return Days != Other.Days; }
+
+private:
+    double Days = 0;
+};
+
+template <typename t_Value>
+class c_SCArray
+{
+public:
+    std::vector<t_Value> Values;
+
+    int GetArraySize() const { return (int)Values.size(); }
+    t_Value& operator[](int Index)
+    {
+        static t_Value Empty;
+        return Index >= 0 && Index < (int)Values.size() ? Values[(size_t)Index] : (Empty = t_Value());
+    }
+    const t_Value& operator[](int Index) const { return const_cast<c_SCArray*>(this)->operator[](Index); }
+};
+
+typedef c_SCArray<float> SCFloatArray;
+typedef c_SCArray<SCDateTime> SCDateTimeArray;
+
+enum
+{
+    SC_OPEN = 0, SC_HIGH, SC_LOW, SC_LAST, SC_VOLUME, SC_NUM_TRADES, SC_OPEN_INTEREST,
+    SC_OHLC_AVG, SC_HLC_AVG, SC_HL_AVG, SC_BIDVOL, SC_ASKVOL, SC_BASE_DATA_COUNT
+};
+
+enum { SC_TS_MARKER = 0, SC_TS_BID, SC_TS_ASK, SC_TS_BIDASKVALUES };
+enum { SCALE_AUTO = 0, SCALE_INDEPENDENT };
+enum { VALUEFORMAT_INHERITED = 0 };
+enum { DRAWSTYLE_IGNORE = 0, DRAWSTYLE_LINE, DRAWSTYLE_HIDDEN };
+enum { BHCS_BAR_HAS_NOT_CLOSED = 0, BHCS_BAR_HAS_CLOSED };
+
+#define RGB(r, g, b) ((unsigned)(r) | ((unsigned)(g) << 8) | ((unsigned)(b) << 16))
+
+struct s_TimeAndSales
+{
+    SCDateTime DateTime;
+    float Price = 0;
+    unsigned Volume = 0;
+    float Bid = 0, Ask = 0;
+    unsigned BidSize = 0, AskSize = 0;
+    int Type = 0;
+    unsigned Sequence = 0;
+};
+
+class c_SCTimeAndSalesArray
+{
+public:
+    std::vector<s_TimeAndSales> Records;
+    int Size() const { return (int)Records.size(); }
+    const s_TimeAndSales& operator[](int Index) const { return Records[(size_t)Index]; }
+};
+
+struct s_MarketDepthEntry
+{
+    float Price = 0;
+    unsigned Quantity = 0;
+    unsigned NumOrders = 0;
+};
+
+struct s_VolumeAtPriceV2
+{
+    int PriceInTicks = 0;
+    unsigned Volume = 0;
+    unsigned BidVolume = 0;
+    unsigned AskVolume = 0;
+    unsigned NumberOfTrades = 0;
+};
+
+// Per-bar ladders, each sorted by price as Sierra Chart keeps them
+class c_VAPContainer
+{
+public:
+    std::vector<std::vector<s_VolumeAtPriceV2>> Bars;
+
+    int GetSizeAtBarIndex(int Index) const
+    {
+        return Index >= 0 && Index < (int)Bars.size() ? (int)Bars[(size_t)Index].size() : 0;
+    }
+    bool GetVAPElementAtIndex(int Index, int Element, s_VolumeAtPriceV2** Out)
+    {
+        if (Element < 0 || Element >= GetSizeAtBarIndex(Index))
+            return false;
+        *Out = &Bars[(size_t)Index][(size_t)Element];
+        return true;
+    }
+};
+
+class SCInput
+{
+public:
+    SCString Name;
+    SCString String;
+    int Int = 0;
+    float Float = 0;
+
+    const char* GetString() const { return String.GetChars(); }
+    void SetString(const char* Value) { String = Value; }
+    int GetInt() const { return Int; }
+    void SetInt(int Value) { Int = Value; }
+    void SetIntLimits(int, int) {}
+    float GetFloat() const { return Float; }
+    void SetFloat(float Value) { Float = Value; }
+    void SetFloatLimits(float, float) {}
+    int GetYesNo() const { return Int; }
+    void SetYesNo(int Value) { Int = Value; }
+    int GetIndex() const { return Int; }
+    void SetCustomInputIndex(int Value) { Int = Value; }
+    void SetCustomInputStrings(const char*) {}
+    void SetDescription(const char*) {}
+};
+typedef SCInput& SCInputRef;
+
+class SCSubgraph
+{
+public:
+    SCString Name;
+    int DrawStyle = 0;
+    unsigned PrimaryColor = 0;
+    int LineWidth = 1;
+    SCFloatArray Data;
+    float& operator[](int Index) { return Data[Index]; }
+};
+typedef SCSubgraph& SCSubgraphRef;
+
+namespace n_ACSIL
+{
+    struct s_HTTPHeader
+    {
+        SCString Name;
+        SCString Value;
+    };
+}
+
+struct s_sc
+{
+    // Chart data
+    SCFloatArray BaseDataIn[SC_BASE_DATA_COUNT];
+    SCDateTimeArray BaseDateTimeIn;
+    SCFloatArray NumberOfTrades;
+    int ArraySize = 0;
+    int Index = 0;
+    SCString Symbol;
+    int ChartNumber = 1;
+    int SecondsPerBar = 60;
+    float TickSize = 0.25f;
+    float RealTimePriceMultiplier = 1;
+    SCDateTime TimeScaleAdjustment;
+    SCDateTime CurrentSystemDateTime;
+    SCDateTime CurrentSystemDateTimeMS;
+    int StartTime1 = 0, EndTime1 = 86399, StartTime2 = 0, EndTime2 = 0;
+    int StartTime = 0, EndTime = 86399;
+    int UseSecondStartEndTimes = 0;
+    c_VAPContainer* VolumeAtPriceForBars = nullptr;
+    c_SCTimeAndSalesArray TimeAndSales;
+    std::vector<s_MarketDepthEntry> BidDepth, AskDepth;
+
+    // Study settings
+    SCInput Input[64];
+    SCSubgraph Subgraph[16];
+    SCString GraphName, StudyDescription;
+    int SetDefaults = 0, AutoLoop = 0, FreeDLL = 0, GraphRegion = 0, ScaleRangeType = 0, ValueFormat = 0;
+    int UsesMarketDepthData = 0, MaintainVolumeAtPriceData = 0;
+    int IsFullRecalculation = 0, LastCallToFunction = 0;
+
+    // HTTP
+    int HTTPRequestID = 0;
+    SCString HTTPResponse;
+    std::vector<SCString> Posted;
+    std::vector<std::vector<n_ACSIL::s_HTTPHeader>> PostedHeaders;
+    std::vector<SCString> Log;
+    void* Persistent[8] = {};
+
+    SCString FormatDateTime(const SCDateTime& DateTime) const
+    {
+        long long Ms = (long long)std::floor(DateTime.GetAsDouble() * 86400000.0 + 0.5);
+        long long Days = Ms / 86400000, MsOfDay = Ms % 86400000;
+        long long z = Days - 25569 + 719468;
+        long long Era = (z >= 0 ? z : z - 146096) / 146097;
+        long long DayOfEra = z - Era * 146097;
+        long long YearOfEra = (DayOfEra - DayOfEra / 1460 + DayOfEra / 36524 - DayOfEra / 146096) / 365;
+        long long DayOfYear = DayOfEra - (365 * YearOfEra + YearOfEra / 4 - YearOfEra / 100);
+        long long MonthPart = (5 * DayOfYear + 2) / 153;
+        int Day = (int)(DayOfYear - (153 * MonthPart + 2) / 5 + 1);
+        int Month = (int)(MonthPart < 10 ? MonthPart + 3 : MonthPart - 9);
+        int Year = (int)(YearOfEra + Era * 400 + (Month <= 2 ? 1 : 0));
+        return SCString().Format("%04d-%02d-%02d %02d:%02d:%02d", Year, Month, Day,
+            (int)(MsOfDay / 3600000), (int)(MsOfDay / 60000 % 60), (int)(MsOfDay / 1000 % 60));
+    }
+
+    int GetTradingDayDate(const SCDateTime& DateTime) const { return DateTime.GetDate(); }
+    int PriceValueToTicks(float Price) const { return (int)std::floor(Price / TickSize + 0.5); }
+    int GetBarHasClosedStatus(int BarIndex) const { return BarIndex < ArraySize - 1 ? BHCS_BAR_HAS_CLOSED : BHCS_BAR_HAS_NOT_CLOSED; }
+    int GetBarHasClosedStatus() const { return GetBarHasClosedStatus(Index); }
+
+    void AddMessageToLog(const SCString& Message, int) { Log.push_back(Message); }
+    void AddMessageToLog(const char* Message, int) { Log.push_back(Message); }
+    int MakeHTTPPOSTRequest(const SCString&, const SCString& Body, const n_ACSIL::s_HTTPHeader* Headers, int HeaderCount)
+    {
+        Posted.push_back(Body);
+        PostedHeaders.emplace_back(Headers, Headers + HeaderCount);
+        return 1;
+    }
+
+    void* GetPersistentPointer(int Key) { return Persistent[Key]; }
+    void SetPersistentPointer(int Key, void* Pointer) { Persistent[Key] = Pointer; }
+
+    void GetTimeAndSales(c_SCTimeAndSalesArray& Out) const { Out = TimeAndSales; }
+    int GetBidMarketDepthNumberOfLevels() const { return (int)BidDepth.size(); }
+    int GetAskMarketDepthNumberOfLevels() const { return (int)AskDepth.size(); }
+    int GetBidMarketDepthEntryAtLevel(s_MarketDepthEntry& Entry, int Level) const
+    {
+        if (Level < 0 || Level >= (int)BidDepth.size())
+            return 0;
+        Entry = BidDepth[(size_t)Level];
+        return 1;
+    }
+    int GetAskMarketDepthEntryAtLevel(s_MarketDepthEntry& Entry, int Level) const
+    {
+        if (Level < 0 || Level >= (int)AskDepth.size())
+            return 0;
+        Entry = AskDepth[(size_t)Level];
+        return 1;
+    }
+};
+typedef s_sc& SCStudyInterfaceRef;
@@ -0,0 +1,164 @@
+// Collector streaming calculations: delta, session CVD and VWAP resets,
+// EMAs, skipped bars, recomputed older bars carried forward, and disabled
+// calculations allocating nothing. Built against the sierrachart.h stand-in.
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative/tests -I. native/tests/streamingcalcs_test.cpp -o streamingcalcs_test && ./streamingcalcs_test
+#include "sierrachart.h"
+#include "TradeFlow_Pro_StreamingCalcs.h"
+#include "check.h"
+
+static const int BAR_COUNT = 30;
+
+// 1 minute bars from 2025-03-14 23:45: the trading day changes at bar 15
+static void FillChart(s_sc& sc)
+{
+    sc.ArraySize = BAR_COUNT;
+    for (int i = 0; i < BAR_COUNT; i++)
+    {
+        sc.BaseDateTimeIn.Values.push_back(SCDateTime(45730.0 + (23 * 3600 + 45 * 60 + i * 60) / 86400.0));
+        float Close = 5000.0f + (float)(i % 9) - (float)(i % 4) * 0.5f;
+        sc.BaseDataIn[SC_HIGH].Values.push_back(Close + 1.0f);
+        sc.BaseDataIn[SC_LOW].Values.push_back(Close - 1.5f);
+        sc.BaseDataIn[SC_LAST].Values.push_back(Close);
+        sc.BaseDataIn[SC_VOLUME].Values.push_back((float)(100 + i * 7));
+        sc.BaseDataIn[SC_BIDVOL].Values.push_back((float)(40 + i * 3));
+        sc.BaseDataIn[SC_ASKVOL].Values.push_back((float)(60 + (i % 5) * 9));
+    }
+}
+
+static s_StreamingCalcConfig AllCalcs()
+{
+    s_StreamingCalcConfig Config;
+    Config.Delta = true;
+    Config.CVD = true;
+    Config.VWAP = true;
+    Config.EMAPeriods[0] = 5;
+    Config.EMAPeriods[2] = 12;
+    return Config;
+}
+
+// Every bar from scratch, as a full recalculation would
+static void Recalculate(s_sc& sc, s_StreamingCalcs& Calcs)
+{
+    sc.IsFullRecalculation = 1;
+    for (int i = 0; i < sc.ArraySize; i++)
+        Calcs.Update(sc, i);
+    sc.IsFullRecalculation = 0;
+}
+
+static void CheckSame(const s_StreamingCalcs& Expected, const s_StreamingCalcs& Actual)
+{
+    CHECK(Actual.ComputedThrough == Expected.ComputedThrough);
+    for (int i = 0; i <= Expected.ComputedThrough && i <= Actual.ComputedThrough; i++)
+    {
+        CHECK_NEAR(Actual.Delta[i], Expected.Delta[i]);
+        CHECK_NEAR(Actual.CVD[i], Expected.CVD[i]);
+        CHECK_NEAR(Actual.VWAP(i), Expected.VWAP(i));
+        CHECK_NEAR(Actual.VWAPStdDev(i), Expected.VWAPStdDev(i));
+        CHECK_NEAR(Actual.EMA[0][i], Expected.EMA[0][i]);
+        CHECK_NEAR(Actual.EMA[2][i], Expected.EMA[2][i]);
+    }
+}
+
+static void TestValues()
+{
+    s_sc sc;
+    FillChart(sc);
+    s_StreamingCalcs Calcs;
+    Calcs.Configure(AllCalcs());
+    Recalculate(sc, Calcs);
+
+    CHECK(Calcs.ComputedThrough == BAR_COUNT - 1);
+    CHECK_NEAR(Calcs.Delta[3], (60 + 3 * 9) - (40 + 3 * 3));
+
+    // Session CVD and VWAP restart on the new trading day
+    CHECK_NEAR(Calcs.CVD[14], Calcs.CVD[13] + Calcs.Delta[14]);
+    CHECK_NEAR(Calcs.CVD[15], Calcs.Delta[15]);
+    double Typical = (sc.BaseDataIn[SC_HIGH][15] + sc.BaseDataIn[SC_LOW][15] + sc.BaseDataIn[SC_LAST][15]) / 3.0;
+    CHECK_NEAR(Calcs.VWAP(15), Typical);
+    CHECK_NEAR(Calcs.VWAPStdDev(15), 0.0);
+    CHECK(Calcs.VWAPStdDev(20) > 0);
+
+    // EMAs run across sessions from the first close
+    double Alpha = 2.0 / 6.0;
+    CHECK_NEAR(Calcs.EMA[0][0], sc.BaseDataIn[SC_LAST][0]);
+    CHECK_NEAR(Calcs.EMA[0][16], Calcs.EMA[0][15] + Alpha * (sc.BaseDataIn[SC_LAST][16] - Calcs.EMA[0][15]));
+    CHECK(Calcs.EMA[1].empty());
+}
+
+// A bar recomputed after later bars were computed carries into all of them
+static void TestRecomputedBarCarriesForward()
+{
+    s_sc sc;
+    FillChart(sc);
+    s_StreamingCalcs Calcs;
+    Calcs.Configure(AllCalcs());
+    Recalculate(sc, Calcs);
+    double OldCVD = Calcs.CVD[14];
+
+    sc.BaseDataIn[SC_ASKVOL][8] += 500;
+    sc.BaseDataIn[SC_LAST][8] += 6;
+    sc.BaseDataIn[SC_VOLUME][8] += 500;
+    Calcs.Update(sc, 8);
+    CHECK(Calcs.ComputedThrough == BAR_COUNT - 1);
+    CHECK_NEAR(Calcs.CVD[14], OldCVD + 500);
+
+    s_StreamingCalcs Fresh;
+    Fresh.Configure(AllCalcs());
+    Recalculate(sc, Fresh);
+    CheckSame(Fresh, Calcs);
+}
+
+// Bars between the last computed one and the requested one are filled in
+static void TestSkippedBars()
+{
+    s_sc sc;
+    FillChart(sc);
+    s_StreamingCalcs Calcs;
+    Calcs.Configure(AllCalcs());
+    Calcs.Update(sc, 3);
+    Calcs.Update(sc, BAR_COUNT - 1);
+
+    s_StreamingCalcs Fresh;
+    Fresh.Configure(AllCalcs());
+    Recalculate(sc, Fresh);
+    CheckSame(Fresh, Calcs);
+
+    // A shorter chart does not read past its end
+    sc.ArraySize = 10;
+    Calcs.Update(sc, 5);
+    CHECK(Calcs.ComputedThrough == 9);
+}
+
+static void TestDisabled()
+{
+    s_sc sc;
+    FillChart(sc);
+    s_StreamingCalcs Calcs;
+    Recalculate(sc, Calcs);
+    CHECK(Calcs.ComputedThrough == -1);
+    CHECK(!Calcs.HasValues(0));
+    CHECK(Calcs.Delta.empty() && Calcs.CVD.empty() && Calcs.SumVolume.empty());
+
+    // Only what is enabled is allocated
+    s_StreamingCalcConfig Config;
+    Config.CVD = true;
+    Calcs.Configure(Config);
+    Recalculate(sc, Calcs);
+    CHECK(Calcs.CVD.size() == (size_t)BAR_COUNT && Calcs.Delta.size() == (size_t)BAR_COUNT);
+    CHECK(Calcs.SumVolume.empty() && Calcs.EMA[0].empty());
+
+    SCString Json;
+    Calcs.AppendJSON(Json, 2);
+    CHECK(Json == SCString().Format("\"cvd\":%.0f,", Calcs.CVD[2]));
+}
+
+int main()
+{
+    TestValues();
+    TestRecomputedBarCarriesForward();
+    TestSkippedBars();
+    TestDisabled();
+    return TestResult("streamingcalcs_test");
+}
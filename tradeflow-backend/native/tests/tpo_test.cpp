@@ -0,0 +1,170 @@
+// TPO engine: letters and counts, POC, value area, initial balance, ladder
+// growth, changed-only flushes, session rollover and calendar sessions
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/tpo_test.cpp -o tpo_test && ./tpo_test
+#include "tpo.h"
+#include "check.h"
+
+using namespace n_TradeFlow;
+
+static const int64_t MINUTE = 60LL * 1000000;
+static const int64_t HOUR = 60 * MINUTE;
+static const int64_t DAY = 24 * HOUR;
+
+// Tick size 1, one letter per minute, two initial balance periods, 70% value area
+static c_TPOEngine Engine(int SessionSeconds = 86400)
+{
+    return c_TPOEngine(1.0, 60, 0, SessionSeconds, 2, 0.70);
+}
+
+static const s_TPOLevel* Level(const s_TPOSnapshot& Snapshot, int64_t Tick)
+{
+    for (const s_TPOLevel& Level : Snapshot.Levels)
+    {
+        if (Level.Tick == Tick)
+            return &Level;
+    }
+    return nullptr;
+}
+
+static void TestProfile()
+{
+    c_TPOEngine Tpo = Engine();
+    CHECK(Tpo.Add("ES", 0, 12, 10));            // A: 10-12
+    CHECK(Tpo.Add("ES", MINUTE, 13, 11));       // B: 11-13
+    CHECK(Tpo.Add("ES", 2 * MINUTE, 11, 11));   // C: 11
+
+    s_TPOSnapshot Profile;
+    CHECK(Tpo.Profile("ES", Profile));
+    CHECK(Profile.Periods == 3);
+    CHECK(Profile.TotalTPOs == 7);
+    CHECK(Profile.SinglePrints == 2);
+    CHECK(Profile.HighTick == 13 && Profile.LowTick == 10);
+    CHECK(Profile.POCTick == 11);
+    CHECK(Profile.IBComplete);
+    CHECK(Profile.IBHighTick == 13 && Profile.IBLowTick == 10);
+    // 5 of 7 TPOs: from the POC the pair above (3) beats the level below (1)
+    CHECK(Profile.ValueAreaHighTick == 13 && Profile.ValueAreaLowTick == 11);
+
+    CHECK(Profile.Levels.size() == 4 && Profile.Levels[0].Tick == 13 && Profile.Levels[3].Tick == 10);
+    const s_TPOLevel* Poc = Level(Profile, 11);
+    CHECK(Poc && Poc->Count == 3 && Poc->Letters == "ABC");
+    const s_TPOLevel* Top = Level(Profile, 13);
+    CHECK(Top && Top->Count == 1 && Top->Letters == "B");
+
+    // A second bar in the same period adds no TPO where the period already traded
+    CHECK(Tpo.Add("ES", 2 * MINUTE + 30 * 1000000, 12, 11));
+    CHECK(Tpo.Profile("ES", Profile));
+    CHECK(Profile.TotalTPOs == 8);
+    CHECK(Level(Profile, 12) && Level(Profile, 12)->Letters == "ABC");
+}
+
+static void TestChangedOnlyFlush()
+{
+    c_TPOEngine Tpo = Engine();
+    Tpo.Add("ES", 0, 12, 10);
+    Tpo.Add("ES", MINUTE, 13, 11);
+
+    std::vector<s_TPOSnapshot> Flushed;
+    Tpo.Flush(Flushed);
+    CHECK(Flushed.size() == 1 && Flushed[0].Levels.size() == 4 && !Flushed[0].Complete);
+
+    // Nothing new: nothing to flush
+    Flushed.clear();
+    Tpo.Add("ES", MINUTE, 12, 12);
+    Tpo.Flush(Flushed);
+    CHECK(Flushed.empty());
+
+    Tpo.Add("ES", 2 * MINUTE, 10, 10);
+    Tpo.Flush(Flushed);
+    CHECK(Flushed.size() == 1);
+    CHECK(Flushed.size() == 1 && Flushed[0].Levels.size() == 1);
+    CHECK(Flushed.size() == 1 && Flushed[0].Levels[0].Tick == 10 && Flushed[0].Levels[0].Letters == "AC");
+    CHECK(Flushed.size() == 1 && Flushed[0].TotalTPOs == 7);
+}
+
+static void TestSessionRollover()
+{
+    c_TPOEngine Tpo = Engine(8 * 3600);
+    Tpo.Add("ES", HOUR, 11, 10);
+    CHECK(!Tpo.Add("ES", 9 * HOUR, 11, 10));    // After the 8 hour session
+    CHECK(Tpo.Add("ES", DAY, 21, 20));
+
+    std::vector<s_TPOSnapshot> Flushed;
+    Tpo.Flush(Flushed);
+    CHECK(Flushed.size() == 2);
+    if (Flushed.size() == 2)
+    {
+        CHECK(Flushed[0].Complete && Flushed[0].SessionStart == 0 && Flushed[0].Levels.size() == 2);
+        CHECK(!Flushed[1].Complete && Flushed[1].SessionStart == DAY && Flushed[1].POCTick == 20);
+    }
+
+    // The earlier session is closed
+    CHECK(!Tpo.Add("ES", 2 * HOUR, 11, 10));
+    CHECK(Tpo.GetStats().Sessions == 2);
+    CHECK(Tpo.GetStats().RejectedBars == 2);
+}
+
+// Prices far apart grow the ladder at either end; a too-wide range or a bad print is refused
+static void TestLadderGrowth()
+{
+    c_TPOEngine Tpo = Engine();
+    CHECK(Tpo.Add("ES", 0, 1000, 1000));
+    CHECK(Tpo.Add("ES", MINUTE, 5, 3));
+    CHECK(Tpo.Add("ES", 2 * MINUTE, 3000, 2999));
+    CHECK(!Tpo.Add("ES", 3 * MINUTE, 90000, 10));
+    CHECK(!Tpo.Add("ES", 3 * MINUTE, NAN, 10));
+
+    s_TPOSnapshot Profile;
+    CHECK(Tpo.Profile("ES", Profile));
+    CHECK(Profile.TotalTPOs == 6);
+    CHECK(Profile.HighTick == 3000 && Profile.LowTick == 3);
+    CHECK(Level(Profile, 1000) && Level(Profile, 1000)->Letters == "A");
+    CHECK(Level(Profile, 4) && Level(Profile, 4)->Letters == "B");
+    CHECK(Level(Profile, 2999) && Level(Profile, 2999)->Letters == "C");
+    CHECK(Tpo.GetStats().Levels >= 2998);
+}
+
+// Periods past the alphabet share its last letter
+static void TestLastLetter()
+{
+    c_TPOEngine Tpo = Engine();
+    Tpo.Add("ES", 0, 10, 10);
+    Tpo.Add("ES", 100 * MINUTE, 10, 10);
+    s_TPOSnapshot Profile;
+    CHECK(Tpo.Profile("ES", Profile));
+    CHECK(Profile.Periods == TPO_MAX_PERIODS);
+    CHECK(Level(Profile, 10) && Level(Profile, 10)->Letters == "Az");
+}
+
+static void TestCalendarSessions()
+{
+    c_SessionCalendar Calendar;
+    CHECK(Calendar.Define("rth", { 5 * HOUR, DAY + 5 * HOUR }, { 10 * HOUR, DAY + 10 * HOUR }));
+    CHECK(Calendar.Assign("ES", "rth"));
+
+    c_TPOEngine Tpo = Engine();
+    Tpo.SetCalendar(&Calendar);
+    CHECK(!Tpo.Add("ES", 4 * HOUR, 10, 10));            // Before the first session
+    CHECK(!Tpo.Add("ES", 11 * HOUR, 10, 10));           // Between sessions
+    CHECK(Tpo.Add("ES", 5 * HOUR + MINUTE, 10, 10));
+    CHECK(Tpo.Add("NQ", 4 * HOUR, 10, 10));             // No calendar: the daily default
+
+    s_TPOSnapshot Profile;
+    CHECK(Tpo.Profile("ES", Profile));
+    CHECK(Profile.SessionStart == 5 * HOUR);
+    CHECK(Level(Profile, 10) && Level(Profile, 10)->Letters == "B");
+    CHECK(Tpo.Profile("NQ", Profile) && Profile.SessionStart == 0);
+}
+
+int main()
+{
+    TestProfile();
+    TestChangedOnlyFlush();
+    TestSessionRollover();
+    TestLadderGrowth();
+    TestLastLetter();
+    TestCalendarSessions();
+    return TestResult("tpo_test");
+}
@@ -0,0 +1,391 @@
+// io_uring sender and spool on loopback: POSTs over several keep-alive
+// connections answered in order and byte for byte (slot, oversized and gather
+// bodies, gather lists longer than one writev, partial socket writes), a
+// server that closes after a response, a refused connection, a short spool
+// append finished by a second write, and spool replay after a restart with a
+// torn last record. Skipped where io_uring is unavailable.
+//
+// Build and run (from tradeflow-backend/):
+//   c++ -O1 -g -std=c++17 -fsanitize=address,undefined -Inative native/tests/uring_test.cpp -o uring_test -lpthread && ./uring_test
+#include "uring.h"
+#include "check.h"
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <csignal>
+#include <mutex>
+#include <thread>
+
+#include <sys/resource.h>
+
+using namespace n_TradeFlow;
+
+static uint64_t Hash(const char* Data, size_t Length)
+{
+    uint64_t Value = 1469598103934665603ull;
+    for (size_t i = 0; i < Length; i++)
+        Value = (Value ^ (unsigned char)Data[i]) * 1099511628211ull;
+    return Value;
+}
+
+static std::string Answer(const std::string& Path, const std::string& Body)
+{
+    char Text[160];
+    snprintf(Text, sizeof(Text), "{\"status\":\"success\",\"path\":\"%s\",\"bytes\":%zu,\"hash\":\"%016llx\"}",
+        Path.c_str(), Body.size(), (unsigned long long)Hash(Body.data(), Body.size()));
+    return Text;
+}
+
+// Blocking HTTP/1.1 responder on 127.0.0.1, a thread per connection. Every
+// request is answered with its path, body length and body hash; requests to
+// ".../close" are answered with "Connection: close" and the socket is closed.
+// A small receive buffer and a pause before each body make large writes
+// from the sender come back short.
+class c_LoopbackServer
+{
+public:
+    int Port = 0;
+
+    c_LoopbackServer()
+    {
+        Listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int Small = 4096;
+        setsockopt(Listener, SOL_SOCKET, SO_RCVBUF, &Small, sizeof(Small));
+        sockaddr_in Address;
+        memset(&Address, 0, sizeof(Address));
+        Address.sin_family = AF_INET;
+        Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(Listener, (sockaddr*)&Address, sizeof(Address));
+        socklen_t Length = sizeof(Address);
+        getsockname(Listener, (sockaddr*)&Address, &Length);
+        Port = ntohs(Address.sin_port);
+        listen(Listener, 64);
+        Acceptor = std::thread([this]() { Accept(); });
+    }
+
+    ~c_LoopbackServer()
+    {
+        shutdown(Listener, SHUT_RDWR);
+        Acceptor.join();
+        close(Listener);
+        std::lock_guard<std::mutex> Lock(Mutex);
+        for (std::thread& Thread : Connections)
+            Thread.join();
+    }
+
+    int Accepted()
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        return (int)Connections.size();
+    }
+
+private:
+    int Listener = -1;
+    std::thread Acceptor;
+    std::mutex Mutex;
+    std::vector<std::thread> Connections;
+
+    void Accept()
+    {
+        for (;;)
+        {
+            int Client = accept4(Listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (Client < 0)
+                return;
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Connections.emplace_back([Client]() { Serve(Client); });
+        }
+    }
+
+    static void Serve(int Client)
+    {
+        std::string Buffer;
+        char Chunk[65536];
+        bool Open = true;
+        while (Open)
+        {
+            size_t End = Buffer.find("\r\n\r\n");
+            if (End == std::string::npos)
+            {
+                ssize_t Received = recv(Client, Chunk, sizeof(Chunk), 0);
+                if (Received <= 0)
+                    break;
+                Buffer.append(Chunk, (size_t)Received);
+                continue;
+            }
+
+            size_t Length = 0;
+            size_t Header = Buffer.find("Content-Length: ");
+            if (Header != std::string::npos && Header < End)
+                Length = (size_t)strtoull(Buffer.c_str() + Header + 16, nullptr, 10);
+            std::string Path = Buffer.substr(5, Buffer.find(' ', 5) - 5);
+            if (Buffer.size() < End + 4 + Length)
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            while (Buffer.size() < End + 4 + Length)
+            {
+                ssize_t Received = recv(Client, Chunk, sizeof(Chunk), 0);
+                if (Received <= 0)
+                {
+                    close(Client);
+                    return;
+                }
+                Buffer.append(Chunk, (size_t)Received);
+            }
+
+            std::string Body = Buffer.substr(End + 4, Length);
+            Buffer.erase(0, End + 4 + Length);
+            bool CloseAfter = Path.size() >= 6 && Path.compare(Path.size() - 6, 6, "/close") == 0;
+            std::string Content = Answer(Path, Body);
+            std::string Response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: "
+                + std::to_string(Content.size()) + (CloseAfter ? "\r\nConnection: close" : "") + "\r\n\r\n" + Content;
+            send(Client, Response.data(), Response.size(), MSG_NOSIGNAL);
+            Open = !CloseAfter;
+        }
+        close(Client);
+    }
+};
+
+static std::string MakeBody(size_t Bytes, char Seed)
+{
+    std::string Body(Bytes, ' ');
+    for (size_t i = 0; i < Bytes; i++)
+        Body[i] = (char)('a' + (i * 7 + (size_t)Seed) % 26);
+    return Body;
+}
+
+// Runs the loop until Done is true or ten seconds pass
+template <typename t_Done>
+static bool RunUntil(c_UringLoop& Loop, t_Done Done)
+{
+    std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!Done())
+    {
+        if (std::chrono::steady_clock::now() > Deadline || Loop.Run(1, 50000000) < 0)
+            return false;
+    }
+    return true;
+}
+
+struct s_Sent
+{
+    std::string Path;
+    std::string Body;
+    s_UringResponse Response;
+    bool Answered = false;
+    size_t Position = 0;    // Completion order across every connection
+};
+
+static void TestSender()
+{
+    c_UringLoop Loop;
+    CHECK(Loop.Open(256, 8, 65536));
+    c_LoopbackServer Server;
+    c_UringSender Sender(Loop, "http://127.0.0.1:" + std::to_string(Server.Port) + "/api/v1/market-data/", "key");
+    CHECK(Sender.IsValid() && Sender.GetBasePath() == "/api/v1/market-data");
+
+    // Four streams, each with five requests queued at once: two that fit a
+    // slot, one larger than a slot, one of 4 MB and one gather request of
+    // 3000 slices (three writev calls at least)
+    const int STREAMS = 4;
+    std::vector<std::vector<s_Sent>> Sent(STREAMS);
+    std::vector<std::string> SliceBodies(STREAMS);
+    std::vector<std::vector<s_UringSlice>> Slices(STREAMS);
+    size_t Answered = 0;
+    for (int s = 0; s < STREAMS; s++)
+    {
+        int Connection = Sender.AddConnection();
+        Sent[(size_t)s].resize(5);
+        size_t Sizes[4] = { 700, 40000, 200000, 4u << 20 };
+        for (int r = 0; r < 5; r++)
+        {
+            s_Sent& Request = Sent[(size_t)s][(size_t)r];
+            Request.Path = "/batch";
+            auto Done = [&Request, &Answered](const s_UringResponse& Response)
+            {
+                Request.Response = Response;
+                Request.Answered = true;
+                Request.Position = Answered++;
+            };
+            if (r < 4)
+            {
+                Request.Body = MakeBody(Sizes[r], (char)(s * 5 + r));
+                Sender.Post(Connection, Request.Path, Request.Body.data(), Request.Body.size(), Done, "X-TradeFlow-Seq: 1-1\r\n");
+                continue;
+            }
+            SliceBodies[(size_t)s] = MakeBody(3000 * 320, (char)s);
+            for (size_t b = 0; b < 3000; b++)
+                Slices[(size_t)s].push_back({ SliceBodies[(size_t)s].data() + b * 320, 320 });
+            Request.Body = SliceBodies[(size_t)s];
+            Sender.Post(Connection, Request.Path, Slices[(size_t)s].data(), Slices[(size_t)s].size(), Done);
+        }
+        CHECK(Sender.Pending(Connection) == 5);
+    }
+
+    CHECK(RunUntil(Loop, [&]() { return Answered == STREAMS * 5; }));
+    bool AllDelivered = true;
+    bool InOrder = true;
+    for (int s = 0; s < STREAMS; s++)
+    {
+        for (size_t r = 0; r < 5; r++)
+        {
+            const s_Sent& Request = Sent[(size_t)s][r];
+            AllDelivered &= Request.Answered && Request.Response.Status == 200 && Request.Response.Connection == s
+                && Request.Response.Body == Answer("/api/v1/market-data/batch", Request.Body);
+            InOrder &= r == 0 || Request.Position > Sent[(size_t)s][r - 1].Position;
+        }
+    }
+    CHECK(AllDelivered);
+    CHECK(InOrder);
+    CHECK(Sender.GetStats().Completed == STREAMS * 5 && Sender.GetStats().Failed == 0);
+    CHECK(Sender.GetStats().Connects == STREAMS && Server.Accepted() == STREAMS);
+
+    // Gather lists past IOV_MAX and the 4 MB bodies against a 4 KB receive
+    // window both take more than one write per request
+    CHECK(Loop.GetStats().GatherWrites >= STREAMS * 3);
+    CHECK(Loop.GetStats().FixedWrites + Loop.GetStats().PlainWrites > STREAMS * 4);
+
+    // A response with "Connection: close" ends the connection; the next
+    // request on it opens a new one
+    int Connection = Sender.AddConnection();
+    std::vector<s_UringResponse> Responses;
+    std::string Body = MakeBody(100, 'x');
+    for (const char* Path : { "/close", "/batch" })
+        Sender.Post(Connection, Path, Body.data(), Body.size(), [&Responses](const s_UringResponse& Response) { Responses.push_back(Response); });
+    CHECK(RunUntil(Loop, [&]() { return Responses.size() == 2; }));
+    CHECK(Responses[0].Status == 200 && Responses[0].Body == Answer("/api/v1/market-data/close", Body));
+    CHECK(Responses[1].Status == 200 && Responses[1].Body == Answer("/api/v1/market-data/batch", Body));
+    CHECK(Sender.GetStats().Connects == STREAMS + 2);
+}
+
+// Nothing listens: every queued request fails with the connect error
+static void TestRefused()
+{
+    c_UringLoop Loop;
+    CHECK(Loop.Open(64, 4, 4096));
+    int Port = 0;
+    {
+        c_LoopbackServer Closed;
+        Port = Closed.Port;
+    }
+    c_UringSender Sender(Loop, "http://127.0.0.1:" + std::to_string(Port));
+    int Connection = Sender.AddConnection();
+    std::vector<int> Status;
+    for (int r = 0; r < 2; r++)
+        Sender.Post(Connection, "/", "{}", 2, [&Status](const s_UringResponse& Response) { Status.push_back(Response.Status); });
+    CHECK(RunUntil(Loop, [&]() { return Status.size() == 2; }));
+    CHECK(Status[0] == -ECONNREFUSED && Status[1] == -ECONNREFUSED);
+    CHECK(Sender.GetStats().Failed == 2 && Sender.Pending(Connection) == 0);
+}
+
+static std::string Record(size_t Bytes, char Seed)
+{
+    return MakeBody(Bytes - 1, Seed) + "\n";
+}
+
+// An append cut short by the file size limit is finished by a second write
+// at the rest of its reserved range; after a restart the spool replays the
+// complete records past an acknowledged offset and drops a torn last one
+static void TestSpool()
+{
+    char Path[] = "/tmp/uring_test_XXXXXX";
+    int Temp = mkstemp(Path);
+    CHECK(Temp >= 0);
+    close(Temp);
+
+    std::vector<std::string> Records = { Record(50, 'a'), Record(120, 'b'), Record(300, 'c'), Record(80, 'd') };
+    uint64_t SecondOffset = 0;
+    {
+        c_UringLoop Loop;
+        CHECK(Loop.Open(64, 4, 4096));
+        c_UringSpool Spool(Loop);
+        CHECK(Spool.Open(Path) && Spool.Size() == 0);
+
+        std::vector<int> Results;
+        auto Done = [&Results](int Result) { Results.push_back(Result); };
+        CHECK(Spool.Append(Records[0].data(), Records[0].size(), Done) == 0);
+        SecondOffset = Spool.Append(Records[1].data(), Records[1].size(), Done);
+        CHECK(SecondOffset == 50);
+        CHECK(RunUntil(Loop, [&]() { return Results.size() == 2; }));
+        CHECK(Results[0] == 50 && Results[1] == 120);
+
+        // Only 100 more bytes fit under the limit: the first write is short,
+        // the rest goes out once the limit is lifted
+        signal(SIGXFSZ, SIG_IGN);
+        rlimit Limit;
+        getrlimit(RLIMIT_FSIZE, &Limit);
+        rlimit Tight = Limit;
+        Tight.rlim_cur = Spool.Size() + 100;
+        setrlimit(RLIMIT_FSIZE, &Tight);
+        size_t Writes = Loop.GetStats().FixedWrites + Loop.GetStats().PlainWrites;
+        Spool.Append(Records[2].data(), Records[2].size(), Done);
+        CHECK(RunUntil(Loop, [&]() { return Spool.GetStats().Bytes == 170 + 100; }));
+        CHECK(Results.size() == 2);
+        setrlimit(RLIMIT_FSIZE, &Limit);
+        CHECK(RunUntil(Loop, [&]() { return Results.size() == 3; }));
+        CHECK(Results[2] == 300);
+        CHECK(Loop.GetStats().FixedWrites + Loop.GetStats().PlainWrites == Writes + 2);
+        CHECK(Spool.GetStats().Errors == 0);
+
+        // A crash in the middle of the next append leaves a torn record
+        std::string Torn = "{\"partial";
+        Spool.Append(Torn.data(), Torn.size(), Done);
+        Spool.Sync(Done);
+        CHECK(RunUntil(Loop, [&]() { return Results.size() == 5; }));
+        CHECK(Results[4] == 0 && Spool.GetStats().Syncs == 1);
+    }
+
+    // Restart: replay past the first record, which the backend acknowledged
+    std::vector<std::pair<uint64_t, std::string>> Replayed;
+    int64_t End = c_UringSpool::Replay(Path, SecondOffset, [&Replayed](uint64_t Offset, const char* Data, size_t Length)
+    {
+        Replayed.emplace_back(Offset, std::string(Data, Length));
+    });
+    CHECK(End == 50 + 120 + 300);
+    CHECK(Replayed.size() == 2);
+    CHECK(Replayed[0].first == 50 && Replayed[0].second + "\n" == Records[1]);
+    CHECK(Replayed[1].first == 170 && Replayed[1].second + "\n" == Records[2]);
+
+    // Reopening at the replayed end cuts the torn record off before new appends
+    {
+        c_UringLoop Loop;
+        CHECK(Loop.Open(64, 4, 4096));
+        c_UringSpool Spool(Loop);
+        CHECK(Spool.Open(Path, End) && Spool.Size() == (uint64_t)End);
+        int Result = 0;
+        CHECK(Spool.Append(Records[3].data(), Records[3].size(), [&Result](int Written) { Result = Written; }) == (uint64_t)End);
+        CHECK(RunUntil(Loop, [&]() { return Result != 0; }));
+        CHECK(Result == 80);
+    }
+
+    std::vector<std::string> All;
+    End = c_UringSpool::Replay(Path, 0, [&All](uint64_t, const char* Data, size_t Length) { All.emplace_back(std::string(Data, Length) + "\n"); });
+    CHECK(End == 50 + 120 + 300 + 80);
+    CHECK(All == Records);
+    CHECK(c_UringSpool::Replay("/tmp/uring_test_missing.spool", 0, [](uint64_t, const char*, size_t) {}) == 0);
+    unlink(Path);
+}
+
+int main()
+{
+    c_UringLoop Probe;
+    if (!Probe.Open(8, 0, 0))
+    {
+        printf("uring_test: io_uring unavailable, skipped\n");
+        return 0;
+    }
+    TestSender();
+    TestRefused();
+    TestSpool();
+    return TestResult("uring_test");
+}
+
+#else
+
+int main()
+{
+    printf("uring_test: Linux only, skipped\n");
+    return 0;
+}
+
+#endif
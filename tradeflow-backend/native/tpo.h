@@ -0,0 +1,456 @@
+// TradeFlow Pro native TPO (market profile) engine
+// Letter-period profiles built as bars arrive. Each session keeps one bitset
+// per period over a shared tick ladder (bit set = the period traded at that
+// price) and a TPO count per level. A bar sets the bits of its range a word at
+// a time and only newly set bits touch the counts, so a bar costs O(range in
+// ticks / 64) plus the TPOs it adds, never a rescan of the session. The POC,
+// initial balance and single-print count are kept current on the way; the
+// value area is walked out from the POC when a snapshot is taken. Flushes
+// carry only the levels changed since the previous flush.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "calendar.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace n_TradeFlow
+{
+    const int TPO_MAX_PERIODS = 52;             // A-Z then a-z; later periods share the last letter
+    const int64_t TPO_MAX_LEVELS = 1 << 16;     // Ladder span guard against bad prints
+    const char TPO_LETTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+    inline int LowestBit(uint64_t Word)
+    {
+#if defined(_MSC_VER)
+        unsigned long Index;
+        _BitScanForward64(&Index, Word);
+        return (int)Index;
+#else
+        return __builtin_ctzll(Word);
+#endif
+    }
+
+    struct s_TPOLevel
+    {
+        int64_t Tick = 0;
+        uint32_t Count = 0;
+        std::string Letters;    // Periods that traded here, in order
+    };
+
+    struct s_TPOSnapshot
+    {
+        std::string Symbol;
+        int64_t SessionStart = 0;   // Epoch microseconds
+        int64_t LastTime = 0;       // Newest bar added
+        bool Complete = false;      // A later session has started; no further changes
+        int Periods = 0;
+        uint32_t TotalTPOs = 0;
+        uint32_t SinglePrints = 0;  // Levels with exactly one TPO
+        int64_t HighTick = 0;
+        int64_t LowTick = 0;
+        int64_t POCTick = 0;
+        int64_t ValueAreaHighTick = 0;
+        int64_t ValueAreaLowTick = 0;
+        bool IBComplete = false;    // All initial balance periods have started
+        int64_t IBHighTick = 0;
+        int64_t IBLowTick = 0;
+        std::vector<s_TPOLevel> Levels;   // Highest price first
+    };
+
+    struct s_TPOStats
+    {
+        size_t Symbols = 0;
+        size_t Levels = 0;          // Ladder levels allocated across live sessions
+        size_t Sessions = 0;        // Sessions started since startup
+        size_t RejectedBars = 0;    // Older session, outside session hours or too wide
+    };
+
+    // One symbol's session. Level i of the ladder is tick BaseTick + i; BaseTick
+    // is a multiple of 64 so every period's bitset shares the word layout.
+    class c_TPOProfile
+    {
+    public:
+        c_TPOProfile(int64_t SessionStart, int64_t PeriodMicros, int IBPeriods)
+            : SessionStart(SessionStart)
+            , PeriodMicros(PeriodMicros)
+            , IBPeriods(IBPeriods)
+        {
+        }
+
+        int64_t GetSessionStart() const { return SessionStart; }
+        size_t LevelCount() const { return Counts.size(); }
+        bool HasChanges() const { return Changed; }
+
+        bool Add(int64_t Time, int64_t LowTick, int64_t HighTick)
+        {
+            if (HighTick < LowTick)
+                std::swap(LowTick, HighTick);
+            int64_t Period = (Time - SessionStart) / PeriodMicros;
+            if (Period < 0 || !Reserve(LowTick, HighTick))
+                return false;
+            if (Period >= TPO_MAX_PERIODS)
+                Period = TPO_MAX_PERIODS - 1;
+
+            if ((size_t)Period >= Bits.size())
+                Bits.resize((size_t)Period + 1, std::vector<uint64_t>(Words, 0));
+            LastTime = std::max(LastTime, Time);
+
+            if (Total == 0)
+            {
+                High = HighTick;
+                Low = LowTick;
+            }
+            else
+            {
+                High = std::max(High, HighTick);
+                Low = std::min(Low, LowTick);
+            }
+            if (Period < IBPeriods)
+            {
+                IBHigh = HasIB ? std::max(IBHigh, HighTick) : HighTick;
+                IBLow = HasIB ? std::min(IBLow, LowTick) : LowTick;
+                HasIB = true;
+            }
+
+            std::vector<uint64_t>& Row = Bits[(size_t)Period];
+            size_t First = (size_t)(LowTick - BaseTick);
+            size_t Last = (size_t)(HighTick - BaseTick);
+            for (size_t w = First >> 6; w <= Last >> 6; w++)
+            {
+                uint64_t Mask = ~0ULL;
+                if (w == First >> 6)
+                    Mask &= ~0ULL << (First & 63);
+                if (w == Last >> 6)
+                    Mask &= ~0ULL >> (63 - (Last & 63));
+
+                uint64_t New = Mask & ~Row[w];
+                if (New == 0)
+                    continue;
+                Row[w] |= New;
+                Dirty[w] |= New;
+                Changed = true;
+                for (; New != 0; New &= New - 1)
+                    Count(w * 64 + (size_t)LowestBit(New));
+            }
+            return true;
+        }
+
+        // Full profile, or only the levels changed since ClearChanges()
+        void Snapshot(double ValueArea, bool ChangedOnly, s_TPOSnapshot& Out) const
+        {
+            Out.SessionStart = SessionStart;
+            Out.LastTime = LastTime;
+            Out.Periods = (int)Bits.size();
+            Out.TotalTPOs = Total;
+            Out.SinglePrints = Singles;
+            Out.HighTick = High;
+            Out.LowTick = Low;
+            Out.POCTick = POCTick;
+            Out.IBComplete = HasIB && (int)Bits.size() > IBPeriods;
+            Out.IBHighTick = IBHigh;
+            Out.IBLowTick = IBLow;
+            FindValueArea(ValueArea, Out.ValueAreaHighTick, Out.ValueAreaLowTick);
+
+            Out.Levels.clear();
+            if (Total == 0)
+                return;
+            for (size_t i = (size_t)(High - BaseTick) + 1; i-- > (size_t)(Low - BaseTick); )
+            {
+                uint64_t Bit = 1ULL << (i & 63);
+                if (Counts[i] == 0 || (ChangedOnly && (Dirty[i >> 6] & Bit) == 0))
+                    continue;
+                s_TPOLevel Level;
+                Level.Tick = BaseTick + (int64_t)i;
+                Level.Count = Counts[i];
+                for (size_t p = 0; p < Bits.size(); p++)
+                {
+                    if (Bits[p][i >> 6] & Bit)
+                        Level.Letters.push_back(TPO_LETTERS[p]);
+                }
+                Out.Levels.push_back(std::move(Level));
+            }
+        }
+
+        void ClearChanges()
+        {
+            std::fill(Dirty.begin(), Dirty.end(), 0);
+            Changed = false;
+        }
+
+    private:
+        int64_t SessionStart;
+        int64_t PeriodMicros;
+        int IBPeriods;
+
+        int64_t BaseTick = 0;
+        size_t Words = 0;
+        std::vector<std::vector<uint64_t>> Bits;   // [period][word]
+        std::vector<uint64_t> Dirty;               // Levels changed since the last flush
+        std::vector<uint32_t> Counts;              // TPOs per level
+        bool Changed = false;
+
+        int64_t LastTime = 0;
+        int64_t High = 0;
+        int64_t Low = 0;
+        uint32_t Total = 0;
+        uint32_t Singles = 0;
+        int64_t POCTick = 0;
+        uint32_t POCCount = 0;
+        bool HasIB = false;
+        int64_t IBHigh = 0;
+        int64_t IBLow = 0;
+
+        void Count(size_t Index)
+        {
+            uint32_t Value = ++Counts[Index];
+            Total++;
+            if (Value == 1)
+                Singles++;
+            else if (Value == 2)
+                Singles--;
+            // Ties keep the level that reached the count first
+            if (Value > POCCount)
+            {
+                POCCount = Value;
+                POCTick = BaseTick + (int64_t)Index;
+            }
+        }
+
+        // Grows the ladder to cover [LowTick, HighTick] in whole words, with
+        // slack on the growing side so a trending session reallocates rarely
+        bool Reserve(int64_t LowTick, int64_t HighTick)
+        {
+            int64_t End = BaseTick + (int64_t)Words * 64;
+            if (Words > 0 && LowTick >= BaseTick && HighTick < End)
+                return true;
+
+            int64_t Slack = Words > 0 ? std::max<int64_t>(1, (int64_t)Words / 2) * 64 : 0;
+            int64_t LowWord = LowTick & ~(int64_t)63;
+            int64_t HighWordEnd = (HighTick & ~(int64_t)63) + 64;
+            int64_t NewBase = Words > 0 ? std::min(BaseTick, LowWord) : LowWord;
+            int64_t NewEnd = Words > 0 ? std::max(End, HighWordEnd) : HighWordEnd;
+            if (NewEnd - NewBase > TPO_MAX_LEVELS)
+                return false;
+            // Slack is dropped rather than refusing a legitimately wide session
+            if (LowWord < BaseTick && NewEnd - (NewBase - Slack) <= TPO_MAX_LEVELS)
+                NewBase -= Slack;
+            if (HighWordEnd > End && NewEnd + Slack - NewBase <= TPO_MAX_LEVELS)
+                NewEnd += Slack;
+
+            size_t Front = Words > 0 ? (size_t)((BaseTick - NewBase) / 64) : 0;
+            size_t NewWords = (size_t)((NewEnd - NewBase) / 64);
+            for (std::vector<uint64_t>& Row : Bits)
+            {
+                Row.insert(Row.begin(), Front, 0);
+                Row.resize(NewWords, 0);
+            }
+            Dirty.insert(Dirty.begin(), Front, 0);
+            Dirty.resize(NewWords, 0);
+            Counts.insert(Counts.begin(), Front * 64, 0);
+            Counts.resize(NewWords * 64, 0);
+            BaseTick = NewBase;
+            Words = NewWords;
+            return true;
+        }
+
+        // Two-row rule: from the POC, repeatedly add whichever pair of levels
+        // (above or below) holds more TPOs until ValueArea of the total is in
+        void FindValueArea(double ValueArea, int64_t& AreaHigh, int64_t& AreaLow) const
+        {
+            AreaHigh = AreaLow = POCTick;
+            if (Total == 0)
+                return;
+
+            uint64_t Target = (uint64_t)std::ceil(ValueArea * Total);
+            size_t Top = (size_t)(High - BaseTick);
+            size_t Bottom = (size_t)(Low - BaseTick);
+            size_t Up = (size_t)(POCTick - BaseTick);
+            size_t Down = Up;
+            uint64_t Sum = Counts[Up];
+            while (Sum < Target && (Up < Top || Down > Bottom))
+            {
+                uint64_t Above = 0, Below = 0;
+                for (size_t k = 1; k <= 2 && Up + k <= Top; k++)
+                    Above += Counts[Up + k];
+                for (size_t k = 1; k <= 2 && Down >= Bottom + k; k++)
+                    Below += Counts[Down - k];
+
+                if (Up < Top && (Down == Bottom || Above >= Below))
+                {
+                    size_t Step = std::min<size_t>(2, Top - Up);
+                    Up += Step;
+                    Sum += Above;
+                }
+                else
+                {
+                    size_t Step = std::min<size_t>(2, Down - Bottom);
+                    Down -= Step;
+                    Sum += Below;
+                }
+            }
+            AreaHigh = BaseTick + (int64_t)Up;
+            AreaLow = BaseTick + (int64_t)Down;
+        }
+    };
+
+    // Sessions start every 24 hours at SessionOffsetSeconds past midnight UTC
+    // and last SessionSeconds, or come from a shared session calendar when one
+    // is set; bars outside session hours are ignored.
+    class c_TPOEngine
+    {
+    public:
+        c_TPOEngine(double TickSize, int PeriodSeconds, int SessionOffsetSeconds, int SessionSeconds, int IBPeriods, double ValueArea)
+            : TickSize(TickSize > 0 ? TickSize : 0.01)
+            , TicksPerUnit(1.0 / this->TickSize)
+            , PeriodMicros((int64_t)std::max(PeriodSeconds, 1) * 1000000)
+            , OffsetMicros((int64_t)SessionOffsetSeconds * 1000000)
+            , SessionMicros((int64_t)std::min(std::max(SessionSeconds, 1), 86400) * 1000000)
+            , IBPeriods(std::max(IBPeriods, 1))
+            , ValueArea(std::min(std::max(ValueArea, 0.0), 1.0))
+        {
+        }
+
+        int64_t ToTick(double Price) const { return (int64_t)llround(Price * TicksPerUnit); }
+        double ToPrice(int64_t Tick) const { return (double)Tick / TicksPerUnit; }
+
+        // Per-symbol sessions from Calendar (owned by the caller, which keeps
+        // it alive); null returns to the daily sessions
+        void SetCalendar(c_SessionCalendar* NewCalendar) { Calendar = NewCalendar; }
+
+        int64_t SessionStartOf(int64_t Time) const
+        {
+            const int64_t Day = 86400LL * 1000000;
+            int64_t Shifted = Time - OffsetMicros;
+            int64_t Days = Shifted / Day - (Shifted % Day < 0 ? 1 : 0);
+            return Days * Day + OffsetMicros;
+        }
+
+        // Adds a bar's range to the period it starts in. A bar from a later
+        // session closes the current one (queued for the next Flush).
+        bool Add(const std::string& Symbol, int64_t Time, double High, double Low)
+        {
+            if (!std::isfinite(High) || !std::isfinite(Low))
+                return Reject();
+
+            int64_t SessionStart;
+            if (Calendar)
+            {
+                s_SessionPosition Position;
+                if (!Calendar->Locate(Symbol, Time, 0, Position) || !Position.InSession)
+                    return Reject();
+                SessionStart = Position.Start;
+            }
+            else
+            {
+                SessionStart = SessionStartOf(Time);
+                if (Time - SessionStart >= SessionMicros)
+                    return Reject();
+            }
+
+            s_SymbolState& State = Symbols[Symbol];
+            if (State.Current && SessionStart < State.Current->GetSessionStart())
+                return Reject();
+            if (State.Current && SessionStart > State.Current->GetSessionStart())
+            {
+                s_TPOSnapshot Final;
+                Final.Symbol = Symbol;
+                State.Current->Snapshot(ValueArea, true, Final);
+                Final.Complete = true;
+                State.Ended.push_back(std::move(Final));
+                State.Current.reset();
+            }
+            if (!State.Current)
+            {
+                State.Current.reset(new c_TPOProfile(SessionStart, PeriodMicros, IBPeriods));
+                Sessions++;
+            }
+
+            if (!State.Current->Add(Time, ToTick(Low), ToTick(High)))
+                return Reject();
+            return true;
+        }
+
+        // Ended sessions plus every live session with changes, each carrying
+        // only the levels changed since the previous flush
+        void Flush(std::vector<s_TPOSnapshot>& Out)
+        {
+            for (auto& Entry : Symbols)
+            {
+                s_SymbolState& State = Entry.second;
+                for (s_TPOSnapshot& Ended : State.Ended)
+                    Out.push_back(std::move(Ended));
+                State.Ended.clear();
+
+                if (State.Current && State.Current->HasChanges())
+                {
+                    s_TPOSnapshot Snapshot;
+                    Snapshot.Symbol = Entry.first;
+                    State.Current->Snapshot(ValueArea, true, Snapshot);
+                    State.Current->ClearChanges();
+                    Out.push_back(std::move(Snapshot));
+                }
+            }
+        }
+
+        // Full profile of the symbol's live session
+        bool Profile(const std::string& Symbol, s_TPOSnapshot& Out) const
+        {
+            auto Found = Symbols.find(Symbol);
+            if (Found == Symbols.end() || !Found->second.Current)
+                return false;
+            Out.Symbol = Symbol;
+            Found->second.Current->Snapshot(ValueArea, false, Out);
+            return true;
+        }
+
+        s_TPOStats GetStats() const
+        {
+            s_TPOStats Stats;
+            Stats.Symbols = Symbols.size();
+            Stats.Sessions = Sessions;
+            Stats.RejectedBars = RejectedBars;
+            for (const auto& Entry : Symbols)
+            {
+                if (Entry.second.Current)
+                    Stats.Levels += Entry.second.Current->LevelCount();
+            }
+            return Stats;
+        }
+
+    private:
+        struct s_SymbolState
+        {
+            std::unique_ptr<c_TPOProfile> Current;
+            std::vector<s_TPOSnapshot> Ended;
+        };
+
+        double TickSize;
+        double TicksPerUnit;
+        int64_t PeriodMicros;
+        int64_t OffsetMicros;
+        int64_t SessionMicros;
+        int IBPeriods;
+        double ValueArea;
+        c_SessionCalendar* Calendar = nullptr;
+        std::unordered_map<std::string, s_SymbolState> Symbols;
+        size_t Sessions = 0;
+        size_t RejectedBars = 0;
+
+        bool Reject()
+        {
+            RejectedBars++;
+            return false;
+        }
+    };
+}
@@ -0,0 +1,1063 @@
+// TradeFlow Pro native io_uring sender and spool (Linux only)
+// A stand-in for sc.MakeHTTPPOSTRequest when the collector logic runs as a
+// native Linux process: HTTP/1.1 keep-alive POSTs over many connections plus an
+// append-only disk spool, all driven from one thread through one io_uring.
+// Socket writes, receives and spool appends queued between two Run calls go to
+// the kernel in a single io_uring_enter, and request bytes are staged in a pool
+// of registered buffers so writes skip the per-call page pinning (WRITE_FIXED).
+//
+// Completions are delivered through per-request callbacks, which is all a C++20
+// coroutine awaiter needs (store the handle, resume it from the callback); the
+// header itself stays C++17. Uses the raw io_uring syscalls, no liburing.
+#pragma once
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace n_TradeFlow
+{
+    const size_t URING_RECV_BYTES = 16384;
+    const int URING_TAG_BITS = 48;   // user_data = handler id << 48 | handler tag
+    const size_t URING_MAX_VECTORS = 1024;  // IOV_MAX: longer gather lists go out in several writes
+
+    // A piece of a request body referenced in place (same layout as iovec)
+    struct s_UringSlice
+    {
+        const void* Data;
+        size_t Length;
+    };
+
+    struct s_UringStats
+    {
+        size_t Submits = 0;         // io_uring_enter calls
+        size_t Submitted = 0;       // SQEs handed to the kernel
+        size_t Completions = 0;
+        size_t FixedWrites = 0;     // Writes from a registered buffer slot
+        size_t PlainWrites = 0;     // Too large for a slot, no slot free, or registration unavailable
+        size_t GatherWrites = 0;    // Vectored writes of slices referenced in place
+    };
+
+    // One ring plus a pool of registered buffer slots shared by every sender
+    // and spool attached to it. Not thread-safe: one thread owns the loop.
+    class c_UringLoop
+    {
+    public:
+        typedef std::function<void(uint64_t Tag, int32_t Result)> t_Handler;
+
+        c_UringLoop() {}
+        c_UringLoop(const c_UringLoop&) = delete;
+        c_UringLoop& operator=(const c_UringLoop&) = delete;
+
+        ~c_UringLoop()
+        {
+            if (RingFd < 0)
+                return;
+            if (BuffersRegistered)
+                syscall(__NR_io_uring_register, RingFd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+            munmap(Sqes, SqeBytes);
+            if (CqRing != SqRing)
+                munmap(CqRing, CqBytes);
+            munmap(SqRing, SqBytes);
+            close(RingFd);
+        }
+
+        // Entries bounds the SQEs queued between two Run calls; Slots x SlotBytes
+        // is the registered staging memory. Returns false when io_uring is not
+        // available (old kernel, seccomp, io_uring_disabled).
+        bool Open(unsigned Entries = 1024, size_t Slots = 256, size_t SlotBytes = 65536)
+        {
+            io_uring_params Params;
+            memset(&Params, 0, sizeof(Params));
+            Params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+            Params.cq_entries = Entries * 4;
+            RingFd = (int)syscall(__NR_io_uring_setup, Entries, &Params);
+            if (RingFd < 0 && errno == EINVAL)
+            {
+                // Kernels before 6.1 lack DEFER_TASKRUN
+                memset(&Params, 0, sizeof(Params));
+                Params.flags = IORING_SETUP_CQSIZE;
+                Params.cq_entries = Entries * 4;
+                RingFd = (int)syscall(__NR_io_uring_setup, Entries, &Params);
+            }
+            if (RingFd < 0)
+                return false;
+
+            SqBytes = Params.sq_off.array + Params.sq_entries * sizeof(unsigned);
+            CqBytes = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+            bool SingleMmap = (Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (SingleMmap)
+                SqBytes = CqBytes = std::max(SqBytes, CqBytes);
+
+            SqRing = mmap(nullptr, SqBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_SQ_RING);
+            if (SqRing == MAP_FAILED)
+                return Fail();
+            CqRing = SingleMmap ? SqRing
+                : mmap(nullptr, CqBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_CQ_RING);
+            if (CqRing == MAP_FAILED)
+                return Fail();
+            SqeBytes = Params.sq_entries * sizeof(io_uring_sqe);
+            Sqes = (io_uring_sqe*)mmap(nullptr, SqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_SQES);
+            if (Sqes == MAP_FAILED)
+                return Fail();
+
+            char* Sq = (char*)SqRing;
+            SqHead = (unsigned*)(Sq + Params.sq_off.head);
+            SqTail = (unsigned*)(Sq + Params.sq_off.tail);
+            SqMask = *(unsigned*)(Sq + Params.sq_off.ring_mask);
+            SqArray = (unsigned*)(Sq + Params.sq_off.array);
+            SqEntries = Params.sq_entries;
+            char* Cq = (char*)CqRing;
+            CqHead = (unsigned*)(Cq + Params.cq_off.head);
+            CqTail = (unsigned*)(Cq + Params.cq_off.tail);
+            CqMask = *(unsigned*)(Cq + Params.cq_off.ring_mask);
+            Cqes = (io_uring_cqe*)(Cq + Params.cq_off.cqes);
+            LocalTail = *SqTail;
+            ExtArg = (Params.features & IORING_FEAT_EXT_ARG) != 0;
+
+            // Registration pins the slots once; without it (RLIMIT_MEMLOCK)
+            // the slots are still used, just with plain writes
+            this->SlotBytes = SlotBytes;
+            Staging.reset(new char[Slots * SlotBytes]);
+            std::vector<iovec> Vectors(Slots);
+            for (size_t s = 0; s < Slots; s++)
+            {
+                Vectors[s].iov_base = Staging.get() + s * SlotBytes;
+                Vectors[s].iov_len = SlotBytes;
+                FreeSlots.push_back((int)(Slots - 1 - s));
+            }
+            BuffersRegistered = Slots > 0 &&
+                syscall(__NR_io_uring_register, RingFd, IORING_REGISTER_BUFFERS, Vectors.data(), (unsigned)Slots) == 0;
+            return true;
+        }
+
+        bool IsOpen() const { return RingFd >= 0; }
+        bool HasRegisteredBuffers() const { return BuffersRegistered; }
+        size_t GetSlotBytes() const { return SlotBytes; }
+        const s_UringStats& GetStats() const { return Stats; }
+
+        int AddHandler(t_Handler Handler)
+        {
+            Handlers.push_back(std::move(Handler));
+            return (int)Handlers.size() - 1;
+        }
+
+        // Staging slot of SlotBytes, or -1 when all are in use
+        int AcquireSlot()
+        {
+            if (FreeSlots.empty())
+                return -1;
+            int Slot = FreeSlots.back();
+            FreeSlots.pop_back();
+            return Slot;
+        }
+
+        void ReleaseSlot(int Slot)
+        {
+            if (Slot >= 0)
+                FreeSlots.push_back(Slot);
+        }
+
+        char* SlotData(int Slot) { return Staging.get() + (size_t)Slot * SlotBytes; }
+
+        // Writes Length bytes at Data (inside Slot when Slot >= 0) to Fd at Offset
+        // (0 for sockets)
+        void PrepWrite(int Handler, uint64_t Tag, int Fd, const char* Data, size_t Length, uint64_t Offset, int Slot)
+        {
+            io_uring_sqe* Sqe = NextSqe(Handler, Tag);
+            bool Fixed = Slot >= 0 && BuffersRegistered;
+            Sqe->opcode = Fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+            Sqe->fd = Fd;
+            Sqe->addr = (uint64_t)(uintptr_t)Data;
+            Sqe->len = (uint32_t)Length;
+            Sqe->off = Offset;
+            if (Fixed)
+                Sqe->buf_index = (uint16_t)Slot;
+            if (Fixed)
+                Stats.FixedWrites++;
+            else
+                Stats.PlainWrites++;
+        }
+
+        // Vectors must stay valid until the write completes
+        void PrepWritev(int Handler, uint64_t Tag, int Fd, const iovec* Vectors, size_t Count)
+        {
+            io_uring_sqe* Sqe = NextSqe(Handler, Tag);
+            Sqe->opcode = IORING_OP_WRITEV;
+            Sqe->fd = Fd;
+            Sqe->addr = (uint64_t)(uintptr_t)Vectors;
+            Sqe->len = (uint32_t)std::min(Count, URING_MAX_VECTORS);
+            Stats.GatherWrites++;
+        }
+
+        void PrepRecv(int Handler, uint64_t Tag, int Fd, char* Data, size_t Length)
+        {
+            io_uring_sqe* Sqe = NextSqe(Handler, Tag);
+            Sqe->opcode = IORING_OP_RECV;
+            Sqe->fd = Fd;
+            Sqe->addr = (uint64_t)(uintptr_t)Data;
+            Sqe->len = (uint32_t)Length;
+        }
+
+        void PrepConnect(int Handler, uint64_t Tag, int Fd, const sockaddr* Address, socklen_t Length)
+        {
+            io_uring_sqe* Sqe = NextSqe(Handler, Tag);
+            Sqe->opcode = IORING_OP_CONNECT;
+            Sqe->fd = Fd;
+            Sqe->addr = (uint64_t)(uintptr_t)Address;
+            Sqe->off = Length;
+        }
+
+        // fdatasync ordered after every SQE queued before it
+        void PrepDataSync(int Handler, uint64_t Tag, int Fd)
+        {
+            io_uring_sqe* Sqe = NextSqe(Handler, Tag);
+            Sqe->opcode = IORING_OP_FSYNC;
+            Sqe->fd = Fd;
+            Sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+            Sqe->flags = IOSQE_IO_DRAIN;
+        }
+
+        // Submits everything queued since the last call, waits for at least
+        // MinComplete completions, and dispatches all that are ready. Returns
+        // the number dispatched, or -errno. With TimeoutNs >= 0 the wait ends
+        // after that long even if fewer completions arrived (kernels before
+        // 5.11 lack the bounded wait and do not wait at all).
+        int Run(unsigned MinComplete = 0, long long TimeoutNs = -1)
+        {
+            int Result = Enter(MinComplete, TimeoutNs);
+            if (Result < 0)
+                return Result;
+
+            int Dispatched = 0;
+            unsigned Head = *CqHead;
+            unsigned Tail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+            while (Head != Tail)
+            {
+                // Copy first: the handler may queue SQEs, but the slot is only
+                // reused after the head moves
+                io_uring_cqe Cqe = Cqes[Head & CqMask];
+                __atomic_store_n(CqHead, ++Head, __ATOMIC_RELEASE);
+                Dispatch(Cqe.user_data, Cqe.res);
+                Dispatched++;
+                if (Head == Tail)
+                    Tail = __atomic_load_n(CqTail, __ATOMIC_ACQUIRE);
+            }
+            Stats.Completions += (size_t)Dispatched;
+            return Dispatched;
+        }
+
+    private:
+        int RingFd = -1;
+        void* SqRing = MAP_FAILED;
+        void* CqRing = MAP_FAILED;
+        io_uring_sqe* Sqes = (io_uring_sqe*)MAP_FAILED;
+        size_t SqBytes = 0;
+        size_t CqBytes = 0;
+        size_t SqeBytes = 0;
+        unsigned* SqHead = nullptr;
+        unsigned* SqTail = nullptr;
+        unsigned* SqArray = nullptr;
+        unsigned SqMask = 0;
+        unsigned SqEntries = 0;
+        unsigned LocalTail = 0;     // Includes SQEs not yet published
+        unsigned* CqHead = nullptr;
+        unsigned* CqTail = nullptr;
+        unsigned CqMask = 0;
+        io_uring_cqe* Cqes = nullptr;
+        bool ExtArg = false;        // io_uring_enter takes a wait timeout
+
+        std::unique_ptr<char[]> Staging;
+        size_t SlotBytes = 0;
+        std::vector<int> FreeSlots;
+        bool BuffersRegistered = false;
+        std::vector<t_Handler> Handlers;
+        s_UringStats Stats;
+
+        bool Fail()
+        {
+            close(RingFd);
+            RingFd = -1;
+            return false;
+        }
+
+        io_uring_sqe* NextSqe(int Handler, uint64_t Tag)
+        {
+            // A full queue is flushed to the kernel without waiting
+            if (LocalTail - __atomic_load_n(SqHead, __ATOMIC_ACQUIRE) >= SqEntries)
+                Enter(0, -1);
+
+            unsigned Index = LocalTail & SqMask;
+            io_uring_sqe* Sqe = &Sqes[Index];
+            memset(Sqe, 0, sizeof(*Sqe));
+            Sqe->user_data = ((uint64_t)Handler << URING_TAG_BITS) | Tag;
+            SqArray[Index] = Index;
+            LocalTail++;
+            return Sqe;
+        }
+
+        int Enter(unsigned MinComplete, long long TimeoutNs)
+        {
+            // Everything past the kernel's head is unsubmitted, including SQEs
+            // left over from a call that returned EBUSY
+            __atomic_store_n(SqTail, LocalTail, __ATOMIC_RELEASE);
+            unsigned Pending = LocalTail - __atomic_load_n(SqHead, __ATOMIC_ACQUIRE);
+
+            unsigned Flags = IORING_ENTER_GETEVENTS;
+            const void* Arg = nullptr;
+            size_t ArgSize = 0;
+            __kernel_timespec Timeout;
+            io_uring_getevents_arg Wait;
+            if (TimeoutNs >= 0 && MinComplete > 0)
+            {
+                if (!ExtArg)
+                    MinComplete = 0;
+                else
+                {
+                    Timeout.tv_sec = TimeoutNs / 1000000000;
+                    Timeout.tv_nsec = TimeoutNs % 1000000000;
+                    memset(&Wait, 0, sizeof(Wait));
+                    Wait.ts = (uint64_t)(uintptr_t)&Timeout;
+                    Flags |= IORING_ENTER_EXT_ARG;
+                    Arg = &Wait;
+                    ArgSize = sizeof(Wait);
+                }
+            }
+
+            for (;;)
+            {
+                int Result = (int)syscall(__NR_io_uring_enter, RingFd, Pending, MinComplete, Flags, Arg, ArgSize);
+                if (Result >= 0)
+                {
+                    Stats.Submits++;
+                    Stats.Submitted += (size_t)Result;
+                    return Result;
+                }
+                if (errno == EINTR)
+                    continue;
+                // The bounded wait ran out; nothing was submitted
+                if (errno == ETIME)
+                {
+                    Stats.Submits++;
+                    return 0;
+                }
+                // Completions have to be reaped before more SQEs are taken
+                if (errno == EAGAIN || errno == EBUSY)
+                    return 0;
+                return -errno;
+            }
+        }
+
+        void Dispatch(uint64_t UserData, int32_t Result)
+        {
+            size_t Handler = (size_t)(UserData >> URING_TAG_BITS);
+            if (Handler < Handlers.size())
+                Handlers[Handler](UserData & (((uint64_t)1 << URING_TAG_BITS) - 1), Result);
+        }
+    };
+
+    struct s_UringResponse
+    {
+        uint64_t Ticket = 0;
+        int Connection = -1;
+        int Status = 0;         // HTTP status, or -errno when the request failed
+        std::string Body;
+    };
+
+    struct s_UringSenderStats
+    {
+        size_t Posted = 0;
+        size_t Completed = 0;
+        size_t Failed = 0;
+        size_t Connects = 0;
+        size_t BytesSent = 0;
+    };
+
+    // HTTP/1.1 POSTs to one endpoint over any number of keep-alive connections
+    // (one per collector stream). Each connection sends its requests in order,
+    // one at a time, the way the collector waits for each response.
+    class c_UringSender
+    {
+    public:
+        typedef std::function<void(const s_UringResponse&)> t_Callback;
+
+        // Endpoint is "http://host[:port][/base path]"; requests go to base path + Path
+        c_UringSender(c_UringLoop& Loop, const std::string& Endpoint, const std::string& APIKey = std::string())
+            : Loop(Loop)
+            , APIKey(APIKey)
+        {
+            Valid = ParseEndpoint(Endpoint);
+            HandlerId = Loop.AddHandler([this](uint64_t Tag, int32_t Result) { OnCompletion(Tag, Result); });
+        }
+
+        ~c_UringSender()
+        {
+            for (s_Connection& Connection : Connections)
+                if (Connection.Fd >= 0)
+                    close(Connection.Fd);
+        }
+
+        bool IsValid() const { return Valid; }
+        const std::string& GetBasePath() const { return BasePath; }
+        const s_UringSenderStats& GetStats() const { return Stats; }
+
+        // Connections are opened on their first request
+        int AddConnection()
+        {
+            Connections.emplace_back();
+            Connections.back().Receive.resize(URING_RECV_BYTES);
+            return (int)Connections.size() - 1;
+        }
+
+        // Queues a POST on Connection; Done runs from Loop.Run once the response
+        // (or failure) arrives. ExtraHeaders are complete "Name: value\r\n" lines.
+        uint64_t Post(int Connection, const std::string& Path, const char* Body, size_t Length,
+            t_Callback Done, const std::string& ExtraHeaders = std::string())
+        {
+            s_Request Request;
+            const std::string& Block = HeaderBlock(Path);
+            std::string Head = RequestHead(Length, ExtraHeaders);
+
+            // The body is copied once: straight into a registered slot when one
+            // is free, otherwise into the request
+            Request.Length = Block.size() + Head.size() + Length;
+            Request.Slot = Request.Length <= Loop.GetSlotBytes() ? Loop.AcquireSlot() : -1;
+            char* Target = nullptr;
+            if (Request.Slot >= 0)
+                Target = Loop.SlotData(Request.Slot);
+            else
+            {
+                Request.Wire.resize(Request.Length);
+                Target = &Request.Wire[0];
+            }
+            memcpy(Target, Block.data(), Block.size());
+            memcpy(Target + Block.size(), Head.data(), Head.size());
+            memcpy(Target + Block.size() + Head.size(), Body, Length);
+            return Queue(Connection, std::move(Request), std::move(Done));
+        }
+
+        // Queues a POST whose body is the concatenation of Slices, sent in
+        // place with vectored writes: the prebuilt header block for Path, the
+        // request's own Content-Length and ExtraHeaders, then every slice. No
+        // contiguous body is built, so the slice memory must stay valid and
+        // unchanged until Done runs.
+        uint64_t Post(int Connection, const std::string& Path, const s_UringSlice* Slices, size_t Count,
+            t_Callback Done, const std::string& ExtraHeaders = std::string())
+        {
+            s_Request Request;
+            size_t Length = 0;
+            for (size_t i = 0; i < Count; i++)
+                Length += Slices[i].Length;
+
+            const std::string& Block = HeaderBlock(Path);
+            Request.Head = RequestHead(Length, ExtraHeaders);
+            Request.Length = Block.size() + Request.Head.size() + Length;
+            Request.Vectors.reserve(Count + 2);
+            Request.Vectors.push_back({ (void*)Block.data(), Block.size() });
+            Request.Vectors.push_back({ nullptr, Request.Head.size() });   // Pointed at Head once queued
+            for (size_t i = 0; i < Count; i++)
+                if (Slices[i].Length > 0)
+                    Request.Vectors.push_back({ (void*)Slices[i].Data, Slices[i].Length });
+            return Queue(Connection, std::move(Request), std::move(Done));
+        }
+
+        size_t Pending(int Connection) const { return Connections[(size_t)Connection].Queue.size(); }
+
+    private:
+        enum e_State
+        {
+            STATE_CLOSED = 0,
+            STATE_CONNECTING,
+            STATE_IDLE,
+            STATE_WRITING,
+            STATE_READING
+        };
+
+        enum e_Operation
+        {
+            OP_CONNECT = 0,
+            OP_WRITE,
+            OP_RECV
+        };
+
+        struct s_Request
+        {
+            uint64_t Ticket = 0;
+            int Slot = -1;          // Staging slot holding the request, else Wire does
+            size_t Length = 0;
+            std::string Wire;
+            std::string Head;               // Gather requests: Content-Length and extra headers
+            std::vector<iovec> Vectors;     // Gather requests: unsent part, advanced by writes
+            size_t FirstVector = 0;
+            t_Callback Done;
+
+            bool IsGather() const { return !Vectors.empty(); }
+            const char* Data(c_UringLoop& Loop) const { return Slot >= 0 ? Loop.SlotData(Slot) : Wire.data(); }
+        };
+
+        struct s_Connection
+        {
+            int Fd = -1;
+            e_State State = STATE_CLOSED;
+            std::deque<s_Request> Queue;    // Front is in flight unless Idle
+            size_t Written = 0;             // Bytes of the front request sent
+            std::vector<char> Receive;
+            std::string Response;
+            size_t HeaderEnd = 0;           // Offset of the body, 0 until headers are complete
+            size_t ContentLength = 0;
+            int Status = 0;
+            bool CloseAfter = false;
+        };
+
+        c_UringLoop& Loop;
+        std::string APIKey;
+        std::string Host;
+        std::string BasePath;
+        sockaddr_storage Address;
+        socklen_t AddressLength = 0;
+        bool Valid = false;
+        int HandlerId = -1;
+        uint64_t LastTicket = 0;
+        std::deque<s_Connection> Connections;   // Stable addresses as connections are added
+        std::unordered_map<std::string, std::string> HeaderBlocks;  // Path -> request line and fixed headers
+        s_UringSenderStats Stats;
+
+        const std::string& HeaderBlock(const std::string& Path)
+        {
+            std::string& Block = HeaderBlocks[Path];
+            if (!Block.empty())
+                return Block;
+            Block += "POST ";
+            Block += BasePath;
+            Block += Path;
+            Block += " HTTP/1.1\r\nHost: ";
+            Block += Host;
+            Block += "\r\nContent-Type: application/json\r\n";
+            if (!APIKey.empty())
+            {
+                Block += "X-API-Key: ";
+                Block += APIKey;
+                Block += "\r\n";
+            }
+            return Block;
+        }
+
+        static std::string RequestHead(size_t Length, const std::string& ExtraHeaders)
+        {
+            std::string Head = "Content-Length: ";
+            Head += std::to_string(Length);
+            Head += "\r\n";
+            Head += ExtraHeaders;
+            Head += "\r\n";
+            return Head;
+        }
+
+        uint64_t Queue(int Connection, s_Request&& Request, t_Callback&& Done)
+        {
+            Request.Ticket = ++LastTicket;
+            Request.Done = std::move(Done);
+            Stats.Posted++;
+            s_Connection& Owner = Connections[(size_t)Connection];
+            Owner.Queue.push_back(std::move(Request));
+            s_Request& Queued = Owner.Queue.back();
+            if (Queued.IsGather())
+                Queued.Vectors[1].iov_base = &Queued.Head[0];
+            if (Owner.State == STATE_IDLE || Owner.State == STATE_CLOSED)
+                Start(Connection);
+            return LastTicket;
+        }
+
+        bool ParseEndpoint(const std::string& Endpoint)
+        {
+            std::string Rest = Endpoint;
+            const std::string Scheme = "http://";
+            if (Rest.compare(0, Scheme.size(), Scheme) == 0)
+                Rest = Rest.substr(Scheme.size());
+            size_t Slash = Rest.find('/');
+            Host = Rest.substr(0, Slash);
+            BasePath = Slash == std::string::npos ? std::string() : Rest.substr(Slash);
+            while (!BasePath.empty() && BasePath.back() == '/')
+                BasePath.pop_back();
+
+            std::string Name = Host;
+            std::string Port = "80";
+            size_t Colon = Host.rfind(':');
+            if (Colon != std::string::npos)
+            {
+                Name = Host.substr(0, Colon);
+                Port = Host.substr(Colon + 1);
+            }
+
+            addrinfo Hints;
+            memset(&Hints, 0, sizeof(Hints));
+            Hints.ai_family = AF_UNSPEC;
+            Hints.ai_socktype = SOCK_STREAM;
+            addrinfo* Found = nullptr;
+            if (getaddrinfo(Name.c_str(), Port.c_str(), &Hints, &Found) != 0 || Found == nullptr)
+                return false;
+            memcpy(&Address, Found->ai_addr, Found->ai_addrlen);
+            AddressLength = Found->ai_addrlen;
+            freeaddrinfo(Found);
+            return true;
+        }
+
+        static uint64_t MakeTag(int Connection, e_Operation Operation)
+        {
+            return ((uint64_t)Connection << 2) | (uint64_t)Operation;
+        }
+
+        // Moves an idle or closed connection with queued requests forward
+        void Start(int Index)
+        {
+            s_Connection& Connection = Connections[(size_t)Index];
+            if (Connection.Queue.empty())
+            {
+                if (Connection.State != STATE_CLOSED)
+                    Connection.State = STATE_IDLE;
+                return;
+            }
+
+            if (Connection.State == STATE_CLOSED)
+            {
+                Connection.Fd = Valid ? socket(Address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0) : -1;
+                if (Connection.Fd < 0)
+                {
+                    FailAll(Index, Valid ? -errno : -EINVAL);
+                    return;
+                }
+                int One = 1;
+                setsockopt(Connection.Fd, IPPROTO_TCP, TCP_NODELAY, &One, sizeof(One));
+                Connection.State = STATE_CONNECTING;
+                Stats.Connects++;
+                Loop.PrepConnect(HandlerId, MakeTag(Index, OP_CONNECT), Connection.Fd, (const sockaddr*)&Address, AddressLength);
+                return;
+            }
+
+            Connection.Written = 0;
+            Connection.State = STATE_WRITING;
+            PrepNextWrite(Index);
+        }
+
+        void OnCompletion(uint64_t Tag, int32_t Result)
+        {
+            int Index = (int)(Tag >> 2);
+            s_Connection& Connection = Connections[(size_t)Index];
+            switch ((e_Operation)(Tag & 3))
+            {
+            case OP_CONNECT:
+                if (Result < 0)
+                {
+                    Close(Index);
+                    FailAll(Index, Result);
+                    return;
+                }
+                Connection.State = STATE_IDLE;
+                Start(Index);
+                return;
+
+            case OP_WRITE:
+                if (Result <= 0)
+                {
+                    Fail(Index, Result < 0 ? Result : -EPIPE);
+                    return;
+                }
+                OnWritten(Index, (size_t)Result);
+                return;
+
+            case OP_RECV:
+                if (Result <= 0)
+                {
+                    Fail(Index, Result < 0 ? Result : -ECONNRESET);
+                    return;
+                }
+                Connection.Response.append(Connection.Receive.data(), (size_t)Result);
+                if (!ParseResponse(Connection))
+                {
+                    Fail(Index, -EPROTO);
+                    return;
+                }
+                if (Connection.HeaderEnd == 0 || Connection.Response.size() < Connection.HeaderEnd + Connection.ContentLength)
+                {
+                    Loop.PrepRecv(HandlerId, MakeTag(Index, OP_RECV), Connection.Fd, Connection.Receive.data(), Connection.Receive.size());
+                    return;
+                }
+                Complete(Index);
+                return;
+            }
+        }
+
+        // Writes what is left of the front request: the rest of its bytes, or
+        // its unsent vectors
+        void PrepNextWrite(int Index)
+        {
+            s_Connection& Connection = Connections[(size_t)Index];
+            s_Request& Request = Connection.Queue.front();
+            if (Request.IsGather())
+                Loop.PrepWritev(HandlerId, MakeTag(Index, OP_WRITE), Connection.Fd, Request.Vectors.data() + Request.FirstVector,
+                    Request.Vectors.size() - Request.FirstVector);
+            else
+                Loop.PrepWrite(HandlerId, MakeTag(Index, OP_WRITE), Connection.Fd, Request.Data(Loop) + Connection.Written,
+                    Request.Length - Connection.Written, 0, Request.Slot);
+        }
+
+        void OnWritten(int Index, size_t Bytes)
+        {
+            s_Connection& Connection = Connections[(size_t)Index];
+            s_Request& Request = Connection.Queue.front();
+            Stats.BytesSent += Bytes;
+            Connection.Written += Bytes;
+            if (Request.IsGather())
+            {
+                // Skip the vectors the write covered and trim a partial one
+                while (Bytes > 0 && Request.FirstVector < Request.Vectors.size())
+                {
+                    iovec& Vector = Request.Vectors[Request.FirstVector];
+                    size_t Taken = std::min(Bytes, Vector.iov_len);
+                    Vector.iov_base = (char*)Vector.iov_base + Taken;
+                    Vector.iov_len -= Taken;
+                    Bytes -= Taken;
+                    if (Vector.iov_len == 0)
+                        Request.FirstVector++;
+                }
+            }
+            if (Connection.Written < Request.Length)
+            {
+                // Short write (or more vectors than one writev takes): the rest
+                PrepNextWrite(Index);
+                return;
+            }
+
+            Loop.ReleaseSlot(Request.Slot);
+            Request.Slot = -1;
+            Connection.Response.clear();
+            Connection.HeaderEnd = 0;
+            Connection.State = STATE_READING;
+            Loop.PrepRecv(HandlerId, MakeTag(Index, OP_RECV), Connection.Fd, Connection.Receive.data(), Connection.Receive.size());
+        }
+
+        // Reads the status line and Content-Length once the headers are in;
+        // false for a malformed response
+        static bool ParseResponse(s_Connection& Connection)
+        {
+            if (Connection.HeaderEnd != 0)
+                return true;
+            size_t End = Connection.Response.find("\r\n\r\n");
+            if (End == std::string::npos)
+                return true;
+
+            const std::string& Text = Connection.Response;
+            if (Text.compare(0, 5, "HTTP/") != 0)
+                return false;
+            size_t Space = Text.find(' ');
+            if (Space == std::string::npos || Space > End)
+                return false;
+            Connection.Status = atoi(Text.c_str() + Space + 1);
+            Connection.ContentLength = 0;
+            Connection.CloseAfter = false;
+
+            size_t Line = Text.find("\r\n") + 2;
+            while (Line < End)
+            {
+                size_t LineEnd = Text.find("\r\n", Line);
+                size_t Colon = Text.find(':', Line);
+                if (Colon != std::string::npos && Colon < LineEnd)
+                {
+                    std::string Name = Text.substr(Line, Colon - Line);
+                    std::transform(Name.begin(), Name.end(), Name.begin(), ::tolower);
+                    const char* Value = Text.c_str() + Colon + 1;
+                    if (Name == "content-length")
+                        Connection.ContentLength = (size_t)strtoull(Value, nullptr, 10);
+                    else if (Name == "connection" && strstr(Value, "close") != nullptr)
+                        Connection.CloseAfter = true;
+                    else if (Name == "transfer-encoding")
+                        return false;   // Chunked bodies are not used by the backend
+                }
+                Line = LineEnd + 2;
+            }
+            Connection.HeaderEnd = End + 4;
+            return true;
+        }
+
+        void Complete(int Index)
+        {
+            s_Connection& Connection = Connections[(size_t)Index];
+            s_Request Request = std::move(Connection.Queue.front());
+            Connection.Queue.pop_front();
+
+            s_UringResponse Response;
+            Response.Ticket = Request.Ticket;
+            Response.Connection = Index;
+            Response.Status = Connection.Status;
+            Response.Body = Connection.Response.substr(Connection.HeaderEnd, Connection.ContentLength);
+            Stats.Completed++;
+
+            if (Connection.CloseAfter)
+                Close(Index);
+            else
+                Connection.State = STATE_IDLE;
+            Start(Index);
+            if (Request.Done)
+                Request.Done(Response);
+        }
+
+        // Fails the in-flight request; queued ones go out on a new connection
+        void Fail(int Index, int Error)
+        {
+            s_Connection& Connection = Connections[(size_t)Index];
+            s_Request Request = std::move(Connection.Queue.front());
+            Connection.Queue.pop_front();
+            Close(Index);
+            Start(Index);
+            Deliver(Index, Request, Error);
+        }
+
+        void FailAll(int Index, int Error)
+        {
+            std::deque<s_Request> Failed;
+            Failed.swap(Connections[(size_t)Index].Queue);
+            for (s_Request& Request : Failed)
+                Deliver(Index, Request, Error);
+        }
+
+        void Deliver(int Index, s_Request& Request, int Error)
+        {
+            Loop.ReleaseSlot(Request.Slot);
+            Request.Slot = -1;
+            s_UringResponse Response;
+            Response.Ticket = Request.Ticket;
+            Response.Connection = Index;
+            Response.Status = Error;
+            Stats.Failed++;
+            if (Request.Done)
+                Request.Done(Response);
+        }
+
+        void Close(int Index)
+        {
+            s_Connection& Connection = Connections[(size_t)Index];
+            if (Connection.Fd >= 0)
+                close(Connection.Fd);
+            Connection.Fd = -1;
+            Connection.State = STATE_CLOSED;
+        }
+    };
+
+    struct s_UringSpoolStats
+    {
+        size_t Appends = 0;
+        size_t Bytes = 0;
+        size_t Syncs = 0;
+        size_t Errors = 0;
+    };
+
+    // Append-only spool file. Appends are staged like sender requests and
+    // written at offsets reserved when they are queued, so any number may be
+    // in flight and they land in call order.
+    class c_UringSpool
+    {
+    public:
+        typedef std::function<void(int Result)> t_Callback;
+
+        c_UringSpool(c_UringLoop& Loop)
+            : Loop(Loop)
+        {
+            HandlerId = Loop.AddHandler([this](uint64_t Tag, int32_t Result) { OnCompletion(Tag, Result); });
+        }
+
+        ~c_UringSpool()
+        {
+            if (Fd >= 0)
+                close(Fd);
+        }
+
+        // Appends continue at the end of an existing file. After a restart,
+        // pass the end Replay returned as ValidSize to cut off a torn record.
+        bool Open(const std::string& Path, int64_t ValidSize = -1)
+        {
+            Fd = open(Path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+            if (Fd < 0)
+                return false;
+            if (ValidSize >= 0 && ftruncate(Fd, (off_t)ValidSize) != 0)
+                return false;
+            struct stat Info;
+            if (fstat(Fd, &Info) != 0)
+                return false;
+            Tail = (uint64_t)Info.st_size;
+            return true;
+        }
+
+        uint64_t Size() const { return Tail; }
+        const s_UringSpoolStats& GetStats() const { return Stats; }
+
+        typedef std::function<void(uint64_t Offset, const char* Data, size_t Length)> t_Visitor;
+
+        // Reads back records appended as newline-terminated bodies (collector
+        // JSON has no raw newlines) from offset From, such as the end of the
+        // last body the backend acknowledged. Visit gets each complete record
+        // without its newline. Returns the end of the last complete record, so
+        // a record torn by a crash mid-append is left out, or -errno. Blocking
+        // reads: this runs at startup, before the loop does.
+        static int64_t Replay(const std::string& Path, uint64_t From, const t_Visitor& Visit)
+        {
+            int File = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (File < 0)
+                return errno == ENOENT ? 0 : -errno;
+
+            std::string Pending;
+            std::vector<char> Chunk(65536);
+            uint64_t Offset = From;     // File offset of Pending's first byte
+            uint64_t ReadAt = From;
+            for (;;)
+            {
+                ssize_t Read = pread(File, Chunk.data(), Chunk.size(), (off_t)ReadAt);
+                if (Read < 0 && errno == EINTR)
+                    continue;
+                if (Read < 0)
+                {
+                    int Error = errno;
+                    close(File);
+                    return -Error;
+                }
+                if (Read == 0)
+                    break;
+                ReadAt += (uint64_t)Read;
+                Pending.append(Chunk.data(), (size_t)Read);
+
+                size_t Start = 0;
+                for (size_t End = Pending.find('\n'); End != std::string::npos; End = Pending.find('\n', Start))
+                {
+                    Visit(Offset + Start, Pending.data() + Start, End - Start);
+                    Start = End + 1;
+                }
+                Pending.erase(0, Start);
+                Offset += Start;
+            }
+            close(File);
+            return (int64_t)Offset;
+        }
+
+        // Queues Length bytes at the current end; returns the offset they are
+        // written at. Done (optional) gets the bytes written or -errno.
+        uint64_t Append(const char* Data, size_t Length, t_Callback Done = t_Callback())
+        {
+            size_t Id = AllocateWrite();
+            s_Write& Write = Writes[Id];
+            Write.Offset = Tail;
+            Write.Length = Length;
+            Write.Written = 0;
+            Write.Done = std::move(Done);
+            Write.Slot = Length <= Loop.GetSlotBytes() ? Loop.AcquireSlot() : -1;
+            if (Write.Slot >= 0)
+            {
+                memcpy(Loop.SlotData(Write.Slot), Data, Length);
+                Write.Data = Loop.SlotData(Write.Slot);
+            }
+            else
+            {
+                Write.Copy.assign(Data, Length);
+                Write.Data = Write.Copy.data();
+            }
+            Tail += Length;
+            Stats.Appends++;
+            Loop.PrepWrite(HandlerId, Id, Fd, Write.Data, Length, Write.Offset, Write.Slot);
+            return Write.Offset;
+        }
+
+        // fdatasync after every append queued so far
+        void Sync(t_Callback Done = t_Callback())
+        {
+            size_t Id = AllocateWrite();
+            Writes[Id].IsSync = true;
+            Writes[Id].Done = std::move(Done);
+            Stats.Syncs++;
+            Loop.PrepDataSync(HandlerId, Id, Fd);
+        }
+
+    private:
+        struct s_Write
+        {
+            bool IsSync = false;
+            uint64_t Offset = 0;
+            const char* Data = nullptr;
+            size_t Length = 0;
+            size_t Written = 0;
+            int Slot = -1;
+            std::string Copy;
+            t_Callback Done;
+        };
+
+        c_UringLoop& Loop;
+        int HandlerId = -1;
+        int Fd = -1;
+        uint64_t Tail = 0;
+        std::deque<s_Write> Writes;     // Stable addresses: Copy buffers are in flight
+        std::vector<size_t> FreeWrites;
+        s_UringSpoolStats Stats;
+
+        size_t AllocateWrite()
+        {
+            if (FreeWrites.empty())
+            {
+                Writes.emplace_back();
+                FreeWrites.push_back(Writes.size() - 1);
+            }
+            size_t Id = FreeWrites.back();
+            FreeWrites.pop_back();
+            Writes[Id] = s_Write();
+            return Id;
+        }
+
+        void OnCompletion(uint64_t Id, int32_t Result)
+        {
+            s_Write& Write = Writes[(size_t)Id];
+            if (!Write.IsSync && Result > 0)
+            {
+                Stats.Bytes += (size_t)Result;
+                Write.Written += (size_t)Result;
+                if (Write.Written < Write.Length)
+                {
+                    Loop.PrepWrite(HandlerId, Id, Fd, Write.Data + Write.Written, Write.Length - Write.Written,
+                        Write.Offset + Write.Written, Write.Slot);
+                    return;
+                }
+                Result = (int32_t)Write.Written;
+            }
+            else if (Result < 0 || (!Write.IsSync && Result == 0))
+                Stats.Errors++;
+
+            Loop.ReleaseSlot(Write.Slot);
+            t_Callback Done = std::move(Write.Done);
+            Write = s_Write();
+            FreeWrites.push_back((size_t)Id);
+            if (Done)
+                Done(Result);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,20 @@
+from pybind11.setup_helpers import Pybind11Extension, build_ext
+from setuptools import setup
+
+# Builds the optional tradeflow_native extension (native/README.md). Run
+# `python setup.py build_ext --inplace` from tradeflow-backend/ to place the
+# module next to app/; the Docker image does the same in its build stage.
+setup(
+    name="tradeflow-native",
+    ext_modules=[
+        Pybind11Extension(
+            "tradeflow_native",
+            ["native/bindings.cpp"],
+            include_dirs=["native"],
+            cxx_std=17,
+            extra_compile_args=["-O3"],
+        )
+    ],
+    cmdclass={"build_ext": build_ext},
+    zip_safe=False,
+)
@@ -1,6 +1,11 @@
 -- Connect to the database (assumes it exists or run this in the DB)
 -- CREATE DATABASE market_data_db;
 -- \c market_data_db;
+--
+-- Safe to re-run: every statement skips what already exists, so each deploy
+-- applies this file to bring an existing database up to date (new market_data
+-- columns, tables and policies) before the API starts:
+--   psql -v ON_ERROR_STOP=1 -d market_data_db -f sql/timescale_schema.sql
 
 -- Install TimescaleDB
 CREATE EXTENSION IF NOT EXISTS timescaledb CASCADE;
@@ -19,33 +24,56 @@ CREATE TABLE IF NOT EXISTS market_data (
     ask_volume DOUBLE PRECISION,
     number_of_trades INTEGER,
     open_interest DOUBLE PRECISION,
+    -- Collector-side calculations (NULL when not enabled in the study)
+    delta DOUBLE PRECISION,
+    cvd DOUBLE PRECISION,
+    vwap DOUBLE PRECISION,
+    vwap_upper DOUBLE PRECISION,
+    vwap_lower DOUBLE PRECISION,
+    ema JSONB,
     source VARCHAR(100) DEFAULT 'sierra_chart',
     collected_at TIMESTAMPTZ DEFAULT NOW(),
     PRIMARY KEY (time, symbol, timeframe)
 );
 
+-- Upgrade path for tables created before collector-side calculations
+ALTER TABLE market_data ADD COLUMN IF NOT EXISTS delta DOUBLE PRECISION;
+ALTER TABLE market_data ADD COLUMN IF NOT EXISTS cvd DOUBLE PRECISION;
+ALTER TABLE market_data ADD COLUMN IF NOT EXISTS vwap DOUBLE PRECISION;
+ALTER TABLE market_data ADD COLUMN IF NOT EXISTS vwap_upper DOUBLE PRECISION;
+ALTER TABLE market_data ADD COLUMN IF NOT EXISTS vwap_lower DOUBLE PRECISION;
+ALTER TABLE market_data ADD COLUMN IF NOT EXISTS ema JSONB;
+
 -- Convert to hypertable (TimescaleDB magic!)
 SELECT create_hypertable('market_data', 'time', 
     chunk_time_interval => INTERVAL '1 day',
     if_not_exists => TRUE
 );
 
--- Enable compression (saves 90%+ storage)
-ALTER TABLE market_data SET (
-    timescaledb.compress,
-    timescaledb.compress_segmentby = 'symbol,timeframe',
-    timescaledb.compress_orderby = 'time DESC'
-);
+-- Enable compression (saves 90%+ storage). Only once: the settings cannot be
+-- changed while compressed chunks exist.
+DO $$
+BEGIN
+    IF NOT EXISTS (SELECT 1 FROM timescaledb_information.hypertables
+                   WHERE hypertable_name = 'market_data' AND compression_enabled) THEN
+        ALTER TABLE market_data SET (
+            timescaledb.compress,
+            timescaledb.compress_segmentby = 'symbol,timeframe',
+            timescaledb.compress_orderby = 'time DESC'
+        );
+    END IF;
+END
+$$;
 
 -- Auto-compress data older than 7 days
-SELECT add_compression_policy('market_data', INTERVAL '7 days');
+SELECT add_compression_policy('market_data', INTERVAL '7 days', if_not_exists => TRUE);
 
 -- Indexes for fast queries
 CREATE INDEX IF NOT EXISTS idx_market_data_symbol_time ON market_data (symbol, time DESC);
 CREATE INDEX IF NOT EXISTS idx_market_data_timeframe ON market_data (timeframe, time DESC);
 
 -- Continuous aggregates (pre-computed timeframes)
-CREATE MATERIALIZED VIEW market_data_1min
+CREATE MATERIALIZED VIEW IF NOT EXISTS market_data_1min
 WITH (timescaledb.continuous) AS
 SELECT 
     time_bucket('1 minute', time) AS bucket,
@@ -67,7 +95,8 @@ GROUP BY bucket, symbol;
 SELECT add_continuous_aggregate_policy('market_data_1min',
     start_offset => INTERVAL '1 hour',
     end_offset => INTERVAL '1 minute',
-    schedule_interval => INTERVAL '1 minute'
+    schedule_interval => INTERVAL '1 minute',
+    if_not_exists => TRUE
 );
 
 -- Volume Profile table
@@ -103,6 +132,65 @@ SELECT create_hypertable('market_profile', 'time',
     if_not_exists => TRUE
 );
 
+-- Market Profile session summary (one row per symbol and session, updated while live)
+CREATE TABLE IF NOT EXISTS market_profile_sessions (
+    session_start TIMESTAMPTZ NOT NULL,
+    symbol VARCHAR(50) NOT NULL,
+    last_update TIMESTAMPTZ NOT NULL,
+    complete BOOLEAN NOT NULL DEFAULT FALSE,
+    periods INTEGER NOT NULL,
+    tpo_count INTEGER NOT NULL,
+    single_prints INTEGER NOT NULL,
+    high DOUBLE PRECISION NOT NULL,
+    low DOUBLE PRECISION NOT NULL,
+    poc DOUBLE PRECISION NOT NULL,
+    value_area_high DOUBLE PRECISION NOT NULL,
+    value_area_low DOUBLE PRECISION NOT NULL,
+    ib_high DOUBLE PRECISION,
+    ib_low DOUBLE PRECISION,
+    ib_complete BOOLEAN NOT NULL DEFAULT FALSE,
+    PRIMARY KEY (session_start, symbol)
+);
+
+SELECT create_hypertable('market_profile_sessions', 'session_start',
+    chunk_time_interval => INTERVAL '30 days',
+    if_not_exists => TRUE
+);
+
+-- Per-stream statistics maintained on ingest (see native/catalog.h)
+CREATE TABLE IF NOT EXISTS stream_catalog (
+    symbol VARCHAR(50) NOT NULL,
+    timeframe VARCHAR(10) NOT NULL,
+    bar_count BIGINT NOT NULL,
+    first_time TIMESTAMPTZ NOT NULL,
+    last_time TIMESTAMPTZ NOT NULL,
+    volume_sum DOUBLE PRECISION NOT NULL,
+    max_volume DOUBLE PRECISION NOT NULL,
+    min_low DOUBLE PRECISION NOT NULL,
+    max_high DOUBLE PRECISION NOT NULL,
+    last_volume DOUBLE PRECISION NOT NULL,
+    PRIMARY KEY (symbol, timeframe)
+);
+
+-- Liquidity heatmap tiles aggregated by the collector from market depth
+-- (TradeFlow_Pro_Heatmap.h): one finished time column per row, cells quantized
+CREATE TABLE IF NOT EXISTS heatmap_tiles (
+    time TIMESTAMPTZ NOT NULL,
+    symbol VARCHAR(50) NOT NULL,
+    column_seconds INTEGER NOT NULL,
+    row_size DOUBLE PRECISION NOT NULL,
+    low_price DOUBLE PRECISION NOT NULL,
+    scale DOUBLE PRECISION NOT NULL,
+    cells TEXT NOT NULL,
+    PRIMARY KEY (time, symbol, column_seconds)
+);
+
+SELECT create_hypertable('heatmap_tiles', 'time',
+    chunk_time_interval => INTERVAL '1 day',
+    if_not_exists => TRUE
+);
+
 -- Retention policies
-SELECT add_retention_policy('market_data', INTERVAL '2 years');
-SELECT add_retention_policy('volume_profile', INTERVAL '6 months');
+SELECT add_retention_policy('market_data', INTERVAL '2 years', if_not_exists => TRUE);
+SELECT add_retention_policy('volume_profile', INTERVAL '6 months', if_not_exists => TRUE);
+SELECT add_retention_policy('heatmap_tiles', INTERVAL '30 days', if_not_exists => TRUE);